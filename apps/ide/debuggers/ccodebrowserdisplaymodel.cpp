@@ -26,6 +26,8 @@ static char modelStringBuffer [ 2048 ];
 CCodeBrowserDisplayModel::CCodeBrowserDisplayModel(CBreakpointInfo* pBreakpoints,QObject*)
 {
    m_pBreakpoints = pBreakpoints;
+   m_viewRegion = 0xFFFFFFFF;
+   m_rows = 0;
 }
 
 CCodeBrowserDisplayModel::~CCodeBrowserDisplayModel()
@@ -220,7 +222,8 @@ QVariant CCodeBrowserDisplayModel::data(const QModelIndex& index, int role) cons
       case CodeBrowserCol_Disassembly:
          if ( !nesicideProject->getProjectTarget().compare("nes",Qt::CaseInsensitive) )
          {
-            return nesGetDisassemblyAtAddress(addr);
+            nesGetDisassemblyAtAddress(addr,modelStringBuffer);
+            return QVariant(modelStringBuffer);
          }
          else if ( !nesicideProject->getProjectTarget().compare("c64",Qt::CaseInsensitive) )
          {
@@ -335,8 +338,8 @@ int CCodeBrowserDisplayModel::rowCount(const QModelIndex&) const
 
    if ( !nesicideProject->getProjectTarget().compare("nes",Qt::CaseInsensitive) )
    {
-      // Get the source-lines-of-code count from RAM/SRAM/EXRAM/PRG-ROM that is currently visible to the CPU...
-      rows = nesGetSLOC(nesGetCPUProgramCounterOfLastSync());
+      // The view's rows only change in update() (see there).
+      rows = m_rows;
    }
    else if ( !nesicideProject->getProjectTarget().compare("c64",Qt::CaseInsensitive) )
    {
@@ -362,12 +365,94 @@ void CCodeBrowserDisplayModel::update()
    // Update display...
    if ( !nesicideProject->getProjectTarget().compare("nes",Qt::CaseInsensitive) )
    {
+      uint32_t pc = nesGetCPUProgramCounterOfLastSync();
+      uint32_t region;
+      uint32_t bank;
+      int32_t  firstRow;
+      int32_t  endRow;
+      int32_t  rowDelta;
+      int32_t  oldRows;
+      bool     changed;
+      bool     moved;
+      int      idx;
+
       nesDisassemble();
+
+      // Which memory is the CPU running from?  Its disassembly is the view.
+      if ( pc < 0x800 )
+      {
+         region = 0x0000;
+      }
+      else if ( pc < 0x5C00 )
+      {
+         region = 0x0800;
+      }
+      else if ( pc < 0x6000 )
+      {
+         region = 0x5C00;
+      }
+      else if ( pc < 0x8000 )
+      {
+         region = 0x6000;
+      }
+      else
+      {
+         region = 0x8000;
+      }
+      moved = (region != m_viewRegion);
+      for ( idx = 0; idx < 4; idx++ )
+      {
+         bank = (region == 0x8000) ? nesGetAbsoluteAddressFromAddress(0x8000+(idx*MEM_8KB)) : nesGetAbsoluteAddressFromAddress(region);
+         moved |= (bank != m_viewBanks[idx]);
+         m_viewBanks[idx] = bank;
+      }
+
+      changed = nesGetDisassemblyChanges(pc,&firstRow,&endRow,&rowDelta);
+
+      if ( moved )
+      {
+         // Different memory altogether.
+         m_viewRegion = region;
+         m_rows = nesGetSLOC(pc);
+         emit layoutChanged();
+         return;
+      }
+
+      // Only the rows that were disassembled again changed.
+      if ( changed )
+      {
+         oldRows = (endRow-firstRow)-rowDelta;
+         if ( rowDelta )
+         {
+            if ( oldRows > 0 )
+            {
+               beginRemoveRows(QModelIndex(),firstRow,firstRow+oldRows-1);
+               m_rows -= oldRows;
+               endRemoveRows();
+            }
+            if ( endRow > firstRow )
+            {
+               beginInsertRows(QModelIndex(),firstRow,endRow-1);
+               m_rows += endRow-firstRow;
+               endInsertRows();
+            }
+         }
+         else if ( endRow > firstRow )
+         {
+            emit dataChanged(index(firstRow,0),index(endRow-1,CodeBrowserCol_Max-1));
+         }
+      }
+
+      // Breakpoints, markers and the execution pointer can be anywhere.
+      if ( m_rows )
+      {
+         emit dataChanged(index(0,CodeBrowserCol_Decoration),index(m_rows-1,CodeBrowserCol_Decoration));
+      }
    }
    else if ( !nesicideProject->getProjectTarget().compare("c64",Qt::CaseInsensitive) )
    {
       c64Disassemble();
-   }
 
-   emit layoutChanged();
+      emit layoutChanged();
+   }
 }
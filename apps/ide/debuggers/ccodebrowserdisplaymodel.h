@@ -34,6 +34,12 @@ public:
 private:
    CBreakpointInfo* m_pBreakpoints;
 
+   // What the view showed at the last update: the region the CPU was
+   // running in, the banks mapped there, and how many rows it had.
+   uint32_t m_viewRegion;
+   uint32_t m_viewBanks [ 4 ];
+   int      m_rows;
+
 public slots:
    void update(void);
 };
@@ -3,6 +3,8 @@
 #include "dbg_cnes.h"
 #include "dbg_cnes6502.h"
 
+#include <QTimer>
+
 static char modelStringBuffer [ 2048 ];
 
 void GetPrintable ( TracerInfo* pSample, int subItem, char* str );
@@ -10,12 +12,17 @@ void GetPrintable ( TracerInfo* pSample, int subItem, char* str );
 CDebuggerExecutionTracerModel::CDebuggerExecutionTracerModel(QObject*)
 {
    m_pTracer = nesGetExecutionTracerDatabase();
+   m_pView = new CTracerView(m_pTracer);
    m_bShowCPU = true;
    m_bShowPPU = true;
+   m_type = -1;
+   m_firstAddr = 0x0000;
+   m_lastAddr = 0xFFFF;
 }
 
 CDebuggerExecutionTracerModel::~CDebuggerExecutionTracerModel()
 {
+   delete m_pView;
 }
 
 QVariant CDebuggerExecutionTracerModel::data(const QModelIndex& index, int role) const
@@ -30,7 +37,15 @@ QVariant CDebuggerExecutionTracerModel::data(const QModelIndex& index, int role)
       return QVariant();
    }
 
-   GetPrintable((TracerInfo*)index.internalPointer(), index.column(), modelStringBuffer);
+   if ( (uint32_t)index.row() >= m_pView->GetNumRows() )
+   {
+      return QVariant();
+   }
+
+   TracerInfo sample;
+
+   m_pTracer->GetSample(m_pView->GetRowSlot(index.row()), &sample);
+   GetPrintable(&sample, index.column(), modelStringBuffer);
 
    return QVariant(modelStringBuffer);
 }
@@ -108,18 +123,7 @@ QModelIndex CDebuggerExecutionTracerModel::index(int row, int column, const QMod
 {
    if ( (row >= 0) && (column >= 0) )
    {
-      if ( (m_bShowCPU) && (m_bShowPPU) )
-      {
-         return createIndex(row, column, m_pTracer->GetSample(row));
-      }
-      else if ( m_bShowCPU )
-      {
-         return createIndex(row, column, m_pTracer->GetCPUSample(row));
-      }
-      else if ( m_bShowPPU )
-      {
-         return createIndex(row, column, m_pTracer->GetPPUSample(row));
-      }
+      return createIndex(row, column);
    }
 
    return QModelIndex();
@@ -127,22 +131,7 @@ QModelIndex CDebuggerExecutionTracerModel::index(int row, int column, const QMod
 
 int CDebuggerExecutionTracerModel::rowCount(const QModelIndex&) const
 {
-   int rows = 0;
-
-   if ( (m_bShowCPU) && (m_bShowPPU) )
-   {
-      rows = m_pTracer->GetNumSamples();
-   }
-   else if ( m_bShowCPU )
-   {
-      rows = m_pTracer->GetNumCPUSamples();
-   }
-   else if ( m_bShowPPU )
-   {
-      rows = m_pTracer->GetNumPPUSamples();
-   }
-
-   return rows;
+   return m_pView->GetNumRows();
 }
 
 int CDebuggerExecutionTracerModel::columnCount(const QModelIndex& parent) const
@@ -157,17 +146,149 @@ int CDebuggerExecutionTracerModel::columnCount(const QModelIndex& parent) const
 
 void CDebuggerExecutionTracerModel::update()
 {
+   // Index the new samples a batch at a time so a full tracer never holds
+   // up the UI; the rest are picked up once pending events are handled.
+   if ( m_pView->Update() )
+   {
+      QTimer::singleShot(0, this, SLOT(update()));
+   }
+
    emit layoutChanged();
 }
 
 void CDebuggerExecutionTracerModel::showCPU ( bool show )
 {
    m_bShowCPU = show;
+   setFilter();
 }
 
 void CDebuggerExecutionTracerModel::showPPU ( bool show )
 {
    m_bShowPPU = show;
+   setFilter();
+}
+
+void CDebuggerExecutionTracerModel::showType ( int type )
+{
+   m_type = type;
+   setFilter();
+}
+
+void CDebuggerExecutionTracerModel::showAddresses ( uint16_t first, uint16_t last )
+{
+   m_firstAddr = first;
+   m_lastAddr = last;
+   setFilter();
+}
+
+void CDebuggerExecutionTracerModel::setFilter ()
+{
+   TracerFilter filter;
+
+   CTracerView::ClearFilter(&filter);
+
+   // Everything that is not the PPU counts as the CPU.
+   filter.sourceMask = 0;
+   if ( m_bShowCPU )
+   {
+      filter.sourceMask |= ~(1<<eNESSource_PPU);
+   }
+   if ( m_bShowPPU )
+   {
+      filter.sourceMask |= (1<<eNESSource_PPU);
+   }
+   if ( m_type >= 0 )
+   {
+      filter.typeMask = (1<<m_type);
+   }
+   filter.firstAddr = m_firstAddr;
+   filter.lastAddr = m_lastAddr;
+
+   m_pView->SetFilter(filter);
+}
+
+int CDebuggerExecutionTracerModel::find ( int startRow, int type, int addr, bool backwards ) const
+{
+   TracerFilter filter;
+
+   if ( startRow < 0 )
+   {
+      return -1;
+   }
+
+   CTracerView::ClearFilter(&filter);
+   if ( type >= 0 )
+   {
+      filter.typeMask = (1<<type);
+   }
+   if ( addr >= 0 )
+   {
+      filter.firstAddr = addr;
+      filter.lastAddr = addr;
+   }
+
+   return m_pView->Find(startRow, filter, backwards);
+}
+
+const char* CDebuggerExecutionTracerModel::typeName ( int type )
+{
+   switch ( type )
+   {
+      case eTracer_OperandFetch:
+         return "Operand Fetch";
+      case eTracer_InstructionFetch:
+         return "Instruction Fetch";
+      case eTracer_ExtraInstructionFetch:
+         return "Extra Fetch";
+      case eTracer_StolenCycle:
+         return "DMA Stolen Cycle";
+      case eTracer_DataRead:
+         return "Memory Read";
+      case eTracer_DataWrite:
+         return "Memory Write";
+      case eTracer_DMA:
+         return "DMA";
+      case eTracer_RESET:
+         return "RESET";
+      case eTracer_NMI:
+         return "NMI";
+      case eTracer_IRQ:
+         return "IRQ";
+      case eTracer_IRQRelease:
+         return "IRQ Released";
+      case eTracer_GarbageRead:
+         return "Garbage Fetch";
+      case eTracer_RenderBkgnd:
+         return "Playfield Render";
+      case eTracer_RenderSprite:
+         return "Sprite Render";
+      case eTracer_Sprite0Hit:
+         return "Sprite 0 Hit";
+      case eTracer_StartPPUFrame:
+         return "Frame Start";
+      case eTracer_VBLANKStart:
+         return "VBLANK Start";
+      case eTracer_VBLANKEnd:
+         return "VBLANK End";
+      case eTracer_PreRenderStart:
+         return "Pre-render Scanline Start";
+      case eTracer_PreRenderEnd:
+         return "Pre-render Scanline End";
+      case eTracer_QuietStart:
+         return "Post-render Scanline Start";
+      case eTracer_QuietEnd:
+         return "Post-render Scanline End";
+      case eTracer_EndPPUFrame:
+         return "Frame End";
+      case eTracer_StartAPUFrame:
+         return "Frame Start";
+      case eTracer_SequencerStep:
+         return "Sequencer Step";
+      case eTracer_EndAPUFrame:
+         return "Frame End";
+   }
+
+   return "";
 }
 
 void GetPrintable ( TracerInfo* pSample, int subItem, char* str )
@@ -202,92 +323,7 @@ void GetPrintable ( TracerInfo* pSample, int subItem, char* str )
 
             break;
          case eTracerCol_Type:
-
-            switch ( pSample->type )
-            {
-               case eTracer_Unknown:
-                  str[0] = 0;
-                  break;
-               case eTracer_OperandFetch:
-                  strcpy ( str, "Operand Fetch" );
-                  break;
-               case eTracer_InstructionFetch:
-                  strcpy ( str, "Instruction Fetch" );
-                  break;
-               case eTracer_ExtraInstructionFetch:
-                  strcpy ( str, "Extra Fetch" );
-                  break;
-               case eTracer_StolenCycle:
-                  strcpy ( str, "DMA Stolen Cycle" );
-                  break;
-               case eTracer_DataRead:
-                  strcpy ( str, "Memory Read" );
-                  break;
-               case eTracer_DataWrite:
-                  strcpy ( str, "Memory Write" );
-                  break;
-               case eTracer_DMA:
-                  strcpy ( str, "DMA" );
-                  break;
-               case eTracer_RESET:
-                  strcpy ( str, "RESET" );
-                  break;
-               case eTracer_NMI:
-                  strcpy ( str, "NMI" );
-                  break;
-               case eTracer_IRQ:
-                  strcpy ( str, "IRQ" );
-                  break;
-               case eTracer_IRQRelease:
-                  strcpy ( str, "IRQ Released" );
-                  break;
-               case eTracer_GarbageRead:
-                  strcpy ( str, "Garbage Fetch" );
-                  break;
-               case eTracer_RenderBkgnd:
-                  strcpy ( str, "Playfield Render" );
-                  break;
-               case eTracer_RenderSprite:
-                  strcpy ( str, "Sprite Render" );
-                  break;
-               case eTracer_Sprite0Hit:
-                  strcpy ( str, "Sprite 0 Hit" );
-                  break;
-               case eTracer_StartPPUFrame:
-                  strcpy ( str, "Frame Start" );
-                  break;
-               case eTracer_VBLANKStart:
-                  strcpy ( str, "VBLANK Start" );
-                  break;
-               case eTracer_VBLANKEnd:
-                  strcpy ( str, "VBLANK End" );
-                  break;
-               case eTracer_PreRenderStart:
-                  strcpy ( str, "Pre-render Scanline Start" );
-                  break;
-               case eTracer_PreRenderEnd:
-                  strcpy ( str, "Pre-render Scanline End" );
-                  break;
-               case eTracer_QuietStart:
-                  strcpy ( str, "Post-render Scanline Start" );
-                  break;
-               case eTracer_QuietEnd:
-                  strcpy ( str, "Post-render Scanline End" );
-                  break;
-               case eTracer_EndPPUFrame:
-                  strcpy ( str, "Frame End" );
-                  break;
-               case eTracer_StartAPUFrame:
-                  strcpy ( str, "Frame Start" );
-                  break;
-               case eTracer_SequencerStep:
-                  strcpy ( str, "Sequencer Step" );
-                  break;
-               case eTracer_EndAPUFrame:
-                  strcpy ( str, "Frame End" );
-                  break;
-            }
-
+            strcpy ( str, CDebuggerExecutionTracerModel::typeName(pSample->type) );
             break;
          case eTracerCol_Target:
 
@@ -20,14 +20,30 @@ public:
    int columnCount(const QModelIndex& parent = QModelIndex()) const;
    void showCPU ( bool show );
    void showPPU ( bool show );
-   
+   // Only show samples of this type, or of any type if type is -1.
+   void showType ( int type );
+   // Only show samples with an address from first to last.
+   void showAddresses ( uint16_t first, uint16_t last );
+   // Row at or after startRow (before it if backwards is set) whose sample
+   // is of the type and at the address; -1 for either means any.  Returns
+   // -1 if there is no such row.
+   int find ( int startRow, int type, int addr, bool backwards = false ) const;
+
+   static const char* typeName ( int type );
+
 public slots:
    void update();
 
 private:
+   void setFilter ();
+
    CTracer* m_pTracer;
+   CTracerView* m_pView;
    bool    m_bShowCPU;
    bool    m_bShowPPU;
+   int     m_type;
+   uint16_t m_firstAddr;
+   uint16_t m_lastAddr;
 };
 
 #endif // CDEBUGGEREXECUTIONTRACERMODEL_H
@@ -4,6 +4,10 @@
 
 #include "main.h"
 
+#include <QElapsedTimer>
+
+QAtomicInteger<qint64> DebuggerUpdateThread::_busyNsecs;
+
 DebuggerUpdateThread::DebuggerUpdateThread(void (*func)(),QObject */*parent*/) :
     QObject(),_func(func)
 {
@@ -24,8 +28,12 @@ DebuggerUpdateThread::~DebuggerUpdateThread()
 
 void DebuggerUpdateThread::updateDebuggers()
 {
+   QElapsedTimer timer;
+
+   timer.start();
    if ( _func )
       _func();
+   _busyNsecs.fetchAndAddRelaxed(timer.nsecsElapsed());
 
    emit updateComplete();
 }
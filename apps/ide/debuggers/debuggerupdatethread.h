@@ -2,6 +2,7 @@
 #define DEBUGGERUPDATETHREAD_H
 
 #include <QThread>
+#include <QAtomicInteger>
 
 class DebuggerUpdateThread : public QObject
 {
@@ -12,6 +13,10 @@ public:
 
    void changeFunction(void (*func)()) { _func = func; }
 
+   // Time spent in update functions, across every update thread, since
+   // the last call.
+   static qint64 takeBusyNsecs() { return _busyNsecs.fetchAndStoreRelaxed(0); }
+
 signals:
    void updateComplete();
 
@@ -21,6 +26,7 @@ public slots:
 private:
    void (*_func)();
    QThread* pThread;
+   static QAtomicInteger<qint64> _busyNsecs;
 };
 
 #endif // DEBUGGERUPDATETHREAD_H
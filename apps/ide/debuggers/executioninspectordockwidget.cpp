@@ -10,12 +10,23 @@ ExecutionInspectorDockWidget::ExecutionInspectorDockWidget(QWidget *parent) :
     CDebuggerBase(parent),
     ui(new Ui::ExecutionInspectorDockWidget)
 {
+   int type;
+
    ui->setupUi(this);
    model = new CDebuggerExecutionTracerModel(this);
    model->showCPU ( true );
    model->showPPU ( true );
    ui->showCPU->setChecked(true);
    ui->showPPU->setChecked(true);
+
+   ui->showType->addItem("All Types", -1);
+   ui->findType->addItem("Any Type", -1);
+   for ( type = eTracer_InstructionFetch; type <= eTracer_EndAPUFrame; type++ )
+   {
+      ui->showType->addItem(CDebuggerExecutionTracerModel::typeName(type), type);
+      ui->findType->addItem(CDebuggerExecutionTracerModel::typeName(type), type);
+   }
+
    ui->tableView->setModel(model);
 }
 
@@ -125,6 +136,64 @@ void ExecutionInspectorDockWidget::on_showPPU_toggled(bool checked)
    model->update();
 }
 
+void ExecutionInspectorDockWidget::on_showType_currentIndexChanged(int index)
+{
+   model->showType ( ui->showType->itemData(index).toInt() );
+   model->update();
+}
+
+void ExecutionInspectorDockWidget::on_showAddress_editingFinished()
+{
+   QStringList range = ui->showAddress->text().split('-');
+   uint16_t first = 0x0000;
+   uint16_t last = 0xFFFF;
+
+   if ( !range.at(0).trimmed().isEmpty() )
+   {
+      first = range.at(0).toInt(0,16);
+      last = first;
+      if ( range.count() > 1 )
+      {
+         last = range.at(1).toInt(0,16);
+      }
+   }
+
+   model->showAddresses ( first, last );
+   model->update();
+}
+
+void ExecutionInspectorDockWidget::find(bool backwards)
+{
+   int type = ui->findType->itemData(ui->findType->currentIndex()).toInt();
+   int addr = -1;
+   int row;
+
+   if ( !ui->findAddress->text().isEmpty() )
+   {
+      addr = ui->findAddress->text().toInt(0,16);
+   }
+
+   // Start just past the current row so repeated finds move along.
+   row = ui->tableView->currentIndex().isValid() ? ui->tableView->currentIndex().row() : -1;
+   row = backwards ? row-1 : row+1;
+
+   row = model->find ( row, type, addr, backwards );
+   if ( row >= 0 )
+   {
+      ui->tableView->setCurrentIndex(model->index(row,0));
+   }
+}
+
+void ExecutionInspectorDockWidget::on_findPrevious_clicked()
+{
+   find(true);
+}
+
+void ExecutionInspectorDockWidget::on_findNext_clicked()
+{
+   find(false);
+}
+
 void ExecutionInspectorDockWidget::on_actionBreak_on_CPU_execution_here_triggered()
 {
 }
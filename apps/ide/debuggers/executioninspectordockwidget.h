@@ -28,6 +28,8 @@ public slots:
    void updateTargetMachine(QString target);
 
 private:
+   void find(bool backwards);
+
    Ui::ExecutionInspectorDockWidget *ui;
    CDebuggerExecutionTracerModel* model;
 
@@ -35,6 +37,10 @@ private slots:
    void on_actionBreak_on_CPU_execution_here_triggered();
    void on_showCPU_toggled(bool checked);
    void on_showPPU_toggled(bool checked);
+   void on_showType_currentIndexChanged(int index);
+   void on_showAddress_editingFinished();
+   void on_findPrevious_clicked();
+   void on_findNext_clicked();
 };
 
 #endif // EXECUTIONINSPECTORDOCKWIDGET_H
@@ -660,6 +660,8 @@ void MainWindow::createNesUi()
    actionJoypadLogger_Inspector->setEnabled(false);
    actionCodeDataLogger_Inspector = new QAction("Code/Data Log Visualizer",this);
    actionCodeDataLogger_Inspector->setObjectName(QString::fromUtf8("actionCodeDataLogger_Inspector"));
+   actionEmulatorPerformance_Inspector = new QAction("Emulator Performance",this);
+   actionEmulatorPerformance_Inspector->setObjectName(QString::fromUtf8("actionEmulatorPerformance_Inspector"));
    actionExecution_Visualizer_Inspector = new QAction("Execution Visualizer",this);
    actionExecution_Visualizer_Inspector->setObjectName(QString::fromUtf8("actionExecution_Visualizer_Inspector"));
    actionMapperInformation_Inspector = new QAction("Information",this);
@@ -795,6 +797,7 @@ void MainWindow::createNesUi()
    menuDebugger->addSeparator();
    menuDebugger->addAction(actionExecution_Visualizer_Inspector);
    menuDebugger->addAction(actionCodeDataLogger_Inspector);
+   menuDebugger->addAction(actionEmulatorPerformance_Inspector);
    menuDebugger->addSeparator();
    menuDebugger->addAction(menuCPU_Inspectors->menuAction());
    menuDebugger->addAction(menuPPU_Inspectors->menuAction());
@@ -962,6 +965,13 @@ void MainWindow::createNesUi()
    QObject::connect(m_pCodeDataLoggerInspector,SIGNAL(markProjectDirty(bool)),this,SLOT(markProjectDirty(bool)));
    CDockWidgetRegistry::addWidget ( "Code/Data Logger Inspector", m_pCodeDataLoggerInspector );
 
+   m_pEmulatorPerformanceInspector = new EmulatorPerformanceDockWidget();
+   QObject::connect(this,SIGNAL(updateTargetMachine(QString)),m_pEmulatorPerformanceInspector,SLOT(updateTargetMachine(QString)));
+   addDockWidget(Qt::BottomDockWidgetArea, m_pEmulatorPerformanceInspector );
+   m_pEmulatorPerformanceInspector->hide();
+   QObject::connect(m_pEmulatorPerformanceInspector,SIGNAL(markProjectDirty(bool)),this,SLOT(markProjectDirty(bool)));
+   CDockWidgetRegistry::addWidget ( "Emulator Performance", m_pEmulatorPerformanceInspector );
+
    m_pBinCPURegisterInspector = new RegisterInspectorDockWidget(nesGetCpuRegisterDatabase,nesGetBreakpointDatabase());
    QObject::connect(this,SIGNAL(updateTargetMachine(QString)),m_pBinCPURegisterInspector,SLOT(updateTargetMachine(QString)));
    m_pBinCPURegisterInspector->setObjectName("cpuRegisterInspector");
@@ -1134,6 +1144,7 @@ void MainWindow::createNesUi()
    QObject::connect(actionRun_Test_Suite,SIGNAL(triggered()),this,SLOT(actionRun_Test_Suite_triggered()));
    QObject::connect(actionConfigure,SIGNAL(triggered()),this,SLOT(actionConfigure_triggered()));
    QObject::connect(actionCodeDataLogger_Inspector,SIGNAL(triggered()),this,SLOT(actionCodeDataLogger_Inspector_triggered()));
+   QObject::connect(actionEmulatorPerformance_Inspector,SIGNAL(triggered()),this,SLOT(actionEmulatorPerformance_Inspector_triggered()));
    QObject::connect(actionExecution_Visualizer_Inspector,SIGNAL(triggered()),this,SLOT(actionExecution_Visualizer_Inspector_triggered()));
    QObject::connect(actionGfxCHRMemory_Inspector,SIGNAL(triggered()),this,SLOT(actionGfxCHRMemory_Inspector_triggered()));
    QObject::connect(actionGfxOAMMemory_Inspector,SIGNAL(triggered()),this,SLOT(actionGfxOAMMemory_Inspector_triggered()));
@@ -1187,6 +1198,7 @@ void MainWindow::destroyNesUi()
    CDockWidgetRegistry::removeWidget ( "Name Table Visualizer" );
    CDockWidgetRegistry::removeWidget ( "Execution Visualizer" );
    CDockWidgetRegistry::removeWidget ( "Code/Data Logger Inspector" );
+   CDockWidgetRegistry::removeWidget ( "Emulator Performance" );
    CDockWidgetRegistry::removeWidget ( "CPU Register Inspector" );
    CDockWidgetRegistry::removeWidget ( "CPU RAM Inspector" );
    CDockWidgetRegistry::removeWidget ( "PRG-ROM Inspector" );
@@ -1230,6 +1242,8 @@ void MainWindow::destroyNesUi()
    delete m_pExecutionVisualizer;
    removeDockWidget(m_pCodeDataLoggerInspector);
    delete m_pCodeDataLoggerInspector;
+   removeDockWidget(m_pEmulatorPerformanceInspector);
+   delete m_pEmulatorPerformanceInspector;
    removeDockWidget(m_pBinCPURegisterInspector);
    delete m_pBinCPURegisterInspector;
    removeDockWidget(m_pBinCPURAMInspector);
@@ -1294,6 +1308,7 @@ void MainWindow::destroyNesUi()
    delete actionPPUInformation_Inspector;
    delete actionJoypadLogger_Inspector;
    delete actionCodeDataLogger_Inspector;
+   delete actionEmulatorPerformance_Inspector;
    delete actionExecution_Visualizer_Inspector;
    delete actionMapperInformation_Inspector;
    delete actionAPUInformation_Inspector;
@@ -2739,6 +2754,11 @@ void MainWindow::actionCodeDataLogger_Inspector_triggered()
    m_pCodeDataLoggerInspector->setVisible(true);
 }
 
+void MainWindow::actionEmulatorPerformance_Inspector_triggered()
+{
+   m_pEmulatorPerformanceInspector->setVisible(true);
+}
+
 void MainWindow::actionPPUInformation_Inspector_triggered()
 {
    m_pPPUInformationInspector->setVisible(true);
@@ -3351,6 +3371,8 @@ void MainWindow::updateFromEmulatorPrefs(bool initial)
       actionWave_7N106->setChecked(wave7N106);
       actionWave_8N106->setChecked(wave8N106);
       nesSetN106AudioChannelMask(mask);
+
+      nesSetAudioSynthesis(EmulatorPrefsDialog::getBandLimitedAudio()?AUDIO_SYNTHESIS_BANDLIMITED:AUDIO_SYNTHESIS_AVERAGE);
    }
 
    if ( initial || EmulatorPrefsDialog::videoSettingsChanged() )
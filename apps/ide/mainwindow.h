@@ -19,6 +19,7 @@
 #include "breakpointdockwidget.h"
 #include "codebrowserdockwidget.h"
 #include "codedataloggerdockwidget.h"
+#include "emulatorperformancedockwidget.h"
 #include "ppuinformationdockwidget.h"
 #include "apuinformationdockwidget.h"
 #include "mapperinformationdockwidget.h"
@@ -119,6 +120,7 @@ protected:
    MemoryInspectorDockWidget* m_pBinPaletteMemoryInspector;
    RegisterInspectorDockWidget* m_pBinMapperMemoryInspector;
    CodeDataLoggerDockWidget* m_pCodeDataLoggerInspector;
+   EmulatorPerformanceDockWidget* m_pEmulatorPerformanceInspector;
    PPUInformationDockWidget* m_pPPUInformationInspector;
    APUInformationDockWidget* m_pAPUInformationInspector;
    MapperInformationDockWidget* m_pMapperInformationInspector;
@@ -150,6 +152,7 @@ protected:
    QAction *actionPPUInformation_Inspector;
    QAction *actionJoypadLogger_Inspector;
    QAction *actionCodeDataLogger_Inspector;
+   QAction *actionEmulatorPerformance_Inspector;
    QAction *actionExecution_Visualizer_Inspector;
    QAction *actionMapperInformation_Inspector;
    QAction *actionAPUInformation_Inspector;
@@ -314,6 +317,7 @@ private slots:
    void actionDendy_triggered();
    void actionRun_Test_Suite_triggered();
    void actionCodeDataLogger_Inspector_triggered();
+   void actionEmulatorPerformance_Inspector_triggered();
    void actionExecution_Visualizer_Inspector_triggered();
    void actionGfxCHRMemory_Inspector_triggered();
    void actionGfxOAMMemory_Inspector_triggered();
@@ -0,0 +1,220 @@
+#include "emulatorperformancedockwidget.h"
+#include "ui_emulatorperformancedockwidget.h"
+
+#include "debuggerupdatethread.h"
+
+#include "cobjectregistry.h"
+#include "main.h"
+
+// Frames averaged for each refresh of the table.
+#define BREAKDOWN_FRAMES 60
+
+// What the graph and table show: the core's counters, then whatever else
+// the emulator thread did in the frame, the time debugger updates took
+// on their own threads and the time the emulator thread sat in a hook.
+// Waiting is only in the table; it is not work.
+enum
+{
+   Part_Other = eNESPerf_Count,
+   Part_Debugger,
+   Part_Waiting,
+   Part_Count
+};
+
+static const char* partNames [ Part_Count ] =
+{
+   "CPU",
+   "PPU rendering",
+   "APU",
+   "Tracer",
+   "Code/Data Logger",
+   "Breakpoints",
+   "Other emulation",
+   "Debugger updates",
+   "Waiting in hooks"
+};
+
+static const QRgb partColors [ Part_Waiting ] =
+{
+   0x4080FF,
+   0x40C040,
+   0xE0A020,
+   0xC040C0,
+   0x40C0C0,
+   0xE04040,
+   0x808080,
+   0xF0F0F0
+};
+
+EmulatorPerformanceDockWidget::EmulatorPerformanceDockWidget(QWidget *parent) :
+    CDebuggerBase(parent),
+    ui(new Ui::EmulatorPerformanceDockWidget),
+    lastFrame(0xFFFFFFFF),
+    sumFrames(0),
+    sumMsecs(Part_Count,0.0),
+    sumCalls(eNESPerf_Count,0.0)
+{
+   QStringList names;
+   QVector<QColor> colors;
+   int part;
+
+   ui->setupUi(this);
+
+   graph = new EmulatorPerformanceGraph(ui->frame);
+   ui->frame->layout()->addWidget(graph);
+   ui->frame->layout()->update();
+
+   for ( part = 0; part < Part_Waiting; part++ )
+   {
+      names.append(partNames[part]);
+      colors.append(QColor(partColors[part]));
+   }
+   graph->setSeries(names,colors);
+
+   ui->breakdown->setRowCount(Part_Count+1);
+   for ( part = 0; part <= Part_Count; part++ )
+   {
+      ui->breakdown->setItem(part,0,new QTableWidgetItem((part < Part_Count) ? partNames[part] : "Emulator thread"));
+      ui->breakdown->setItem(part,1,new QTableWidgetItem());
+      ui->breakdown->setItem(part,2,new QTableWidgetItem());
+   }
+   ui->breakdown->resizeColumnsToContents();
+}
+
+EmulatorPerformanceDockWidget::~EmulatorPerformanceDockWidget()
+{
+   delete ui;
+   delete graph;
+}
+
+void EmulatorPerformanceDockWidget::updateTargetMachine(QString /*target*/)
+{
+   QObject* emulator = CObjectRegistry::getObject("Emulator");
+
+   QObject::connect(emulator,SIGNAL(emulatorReset()),this,SLOT(emulatorReset()));
+}
+
+void EmulatorPerformanceDockWidget::changeEvent(QEvent* e)
+{
+   CDebuggerBase::changeEvent(e);
+
+   switch (e->type())
+   {
+      case QEvent::LanguageChange:
+         ui->retranslateUi(this);
+         break;
+      default:
+         break;
+   }
+}
+
+void EmulatorPerformanceDockWidget::showEvent(QShowEvent* /*event*/)
+{
+   QObject* emulator = CObjectRegistry::getObject("Emulator");
+   NesPerfCounters counters;
+
+   QObject::connect(emulator,SIGNAL(emulatedFrame()),this,SLOT(emulatedFrame()));
+
+   if ( nesGetPerfCounters(&counters) )
+   {
+      ui->status->setText("");
+   }
+   else
+   {
+      ui->status->setText("The emulator library was built without NES_PERF_COUNTERS, "
+                          "so only debugger updates are shown.");
+   }
+
+   // Don't count debugger updates from while nobody was looking.
+   DebuggerUpdateThread::takeBusyNsecs();
+}
+
+void EmulatorPerformanceDockWidget::hideEvent(QHideEvent* /*event*/)
+{
+   QObject* emulator = CObjectRegistry::getObject("Emulator");
+
+   QObject::disconnect(emulator,SIGNAL(emulatedFrame()),this,SLOT(emulatedFrame()));
+}
+
+void EmulatorPerformanceDockWidget::emulatorReset()
+{
+   int part;
+
+   graph->clear();
+   lastFrame = 0xFFFFFFFF;
+   sumFrames = 0;
+   for ( part = 0; part < Part_Count; part++ )
+   {
+      sumMsecs[part] = 0.0;
+   }
+   for ( part = 0; part < eNESPerf_Count; part++ )
+   {
+      sumCalls[part] = 0.0;
+   }
+}
+
+void EmulatorPerformanceDockWidget::emulatedFrame()
+{
+   NesPerfCounters counters;
+   QVector<double> msecs(Part_Waiting,0.0);
+   double other;
+   int part;
+
+   // The emulator thread may have run several frames since it queued
+   // this; only the last one's counters are still there.
+   nesGetPerfCounters(&counters);
+   if ( counters.frame == lastFrame )
+   {
+      return;
+   }
+   lastFrame = counters.frame;
+
+   other = counters.frameNs/1000000.0;
+   for ( part = 0; part < eNESPerf_Count; part++ )
+   {
+      msecs[part] = counters.ns[part]/1000000.0;
+      other -= msecs[part];
+      sumCalls[part] += counters.calls[part];
+   }
+   msecs[Part_Other] = (other > 0.0) ? other : 0.0;
+   msecs[Part_Debugger] = DebuggerUpdateThread::takeBusyNsecs()/1000000.0;
+
+   for ( part = 0; part < Part_Waiting; part++ )
+   {
+      sumMsecs[part] += msecs[part];
+   }
+   sumMsecs[Part_Waiting] += counters.waitNs/1000000.0;
+
+   graph->setBudget((nesGetSystemMode() == MODE_NTSC) ? (1000.0/60.0) : (1000.0/50.0));
+   graph->addFrame(msecs);
+
+   sumFrames++;
+   if ( sumFrames == BREAKDOWN_FRAMES )
+   {
+      updateBreakdown();
+   }
+}
+
+void EmulatorPerformanceDockWidget::updateBreakdown()
+{
+   double total = 0.0;
+   int part;
+
+   for ( part = 0; part < Part_Count; part++ )
+   {
+      ui->breakdown->item(part,1)->setText(QString::number(sumMsecs[part]/sumFrames,'f',3));
+      if ( part < eNESPerf_Count )
+      {
+         ui->breakdown->item(part,2)->setText(QString::number(sumCalls[part]/sumFrames,'f',0));
+         sumCalls[part] = 0.0;
+      }
+      if ( part <= Part_Other )
+      {
+         total += sumMsecs[part];
+      }
+      sumMsecs[part] = 0.0;
+   }
+   ui->breakdown->item(Part_Count,1)->setText(QString::number(total/sumFrames,'f',3));
+
+   sumFrames = 0;
+}
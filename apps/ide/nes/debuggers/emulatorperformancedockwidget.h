@@ -0,0 +1,41 @@
+#ifndef EMULATORPERFORMANCEDOCKWIDGET_H
+#define EMULATORPERFORMANCEDOCKWIDGET_H
+
+#include "cdebuggerbase.h"
+
+#include "emulatorperformancegraph.h"
+
+namespace Ui {
+   class EmulatorPerformanceDockWidget;
+}
+
+class EmulatorPerformanceDockWidget : public CDebuggerBase
+{
+   Q_OBJECT
+
+public:
+   explicit EmulatorPerformanceDockWidget(QWidget *parent = 0);
+   virtual ~EmulatorPerformanceDockWidget();
+
+protected:
+   void showEvent(QShowEvent* event);
+   void hideEvent(QHideEvent* event);
+   void changeEvent(QEvent* e);
+
+public slots:
+   void emulatedFrame();
+   void emulatorReset();
+   void updateTargetMachine(QString target);
+
+private:
+   void updateBreakdown();
+
+   Ui::EmulatorPerformanceDockWidget *ui;
+   EmulatorPerformanceGraph* graph;
+   uint32_t lastFrame;
+   int sumFrames;
+   QVector<double> sumMsecs;
+   QVector<double> sumCalls;
+};
+
+#endif // EMULATORPERFORMANCEDOCKWIDGET_H
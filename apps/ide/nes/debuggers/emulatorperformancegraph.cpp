@@ -0,0 +1,120 @@
+#include "emulatorperformancegraph.h"
+
+#include <QPainter>
+
+// Frames of history kept.
+#define GRAPH_FRAMES 240
+
+EmulatorPerformanceGraph::EmulatorPerformanceGraph(QWidget *parent) :
+   QWidget(parent),
+   m_frames(GRAPH_FRAMES),
+   m_next(0),
+   m_count(0),
+   m_budget(0.0)
+{
+   setMinimumSize(GRAPH_FRAMES,100);
+}
+
+void EmulatorPerformanceGraph::setSeries(QStringList names, QVector<QColor> colors)
+{
+   m_names = names;
+   m_colors = colors;
+   clear();
+}
+
+void EmulatorPerformanceGraph::addFrame(const QVector<double>& msecs)
+{
+   m_frames[m_next] = msecs;
+   m_next = (m_next+1)%GRAPH_FRAMES;
+   if ( m_count < GRAPH_FRAMES )
+   {
+      m_count++;
+   }
+   update();
+}
+
+void EmulatorPerformanceGraph::clear()
+{
+   m_next = 0;
+   m_count = 0;
+   update();
+}
+
+void EmulatorPerformanceGraph::paintEvent(QPaintEvent */*event*/)
+{
+   QPainter p(this);
+   int w = width();
+   int h = height();
+   double top = m_budget*1.5;
+   double barWidth = (double)w/GRAPH_FRAMES;
+   int frame;
+   int series;
+
+   p.fillRect(rect(),Qt::black);
+
+   // Scale to the slowest frame shown, but never so far that the budget
+   // line runs off the top.
+   for ( frame = 0; frame < m_count; frame++ )
+   {
+      const QVector<double>& msecs = m_frames[frame];
+      double total = 0.0;
+
+      for ( series = 0; series < msecs.count(); series++ )
+      {
+         total += msecs[series];
+      }
+      if ( total > top )
+      {
+         top = total;
+      }
+   }
+   if ( top <= 0.0 )
+   {
+      top = 1.0;
+   }
+
+   // Oldest frame on the left, newest on the right.
+   for ( frame = 0; frame < m_count; frame++ )
+   {
+      const QVector<double>& msecs = m_frames[(m_next+GRAPH_FRAMES-m_count+frame)%GRAPH_FRAMES];
+      double x = w-((m_count-frame)*barWidth);
+      double y = h;
+
+      for ( series = 0; (series < msecs.count()) && (series < m_colors.count()); series++ )
+      {
+         double bar = (msecs[series]*h)/top;
+
+         p.fillRect(QRectF(x,y-bar,barWidth,bar),m_colors[series]);
+         y -= bar;
+      }
+   }
+
+   if ( m_budget > 0.0 )
+   {
+      int y = h-(int)((m_budget*h)/top);
+
+      p.setPen(QPen(Qt::white,0,Qt::DashLine));
+      p.drawLine(0,y,w,y);
+      p.drawText(4,y-2,QString::number(m_budget,'f',1)+" ms");
+   }
+
+   // Legend.
+   QFontMetrics metrics(p.font());
+   int x = 4;
+   int y = 4;
+
+   for ( series = 0; (series < m_names.count()) && (series < m_colors.count()); series++ )
+   {
+      int text = metrics.width(m_names[series]);
+
+      if ( (x > 4) && (x+text+16 > w) )
+      {
+         x = 4;
+         y += metrics.height()+2;
+      }
+      p.fillRect(x,y+2,8,metrics.height()-4,m_colors[series]);
+      p.setPen(Qt::white);
+      p.drawText(x+12,y+metrics.ascent(),m_names[series]);
+      x += text+24;
+   }
+}
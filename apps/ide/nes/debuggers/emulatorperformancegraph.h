@@ -0,0 +1,35 @@
+#ifndef EMULATORPERFORMANCEGRAPH_H
+#define EMULATORPERFORMANCEGRAPH_H
+
+#include <QWidget>
+#include <QStringList>
+#include <QVector>
+#include <QColor>
+
+// Scrolling history of per-frame times, one stacked bar per frame with a
+// band for each series.  The newest frame is on the right; a line marks
+// the time one frame has to take for the emulator to keep up.
+class EmulatorPerformanceGraph : public QWidget
+{
+   Q_OBJECT
+public:
+   explicit EmulatorPerformanceGraph(QWidget *parent = 0);
+
+   void setSeries(QStringList names, QVector<QColor> colors);
+   void setBudget(double msecs) { m_budget = msecs; }
+   void addFrame(const QVector<double>& msecs);
+   void clear();
+
+protected:
+   void paintEvent(QPaintEvent *event);
+
+private:
+   QStringList m_names;
+   QVector<QColor> m_colors;
+   QVector<QVector<double> > m_frames;
+   int m_next;
+   int m_count;
+   double m_budget;
+};
+
+#endif // EMULATORPERFORMANCEGRAPH_H
@@ -34,6 +34,7 @@ NESEmulatorDockWidget::NESEmulatorDockWidget(QWidget *parent) :
 
    m_joy [ CONTROLLER1 ] = 0;
    m_joy [ CONTROLLER2 ] = 0;
+   m_isFastForwarding = false;
 
    // Clear image to set alpha channel...
    for ( i = 0; i < 256*256*4; i+=4 )
@@ -89,6 +90,9 @@ void NESEmulatorDockWidget::updateTargetMachine(QString target)
    if ( !target.compare("nes") )
    {
       QObject::connect(this,SIGNAL(controllerInput(uint32_t*)),emulator,SLOT(controllerInput(uint32_t*)));
+      QObject::connect(this,SIGNAL(rewind(bool)),emulator,SLOT(rewindEmulation(bool)));
+      QObject::connect(this,SIGNAL(fastForward(bool)),emulator,SLOT(fastForwardEmulation(bool)));
+      QObject::connect(emulator,SIGNAL(emulationRate(int)),this,SLOT(emulationRate(int)));
    }
    QObject::connect(emulator, SIGNAL(emulatedFrame()), this, SLOT(renderData()));
    QObject::connect(breakpointWatcher, SIGNAL(breakpointHit()), this, SLOT(renderData()));
@@ -178,6 +182,30 @@ void NESEmulatorDockWidget::mouseReleaseEvent(QMouseEvent* event)
 
 void NESEmulatorDockWidget::keyPressEvent(QKeyEvent* event)
 {
+   // Hold Backspace to rewind.
+   if ( event->key() == Qt::Key_Backspace )
+   {
+      if ( !event->isAutoRepeat() )
+      {
+         emit rewind(true);
+      }
+      event->accept();
+      return;
+   }
+
+   // Hold Tab to fast-forward.
+   if ( event->key() == Qt::Key_Tab )
+   {
+      if ( !event->isAutoRepeat() )
+      {
+         m_isFastForwarding = true;
+         renderer->setOSD(">>");
+         emit fastForward(true);
+      }
+      event->accept();
+      return;
+   }
+
    if ( EmulatorPrefsDialog::getControllerType(CONTROLLER1) == IO_TurboJoypad )
    {
       if ( event->key() == EmulatorPrefsDialog::getControllerKeyMap(CONTROLLER1,IO_TurboJoypad_ATURBO) )
@@ -309,6 +337,28 @@ void NESEmulatorDockWidget::keyPressEvent(QKeyEvent* event)
 
 void NESEmulatorDockWidget::keyReleaseEvent(QKeyEvent* event)
 {
+   if ( event->key() == Qt::Key_Backspace )
+   {
+      if ( !event->isAutoRepeat() )
+      {
+         emit rewind(false);
+      }
+      event->accept();
+      return;
+   }
+
+   if ( event->key() == Qt::Key_Tab )
+   {
+      if ( !event->isAutoRepeat() )
+      {
+         m_isFastForwarding = false;
+         renderer->setOSD("");
+         emit fastForward(false);
+      }
+      event->accept();
+      return;
+   }
+
    if ( EmulatorPrefsDialog::getControllerType(CONTROLLER1) == IO_TurboJoypad )
    {
       if ( event->key() == EmulatorPrefsDialog::getControllerKeyMap(CONTROLLER1,IO_TurboJoypad_ATURBO) )
@@ -442,3 +492,16 @@ void NESEmulatorDockWidget::renderData()
 {
    renderer->updateGL();
 }
+
+void NESEmulatorDockWidget::emulationRate(int fps)
+{
+   float nominal = (nesGetSystemMode()==MODE_NTSC)?60.0f:50.0f;
+   QString str;
+
+   // A rate can still be on its way after fast-forward stops.
+   if ( m_isFastForwarding )
+   {
+      str.sprintf(">> %d fps (%.1fx)",fps,(float)fps/nominal);
+      renderer->setOSD(str);
+   }
+}
@@ -29,19 +29,25 @@ protected:
    void mouseReleaseEvent(QMouseEvent* event);
    void keyPressEvent(QKeyEvent* event);
    void keyReleaseEvent(QKeyEvent* event);
+   // Tab is the fast-forward key, not a focus change.
+   bool focusNextPrevChild(bool) { return false; }
 
 signals:
    void controllerInput(uint32_t* joy);
+   void rewind(bool rewind);
+   void fastForward(bool fastForward);
 
 private:
    Ui::NESEmulatorDockWidget *ui;
    CNESEmulatorRenderer* renderer;
    char* imgData;
    uint32_t m_joy [ NUM_CONTROLLERS ];
+   bool m_isFastForwarding;
    QRect ncRect;
 
 private slots:
    void renderData();
+   void emulationRate(int fps);
    void updateTargetMachine(QString target);
 };
 
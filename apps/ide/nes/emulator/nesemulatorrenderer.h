@@ -21,6 +21,7 @@ public:
    void setBGColor(QColor clr);
    void setLinearInterpolation(bool enabled) { linearInterpolation = enabled; }
    void set43Aspect(bool enabled) { aspect43 = enabled; }
+   void setOSD(QString text) { osdText = text; }
    int zoom;
    int scrollX;
    int scrollY;
@@ -29,6 +30,7 @@ public:
    QRect renderRect;
    bool linearInterpolation;
    bool aspect43;
+   QString osdText;
 };
 
 #endif // CNESEMULATORRENDERER_H
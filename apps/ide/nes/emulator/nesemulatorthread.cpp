@@ -36,8 +36,17 @@
 
 #include "cnesicideproject.h"
 
+#include <QElapsedTimer>
+
 SDL_AudioSpec sdlAudioSpec;
 
+// Uncapped fast-forward runs frames nobody sees for about this long
+// between frames that are shown.
+#define FAST_FORWARD_MSEC 16
+
+// How often the emulation rate is worked out while fast-forwarding.
+#define RATE_PERIOD_MSEC 500
+
 // Hook function endpoints.
 static void breakpointHook ( void )
 {
@@ -46,6 +55,10 @@ static void breakpointHook ( void )
    if ( emulator )
       emulator->_breakpointHook();
 
+   // Draw the rest of the frame a breakpoint stops in, even while
+   // fast-forwarding.
+   nesSetFrameSkip(false);
+
    // Put my thread to sleep.
    if ( emulator )
       emulator->nesBreakpointSemaphore->acquire();
@@ -58,13 +71,18 @@ void NESEmulatorThread::_breakpointHook()
 
 static void audioHook ( void )
 {
-   NESEmulatorThread* emulator = dynamic_cast<NESEmulatorThread*>(CObjectRegistry::getObject("Emulator"));
-   emulator->nesAudioSemaphore->acquire();
+   // Wait for the SDL callback to play the core's ring back down.  It
+   // takes samples without locking anything, so just poll; don't wait
+   // on a device that isn't playing.
+   while ( (nesGetAudioSamplesAvailable() >= APU_BUFFER_PRERENDER) &&
+           (SDL_GetAudioStatus() == SDL_AUDIO_PLAYING) )
+   {
+      SDL_Delay ( 1 );
+   }
 }
 
 extern "C" void SDL_Emulator(void* userdata, uint8_t* stream, int32_t len)
 {
-   NESEmulatorThread* emulator = (NESEmulatorThread*)userdata;
 #if 0
    LARGE_INTEGER t;
    static LARGE_INTEGER to;
@@ -76,16 +94,12 @@ extern "C" void SDL_Emulator(void* userdata, uint8_t* stream, int32_t len)
    to = t;
    qDebug(str.toLatin1().constData());
 #endif
-   if ( nesGetAudioSamplesAvailable() >= (len>>1) )
+   // The device is shared with the music tracker; only mix while the
+   // emulator is producing.  A short buffer holds the last sample.
+   if ( nesGetAudioSamplesAvailable() )
    {
       SDL_MixAudio(stream,nesGetAudioSamples(len>>1),len,SDL_MIX_MAXVOLUME);
    }
-   else
-   {
-//      qDebug("UNDERRUN");
-   }
-   if ( emulator && emulator->nesAudioSemaphore )
-      emulator->nesAudioSemaphore->release();
 }
 
 SDL_Callback nesSDLCallback;
@@ -101,11 +115,15 @@ NESEmulatorThread::NESEmulatorThread(QObject*)
    m_isStarting = false;
    m_isTerminating = false;
    m_isResetting = false;
+   m_isRewinding = false;
+   m_isFastForwarding = false;
    m_debugFrame = 0;
    m_pCartridge = NULL;
+
+   // Keep the last minute or so of execution to rewind through.
+   nesSetRewindEnabled(true);
    
    nesBreakpointSemaphore = new QSemaphore(0);
-   nesAudioSemaphore = new QSemaphore(0);
 
    // Enable callbacks from the external emulator library.
    nesSetBreakpointHook(breakpointHook);
@@ -116,6 +134,11 @@ NESEmulatorThread::NESEmulatorThread(QObject*)
    nesSDLCallback._valid = true;
    sdlHooks.append(nesSDLCallback);
 
+   // The emulator runs until the ring holds APU_BUFFER_PRERENDER samples
+   // and the callback takes a buffer at a time, so on average the ring is
+   // half a buffer short of that.  Keep it there.
+   nesSetAudioBufferTarget ( APU_BUFFER_PRERENDER-(APU_SAMPLES/2) );
+
    nesClearAudioSamplesAvailable();
 
    BreakpointWatcherThread* breakpointWatcher = dynamic_cast<BreakpointWatcherThread*>(CObjectRegistry::getObject("Breakpoint Watcher"));
@@ -128,9 +151,6 @@ NESEmulatorThread::~NESEmulatorThread()
    nesBreakpointSemaphore->release();
    delete nesBreakpointSemaphore;
    nesBreakpointSemaphore = NULL;
-   nesAudioSemaphore->release();
-   delete nesAudioSemaphore;
-   nesAudioSemaphore = NULL;
 }
 
 void NESEmulatorThread::kill()
@@ -150,7 +170,6 @@ void NESEmulatorThread::kill()
    while ( !isFinished() )
    {
       nesBreakpointSemaphore->release();
-      nesAudioSemaphore->release();
    }
 }
 
@@ -478,6 +497,12 @@ void NESEmulatorThread::run ()
    int emuY;
    int32_t samplesAvailable;
    int32_t debuggerUpdateRate = EnvironmentSettingsDialog::debuggerUpdateRate();
+   QElapsedTimer batchTimer;
+   QElapsedTimer rateTimer;
+   bool wasFastForwarding = false;
+   int speed;
+   int frames;
+   int rateFrames = 0;
 
    // Special case for 1Hz debugger update to match system mode.
    if ( debuggerUpdateRate == -1 )
@@ -619,7 +644,71 @@ void NESEmulatorThread::run ()
                                               emuY+(240*scale));
             }
          }
-         nesRun(m_joy);
+         if ( m_isRewinding )
+         {
+            // Restore the previous frame and run it again to put its
+            // picture back up.  Breakpoints stay quiet while going back
+            // over frames that already hit them.  Once the history runs
+            // out, hold there.
+            nesEnableBreakpoints(false);
+            if ( nesRewindStep(m_rewindJoy) )
+            {
+               nesRun(m_rewindJoy);
+            }
+            else
+            {
+               msleep(16);
+            }
+         }
+         else if ( m_isFastForwarding )
+         {
+            if ( !wasFastForwarding )
+            {
+               rateTimer.start();
+               rateFrames = 0;
+            }
+
+            // Only the last frame of each batch is drawn or heard.  At a
+            // set speed the audio of that one frame still paces the batch
+            // to a frame's time.  Uncapped, the batch goes on for about a
+            // frame's time instead, so what is heard is one frame of each.  A
+            // batch never runs past a pending pause.
+            speed = EmulatorPrefsDialog::getFastForwardSpeed();
+            frames = 1;
+            batchTimer.start();
+            nesSetFrameSkip(true);
+            while ( m_isRunning &&
+                    ((m_pauseAfterFrames == -1) || (frames < m_pauseAfterFrames)) &&
+                    (speed ? (frames < speed) : (batchTimer.elapsed() < FAST_FORWARD_MSEC)) )
+            {
+               nesRewindCapture(m_joy);
+               nesRun(m_joy);
+               frames++;
+            }
+            nesSetFrameSkip(false);
+
+            nesRewindCapture(m_joy);
+            nesRun(m_joy);
+
+            rateFrames += frames;
+            if ( rateTimer.elapsed() >= RATE_PERIOD_MSEC )
+            {
+               emit emulationRate((int)((rateFrames*1000)/rateTimer.elapsed()));
+               rateTimer.restart();
+               rateFrames = 0;
+            }
+
+            if ( m_pauseAfterFrames != -1 )
+            {
+               m_pauseAfterFrames -= frames-1;
+            }
+         }
+         else
+         {
+            nesRewindCapture(m_joy);
+            nesRun(m_joy);
+         }
+         wasFastForwarding = m_isFastForwarding && (!m_isRewinding);
 
          if ( m_pauseAfterFrames != -1 )
          {
@@ -635,7 +724,7 @@ void NESEmulatorThread::run ()
          if ( (!m_debugFrame) && (debuggerUpdateRate) )
          {
             m_debugFrame = debuggerUpdateRate;
-            if ( nesIsDebuggable() )
+            if ( nesIsDebugEnabled() )
             {
                emit updateDebuggers();
             }
@@ -773,6 +862,18 @@ bool NESEmulatorThread::serialize(QDomDocument& doc, QDomNode& node)
    return true;
 }
 
+bool NESEmulatorThread::saveState(QByteArray& state)
+{
+   state.resize(nesGetStateSize());
+
+   return nesSaveState((uint8_t*)state.data(),state.size()) > 0;
+}
+
+bool NESEmulatorThread::loadState(const QByteArray& state)
+{
+   return nesLoadState((const uint8_t*)state.constData(),state.size());
+}
+
 bool NESEmulatorThread::serializeContent(QFile& fileOut)
 {
    QByteArray bytesToWrite;
@@ -25,8 +25,11 @@ public:
    virtual bool serializeContent(QFile& fileOut);
    virtual bool deserializeContent(QFile& fileIn);
 
+   // Binary snapshot of the whole machine (see nesSaveState).
+   bool saveState(QByteArray& state);
+   bool loadState(const QByteArray& state);
+
    QSemaphore* nesBreakpointSemaphore;
-   QSemaphore* nesAudioSemaphore;   
    
 public slots:
    void breakpointsChanged (); // unused
@@ -47,11 +50,14 @@ public slots:
       m_joy[CONTROLLER1] = joy[CONTROLLER1];
       m_joy[CONTROLLER2] = joy[CONTROLLER2];
    }
+   void rewindEmulation ( bool rewind ) { m_isRewinding = rewind; }
+   void fastForwardEmulation ( bool fastForward ) { m_isFastForwarding = fastForward; }
 
    void _breakpointHook();
 signals:
    void breakpoint ();
    void emulatedFrame ();
+   void emulationRate ( int fps );
    void updateDebuggers ();
    void machineReady ();
    void emulatorPaused(bool show);
@@ -75,7 +81,10 @@ protected:
    bool          m_isSoftReset;
    bool          m_isStarting;
    int           m_debugFrame;
+   bool          m_isRewinding;
+   bool          m_isFastForwarding;
    uint32_t      m_joy [ NUM_CONTROLLERS ];
+   uint32_t      m_rewindJoy [ NUM_CONTROLLERS ];
 };
 
 #endif // NESEMULATORTHREAD_H
@@ -302,6 +302,8 @@ SOURCES += \
    nes/debuggers/chrmeminspector.cpp \
    debuggers/codebrowserdockwidget.cpp \
    nes/debuggers/codedataloggerdockwidget.cpp \
+   nes/debuggers/emulatorperformancedockwidget.cpp \
+   nes/debuggers/emulatorperformancegraph.cpp \
    debuggers/codeprofilerdockwidget.cpp \
    debuggers/csymbolwatchmodel.cpp \
    nes/debuggers/dbg_cnes.cpp \
@@ -451,6 +453,8 @@ HEADERS += \
    nes/debuggers/chrmeminspector.h \
    debuggers/codebrowserdockwidget.h \
    nes/debuggers/codedataloggerdockwidget.h \
+   nes/debuggers/emulatorperformancedockwidget.h \
+   nes/debuggers/emulatorperformancegraph.h \
    debuggers/codeprofilerdockwidget.h \
    debuggers/csymbolwatchmodel.h \
    nes/debuggers/dbg_cnes.h \
@@ -574,6 +578,7 @@ FORMS += \
    debuggers/breakpointdockwidget.ui \
    debuggers/codebrowserdockwidget.ui \
    nes/debuggers/codedataloggerdockwidget.ui \
+   nes/debuggers/emulatorperformancedockwidget.ui \
    debuggers/codeprofilerdockwidget.ui \
    debuggers/executioninspectordockwidget.ui \
    nes/debuggers/executionvisualizerdockwidget.ui \
@@ -0,0 +1,814 @@
+// Mapper benchmark suite for the NES emulator core.
+//
+// Builds a small synthetic cartridge for each of a handful of mappers
+// and runs it headless for a fixed number of frames, once with debug
+// support off and once with it on.  Each program turns rendering, NMIs,
+// the APU and (where the mapper has them) mapper IRQs and expansion audio
+// on, switches banks every frame from its NMI handler and otherwise sits
+// in a loop reading PRG-ROM, RAM and SRAM, so the numbers cover the whole
+// machine rather than one part of it.  Results are written as JSON; give
+// it a baseline written by an earlier run and it exits non-zero if any
+// case got slower than the threshold allows.
+
+#include "nes_emulator_core.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#define DEFAULT_FRAMES    1200
+#define DEFAULT_THRESHOLD 10.0
+
+// Frames run before the clock starts, so every case is past power-on
+// and its mapper IRQs and audio are going.
+#define WARMUP_FRAMES 60
+
+// The PPU renders 256x256 RGBA pixels into the TV buffer.
+#define TV_SIZE (256*256*4)
+
+// 128KB of PRG-ROM and CHR-ROM.  Every 8KB PRG-ROM bank holds the same
+// program and vectors so it keeps running whichever bank the mapper puts
+// at $E000; the program lives at $F000.
+#define PRG_SIZE    (16*MEM_8KB)
+#define CHR_SIZE    (16*MEM_8KB)
+#define PRG_ORIGIN  0xF000
+#define PRG_CODE    0x1000
+#define PRG_VECTORS 0x1FFA
+
+// Zero-page frame counter the NMI handler bumps.
+#define ZP_FRAME 0x10
+
+// 6502 opcodes the generated programs use.
+#define OP_ADC_ABSX 0x7D
+#define OP_AND_IMM  0x29
+#define OP_BIT_ABS  0x2C
+#define OP_BNE      0xD0
+#define OP_BPL      0x10
+#define OP_CLD      0xD8
+#define OP_CLI      0x58
+#define OP_CPX_IMM  0xE0
+#define OP_DEY      0x88
+#define OP_EOR_ABSX 0x5D
+#define OP_INC_ZP   0xE6
+#define OP_INX      0xE8
+#define OP_JMP_ABS  0x4C
+#define OP_LDA_ABS  0xAD
+#define OP_LDA_ABSX 0xBD
+#define OP_LDA_IMM  0xA9
+#define OP_LDA_ZP   0xA5
+#define OP_LDX_IMM  0xA2
+#define OP_LDY_IMM  0xA0
+#define OP_LSR_A    0x4A
+#define OP_ORA_IMM  0x09
+#define OP_PHA      0x48
+#define OP_PLA      0x68
+#define OP_RTI      0x40
+#define OP_SEI      0x78
+#define OP_STA_ABS  0x8D
+#define OP_STA_ABSX 0x9D
+#define OP_TAX      0xAA
+#define OP_TAY      0xA8
+#define OP_TXA      0x8A
+#define OP_TXS      0x9A
+#define OP_TYA      0x98
+
+// The program being assembled.  It is copied into every PRG-ROM bank.
+static std::vector<uint8_t> code;
+
+static uint16_t here ( void )
+{
+   return PRG_ORIGIN+code.size();
+}
+
+static void op ( uint8_t opcode )
+{
+   code.push_back(opcode);
+}
+
+static void op8 ( uint8_t opcode, uint8_t data )
+{
+   code.push_back(opcode);
+   code.push_back(data);
+}
+
+static void op16 ( uint8_t opcode, uint16_t addr )
+{
+   code.push_back(opcode);
+   code.push_back(addr&0xFF);
+   code.push_back(addr>>8);
+}
+
+static void branch ( uint8_t opcode, uint16_t target )
+{
+   code.push_back(opcode);
+   code.push_back((uint8_t)(target-(here()+1)));
+}
+
+static void poke ( uint16_t addr, uint8_t data )
+{
+   op8(OP_LDA_IMM,data);
+   op16(OP_STA_ABS,addr);
+}
+
+// Mapper-specific pieces of the program.  init runs once from RESET
+// before rendering is turned on.  nmi runs every frame with the frame
+// counter in A and switches banks.  irq acknowledges the mapper's IRQ;
+// cases without one leave interrupts masked.
+typedef struct _BenchCase
+{
+   const char* name;
+   uint32_t    mapper;
+   void (*init)(void);
+   void (*nmi)(void);
+   void (*irq)(void);
+} BenchCase;
+
+static void mmc1Write ( uint16_t addr )
+{
+   uint32_t bit;
+
+   for ( bit = 0; bit < 5; bit++ )
+   {
+      if ( bit )
+      {
+         op(OP_LSR_A);
+      }
+      op16(OP_STA_ABS,addr);
+   }
+}
+
+static void mmc1Init ( void )
+{
+   // Reset the shift register, then 16KB PRG with $C000 fixed, 4KB CHR
+   // and vertical mirroring.
+   poke(0x8000,0x80);
+   op8(OP_LDA_IMM,0x1E);
+   mmc1Write(0x8000);
+}
+
+static void mmc1Nmi ( void )
+{
+   op8(OP_AND_IMM,0x07);
+   mmc1Write(0xE000);
+   op8(OP_LDA_ZP,ZP_FRAME);
+   op8(OP_AND_IMM,0x1F);
+   mmc1Write(0xA000);
+}
+
+static void mmc3Init ( void )
+{
+   uint32_t reg;
+
+   for ( reg = 0; reg < 8; reg++ )
+   {
+      poke(0x8000,reg);
+      poke(0x8001,(reg < 6) ? (reg*2) : (reg-6));
+   }
+   poke(0xA000,0x00);
+   poke(0xA001,0x80);
+
+   // Scanline IRQ a hundred lines in.
+   poke(0xC000,100);
+   op16(OP_STA_ABS,0xC001);
+   op16(OP_STA_ABS,0xE001);
+}
+
+static void mmc3Nmi ( void )
+{
+   op8(OP_AND_IMM,0x0F);
+   op(OP_TAX);
+   poke(0x8000,0x06);
+   op(OP_TXA);
+   op16(OP_STA_ABS,0x8001);
+   poke(0x8000,0x02);
+   op8(OP_LDA_ZP,ZP_FRAME);
+   op8(OP_AND_IMM,0x7F);
+   op16(OP_STA_ABS,0x8001);
+}
+
+static void mmc3Irq ( void )
+{
+   op16(OP_STA_ABS,0xE000);
+   op16(OP_STA_ABS,0xE001);
+}
+
+static void mmc5Init ( void )
+{
+   uint32_t reg;
+
+   // 8KB PRG banks, 1KB CHR banks, PRG-RAM writable, vertical mirroring.
+   poke(0x5100,0x03);
+   poke(0x5101,0x03);
+   poke(0x5102,0x02);
+   poke(0x5103,0x01);
+   poke(0x5105,0x44);
+   poke(0x5113,0x00);
+   for ( reg = 0; reg < 3; reg++ )
+   {
+      poke(0x5114+reg,0x80|reg);
+   }
+   poke(0x5117,0xFF);
+   for ( reg = 0; reg < 12; reg++ )
+   {
+      poke(0x5120+reg,reg&0x07);
+   }
+
+   // Scanline IRQ, and one pulse channel droning.
+   poke(0x5203,120);
+   poke(0x5204,0x80);
+   poke(0x5015,0x03);
+   poke(0x5000,0xBF);
+}
+
+static void mmc5Nmi ( void )
+{
+   op8(OP_AND_IMM,0x0F);
+   op8(OP_ORA_IMM,0x80);
+   op16(OP_STA_ABS,0x5114);
+   op8(OP_LDA_ZP,ZP_FRAME);
+   op8(OP_AND_IMM,0x7F);
+   op16(OP_STA_ABS,0x5120);
+   op16(OP_STA_ABS,0x5002);
+   poke(0x5003,0x08);
+}
+
+static void mmc5Irq ( void )
+{
+   op16(OP_LDA_ABS,0x5204);
+}
+
+static void vrc6Init ( void )
+{
+   uint32_t reg;
+
+   poke(0x8000,0x00);
+   poke(0xC000,0x0E);
+   for ( reg = 0; reg < 4; reg++ )
+   {
+      poke(0xD000+reg,reg);
+      poke(0xE000+reg,reg+4);
+   }
+   poke(0xB003,0x00);
+
+   // Scanline-mode IRQ a hundred lines after each acknowledge.
+   poke(0xF000,0x9C);
+   poke(0xF001,0x03);
+
+   // Both pulses and the sawtooth on.
+   poke(0x9000,0x7F);
+   poke(0x9002,0x80);
+   poke(0xA000,0x3F);
+   poke(0xA002,0x80);
+   poke(0xB000,0x20);
+   poke(0xB002,0x80);
+}
+
+static void vrc6Nmi ( void )
+{
+   op8(OP_AND_IMM,0x07);
+   op16(OP_STA_ABS,0x8000);
+   op8(OP_LDA_ZP,ZP_FRAME);
+   op8(OP_AND_IMM,0x7F);
+   op16(OP_STA_ABS,0xD000);
+   op16(OP_STA_ABS,0x9001);
+   op16(OP_STA_ABS,0xB001);
+}
+
+static void vrc6Irq ( void )
+{
+   op16(OP_STA_ABS,0xF002);
+}
+
+static void n163Init ( void )
+{
+   uint32_t reg;
+
+   for ( reg = 0; reg < 8; reg++ )
+   {
+      poke(0x8000+(reg*0x800),reg);
+   }
+
+   // Nametables from CIRAM, vertical mirroring.
+   poke(0xC000,0xE0);
+   poke(0xC800,0xE1);
+   poke(0xD000,0xE0);
+   poke(0xD800,0xE1);
+   poke(0xE000,0x00);
+   poke(0xE800,0x01);
+   poke(0xF000,0x02);
+
+   // A sawtooth in wave RAM and one channel playing it.
+   poke(0xF800,0x80);
+   for ( reg = 0; reg < 16; reg++ )
+   {
+      poke(0x4800,reg*0x11);
+   }
+   poke(0xF800,0xF8);
+   poke(0x4800,0x00);
+   poke(0x4800,0x00);
+   poke(0x4800,0x40);
+   poke(0x4800,0x00);
+   poke(0x4800,0xE0);
+   poke(0x4800,0x00);
+   poke(0x4800,0x00);
+   poke(0x4800,0x0F);
+
+   // Cycle IRQ counting up to $7FFF.
+   poke(0x5000,0x0F);
+   poke(0x5800,0xDA);
+}
+
+static void n163Nmi ( void )
+{
+   op8(OP_AND_IMM,0x0F);
+   op16(OP_STA_ABS,0xE000);
+   op8(OP_LDA_ZP,ZP_FRAME);
+   op8(OP_AND_IMM,0x7F);
+   op16(OP_STA_ABS,0x8000);
+   poke(0xF800,0xFA);
+   op8(OP_LDA_ZP,ZP_FRAME);
+   op16(OP_STA_ABS,0x4800);
+}
+
+static void n163Irq ( void )
+{
+   poke(0x5000,0x0F);
+   poke(0x5800,0xDA);
+}
+
+static void fme7Command ( uint8_t command, uint8_t data )
+{
+   poke(0x8000,command);
+   poke(0xA000,data);
+}
+
+static void fme7Init ( void )
+{
+   uint32_t reg;
+
+   for ( reg = 0; reg < 8; reg++ )
+   {
+      fme7Command(reg,reg);
+   }
+   fme7Command(0x08,0xC0);
+   fme7Command(0x09,0x00);
+   fme7Command(0x0A,0x01);
+   fme7Command(0x0B,0x02);
+   fme7Command(0x0C,0x00);
+
+   // Cycle IRQ every 8K CPU cycles.
+   fme7Command(0x0E,0x00);
+   fme7Command(0x0F,0x20);
+   fme7Command(0x0D,0x81);
+}
+
+static void fme7Nmi ( void )
+{
+   op(OP_TAX);
+   poke(0x8000,0x09);
+   op(OP_TXA);
+   op8(OP_AND_IMM,0x0F);
+   op16(OP_STA_ABS,0xA000);
+   poke(0x8000,0x00);
+   op(OP_TXA);
+   op8(OP_AND_IMM,0x7F);
+   op16(OP_STA_ABS,0xA000);
+}
+
+static void fme7Irq ( void )
+{
+   fme7Command(0x0D,0x00);
+   fme7Command(0x0E,0x00);
+   fme7Command(0x0F,0x20);
+   fme7Command(0x0D,0x81);
+}
+
+static const BenchCase cases [] =
+{
+   { "nrom", 0,  NULL,     NULL,    NULL },
+   { "mmc1", 1,  mmc1Init, mmc1Nmi, NULL },
+   { "mmc3", 4,  mmc3Init, mmc3Nmi, mmc3Irq },
+   { "mmc5", 5,  mmc5Init, mmc5Nmi, mmc5Irq },
+   { "vrc6", 24, vrc6Init, vrc6Nmi, vrc6Irq },
+   { "n163", 19, n163Init, n163Nmi, n163Irq },
+   { "fme7", 69, fme7Init, fme7Nmi, fme7Irq }
+};
+
+static void assemble ( const BenchCase* pCase, uint16_t* vectors )
+{
+   uint16_t addr;
+
+   code.clear();
+
+   // RESET
+   vectors[1] = here();
+   op(OP_SEI);
+   op(OP_CLD);
+   op8(OP_LDX_IMM,0xFF);
+   op(OP_TXS);
+   poke(0x2000,0x00);
+   poke(0x2001,0x00);
+   poke(0x4017,0x40);
+   if ( pCase->init )
+   {
+      pCase->init();
+   }
+
+   // Wait out the PPU's warm-up.
+   op16(OP_BIT_ABS,0x2002);
+   addr = here();
+   op16(OP_BIT_ABS,0x2002);
+   branch(OP_BPL,addr);
+   addr = here();
+   op16(OP_BIT_ABS,0x2002);
+   branch(OP_BPL,addr);
+
+   // Palette, then all four nametables.
+   poke(0x2006,0x3F);
+   poke(0x2006,0x00);
+   op8(OP_LDX_IMM,0x00);
+   addr = here();
+   op(OP_TXA);
+   op16(OP_STA_ABS,0x2007);
+   op(OP_INX);
+   op8(OP_CPX_IMM,0x20);
+   branch(OP_BNE,addr);
+   poke(0x2006,0x20);
+   poke(0x2006,0x00);
+   op8(OP_LDY_IMM,0x10);
+   addr = here();
+   op(OP_TXA);
+   op16(OP_STA_ABS,0x2007);
+   op(OP_INX);
+   branch(OP_BNE,addr);
+   op(OP_DEY);
+   branch(OP_BNE,addr);
+
+   // Pulse 1 droning at constant volume.
+   poke(0x4015,0x0F);
+   poke(0x4000,0xBF);
+   poke(0x4001,0x00);
+
+   // Background and sprites on, 8x8 sprites from $1000, NMI on vblank.
+   poke(0x2001,0x1E);
+   poke(0x2000,0x88);
+   if ( pCase->irq )
+   {
+      op(OP_CLI);
+   }
+
+   // The loop the CPU spends its time in; $0200 is the OAM DMA page.
+   op8(OP_LDX_IMM,0x00);
+   addr = here();
+   op16(OP_LDA_ABSX,0x8000);
+   op16(OP_STA_ABSX,0x0200);
+   op16(OP_ADC_ABSX,0xA000);
+   op16(OP_EOR_ABSX,0xC000);
+   op16(OP_EOR_ABSX,0x6000);
+   op(OP_INX);
+   branch(OP_BNE,addr);
+   op16(OP_JMP_ABS,addr);
+
+   // NMI
+   vectors[0] = here();
+   op(OP_PHA);
+   op(OP_TXA);
+   op(OP_PHA);
+   op(OP_TYA);
+   op(OP_PHA);
+   poke(0x4014,0x02);
+   op8(OP_INC_ZP,ZP_FRAME);
+   op8(OP_LDA_ZP,ZP_FRAME);
+   op16(OP_STA_ABS,0x2005);
+   op16(OP_STA_ABS,0x4002);
+   poke(0x2005,0x00);
+   poke(0x4003,0x08);
+   if ( pCase->nmi )
+   {
+      op8(OP_LDA_ZP,ZP_FRAME);
+      pCase->nmi();
+   }
+   op(OP_PLA);
+   op(OP_TAY);
+   op(OP_PLA);
+   op(OP_TAX);
+   op(OP_PLA);
+   op(OP_RTI);
+
+   // IRQ
+   vectors[2] = here();
+   op(OP_PHA);
+   op(OP_TXA);
+   op(OP_PHA);
+   if ( pCase->irq )
+   {
+      pCase->irq();
+   }
+   op(OP_PLA);
+   op(OP_TAX);
+   op(OP_PLA);
+   op(OP_RTI);
+}
+
+static void loadCartridge ( const BenchCase* pCase )
+{
+   std::vector<uint8_t> prg(PRG_SIZE,0);
+   std::vector<uint8_t> chr(CHR_SIZE,0);
+   uint16_t vectors [ 3 ];
+   uint32_t bank;
+   uint32_t idx;
+   uint32_t seed = 0x12345678;
+
+   assemble(pCase,vectors);
+
+   // Something for the loop to chew on besides the program itself.
+   for ( idx = 0; idx < PRG_SIZE; idx++ )
+   {
+      seed = (seed*1103515245)+12345;
+      prg[idx] = seed>>24;
+   }
+   for ( idx = 0; idx < CHR_SIZE; idx++ )
+   {
+      chr[idx] = idx*0x9D;
+   }
+   for ( bank = 0; bank < PRG_SIZE/MEM_8KB; bank++ )
+   {
+      memcpy(&prg[(bank*MEM_8KB)+PRG_CODE],code.data(),code.size());
+      for ( idx = 0; idx < 3; idx++ )
+      {
+         prg[(bank*MEM_8KB)+PRG_VECTORS+(idx*2)+0] = vectors[idx]&0xFF;
+         prg[(bank*MEM_8KB)+PRG_VECTORS+(idx*2)+1] = vectors[idx]>>8;
+      }
+   }
+
+   nesUnloadROM();
+   for ( bank = 0; bank < PRG_SIZE/MEM_8KB; bank++ )
+   {
+      nesLoadPRGROMBank(bank,&prg[bank*MEM_8KB]);
+   }
+   for ( bank = 0; bank < CHR_SIZE/MEM_8KB; bank++ )
+   {
+      nesLoadCHRROMBank(bank,&chr[bank*MEM_8KB]);
+   }
+   nesLoadROM();
+   nesSetVerticalMirroring();
+   nesResetInitial(pCase->mapper);
+}
+
+typedef struct _BenchResult
+{
+   const BenchCase* pCase;
+   bool             debug;
+   double           fps;
+   double           nsPerInstruction;
+   double           nsPerDot;
+} BenchResult;
+
+static void runFrames ( uint32_t frames )
+{
+   uint32_t joy [ NUM_CONTROLLERS ] = { 0, 0 };
+   uint32_t frame;
+
+   for ( frame = 0; frame < frames; frame++ )
+   {
+      nesRun(joy);
+
+      // Keep the core's audio ring from wrapping.
+      while ( nesGetAudioSamplesAvailable() >= APU_SAMPLES )
+      {
+         nesGetAudioSamples(APU_SAMPLES);
+      }
+   }
+}
+
+static BenchResult runCase ( const BenchCase* pCase, bool debug, uint32_t frames )
+{
+   std::vector<int8_t> tv(TV_SIZE,0);
+   BenchResult result;
+   uint32_t instructions;
+
+   if ( debug )
+   {
+      nesEnableDebug();
+   }
+   else
+   {
+      nesDisableDebug();
+   }
+
+   nesSetSystemMode(MODE_NTSC);
+   nesSetTVOut(tv.data());
+   loadCartridge(pCase);
+   nesClearAudioSamplesAvailable();
+
+   runFrames(WARMUP_FRAMES);
+
+   instructions = nesGetCPUInstructions();
+
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+   runFrames(frames);
+
+   double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+   instructions = nesGetCPUInstructions()-instructions;
+
+   result.pCase = pCase;
+   result.debug = debug;
+   result.fps = (seconds > 0.0) ? (frames/seconds) : 0.0;
+   result.nsPerInstruction = instructions ? ((seconds*1e9)/instructions) : 0.0;
+   result.nsPerDot = (seconds*1e9)/((double)frames*SCANLINES_TOTAL_NTSC*PPU_CYCLES_PER_SCANLINE);
+
+   return result;
+}
+
+// One result per line so the baseline can be read back a line at a time
+// without a JSON library.
+static void writeResults ( FILE* fp, const std::vector<BenchResult>& results, uint32_t frames )
+{
+   uint32_t idx;
+
+   fprintf(fp,"{\n  \"frames\": %u,\n  \"results\": [\n",frames);
+   for ( idx = 0; idx < results.size(); idx++ )
+   {
+      fprintf(fp,
+              "    {\"case\": \"%s\", \"mapper\": %u, \"debug\": %s, \"fps\": %.1f, \"ns_per_instruction\": %.2f, \"ns_per_dot\": %.3f}%s\n",
+              results[idx].pCase->name,
+              results[idx].pCase->mapper,
+              results[idx].debug ? "true" : "false",
+              results[idx].fps,
+              results[idx].nsPerInstruction,
+              results[idx].nsPerDot,
+              (idx+1 < results.size()) ? "," : "");
+   }
+   fprintf(fp,"  ]\n}\n");
+}
+
+static bool findBaseline ( FILE* fp, const BenchResult& result, double* fps )
+{
+   char line [ 512 ];
+   char name [ 64 ];
+   const char* field;
+
+   snprintf(name,sizeof(name),"\"case\": \"%s\"",result.pCase->name);
+
+   rewind(fp);
+   while ( fgets(line,sizeof(line),fp) )
+   {
+      if ( !strstr(line,name) ||
+           !strstr(line,result.debug ? "\"debug\": true" : "\"debug\": false") )
+      {
+         continue;
+      }
+      field = strstr(line,"\"fps\":");
+      if ( field && (sscanf(field+6,"%lf",fps) == 1) )
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+// Returns the number of cases slower than the baseline allows.
+static uint32_t compareBaseline ( const char* path, const std::vector<BenchResult>& results, double threshold )
+{
+   FILE* fp = fopen(path,"r");
+   uint32_t regressions = 0;
+   uint32_t idx;
+   double   fps;
+
+   if ( !fp )
+   {
+      fprintf(stderr,"cannot open baseline %s\n",path);
+      return 1;
+   }
+
+   for ( idx = 0; idx < results.size(); idx++ )
+   {
+      if ( !findBaseline(fp,results[idx],&fps) )
+      {
+         fprintf(stderr,"%-6s debug %-3s: not in baseline\n",
+                 results[idx].pCase->name,results[idx].debug ? "on" : "off");
+         continue;
+      }
+
+      double change = (fps > 0.0) ? (((results[idx].fps-fps)*100.0)/fps) : 0.0;
+      bool regressed = (change < -threshold);
+
+      fprintf(stderr,"%-6s debug %-3s: %9.1f fps, baseline %9.1f (%+6.1f%%)%s\n",
+              results[idx].pCase->name,results[idx].debug ? "on" : "off",
+              results[idx].fps,fps,change,regressed ? "  REGRESSION" : "");
+      if ( regressed )
+      {
+         regressions++;
+      }
+   }
+
+   fclose(fp);
+
+   return regressions;
+}
+
+static void usage ( const char* argv0 )
+{
+   fprintf(stderr,
+           "usage: %s [options]\n"
+           "\n"
+           "options:\n"
+           "  -f, --frames N       frames to time per case (default %d)\n"
+           "  -c, --case NAME      run only the named case\n"
+           "  -o, --output FILE    write the JSON results to FILE instead of stdout\n"
+           "  -b, --baseline FILE  compare against an earlier run's results\n"
+           "  -t, --threshold PCT  slowdown allowed against the baseline (default %.0f)\n",
+           argv0,DEFAULT_FRAMES,DEFAULT_THRESHOLD);
+}
+
+int main ( int argc, char* argv[] )
+{
+   std::vector<BenchResult> results;
+   uint32_t    frames = DEFAULT_FRAMES;
+   double      threshold = DEFAULT_THRESHOLD;
+   const char* only = NULL;
+   const char* output = NULL;
+   const char* baseline = NULL;
+   uint32_t    idx;
+   int         arg;
+
+   for ( arg = 1; arg < argc; arg++ )
+   {
+      std::string opt = argv[arg];
+      bool hasValue = (arg+1 < argc);
+
+      if ( ((opt == "-f") || (opt == "--frames")) && hasValue )
+      {
+         frames = strtoul(argv[++arg],NULL,0);
+      }
+      else if ( ((opt == "-c") || (opt == "--case")) && hasValue )
+      {
+         only = argv[++arg];
+      }
+      else if ( ((opt == "-o") || (opt == "--output")) && hasValue )
+      {
+         output = argv[++arg];
+      }
+      else if ( ((opt == "-b") || (opt == "--baseline")) && hasValue )
+      {
+         baseline = argv[++arg];
+      }
+      else if ( ((opt == "-t") || (opt == "--threshold")) && hasValue )
+      {
+         threshold = strtod(argv[++arg],NULL);
+      }
+      else
+      {
+         usage(argv[0]);
+         return 2;
+      }
+   }
+
+   for ( idx = 0; idx < sizeof(cases)/sizeof(cases[0]); idx++ )
+   {
+      if ( only && strcmp(only,cases[idx].name) )
+      {
+         continue;
+      }
+
+      results.push_back(runCase(&cases[idx],false,frames));
+      results.push_back(runCase(&cases[idx],true,frames));
+   }
+   nesDisableDebug();
+
+   if ( results.empty() )
+   {
+      fprintf(stderr,"no case named %s\n",only);
+      return 2;
+   }
+
+   if ( output )
+   {
+      FILE* fp = fopen(output,"w");
+
+      if ( !fp )
+      {
+         fprintf(stderr,"cannot write %s\n",output);
+         return 2;
+      }
+      writeResults(fp,results,frames);
+      fclose(fp);
+   }
+   else
+   {
+      writeResults(stdout,results,frames);
+   }
+
+   if ( baseline && compareBaseline(baseline,results,threshold) )
+   {
+      return 1;
+   }
+
+   return 0;
+}
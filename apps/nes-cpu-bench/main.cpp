@@ -0,0 +1,195 @@
+// CPU micro-benchmark for the NES emulator core.
+//
+// Runs a synthetic cartridge on each supported mapper with rendering and
+// NMIs off.  The CPU sits in a loop that reads PRG-ROM, RAM and SRAM, so
+// most of the time goes into instruction and operand fetches through the
+// mapper.  Reports emulated CPU cycles per second for each mapper.  Build
+// it against two versions of the library and compare the numbers to see
+// what a change to the CPU's memory path is worth.
+
+#include "nes_emulator_core.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#define DEFAULT_FRAMES 3000
+
+// The PPU renders 256x256 RGBA pixels into the TV buffer.
+#define TV_SIZE (256*256*4)
+
+// 128KB of PRG-ROM and CHR-ROM.  Every 8KB PRG-ROM bank holds the same
+// program and vectors so it runs no matter how the mapper lays out its
+// banks at power-on; the program lives at $F000 once a bank is at $E000.
+#define PRG_SIZE    (16*MEM_8KB)
+#define CHR_SIZE    (16*MEM_8KB)
+#define PRG_CODE    0x1000
+#define PRG_VECTORS 0x1FFA
+
+// SEI
+// LDA #$00      ; rendering and NMI off
+// STA $2001
+// STA $2000
+// LDX #$00
+// loop:
+// LDA $F100,X   ; PRG-ROM
+// STA $0200,X   ; RAM
+// ADC $0300,X
+// EOR $6000,X   ; SRAM
+// INX
+// BNE loop
+// JMP loop
+// RTI           ; NMI/IRQ
+static const uint8_t program [] =
+{
+   0x78,
+   0xA9, 0x00,
+   0x8D, 0x01, 0x20,
+   0x8D, 0x00, 0x20,
+   0xA2, 0x00,
+   0xBD, 0x00, 0xF1,
+   0x9D, 0x00, 0x02,
+   0x7D, 0x00, 0x03,
+   0x5D, 0x00, 0x60,
+   0xE8,
+   0xD0, 0xF1,
+   0x4C, 0x0B, 0xF0,
+   0x40
+};
+
+// NMI, RESET, IRQ
+static const uint8_t vectors [] =
+{
+   0x1D, 0xF0,
+   0x00, 0xF0,
+   0x1D, 0xF0
+};
+
+// Mappers the core implements.
+static const uint32_t mappers [] =
+{
+   0, 1, 2, 3, 4, 5, 7, 9, 10, 11, 13, 16, 18, 19, 21, 22, 23, 24, 25, 26,
+   28, 33, 34, 65, 68, 69, 73, 75, 111
+};
+
+static void usage ( const char* argv0 )
+{
+   fprintf(stderr,
+           "usage: %s [options]\n"
+           "\n"
+           "options:\n"
+           "  -f, --frames N     frames to run per mapper (default %d)\n"
+           "  -m, --mapper N     run only mapper N\n",
+           argv0,DEFAULT_FRAMES);
+}
+
+static void loadCartridge ( uint32_t mapper )
+{
+   std::vector<uint8_t> prg(PRG_SIZE,0xEA);
+   std::vector<uint8_t> chr(CHR_SIZE,0);
+   uint32_t bank;
+   uint32_t idx;
+
+   for ( bank = 0; bank < PRG_SIZE/MEM_8KB; bank++ )
+   {
+      memcpy(&prg[(bank*MEM_8KB)+PRG_CODE],program,sizeof(program));
+      memcpy(&prg[(bank*MEM_8KB)+PRG_VECTORS],vectors,sizeof(vectors));
+   }
+   for ( idx = 0; idx < CHR_SIZE; idx++ )
+   {
+      chr[idx] = idx*0x9D;
+   }
+
+   nesUnloadROM();
+   for ( bank = 0; bank < PRG_SIZE/MEM_8KB; bank++ )
+   {
+      nesLoadPRGROMBank(bank,&prg[bank*MEM_8KB]);
+   }
+   for ( bank = 0; bank < CHR_SIZE/MEM_8KB; bank++ )
+   {
+      nesLoadCHRROMBank(bank,&chr[bank*MEM_8KB]);
+   }
+   nesLoadROM();
+   nesSetHorizontalMirroring();
+   nesResetInitial(mapper);
+}
+
+static double runCase ( uint32_t mapper, uint32_t frames )
+{
+   std::vector<int8_t> tv(TV_SIZE,0);
+   uint32_t joy [ NUM_CONTROLLERS ] = { 0, 0 };
+   uint32_t frame;
+   uint32_t cycles;
+
+   nesSetSystemMode(MODE_NTSC);
+   nesSetTVOut(tv.data());
+   loadCartridge(mapper);
+   nesClearAudioSamplesAvailable();
+
+   cycles = nesGetCPUCycle();
+
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+   for ( frame = 0; frame < frames; frame++ )
+   {
+      nesRun(joy);
+
+      // Keep the core's audio ring from wrapping.
+      while ( nesGetAudioSamplesAvailable() >= APU_SAMPLES )
+      {
+         nesGetAudioSamples(APU_SAMPLES);
+      }
+   }
+
+   double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+   cycles = nesGetCPUCycle()-cycles;
+
+   return (seconds > 0.0) ? (((double)cycles)/seconds) : 0.0;
+}
+
+int main ( int argc, char* argv[] )
+{
+   uint32_t frames = DEFAULT_FRAMES;
+   int32_t  only = -1;
+   uint32_t idx;
+   int      arg;
+
+   for ( arg = 1; arg < argc; arg++ )
+   {
+      std::string opt = argv[arg];
+      bool hasValue = (arg+1 < argc);
+
+      if ( ((opt == "-f") || (opt == "--frames")) && hasValue )
+      {
+         frames = strtoul(argv[++arg],NULL,0);
+      }
+      else if ( ((opt == "-m") || (opt == "--mapper")) && hasValue )
+      {
+         only = strtol(argv[++arg],NULL,0);
+      }
+      else
+      {
+         usage(argv[0]);
+         return 2;
+      }
+   }
+
+   printf("%-6s %14s\n","mapper","Mcycles/sec");
+   for ( idx = 0; idx < sizeof(mappers)/sizeof(mappers[0]); idx++ )
+   {
+      if ( (only >= 0) && (mappers[idx] != (uint32_t)only) )
+      {
+         continue;
+      }
+
+      double rate = runCase(mappers[idx],frames);
+
+      printf("%-6u %14.2f\n",mappers[idx],rate/1000000.0);
+   }
+
+   return 0;
+}
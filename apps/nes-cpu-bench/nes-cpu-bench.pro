@@ -0,0 +1,47 @@
+#-------------------------------------------------
+#
+# CPU micro-benchmark for the NES emulator core.
+#
+#-------------------------------------------------
+
+TARGET = "nes-cpu-bench"
+
+TEMPLATE = app
+
+# No Qt, no SDL; just the emulator core.
+QT =
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TOP = ../..
+
+macx {
+    QMAKE_MAC_SDK = macosx10.14
+}
+
+CONFIG(release, debug|release) {
+   DESTDIR = release
+} else {
+   DESTDIR = debug
+}
+
+# Remove crap we do not need!
+CONFIG -= rtti exceptions
+
+OBJECTS_DIR = $$DESTDIR
+
+NESICIDE_CXXFLAGS = -I$$TOP/libs/nes -I$$TOP/libs/nes/emulator
+NESICIDE_LIBS = -L$$TOP/libs/nes/$$DESTDIR -lnes-emulator
+
+win32 {
+   QMAKE_LFLAGS += -static-libgcc
+}
+
+QMAKE_CXXFLAGS += $$NESICIDE_CXXFLAGS
+LIBS += $$NESICIDE_LIBS
+
+INCLUDEPATH += \
+   $$TOP/common
+
+SOURCES += \
+   main.cpp
@@ -0,0 +1,243 @@
+#include "cbatchjob.h"
+#include "csha1.h"
+
+#include "nes_emulator_core.h"
+
+#include <stdio.h>
+#include <vector>
+#include <chrono>
+
+// iNES header layout.
+#define INES_HEADER_SIZE   16
+#define INES_TRAINER_SIZE  512
+#define INES_FLAG_VERTICAL 0x01
+#define INES_FLAG_TRAINER  0x04
+#define INES_FLAG_FOURSCR  0x08
+
+// The PPU renders 256x256 RGBA pixels into the TV buffer.
+#define TV_SIZE (256*256*4)
+
+static bool readFile ( const std::string& fileName, std::vector<uint8_t>& data )
+{
+   FILE* file = fopen(fileName.c_str(),"rb");
+   long size;
+
+   if ( !file )
+   {
+      return false;
+   }
+   fseek(file,0,SEEK_END);
+   size = ftell(file);
+   fseek(file,0,SEEK_SET);
+   data.resize(size);
+   if ( size && (fread(&data[0],1,size,file) != (size_t)size) )
+   {
+      fclose(file);
+      return false;
+   }
+   fclose(file);
+   return true;
+}
+
+static bool loadINES ( const std::vector<uint8_t>& image, std::string& error )
+{
+   uint32_t numPrgRomBanks;
+   uint32_t numChrRomBanks;
+   uint8_t  romCB1;
+   uint8_t  romCB2;
+   uint32_t offset = INES_HEADER_SIZE;
+   uint32_t bank;
+
+   if ( (image.size() < INES_HEADER_SIZE) ||
+        (image[0] != 'N') || (image[1] != 'E') || (image[2] != 'S') || (image[3] != 0x1A) )
+   {
+      error = "invalid iNES header";
+      return false;
+   }
+
+   // PRG-ROM is counted in 16KB units, CHR-ROM in 8KB units.  The
+   // emulator core takes PRG-ROM in 8KB banks.
+   numPrgRomBanks = image[4]<<1;
+   numChrRomBanks = image[5];
+   romCB1 = image[6];
+   romCB2 = image[7];
+
+   // Headers with garbage in the reserved bits also carry garbage
+   // in the upper mapper nybble.
+   if ( romCB2&0x0F )
+   {
+      romCB2 = 0x00;
+   }
+
+   if ( romCB1&INES_FLAG_TRAINER )
+   {
+      offset += INES_TRAINER_SIZE;
+   }
+
+   if ( image.size() < offset+(numPrgRomBanks*MEM_8KB)+(numChrRomBanks*MEM_8KB) )
+   {
+      error = "truncated iNES image";
+      return false;
+   }
+
+   nesUnloadROM();
+
+   for ( bank = 0; bank < numPrgRomBanks; bank++ )
+   {
+      nesLoadPRGROMBank(bank,(uint8_t*)&image[offset]);
+      offset += MEM_8KB;
+   }
+   for ( bank = 0; bank < numChrRomBanks; bank++ )
+   {
+      nesLoadCHRROMBank(bank,(uint8_t*)&image[offset]);
+      offset += MEM_8KB;
+   }
+
+   nesLoadROM();
+
+   if ( romCB1&INES_FLAG_VERTICAL )
+   {
+      nesSetVerticalMirroring();
+   }
+   else
+   {
+      nesSetHorizontalMirroring();
+   }
+   if ( romCB1&INES_FLAG_FOURSCR )
+   {
+      nesSetFourScreen();
+   }
+
+   nesResetInitial(((romCB1>>4)&0x0F)|(romCB2&0xF0));
+
+   return true;
+}
+
+static bool runBatchJobOnMachine ( const BatchJob& job, BatchResult& result )
+{
+   std::vector<uint8_t> image;
+   std::vector<uint8_t> joypads;
+   std::vector<int8_t>  tv(TV_SIZE,0);
+   std::vector<uint16_t> tvIndexed(TV_INDEXED_WIDTH*TV_INDEXED_HEIGHT,0);
+   uint32_t joy [ NUM_CONTROLLERS ];
+   uint64_t audioHash = 0xCBF29CE484222325ULL;
+   uint64_t idleCycles = 0;
+   uint32_t idleTurns;
+   uint32_t idleFrameCycles;
+   uint32_t cpuCycles;
+   uint32_t frame;
+   uint32_t idx;
+   CSHA1    sha1;
+   char     hex [ 41 ];
+
+   result = BatchResult();
+
+   if ( !readFile(job.rom,image) )
+   {
+      result.error = "cannot read ROM";
+      return false;
+   }
+   if ( !job.joypads.empty() && !readFile(job.joypads,joypads) )
+   {
+      result.error = "cannot read joypad stream";
+      return false;
+   }
+
+   nesSetSystemMode(job.systemMode);
+   nesSetIdleLoopSkip(job.idleSkip);
+   // Only the last frame is looked at, so have the core store palette
+   // indexes and convert to RGB once at the end.
+   nesSetTVOut(NULL);
+   nesSetTVOutIndexed(tvIndexed.data());
+   nesClearAudioSamplesAvailable();
+
+   if ( !loadINES(image,result.error) )
+   {
+      return false;
+   }
+
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+   cpuCycles = nesGetCPUCycle();
+
+   for ( frame = 0; frame < job.frames; frame++ )
+   {
+      joy[CONTROLLER1] = 0;
+      joy[CONTROLLER2] = 0;
+      if ( (frame*2)+1 < joypads.size() )
+      {
+         joy[CONTROLLER1] = joypads[frame*2];
+         joy[CONTROLLER2] = joypads[(frame*2)+1];
+      }
+
+      nesRun(joy);
+
+      if ( job.idleSkip )
+      {
+         nesGetIdleLoopStats(&idleTurns,&idleFrameCycles);
+         if ( idleTurns )
+         {
+            result.idleFrames++;
+            idleCycles += idleFrameCycles;
+         }
+      }
+
+      // Drain audio as it is produced so the core's ring never wraps;
+      // FNV-1a over the raw 16-bit samples.
+      while ( nesGetAudioSamplesAvailable() >= APU_SAMPLES )
+      {
+         uint8_t* samples = nesGetAudioSamples(APU_SAMPLES);
+
+         for ( idx = 0; idx < APU_SAMPLES*sizeof(uint16_t); idx++ )
+         {
+            audioHash ^= samples[idx];
+            audioHash *= 0x100000001B3ULL;
+         }
+      }
+   }
+
+   double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+   cpuCycles = nesGetCPUCycle()-cpuCycles;
+   result.idleShare = cpuCycles ? (((double)idleCycles)/cpuCycles) : 0.0;
+
+   if ( job.frames )
+   {
+      nesConvertTVOutRGBA(tvIndexed.data(),tv.data(),0);
+   }
+
+   sha1.Update(tv.data(),tv.size());
+   sha1.Final(hex);
+   result.tvSHA1 = hex;
+
+   snprintf(hex,sizeof(hex),"%016llx",(unsigned long long)audioHash);
+   result.audioHash = hex;
+
+   result.fps = (seconds > 0.0) ? (job.frames/seconds) : 0.0;
+
+   if ( !job.expectedTV.empty() && (job.expectedTV != result.tvSHA1) )
+   {
+      result.error = "TV digest mismatch";
+      return false;
+   }
+
+   result.ok = true;
+   return true;
+}
+
+bool runBatchJob ( const BatchJob& job, BatchResult& result )
+{
+   NesMachine* machine = nesCreate();
+   NesMachine* previous;
+   bool ok;
+
+   // Nothing the previous job left in the CPU, PPU, APU, mapper or RAM
+   // may show up in this one's hashes, so every job gets a machine fresh
+   // from power-on.
+   previous = nesSelect(machine);
+   ok = runBatchJobOnMachine(job,result);
+   nesSelect(previous);
+   nesDestroy(machine);
+
+   return ok;
+}
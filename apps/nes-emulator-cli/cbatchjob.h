@@ -0,0 +1,45 @@
+#if !defined ( BATCHJOB_H )
+#define BATCHJOB_H
+
+#include <stdint.h>
+#include <string>
+
+// One ROM regression check: a ROM image, how many frames to run it for,
+// an optional recorded joypad stream and an optional expected TV digest.
+//
+// The joypad stream is a raw file of two bytes per frame, the JOY_*
+// bitmask of CONTROLLER1 followed by that of CONTROLLER2.  Frames past
+// the end of the stream run with no buttons pressed.
+struct BatchJob
+{
+   BatchJob() : frames(0), systemMode(0), idleSkip(false) {}
+
+   std::string rom;
+   std::string joypads;
+   std::string expectedTV;
+   uint32_t    frames;
+   uint32_t    systemMode;
+   bool        idleSkip;
+};
+
+struct BatchResult
+{
+   BatchResult() : ok(false), fps(0.0), idleFrames(0), idleShare(0.0) {}
+
+   bool        ok;
+   std::string error;
+   std::string tvSHA1;
+   std::string audioHash;
+   double      fps;
+
+   // With idle-loop skipping on, the frames anything was skipped in and
+   // the share of all CPU cycles skipped.
+   uint32_t    idleFrames;
+   double      idleShare;
+};
+
+// Load the job's ROM into a machine of its own and run it uncapped, so
+// its results don't depend on which jobs ran before it on this thread.
+bool runBatchJob ( const BatchJob& job, BatchResult& result );
+
+#endif // #if !defined ( BATCHJOB_H )
@@ -0,0 +1,146 @@
+#include "csha1.h"
+
+#include <string.h>
+
+static inline uint32_t rol ( uint32_t value, int bits )
+{
+   return (value<<bits)|(value>>(32-bits));
+}
+
+CSHA1::CSHA1()
+{
+   Reset();
+}
+
+void CSHA1::Reset ( void )
+{
+   m_h[0] = 0x67452301;
+   m_h[1] = 0xEFCDAB89;
+   m_h[2] = 0x98BADCFE;
+   m_h[3] = 0x10325476;
+   m_h[4] = 0xC3D2E1F0;
+   m_length = 0;
+   m_used = 0;
+}
+
+void CSHA1::Block ( const uint8_t* block )
+{
+   uint32_t w [ 80 ];
+   uint32_t a, b, c, d, e, f, k, t;
+   int i;
+
+   for ( i = 0; i < 16; i++ )
+   {
+      w[i] = (block[i*4]<<24)|(block[i*4+1]<<16)|(block[i*4+2]<<8)|(block[i*4+3]);
+   }
+   for ( ; i < 80; i++ )
+   {
+      w[i] = rol(w[i-3]^w[i-8]^w[i-14]^w[i-16],1);
+   }
+
+   a = m_h[0];
+   b = m_h[1];
+   c = m_h[2];
+   d = m_h[3];
+   e = m_h[4];
+
+   for ( i = 0; i < 80; i++ )
+   {
+      if ( i < 20 )
+      {
+         f = (b&c)|((~b)&d);
+         k = 0x5A827999;
+      }
+      else if ( i < 40 )
+      {
+         f = b^c^d;
+         k = 0x6ED9EBA1;
+      }
+      else if ( i < 60 )
+      {
+         f = (b&c)|(b&d)|(c&d);
+         k = 0x8F1BBCDC;
+      }
+      else
+      {
+         f = b^c^d;
+         k = 0xCA62C1D6;
+      }
+      t = rol(a,5)+f+e+k+w[i];
+      e = d;
+      d = c;
+      c = rol(b,30);
+      b = a;
+      a = t;
+   }
+
+   m_h[0] += a;
+   m_h[1] += b;
+   m_h[2] += c;
+   m_h[3] += d;
+   m_h[4] += e;
+}
+
+void CSHA1::Update ( const void* data, size_t length )
+{
+   const uint8_t* bytes = (const uint8_t*)data;
+   size_t chunk;
+
+   m_length += length;
+
+   while ( length )
+   {
+      if ( (m_used == 0) && (length >= 64) )
+      {
+         Block(bytes);
+         bytes += 64;
+         length -= 64;
+         continue;
+      }
+
+      chunk = 64-m_used;
+      if ( chunk > length )
+      {
+         chunk = length;
+      }
+      memcpy(m_buffer+m_used,bytes,chunk);
+      m_used += chunk;
+      bytes += chunk;
+      length -= chunk;
+
+      if ( m_used == 64 )
+      {
+         Block(m_buffer);
+         m_used = 0;
+      }
+   }
+}
+
+void CSHA1::Final ( char* hex )
+{
+   static const char* digits = "0123456789abcdef";
+   uint64_t bits = m_length*8;
+   uint8_t pad = 0x80;
+   uint8_t lengthBytes [ 8 ];
+   int i;
+
+   Update(&pad,1);
+   pad = 0x00;
+   while ( m_used != 56 )
+   {
+      Update(&pad,1);
+   }
+   for ( i = 0; i < 8; i++ )
+   {
+      lengthBytes[i] = (bits>>(56-(i*8)))&0xFF;
+   }
+   Update(lengthBytes,8);
+
+   for ( i = 0; i < 20; i++ )
+   {
+      uint8_t byte = (m_h[i>>2]>>(24-((i&3)*8)))&0xFF;
+      hex[i*2] = digits[byte>>4];
+      hex[i*2+1] = digits[byte&0x0F];
+   }
+   hex[40] = 0;
+}
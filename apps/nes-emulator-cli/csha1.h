@@ -0,0 +1,30 @@
+#if !defined ( SHA1_H )
+#define SHA1_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Minimal SHA-1 digest used to fingerprint rendered TV frames so that
+// regression runs can be compared without storing the frames themselves.
+class CSHA1
+{
+public:
+   CSHA1();
+
+   void Reset ( void );
+   void Update ( const void* data, size_t length );
+
+   // Finish the digest and write it as 40 lowercase hex digits plus
+   // a terminating NUL into hex.  The object must be Reset() before reuse.
+   void Final ( char* hex );
+
+private:
+   void Block ( const uint8_t* block );
+
+   uint32_t m_h [ 5 ];
+   uint64_t m_length;
+   uint8_t  m_buffer [ 64 ];
+   uint32_t m_used;
+};
+
+#endif // #if !defined ( SHA1_H )
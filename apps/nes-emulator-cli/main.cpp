@@ -0,0 +1,392 @@
+// Headless batch runner for the NES emulator core.
+//
+// Runs one ROM, or every ROM listed in a manifest, uncapped for a fixed
+// number of frames and reports a SHA-1 of the final TV frame, a hash of
+// all audio produced and the emulation speed.  Manifests are spread over
+// a pool of worker processes, one per core by default, so that a crashing
+// or hung ROM cannot take the rest of the run down with it.
+
+#include "cbatchjob.h"
+
+#include "nes_emulator_core.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#if defined(_WIN32)
+#include <atomic>
+#else
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+#define DEFAULT_FRAMES 600
+
+static void usage ( const char* argv0 )
+{
+   fprintf(stderr,
+           "usage: %s [options] <rom.nes>\n"
+           "       %s [options] --manifest <file>\n"
+           "\n"
+           "options:\n"
+           "  -f, --frames N     frames to run (default %d)\n"
+           "  -i, --joypads FILE recorded joypad stream, 2 bytes per frame\n"
+           "  -e, --expect SHA1  fail unless the final TV frame matches\n"
+           "  -j, --jobs N       worker processes for a manifest (default: cores)\n"
+           "      --pal          emulate a PAL system\n"
+           "      --dendy        emulate a Dendy system\n"
+           "      --idle-skip    skip idle loops and report how much was skipped\n"
+           "\n"
+           "manifest lines: <rom> [frames] [joypads|-] [expected-sha1|-]\n"
+           "relative paths are taken relative to the manifest.\n",
+           argv0,argv0,DEFAULT_FRAMES);
+}
+
+static bool parseManifest ( const char* fileName, const BatchJob& defaults, std::vector<BatchJob>& jobs )
+{
+   FILE* file = fopen(fileName,"r");
+   std::string dir = fileName;
+   size_t slash = dir.find_last_of("/\\");
+   char line [ 4096 ];
+
+   if ( !file )
+   {
+      return false;
+   }
+
+   dir = (slash == std::string::npos) ? std::string() : dir.substr(0,slash+1);
+
+   while ( fgets(line,sizeof(line),file) )
+   {
+      std::vector<std::string> fields;
+      char* tok = strtok(line," \t\r\n");
+
+      while ( tok )
+      {
+         fields.push_back(tok);
+         tok = strtok(NULL," \t\r\n");
+      }
+      if ( fields.empty() || (fields[0][0] == '#') )
+      {
+         continue;
+      }
+
+      BatchJob job = defaults;
+      job.rom = fields[0];
+      if ( fields.size() > 1 )
+      {
+         job.frames = strtoul(fields[1].c_str(),NULL,0);
+      }
+      if ( (fields.size() > 2) && (fields[2] != "-") )
+      {
+         job.joypads = fields[2];
+      }
+      if ( (fields.size() > 3) && (fields[3] != "-") )
+      {
+         job.expectedTV = fields[3];
+      }
+
+      if ( !job.rom.empty() && (job.rom[0] != '/') && !dir.empty() )
+      {
+         job.rom = dir+job.rom;
+      }
+      if ( !job.joypads.empty() && (job.joypads[0] != '/') && !dir.empty() )
+      {
+         job.joypads = dir+job.joypads;
+      }
+
+      jobs.push_back(job);
+   }
+
+   fclose(file);
+   return true;
+}
+
+static void printResult ( const BatchJob& job, const BatchResult& result )
+{
+   char idle [ 64 ] = "";
+
+   if ( job.idleSkip )
+   {
+      snprintf(idle,sizeof(idle)," idle %5.1f%% %6u/%-6u",
+               result.idleShare*100.0,result.idleFrames,job.frames);
+   }
+
+   printf("%s %s %s %9.1f%s %s%s%s\n",
+          result.ok ? "PASS" : "FAIL",
+          result.tvSHA1.empty() ? "----------------------------------------" : result.tvSHA1.c_str(),
+          result.audioHash.empty() ? "----------------" : result.audioHash.c_str(),
+          result.fps,
+          idle,
+          job.rom.c_str(),
+          result.error.empty() ? "" : ": ",
+          result.error.c_str());
+}
+
+#if defined(_WIN32)
+// No fork() here; worker threads instead, each job on its own NesMachine
+// (see runBatchJob).
+static void runPool ( const std::vector<BatchJob>& jobs, std::vector<BatchResult>& results, uint32_t workers )
+{
+   std::vector<std::thread> pool;
+   std::atomic<size_t> next(0);
+   uint32_t worker;
+
+   for ( worker = 0; worker < workers; worker++ )
+   {
+      pool.push_back(std::thread([&]()
+      {
+         size_t idx;
+
+         while ( (idx = next++) < jobs.size() )
+         {
+            runBatchJob(jobs[idx],results[idx]);
+         }
+      }));
+   }
+   for ( worker = 0; worker < workers; worker++ )
+   {
+      pool[worker].join();
+   }
+}
+#else
+// Each worker process takes every workers'th job and reports its results
+// back over a pipe, one tab-separated line per job.
+static void runPool ( const std::vector<BatchJob>& jobs, std::vector<BatchResult>& results, uint32_t workers )
+{
+   std::vector<int>   pipes;
+   std::vector<pid_t> pids;
+   uint32_t worker;
+   size_t idx;
+
+   for ( worker = 0; worker < workers; worker++ )
+   {
+      int fds [ 2 ];
+
+      if ( pipe(fds) != 0 )
+      {
+         break;
+      }
+
+      pid_t pid = fork();
+
+      if ( pid == 0 )
+      {
+         FILE* out = fdopen(fds[1],"w");
+
+         close(fds[0]);
+         for ( idx = worker; idx < jobs.size(); idx += workers )
+         {
+            BatchResult result;
+
+            runBatchJob(jobs[idx],result);
+            fprintf(out,"%u\t%d\t%s\t%s\t%f\t%u\t%f\t%s\n",
+                    (unsigned)idx,result.ok,result.tvSHA1.c_str(),result.audioHash.c_str(),
+                    result.fps,result.idleFrames,result.idleShare,result.error.c_str());
+            fflush(out);
+         }
+         fclose(out);
+         _exit(0);
+      }
+
+      close(fds[1]);
+      if ( pid < 0 )
+      {
+         close(fds[0]);
+         break;
+      }
+      pipes.push_back(fds[0]);
+      pids.push_back(pid);
+   }
+
+   for ( worker = 0; worker < pipes.size(); worker++ )
+   {
+      FILE* in = fdopen(pipes[worker],"r");
+      char line [ 1024 ];
+
+      while ( fgets(line,sizeof(line),in) )
+      {
+         std::vector<std::string> fields;
+         char* start = line;
+         char* tab;
+
+         line[strcspn(line,"\n")] = 0;
+         while ( (tab = strchr(start,'\t')) )
+         {
+            fields.push_back(std::string(start,tab-start));
+            start = tab+1;
+         }
+         fields.push_back(start);
+
+         if ( fields.size() == 8 )
+         {
+            idx = strtoul(fields[0].c_str(),NULL,10);
+            if ( idx < results.size() )
+            {
+               results[idx].ok = atoi(fields[1].c_str());
+               results[idx].tvSHA1 = fields[2];
+               results[idx].audioHash = fields[3];
+               results[idx].fps = atof(fields[4].c_str());
+               results[idx].idleFrames = strtoul(fields[5].c_str(),NULL,10);
+               results[idx].idleShare = atof(fields[6].c_str());
+               results[idx].error = fields[7];
+            }
+         }
+      }
+      fclose(in);
+   }
+
+   for ( worker = 0; worker < pids.size(); worker++ )
+   {
+      int status;
+
+      waitpid(pids[worker],&status,0);
+   }
+
+   // Anything a worker never reported on crashed or was never started.
+   for ( idx = 0; idx < results.size(); idx++ )
+   {
+      if ( !results[idx].ok && results[idx].error.empty() )
+      {
+         results[idx].error = "worker exited without a result";
+      }
+   }
+}
+#endif
+
+int main ( int argc, char* argv[] )
+{
+   std::vector<BatchJob> jobs;
+   BatchJob    defaults;
+   const char* manifest = NULL;
+   const char* rom = NULL;
+   uint32_t    workers = std::thread::hardware_concurrency();
+   uint64_t    totalFrames = 0;
+   uint32_t    failures = 0;
+   size_t      idx;
+   int         arg;
+
+   defaults.frames = DEFAULT_FRAMES;
+   defaults.systemMode = MODE_NTSC;
+
+   for ( arg = 1; arg < argc; arg++ )
+   {
+      std::string opt = argv[arg];
+      bool hasValue = (arg+1 < argc);
+
+      if ( ((opt == "-f") || (opt == "--frames")) && hasValue )
+      {
+         defaults.frames = strtoul(argv[++arg],NULL,0);
+      }
+      else if ( ((opt == "-i") || (opt == "--joypads")) && hasValue )
+      {
+         defaults.joypads = argv[++arg];
+      }
+      else if ( ((opt == "-e") || (opt == "--expect")) && hasValue )
+      {
+         defaults.expectedTV = argv[++arg];
+      }
+      else if ( ((opt == "-j") || (opt == "--jobs")) && hasValue )
+      {
+         workers = strtoul(argv[++arg],NULL,0);
+      }
+      else if ( ((opt == "-m") || (opt == "--manifest")) && hasValue )
+      {
+         manifest = argv[++arg];
+      }
+      else if ( opt == "--pal" )
+      {
+         defaults.systemMode = MODE_PAL;
+      }
+      else if ( opt == "--dendy" )
+      {
+         defaults.systemMode = MODE_DENDY;
+      }
+      else if ( opt == "--idle-skip" )
+      {
+         defaults.idleSkip = true;
+      }
+      else if ( (opt[0] != '-') && !rom )
+      {
+         rom = argv[arg];
+      }
+      else
+      {
+         usage(argv[0]);
+         return 2;
+      }
+   }
+
+   if ( manifest )
+   {
+      if ( !parseManifest(manifest,defaults,jobs) )
+      {
+         fprintf(stderr,"%s: cannot read manifest %s\n",argv[0],manifest);
+         return 2;
+      }
+   }
+   else if ( rom )
+   {
+      defaults.rom = rom;
+      jobs.push_back(defaults);
+   }
+   else
+   {
+      usage(argv[0]);
+      return 2;
+   }
+
+   std::vector<BatchResult> results(jobs.size());
+
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+   if ( workers < 1 )
+   {
+      workers = 1;
+   }
+   if ( workers > jobs.size() )
+   {
+      workers = jobs.size();
+   }
+   if ( workers <= 1 )
+   {
+      for ( idx = 0; idx < jobs.size(); idx++ )
+      {
+         runBatchJob(jobs[idx],results[idx]);
+      }
+   }
+   else
+   {
+      runPool(jobs,results,workers);
+   }
+
+   double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+   for ( idx = 0; idx < jobs.size(); idx++ )
+   {
+      printResult(jobs[idx],results[idx]);
+      if ( results[idx].ok )
+      {
+         totalFrames += jobs[idx].frames;
+      }
+      else
+      {
+         failures++;
+      }
+   }
+
+   if ( jobs.size() > 1 )
+   {
+      printf("%u/%u passed, %llu frames in %.2fs (%.1f frames/sec aggregate, %u workers)\n",
+             (unsigned)(jobs.size()-failures),(unsigned)jobs.size(),
+             (unsigned long long)totalFrames,seconds,
+             (seconds > 0.0) ? (totalFrames/seconds) : 0.0,workers);
+   }
+
+   return failures ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+#-------------------------------------------------
+#
+# Headless batch runner for the NES emulator core.
+#
+#-------------------------------------------------
+
+TARGET = "nes-emulator-cli"
+
+TEMPLATE = app
+
+# No Qt, no SDL; just the emulator core.
+QT =
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TOP = ../..
+
+macx {
+    QMAKE_MAC_SDK = macosx10.14
+}
+
+CONFIG(release, debug|release) {
+   DESTDIR = release
+} else {
+   DESTDIR = debug
+}
+
+# Remove crap we do not need!
+CONFIG -= rtti exceptions
+
+OBJECTS_DIR = $$DESTDIR
+
+NESICIDE_CXXFLAGS = -I$$TOP/libs/nes -I$$TOP/libs/nes/emulator
+NESICIDE_LIBS = -L$$TOP/libs/nes/$$DESTDIR -lnes-emulator
+
+win32 {
+   QMAKE_LFLAGS += -static-libgcc
+}
+
+unix:!mac {
+   PREFIX = $$(PREFIX)
+   isEmpty (PREFIX) {
+      PREFIX = /usr/local
+   }
+
+   BINDIR = $$(BINDIR)
+   isEmpty (BINDIR) {
+      BINDIR=$$PREFIX/bin
+   }
+
+   target.path = $$BINDIR
+   INSTALLS += target
+}
+
+# make check runs the regression tests under tests/ against this build.
+unix {
+   check.commands = $$PWD/tests/repeat-manifest.sh $$OUT_PWD/$$DESTDIR/nes-emulator-cli
+   check.depends = first
+   QMAKE_EXTRA_TARGETS += check
+}
+
+QMAKE_CXXFLAGS += $$NESICIDE_CXXFLAGS
+LIBS += $$NESICIDE_LIBS
+
+INCLUDEPATH += \
+   $$TOP/common
+
+SOURCES += \
+   main.cpp \
+   cbatchjob.cpp \
+   csha1.cpp
+
+HEADERS += \
+   cbatchjob.h \
+   csha1.h
@@ -0,0 +1,67 @@
+#!/bin/bash
+#
+# Runs one ROM four times in one manifest, one worker and then two, and
+# fails unless every run reports the same TV and audio hashes.  Each job
+# has to start from power-on for that to hold; anything a job inherits
+# from the one before it on the same worker shows up here.
+#
+# usage: repeat-manifest.sh [path/to/nes-emulator-cli]
+
+CLI=${1:-$(dirname "$0")/../release/nes-emulator-cli}
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT
+
+# NROM-128 test cartridge.  The program never clears RAM; it keeps
+# incrementing $00 and feeding it to pulse 1's period, so the audio
+# depends on what RAM and the APU held when the job started.
+#
+# $C000 reset: SEI / CLD
+#              LDA #$01 / STA $4015   pulse 1 on
+#              LDA #$BF / STA $4000   constant volume 15
+#              LDA #$00 / STA $4001   no sweep
+# $C011 loop:  INC $00
+#              LDA $00 / STA $4002    period low
+#              LDA #$08 / STA $4003   period high, length
+#              JMP loop
+# $C020 nmi/irq: RTI
+CODE='\x78\xd8'
+CODE+='\xa9\x01\x8d\x15\x40'
+CODE+='\xa9\xbf\x8d\x00\x40'
+CODE+='\xa9\x00\x8d\x01\x40'
+CODE+='\xe6\x00'
+CODE+='\xa5\x00\x8d\x02\x40'
+CODE+='\xa9\x08\x8d\x03\x40'
+CODE+='\x4c\x11\xc0'
+CODE+='\x40'
+CODE_SIZE=33
+
+{
+   printf 'NES\x1a\x01\x01\x00\x00'
+   head -c 8 /dev/zero
+   printf "$CODE"
+   head -c $((0x3FFA-CODE_SIZE)) /dev/zero
+   printf '\x20\xc0\x00\xc0\x20\xc0'
+   head -c 8192 /dev/zero
+} > "$DIR/repeat.nes"
+
+for run in 1 2 3 4; do
+   echo "repeat.nes 120"
+done > "$DIR/manifest"
+
+status=0
+for jobs in 1 2; do
+   "$CLI" -j $jobs -m "$DIR/manifest" > "$DIR/results.$jobs" || status=1
+   if [ "$(grep -c '^PASS' "$DIR/results.$jobs")" != 4 ]; then
+      status=1
+   fi
+done
+
+hashes=$(cat "$DIR"/results.* | awk '$1 == "PASS" { print $2, $3 }' | sort -u | wc -l)
+if [ $status != 0 ] || [ $hashes != 1 ]; then
+   cat "$DIR"/results.*
+   echo "FAIL: repeated runs of one ROM do not match"
+   exit 1
+fi
+
+echo "PASS: repeated runs of one ROM match"
+exit 0
@@ -29,9 +29,13 @@ protected:
    void mouseReleaseEvent(QMouseEvent* event);
    void keyPressEvent(QKeyEvent* event);
    void keyReleaseEvent(QKeyEvent* event);
+   // Tab is the fast-forward key, not a focus change.
+   bool focusNextPrevChild(bool) { return false; }
 
 signals:
    void controllerInput(uint32_t* joy);
+   void rewind(bool rewind);
+   void fastForward(bool fastForward);
 
 private:
    Ui::NESEmulatorDockWidget *ui;
@@ -40,9 +44,11 @@ private:
    QWidget* savedTitleBar;
    char* imgData;
    uint32_t m_joy [ NUM_CONTROLLERS ];
+   bool m_isFastForwarding;
 
 private slots:
    void renderData();
+   void emulationRate(int fps);
 };
 
 #endif // NESEMULATORDOCKWIDGET_H
@@ -175,6 +175,16 @@ void CNESEmulatorRenderer::paintGL()
    glTexCoord2f (0.0, 0);
    glVertex3f(0.0, 1.0f, 0.0f);
    glEnd();
+
+   // On-screen display, such as the fast-forward rate...
+   if ( !osdText.isEmpty() )
+   {
+      glDisable(GL_TEXTURE_2D);
+      glColor3f(1.0f, 1.0f, 0.0f);
+      renderText(8, 20, osdText);
+      glColor3f(1.0f, 1.0f, 1.0f);
+      glEnable(GL_TEXTURE_2D);
+   }
 }
 
 void CNESEmulatorRenderer::changeZoom(int newZoom)
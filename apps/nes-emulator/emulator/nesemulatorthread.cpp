@@ -20,16 +20,35 @@
 
 #include "main.h"
 
+#include <QElapsedTimer>
+
 #undef main
 #include <SDL.h>
 
 SDL_AudioSpec sdlAudioSpec;
-QSemaphore nesAudioSemaphore(0);
+
+// Samples per SDL callback.  Rate control keeps enough queued in the
+// emulator core's ring that a buffer this short doesn't run dry.
+#define SDL_CALLBACK_SAMPLES (APU_SAMPLES/2)
+
+// Uncapped fast-forward runs frames nobody sees for about this long
+// between frames that are shown.
+#define FAST_FORWARD_MSEC 16
+
+// How often the emulation rate is worked out while fast-forwarding.
+#define RATE_PERIOD_MSEC 500
 
 // Hook function endpoints.
 static void audioHook ( void )
 {
-   nesAudioSemaphore.acquire();
+   // Wait for the SDL callback to play the core's ring back down.  It
+   // takes samples without locking anything, so just poll; don't wait
+   // on a device that isn't playing.
+   while ( (nesGetAudioSamplesAvailable() >= APU_BUFFER_PRERENDER) &&
+           (SDL_GetAudioStatus() == SDL_AUDIO_PLAYING) )
+   {
+      SDL_Delay ( 1 );
+   }
 }
 
 extern "C" void SDL_GetMoreData(void* userdata, uint8_t* stream, int32_t len)
@@ -48,17 +67,8 @@ extern "C" void SDL_GetMoreData(void* userdata, uint8_t* stream, int32_t len)
 //   QDateTime dt = QDateTime::currentDateTime();
 //   static int ctr = 0;
 //   qDebug("%d %d:%03d",ctr++,dt.time().second(),dt.time().msec());
-   if ( nesGetAudioSamplesAvailable() >= (len>>1) )
-   {
-      memcpy(stream,nesGetAudioSamples(len>>1),len);
-   }
-#if 0
-   else
-   {
-//      qDebug("UNDERRUN");
-   }
-#endif
-   nesAudioSemaphore.release();
+   // Always a full buffer; through an underrun the last sample is held.
+   memcpy(stream,nesGetAudioSamples(len>>1),len);
 }
 
 NESEmulatorThread::NESEmulatorThread(QObject*)
@@ -71,8 +81,13 @@ NESEmulatorThread::NESEmulatorThread(QObject*)
    m_isStarting = false;
    m_isTerminating = false;
    m_isResetting = false;
+   m_isRewinding = false;
+   m_isFastForwarding = false;
    m_pCartridge = NULL;
 
+   // Keep the last minute or so of play to rewind through.
+   nesSetRewindEnabled(true);
+
    // Enable callbacks from the external emulator library.
    nesSetAudioHook(audioHook);
 
@@ -85,11 +100,16 @@ NESEmulatorThread::NESEmulatorThread(QObject*)
    sdlAudioSpec.freq = SDL_SAMPLE_RATE;
 
    // Set up audio sample rate for video mode...
-   sdlAudioSpec.samples = APU_SAMPLES;
+   sdlAudioSpec.samples = SDL_CALLBACK_SAMPLES;
 
    SDL_AudioSpec sdlAudioSpecOut;
    SDL_OpenAudio ( &sdlAudioSpec, &sdlAudioSpecOut );
 
+   // The emulator runs until the ring holds APU_BUFFER_PRERENDER samples
+   // and the callback takes a buffer at a time, so on average the ring is
+   // half a buffer short of that.  Keep it there.
+   nesSetAudioBufferTarget ( APU_BUFFER_PRERENDER-(SDL_CALLBACK_SAMPLES/2) );
+
    SDL_PauseAudio ( 0 );
 
    nesClearAudioSamplesAvailable();
@@ -112,12 +132,9 @@ void NESEmulatorThread::kill()
 
    SDL_Quit();
 
+   // With the audio stopped the audio hook no longer waits.
    start();
-
-   while ( !isFinished() )
-   {
-      nesAudioSemaphore.release();
-   }
+   wait();
 }
 
 void NESEmulatorThread::primeEmulator(CCartridge* pCartridge)
@@ -178,12 +195,12 @@ void NESEmulatorThread::loadCartridge()
       saveState.close();
 
       deserialize(saveDoc,saveDoc,errors);
-#endif
-
+#else
       if ( saveState.open(QIODevice::ReadOnly) )
       {
          deserializeContent(saveState);
       }
+#endif
    }
 
    // Turn off replay...
@@ -238,6 +255,12 @@ void NESEmulatorThread::run ()
    int emuX;
    int emuY;
    int32_t samplesAvailable;
+   QElapsedTimer batchTimer;
+   QElapsedTimer rateTimer;
+   bool wasFastForwarding = false;
+   int speed;
+   int frames;
+   int rateFrames = 0;
 
    while ( m_isStarting || m_isRunning || m_isResetting || m_isPaused )
    {
@@ -326,7 +349,65 @@ void NESEmulatorThread::run ()
                                               emuY+(240*scale));
             }
          }
-         nesRun(m_joy);
+         if ( m_isRewinding )
+         {
+            // Restore the previous frame and run it again to put its
+            // picture back up.  Once the history runs out, hold there.
+            if ( nesRewindStep(m_rewindJoy) )
+            {
+               nesRun(m_rewindJoy);
+            }
+            else
+            {
+               msleep(16);
+            }
+         }
+         else if ( m_isFastForwarding )
+         {
+            if ( !wasFastForwarding )
+            {
+               rateTimer.start();
+               rateFrames = 0;
+            }
+
+            // Only the last frame of each batch is drawn or heard.  At a
+            // set speed the audio of that one frame still paces the batch
+            // to a frame's time.  Uncapped, the batch goes on for about a
+            // frame's time instead, so what is heard is one frame of each.
+            speed = EmulatorPrefsDialog::getFastForwardSpeed();
+            frames = 1;
+            batchTimer.start();
+            nesSetFrameSkip(true);
+            while ( speed ? (frames < speed) : (batchTimer.elapsed() < FAST_FORWARD_MSEC) )
+            {
+               nesRewindCapture(m_joy);
+               nesRun(m_joy);
+               frames++;
+            }
+            nesSetFrameSkip(false);
+
+            nesRewindCapture(m_joy);
+            nesRun(m_joy);
+
+            rateFrames += frames;
+            if ( rateTimer.elapsed() >= RATE_PERIOD_MSEC )
+            {
+               emit emulationRate((int)((rateFrames*1000)/rateTimer.elapsed()));
+               rateTimer.restart();
+               rateFrames = 0;
+            }
+         }
+         else
+         {
+            nesRewindCapture(m_joy);
+
+            // With run-ahead the picture shown is that many frames into the
+            // future, hiding the game's own input lag; the machine itself
+            // only advances by one frame.
+            nesRunAhead(m_joy,EmulatorPrefsDialog::getRunAhead());
+         }
+
+         wasFastForwarding = m_isFastForwarding && (!m_isRewinding);
 
          emit emulatedFrame();
       }
@@ -472,20 +553,31 @@ bool NESEmulatorThread::serialize(QDomDocument& doc, QDomNode& node)
    return true;
 }
 
+bool NESEmulatorThread::saveState(QByteArray& state)
+{
+   state.resize(nesGetStateSize());
+
+   return nesSaveState((uint8_t*)state.data(),state.size()) > 0;
+}
+
+bool NESEmulatorThread::loadState(const QByteArray& state)
+{
+   return nesLoadState((const uint8_t*)state.constData(),state.size());
+}
+
 bool NESEmulatorThread::serializeContent(QFile& fileOut)
 {
    QByteArray bytesToWrite;
    qint64     bytesWritten;
-   int idx;
 
-   for ( idx = 0; idx < MEM_64KB; idx++ )
+   if ( !saveState(bytesToWrite) )
    {
-      bytesToWrite += nesGetSRAMDataPhysical(idx);
+      return false;
    }
 
    bytesWritten = fileOut.write(bytesToWrite);
 
-   return bytesWritten > 0;
+   return bytesWritten == bytesToWrite.count();
 }
 
 bool NESEmulatorThread::deserialize(QDomDocument& doc, QDomNode& node, QString& errors)
@@ -631,32 +723,50 @@ bool NESEmulatorThread::deserialize(QDomDocument& doc, QDomNode& node, QString&
 bool NESEmulatorThread::deserializeContent(QFile& fileIn)
 {
    QByteArray bytes;
+   QByteArray head;
    int idx;
-   char zero = 0;
 
    bytes = fileIn.readAll();
 
-   if ( bytes.count() != MEM_64KB )
+   // Save files are binary save-states.
+   if ( loadState(bytes) )
+   {
+      return true;
+   }
+
+   // Save files written before the binary save-state are XML.  Import
+   // the SRAM from them; the next save writes a binary save-state.
+   head = bytes.left(64).trimmed();
+   if ( head.startsWith("<?xml") || head.startsWith("<save") )
    {
-      if ( bytes.count() < MEM_64KB )
+      QDomDocument doc;
+      QString errors;
+
+      if ( doc.setContent(bytes) &&
+           (doc.documentElement().tagName() == "save") )
       {
-         for ( idx = bytes.count(); idx < MEM_64KB; idx++ )
-         {
-            bytes.append(zero);
-         }
+         return deserialize(doc,doc,errors);
       }
-
-      QString str;
-      str = "The save file found for this ROM:\n\n";
-      str += fileIn.fileName();
-      str += "\n\nis not 64KB in size and may not be\n";
-      str += "valid.  Game save data may be lost.";
-//      QMessageBox::warning(0,"Save file corrupted?",str);
-      bytes.truncate(MEM_64KB);
    }
 
-   for ( idx = 0; idx < bytes.count(); idx++ )
+   // A raw 64KB SRAM dump.
+   if ( bytes.count() == MEM_64KB )
    {
-      nesSetSRAMDataPhysical(idx,bytes.at(idx));
+      for ( idx = 0; idx < bytes.count(); idx++ )
+      {
+         nesSetSRAMDataPhysical(idx,bytes.at(idx));
+      }
+      return true;
    }
+
+   // Anything else is left alone rather than loaded into SRAM.
+   QString str;
+   str = "The save file found for this ROM:\n\n";
+   str += fileIn.fileName();
+   str += "\n\nis not a save-state, an XML save file or a 64KB\n";
+   str += "SRAM dump, and was not loaded.  Game save data\n";
+   str += "written from now on will replace it.";
+   emit saveStateRejected(str);
+
+   return false;
 }
@@ -2,7 +2,6 @@
 #define NESEMULATORTHREAD_H
 
 #include <QThread>
-#include <QSemaphore>
 
 #include "ixmlserializable.h"
 
@@ -25,6 +24,10 @@ public:
    virtual bool serializeContent(QFile& fileOut);
    virtual bool deserializeContent(QFile& fileIn);
 
+   // Binary snapshot of the whole machine (see nesSaveState).
+   bool saveState(QByteArray& state);
+   bool loadState(const QByteArray& state);
+
 public slots:
    void resetEmulator ();
    void softResetEmulator ();
@@ -35,14 +38,18 @@ public slots:
       m_joy[CONTROLLER1] = joy[CONTROLLER1];
       m_joy[CONTROLLER2] = joy[CONTROLLER2];
    }
+   void rewindEmulation ( bool rewind ) { m_isRewinding = rewind; }
+   void fastForwardEmulation ( bool fastForward ) { m_isFastForwarding = fastForward; }
    void primeEmulator ( CCartridge* pCartridge );
 
 signals:
    void emulatedFrame ();
+   void emulationRate ( int fps );
    void cartridgeLoaded ();
    void emulatorPaused (bool show);
    void emulatorReset();
    void emulatorStarted();
+   void saveStateRejected(QString message);
 
 protected:
    virtual void run ();
@@ -57,7 +64,10 @@ protected:
    bool          m_isResetting;
    bool          m_isSoftReset;
    bool          m_isStarting;
+   bool          m_isRewinding;
+   bool          m_isFastForwarding;
    uint32_t      m_joy [ NUM_CONTROLLERS ];
+   uint32_t      m_rewindJoy [ NUM_CONTROLLERS ];
 };
 
 #endif // NESEMULATORTHREAD_H
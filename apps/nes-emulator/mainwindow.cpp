@@ -49,6 +49,7 @@ MainWindow::MainWindow(QWidget* parent) :
    QObject::connect(this,SIGNAL(pauseEmulation(bool)),m_pNESEmulatorThread,SLOT(pauseEmulation(bool)));
    QObject::connect(this,SIGNAL(resetEmulator()),m_pNESEmulatorThread,SLOT(resetEmulator()));
    QObject::connect(this,SIGNAL(primeEmulator(CCartridge*)),m_pNESEmulatorThread,SLOT(primeEmulator(CCartridge*)));
+   QObject::connect(m_pNESEmulatorThread,SIGNAL(saveStateRejected(QString)),this,SLOT(saveStateRejected(QString)));
 
    // Add menu for emulator control.  The emulator control provides menu for itself!  =]
    QAction* firstEmuMenuAction = ui->menuEmulator->actions().at(0);
@@ -246,6 +247,11 @@ void MainWindow::saveEmulatorState(QString fileName)
    }
 }
 
+void MainWindow::saveStateRejected(QString message)
+{
+   QMessageBox::warning(this,"Save file corrupted?",message);
+}
+
 void MainWindow::loadCartridge ( QString fileName )
 {
    QString str;
@@ -685,6 +691,8 @@ void MainWindow::updateFromEmulatorPrefs(bool initial)
       ui->actionWave_7N106->setChecked(wave7N106);
       ui->actionWave_8N106->setChecked(wave8N106);
       nesSetN106AudioChannelMask(mask);
+
+      nesSetAudioSynthesis(EmulatorPrefsDialog::getBandLimitedAudio()?AUDIO_SYNTHESIS_BANDLIMITED:AUDIO_SYNTHESIS_AVERAGE);
    }
 
    if ( initial || EmulatorPrefsDialog::videoSettingsChanged() )
@@ -55,6 +55,7 @@ signals:
    void resetEmulator();
 
 private slots:
+   void saveStateRejected(QString message);
    void openRecentFile();
    void saveRecentFiles(QString fileName);
    void updateRecentFiles();
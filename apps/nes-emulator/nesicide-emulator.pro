@@ -37,7 +37,10 @@ RCC_DIR = $$DESTDIR
 UI_DIR = $$DESTDIR
 
 DEFINES -= UNICODE
-DEFINES += XML_SAVE_STATE
+
+# The XML save-state is an import/export format; uncomment to use it
+# for the cartridge save file instead of the binary save-state.
+#DEFINES += XML_SAVE_STATE
 
 TARGET = "nes-emulator"
 
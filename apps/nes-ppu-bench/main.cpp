@@ -0,0 +1,169 @@
+// PPU micro-benchmark for the NES emulator core.
+//
+// Runs a synthetic NROM cartridge whose CPU sits in a JMP loop with NMIs
+// enabled, so nearly all of the time goes into stepping the PPU, and
+// reports PPU dots per second for each video mode with rendering on and
+// off.  Build it against two versions of the library and compare the
+// numbers to see what a PPU change is worth.
+
+#include "nes_emulator_core.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#define DEFAULT_FRAMES 3000
+
+// The PPU renders 256x256 RGBA pixels into the TV buffer.
+#define TV_SIZE (256*256*4)
+
+// 32KB of PRG-ROM mapped at $8000; the program lives at $C000.
+#define PRG_SIZE      (MEM_32KB)
+#define PRG_CODE      0x4000
+#define PRG_VECTORS   0x7FFA
+#define PRG_MASK_BYTE 0x0002
+
+// SEI
+// LDA #$1E    ; show background and sprites
+// STA $2001
+// LDA #$80    ; NMI on vblank
+// STA $2000
+// JMP *
+// RTI         ; NMI/IRQ
+static const uint8_t program [] =
+{
+   0x78,
+   0xA9, 0x1E,
+   0x8D, 0x01, 0x20,
+   0xA9, 0x80,
+   0x8D, 0x00, 0x20,
+   0x4C, 0x0B, 0xC0,
+   0x40
+};
+
+// NMI, RESET, IRQ
+static const uint8_t vectors [] =
+{
+   0x0E, 0xC0,
+   0x00, 0xC0,
+   0x0E, 0xC0
+};
+
+static void usage ( const char* argv0 )
+{
+   fprintf(stderr,
+           "usage: %s [options]\n"
+           "\n"
+           "options:\n"
+           "  -f, --frames N     frames to run per case (default %d)\n",
+           argv0,DEFAULT_FRAMES);
+}
+
+static void loadCartridge ( bool rendering )
+{
+   std::vector<uint8_t> prg(PRG_SIZE,0xEA);
+   std::vector<uint8_t> chr(MEM_8KB,0);
+   uint32_t bank;
+   uint32_t idx;
+
+   memcpy(&prg[PRG_CODE],program,sizeof(program));
+   memcpy(&prg[PRG_VECTORS],vectors,sizeof(vectors));
+   if ( !rendering )
+   {
+      prg[PRG_CODE+PRG_MASK_BYTE] = 0x00;
+   }
+
+   // Give the pattern tables something other than transparent pixels.
+   for ( idx = 0; idx < MEM_8KB; idx++ )
+   {
+      chr[idx] = idx*0x9D;
+   }
+
+   nesUnloadROM();
+   for ( bank = 0; bank < PRG_SIZE/MEM_8KB; bank++ )
+   {
+      nesLoadPRGROMBank(bank,&prg[bank*MEM_8KB]);
+   }
+   nesLoadCHRROMBank(0,chr.data());
+   nesLoadROM();
+   nesSetHorizontalMirroring();
+   nesResetInitial(0);
+}
+
+static double runCase ( uint32_t mode, bool rendering, uint32_t frames, uint32_t scanlines )
+{
+   std::vector<int8_t> tv(TV_SIZE,0);
+   uint32_t joy [ NUM_CONTROLLERS ] = { 0, 0 };
+   uint32_t frame;
+
+   nesSetSystemMode(mode);
+   nesSetTVOut(tv.data());
+   loadCartridge(rendering);
+   nesClearAudioSamplesAvailable();
+
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+   for ( frame = 0; frame < frames; frame++ )
+   {
+      nesRun(joy);
+
+      // Keep the core's audio ring from wrapping.
+      while ( nesGetAudioSamplesAvailable() >= APU_SAMPLES )
+      {
+         nesGetAudioSamples(APU_SAMPLES);
+      }
+   }
+
+   double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+   return (seconds > 0.0) ? (((double)frames*scanlines*PPU_CYCLES_PER_SCANLINE)/seconds) : 0.0;
+}
+
+int main ( int argc, char* argv[] )
+{
+   static const struct
+   {
+      const char* name;
+      uint32_t    mode;
+      uint32_t    scanlines;
+   } modes [] =
+   {
+      { "NTSC",  MODE_NTSC,  SCANLINES_TOTAL_NTSC },
+      { "PAL",   MODE_PAL,   SCANLINES_TOTAL_PAL },
+      { "Dendy", MODE_DENDY, SCANLINES_TOTAL_DENDY }
+   };
+   uint32_t frames = DEFAULT_FRAMES;
+   uint32_t idx;
+   int      arg;
+
+   for ( arg = 1; arg < argc; arg++ )
+   {
+      std::string opt = argv[arg];
+      bool hasValue = (arg+1 < argc);
+
+      if ( ((opt == "-f") || (opt == "--frames")) && hasValue )
+      {
+         frames = strtoul(argv[++arg],NULL,0);
+      }
+      else
+      {
+         usage(argv[0]);
+         return 2;
+      }
+   }
+
+   printf("%-6s %-10s %14s\n","mode","rendering","Mdots/sec");
+   for ( idx = 0; idx < sizeof(modes)/sizeof(modes[0]); idx++ )
+   {
+      double on = runCase(modes[idx].mode,true,frames,modes[idx].scanlines);
+      double off = runCase(modes[idx].mode,false,frames,modes[idx].scanlines);
+
+      printf("%-6s %-10s %14.2f\n",modes[idx].name,"on",on/1000000.0);
+      printf("%-6s %-10s %14.2f\n",modes[idx].name,"off",off/1000000.0);
+   }
+
+   return 0;
+}
@@ -0,0 +1,259 @@
+// Query tool for NES execution trace files.
+//
+// Reads a trace file written while the execution tracer was streaming
+// (see nesStartTraceStream) and prints the samples matching the given
+// frame, CPU cycle, source, type and address filters.  Only the chunks
+// whose index entries allow a match are decompressed, so picking a few
+// frames out of a long trace is quick.
+
+#include "ctracestream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+static const char* sourceNames [] =
+{
+   "cpu", "ppu", "apu", "mapper"
+};
+
+static const char* typeNames [] =
+{
+   "unknown", "ifetch", "ofetch", "xfetch", "stolen", "read", "write", "dma",
+   "reset", "nmi", "irq", "irqrelease", "garbage", "bkgnd", "sprite",
+   "ppuframe", "sprite0", "vblankstart", "vblankend", "prerenderstart",
+   "prerenderend", "quietstart", "quietend", "ppuframeend", "apuframe",
+   "sequencer", "apuframeend"
+};
+
+static const char* targetNames [] =
+{
+   "-", "ram", "ppureg", "apureg", "ioreg", "sram", "exram", "mapper",
+   "pattern", "nametable", "attribute", "palette", "extra"
+};
+
+#define NUM_NAMES(names) (sizeof(names)/sizeof(names[0]))
+
+static const char* lookupName ( const char** names, uint32_t count, int8_t value )
+{
+   return (((uint8_t)value) < count) ? names[(uint8_t)value] : "?";
+}
+
+static int32_t findName ( const char** names, uint32_t count, const char* name )
+{
+   uint32_t idx;
+
+   for ( idx = 0; idx < count; idx++ )
+   {
+      if ( !strcmp(names[idx],name) )
+      {
+         return idx;
+      }
+   }
+   return -1;
+}
+
+static void usage ( const char* argv0 )
+{
+   uint32_t idx;
+
+   fprintf(stderr,
+           "usage: %s [options] file\n"
+           "\n"
+           "options:\n"
+           "  -i, --info         print the chunk index instead of samples\n"
+           "  -f, --frame A[:B]  frames A through B\n"
+           "  -c, --cycle A[:B]  CPU cycles A through B\n"
+           "  -a, --addr A[:B]   addresses A through B\n"
+           "  -s, --source NAME  samples from this source (repeatable)\n"
+           "  -t, --type NAME    samples of this type (repeatable)\n"
+           "  -n, --limit N      stop after N samples\n"
+           "  --count            print only the number of matches\n"
+           "\n"
+           "sources:",
+           argv0);
+   for ( idx = 0; idx < NUM_NAMES(sourceNames); idx++ )
+   {
+      fprintf(stderr," %s",sourceNames[idx]);
+   }
+   fprintf(stderr,"\ntypes:");
+   for ( idx = 0; idx < NUM_NAMES(typeNames); idx++ )
+   {
+      fprintf(stderr,"%s%s",(idx%8)?" ":"\n  ",typeNames[idx]);
+   }
+   fprintf(stderr,"\n");
+}
+
+static void parseRange ( const char* arg, uint32_t* first, uint32_t* last )
+{
+   char* end;
+
+   (*first) = strtoul(arg,&end,0);
+   (*last) = ((*end) == ':') ? strtoul(end+1,NULL,0) : (*first);
+}
+
+struct PrintState
+{
+   uint64_t limit;
+   uint64_t printed;
+};
+
+static bool printSample ( const TracerInfo* pSample, uint32_t cpuCycle, void* userData )
+{
+   PrintState* state = (PrintState*)userData;
+
+   printf("%8u %10u %10u %-6s %-14s %-9s %04X %02X",
+          pSample->frame,cpuCycle,pSample->cycle,
+          lookupName(sourceNames,NUM_NAMES(sourceNames),pSample->source),
+          lookupName(typeNames,NUM_NAMES(typeNames),pSample->type),
+          lookupName(targetNames,NUM_NAMES(targetNames),pSample->target),
+          pSample->addr,pSample->data);
+   if ( pSample->disassemble[3] == 0 )
+   {
+      printf("  op %02X %02X %02X",pSample->disassemble[0],pSample->disassemble[1],pSample->disassemble[2]);
+   }
+   if ( pSample->regsset )
+   {
+      printf("  A:%02X X:%02X Y:%02X SP:%02X F:%02X",pSample->a,pSample->x,pSample->y,pSample->sp,pSample->f);
+   }
+   if ( pSample->ea != 0xFFFFFFFF )
+   {
+      printf("  EA:%04X",pSample->ea);
+   }
+   printf("\n");
+
+   state->printed++;
+   return state->printed < state->limit;
+}
+
+static void printInfo ( const CTraceFile& file )
+{
+   uint32_t chunk;
+
+   printf("%u chunks, %llu samples\n",file.GetNumChunks(),(unsigned long long)file.GetNumSamples());
+   printf("%6s %12s %6s %8s %8s %8s %8s %10s %10s %8s %8s %16s\n",
+          "chunk","sample","count","raw","packed","frame","to","cycle","to","types","sources","pages");
+   for ( chunk = 0; chunk < file.GetNumChunks(); chunk++ )
+   {
+      const TraceChunkInfo& info = file.GetChunkInfo(chunk);
+
+      printf("%6u %12llu %6u %8u %8u %8u %8u %10u %10u %08X %8X %016llX\n",
+             chunk,(unsigned long long)info.firstSample,info.samples,info.rawSize,info.packedSize,
+             info.firstFrame,info.lastFrame,info.firstCycle,info.lastCycle,
+             info.typeMask,info.sourceMask,(unsigned long long)info.addrPages);
+   }
+}
+
+int main ( int argc, char* argv[] )
+{
+   CTraceFile  file;
+   TraceFilter filter;
+   PrintState  state;
+   const char* fileName = NULL;
+   bool        info = false;
+   bool        countOnly = false;
+   uint32_t    first;
+   uint32_t    last;
+   int32_t     value;
+   int         arg;
+
+   CTraceFile::ClearFilter(&filter);
+   filter.sourceMask = 0;
+   filter.typeMask = 0;
+   state.limit = (uint64_t)-1;
+   state.printed = 0;
+
+   for ( arg = 1; arg < argc; arg++ )
+   {
+      std::string opt = argv[arg];
+      bool hasValue = (arg+1 < argc);
+
+      if ( (opt == "-i") || (opt == "--info") )
+      {
+         info = true;
+      }
+      else if ( opt == "--count" )
+      {
+         countOnly = true;
+      }
+      else if ( ((opt == "-f") || (opt == "--frame")) && hasValue )
+      {
+         parseRange(argv[++arg],&filter.firstFrame,&filter.lastFrame);
+      }
+      else if ( ((opt == "-c") || (opt == "--cycle")) && hasValue )
+      {
+         parseRange(argv[++arg],&filter.firstCycle,&filter.lastCycle);
+      }
+      else if ( ((opt == "-a") || (opt == "--addr")) && hasValue )
+      {
+         parseRange(argv[++arg],&first,&last);
+         filter.firstAddr = first;
+         filter.lastAddr = last;
+      }
+      else if ( ((opt == "-s") || (opt == "--source")) && hasValue &&
+                ((value = findName(sourceNames,NUM_NAMES(sourceNames),argv[arg+1])) >= 0) )
+      {
+         filter.sourceMask |= 1<<value;
+         arg++;
+      }
+      else if ( ((opt == "-t") || (opt == "--type")) && hasValue &&
+                ((value = findName(typeNames,NUM_NAMES(typeNames),argv[arg+1])) >= 0) )
+      {
+         filter.typeMask |= 1<<value;
+         arg++;
+      }
+      else if ( ((opt == "-n") || (opt == "--limit")) && hasValue )
+      {
+         state.limit = strtoull(argv[++arg],NULL,0);
+      }
+      else if ( (opt[0] != '-') && !fileName )
+      {
+         fileName = argv[arg];
+      }
+      else
+      {
+         usage(argv[0]);
+         return 2;
+      }
+   }
+
+   if ( !fileName )
+   {
+      usage(argv[0]);
+      return 2;
+   }
+   if ( !file.Open(fileName) )
+   {
+      fprintf(stderr,"%s: cannot read trace file %s\n",argv[0],fileName);
+      return 1;
+   }
+
+   if ( info )
+   {
+      printInfo(file);
+      return 0;
+   }
+
+   if ( !filter.sourceMask )
+   {
+      filter.sourceMask = 0xFFFFFFFF;
+   }
+   if ( !filter.typeMask )
+   {
+      filter.typeMask = 0xFFFFFFFF;
+   }
+
+   if ( countOnly )
+   {
+      printf("%llu\n",(unsigned long long)file.Query(filter,NULL,NULL));
+   }
+   else if ( state.limit )
+   {
+      printf("%8s %10s %10s %-6s %-14s %-9s %4s %2s\n",
+             "frame","cpucycle","cycle","source","type","target","addr","dt");
+      file.Query(filter,printSample,&state);
+   }
+
+   return 0;
+}
@@ -24,5 +24,7 @@ echo Building FamiPlayer...
 ( cd build/famiplayer; qmake; make )
 echo Building NES Emulator...
 ( cd build/famitracker; qmake; make )
+echo Building NES Emulator CLI...
+( cd build/nes-emulator-cli; qmake; make )
 
 exit 0
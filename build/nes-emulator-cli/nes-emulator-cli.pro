@@ -0,0 +1,16 @@
+TEMPLATE = subdirs
+
+SUBDIRS = nes-emulator-lib nes-emulator-cli nes-ppu-bench nes-cpu-bench nes-bench nes-trace-query
+
+nes-emulator-lib.file = ../../libs/nes/nes-emulator-lib.pro
+nes-emulator-cli.file = ../../apps/nes-emulator-cli/nes-emulator-cli.pro
+nes-ppu-bench.file = ../../apps/nes-ppu-bench/nes-ppu-bench.pro
+nes-cpu-bench.file = ../../apps/nes-cpu-bench/nes-cpu-bench.pro
+nes-bench.file = ../../apps/nes-bench/nes-bench.pro
+nes-trace-query.file = ../../apps/nes-trace-query/nes-trace-query.pro
+
+nes-emulator-cli.depends = nes-emulator-lib
+nes-ppu-bench.depends = nes-emulator-lib
+nes-cpu-bench.depends = nes-emulator-lib
+nes-bench.depends = nes-emulator-lib
+nes-trace-query.depends = nes-emulator-lib
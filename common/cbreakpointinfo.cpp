@@ -8,11 +8,13 @@ CBreakpointInfo::CBreakpointInfo()
 void CBreakpointInfo::ToggleEnabled ( int bp )
 {
    m_breakpoint [ bp ].enabled = !m_breakpoint [ bp ].enabled;
+   BreakpointsChanged ();
 }
 
 void CBreakpointInfo::SetEnabled ( int bp, bool enabled )
 {
    m_breakpoint [ bp ].enabled = enabled;
+   BreakpointsChanged ();
 }
 
 int CBreakpointInfo::FindExactMatch ( int type, eBreakpointItemType itemType, int event, int item1, int item1Absolute, int item2, int mask, bool maskExclusive, eBreakpointConditionType conditionType, int condition, eBreakpointDataType dataType, int data )
@@ -61,6 +63,7 @@ void CBreakpointInfo::ModifyBreakpoint ( int bp, BreakpointInfo* pBreakpoint )
                        pBreakpoint->dataType,
                        pBreakpoint->data,
                        pBreakpoint->enabled);
+      BreakpointsChanged ();
    }
 }
 
@@ -89,6 +92,7 @@ int CBreakpointInfo::AddBreakpoint ( BreakpointInfo* pBreakpoint )
                          pBreakpoint->data,
                          pBreakpoint->enabled );
       m_numBreakpoints++;
+      BreakpointsChanged ();
    }
    else
    {
@@ -118,6 +122,7 @@ int CBreakpointInfo::AddBreakpoint ( int type, eBreakpointItemType itemType, int
                          data,
                          enabled );
       m_numBreakpoints++;
+      BreakpointsChanged ();
    }
    else
    {
@@ -153,6 +158,7 @@ void CBreakpointInfo::RemoveBreakpoint ( int index )
    }
 
    m_numBreakpoints--;
+   BreakpointsChanged ();
 }
 
 BreakpointStatus CBreakpointInfo::GetStatus ( int idx )
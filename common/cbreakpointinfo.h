@@ -1,7 +1,7 @@
 #ifndef CBREAKPOINTINFO_H
 #define CBREAKPOINTINFO_H
 
-#define NUM_BREAKPOINTS 10
+#define NUM_BREAKPOINTS 64
 
 #include <stdlib.h>
 #include <stdint.h>
@@ -157,6 +157,7 @@ class CBreakpointInfo
 {
 public:
    CBreakpointInfo();
+   virtual ~CBreakpointInfo() {}
    void ConstructBreakpoint ( BreakpointInfo* pBreakpoint, int type, eBreakpointItemType itemType, int event, int item1, int item1Absolute, int item2, int mask, bool maskExclusive, eBreakpointConditionType conditionType, int condition, eBreakpointDataType dataType, int data, bool enabled );
    int AddBreakpoint ( BreakpointInfo* pBreakpoint );
    int AddBreakpoint ( int type, eBreakpointItemType itemType, int event, int item1, int item1Absolute, int item2, int mask, bool maskExclusive, eBreakpointConditionType conditionType, int condition, eBreakpointDataType dataType, int data, bool enabled );
@@ -181,6 +182,10 @@ protected:
    // Must be provided by subclass.
    virtual void ModifyBreakpoint ( BreakpointInfo* pBreakpoint, int type, eBreakpointItemType itemType, int event, int item1, int item1Absolute, int item2, int mask, bool maskExclusive, eBreakpointConditionType conditionType, int condition, eBreakpointDataType dataType, int data, bool enabled ) = 0;
 
+   // Called whenever a breakpoint is added, changed, removed, enabled or
+   // disabled, so subclasses can rebuild any lookup structures they keep.
+   virtual void BreakpointsChanged ( void ) {}
+
 protected:
    BreakpointInfo m_breakpoint [ NUM_BREAKPOINTS ];
    int            m_numBreakpoints;
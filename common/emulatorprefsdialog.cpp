@@ -26,6 +26,8 @@ bool EmulatorPrefsDialog::vausArkanoidMouseMap[NUM_CONTROLLERS][IO_Vaus_MAX];
 int EmulatorPrefsDialog::vausArkanoidTrimPot[NUM_CONTROLLERS];
 int EmulatorPrefsDialog::tvStandard;
 bool EmulatorPrefsDialog::pauseOnKIL;
+int EmulatorPrefsDialog::runAhead;
+int EmulatorPrefsDialog::fastForwardSpeed;
 bool EmulatorPrefsDialog::square1Enabled;
 bool EmulatorPrefsDialog::square2Enabled;
 bool EmulatorPrefsDialog::triangleEnabled;
@@ -42,6 +44,7 @@ bool EmulatorPrefsDialog::wave5N106Enabled;
 bool EmulatorPrefsDialog::wave6N106Enabled;
 bool EmulatorPrefsDialog::wave7N106Enabled;
 bool EmulatorPrefsDialog::wave8N106Enabled;
+bool EmulatorPrefsDialog::bandLimitedAudio;
 int EmulatorPrefsDialog::scalingFactor;
 bool EmulatorPrefsDialog::linearInterpolation;
 bool EmulatorPrefsDialog::aspect43;
@@ -79,6 +82,13 @@ EmulatorPrefsDialog::EmulatorPrefsDialog(QString target,QWidget* parent) :
 
    ui->tvStandard->setCurrentIndex(tvStandard);
    ui->pauseOnKIL->setChecked(pauseOnKIL);
+   ui->runAhead->setCurrentIndex(runAhead);
+   ui->fastForwardSpeed->setCurrentIndex(fastForwardSpeed);
+#if defined(IDE)
+   // Run-ahead hides the debugger from speculative frames; it is for playing.
+   ui->runAheadLabel->setVisible(false);
+   ui->runAhead->setVisible(false);
+#endif
 
    ui->square1->setChecked(square1Enabled);
    ui->square2->setChecked(square2Enabled);
@@ -96,6 +106,7 @@ EmulatorPrefsDialog::EmulatorPrefsDialog(QString target,QWidget* parent) :
    ui->wave6N106->setChecked(wave6N106Enabled);
    ui->wave7N106->setChecked(wave7N106Enabled);
    ui->wave8N106->setChecked(wave8N106Enabled);
+   ui->bandLimitedAudio->setChecked(bandLimitedAudio);
 
    ui->scalingFactor->setCurrentIndex(scalingFactor);
    ui->linearInterpolation->setChecked(linearInterpolation);
@@ -201,6 +212,7 @@ void EmulatorPrefsDialog::readSettings()
    wave7N106Enabled = settings.value("Wave7",QVariant(true)).toBool();
    wave8N106Enabled = settings.value("Wave8",QVariant(true)).toBool();
    settings.endGroup();
+   bandLimitedAudio = settings.value("BandLimited",QVariant(false)).toBool();
    settings.endGroup();
 
    settings.beginGroup("EmulatorPreferences/NES/Video");
@@ -220,6 +232,8 @@ void EmulatorPrefsDialog::readSettings()
    settings.beginGroup("EmulatorPreferences/NES/System");
    tvStandard = settings.value("TVStandard",QVariant(MODE_NTSC)).toInt();
    pauseOnKIL = settings.value("PauseOnKIL",QVariant(true)).toBool();
+   runAhead = settings.value("RunAhead",QVariant(0)).toInt();
+   fastForwardSpeed = settings.value("FastForwardSpeed",QVariant(1)).toInt();
    settings.endGroup();
 
    settings.beginGroup("EmulatorPreferences/C64");
@@ -293,7 +307,9 @@ void EmulatorPrefsDialog::writeSettings()
 
    // Set query flags.
    if ( (tvStandard != ui->tvStandard->currentIndex()) ||
-        (pauseOnKIL != ui->pauseOnKIL->isChecked()) )
+        (pauseOnKIL != ui->pauseOnKIL->isChecked()) ||
+        (runAhead != ui->runAhead->currentIndex()) ||
+        (fastForwardSpeed != ui->fastForwardSpeed->currentIndex()) )
    {
       systemUpdated = true;
    }
@@ -322,6 +338,10 @@ void EmulatorPrefsDialog::writeSettings()
    {
       audioUpdated = true;
    }
+   if ( bandLimitedAudio != ui->bandLimitedAudio->isChecked() )
+   {
+      audioUpdated = true;
+   }
    if ( (scalingFactor != ui->scalingFactor->currentIndex()) ||
         (aspect43 != ui->aspect43->isChecked()) )
    {
@@ -401,6 +421,8 @@ void EmulatorPrefsDialog::writeSettings()
 
    tvStandard = ui->tvStandard->currentIndex();
    pauseOnKIL = ui->pauseOnKIL->isChecked();
+   runAhead = ui->runAhead->currentIndex();
+   fastForwardSpeed = ui->fastForwardSpeed->currentIndex();
 
    square1Enabled = ui->square1->isChecked();
    square2Enabled = ui->square2->isChecked();
@@ -418,6 +440,7 @@ void EmulatorPrefsDialog::writeSettings()
    wave6N106Enabled = ui->wave6N106->isChecked();
    wave7N106Enabled = ui->wave7N106->isChecked();
    wave8N106Enabled = ui->wave8N106->isChecked();
+   bandLimitedAudio = ui->bandLimitedAudio->isChecked();
 
    scalingFactor = ui->scalingFactor->currentIndex();
    linearInterpolation = ui->linearInterpolation->isChecked();
@@ -491,6 +514,7 @@ void EmulatorPrefsDialog::writeSettings()
    settings.setValue("Wave7",wave7N106Enabled);
    settings.setValue("Wave8",wave8N106Enabled);
    settings.endGroup();
+   settings.setValue("BandLimited",bandLimitedAudio);
    settings.endGroup();
 
    settings.beginGroup("EmulatorPreferences/NES/Video");
@@ -510,6 +534,8 @@ void EmulatorPrefsDialog::writeSettings()
    settings.beginGroup("EmulatorPreferences/NES/System");
    settings.setValue("TVStandard",tvStandard);
    settings.setValue("PauseOnKIL",pauseOnKIL);
+   settings.setValue("RunAhead",runAhead);
+   settings.setValue("FastForwardSpeed",fastForwardSpeed);
    settings.endGroup();
 
    settings.beginGroup("EmulatorPreferences/C64");
@@ -842,6 +868,27 @@ bool EmulatorPrefsDialog::getPauseOnKIL()
    return pauseOnKIL;
 }
 
+int EmulatorPrefsDialog::getRunAhead()
+{
+#if defined(IDE)
+   return 0;
+#else
+   return runAhead;
+#endif
+}
+
+int EmulatorPrefsDialog::getFastForwardSpeed()
+{
+   // Frames run per frame shown; 0 is as many as fit in a frame's time.
+   static const int speeds [] = { 2, 4, 8, 0 };
+
+   if ( (fastForwardSpeed < 0) || (fastForwardSpeed > 3) )
+   {
+      return speeds[1];
+   }
+   return speeds[fastForwardSpeed];
+}
+
 void EmulatorPrefsDialog::setPauseOnTaskSwitch(bool pause)
 {
    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "CSPSoftware", "NESICIDE");
@@ -39,6 +39,8 @@ public:
    static int getControllerSpecial(int port);
    static int getTVStandard();
    static bool getPauseOnKIL();
+   static int getRunAhead();
+   static int getFastForwardSpeed();
    static bool getSquare1Enabled() { return square1Enabled; }
    static bool getSquare2Enabled() { return square2Enabled; }
    static bool getTriangleEnabled() { return triangleEnabled; }
@@ -55,6 +57,7 @@ public:
    static bool getWave6N106Enabled() { return wave6N106Enabled; }
    static bool getWave7N106Enabled() { return wave7N106Enabled; }
    static bool getWave8N106Enabled() { return wave8N106Enabled; }
+   static bool getBandLimitedAudio() { return bandLimitedAudio; }
    static int getScalingFactor();
    static bool getLinearInterpolation();
    static bool get43Aspect();
@@ -114,6 +117,8 @@ private:
    static int vausArkanoidTrimPot[NUM_CONTROLLERS];
    static int tvStandard;
    static bool pauseOnKIL;
+   static int runAhead;
+   static int fastForwardSpeed;
    static bool square1Enabled;
    static bool square2Enabled;
    static bool triangleEnabled;
@@ -130,6 +135,7 @@ private:
    static bool wave6N106Enabled;
    static bool wave7N106Enabled;
    static bool wave8N106Enabled;
+   static bool bandLimitedAudio;
    static int scalingFactor;
    static bool linearInterpolation;
    static bool aspect43;
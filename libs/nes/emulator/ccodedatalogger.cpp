@@ -17,13 +17,14 @@
 #include "ccodedatalogger.h"
 
 #include "nes_emulator_core.h"
+#include "cnesperf.h"
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
 
-uint32_t CCodeDataLogger::m_curCycle = 0;
-LoggerInfo* CCodeDataLogger::m_pLastLoad = NULL;
+CCodeDataLogger::State CCodeDataLogger::m_defaultState;
+thread_local CCodeDataLogger::State* CCodeDataLogger::m_state = &CCodeDataLogger::m_defaultState;
 
 CCodeDataLogger::CCodeDataLogger(uint32_t size, uint32_t mask)
 {
@@ -68,6 +69,8 @@ void CCodeDataLogger::LogAccess ( uint32_t cycle, uint32_t addr, uint8_t data, i
 {
    LoggerInfo* pLogger = m_pLogger+(addr&m_mask);
 
+   NESPERFSCOPE ( eNESPerf_CodeDataLogger );
+
    pLogger->cpuAddr = addr;
    pLogger->cycle = cycle;
    pLogger->type = type;
@@ -85,18 +88,18 @@ void CCodeDataLogger::LogAccess ( uint32_t cycle, uint32_t addr, uint8_t data, i
 
    pLogger->pLastLoad = NULL;
 
-   if ( (m_pLastLoad) &&
+   if ( (m_state->m_pLastLoad) &&
          (type == eLogger_DataWrite) )
    {
-      pLogger->pLastLoad = m_pLastLoad;
+      pLogger->pLastLoad = m_state->m_pLastLoad;
    }
 
    if ( type == eLogger_DataRead )
    {
-      m_pLastLoad = pLogger;
+      m_state->m_pLastLoad = pLogger;
    }
 
-   m_curCycle = cycle;
+   m_state->m_curCycle = cycle;
 }
 
 void CCodeDataLogger::GetPrintable ( uint32_t addr, int32_t subItem, char* str )
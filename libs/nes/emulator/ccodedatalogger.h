@@ -78,7 +78,7 @@ public:
 
    static inline uint32_t GetCurCycle ( void )
    {
-      return m_curCycle;
+      return m_state->m_curCycle;
    }
    inline uint32_t GetMaxCount ( void )
    {
@@ -88,9 +88,17 @@ public:
 protected:
    uint32_t        m_size;
    uint32_t        m_mask;
-   static uint32_t m_curCycle;
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      uint32_t m_curCycle = 0;
+      LoggerInfo* m_pLastLoad = NULL;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
+
    uint32_t m_maxCount;
-   static LoggerInfo* m_pLastLoad;
    LoggerInfo* m_pLogger;
 };
 
@@ -22,43 +22,60 @@
 #include "cnesio.h"
 #include "cnesapu.h"
 
-int32_t  CNES::m_videoMode = MODE_NTSC;
-int32_t  CNES::m_controllerType [] = { IO_StandardJoypad, IO_Zapper };
-int32_t  CNES::m_controllerPositionX [] = { 0, };
-int32_t  CNES::m_controllerPositionY [] = { 0, };
-int32_t  CNES::m_windowX1 = 0;
-int32_t  CNES::m_windowY1 = 0;
-int32_t  CNES::m_windowX2 = 0;
-int32_t  CNES::m_windowY2 = 0;
-
-bool     CNES::m_bReplay = false;
-bool     CNES::m_bRecord = true;
-uint32_t CNES::m_frame = 0;
-
-CTracer*         CNES::m_tracer = NULL;
-
-CBreakpointInfo* CNES::m_breakpoints;
-bool            CNES::m_bBreakpointsEnabled = true;
-bool            CNES::m_bAtBreakpoint = false;
-bool            CNES::m_bStepCPUBreakpoint = false;
-bool            CNES::m_bStepPPUBreakpoint = false;
-int32_t         CNES::m_ppuCycleToStepTo = -1;
-uint32_t        CNES::m_ppuFrameToStepTo = -1;
+CNES::State CNES::m_defaultState;
+thread_local CNES::State* CNES::m_state = &CNES::m_defaultState;
 
 static CNES __init __attribute__((unused));
 
 CNES::CNES()
 {
-   m_breakpoints = new CNESBreakpointInfo();
-
-   m_tracer = new CTracer();
+   CREATE();
 }
 
 CNES::~CNES()
 {
-   delete m_breakpoints;
+   DESTROY();
+}
+
+void CNES::CREATE ( void )
+{
+   m_state->m_breakpoints = new CNESBreakpointInfo();
+
+   m_state->m_tracer = new CTracer();
+}
+
+void CNES::DESTROY ( void )
+{
+   delete m_state->m_breakpoints;
+
+   delete m_state->m_tracer;
+}
+
+void CNES::SAVESTATE ( CNESStateWriter& state )
+{
+   MAPPERSYNC ();
+
+   state.BeginChunk ( NES_STATE_CHUNK_NES, NES_STATE_VERSION_NES );
+   state.Put ( m_state->m_videoMode );
+   state.Put ( m_state->m_frame );
+   state.EndChunk ();
+}
+
+bool CNES::LOADSTATE ( CNESStateReader& state )
+{
+   int32_t videoMode;
 
-   delete m_tracer;
+   // A state taken on a system with different timing can't be resumed.
+   if ( !state.FindChunk(NES_STATE_CHUNK_NES,NES_STATE_VERSION_NES) ||
+        !state.Get(videoMode) ||
+        (videoMode != m_state->m_videoMode) )
+   {
+      return false;
+   }
+   m_state->m_mapperPendingCycles = 0;
+   m_state->m_mapperSyncCycles = 1;
+
+   return state.Get ( m_state->m_frame );
 }
 
 uint8_t CNES::_MEM ( uint32_t addr )
@@ -85,27 +102,28 @@ uint8_t CNES::_MEM ( uint32_t addr )
    }
 }
 
-char* CNES::DISASSEMBLY ( uint32_t addr )
+char* CNES::DISASSEMBLY ( uint32_t addr, char* buffer )
 {
    if ( addr < 0x800 )
    {
-      return C6502::DISASSEMBLY ( addr );
+      return C6502::DisassemblyText ( C6502::DISASSEMBLY(addr), buffer );
    }
    else if ( addr < 0x5C00 )
    {
-      return "N/A";
+      strcpy ( buffer, "N/A" );
+      return buffer;
    }
    else if ( addr < 0x6000 )
    {
-      return CROM::EXRAMDISASSEMBLY ( addr );
+      return C6502::DisassemblyText ( CROM::EXRAMDISASSEMBLY(addr), buffer );
    }
    else if ( addr < 0x8000 )
    {
-      return CROM::SRAMDISASSEMBLY ( addr );
+      return C6502::DisassemblyText ( CROM::SRAMDISASSEMBLY(addr), buffer );
    }
    else
    {
-      return CROM::PRGROMDISASSEMBLY ( addr );
+      return C6502::DisassemblyText ( CROM::PRGROMDISASSEMBLY(addr), buffer );
    }
 }
 
@@ -115,6 +133,28 @@ void CNES::DISASSEMBLE ( void )
    CROM::DISASSEMBLE();
 }
 
+bool CNES::DISASSEMBLYCHANGES ( uint32_t addr, int32_t* firstRow, int32_t* endRow, int32_t* rowDelta )
+{
+   DisassemblyState view;
+
+   C6502::DISASSEMBLYCHANGESCLR ( &view );
+
+   if ( addr < 0x800 )
+   {
+      C6502::DISASSEMBLYCHANGES ( C6502::DISASSEMBLYSTATE(), 0, &view );
+      C6502::DISASSEMBLYCHANGESCLR ( C6502::DISASSEMBLYSTATE() );
+   }
+   else if ( addr >= 0x5C00 )
+   {
+      CROM::DISASSEMBLYCHANGES ( addr, &view );
+   }
+
+   (*firstRow) = view.changedFirst;
+   (*endRow) = view.changedEnd;
+   (*rowDelta) = view.changedDelta;
+   return view.changedFirst <= view.changedEnd;
+}
+
 void CNES::PRINTABLEADDR ( char* buffer, uint32_t addr )
 {
    if ( addr < 0x5C00 )
@@ -265,20 +305,55 @@ uint32_t CNES::ABSADDR ( uint32_t addr )
    }
 }
 
+void CNES::MAPPERSYNC ( void )
+{
+   if ( m_state->m_mapperPendingCycles )
+   {
+      m_state->m_mapperFunc->skip_cpu ( m_state->m_mapperPendingCycles );
+      m_state->m_mapperPendingCycles = 0;
+   }
+
+   // The caller may be about to change what the mapper will do next;
+   // ask it again on the next cycle.
+   m_state->m_mapperSyncCycles = 1;
+}
+
+void CNES::MAPPERCATCHUP ( void )
+{
+   uint32_t idle;
+
+   // Every cycle but this one was predicted to be idle.
+   if ( m_state->m_mapperPendingCycles > 1 )
+   {
+      m_state->m_mapperFunc->skip_cpu ( m_state->m_mapperPendingCycles-1 );
+   }
+   m_state->m_mapperPendingCycles = 0;
+
+   m_state->m_mapperFunc->sync_cpu ();
+
+   idle = m_state->m_mapperFunc->cpu_idle ();
+   m_state->m_mapperSyncCycles = (idle != MAPPER_IDLE_FOREVER) ? (idle+1) : idle;
+}
+
 void CNES::RESET ( uint32_t mapper, bool soft )
 {
    if ( nesIsDebuggable() )
    {
       // Clear execution tracer sample buffer...
-      m_tracer->ClearSampleBuffer ();
+      m_state->m_tracer->ClearSampleBuffer ();
 
       // Zero visualizer markers...
       C6502::MARKERS()->ZeroAllMarkers();
    }
 
    // Reset mapper and set up quick access pointer to mapper function table.
-   MAPPERFUNC = &(_mapperfunc[mapper]);
-   MAPPERFUNC->reset ( soft );
+   m_state->m_mapperFunc = &(_mapperfunc[mapper]);
+   m_state->m_mapperPendingCycles = 0;
+   m_state->m_mapperSyncCycles = 1;
+   MAPPERFUNC()->reset ( soft );
+
+   // The mapper has set up its banks; point the CPU's page table at them.
+   CROM::MAPCPUPAGES ();
 
    // Reset emulated PPU...
    CPPU::RESET ( soft );
@@ -288,32 +363,34 @@ void CNES::RESET ( uint32_t mapper, bool soft )
    // The SDL callback triggers emulation...
    C6502::RESET ( soft );
 
-   m_frame = 0;
+   m_state->m_frame = 0;
 }
 
 void CNES::STEPCPUBREAKPOINT ( void )
 {
-   m_bStepCPUBreakpoint = true;
+   m_state->m_bStepCPUBreakpoint = true;
 }
 
 void CNES::STEPPPUBREAKPOINT ( bool goFrame )
 {
-   m_bStepPPUBreakpoint = true;
+   m_state->m_bStepPPUBreakpoint = true;
    if ( goFrame )
    {
-      m_ppuFrameToStepTo = CPPU::_FRAME()+1;
-      m_ppuCycleToStepTo = CPPU::_CYCLES();
+      m_state->m_ppuFrameToStepTo = CPPU::_FRAME()+1;
+      m_state->m_ppuCycleToStepTo = CPPU::_CYCLES();
    }
    else
    {
-      m_ppuFrameToStepTo = -1;
-      m_ppuCycleToStepTo = -1;
+      m_state->m_ppuFrameToStepTo = -1;
+      m_state->m_ppuCycleToStepTo = -1;
    }
 }
 
-void CNES::CHECKBREAKPOINT ( eBreakpointTarget target, eBreakpointType type, int32_t data, int32_t event )
+void CNES::EVALUATEBREAKPOINT ( eBreakpointTarget target, eBreakpointType type, int32_t data, int32_t event )
 {
    int32_t idx;
+   const uint8_t* pArmed;
+   int32_t numArmed;
    BreakpointInfo* pBreakpoint;
    CRegisterData* pRegister;
    CBitfieldData* pBitfield;
@@ -322,539 +399,538 @@ void CNES::CHECKBREAKPOINT ( eBreakpointTarget target, eBreakpointType type, int
    int32_t value = 0;
    bool force = false;
 
+   NESPERFTIME ( eNESPerf_Breakpoints );
+
    // If stepping, break...
-   if ( (m_bStepCPUBreakpoint) &&
+   if ( (m_state->m_bStepCPUBreakpoint) &&
         (target == eBreakInCPU) &&
         (type == eBreakOnCPUExecution) )
    {
-      m_bStepCPUBreakpoint = false;
+      m_state->m_bStepCPUBreakpoint = false;
       force = true;
    }
-   else if ( (m_bStepPPUBreakpoint) &&
+   else if ( (m_state->m_bStepPPUBreakpoint) &&
              (target == eBreakInPPU) &&
              (type == eBreakOnPPUCycle) &&
-             ((m_ppuCycleToStepTo == -1) ||
-             ((m_ppuCycleToStepTo == CPPU::_CYCLES()) &&
-             (m_ppuFrameToStepTo == CPPU::_FRAME()))) )
+             ((m_state->m_ppuCycleToStepTo == -1) ||
+             ((m_state->m_ppuCycleToStepTo == CPPU::_CYCLES()) &&
+             (m_state->m_ppuFrameToStepTo == CPPU::_FRAME()))) )
    {
-      m_bStepPPUBreakpoint = false;
+      m_state->m_bStepPPUBreakpoint = false;
       force = true;
    }
    // For all breakpoints...if we're not stepping...
    else
    {
-      for ( idx = 0; idx < m_breakpoints->GetNumBreakpoints(); idx++ )
+      // Hits are only reported for the check that caused the break.
+      if ( m_state->m_bBreakpointsHit )
       {
-         // Get breakpoint data...
-         pBreakpoint = m_breakpoints->GetBreakpoint(idx);
+         for ( idx = 0; idx < m_state->m_breakpoints->GetNumBreakpoints(); idx++ )
+         {
+            m_state->m_breakpoints->GetBreakpoint(idx)->hit = false;
+         }
+         m_state->m_bBreakpointsHit = false;
+      }
 
-         // Not hit yet...
-         pBreakpoint->hit = false;
+      // Nothing to do if no breakpoint covers the address.
+      if ( ((type == eBreakOnCPUExecution) && (!m_state->m_breakpoints->IsExecutionArmed(C6502::__PCSYNC()))) ||
+           ((type == eBreakOnCPUMemoryRead) && (!m_state->m_breakpoints->IsReadArmed(C6502::_EA()))) ||
+           ((type == eBreakOnCPUMemoryWrite) && (!m_state->m_breakpoints->IsWriteArmed(C6502::_EA()))) )
+      {
+         return;
+      }
 
-         // Is this breakpoint enabled?
-         if ( pBreakpoint->enabled )
+      // Only the enabled breakpoints for the specified target...
+      pArmed = m_state->m_breakpoints->GetArmed(target,&numArmed);
+      for ( idx = 0; idx < numArmed; idx++ )
+      {
+         // Get breakpoint data...
+         pBreakpoint = m_state->m_breakpoints->GetBreakpoint(pArmed[idx]);
+
+         // "Access" types match reads and writes...
+         if ( (pBreakpoint->type == type) ||
+              ((pBreakpoint->type == eBreakOnCPUMemoryAccess) &&
+               ((type == eBreakOnCPUMemoryRead) || (type == eBreakOnCPUMemoryWrite))) ||
+              ((pBreakpoint->type == eBreakOnOAMPortalAccess) &&
+               ((type == eBreakOnOAMPortalRead) || (type == eBreakOnOAMPortalWrite))) ||
+              ((pBreakpoint->type == eBreakOnPPUPortalAccess) &&
+               ((type == eBreakOnPPUPortalRead) || (type == eBreakOnPPUPortalWrite))) )
          {
-            // Are there any for the specified target?
-            if ( pBreakpoint->target == target )
+            switch ( pBreakpoint->type )
             {
-               // Promote "Access" types...
-               if ( (pBreakpoint->type == eBreakOnCPUMemoryAccess) &&
-                     ((type == eBreakOnCPUMemoryRead) || (type == eBreakOnCPUMemoryWrite)) )
-               {
-                  type = eBreakOnCPUMemoryAccess;
-               }
-
-               if ( (pBreakpoint->type == eBreakOnOAMPortalAccess) &&
-                     ((type == eBreakOnOAMPortalRead) || (type == eBreakOnOAMPortalWrite)) )
-               {
-                  type = eBreakOnOAMPortalAccess;
-               }
-
-               if ( (pBreakpoint->type == eBreakOnPPUPortalAccess) &&
-                     ((type == eBreakOnPPUPortalRead) || (type == eBreakOnPPUPortalWrite)) )
-               {
-                  type = eBreakOnPPUPortalAccess;
-               }
-
-               if ( pBreakpoint->type == type )
-               {
-                  switch ( pBreakpoint->type )
+               case eBreakOnPPUCycle:
+                  // Nothing to do here; make the warning go away...
+                  break;
+               case eBreakOnCPUExecution:
+                  addr = C6502::__PCSYNC();
+                  absAddr = CNES::ABSADDR(C6502::__PCSYNC());
+
+                  if ( pBreakpoint->item1 == pBreakpoint->item2 )
+                  {
+                     if ( ((absAddr == -1) || (absAddr == pBreakpoint->item1Absolute)) &&
+                          (addr >= pBreakpoint->item1) &&
+                          (addr <= pBreakpoint->item2) &&
+                          (((!pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask)) ||
+                           ((pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask) && ((addr&(~pBreakpoint->itemMask)) == 0))) )
+                     {
+                        pBreakpoint->itemActual = addr;
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                  }
+                  else
+                  {
+                     if ( (addr >= pBreakpoint->item1) &&
+                          (addr <= pBreakpoint->item2) &&
+                          (((!pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask)) ||
+                           ((pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask) && ((addr&(~pBreakpoint->itemMask)) == 0))) )
+                     {
+                        pBreakpoint->itemActual = addr;
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                  }
+                  break;
+               case eBreakOnCPUMemoryAccess:
+               case eBreakOnCPUMemoryRead:
+               case eBreakOnCPUMemoryWrite:
+                  addr = C6502::_EA();
+
+                  if ( (addr >= pBreakpoint->item1) &&
+                       (addr <= pBreakpoint->item2) &&
+                       (((!pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask)) ||
+                        ((pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask) && ((addr&(~pBreakpoint->itemMask)) == 0))) )
+                  {
+                     pBreakpoint->itemActual = addr;
+
+                     if ( pBreakpoint->condition == eBreakIfAnything )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfEqual) &&
+                               (data == pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfNotEqual) &&
+                               (data != pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfLessThan) &&
+                               (data < pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfGreaterThan) &&
+                               (data > pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfInclusiveMask) &&
+                               (data&pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfExclusiveMask) &&
+                               (data&pBreakpoint->data) &&
+                               ((data&(~pBreakpoint->data)) == 0) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                  }
+
+                  break;
+               case eBreakOnCPUState:
+
+                  // Is the breakpoint on this register?
+                  if ( pBreakpoint->item1 == data )
+                  {
+                     pRegister = C6502::REGISTERS()->GetRegister(pBreakpoint->item1);
+                     pBitfield = pRegister->GetBitfield(pBreakpoint->item2);
+
+                     // Get actual register data...
+                     switch ( pBreakpoint->item1 )
+                     {
+                        case CPU_PC:
+                           value = C6502::__PC();
+                           break;
+                        case CPU_A:
+                           value = C6502::_A();
+                           break;
+                        case CPU_X:
+                           value = C6502::_X();
+                           break;
+                        case CPU_Y:
+                           value = C6502::_Y();
+                           break;
+                        case CPU_SP:
+                           value = C6502::_SP();
+                           break;
+                        case CPU_F:
+                           value = C6502::_F();
+                           break;
+                     }
+
+                     if ( pBreakpoint->condition == eBreakIfAnything )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfEqual) &&
+                               (pBreakpoint->data == pBitfield->GetValueRaw(value)) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfNotEqual) &&
+                               (pBreakpoint->data != pBitfield->GetValueRaw(value)) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfLessThan) &&
+                               (pBitfield->GetValueRaw(value) < pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfGreaterThan) &&
+                               (pBitfield->GetValueRaw(value) > pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfExclusiveMask) &&
+                               (pBitfield->GetValueRaw(value)&pBreakpoint->data) &&
+                               ((pBitfield->GetValueRaw(value)&(~pBreakpoint->data)) == 0) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfInclusiveMask) &&
+                               (pBitfield->GetValueRaw(value)&pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                  }
+
+                  break;
+               case eBreakOnOAMPortalAccess:
+               case eBreakOnOAMPortalRead:
+               case eBreakOnOAMPortalWrite:
+                  addr = CPPU::_OAMADDR();
+
+                  if ( (addr >= pBreakpoint->item1) &&
+                       (addr <= pBreakpoint->item2) &&
+                       (((!pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask)) ||
+                        ((pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask) && ((addr&(~pBreakpoint->itemMask)) == 0))) )
+                  {
+                     pBreakpoint->itemActual = addr;
+
+                     if ( pBreakpoint->condition == eBreakIfAnything )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfEqual) &&
+                               (data == pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfNotEqual) &&
+                               (data != pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfLessThan) &&
+                               (data < pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfGreaterThan) &&
+                               (data > pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfExclusiveMask) &&
+                               (data&pBreakpoint->data) &&
+                               ((data&(~pBreakpoint->data)) == 0) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfInclusiveMask) &&
+                               (data&pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                  }
+
+                  break;
+               case eBreakOnPPUFetch:
+               case eBreakOnPPUPortalAccess:
+               case eBreakOnPPUPortalRead:
+               case eBreakOnPPUPortalWrite:
+                  addr = CPPU::_PPUADDR();
+
+                  if ( (addr >= pBreakpoint->item1) &&
+                       (addr <= pBreakpoint->item2) &&
+                       (((!pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask)) ||
+                        ((pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask) && ((addr&(~pBreakpoint->itemMask)) == 0))) )
+                  {
+                     pBreakpoint->itemActual = addr;
+
+                     if ( pBreakpoint->condition == eBreakIfAnything )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfEqual) &&
+                               (data == pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfNotEqual) &&
+                               (data != pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfLessThan) &&
+                               (data < pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfGreaterThan) &&
+                               (data > pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfExclusiveMask) &&
+                               (data&pBreakpoint->data) &&
+                               ((data&(~pBreakpoint->data)) == 0) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfInclusiveMask) &&
+                               (data&pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                  }
+
+                  break;
+               case eBreakOnPPUState:
+
+                  // Is the breakpoint on this register?
+                  if ( pBreakpoint->item1 == data )
+                  {
+                     pRegister = CPPU::REGISTERS()->GetRegister(pBreakpoint->item1);
+                     pBitfield = pRegister->GetBitfield(pBreakpoint->item2);
+
+                     // Get actual register data...
+                     value = CPPU::_PPU(pRegister->GetAddr());
+
+                     if ( pBreakpoint->condition == eBreakIfAnything )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfEqual) &&
+                               (pBreakpoint->data == pBitfield->GetValueRaw(value)) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfNotEqual) &&
+                               (pBreakpoint->data != pBitfield->GetValueRaw(value)) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfLessThan) &&
+                               (pBitfield->GetValueRaw(value) < pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfGreaterThan) &&
+                               (pBitfield->GetValueRaw(value) > pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfExclusiveMask) &&
+                               (pBitfield->GetValueRaw(value)&pBreakpoint->data) &&
+                               ((pBitfield->GetValueRaw(value)&(~pBreakpoint->data)) == 0) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfInclusiveMask) &&
+                               (pBitfield->GetValueRaw(value)&pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                  }
+
+                  break;
+               case eBreakOnAPUState:
+
+                  // Is the breakpoint on this register?
+                  if ( pBreakpoint->item1 == data )
+                  {
+                     pRegister = CAPU::REGISTERS()->GetRegister(pBreakpoint->item1);
+                     pBitfield = pRegister->GetBitfield(pBreakpoint->item2);
+
+                     // Get actual register data...
+                     value = CAPU::_APU(pRegister->GetAddr());
+
+                     if ( pBreakpoint->condition == eBreakIfAnything )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfEqual) &&
+                               (pBreakpoint->data == pBitfield->GetValueRaw(value)) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfNotEqual) &&
+                               (pBreakpoint->data != pBitfield->GetValueRaw(value)) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfLessThan) &&
+                               (pBitfield->GetValueRaw(value) < pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfGreaterThan) &&
+                               (pBitfield->GetValueRaw(value) > pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfExclusiveMask) &&
+                               (pBitfield->GetValueRaw(value)&pBreakpoint->data) &&
+                               ((pBitfield->GetValueRaw(value)&(~pBreakpoint->data)) == 0) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfInclusiveMask) &&
+                               (pBitfield->GetValueRaw(value)&pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                  }
+
+                  break;
+               case eBreakOnMapperState:
+
+                  // Is the breakpoint on this register?
+                  if ( pBreakpoint->item1 == data )
                   {
-                     case eBreakOnPPUCycle:
-                        // Nothing to do here; make the warning go away...
-                        break;
-                     case eBreakOnCPUExecution:
-                        addr = C6502::__PCSYNC();
-                        absAddr = CNES::ABSADDR(C6502::__PCSYNC());
-
-                        if ( pBreakpoint->item1 == pBreakpoint->item2 )
-                        {
-                           if ( ((absAddr == -1) || (absAddr == pBreakpoint->item1Absolute)) &&
-                                (addr >= pBreakpoint->item1) &&
-                                (addr <= pBreakpoint->item2) &&
-                                (((!pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask)) ||
-                                 ((pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask) && ((addr&(~pBreakpoint->itemMask)) == 0))) )
-                           {
-                              pBreakpoint->itemActual = addr;
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                        }
-                        else
-                        {
-                           if ( (addr >= pBreakpoint->item1) &&
-                                (addr <= pBreakpoint->item2) &&
-                                (((!pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask)) ||
-                                 ((pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask) && ((addr&(~pBreakpoint->itemMask)) == 0))) )
-                           {
-                              pBreakpoint->itemActual = addr;
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                        }
-                        break;
-                     case eBreakOnCPUMemoryAccess:
-                     case eBreakOnCPUMemoryRead:
-                     case eBreakOnCPUMemoryWrite:
-                        addr = C6502::_EA();
-
-                        if ( (addr >= pBreakpoint->item1) &&
-                             (addr <= pBreakpoint->item2) &&
-                             (((!pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask)) ||
-                              ((pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask) && ((addr&(~pBreakpoint->itemMask)) == 0))) )
-                        {
-                           pBreakpoint->itemActual = addr;
-
-                           if ( pBreakpoint->condition == eBreakIfAnything )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfEqual) &&
-                                     (data == pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfNotEqual) &&
-                                     (data != pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfLessThan) &&
-                                     (data < pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfGreaterThan) &&
-                                     (data > pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfInclusiveMask) &&
-                                     (data&pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfExclusiveMask) &&
-                                     (data&pBreakpoint->data) &&
-                                     ((data&(~pBreakpoint->data)) == 0) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                        }
-
-                        break;
-                     case eBreakOnCPUState:
-
-                        // Is the breakpoint on this register?
-                        if ( pBreakpoint->item1 == data )
-                        {
-                           pRegister = C6502::REGISTERS()->GetRegister(pBreakpoint->item1);
-                           pBitfield = pRegister->GetBitfield(pBreakpoint->item2);
-
-                           // Get actual register data...
-                           switch ( pBreakpoint->item1 )
-                           {
-                              case CPU_PC:
-                                 value = C6502::__PC();
-                                 break;
-                              case CPU_A:
-                                 value = C6502::_A();
-                                 break;
-                              case CPU_X:
-                                 value = C6502::_X();
-                                 break;
-                              case CPU_Y:
-                                 value = C6502::_Y();
-                                 break;
-                              case CPU_SP:
-                                 value = C6502::_SP();
-                                 break;
-                              case CPU_F:
-                                 value = C6502::_F();
-                                 break;
-                           }
-
-                           if ( pBreakpoint->condition == eBreakIfAnything )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfEqual) &&
-                                     (pBreakpoint->data == pBitfield->GetValueRaw(value)) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfNotEqual) &&
-                                     (pBreakpoint->data != pBitfield->GetValueRaw(value)) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfLessThan) &&
-                                     (pBitfield->GetValueRaw(value) < pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfGreaterThan) &&
-                                     (pBitfield->GetValueRaw(value) > pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfExclusiveMask) &&
-                                     (pBitfield->GetValueRaw(value)&pBreakpoint->data) &&
-                                     ((pBitfield->GetValueRaw(value)&(~pBreakpoint->data)) == 0) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfInclusiveMask) &&
-                                     (pBitfield->GetValueRaw(value)&pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                        }
-
-                        break;
-                     case eBreakOnOAMPortalAccess:
-                     case eBreakOnOAMPortalRead:
-                     case eBreakOnOAMPortalWrite:
-                        addr = CPPU::_OAMADDR();
-
-                        if ( (addr >= pBreakpoint->item1) &&
-                             (addr <= pBreakpoint->item2) &&
-                             (((!pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask)) ||
-                              ((pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask) && ((addr&(~pBreakpoint->itemMask)) == 0))) )
-                        {
-                           pBreakpoint->itemActual = addr;
-
-                           if ( pBreakpoint->condition == eBreakIfAnything )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfEqual) &&
-                                     (data == pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfNotEqual) &&
-                                     (data != pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfLessThan) &&
-                                     (data < pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfGreaterThan) &&
-                                     (data > pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfExclusiveMask) &&
-                                     (data&pBreakpoint->data) &&
-                                     ((data&(~pBreakpoint->data)) == 0) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfInclusiveMask) &&
-                                     (data&pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                        }
-
-                        break;
-                     case eBreakOnPPUFetch:
-                     case eBreakOnPPUPortalAccess:
-                     case eBreakOnPPUPortalRead:
-                     case eBreakOnPPUPortalWrite:
-                        addr = CPPU::_PPUADDR();
-
-                        if ( (addr >= pBreakpoint->item1) &&
-                             (addr <= pBreakpoint->item2) &&
-                             (((!pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask)) ||
-                              ((pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask) && ((addr&(~pBreakpoint->itemMask)) == 0))) )
-                        {
-                           pBreakpoint->itemActual = addr;
-
-                           if ( pBreakpoint->condition == eBreakIfAnything )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfEqual) &&
-                                     (data == pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfNotEqual) &&
-                                     (data != pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfLessThan) &&
-                                     (data < pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfGreaterThan) &&
-                                     (data > pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfExclusiveMask) &&
-                                     (data&pBreakpoint->data) &&
-                                     ((data&(~pBreakpoint->data)) == 0) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfInclusiveMask) &&
-                                     (data&pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                        }
-
-                        break;
-                     case eBreakOnPPUState:
-
-                        // Is the breakpoint on this register?
-                        if ( pBreakpoint->item1 == data )
-                        {
-                           pRegister = CPPU::REGISTERS()->GetRegister(pBreakpoint->item1);
-                           pBitfield = pRegister->GetBitfield(pBreakpoint->item2);
-
-                           // Get actual register data...
-                           value = CPPU::_PPU(pRegister->GetAddr());
-
-                           if ( pBreakpoint->condition == eBreakIfAnything )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfEqual) &&
-                                     (pBreakpoint->data == pBitfield->GetValueRaw(value)) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfNotEqual) &&
-                                     (pBreakpoint->data != pBitfield->GetValueRaw(value)) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfLessThan) &&
-                                     (pBitfield->GetValueRaw(value) < pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfGreaterThan) &&
-                                     (pBitfield->GetValueRaw(value) > pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfExclusiveMask) &&
-                                     (pBitfield->GetValueRaw(value)&pBreakpoint->data) &&
-                                     ((pBitfield->GetValueRaw(value)&(~pBreakpoint->data)) == 0) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfInclusiveMask) &&
-                                     (pBitfield->GetValueRaw(value)&pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                        }
-
-                        break;
-                     case eBreakOnAPUState:
-
-                        // Is the breakpoint on this register?
-                        if ( pBreakpoint->item1 == data )
-                        {
-                           pRegister = CAPU::REGISTERS()->GetRegister(pBreakpoint->item1);
-                           pBitfield = pRegister->GetBitfield(pBreakpoint->item2);
-
-                           // Get actual register data...
-                           value = CAPU::_APU(pRegister->GetAddr());
-
-                           if ( pBreakpoint->condition == eBreakIfAnything )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfEqual) &&
-                                     (pBreakpoint->data == pBitfield->GetValueRaw(value)) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfNotEqual) &&
-                                     (pBreakpoint->data != pBitfield->GetValueRaw(value)) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfLessThan) &&
-                                     (pBitfield->GetValueRaw(value) < pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfGreaterThan) &&
-                                     (pBitfield->GetValueRaw(value) > pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfExclusiveMask) &&
-                                     (pBitfield->GetValueRaw(value)&pBreakpoint->data) &&
-                                     ((pBitfield->GetValueRaw(value)&(~pBreakpoint->data)) == 0) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfInclusiveMask) &&
-                                     (pBitfield->GetValueRaw(value)&pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                        }
-
-                        break;
-                     case eBreakOnMapperState:
-
-                        // Is the breakpoint on this register?
-                        if ( pBreakpoint->item1 == data )
-                        {
-                           pRegister = CROM::REGISTERS()->GetRegister(pBreakpoint->item1);
-                           pBitfield = pRegister->GetBitfield(pBreakpoint->item2);
-
-                           // Get actual register data...
-                           if ( pRegister->GetAddr() >= MEM_32KB )
-                           {
-                              value = MAPPERFUNC->debuginfo(pRegister->GetAddr());
-                           }
-                           else
-                           {
-                              value = MAPPERFUNC->debuginfo(pRegister->GetAddr());
-                           }
-
-                           if ( pBreakpoint->condition == eBreakIfAnything )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfEqual) &&
-                                     (pBreakpoint->data == pBitfield->GetValueRaw(value)) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfNotEqual) &&
-                                     (pBreakpoint->data != pBitfield->GetValueRaw(value)) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfLessThan) &&
-                                     (pBitfield->GetValueRaw(value) < pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfGreaterThan) &&
-                                     (pBitfield->GetValueRaw(value) > pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfExclusiveMask) &&
-                                     (pBitfield->GetValueRaw(value)&pBreakpoint->data) &&
-                                     ((pBitfield->GetValueRaw(value)&(~pBreakpoint->data)) == 0) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                           else if ( (pBreakpoint->condition == eBreakIfInclusiveMask) &&
-                                     (pBitfield->GetValueRaw(value)&pBreakpoint->data) )
-                           {
-                              pBreakpoint->hit = true;
-                              force = true;
-                           }
-                        }
-
-                        break;
-                     case eBreakOnCPUEvent:
-                     case eBreakOnPPUEvent:
-                     case eBreakOnAPUEvent:
-                     case eBreakOnMapperEvent:
-
-                        // If this is the right event to check, check it...
-                        if ( pBreakpoint->event == event )
-                        {
-                           pBreakpoint->hit = pBreakpoint->pEvent->Evaluate(pBreakpoint,data);
-
-                           if ( pBreakpoint->hit )
-                           {
-                              force = true;
-                           }
-                        }
-
-                        break;
+                     pRegister = CROM::REGISTERS()->GetRegister(pBreakpoint->item1);
+                     pBitfield = pRegister->GetBitfield(pBreakpoint->item2);
+
+                     // Get actual register data...
+                     if ( pRegister->GetAddr() >= MEM_32KB )
+                     {
+                        value = MAPPERFUNC()->debuginfo(pRegister->GetAddr());
+                     }
+                     else
+                     {
+                        value = MAPPERFUNC()->debuginfo(pRegister->GetAddr());
+                     }
+
+                     if ( pBreakpoint->condition == eBreakIfAnything )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfEqual) &&
+                               (pBreakpoint->data == pBitfield->GetValueRaw(value)) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfNotEqual) &&
+                               (pBreakpoint->data != pBitfield->GetValueRaw(value)) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfLessThan) &&
+                               (pBitfield->GetValueRaw(value) < pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfGreaterThan) &&
+                               (pBitfield->GetValueRaw(value) > pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfExclusiveMask) &&
+                               (pBitfield->GetValueRaw(value)&pBreakpoint->data) &&
+                               ((pBitfield->GetValueRaw(value)&(~pBreakpoint->data)) == 0) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
+                     else if ( (pBreakpoint->condition == eBreakIfInclusiveMask) &&
+                               (pBitfield->GetValueRaw(value)&pBreakpoint->data) )
+                     {
+                        pBreakpoint->hit = true;
+                        force = true;
+                     }
                   }
-               }
+
+                  break;
+               case eBreakOnCPUEvent:
+               case eBreakOnPPUEvent:
+               case eBreakOnAPUEvent:
+               case eBreakOnMapperEvent:
+
+                  // If this is the right event to check, check it...
+                  if ( pBreakpoint->event == event )
+                  {
+                     pBreakpoint->hit = pBreakpoint->pEvent->Evaluate(pBreakpoint,data);
+
+                     if ( pBreakpoint->hit )
+                     {
+                        force = true;
+                     }
+                  }
+
+                  break;
             }
          }
       }
@@ -862,15 +938,16 @@ void CNES::CHECKBREAKPOINT ( eBreakpointTarget target, eBreakpointType type, int
 
    if ( force )
    {
+      m_state->m_bBreakpointsHit = true;
       FORCEBREAKPOINT();
    }
 }
 
 void CNES::FORCEBREAKPOINT ( void )
 {
-   if ( m_bBreakpointsEnabled )
+   if ( m_state->m_bBreakpointsEnabled )
    {
-      m_bAtBreakpoint = true;
+      m_state->m_bAtBreakpoint = true;
 
       // Hook back to IDE to force it to update...
       nesBreak();
@@ -882,11 +959,11 @@ void CNES::RUN ( uint32_t* joy )
    uint32_t  ljoy [ NUM_CONTROLLERS ];
    JoypadLoggerInfo* pSample;
 
-   if ( m_bReplay )
+   if ( m_state->m_bReplay )
    {
-      if ( m_frame >= CIOStandardJoypad::LOGGER(0)->GetNumSamples() )
+      if ( m_state->m_frame >= CIOStandardJoypad::LOGGER(0)->GetNumSamples() )
       {
-         m_bReplay = false;
+         m_state->m_bReplay = false;
       }
    }
 
@@ -894,7 +971,7 @@ void CNES::RUN ( uint32_t* joy )
    *(ljoy+CONTROLLER1) = *(joy+CONTROLLER1);
    *(ljoy+CONTROLLER2) = *(joy+CONTROLLER2);
 
-   if ( m_bRecord )
+   if ( m_state->m_bRecord && (!nesIsSpeculative()) )
    {
       CIOStandardJoypad::LOGGER(0)->AddSample ( C6502::_CYCLES(), *(ljoy+CONTROLLER1) );
       CIOStandardJoypad::LOGGER(1)->AddSample ( C6502::_CYCLES(), *(ljoy+CONTROLLER2) );
@@ -902,18 +979,18 @@ void CNES::RUN ( uint32_t* joy )
 
    if ( CONTROLLER(0) == IO_StandardJoypad )
    {
-      if ( m_bReplay )
+      if ( m_state->m_bReplay )
       {
-         pSample = CIOStandardJoypad::LOGGER(0)->GetSample ( m_frame );
+         pSample = CIOStandardJoypad::LOGGER(0)->GetSample ( m_state->m_frame );
          *(ljoy+CONTROLLER1) |= (pSample->data);
       }
       CIOStandardJoypad::JOY ( CONTROLLER1, *(ljoy+CONTROLLER1) );
    }
    else if ( CONTROLLER(0) == IO_TurboJoypad )
    {
-      if ( m_bReplay )
+      if ( m_state->m_bReplay )
       {
-         pSample = CIOTurboJoypad::LOGGER(0)->GetSample ( m_frame );
+         pSample = CIOTurboJoypad::LOGGER(0)->GetSample ( m_state->m_frame );
          *(ljoy+CONTROLLER1) |= (pSample->data);
       }
       CIOTurboJoypad::JOY ( CONTROLLER1, *(ljoy+CONTROLLER1) );
@@ -933,18 +1010,18 @@ void CNES::RUN ( uint32_t* joy )
 
    if ( CONTROLLER(1) == IO_StandardJoypad )
    {
-      if ( m_bReplay )
+      if ( m_state->m_bReplay )
       {
-         pSample = CIOStandardJoypad::LOGGER(1)->GetSample ( m_frame );
+         pSample = CIOStandardJoypad::LOGGER(1)->GetSample ( m_state->m_frame );
          *(ljoy+CONTROLLER2) |= (pSample->data);
       }
       CIOStandardJoypad::JOY ( CONTROLLER2, *(ljoy+CONTROLLER2) );
    }
    else if ( CONTROLLER(1) == IO_TurboJoypad )
    {
-      if ( m_bReplay )
+      if ( m_state->m_bReplay )
       {
-         pSample = CIOTurboJoypad::LOGGER(1)->GetSample ( m_frame );
+         pSample = CIOTurboJoypad::LOGGER(1)->GetSample ( m_state->m_frame );
          *(ljoy+CONTROLLER2) |= (pSample->data);
       }
       CIOTurboJoypad::JOY ( CONTROLLER2, *(ljoy+CONTROLLER2) );
@@ -962,21 +1039,37 @@ void CNES::RUN ( uint32_t* joy )
       CIOStandardJoypad::JOY ( CONTROLLER2, 0x00 );
    }
 
+   // Turning the debugger on or off takes effect from the next frame.
+   if ( nesIsDebuggable() )
+   {
+      RUNFRAME<true> ();
+   }
+   else
+   {
+      RUNFRAME<false> ();
+   }
+}
+
+template<bool Debuggable>
+void CNES::RUNFRAME ( void )
+{
+   NESPERFFRAMEBEGIN ();
+
    // PPU cycles repeat...
    CPPU::RESETCYCLECOUNTER ();
 
-   m_frame = CPPU::_FRAME();
+   m_state->m_frame = CPPU::_FRAME();
 
-   if ( nesIsDebuggable() )
+   if ( Debuggable )
    {
-      m_tracer->SetFrame ( m_frame );
+      m_state->m_tracer->SetFrame ( m_state->m_frame );
 
       // Emit start-of-frame indication to Tracer...
-      m_tracer->AddSample ( CPPU::_CYCLES(), eTracer_StartPPUFrame, eNESSource_PPU, 0, 0, 0 );
+      m_state->m_tracer->AddSample ( CPPU::_CYCLES(), eTracer_StartPPUFrame, eNESSource_PPU, 0, 0, 0 );
    }
 
    // Do scanline processing for scanlines 0 - 239 (the screen!)...
-   CPPU::RENDERSCANLINE ( SCANLINES_VISIBLE );
+   CPPU::RENDERSCANLINE<Debuggable> ( SCANLINES_VISIBLE );
 
 #if 0
 
@@ -995,46 +1088,57 @@ void CNES::RUN ( uint32_t* joy )
 
 #endif
 
-   if ( nesIsDebuggable() )
+   if ( Debuggable )
    {
       // Emit start-of-quiet scanline indication to Tracer...
-      m_tracer->AddSample ( CPPU::_CYCLES(), eTracer_QuietStart, eNESSource_PPU, 0, 0, 0 );
+      m_state->m_tracer->AddSample ( CPPU::_CYCLES(), eTracer_QuietStart, eNESSource_PPU, 0, 0, 0 );
    }
 
    // Emulate PPU resting scanlines...
-   CPPU::QUIETSCANLINES ();
+   CPPU::QUIETSCANLINES<Debuggable> ();
 
-   if ( nesIsDebuggable() )
+   if ( Debuggable )
    {
       // Emit end-of-quiet scanline indication to Tracer...
-      m_tracer->AddSample ( CPPU::_CYCLES(), eTracer_QuietEnd, eNESSource_PPU, 0, 0, 0 );
+      m_state->m_tracer->AddSample ( CPPU::_CYCLES(), eTracer_QuietEnd, eNESSource_PPU, 0, 0, 0 );
 
       // Do VBLANK processing (scanlines 0-19 NTSC or 0-69 PAL)...
       // Emit start-VBLANK indication to Tracer...
-      m_tracer->AddSample ( CPPU::_CYCLES(), eTracer_VBLANKStart, eNESSource_PPU, 0, 0, 0 );
+      m_state->m_tracer->AddSample ( CPPU::_CYCLES(), eTracer_VBLANKStart, eNESSource_PPU, 0, 0, 0 );
    }
 
    // Emulate VBLANK non-render scanlines...
-   CPPU::VBLANKSCANLINES ();
+   CPPU::VBLANKSCANLINES<Debuggable> ();
 
-   if ( nesIsDebuggable() )
+   if ( Debuggable )
    {
       // Emit end-VBLANK indication to Tracer...
-      m_tracer->AddSample ( CPPU::_CYCLES(), eTracer_VBLANKEnd, eNESSource_PPU, 0, 0, 0 );
+      m_state->m_tracer->AddSample ( CPPU::_CYCLES(), eTracer_VBLANKEnd, eNESSource_PPU, 0, 0, 0 );
 
       // Emit start-of-prerender scanline indication to Tracer...
-      m_tracer->AddSample ( CPPU::_CYCLES(), eTracer_PreRenderStart, eNESSource_PPU, 0, 0, 0 );
+      m_state->m_tracer->AddSample ( CPPU::_CYCLES(), eTracer_PreRenderStart, eNESSource_PPU, 0, 0, 0 );
    }
 
    // Pre-render scanline...
-   CPPU::RENDERSCANLINE ( -1 );
+   CPPU::RENDERSCANLINE<Debuggable> ( -1 );
 
-   if ( nesIsDebuggable() )
+   if ( Debuggable )
    {
       // Emit end-of-prerender scanline indication to Tracer...
-      m_tracer->AddSample ( CPPU::_CYCLES(), eTracer_PreRenderEnd, eNESSource_PPU, 0, 0, 0 );
+      m_state->m_tracer->AddSample ( CPPU::_CYCLES(), eTracer_PreRenderEnd, eNESSource_PPU, 0, 0, 0 );
 
       // Emit end-of-frame indication to Tracer...
-      m_tracer->AddSample ( CPPU::_CYCLES(), eTracer_EndPPUFrame, eNESSource_PPU, 0, 0, 0 );
+      m_state->m_tracer->AddSample ( CPPU::_CYCLES(), eTracer_EndPPUFrame, eNESSource_PPU, 0, 0, 0 );
    }
+
+   // Bring the mapper and APU up to the CPU for anyone looking at them
+   // between frames.
+   MAPPERSYNC ();
+   CAPU::SYNC ();
+   CAPU::RATECONTROL ();
+
+   // Idle-loop statistics are per frame, and so are the performance
+   // counters.
+   C6502::IDLEFRAME ();
+   NESPERFFRAMEEND ( m_state->m_frame );
 }
@@ -5,7 +5,11 @@
 #include "cjoypadlogger.h"
 #include "cnesbreakpointinfo.h"
 
+#include "cnesmappers.h"
+
 #include "nes_emulator_core.h"
+#include "cnesstate.h"
+#include "cnesperf.h"
 
 // The CNES class is the implementation of the NES as a complete
 // emulatable machine.  It contains a RUN method which is used
@@ -41,55 +45,147 @@ public:
    CNES();
    ~CNES();
 
+   // These methods allocate and free the resources owned by the
+   // currently selected machine (see NesMachine).
+   static void CREATE ( void );
+   static void DESTROY ( void );
+
+   // Save/restore the selected machine's system state to/from a binary save-state.
+   static void SAVESTATE ( CNESStateWriter& state );
+   static bool LOADSTATE ( CNESStateReader& state );
+
    // Accessor methods to get/set the current video mode.
    static inline void VIDEOMODE ( int32_t mode )
    {
-      m_videoMode = mode;
+      m_state->m_videoMode = mode;
    }
    static inline int32_t VIDEOMODE ( void )
    {
-      return m_videoMode;
+      return m_state->m_videoMode;
+   }
+
+   // Accessor methods to get/set whether debug support is on, whether the
+   // frame being run is a speculative one (see nesRunAhead) and whether
+   // its picture will be shown (see nesSetFrameSkip).
+   static inline void DEBUGGING ( bool debug )
+   {
+      m_state->m_bDebug = debug;
+   }
+   static inline bool DEBUGGING ( void )
+   {
+      return m_state->m_bDebug;
+   }
+   static inline void SPECULATIVE ( bool speculative )
+   {
+      m_state->m_bSpeculative = speculative;
+   }
+   static inline bool SPECULATIVE ( void )
+   {
+      return m_state->m_bSpeculative;
+   }
+   static inline void FRAMESKIP ( bool skip )
+   {
+      m_state->m_bFrameSkip = skip;
+   }
+   static inline bool FRAMESKIP ( void )
+   {
+      return m_state->m_bFrameSkip;
    }
 
    // Accessor methods to get/set the controller type.
    static inline void CONTROLLER ( int32_t port, int32_t type )
    {
-      m_controllerType[port] = type;
+      m_state->m_controllerType[port] = type;
    }
    static inline int32_t CONTROLLER ( int32_t port )
    {
-      return m_controllerType[port];
+      return m_state->m_controllerType[port];
    }
 
    // Accessor method to set the controller's screen coordinates
    // for controllers that are screen-relative such as Zapper.
    static inline void CONTROLLERPOSITION ( int32_t port, int32_t px, int32_t py, int32_t wx1, int32_t wy1, int32_t wx2, int32_t wy2 )
    {
-      m_controllerPositionX[port] = px;
-      m_controllerPositionY[port] = py;
-      m_windowX1 = wx1;
-      m_windowY1 = wy1;
-      m_windowX2 = wx2;
-      m_windowY2 = wy2;
+      m_state->m_controllerPositionX[port] = px;
+      m_state->m_controllerPositionY[port] = py;
+      m_state->m_windowX1 = wx1;
+      m_state->m_windowY1 = wy1;
+      m_state->m_windowX2 = wx2;
+      m_state->m_windowY2 = wy2;
    }
    static inline void CONTROLLERPOSITION ( int32_t port, int32_t* px, int32_t* py, int32_t* wx1, int32_t* wy1, int32_t* wx2, int32_t* wy2 )
    {
-      (*px) = m_controllerPositionX[port];
-      (*py) = m_controllerPositionY[port];
-      (*wx1) = m_windowX1;
-      (*wy1) = m_windowY1;
-      (*wx2) = m_windowX2;
-      (*wy2) = m_windowY2;
+      (*px) = m_state->m_controllerPositionX[port];
+      (*py) = m_state->m_controllerPositionY[port];
+      (*wx1) = m_state->m_windowX1;
+      (*wy1) = m_state->m_windowY1;
+      (*wx2) = m_state->m_windowX2;
+      (*wy2) = m_state->m_windowY2;
    }
 
    // This method performs a full NES reset and initializes
    // the ROM object with the appropriate mapper index.
    static void RESET ( uint32_t mapper, bool soft );
 
+   // Accessor method to retrieve the function table of the mapper
+   // selected by the most recent RESET.
+   static inline MapperFuncs* MAPPERFUNC ( void )
+   {
+      return m_state->m_mapperFunc;
+   }
+
+   // The CPU calls this once per cycle in place of the mapper's sync_cpu.
+   // Without the debugger watching, the cycles the mapper has said it
+   // will be idle for are only counted here.  They are handed to it in
+   // one go, either when something is about to look at or change the
+   // mapper (see MAPPERSYNC) or on the cycle it next has work to do,
+   // which is still run through sync_cpu so IRQs land on the same cycle.
+   template<bool Debuggable> static inline void MAPPERCLOCK ( void )
+   {
+      if ( Debuggable )
+      {
+         if ( m_state->m_mapperPendingCycles )
+         {
+            MAPPERSYNC ();
+         }
+         m_state->m_mapperFunc->sync_cpu ();
+
+         // Nothing has been predicted for the cycles run here.
+         m_state->m_mapperSyncCycles = 1;
+      }
+      else
+      {
+         m_state->m_mapperPendingCycles++;
+
+         if ( m_state->m_mapperPendingCycles >= m_state->m_mapperSyncCycles )
+         {
+            MAPPERCATCHUP ();
+         }
+      }
+   }
+
+   // Bring the mapper up to the CPU before a register access, a mapper
+   // audio sample or a save-state.
+   static void MAPPERSYNC ( void );
+
+   // How many more cycles MAPPERCLOCK can count before the mapper has to
+   // catch up, and a way to count that many at once (see CAPU::IDLECYCLES).
+   static inline uint32_t MAPPERIDLECYCLES ( void )
+   {
+      return m_state->m_mapperSyncCycles-m_state->m_mapperPendingCycles-1;
+   }
+   static inline void MAPPERCLOCKIDLE ( uint32_t cycles )
+   {
+      m_state->m_mapperPendingCycles += cycles;
+   }
+
    // This method emulates a NES video frame and passes the
    // current state of the joypad to the emulation engine.
    // The current state of the joypad is constructed from
    // intercepted keypress/keyrelease events in the UI.
+   //
+   // Whether the frame is run with or without the debugger hooks is
+   // decided here, once per frame; see RUNFRAME.
    static void RUN ( uint32_t* joy );
 
    // Accessor methods to get/set whether or not the emulation
@@ -99,11 +195,11 @@ public:
    // for emulation runs that start from NES reset.
    static void REPLAY ( bool enable )
    {
-      m_bReplay = enable;
+      m_state->m_bReplay = enable;
    }
    static bool REPLAY ()
    {
-      return m_bReplay;
+      return m_state->m_bReplay;
    }
 
    // Accessor methods to get/set whether or not the emulation
@@ -112,18 +208,18 @@ public:
    // the REPLAY API.
    static void RECORD ( bool enable )
    {
-      m_bRecord = enable;
+      m_state->m_bRecord = enable;
    }
    static bool RECORD ()
    {
-      return m_bRecord;
+      return m_state->m_bRecord;
    }
 
    // Accessor method to retrieve the NES object's frame counter.
    // This is used by some debugger inspectors.
    static uint32_t FRAME ()
    {
-      return m_frame;
+      return m_state->m_frame;
    }
 
    // Accessor method to retrieve the execution tracer database.  Other
@@ -131,14 +227,14 @@ public:
    // during emulation.
    static inline CTracer* TRACER ( void )
    {
-      return m_tracer;
+      return m_state->m_tracer;
    }
 
    // This method globally enables or disables breakpoints.  It is used
    // during an emulation hard-reset (which is caused whenever a new
    // ROM image is loaded) to prevent the emulation engine from getting
    // hung up on a set breakpoint during the ROM image switchover.
-   static void BREAKPOINTS ( bool enable ) { m_bBreakpointsEnabled = enable; }
+   static void BREAKPOINTS ( bool enable ) { m_state->m_bBreakpointsEnabled = enable; }
 
    // This method retrieves the database of currently active breakpoints.
    // It is used by the debugger inspectors to determine whether or not
@@ -146,13 +242,25 @@ public:
    // It is also used by the NES object in evaluating breakpoints for hits.
    static CBreakpointInfo* BREAKPOINTS ( void )
    {
-      return m_breakpoints;
+      return m_state->m_breakpoints;
    }
 
    // This method is invoked by objects within the emulation engine (CNES,
    // C6502, CPPU, CAPU, CROM) to allow the emulation engine to halt itself
-   // if a breakpoint is encountered.
-   static void CHECKBREAKPOINT ( eBreakpointTarget target, eBreakpointType type = (eBreakpointType)-1, int32_t data = 0, int32_t event = 0 );
+   // if a breakpoint is encountered.  Checks that no enabled breakpoint
+   // could match are turned away here without a call.
+   static inline void CHECKBREAKPOINT ( eBreakpointTarget target, eBreakpointType type = (eBreakpointType)-1, int32_t data = 0, int32_t event = 0 )
+   {
+      NESPERFCOUNT ( eNESPerf_Breakpoints );
+
+      if ( m_state->m_bStepCPUBreakpoint ||
+           m_state->m_bStepPPUBreakpoint ||
+           m_state->m_breakpoints->IsArmed(target,type,event) )
+      {
+         EVALUATEBREAKPOINT ( target, type, data, event );
+      }
+   }
+   static void EVALUATEBREAKPOINT ( eBreakpointTarget target, eBreakpointType type, int32_t data, int32_t event );
 
    // This method forces the emulation engine into breakpoint territory;
    // the emulation is halted, a breakpoint-watching thread is released,
@@ -163,11 +271,11 @@ public:
    // whether or not the machine is currently at a breakpoint.
    static bool ATBREAKPOINT ( void )
    {
-      return m_bAtBreakpoint;
+      return m_state->m_bAtBreakpoint;
    }
    static void CLEARBREAKPOINT ( void )
    {
-      m_bAtBreakpoint = false;
+      m_state->m_bAtBreakpoint = false;
    }
 
    // These methods set a flag within the NES object indicating that a
@@ -180,12 +288,13 @@ public:
    // declared in the CPU and ROM objects.  These wrapper
    // methods contain the logic to determine which of the sub-object
    // methods to invoke based on the passed parameters.
-   static char* DISASSEMBLY ( uint32_t addr );
+   static char* DISASSEMBLY ( uint32_t addr, char* buffer );
    static uint32_t SLOC2ADDR ( uint16_t sloc );
    static uint16_t ADDR2SLOC ( uint32_t addr );
    static uint32_t SLOC ( uint32_t addr );
    static uint8_t _MEM ( uint32_t addr );
    static void DISASSEMBLE ( void );
+   static bool DISASSEMBLYCHANGES ( uint32_t addr, int32_t* firstRow, int32_t* endRow, int32_t* rowDelta );
    static uint32_t ABSADDR ( uint32_t addr );
 
    // This method turns a 6502-based address into a printable representation
@@ -194,44 +303,83 @@ public:
    static void PRINTABLEADDR ( char* buffer, uint32_t addr, uint32_t absAddr );
 
 protected:
-   // Whether or not joypad input is being fed from the user or from
-   // previously recorded emulation runs.
-   static bool         m_bReplay;
-
-   // Whether or not joypad input is being recorded during this emulation run.
-   static bool         m_bRecord;
-
-   // NTSC, or PAL?
-   static int32_t             m_videoMode;
-
-   // Controller type information
-   static int32_t  m_controllerType [ NUM_CONTROLLERS ];
-
-   // Controller screen position information (for things like zapper)
-   static int32_t  m_controllerPositionX [ NUM_CONTROLLERS ];
-   static int32_t  m_controllerPositionY [ NUM_CONTROLLERS ];
-   static int32_t  m_windowX1;
-   static int32_t  m_windowY1;
-   static int32_t  m_windowX2;
-   static int32_t  m_windowY2;
-
-   // The execution tracer database.
-   static CTracer*         m_tracer;
-
-   // This is the database of active breakpoints.
-   static CBreakpointInfo* m_breakpoints;
-   static bool m_bBreakpointsEnabled;
-
-   // These flags determine the breakpoint state and behavior
-   // of the emulation engine.
-   static bool            m_bAtBreakpoint;
-   static bool            m_bStepCPUBreakpoint;
-   static bool            m_bStepPPUBreakpoint;
-   static int32_t         m_ppuCycleToStepTo;
-   static uint32_t        m_ppuFrameToStepTo;
-
-   // Emulation frame counter...a copy of CPPU::m_frame;
-   static uint32_t m_frame;
+   // Run the PPU, and with it the CPU and APU, through one frame.  The
+   // Debuggable=false flavour has no tracer, code/data logger or
+   // breakpoint code compiled into it at all.
+   template<bool Debuggable> static void RUNFRAME ( void );
+
+   // Hand the mapper the idle cycles counted so far and run the current
+   // one through sync_cpu, then ask it how long it will be idle for.
+   static void MAPPERCATCHUP ( void );
+
+   // Per-machine state.  Each NesMachine owns one of these; m_state
+   // points at the one selected by the calling thread.
+   struct State
+   {
+      // Whether or not joypad input is being fed from the user or from
+      // previously recorded emulation runs.
+      bool m_bReplay = false;
+
+      // Whether or not joypad input is being recorded during this emulation run.
+      bool m_bRecord = true;
+
+      // NTSC, or PAL?
+      int32_t m_videoMode = MODE_NTSC;
+
+      // Debug support, run-ahead and frame skip (see DEBUGGING).
+      bool m_bDebug = false;
+      bool m_bSpeculative = false;
+      bool m_bFrameSkip = false;
+
+      // Controller type information
+      int32_t m_controllerType [ NUM_CONTROLLERS ] = { IO_StandardJoypad, IO_Zapper };
+
+      // Controller screen position information (for things like zapper)
+      int32_t m_controllerPositionX [ NUM_CONTROLLERS ] = { 0, };
+      int32_t m_controllerPositionY [ NUM_CONTROLLERS ] = { 0, };
+      int32_t m_windowX1 = 0;
+      int32_t m_windowY1 = 0;
+      int32_t m_windowX2 = 0;
+      int32_t m_windowY2 = 0;
+
+      // The execution tracer database.
+      CTracer* m_tracer = NULL;
+
+      // This is the database of active breakpoints.
+      CNESBreakpointInfo* m_breakpoints = NULL;
+      bool m_bBreakpointsEnabled = true;
+
+      // Whether any breakpoint in the database is flagged as hit.
+      bool m_bBreakpointsHit = false;
+
+      // These flags determine the breakpoint state and behavior
+      // of the emulation engine.
+      bool m_bAtBreakpoint = false;
+      bool m_bStepCPUBreakpoint = false;
+      bool m_bStepPPUBreakpoint = false;
+      int32_t m_ppuCycleToStepTo = -1;
+      uint32_t m_ppuFrameToStepTo = -1;
+
+      // Emulation frame counter...a copy of CPPU::m_frame;
+      uint32_t m_frame = 0;
+
+      // The active mapper's function table.
+      MapperFuncs* m_mapperFunc = &(_mapperfunc[0]); // Assume NROM to start.
+
+      // CPU cycles the mapper has yet to see, and how many there can be
+      // before it has to (see MAPPERCLOCK).
+      uint32_t m_mapperPendingCycles = 0;
+      uint32_t m_mapperSyncCycles = 1;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 };
 
+// Internal debug interfaces.  Speculative frames are not seen by the
+// debugger, so they run as if debug support were off.
+#define nesIsDebuggable() ( CNES::DEBUGGING() && !CNES::SPECULATIVE() )
+#define nesIsSpeculative() ( CNES::SPECULATIVE() )
+#define nesIsFrameSkipped() ( CNES::FRAMESKIP() )
+
 #endif
@@ -21,6 +21,7 @@
 #include "cnesios.h"
 #include "cnesio.h"
 #include "cnesmappers.h"
+#include "cnesperf.h"
 
 #include "nes_emulator_core.h"
 
@@ -161,54 +162,8 @@ static CBreakpointEventInfo* tblCPUEvents [] =
 CBreakpointEventInfo** C6502::m_tblBreakpointEvents = tblCPUEvents;
 int32_t                C6502::m_numBreakpointEvents = NUM_CPU_EVENTS;
 
-bool            C6502::m_killed = false;              // KIL opcode not executed.
-bool            C6502::m_breakOnKIL = false;          // IDE sets this for us.
-bool            C6502::m_irqAsserted = false;
-int32_t         C6502::m_instrCycle = 0;
-bool            C6502::m_irqPending = false;
-bool            C6502::m_nmiAsserted = false;
-bool            C6502::m_nmiPending = false;
-uint8_t         C6502::m_openBusData = 0x00;
-uint8_t*  C6502::m_6502memory = NULL;
-uint8_t   C6502::m_a = 0x00;
-uint8_t   C6502::m_x = 0x00;
-uint8_t   C6502::m_y = 0x00;
-uint8_t   C6502::m_f = FLAG_MISC;
-uint16_t  C6502::m_pc = VECTOR_RESET;
-uint16_t  C6502::m_pcSync = VECTOR_RESET;
-bool      C6502::m_pcSyncSet = false;
-uint32_t    C6502::m_ea = 0;
-uint32_t            C6502::m_pcGoto = 0xFFFFFFFF;
-uint8_t   C6502::m_sp = 0x00;
-
-uint32_t    C6502::m_cycles = 0;
-int32_t         C6502::m_curCycles = 0;
-
-uint16_t C6502::m_writeDmaAddr = 0x0000;
-int32_t  C6502::m_writeDmaCounter = 0;
-uint16_t C6502::m_readDmaAddr = 0x0000;
-int32_t     C6502::m_dmaRequest = -1;
-int32_t  C6502::m_readDmaCounter = 0;
-
-int32_t         C6502::amode;
-uint8_t*  C6502::data = NULL;
-uint8_t   C6502::opcodeData [ 4 ]; // 3 opcode bytes and 1 byte for operand return data [extra cycle]
-struct _CNES6502_opcode* C6502::pOpcodeStruct = NULL;
-int32_t         C6502::opcodeSize;
-bool            C6502::m_write = false;
-int8_t            C6502::m_phase = 0;
-
-TracerInfo*      C6502::pDisassemblySample = NULL;
-
-CMarker*         C6502::m_marker = NULL;
-
-CCodeDataLogger* C6502::m_logger = NULL;
-
-uint8_t*   C6502::m_RAMopcodeMask = NULL;
-char**     C6502::m_RAMdisassembly = NULL;
-uint16_t*  C6502::m_RAMsloc2addr = NULL;
-uint16_t*  C6502::m_RAMaddr2sloc = NULL;
-uint32_t   C6502::m_RAMsloc = 0;
+C6502::State C6502::m_defaultState;
+thread_local C6502::State* C6502::m_state = &C6502::m_defaultState;
 
 static int32_t opcode_size [ NUM_ADDRESSING_MODES ] =
 {
@@ -507,156 +462,290 @@ static CNES6502_opcode m_6502opcode [ 256 ] =
 static C6502 __init __attribute__((unused));
 
 C6502::C6502()
+{
+   CREATE();
+}
+
+C6502::~C6502()
+{
+   DESTROY();
+}
+
+void C6502::CREATE ( void )
 {
    int32_t addr;
 
-   m_RAMdisassembly = new char*[MEM_2KB];
-   for ( addr = 0; addr < MEM_2KB; addr++ )
+   m_state->m_RAMdisassembly = new DisassemblyInfo[MEM_2KB];
+   m_state->m_RAMopcodeMask = new uint8_t[MEM_2KB];
+   m_state->m_RAMsloc2addr = new uint16_t[MEM_2KB];
+   m_state->m_RAMaddr2sloc = new uint16_t[MEM_2KB];
+   m_state->m_RAMsloc = 0;
+   DISASSEMBLYRESET ( &(m_state->m_RAMdisassemblyState), MEM_2KB );
+
+   // Machines power on with their memory cleared, whatever the heap had
+   // in it before; batch runs depend on it.
+   m_state->m_6502memory = new uint8_t[MEM_2KB];
+   memset ( m_state->m_6502memory, 0, MEM_2KB );
+
+   // RAM and its mirrors never move.
+   for ( addr = 0; addr < 0x2000; addr += MEM_2KB )
    {
-      m_RAMdisassembly[addr] = new char [ 16 ];
+      MAPREAD ( addr, MEM_2KB, m_state->m_6502memory );
+      MAPWRITE ( addr, MEM_2KB, m_state->m_6502memory );
    }
-   m_RAMopcodeMask = new uint8_t[MEM_2KB];
-   m_RAMsloc2addr = new uint16_t[MEM_2KB];
-   m_RAMaddr2sloc = new uint16_t[MEM_2KB];
-
-   m_6502memory = new uint8_t[MEM_2KB];
 
-   m_logger = new CCodeDataLogger ( MEM_32KB, MASK_32KB );
+   m_state->m_logger = new CCodeDataLogger ( MEM_32KB, MASK_32KB );
 
-   m_marker = new CMarker;
+   m_state->m_marker = new CMarker;
 }
 
-C6502::~C6502()
+void C6502::DESTROY ( void )
 {
-   int32_t addr;
+   delete [] m_state->m_RAMdisassembly;
+   delete [] m_state->m_RAMopcodeMask;
+   delete [] m_state->m_RAMsloc2addr;
+   delete [] m_state->m_RAMaddr2sloc;
 
-   for ( addr = 0; addr < MEM_2KB; addr++ )
-   {
-      delete m_RAMdisassembly[addr];
-   }
-   delete [] m_RAMdisassembly;
-   delete [] m_RAMopcodeMask;
-   delete [] m_RAMsloc2addr;
-   delete [] m_RAMaddr2sloc;
+   delete [] m_state->m_6502memory;
 
-   delete [] m_6502memory;
+   delete m_state->m_logger;
 
-   delete m_logger;
+   delete m_state->m_marker;
+}
 
-   delete m_marker;
+void C6502::SAVESTATE ( CNESStateWriter& state )
+{
+   int8_t opcodeStruct;
+
+   state.BeginChunk ( NES_STATE_CHUNK_CPU, NES_STATE_VERSION_CPU );
+   state.Put ( m_state->m_6502memory, MEM_2KB );
+   state.Put ( m_state->m_killed );
+   state.Put ( m_state->m_irqAsserted );
+   state.Put ( m_state->m_irqPending );
+   state.Put ( m_state->m_nmiAsserted );
+   state.Put ( m_state->m_nmiPending );
+   state.Put ( m_state->m_a );
+   state.Put ( m_state->m_x );
+   state.Put ( m_state->m_y );
+   state.Put ( m_state->m_f );
+   state.Put ( m_state->m_pc );
+   state.Put ( m_state->m_pcSync );
+   state.Put ( m_state->m_pcSyncSet );
+   state.Put ( m_state->m_sp );
+   state.Put ( m_state->m_ea );
+   state.Put ( m_state->m_cycles );
+   state.Put ( m_state->m_instrCycle );
+   state.Put ( m_state->m_curCycles );
+   state.Put ( m_state->amode );
+   state.Put ( m_state->m_dmaRequest );
+   state.Put ( m_state->m_writeDmaAddr );
+   state.Put ( m_state->m_writeDmaCounter );
+   state.Put ( m_state->m_readDmaAddr );
+   state.Put ( m_state->m_readDmaCounter );
+   state.Put ( m_state->opcodeData );
+   state.Put ( m_state->opcodeSize );
+   state.Put ( m_state->m_write );
+   state.Put ( m_state->m_openBusData );
+   state.Put ( m_state->m_phase );
+   state.Put ( m_state->m_dmaDatabuf );
+   state.Put ( m_state->m_brkPclo );
+   state.Put ( m_state->m_brkDoingIrq );
+
+   // The decoded opcode always refers to the opcode in opcodeData, so
+   // only whether or not an instruction is in flight needs saving.
+   opcodeStruct = (m_state->pOpcodeStruct != NULL);
+   state.Put ( opcodeStruct );
+   state.EndChunk ();
+}
+
+bool C6502::LOADSTATE ( CNESStateReader& state )
+{
+   int8_t opcodeStruct;
+   bool   ok;
+
+   if ( !state.FindChunk(NES_STATE_CHUNK_CPU,NES_STATE_VERSION_CPU) )
+   {
+      return false;
+   }
+   ok = state.Get ( m_state->m_6502memory, MEM_2KB ) &&
+        state.Get ( m_state->m_killed ) &&
+        state.Get ( m_state->m_irqAsserted ) &&
+        state.Get ( m_state->m_irqPending ) &&
+        state.Get ( m_state->m_nmiAsserted ) &&
+        state.Get ( m_state->m_nmiPending ) &&
+        state.Get ( m_state->m_a ) &&
+        state.Get ( m_state->m_x ) &&
+        state.Get ( m_state->m_y ) &&
+        state.Get ( m_state->m_f ) &&
+        state.Get ( m_state->m_pc ) &&
+        state.Get ( m_state->m_pcSync ) &&
+        state.Get ( m_state->m_pcSyncSet ) &&
+        state.Get ( m_state->m_sp ) &&
+        state.Get ( m_state->m_ea ) &&
+        state.Get ( m_state->m_cycles ) &&
+        state.Get ( m_state->m_instrCycle ) &&
+        state.Get ( m_state->m_curCycles ) &&
+        state.Get ( m_state->amode ) &&
+        state.Get ( m_state->m_dmaRequest ) &&
+        state.Get ( m_state->m_writeDmaAddr ) &&
+        state.Get ( m_state->m_writeDmaCounter ) &&
+        state.Get ( m_state->m_readDmaAddr ) &&
+        state.Get ( m_state->m_readDmaCounter ) &&
+        state.Get ( m_state->opcodeData ) &&
+        state.Get ( m_state->opcodeSize ) &&
+        state.Get ( m_state->m_write ) &&
+        state.Get ( m_state->m_openBusData ) &&
+        state.Get ( m_state->m_phase ) &&
+        state.Get ( m_state->m_dmaDatabuf ) &&
+        state.Get ( m_state->m_brkPclo ) &&
+        state.Get ( m_state->m_brkDoingIrq ) &&
+        state.Get ( opcodeStruct );
+
+   m_state->data = m_state->opcodeData+1;
+   m_state->pOpcodeStruct = opcodeStruct ? m_6502opcode+(*m_state->opcodeData) : NULL;
+
+   // The tracer sample the in-flight instruction was going to be
+   // disassembled into is gone.
+   m_state->disassemblySample = TRACER_NO_SAMPLE;
+   m_state->m_pcGoto = 0xFFFFFFFF;
+
+   // Start looking for idle loops afresh.
+   m_state->m_idleHead = IDLE_NO_LOOP;
+
+   return ok;
 }
 
+template<bool Debuggable>
 void C6502::EMULATE ( int32_t cycles )
 {
    bool doCycle;
    bool nmiPending = false;
 
-   m_curCycles += cycles;
+   NESPERFSCOPE ( eNESPerf_CPU );
 
-   if ( !m_killed )
+   m_state->m_curCycles += cycles;
+
+   if ( !m_state->m_killed )
    {
       do
       {
-         if ( m_curCycles > 0 )
+         if ( m_state->m_curCycles > 0 )
          {
-            doCycle = DMA();
+            doCycle = DMAACTIVE() ? DMA() : true;
             if ( doCycle )
             {
-               if ( m_phase == 0 )
+               if ( m_state->m_phase == 0 )
                {
+                  // Just branched back to the top of a short loop?
+                  if ( (!Debuggable) && m_state->m_idleSkip &&
+                       (m_state->m_pc <= m_state->m_pcSync) &&
+                       (m_state->m_pcSync-m_state->m_pc < IDLE_LOOP_BYTES) &&
+                       IDLELOOP() )
+                  {
+                     continue;
+                  }
+
                   // Indicate opcode fetch...
-                  m_instrCycle = 0;
+                  m_state->m_instrCycle = 0;
+                  m_state->m_instructions++;
 
                   // Keep track of synchronization points so IDE can display properly.
-                  m_pcSyncSet = true;
-                  m_pcSync = m_pc;
+                  m_state->m_pcSyncSet = true;
+                  m_state->m_pcSync = m_state->m_pc;
 
                   // Break 'flag' is cleared after BRK finishes.
                   cB();
 
                   // Fetch
-                  nmiPending = m_nmiPending;
-                  (*opcodeData) = FETCH ();
+                  nmiPending = m_state->m_nmiPending;
+                  (*m_state->opcodeData) = FETCH<Debuggable> ();
 
-                  CNES::CHECKBREAKPOINT ( eBreakInCPU, eBreakOnCPUExecution, (*opcodeData) );
+                  if ( Debuggable )
+                  {
+                     CNES::CHECKBREAKPOINT ( eBreakInCPU, eBreakOnCPUExecution, (*m_state->opcodeData) );
 
-                  // Save the pointer to where to put the disassembly of
-                  // the current opcode now.  This might be the last fetch
-                  // for an instruction and the disassembly should be placed there.
-                  pDisassemblySample = CNES::TRACER()->GetLastCPUSample ();
+                     // Save the pointer to where to put the disassembly of
+                     // the current opcode now.  This might be the last fetch
+                     // for an instruction and the disassembly should be placed there.
+                     m_state->disassemblySample = CNES::TRACER()->GetLastCPUSample ();
 
-                  // Check flags breakpoint.  Do it here instead of everywhere flags are
-                  // changed so as to limit the number of calls to check the breakpoint.
-                  CNES::CHECKBREAKPOINT(eBreakInCPU,eBreakOnCPUState,CPU_F);
+                     // Check flags breakpoint.  Do it here instead of everywhere flags are
+                     // changed so as to limit the number of calls to check the breakpoint.
+                     CNES::CHECKBREAKPOINT(eBreakInCPU,eBreakOnCPUState,CPU_F);
+                  }
+                  else
+                  {
+                     // Nothing is traced, so an instruction still in flight
+                     // when debugging is turned on has nowhere to go.
+                     m_state->disassemblySample = TRACER_NO_SAMPLE;
+                  }
 
                   // Check for KIL opcodes...
-                  if ( (((*opcodeData) == 0x02) ||
-                        ((*opcodeData) == 0x12) ||
-                        ((*opcodeData) == 0x22) ||
-                        ((*opcodeData) == 0x32) ||
-                        ((*opcodeData) == 0x42) ||
-                        ((*opcodeData) == 0x52) ||
-                        ((*opcodeData) == 0x62) ||
-                        ((*opcodeData) == 0x72) ||
-                        ((*opcodeData) == 0x92) ||
-                        ((*opcodeData) == 0xB2) ||
-                        ((*opcodeData) == 0xD2) ||
-                        ((*opcodeData) == 0xF2)) )
+                  if ( m_state->m_breakOnKIL &&
+                       (((*m_state->opcodeData) == 0x02) ||
+                        ((*m_state->opcodeData) == 0x12) ||
+                        ((*m_state->opcodeData) == 0x22) ||
+                        ((*m_state->opcodeData) == 0x32) ||
+                        ((*m_state->opcodeData) == 0x42) ||
+                        ((*m_state->opcodeData) == 0x52) ||
+                        ((*m_state->opcodeData) == 0x62) ||
+                        ((*m_state->opcodeData) == 0x72) ||
+                        ((*m_state->opcodeData) == 0x92) ||
+                        ((*m_state->opcodeData) == 0xB2) ||
+                        ((*m_state->opcodeData) == 0xD2) ||
+                        ((*m_state->opcodeData) == 0xF2)) )
                   {
                      // KIL opcodes halt PC dead!  Force break if desired...
-                     if ( m_breakOnKIL )
-                     {
-                        CNES::FORCEBREAKPOINT ();
-                     }
+                     CNES::FORCEBREAKPOINT ();
                   }
 
-                  if ( rPC() == m_pcGoto )
+                  if ( Debuggable && (rPC() == m_state->m_pcGoto) )
                   {
                      CNES::STEPCPUBREAKPOINT();
-                     m_pcGoto = 0xFFFFFFFF;
+                     m_state->m_pcGoto = 0xFFFFFFFF;
                   }
 
                   // If we fetched a BRK we might need to do some special stuff...
-                  if ( (!(nmiPending || m_irqPending)) && (*opcodeData) == BRK_IMPLIED )
+                  if ( (!(nmiPending || m_state->m_irqPending)) && (*m_state->opcodeData) == BRK_IMPLIED )
                   {
                      INCPC ();
                      sB ();
                   }
 
                   // Inject BRK if IRQ or NMI are pending...
-                  if ( (m_irqPending && (!rI())) || nmiPending )
+                  if ( (m_state->m_irqPending && (!rI())) || nmiPending )
                   {
-                     (*opcodeData) = BRK_IMPLIED;
+                     (*m_state->opcodeData) = BRK_IMPLIED;
                   }
 
-                  if ( (*opcodeData) != BRK_IMPLIED )
+                  if ( (*m_state->opcodeData) != BRK_IMPLIED )
                   {
                      INCPC ();
                   }
 
                   // Get information about current opcode...
-                  pOpcodeStruct = m_6502opcode+(*opcodeData);
-                  opcodeSize = (*(opcode_size+(pOpcodeStruct->amode)));
+                  m_state->pOpcodeStruct = m_6502opcode+(*m_state->opcodeData);
+                  m_state->opcodeSize = (*(opcode_size+(m_state->pOpcodeStruct->amode)));
 
                   // Set up class data so we don't need to pass it down to each func...
-                  amode = pOpcodeStruct->amode;
-                  data = opcodeData+1;
+                  m_state->amode = m_state->pOpcodeStruct->amode;
+                  m_state->data = m_state->opcodeData+1;
 
                   // Go to next phase...
-                  m_phase++;
+                  m_state->m_phase++;
                }
-               else if ( m_phase == 1 )
+               else if ( m_state->m_phase == 1 )
                {
                   // Check for dummy-read needed for single-byte instructions...
-                  if ( opcodeSize == 1 )
+                  if ( m_state->opcodeSize == 1 )
                   {
                      // Perform additional fetch...
-                     (*(opcodeData+1)) = EXTRAFETCH ();
+                     (*(m_state->opcodeData+1)) = EXTRAFETCH<Debuggable> ();
 
-                     if ( rPC() == m_pcGoto )
+                     if ( Debuggable && (rPC() == m_state->m_pcGoto) )
                      {
                         CNES::STEPCPUBREAKPOINT();
-                        m_pcGoto = 0xFFFFFFFF;
+                        m_state->m_pcGoto = 0xFFFFFFFF;
                      }
 
                      if ( rB() )
@@ -665,117 +754,368 @@ void C6502::EMULATE ( int32_t cycles )
                      }
 
                      // Cause instruction execution...
-                     m_phase = -1;
+                     m_state->m_phase = -1;
                   }
                   else
                   {
-                     (*(opcodeData+1)) = FETCH ();
+                     (*(m_state->opcodeData+1)) = FETCH<Debuggable> ();
 
-                     if ( rPC() == m_pcGoto )
+                     if ( Debuggable && (rPC() == m_state->m_pcGoto) )
                      {
                         CNES::STEPCPUBREAKPOINT();
-                        m_pcGoto = 0xFFFFFFFF;
+                        m_state->m_pcGoto = 0xFFFFFFFF;
                      }
 
                      INCPC ();
 
-                     if ( opcodeSize == 2 )
+                     if ( m_state->opcodeSize == 2 )
                      {
                         // Cause instruction execution...
-                        m_phase = -1;
+                        m_state->m_phase = -1;
                      }
                      else
                      {
                         // JSR doesn't do the third byte fetch yet.
-                        if ( (*opcodeData) == JSR_ABSOLUTE )
+                        if ( (*m_state->opcodeData) == JSR_ABSOLUTE )
                         {
                            // Cause instruction execution...
-                           m_phase = -1;
+                           m_state->m_phase = -1;
                         }
                         else
                         {
                            // Go to next phase...
-                           m_phase++;
+                           m_state->m_phase++;
                         }
                      }
                   }
                }
-               else if ( m_phase == 2 )
+               else if ( m_state->m_phase == 2 )
                {
-                  (*(opcodeData+2)) = FETCH ();
+                  (*(m_state->opcodeData+2)) = FETCH<Debuggable> ();
 
-                  if ( rPC() == m_pcGoto )
+                  if ( Debuggable && (rPC() == m_state->m_pcGoto) )
                   {
                      CNES::STEPCPUBREAKPOINT();
-                     m_pcGoto = 0xFFFFFFFF;
+                     m_state->m_pcGoto = 0xFFFFFFFF;
                   }
 
                   INCPC ();
 
                   // Cause instruction execution...
-                  m_phase = -1;
+                  m_state->m_phase = -1;
                }
-               else if (  m_phase == -1 )
+               else if (  m_state->m_phase == -1 )
                {
-                  if ( nesIsDebuggable() )
+                  if ( Debuggable )
                   {
                      // Update Tracer
-                     CNES::TRACER()->SetRegisters ( pDisassemblySample, rA(), rX(), rY(), rSP(), rF() );
+                     CNES::TRACER()->SetRegisters ( m_state->disassemblySample, rA(), rX(), rY(), rSP(), rF() );
                   }
 
-                  if ( rPC() == m_pcGoto )
+                  if ( Debuggable && (rPC() == m_state->m_pcGoto) )
                   {
                      CNES::STEPCPUBREAKPOINT();
-                     m_pcGoto = 0xFFFFFFFF;
+                     m_state->m_pcGoto = 0xFFFFFFFF;
                   }
 
                   // Execute
-                  pOpcodeStruct->pFn();
+                  m_state->pOpcodeStruct->pFn();
 
-                  if ( nesIsDebuggable() )
+                  if ( Debuggable )
                   {
                      // Update Tracer
-                     CNES::TRACER()->SetDisassembly ( pDisassemblySample, opcodeData );
+                     CNES::TRACER()->SetDisassembly ( m_state->disassemblySample, m_state->opcodeData );
 
                      // Check for undocumented breakpoint...
-                     if ( !pOpcodeStruct->documented )
+                     if ( !m_state->pOpcodeStruct->documented )
                      {
                         CNES::CHECKBREAKPOINT ( eBreakInCPU, eBreakOnCPUEvent, 0, CPU_EVENT_UNDOCUMENTED );
-                        CNES::CHECKBREAKPOINT ( eBreakInCPU, eBreakOnCPUEvent, (*opcodeData), CPU_EVENT_UNDOCUMENTED_EXACT );
+                        CNES::CHECKBREAKPOINT ( eBreakInCPU, eBreakOnCPUEvent, (*m_state->opcodeData), CPU_EVENT_UNDOCUMENTED_EXACT );
                      }
                      else
                      {
-                        CNES::CHECKBREAKPOINT ( eBreakInCPU, eBreakOnCPUEvent, (*opcodeData), CPU_EVENT_EXECUTE_EXACT );
+                        CNES::CHECKBREAKPOINT ( eBreakInCPU, eBreakOnCPUEvent, (*m_state->opcodeData), CPU_EVENT_EXECUTE_EXACT );
                      }
                   }
 
                   // Go back to fetch phases...
-                  if ( ((*opcodeData) != BRK_IMPLIED) ||
-                       (((*opcodeData) == BRK_IMPLIED) && (m_instrCycle == 7)) )
+                  if ( ((*m_state->opcodeData) != BRK_IMPLIED) ||
+                       (((*m_state->opcodeData) == BRK_IMPLIED) && (m_state->m_instrCycle == 7)) )
                   {
-                     m_phase = 0;
+                     m_state->m_phase = 0;
                   }
                }
             }
          }
       }
-      while ( (!m_killed) && (m_curCycles > 0) );
+      while ( (!m_state->m_killed) && (m_state->m_curCycles > 0) );
    }
    else
    {
       // Run APU for cycles...
       while ( cycles )
       {
-         CAPU::EMULATE ();
+         CAPU::CLOCK<Debuggable> ();
          cycles--;
       }
    }
 }
 
+void C6502::IDLESNAPSHOT ( uint8_t* regs )
+{
+   regs[0] = m_state->m_a;
+   regs[1] = m_state->m_x;
+   regs[2] = m_state->m_y;
+   regs[3] = m_state->m_f;
+   regs[4] = m_state->m_sp;
+   regs[5] = m_state->m_openBusData;
+   regs[6] = m_state->opcodeData[0];
+   regs[7] = m_state->opcodeData[1];
+   regs[8] = m_state->opcodeData[2];
+   regs[9] = m_state->opcodeData[3];
+   regs[10] = m_state->m_instrCycle;
+   regs[11] = m_state->m_write;
+}
+
+bool C6502::IDLELOOP ( void )
+{
+   uint8_t  regs [ IDLE_LOOP_REGS ];
+   uint32_t turn;
+   uint32_t turns;
+   uint32_t cycles;
+   uint32_t idle;
+   uint32_t instructions;
+   bool     status;
+
+   IDLESNAPSHOT ( regs );
+   turn = m_state->m_cycles-m_state->m_idleCycle;
+
+   if ( (rPC() != m_state->m_idleHead) || (m_state->m_pcSync != m_state->m_idleTail) )
+   {
+      // Not the loop the CPU was in last time, see whether it could do.
+      m_state->m_idleHead = rPC();
+      m_state->m_idleTail = m_state->m_pcSync;
+      m_state->m_idleLoopCycles = IDLELOOPCYCLES ( m_state->m_idleHead, m_state->m_idleTail, &m_state->m_idleStatus, &m_state->m_idleLoopInstructions );
+      turn = 0;
+   }
+   else if ( !m_state->m_idleLoopCycles )
+   {
+      return false;
+   }
+
+   // Did a turn just go by in the time a turn takes, leaving everything
+   // as it was?  Any way round the loop other than straight through it
+   // takes longer: an interrupt, a stolen cycle or leaving and coming
+   // back.
+   if ( (turn != m_state->m_idleLoopCycles) ||
+        (rEA() != m_state->m_idleEA) ||
+        memcmp(regs,m_state->m_idleRegs,sizeof(regs)) )
+   {
+      memcpy(m_state->m_idleRegs,regs,sizeof(regs));
+      m_state->m_idleEA = rEA();
+      m_state->m_idleCycle = m_state->m_cycles;
+      return false;
+   }
+   m_state->m_idleCycle = m_state->m_cycles;
+
+   // Nothing may be about to interrupt it or steal cycles from it.  An
+   // IRQ from a mapper that watches the PPU can come at any time.
+   if ( m_state->m_nmiAsserted || m_state->m_nmiPending || m_state->m_irqPending || DMAACTIVE() )
+   {
+      return false;
+   }
+   if ( (!rI()) &&
+        (m_state->m_irqAsserted || (CNES::MAPPERFUNC()->sync_ppu != CROM::SYNCPPU)) )
+   {
+      return false;
+   }
+
+   // A bank switch may have put other code there since it was checked.
+   if ( (IDLELOOPCYCLES(m_state->m_idleHead,m_state->m_idleTail,&status,&instructions) != turn) ||
+        (instructions != m_state->m_idleLoopInstructions) )
+   {
+      return false;
+   }
+
+   // The cycles the CPU has been given, and those it can run ahead of
+   // the PPU, APU and mapper before any of them does something the loop
+   // could see.
+   cycles = m_state->m_curCycles+CPPU::CPUIDLECYCLES ( status );
+   idle = CAPU::IDLECYCLES ();
+   if ( idle < cycles )
+   {
+      cycles = idle;
+   }
+   idle = CNES::MAPPERIDLECYCLES ();
+   if ( idle < cycles )
+   {
+      cycles = idle;
+   }
+
+   // Leave the last turn before then to be run for real.
+   turns = cycles/turn;
+   if ( turns < 2 )
+   {
+      return false;
+   }
+   turns--;
+   cycles = turns*turn;
+
+   m_state->m_cycles += cycles;
+   m_state->m_curCycles -= cycles;
+   CAPU::CLOCKIDLE ( cycles );
+   CNES::MAPPERCLOCKIDLE ( cycles );
+
+   m_state->m_idleCycle = m_state->m_cycles;
+   m_state->m_idleTurns += turns;
+   m_state->m_idleCycles += cycles;
+   m_state->m_instructions += turns*m_state->m_idleLoopInstructions;
+
+   return true;
+}
+
+// What a turn of an idle loop may do besides branch: read memory, or
+// work on registers alone.
+static void (*idleReads [])(void) =
+{
+   C6502::LDA, C6502::LDX, C6502::LDY, C6502::BIT, C6502::CMP, C6502::CPX,
+   C6502::CPY, C6502::AND, C6502::ORA, C6502::EOR, C6502::ADC, C6502::SBC
+};
+
+static void (*idleImplied [])(void) =
+{
+   C6502::NOP, C6502::CLC, C6502::SEC, C6502::CLV, C6502::CLD, C6502::SED,
+   C6502::TAX, C6502::TAY, C6502::TXA, C6502::TYA
+};
+
+static bool idleAllowed ( void (*pFn)(void), void (**allowed)(void), uint32_t count )
+{
+   uint32_t idx;
+
+   for ( idx = 0; idx < count; idx++ )
+   {
+      if ( pFn == allowed[idx] )
+      {
+         return true;
+      }
+   }
+   return false;
+}
+
+uint32_t C6502::IDLELOOPCYCLES ( uint32_t head, uint32_t tail, bool* status, uint32_t* instructions )
+{
+   CNES6502_opcode* pOp = NULL;
+   const uint8_t* page;
+   uint8_t  code [ 3 ];
+   uint32_t addr = head;
+   uint32_t cycles = 0;
+   uint32_t target;
+   int32_t  idx;
+
+   (*status) = false;
+   (*instructions) = 0;
+
+   while ( addr <= tail )
+   {
+      // Only code that is read straight from the page table; the mapper
+      // may want to see fetches from anywhere else.
+      for ( idx = 0; idx < 3; idx++ )
+      {
+         page = m_state->m_pReadPage[((addr+idx)&0xFFFF)>>UPSHIFT_1KB];
+         if ( !page )
+         {
+            return 0;
+         }
+         code[idx] = page[(addr+idx)&MASK_1KB];
+
+         if ( idx == 0 )
+         {
+            pOp = m_6502opcode+code[0];
+         }
+         if ( idx+1 >= opcode_size[pOp->amode] )
+         {
+            break;
+         }
+      }
+
+      if ( !pOp->documented )
+      {
+         return 0;
+      }
+      (*instructions)++;
+
+      if ( addr == tail )
+      {
+         // The loop closes with a branch or jump back to its top.
+         if ( pOp->amode == AM_RELATIVE )
+         {
+            target = (addr+2+(int8_t)code[1])&0xFFFF;
+            if ( target != head )
+            {
+               return 0;
+            }
+            return cycles+3+((((addr+2)^head)&0xFF00) ? 1 : 0);
+         }
+         if ( (code[0] == JMP_ABSOLUTE) && ((uint32_t)MAKE16(code[1],code[2]) == head) )
+         {
+            return cycles+3;
+         }
+         return 0;
+      }
+
+      switch ( pOp->amode )
+      {
+         case AM_RELATIVE:
+            // Any other branch has to leave the loop.
+            target = (addr+2+(int8_t)code[1])&0xFFFF;
+            if ( (target >= head) && (target <= tail) )
+            {
+               return 0;
+            }
+            cycles += 2;
+            break;
+         case AM_IMPLIED:
+            if ( !idleAllowed(pOp->pFn,idleImplied,sizeof(idleImplied)/sizeof(idleImplied[0])) )
+            {
+               return 0;
+            }
+            cycles += pOp->cycles;
+            break;
+         case AM_ABSOLUTE:
+            // RAM, ROM and SRAM read straight from the page table, and
+            // PPUSTATUS, only change when the CPU could notice.
+            target = MAKE16(code[1],code[2]);
+            if ( (target >= 0x2000) && (target < 0x4000) && ((target&0x7) == PPUSTATUS_REG) )
+            {
+               (*status) = true;
+            }
+            else if ( !m_state->m_pReadPage[target>>UPSHIFT_1KB] )
+            {
+               return 0;
+            }
+            // Fall through...
+         case AM_IMMEDIATE:
+         case AM_ZEROPAGE:
+            if ( !idleAllowed(pOp->pFn,idleReads,sizeof(idleReads)/sizeof(idleReads[0])) )
+            {
+               return 0;
+            }
+            cycles += pOp->cycles;
+            break;
+         default:
+            return 0;
+      }
+
+      addr += opcode_size[pOp->amode];
+   }
+
+   return 0;
+}
+
 void C6502::APUDMAREQ ( uint16_t addr )
 {
-   m_dmaRequest = 3;
-   m_readDmaAddr = addr;
+   m_state->m_dmaRequest = 3;
+   m_state->m_readDmaAddr = addr;
 }
 
 void C6502::ADVANCE ( bool stealing )
@@ -784,85 +1124,91 @@ void C6502::ADVANCE ( bool stealing )
    if ( !stealing )
    {
       // NMI is ignored if it is asserted in the 6th or 7th cycles of a BRK.
-      if ( ((*opcodeData) != BRK_IMPLIED) ||
-           (((*opcodeData) == BRK_IMPLIED) &&
-           (m_instrCycle >= 0) &&
-           (m_instrCycle < 5)) )
+      if ( ((*m_state->opcodeData) != BRK_IMPLIED) ||
+           (((*m_state->opcodeData) == BRK_IMPLIED) &&
+           (m_state->m_instrCycle >= 0) &&
+           (m_state->m_instrCycle < 5)) )
       {
          // NMI is edge-sensitive thus it will only be marked as pending
          // if an assertion occurred recently.  Once marked as pending it
          // is cleared as not asserted to prevent multiple NMIs on a single
          // edge.
-         if ( m_nmiAsserted )
+         if ( m_state->m_nmiAsserted )
          {
             // NMI is now pending to the CPU.
-            m_nmiPending = true;
-            m_nmiAsserted = false;
+            m_state->m_nmiPending = true;
+            m_state->m_nmiAsserted = false;
          }
       }
 
-      if ( pOpcodeStruct && (pOpcodeStruct->checkInterruptCycleMap&(1<<m_instrCycle)) )
+      if ( m_state->pOpcodeStruct && (m_state->pOpcodeStruct->checkInterruptCycleMap&(1<<m_state->m_instrCycle)) )
       {
          // IRQ is level-sensitive thus it will always be marked as
          // "pending" if it has been asserted and not negated by the peripheral (and the
          // special cases described below are considered).
-         if ( m_irqAsserted && !rI() )
+         if ( m_state->m_irqAsserted && !rI() )
          {
             // IRQ is now pending to the CPU.
-            m_irqPending = true;
+            m_state->m_irqPending = true;
          }
       }
    }
 
-   // Tell mappers that look at CPU cycles that a CPU cycle has whisked by...
-   MAPPERFUNC->sync_cpu();
-
-   // Run APU for one cycle...
-   CAPU::EMULATE ();
+   // Tell mappers that look at CPU cycles that a CPU cycle has whisked by,
+   // and run APU for one cycle...
+   if ( nesIsDebuggable() )
+   {
+      CNES::MAPPERCLOCK<true> ();
+      CAPU::CLOCK<true> ();
+   }
+   else
+   {
+      CNES::MAPPERCLOCK<false> ();
+      CAPU::CLOCK<false> ();
+   }
 
    // Increment running cycle counters...
-   m_cycles++;
+   m_state->m_cycles++;
 
    // If stealing, don't move instruction cycle forward.
    if ( !stealing )
    {
-      m_instrCycle++;
+      m_state->m_instrCycle++;
    }
 
    // Decrement cycles available counter...
-   m_curCycles--;
+   m_state->m_curCycles--;
 }
 
 bool C6502::DMA( void )
 {
    bool doCycle = true;
-   static uint8_t databuf;
 
    // If the DMC DMA request is active it means the CPU was writing when
    // the DMC DMA controller went active.  We need to assert RDY on the next
    // CPU read cycle.  Check if that is now.
-   if ( !m_dmaRequest )
+   if ( !m_state->m_dmaRequest )
    {
-      if ( !m_write )
+      if ( !m_state->m_write )
       {
-         if ( m_writeDmaCounter )
+         if ( m_state->m_writeDmaCounter )
          {
-            m_readDmaCounter = 2;
+            m_state->m_readDmaCounter = 2;
          }
          else
          {
-            m_readDmaCounter = 4;
+            m_state->m_readDmaCounter = 4;
          }
          if ( !(_CYCLES()&1) )
          {
-            m_readDmaCounter++;
+            m_state->m_readDmaCounter++;
          }
-         m_dmaRequest--;
+         m_state->m_dmaRequest--;
       }
    }
-   if ( m_dmaRequest > 0 )
+   if ( m_state->m_dmaRequest > 0 )
    {
-      m_dmaRequest--;
+      m_state->m_dmaRequest--;
    }
 
    // Run the DMA controller cycles if necessary.
@@ -871,17 +1217,17 @@ bool C6502::DMA( void )
    {
       // APU DMC DMA happens even if sprite DMA is occurring.
       // If we're in the waiting period before DMA, wait.
-      if ( m_readDmaCounter > 4 )
+      if ( m_state->m_readDmaCounter > 4 )
       {
-         m_readDmaCounter--;
+         m_state->m_readDmaCounter--;
          goto done;
       }
       // If we're in the DMC DMA RDY-phase, just steal a cycle if there's
       // no sprite DMA already stealing them.
-      if ( m_readDmaCounter > 2 )
+      if ( m_state->m_readDmaCounter > 2 )
       {
-         m_readDmaCounter--;
-         if ( !m_writeDmaCounter )
+         m_state->m_readDmaCounter--;
+         if ( !m_state->m_writeDmaCounter )
          {
             STEAL ( 1, eNESSource_APU );
             doCycle = false;
@@ -894,10 +1240,10 @@ bool C6502::DMA( void )
          }
       }
       // If we're ready to do the DMC DMA read, do it.
-      if ( m_readDmaCounter == 2 )
+      if ( m_state->m_readDmaCounter == 2 )
       {
-         CAPU::DMASAMPLE ( DMA(m_readDmaAddr) );
-         m_readDmaCounter--;
+         CAPU::DMASAMPLE ( DMA(m_state->m_readDmaAddr) );
+         m_state->m_readDmaCounter--;
          doCycle = false;
 
          if ( nesIsDebuggable() )
@@ -909,25 +1255,25 @@ bool C6502::DMA( void )
          goto done;
       }
       // If we're in the sprite DMA RDY-phase, just steal a cycle.
-      if ( m_writeDmaCounter > 512 )
+      if ( m_state->m_writeDmaCounter > 512 )
       {
          STEAL ( 1, eNESSource_PPU );
-         m_writeDmaCounter--;
+         m_state->m_writeDmaCounter--;
          doCycle = false;
          goto done;
       }
       // If we're ready to do the sprite DMA read, do it.
-      if ( m_writeDmaCounter )
+      if ( m_state->m_writeDmaCounter )
       {
-         databuf = DMA(m_writeDmaAddr|(((512-m_writeDmaCounter)>>1)&0xFF));
+         m_state->m_dmaDatabuf = DMA(m_state->m_writeDmaAddr|(((512-m_state->m_writeDmaCounter)>>1)&0xFF));
 
          if ( nesIsDebuggable() )
          {
             // Check for PPU cycle breakpoint...
-            CNES::CHECKBREAKPOINT ( eBreakInPPU, eBreakOnPPUEvent, (512-m_writeDmaCounter)>>1, PPU_EVENT_SPRITE_DMA );
+            CNES::CHECKBREAKPOINT ( eBreakInPPU, eBreakOnPPUEvent, (512-m_state->m_writeDmaCounter)>>1, PPU_EVENT_SPRITE_DMA );
          }
 
-         m_writeDmaCounter--;
+         m_state->m_writeDmaCounter--;
          doCycle = false;
          goto done;
       }
@@ -935,17 +1281,17 @@ bool C6502::DMA( void )
    else
    {
       // If we're in the waiting period before DMA, wait.
-      if ( m_readDmaCounter > 4 )
+      if ( m_state->m_readDmaCounter > 4 )
       {
-         m_readDmaCounter--;
+         m_state->m_readDmaCounter--;
          goto done;
       }
       // If we're in the DMC DMA RDY-phase, just steal a cycle if there's
       // no sprite DMA already stealing them.
-      if ( m_readDmaCounter > 2 )
+      if ( m_state->m_readDmaCounter > 2 )
       {
-         m_readDmaCounter--;
-         if ( !m_writeDmaCounter )
+         m_state->m_readDmaCounter--;
+         if ( !m_state->m_writeDmaCounter )
          {
             STEAL ( 1, eNESSource_APU );
             doCycle = false;
@@ -959,36 +1305,36 @@ bool C6502::DMA( void )
       }
       // If APU DMC DMA occurred on the read-beat, skip this
       // write-beat if sprite DMA is in progress.
-      if ( m_readDmaCounter == 1 )
+      if ( m_state->m_readDmaCounter == 1 )
       {
-         if ( m_writeDmaCounter )
+         if ( m_state->m_writeDmaCounter )
          {
-            m_readDmaCounter--;
+            m_state->m_readDmaCounter--;
             STEAL(rPC(),eNESSource_APU); // Put CPU on bus.
             doCycle = false;
             goto done;
          }
          else
          {
-            m_readDmaCounter--;
+            m_state->m_readDmaCounter--;
             goto done;
          }
       }
       // If we're in the sprite DMA RDY-phase, just steal a cycle.
-      if ( m_writeDmaCounter > 512 )
+      if ( m_state->m_writeDmaCounter > 512 )
       {
          STEAL ( 1, eNESSource_PPU );
-         m_writeDmaCounter--;
+         m_state->m_writeDmaCounter--;
          doCycle = false;
          goto done;
       }
       // If we're ready to do the sprite DMA write, do it.
-      if ( m_writeDmaCounter )
+      if ( m_state->m_writeDmaCounter )
       {
-         DMA ( (m_writeDmaAddr)|(((512-m_writeDmaCounter)>>1)&0xFF),
+         DMA ( (m_state->m_writeDmaAddr)|(((512-m_state->m_writeDmaCounter)>>1)&0xFF),
                OAMDATA,
-               databuf );
-         m_writeDmaCounter--;
+               m_state->m_dmaDatabuf );
+         m_state->m_writeDmaCounter--;
          doCycle = false;
          goto done;
       }
@@ -996,60 +1342,60 @@ bool C6502::DMA( void )
    done:
 #if 0
 
-   if ( (m_readDmaCounter > 1) && (!m_writeDmaCounter) )
+   if ( (m_state->m_readDmaCounter > 1) && (!m_state->m_writeDmaCounter) )
    {
       STEAL ( 1, eNESSource_APU );
-      m_readDmaCounter--;
+      m_state->m_readDmaCounter--;
       doCycle = false;
    }
-   else if ( m_readDmaCounter > 1 )
+   else if ( m_state->m_readDmaCounter > 1 )
    {
-      m_readDmaCounter--;
+      m_state->m_readDmaCounter--;
       doCycle = false;
    }
-   else if ( m_writeDmaCounter > 512 )
+   else if ( m_state->m_writeDmaCounter > 512 )
    {
       STEAL ( 1, eNESSource_PPU );
-      m_writeDmaCounter--;
+      m_state->m_writeDmaCounter--;
       doCycle = false;
    }
-   else if ( m_readDmaCounter == 1 && (!m_writeDmaCounter) )
+   else if ( m_state->m_readDmaCounter == 1 && (!m_state->m_writeDmaCounter) )
    {
-      CAPU::DMASAMPLE ( DMA(m_readDmaAddr) );
-      m_readDmaCounter--;
+      CAPU::DMASAMPLE ( DMA(m_state->m_readDmaAddr) );
+      m_state->m_readDmaCounter--;
       doCycle = false;
    }
-   else if ( m_readDmaCounter == 1 )
+   else if ( m_state->m_readDmaCounter == 1 )
    {
       if ( _CYCLES()&1 )
       {
-         CAPU::DMASAMPLE ( DMA(m_readDmaAddr) );
+         CAPU::DMASAMPLE ( DMA(m_state->m_readDmaAddr) );
          doCycle = false;
       }
       else
       {
          STEAL ( 1, eNESSource_APU );
-         m_readDmaCounter--;
+         m_state->m_readDmaCounter--;
          doCycle = false;
       }
    }
-   else if ( m_writeDmaCounter && (m_readDmaCounter != 1) )
+   else if ( m_state->m_writeDmaCounter && (m_state->m_readDmaCounter != 1) )
    {
       // If this is a read-beat, do the read.
-      if ( !(m_writeDmaCounter&0x01) )
+      if ( !(m_state->m_writeDmaCounter&0x01) )
       {
-         databuf = DMA(m_writeDmaAddr|(((512-m_writeDmaCounter)>>1)&0xFF));
+         m_state->m_dmaDatabuf = DMA(m_state->m_writeDmaAddr|(((512-m_state->m_writeDmaCounter)>>1)&0xFF));
          doCycle = false;
       }
       // If this is a write-beat, do the write.
       else
       {
-         DMA ( (m_writeDmaAddr)|(((512-m_writeDmaCounter)>>1)&0xFF),
+         DMA ( (m_state->m_writeDmaAddr)|(((512-m_state->m_writeDmaCounter)>>1)&0xFF),
                OAMDATA,
-               databuf );
+               m_state->m_dmaDatabuf );
          doCycle = false;
       }
-      m_writeDmaCounter--;
+      m_state->m_writeDmaCounter--;
    }
 #endif
 
@@ -1057,51 +1403,51 @@ bool C6502::DMA( void )
    // Steal a CPU cycle if it is the appropriate time to do so...
    // If the CPU is currently writing, we don't bother it unless we're
    // already bothering it.
-   if ( (m_readDmaCounter > 1) && ((m_writeDmaCounter == 0) || (!(m_writeDmaCounter&1))) )
+   if ( (m_state->m_readDmaCounter > 1) && ((m_state->m_writeDmaCounter == 0) || (!(m_state->m_writeDmaCounter&1))) )
    {
-      if ( m_write )
+      if ( m_state->m_write )
       {
-         m_readDmaCounter--;
+         m_state->m_readDmaCounter--;
          return true;
       }
       else
       {
          STEAL ( 1, eNESSource_APU );
-         m_readDmaCounter--;
+         m_state->m_readDmaCounter--;
          doCycle = false;
       }
    }
-   if ( m_writeDmaCounter > 512 )
+   if ( m_state->m_writeDmaCounter > 512 )
    {
       STEAL ( 1, eNESSource_PPU );
-      m_writeDmaCounter--;
+      m_state->m_writeDmaCounter--;
       doCycle = false;
    }
 
    // Perform DMA if necessary.
    if ( doCycle )
    {
-      if ( (m_readDmaCounter == 1) && ((m_writeDmaCounter == 0) || (!(m_writeDmaCounter&1))) )
+      if ( (m_state->m_readDmaCounter == 1) && ((m_state->m_writeDmaCounter == 0) || (!(m_state->m_writeDmaCounter&1))) )
       {
-         CAPU::DMASAMPLE ( DMA(m_readDmaAddr) );
-         m_readDmaCounter = 0;
+         CAPU::DMASAMPLE ( DMA(m_state->m_readDmaAddr) );
+         m_state->m_readDmaCounter = 0;
          doCycle = false;
       }
-      if ( m_writeDmaCounter && doCycle )
+      if ( m_state->m_writeDmaCounter && doCycle )
       {
-         if ( !(m_writeDmaCounter&1) )
+         if ( !(m_state->m_writeDmaCounter&1) )
          {
-            databuf = DMA(m_writeDmaAddr|(((512-m_writeDmaCounter)>>1)&0xFF));
-            m_writeDmaCounter--;
+            m_state->m_dmaDatabuf = DMA(m_state->m_writeDmaAddr|(((512-m_state->m_writeDmaCounter)>>1)&0xFF));
+            m_state->m_writeDmaCounter--;
             doCycle = false;
          }
          // If we are on a DMA cycle, do the DMA...
          else
          {
-            DMA ( (m_writeDmaAddr)|(((512-m_writeDmaCounter)>>1)&0xFF),
+            DMA ( (m_state->m_writeDmaAddr)|(((512-m_state->m_writeDmaCounter)>>1)&0xFF),
                   OAMDATA,
-                  databuf );
-            m_writeDmaCounter--;
+                  m_state->m_dmaDatabuf );
+            m_state->m_writeDmaCounter--;
             doCycle = false;
          }
       }
@@ -1116,7 +1462,7 @@ bool C6502::DMA( void )
 
 void C6502::KIL ( void )
 {
-   m_killed = true;
+   m_state->m_killed = true;
    return;
 }
 
@@ -1131,7 +1477,7 @@ void C6502::KIL ( void )
 // Immediate   |AAC #arg   |$2B| 2 | 2
 void C6502::ANC ( void )
 {
-   wA ( rA()&(*data) );
+   wA ( rA()&(*m_state->data) );
    wN ( rA()&0x80 );
    wC ( rA()&0x80 );
    wZ ( !rA() );
@@ -1149,7 +1495,7 @@ void C6502::ANC ( void )
 // Immediate   |ASR #arg   |$4B| 2 | 2
 void C6502::ALR ( void )
 {
-   wA ( (rA()&(*data)) );
+   wA ( (rA()&(*m_state->data)) );
    wC ( rA()&0x01 );
    wA ( rA()>>1 );
    wN ( rA()&0x80 );
@@ -1173,7 +1519,7 @@ void C6502::ALR ( void )
 // Immediate   |ARR #arg   |$6B| 2 | 2
 void C6502::ARR ( void )
 {
-   wA ( (rC()<<7)|((rA()>>1)&((*data)>>1)) );
+   wA ( (rC()<<7)|((rA()>>1)&((*m_state->data)>>1)) );
    wN ( rA()&0x80 );
    wZ ( !rA() );
 
@@ -1231,7 +1577,7 @@ void C6502::AXA ( void )
    uint16_t addr;
    uint8_t  val;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
    val = (rX()&rA())&7;
    MEM ( addr, val );
 
@@ -1257,8 +1603,8 @@ void C6502::TAS ( void )
    uint8_t  val;
 
    wSP ( rX()&rA() );
-   addr = MAKEADDR ( amode, data );
-   val = (rSP()&((*(data+1))+1));
+   addr = MAKEADDR ( m_state->amode, m_state->data );
+   val = (rSP()&((*(m_state->data+1))+1));
    MEM ( addr, val );
 
    return;
@@ -1281,7 +1627,7 @@ void C6502::SAY ( void )
    uint16_t addr;
    uint8_t  val;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
    val = (rY()&((addr>>8)+1));
    addr &= 0x00FF;
    addr |= (val<<8);
@@ -1307,7 +1653,7 @@ void C6502::XAS ( void )
    uint16_t addr;
    uint8_t  val;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
    val = (rX()&((addr>>8)+1));
    addr &= 0x00FF;
    addr |= (val<<8);
@@ -1326,7 +1672,7 @@ void C6502::XAS ( void )
 // Immediate   |ATX #arg   |$AB| 2 | 2
 void C6502::OAL ( void )
 {
-   wA ( (*data) );
+   wA ( (*m_state->data) );
    wX ( rA() );
    wN ( rX()&0x80 );
    wZ ( !rX() );
@@ -1347,7 +1693,7 @@ void C6502::LAS ( void )
 {
    uint16_t addr;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
    wA ( rSP()&MEM(addr) );
    wX ( rA() );
    wSP ( rA() );
@@ -1371,7 +1717,7 @@ void C6502::SAX ( void )
    int16_t val;
 
    wX ( rA()&rX() );
-   val = rX()-(*data);
+   val = rX()-(*m_state->data);
    wX ( val&0xFF );
    wN ( rX()&0x80 );
    wZ ( !rX() );
@@ -1400,7 +1746,7 @@ void C6502::ASO ( void )
    uint16_t addr;
    uint16_t val;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
    val = MEM ( addr );
 
    val <<= 1;
@@ -1433,7 +1779,7 @@ void C6502::AXS ( void )
 {
    uint16_t addr;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
 
    MEM ( addr, rA()&rX() );
 
@@ -1464,13 +1810,13 @@ void C6502::ORA ( void )
 {
    uint16_t addr;
 
-   if ( amode == AM_IMMEDIATE )
+   if ( m_state->amode == AM_IMMEDIATE )
    {
-      wA ( rA()|(*data) );
+      wA ( rA()|(*m_state->data) );
    }
    else
    {
-      addr = MAKEADDR ( amode, data );
+      addr = MAKEADDR ( m_state->amode, m_state->data );
       wA ( rA()|MEM(addr) );
    }
 
@@ -1500,13 +1846,13 @@ void C6502::ASL ( void )
    uint16_t addr = 0x0000;
    uint16_t val;
 
-   if ( amode == AM_ACCUMULATOR )
+   if ( m_state->amode == AM_ACCUMULATOR )
    {
       val = rA ();
    }
    else
    {
-      addr = MAKEADDR ( amode, data );
+      addr = MAKEADDR ( m_state->amode, m_state->data );
       val = MEM ( addr );
 
       // dummy write
@@ -1515,7 +1861,7 @@ void C6502::ASL ( void )
 
    val <<= 1;
 
-   if ( amode == AM_ACCUMULATOR )
+   if ( m_state->amode == AM_ACCUMULATOR )
    {
       wA ( (uint8_t)val );
    }
@@ -1565,12 +1911,12 @@ void C6502::BPL ( void )
 {
    uint32_t target;
 
-   target = rPC()+GETSIGNED8(data,0);
+   target = rPC()+GETSIGNED8(m_state->data,0);
 
    if ( !rN() )
    {
       // Synchronize CPU and APU...
-      MEM ( (rPC()&0xFF00)|(((rPC()&0x00FF)+GETUNSIGNED8(data,0))&0xFF) );
+      MEM ( (rPC()&0xFF00)|(((rPC()&0x00FF)+GETUNSIGNED8(m_state->data,0))&0xFF) );
 
       // Extra cycle.
       if ( (rPC()&0xFF00) != (target&0xFF00) )
@@ -1581,10 +1927,10 @@ void C6502::BPL ( void )
 
       wPC ( target );
 
-      if ( rPC() == m_pcGoto )
+      if ( rPC() == m_state->m_pcGoto )
       {
          CNES::STEPCPUBREAKPOINT();
-         m_pcGoto = 0xFFFFFFFF;
+         m_state->m_pcGoto = 0xFFFFFFFF;
       }
    }
 
@@ -1626,14 +1972,14 @@ void C6502::JSR ( void )
    PUSH ( GETHI8(rPC()) );
    PUSH ( GETLO8(rPC()) );
 
-   *(data+1) = FETCH ();
+   *(m_state->data+1) = FETCH ();
 
-   wPC ( MAKE16(GETUNSIGNED8(data,0),GETUNSIGNED8(data,1)) );
+   wPC ( MAKE16(GETUNSIGNED8(m_state->data,0),GETUNSIGNED8(m_state->data,1)) );
 
-   if ( rPC() == m_pcGoto )
+   if ( rPC() == m_state->m_pcGoto )
    {
       CNES::STEPCPUBREAKPOINT();
-      m_pcGoto = 0xFFFFFFFF;
+      m_state->m_pcGoto = 0xFFFFFFFF;
    }
 
    return;
@@ -1661,13 +2007,13 @@ void C6502::AND ( void )
 {
    uint16_t addr;
 
-   if ( amode == AM_IMMEDIATE )
+   if ( m_state->amode == AM_IMMEDIATE )
    {
-      wA ( rA()&(*data) );
+      wA ( rA()&(*m_state->data) );
    }
    else
    {
-      addr = MAKEADDR ( amode, data );
+      addr = MAKEADDR ( m_state->amode, m_state->data );
       wA ( rA()&MEM(addr) );
    }
 
@@ -1696,7 +2042,7 @@ void C6502::BIT ( void )
    uint16_t addr;
    uint8_t  val;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
 
    val = MEM ( addr );
 
@@ -1730,13 +2076,13 @@ void C6502::ROL ( void )
    uint16_t addr = 0x0000;
    uint16_t val;
 
-   if ( amode == AM_ACCUMULATOR )
+   if ( m_state->amode == AM_ACCUMULATOR )
    {
       val = rA ();
    }
    else
    {
-      addr = MAKEADDR ( amode, data );
+      addr = MAKEADDR ( m_state->amode, m_state->data );
       val = MEM ( addr );
 
       // dummy write
@@ -1750,7 +2096,7 @@ void C6502::ROL ( void )
    wN ( val&0x80 );
    wZ ( !val );
 
-   if ( amode == AM_ACCUMULATOR )
+   if ( m_state->amode == AM_ACCUMULATOR )
    {
       wA ( (uint8_t)val );
    }
@@ -1798,12 +2144,12 @@ void C6502::BMI ( void )
 {
    uint32_t target;
 
-   target = rPC()+GETSIGNED8(data,0);
+   target = rPC()+GETSIGNED8(m_state->data,0);
 
    if ( rN() )
    {
       // Synchronize CPU and APU...
-      MEM ( (rPC()&0xFF00)|(((rPC()&0x00FF)+GETUNSIGNED8(data,0))&0xFF) );
+      MEM ( (rPC()&0xFF00)|(((rPC()&0x00FF)+GETUNSIGNED8(m_state->data,0))&0xFF) );
 
       // Extra cycle.
       if ( (rPC()&0xFF00) != (target&0xFF00) )
@@ -1814,10 +2160,10 @@ void C6502::BMI ( void )
 
       wPC ( target );
 
-      if ( rPC() == m_pcGoto )
+      if ( rPC() == m_state->m_pcGoto )
       {
          CNES::STEPCPUBREAKPOINT();
-         m_pcGoto = 0xFFFFFFFF;
+         m_state->m_pcGoto = 0xFFFFFFFF;
       }
    }
 
@@ -1866,12 +2212,12 @@ void C6502::RTI ( void )
 
    wF ( f );
 
-   m_irqPending = false;
+   m_state->m_irqPending = false;
 
-   if ( rPC() == m_pcGoto )
+   if ( rPC() == m_state->m_pcGoto )
    {
       CNES::STEPCPUBREAKPOINT();
-      m_pcGoto = 0xFFFFFFFF;
+      m_state->m_pcGoto = 0xFFFFFFFF;
    }
 
    return;
@@ -1899,13 +2245,13 @@ void C6502::EOR ( void )
 {
    uint16_t addr;
 
-   if ( amode == AM_IMMEDIATE )
+   if ( m_state->amode == AM_IMMEDIATE )
    {
-      wA ( rA()^(*data) );
+      wA ( rA()^(*m_state->data) );
    }
    else
    {
-      addr = MAKEADDR ( amode, data );
+      addr = MAKEADDR ( m_state->amode, m_state->data );
       wA ( rA()^MEM(addr) );
    }
 
@@ -1934,7 +2280,7 @@ void C6502::LSE ( void )
    uint16_t addr;
    uint16_t val;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
    val = MEM ( addr );
 
    wC ( val&0x01 );
@@ -1972,13 +2318,13 @@ void C6502::LSR ( void )
    uint16_t addr = 0x0000;
    uint16_t val;
 
-   if ( amode == AM_ACCUMULATOR )
+   if ( m_state->amode == AM_ACCUMULATOR )
    {
       val = rA ();
    }
    else
    {
-      addr = MAKEADDR ( amode, data );
+      addr = MAKEADDR ( m_state->amode, m_state->data );
       val = MEM ( addr );
 
       // dummy write
@@ -1991,7 +2337,7 @@ void C6502::LSR ( void )
    cN ();
    wZ ( !val );
 
-   if ( amode == AM_ACCUMULATOR )
+   if ( m_state->amode == AM_ACCUMULATOR )
    {
       wA ( (uint8_t)val );
    }
@@ -2033,9 +2379,9 @@ void C6502::PHA ( void )
 //  +----------------+-----------------------+---------+---------+----------+
 void C6502::JMP ( void )
 {
-   uint32_t addr = MAKE16(GETUNSIGNED8(data,0),GETUNSIGNED8(data,1));
+   uint32_t addr = MAKE16(GETUNSIGNED8(m_state->data,0),GETUNSIGNED8(m_state->data,1));
 
-   if ( amode == AM_ABSOLUTE )
+   if ( m_state->amode == AM_ABSOLUTE )
    {
       wPC ( addr );
    }
@@ -2051,10 +2397,10 @@ void C6502::JMP ( void )
       }
    }
 
-   if ( rPC() == m_pcGoto )
+   if ( rPC() == m_state->m_pcGoto )
    {
       CNES::STEPCPUBREAKPOINT();
-      m_pcGoto = 0xFFFFFFFF;
+      m_state->m_pcGoto = 0xFFFFFFFF;
    }
 
    return;
@@ -2076,12 +2422,12 @@ void C6502::BVC ( void )
 {
    uint32_t target;
 
-   target = rPC()+GETSIGNED8(data,0);
+   target = rPC()+GETSIGNED8(m_state->data,0);
 
    if ( !rV() )
    {
       // Synchronize CPU and APU...
-      MEM ( (rPC()&0xFF00)|(((rPC()&0x00FF)+GETUNSIGNED8(data,0))&0xFF) );
+      MEM ( (rPC()&0xFF00)|(((rPC()&0x00FF)+GETUNSIGNED8(m_state->data,0))&0xFF) );
 
       // Extra cycle.
       if ( (rPC()&0xFF00) != (target&0xFF00) )
@@ -2092,10 +2438,10 @@ void C6502::BVC ( void )
 
       wPC ( target );
 
-      if ( rPC() == m_pcGoto )
+      if ( rPC() == m_state->m_pcGoto )
       {
          CNES::STEPCPUBREAKPOINT();
-         m_pcGoto = 0xFFFFFFFF;
+         m_state->m_pcGoto = 0xFFFFFFFF;
       }
    }
 
@@ -2144,10 +2490,10 @@ void C6502::RTS ( void )
    FETCH ();
    wPC ( (MAKE16(pclo,pchi))+1 );
 
-   if ( rPC() == m_pcGoto )
+   if ( rPC() == m_state->m_pcGoto )
    {
       CNES::STEPCPUBREAKPOINT();
-      m_pcGoto = 0xFFFFFFFF;
+      m_state->m_pcGoto = 0xFFFFFFFF;
    }
 
    return;
@@ -2177,13 +2523,13 @@ void C6502::ADC ( void )
    int16_t result;
    uint8_t val;
 
-   if ( amode == AM_IMMEDIATE )
+   if ( m_state->amode == AM_IMMEDIATE )
    {
-      val = (*data);
+      val = (*m_state->data);
    }
    else
    {
-      addr = MAKEADDR ( amode, data );
+      addr = MAKEADDR ( m_state->amode, m_state->data );
       val = MEM ( addr );
    }
 
@@ -2223,13 +2569,13 @@ void C6502::ROR ( void )
    uint32_t addr = 0x0000;
    uint16_t val;
 
-   if ( amode == AM_ACCUMULATOR )
+   if ( m_state->amode == AM_ACCUMULATOR )
    {
       val = rA ();
    }
    else
    {
-      addr = MAKEADDR ( amode, data );
+      addr = MAKEADDR ( m_state->amode, m_state->data );
       val = MEM ( addr );
 
       // dummy write
@@ -2243,7 +2589,7 @@ void C6502::ROR ( void )
    wN ( val&0x80 );
    wZ ( !val );
 
-   if ( amode == AM_ACCUMULATOR )
+   if ( m_state->amode == AM_ACCUMULATOR )
    {
       wA ( (uint8_t)val );
    }
@@ -2274,7 +2620,7 @@ void C6502::RLA ( void )
    uint32_t addr;
    uint16_t val;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
    val = MEM ( addr );
 
    val <<= 1;
@@ -2315,7 +2661,7 @@ void C6502::RRA ( void )
    uint16_t val;
    int16_t result;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
    val = MEM ( addr );
 
    val |= ( rC()*0x100 );
@@ -2377,12 +2723,12 @@ void C6502::BVS ( void )
 {
    uint32_t target;
 
-   target = rPC()+GETSIGNED8(data,0);
+   target = rPC()+GETSIGNED8(m_state->data,0);
 
    if ( rV() )
    {
       // Synchronize CPU and APU...
-      MEM ( (rPC()&0xFF00)|(((rPC()&0x00FF)+GETUNSIGNED8(data,0))&0xFF) );
+      MEM ( (rPC()&0xFF00)|(((rPC()&0x00FF)+GETUNSIGNED8(m_state->data,0))&0xFF) );
 
       // Extra cycle.
       if ( (rPC()&0xFF00) != (target&0xFF00) )
@@ -2393,10 +2739,10 @@ void C6502::BVS ( void )
 
       wPC ( target );
 
-      if ( rPC() == m_pcGoto )
+      if ( rPC() == m_state->m_pcGoto )
       {
          CNES::STEPCPUBREAKPOINT();
-         m_pcGoto = 0xFFFFFFFF;
+         m_state->m_pcGoto = 0xFFFFFFFF;
       }
    }
 
@@ -2439,7 +2785,7 @@ void C6502::STA ( void )
 {
    uint16_t addr;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
    MEM ( addr, rA() );
 
    return;
@@ -2461,7 +2807,7 @@ void C6502::STY ( void )
 {
    uint16_t addr;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
    MEM ( addr, rY() );
 
    return;
@@ -2483,7 +2829,7 @@ void C6502::STX ( void )
 {
    uint16_t addr;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
    MEM ( addr, rX() );
 
    return;
@@ -2541,12 +2887,12 @@ void C6502::BCC ( void )
 {
    uint32_t target;
 
-   target = rPC()+GETSIGNED8(data,0);
+   target = rPC()+GETSIGNED8(m_state->data,0);
 
    if ( !rC() )
    {
       // Synchronize CPU and APU...
-      MEM ( (rPC()&0xFF00)|(((rPC()&0x00FF)+GETUNSIGNED8(data,0))&0xFF) );
+      MEM ( (rPC()&0xFF00)|(((rPC()&0x00FF)+GETUNSIGNED8(m_state->data,0))&0xFF) );
 
       // Extra cycle.
       if ( (rPC()&0xFF00) != (target&0xFF00) )
@@ -2557,10 +2903,10 @@ void C6502::BCC ( void )
 
       wPC ( target );
 
-      if ( rPC() == m_pcGoto )
+      if ( rPC() == m_state->m_pcGoto )
       {
          CNES::STEPCPUBREAKPOINT();
-         m_pcGoto = 0xFFFFFFFF;
+         m_state->m_pcGoto = 0xFFFFFFFF;
       }
    }
 
@@ -2620,13 +2966,13 @@ void C6502::LDY ( void )
 {
    uint32_t addr;
 
-   if ( amode == AM_IMMEDIATE )
+   if ( m_state->amode == AM_IMMEDIATE )
    {
-      wY ( (*data) );
+      wY ( (*m_state->data) );
    }
    else
    {
-      addr = MAKEADDR ( amode, data );
+      addr = MAKEADDR ( m_state->amode, m_state->data );
       wY ( MEM(addr) );
    }
 
@@ -2656,14 +3002,14 @@ void C6502::LAX ( void )
 
    uint32_t addr;
 
-   if ( amode == AM_IMMEDIATE )
+   if ( m_state->amode == AM_IMMEDIATE )
    {
-      wA ( (*data) );
-      wX ( (*data) );
+      wA ( (*m_state->data) );
+      wX ( (*m_state->data) );
    }
    else
    {
-      addr = MAKEADDR ( amode, data );
+      addr = MAKEADDR ( m_state->amode, m_state->data );
       val = MEM ( addr ); // Single memory access cycle...
       wA ( val );
       wX ( val );
@@ -2697,13 +3043,13 @@ void C6502::LDA ( void )
 {
    uint32_t addr;
 
-   if ( amode == AM_IMMEDIATE )
+   if ( m_state->amode == AM_IMMEDIATE )
    {
-      wA ( (*data) );
+      wA ( (*m_state->data) );
    }
    else
    {
-      addr = MAKEADDR ( amode, data );
+      addr = MAKEADDR ( m_state->amode, m_state->data );
       wA ( MEM(addr) );
    }
 
@@ -2732,13 +3078,13 @@ void C6502::LDX ( void )
 {
    uint32_t addr;
 
-   if ( amode == AM_IMMEDIATE )
+   if ( m_state->amode == AM_IMMEDIATE )
    {
-      wX ( (*data) );
+      wX ( (*m_state->data) );
    }
    else
    {
-      addr = MAKEADDR ( amode, data );
+      addr = MAKEADDR ( m_state->amode, m_state->data );
       wX ( MEM(addr) );
    }
 
@@ -2802,12 +3148,12 @@ void C6502::BCS ( void )
 {
    uint32_t target;
 
-   target = rPC()+GETSIGNED8(data,0);
+   target = rPC()+GETSIGNED8(m_state->data,0);
 
    if ( rC() )
    {
       // Synchronize CPU and APU...
-      MEM ( (rPC()&0xFF00)|(((rPC()&0x00FF)+GETUNSIGNED8(data,0))&0xFF) );
+      MEM ( (rPC()&0xFF00)|(((rPC()&0x00FF)+GETUNSIGNED8(m_state->data,0))&0xFF) );
 
       // Extra cycle.
       if ( (rPC()&0xFF00) != (target&0xFF00) )
@@ -2818,10 +3164,10 @@ void C6502::BCS ( void )
 
       wPC ( target );
 
-      if ( rPC() == m_pcGoto )
+      if ( rPC() == m_state->m_pcGoto )
       {
          CNES::STEPCPUBREAKPOINT();
-         m_pcGoto = 0xFFFFFFFF;
+         m_state->m_pcGoto = 0xFFFFFFFF;
       }
    }
 
@@ -2880,13 +3226,13 @@ void C6502::CPY ( void )
    uint16_t addr;
    uint8_t  val;
 
-   if ( amode == AM_IMMEDIATE )
+   if ( m_state->amode == AM_IMMEDIATE )
    {
-      val = (*data)&0xFF;
+      val = (*m_state->data)&0xFF;
    }
    else
    {
-      addr = MAKEADDR ( amode, data );
+      addr = MAKEADDR ( m_state->amode, m_state->data );
       val = MEM ( addr );
    }
 
@@ -2922,13 +3268,13 @@ void C6502::CMP ( void )
    uint32_t addr;
    uint8_t val;
 
-   if ( amode == AM_IMMEDIATE )
+   if ( m_state->amode == AM_IMMEDIATE )
    {
-      val = (*data)&0xFF;
+      val = (*m_state->data)&0xFF;
    }
    else
    {
-      addr = MAKEADDR ( amode, data );
+      addr = MAKEADDR ( m_state->amode, m_state->data );
       val = MEM ( addr );
    }
 
@@ -2960,7 +3306,7 @@ void C6502::DCM ( void )
    uint16_t addr;
    uint8_t  val;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
    val = MEM ( addr );
    val -= 1;
    MEM ( addr, val );
@@ -2995,7 +3341,7 @@ void C6502::DEC ( void )
    uint16_t addr;
    uint8_t  val;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
    val = MEM ( addr );
 
    // dummy write
@@ -3063,12 +3409,12 @@ void C6502::BNE ( void )
 {
    uint32_t target;
 
-   target = rPC()+GETSIGNED8(data,0);
+   target = rPC()+GETSIGNED8(m_state->data,0);
 
    if ( !rZ() )
    {
       // Synchronize CPU and APU...
-      MEM ( (rPC()&0xFF00)|(((rPC()&0x00FF)+GETUNSIGNED8(data,0))&0xFF) );
+      MEM ( (rPC()&0xFF00)|(((rPC()&0x00FF)+GETUNSIGNED8(m_state->data,0))&0xFF) );
 
       // Extra cycle.
       if ( (rPC()&0xFF00) != (target&0xFF00) )
@@ -3079,10 +3425,10 @@ void C6502::BNE ( void )
 
       wPC ( target );
 
-      if ( rPC() == m_pcGoto )
+      if ( rPC() == m_state->m_pcGoto )
       {
          CNES::STEPCPUBREAKPOINT();
-         m_pcGoto = 0xFFFFFFFF;
+         m_state->m_pcGoto = 0xFFFFFFFF;
       }
    }
 
@@ -3122,13 +3468,13 @@ void C6502::CPX ( void )
    uint16_t addr;
    uint8_t  val;
 
-   if ( amode == AM_IMMEDIATE )
+   if ( m_state->amode == AM_IMMEDIATE )
    {
-      val = (*data)&0xFF;
+      val = (*m_state->data)&0xFF;
    }
    else
    {
-      addr = MAKEADDR ( amode, data );
+      addr = MAKEADDR ( m_state->amode, m_state->data );
       val = MEM ( addr );
    }
 
@@ -3165,13 +3511,13 @@ void C6502::SBC ( void )
    int16_t result;
    uint8_t val;
 
-   if ( amode == AM_IMMEDIATE )
+   if ( m_state->amode == AM_IMMEDIATE )
    {
-      val = (*data);
+      val = (*m_state->data);
    }
    else
    {
-      addr = MAKEADDR ( amode, data );
+      addr = MAKEADDR ( m_state->amode, m_state->data );
       val = MEM ( addr );
    }
 
@@ -3203,7 +3549,7 @@ void C6502::INC ( void )
    uint16_t addr;
    uint8_t  val;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
    val = MEM ( addr );
 
    // dummy write
@@ -3237,7 +3583,7 @@ void C6502::INS ( void )
    uint8_t  val;
    int16_t result;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
    val = MEM ( addr );
    val++;
    MEM ( addr, val );
@@ -3293,9 +3639,9 @@ void C6502::DOP ( void )
 {
    uint16_t addr;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
 
-   if ( amode != AM_IMMEDIATE )
+   if ( m_state->amode != AM_IMMEDIATE )
    {
       // A missing memory cycle here?
       // Synchronize CPU and APU...
@@ -3309,7 +3655,7 @@ void C6502::TOP ( void )
 {
    uint16_t addr;
 
-   addr = MAKEADDR ( amode, data );
+   addr = MAKEADDR ( m_state->amode, m_state->data );
 
    // A missing memory cycle here?
    // Synchronize CPU and APU...
@@ -3333,12 +3679,12 @@ void C6502::BEQ ( void )
 {
    uint32_t target;
 
-   target = rPC()+GETSIGNED8(data,0);
+   target = rPC()+GETSIGNED8(m_state->data,0);
 
    if ( rZ() )
    {
       // Synchronize CPU and APU...
-      MEM ( (rPC()&0xFF00)|(((rPC()&0x00FF)+GETUNSIGNED8(data,0))&0xFF) );
+      MEM ( (rPC()&0xFF00)|(((rPC()&0x00FF)+GETUNSIGNED8(m_state->data,0))&0xFF) );
 
       // Extra cycle.
       if ( (rPC()&0xFF00) != (target&0xFF00) )
@@ -3349,10 +3695,10 @@ void C6502::BEQ ( void )
 
       wPC ( target );
 
-      if ( rPC() == m_pcGoto )
+      if ( rPC() == m_state->m_pcGoto )
       {
          CNES::STEPCPUBREAKPOINT();
-         m_pcGoto = 0xFFFFFFFF;
+         m_state->m_pcGoto = 0xFFFFFFFF;
       }
    }
 
@@ -3389,49 +3735,47 @@ void C6502::SED ( void )
 void C6502::BRK ( void )
 {
    uint8_t         pchi;
-   static uint8_t  pclo = 0x00;
-   static bool     doingIrq = false;
 
-   if ( !m_killed )
+   if ( !m_state->m_killed )
    {
-      if ( m_instrCycle == 2 )
+      if ( m_state->m_instrCycle == 2 )
       {
          PUSH ( GETHI8(rPC()) );
       }
-      else if ( m_instrCycle == 3 )
+      else if ( m_state->m_instrCycle == 3 )
       {
          PUSH ( GETLO8((rPC())) );
       }
-      else if ( m_instrCycle == 4 )
+      else if ( m_state->m_instrCycle == 4 )
       {
          PUSH ( rF() );
-         if ( m_nmiPending )
+         if ( m_state->m_nmiPending )
          {
-            doingIrq = false;
+            m_state->m_brkDoingIrq = false;
          }
          else
          {
-            doingIrq = true;
+            m_state->m_brkDoingIrq = true;
          }
       }
       else
       {
-         if ( m_nmiPending && !doingIrq )
+         if ( m_state->m_nmiPending && !m_state->m_brkDoingIrq )
          {
-            if ( m_instrCycle == 5 )
+            if ( m_state->m_instrCycle == 5 )
             {
-               pclo = MEM(VECTOR_NMI);
+               m_state->m_brkPclo = MEM(VECTOR_NMI);
             }
-            else if ( m_instrCycle == 6 )
+            else if ( m_state->m_instrCycle == 6 )
             {
                pchi = MEM(VECTOR_NMI+1);
 
-               wPC ( MAKE16(pclo,pchi) );
+               wPC ( MAKE16(m_state->m_brkPclo,pchi) );
 
-               if ( rPC() == m_pcGoto )
+               if ( rPC() == m_state->m_pcGoto )
                {
                   CNES::STEPCPUBREAKPOINT();
-                  m_pcGoto = 0xFFFFFFFF;
+                  m_state->m_pcGoto = 0xFFFFFFFF;
                }
 
                if ( nesIsDebuggable() )
@@ -3441,26 +3785,26 @@ void C6502::BRK ( void )
                }
 
                sI();
-               m_nmiPending = false;
-               doingIrq = false;
+               m_state->m_nmiPending = false;
+               m_state->m_brkDoingIrq = false;
             }
          }
          else
          {
-            if ( m_instrCycle == 5 )
+            if ( m_state->m_instrCycle == 5 )
             {
-               pclo = MEM(VECTOR_IRQ);
+               m_state->m_brkPclo = MEM(VECTOR_IRQ);
             }
-            else if ( m_instrCycle == 6 )
+            else if ( m_state->m_instrCycle == 6 )
             {
                pchi = MEM(VECTOR_IRQ+1);
 
-               wPC ( MAKE16(pclo,pchi) );
+               wPC ( MAKE16(m_state->m_brkPclo,pchi) );
 
-               if ( rPC() == m_pcGoto )
+               if ( rPC() == m_state->m_pcGoto )
                {
                   CNES::STEPCPUBREAKPOINT();
-                  m_pcGoto = 0xFFFFFFFF;
+                  m_state->m_pcGoto = 0xFFFFFFFF;
                }
 
                if ( nesIsDebuggable() )
@@ -3470,8 +3814,8 @@ void C6502::BRK ( void )
                }
 
                sI();
-               m_irqPending = false;
-               doingIrq = false;
+               m_state->m_irqPending = false;
+               m_state->m_brkDoingIrq = false;
             }
          }
       }
@@ -3482,13 +3826,13 @@ void C6502::BRK ( void )
 
 void C6502::ASSERTIRQ ( int8_t source )
 {
-   m_irqAsserted = true;
+   m_state->m_irqAsserted = true;
 
    if ( nesIsDebuggable() )
    {
       if ( source == eNESSource_Mapper )
       {
-         CNES::TRACER()->AddIRQ ( m_cycles, source );
+         CNES::TRACER()->AddIRQ ( m_state->m_cycles, source );
       }
       else
       {
@@ -3506,19 +3850,19 @@ void C6502::RELEASEIRQ ( int8_t source )
    {
       if ( source == eNESSource_Mapper )
       {
-         CNES::TRACER()->AddIRQRelease ( m_cycles, source );
+         CNES::TRACER()->AddIRQRelease ( m_state->m_cycles, source );
       }
       else
       {
          CNES::TRACER()->AddIRQRelease ( CAPU::CYCLES(), source );
       }
    }
-   m_irqAsserted = false;
+   m_state->m_irqAsserted = false;
 }
 
 void C6502::ASSERTNMI ()
 {
-   m_nmiAsserted = true;
+   m_state->m_nmiAsserted = true;
 
    if ( nesIsDebuggable() )
    {
@@ -3531,7 +3875,7 @@ void C6502::ASSERTNMI ()
 
 void C6502::RESET ( bool soft )
 {
-   m_killed = false;
+   m_state->m_killed = false;
 
    CAPU::RESET ();
 
@@ -3540,28 +3884,30 @@ void C6502::RESET ( bool soft )
       CNES::TRACER()->AddRESET ();
    }
 
-   m_cycles = 0;
-   m_curCycles = 0;
-   m_phase = 0;
+   m_state->m_cycles = 0;
+   m_state->m_curCycles = 0;
+   m_state->m_phase = 0;
 
-   m_dmaRequest = -1;
-   m_writeDmaCounter = 0;
-   m_readDmaCounter = 0;
+   m_state->m_dmaRequest = -1;
+   m_state->m_writeDmaCounter = 0;
+   m_state->m_readDmaCounter = 0;
 
-   m_write = false;
+   m_state->m_write = false;
 
    // Clear the disassembly sample...
-   pDisassemblySample = NULL;
+   m_state->disassemblySample = TRACER_NO_SAMPLE;
 
-   m_irqAsserted = false;
-   m_irqPending = false;
-   m_instrCycle = 0;
-   m_nmiAsserted = false;
-   m_nmiPending = false;
+   m_state->m_idleHead = IDLE_NO_LOOP;
+
+   m_state->m_irqAsserted = false;
+   m_state->m_irqPending = false;
+   m_state->m_instrCycle = 0;
+   m_state->m_nmiAsserted = false;
+   m_state->m_nmiPending = false;
 
    wEA ( 0 );
 
-   m_pcGoto = 0xFFFFFFFF;
+   m_state->m_pcGoto = 0xFFFFFFFF;
 
    // Fake cycle -- stuff is being cleared
    MEM(0xFF);
@@ -3586,8 +3932,8 @@ void C6502::RESET ( bool soft )
    wSP ( 0xFD );
    wPC ( MAKE16(MEM(VECTOR_RESET),MEM(VECTOR_RESET+1)) );
 
-   m_pcSync = rPC();
-   m_pcSyncSet = true;
+   m_state->m_pcSync = rPC();
+   m_state->m_pcSyncSet = true;
 
    // Clear memory...
    if ( !soft )
@@ -3604,18 +3950,29 @@ void C6502::RESET ( bool soft )
 
 uint8_t C6502::LOAD ( uint32_t addr, int8_t* pTarget )
 {
-   uint8_t data = C6502::OPENBUS();
+   const uint8_t* page = m_state->m_pReadPage[addr>>UPSHIFT_1KB];
+   uint8_t data;
+
+   // RAM, and PRG-ROM and SRAM the mapper doesn't need to see, are
+   // read straight from the page table.
+   if ( page )
+   {
+      (*pTarget) = (addr >= 0x8000) ? eTarget_Mapper : (addr >= 0x6000) ? eTarget_SRAM : eTarget_RAM;
+      return page[addr&MASK_1KB];
+   }
+
+   data = C6502::OPENBUS();
 
    if ( addr >= 0x8000 )
    {
       (*pTarget) = eTarget_Mapper;
-      data = MAPPERFUNC->highread(addr);
+      data = CNES::MAPPERFUNC()->highread(addr);
    }
    else if ( addr < 0x2000 )
    {
       (*pTarget) = eTarget_RAM;
       addr &= 0x7FF; // RAM mirrored...
-      data = m_6502memory[addr];
+      data = m_state->m_6502memory[addr];
    }
    else if ( addr < 0x4000 )
    {
@@ -3625,17 +3982,20 @@ uint8_t C6502::LOAD ( uint32_t addr, int8_t* pTarget )
    else if ( addr >= 0x6000 )
    {
       (*pTarget) = eTarget_SRAM;
-      data = MAPPERFUNC->lowread ( addr );
+      CNES::MAPPERSYNC ();
+      data = CNES::MAPPERFUNC()->lowread ( addr );
    }
    else if ( addr >= 0x5C00 )
    {
       (*pTarget) = eTarget_EXRAM;
-      data = MAPPERFUNC->lowread ( addr );
+      CNES::MAPPERSYNC ();
+      data = CNES::MAPPERFUNC()->lowread ( addr );
    }
    else if ( addr >= 0x4018 )
    {
       (*pTarget) = eTarget_Mapper;
-      data = MAPPERFUNC->lowread ( addr );
+      CNES::MAPPERSYNC ();
+      data = CNES::MAPPERFUNC()->lowread ( addr );
    }
    else
    {
@@ -3669,11 +4029,19 @@ uint8_t C6502::LOAD ( uint32_t addr, int8_t* pTarget )
 
 void C6502::STORE ( uint32_t addr, uint8_t data, int8_t* pTarget )
 {
-   if ( addr < 0x2000 )
+   uint8_t* page = m_state->m_pWritePage[addr>>UPSHIFT_1KB];
+
+   // Only RAM is ever writable through the page table.
+   if ( page )
+   {
+      (*pTarget) = eTarget_RAM;
+      page[addr&MASK_1KB] = data;
+   }
+   else if ( addr < 0x2000 )
    {
       (*pTarget) = eTarget_RAM;
       addr &= 0x7FF; // RAM mirrored...
-      m_6502memory[addr] = data&0xFF;
+      m_state->m_6502memory[addr] = data&0xFF;
    }
    else if ( addr < 0x4000 )
    {
@@ -3697,11 +4065,11 @@ void C6502::STORE ( uint32_t addr, uint8_t data, int8_t* pTarget )
 
          // DMA
          // Note: DMA is done in C6502::EMULATE, it is only set-up here.
-         m_writeDmaAddr = data<<8;
-         m_writeDmaCounter = 513;
+         m_state->m_writeDmaAddr = data<<8;
+         m_state->m_writeDmaCounter = 513;
          if ( _CYCLES()&1 )
          {
-            m_writeDmaCounter++;
+            m_state->m_writeDmaCounter++;
          }
       }
       // Otherwise if not accessing a controller port, use default...
@@ -3714,37 +4082,42 @@ void C6502::STORE ( uint32_t addr, uint8_t data, int8_t* pTarget )
    else if ( addr < 0x5C00 )
    {
       (*pTarget) = eTarget_Mapper;
-      MAPPERFUNC->lowwrite ( addr, data );
+      CNES::MAPPERSYNC ();
+      CNES::MAPPERFUNC()->lowwrite ( addr, data );
    }
    else if ( addr < 0x6000 )
    {
       (*pTarget) = eTarget_EXRAM;
-      MAPPERFUNC->lowwrite ( addr, data );
+      CNES::MAPPERSYNC ();
+      CNES::MAPPERFUNC()->lowwrite ( addr, data );
    }
    else if ( addr < 0x8000 )
    {
       (*pTarget) = eTarget_SRAM;
-      MAPPERFUNC->lowwrite ( addr, data );
+      CNES::MAPPERSYNC ();
+      CNES::MAPPERFUNC()->lowwrite ( addr, data );
    }
    else
    {
       (*pTarget) = eTarget_Mapper;
-      MAPPERFUNC->highwrite ( addr, data );
+      CNES::MAPPERSYNC ();
+      CNES::MAPPERFUNC()->highwrite ( addr, data );
    }
 }
 
+template<bool Debuggable>
 uint8_t C6502::FETCH ()
 {
    int8_t target;
    uint8_t data;
-   uint8_t instrCycle = m_instrCycle;
+   uint8_t instrCycle = m_state->m_instrCycle;
 
    // Not writing...
-   m_write = false;
+   m_state->m_write = false;
 
    // Set effective address.
    wEA ( rPC() );
-   if ( nesIsDebuggable() )
+   if ( Debuggable )
    {
       CNES::TRACER()->SetEffectiveAddress ( CNES::TRACER()->GetLastCPUSample(), rEA() );
    }
@@ -3755,18 +4128,18 @@ uint8_t C6502::FETCH ()
    data = LOAD ( rPC(), &target );
 
    // Store data to return as open-bus.
-   m_openBusData = data;
+   m_state->m_openBusData = data;
 
-   if ( nesIsDebuggable() )
+   if ( Debuggable )
    {
       // Add Tracer sample...
       if ( instrCycle == 0 )
       {
-         CNES::TRACER()->AddSample ( m_cycles, eTracer_InstructionFetch, eNESSource_CPU, target, rPC(), data );
+         CNES::TRACER()->AddSample ( m_state->m_cycles, eTracer_InstructionFetch, eNESSource_CPU, target, rPC(), data );
       }
       else
       {
-         CNES::TRACER()->AddSample ( m_cycles, eTracer_OperandFetch, eNESSource_CPU, target, rPC(), data );
+         CNES::TRACER()->AddSample ( m_state->m_cycles, eTracer_OperandFetch, eNESSource_CPU, target, rPC(), data );
       }
 
       // If ROM is being accessed, log code/data logger...
@@ -3777,15 +4150,15 @@ uint8_t C6502::FETCH ()
          CCodeDataLogger* pLogger = CROM::LOGGERVIRT ( rPC() );
          if ( instrCycle == 0 )
          {
-            pLogger->LogAccess ( m_cycles, rPC(), data, eLogger_InstructionFetch, eNESSource_CPU );
+            pLogger->LogAccess ( m_state->m_cycles, rPC(), data, eLogger_InstructionFetch, eNESSource_CPU );
          }
          else
          {
-            pLogger->LogAccess ( m_cycles, rPC(), data, eLogger_OperandFetch, eNESSource_CPU );
+            pLogger->LogAccess ( m_state->m_cycles, rPC(), data, eLogger_OperandFetch, eNESSource_CPU );
          }
 
          // Update Markers...
-         m_marker->UpdateMarkers ( CROM::PRGROMABSADDR(rPC()), C6502::_CYCLES(), CPPU::_FRAME(), CPPU::_CYCLES() );
+         m_state->m_marker->UpdateMarkers ( CROM::PRGROMABSADDR(rPC()), C6502::_CYCLES(), CPPU::_FRAME(), CPPU::_CYCLES() );
 
          // ... and update opcode masking for disassembler...
          CROM::PRGROMOPCODEMASK ( rPC(), (uint8_t)(instrCycle==0) );
@@ -3796,11 +4169,11 @@ uint8_t C6502::FETCH ()
          CCodeDataLogger* pLogger = CROM::SRAMLOGGERVIRT ( rPC() );
          if ( instrCycle == 0 )
          {
-            pLogger->LogAccess ( m_cycles, rPC(), data, eLogger_InstructionFetch, eNESSource_CPU );
+            pLogger->LogAccess ( m_state->m_cycles, rPC(), data, eLogger_InstructionFetch, eNESSource_CPU );
          }
          else
          {
-            pLogger->LogAccess ( m_cycles, rPC(), data, eLogger_OperandFetch, eNESSource_CPU );
+            pLogger->LogAccess ( m_state->m_cycles, rPC(), data, eLogger_OperandFetch, eNESSource_CPU );
          }
 
          // Update opcode masking for disassembler...
@@ -3812,11 +4185,11 @@ uint8_t C6502::FETCH ()
          CCodeDataLogger* pLogger = CROM::EXRAMLOGGER ();
          if ( instrCycle == 0 )
          {
-            pLogger->LogAccess ( m_cycles, rPC(), data, eLogger_InstructionFetch, eNESSource_CPU );
+            pLogger->LogAccess ( m_state->m_cycles, rPC(), data, eLogger_InstructionFetch, eNESSource_CPU );
          }
          else
          {
-            pLogger->LogAccess ( m_cycles, rPC(), data, eLogger_OperandFetch, eNESSource_CPU );
+            pLogger->LogAccess ( m_state->m_cycles, rPC(), data, eLogger_OperandFetch, eNESSource_CPU );
          }
 
          // Update opcode masking for disassembler...
@@ -3826,11 +4199,11 @@ uint8_t C6502::FETCH ()
       {
          if ( instrCycle == 0 )
          {
-            m_logger->LogAccess ( m_cycles, rPC(), data, eLogger_InstructionFetch, eNESSource_CPU );
+            m_state->m_logger->LogAccess ( m_state->m_cycles, rPC(), data, eLogger_InstructionFetch, eNESSource_CPU );
          }
          else
          {
-            m_logger->LogAccess ( m_cycles, rPC(), data, eLogger_OperandFetch, eNESSource_CPU );
+            m_state->m_logger->LogAccess ( m_state->m_cycles, rPC(), data, eLogger_OperandFetch, eNESSource_CPU );
          }
 
          // ... and update opcode masking for disassembler...
@@ -3841,17 +4214,18 @@ uint8_t C6502::FETCH ()
    return data;
 }
 
+template<bool Debuggable>
 uint8_t C6502::EXTRAFETCH ()
 {
    int8_t target;
    uint8_t data;
 
    // Not writing...
-   m_write = false;
+   m_state->m_write = false;
 
    // Set effective address.
    wEA ( rPC() );
-   if ( nesIsDebuggable() )
+   if ( Debuggable )
    {
       CNES::TRACER()->SetEffectiveAddress ( CNES::TRACER()->GetLastCPUSample(), rEA() );
    }
@@ -3861,33 +4235,33 @@ uint8_t C6502::EXTRAFETCH ()
 
    data = LOAD ( rPC(), &target );
 
-   if ( nesIsDebuggable() )
+   if ( Debuggable )
    {
       // Add Tracer sample...
-      CNES::TRACER()->AddSample ( m_cycles, eTracer_OperandFetch, eNESSource_CPU, target, rPC(), data );
+      CNES::TRACER()->AddSample ( m_state->m_cycles, eTracer_OperandFetch, eNESSource_CPU, target, rPC(), data );
 
 #if 0
       // If ROM is being accessed, log code/data logger...
       if ( target == eTarget_Mapper )
       {
          CCodeDataLogger* pLogger = CROM::LOGGERVIRT ( rPC() );
-         pLogger->LogAccess ( m_cycles, rPC(), data, eLogger_OperandFetch, eNESSource_CPU );
+         pLogger->LogAccess ( m_state->m_cycles, rPC(), data, eLogger_OperandFetch, eNESSource_CPU );
       }
       else if ( target == eTarget_SRAM )
       {
          // Log to Code/Data Logger...
          CCodeDataLogger* pLogger = CROM::SRAMLOGGERVIRT ( rPC() );
-         pLogger->LogAccess ( m_cycles, rPC(), data, eLogger_OperandFetch, eNESSource_CPU );
+         pLogger->LogAccess ( m_state->m_cycles, rPC(), data, eLogger_OperandFetch, eNESSource_CPU );
       }
       else if ( target == eTarget_EXRAM )
       {
          // Log to Code/Data Logger...
          CCodeDataLogger* pLogger = CROM::EXRAMLOGGER ();
-         pLogger->LogAccess ( m_cycles, rPC(), data, eLogger_OperandFetch, eNESSource_CPU );
+         pLogger->LogAccess ( m_state->m_cycles, rPC(), data, eLogger_OperandFetch, eNESSource_CPU );
       }
       else if ( target == eTarget_RAM )
       {
-         m_logger->LogAccess ( m_cycles, rPC(), data, eLogger_OperandFetch, eNESSource_CPU );
+         m_state->m_logger->LogAccess ( m_state->m_cycles, rPC(), data, eLogger_OperandFetch, eNESSource_CPU );
       }
 #endif
    }
@@ -3901,7 +4275,7 @@ uint8_t C6502::DMA ( uint32_t addr )
    uint8_t data;
 
    // Not writing...
-   m_write = false;
+   m_state->m_write = false;
 
    // Synchronize CPU and APU...
    ADVANCE ( true );
@@ -3911,18 +4285,18 @@ uint8_t C6502::DMA ( uint32_t addr )
    if ( nesIsDebuggable() )
    {
       // Add Tracer sample...
-      CNES::TRACER()->AddSample ( m_cycles, eTracer_DMA, eNESSource_CPU, target, addr, data );
+      CNES::TRACER()->AddSample ( m_state->m_cycles, eTracer_DMA, eNESSource_CPU, target, addr, data );
 
       // If ROM or RAM is being accessed, log code/data logger...
       if ( (target == eTarget_Mapper) &&
            (addr >= MEM_32KB) )
       {
          CCodeDataLogger* pLogger = CROM::LOGGERVIRT ( addr );
-         pLogger->LogAccess ( m_cycles, addr, data, eLogger_DMA, eNESSource_APU );
+         pLogger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DMA, eNESSource_APU );
       }
       else if ( target == eTarget_RAM )
       {
-         m_logger->LogAccess ( m_cycles, addr, data, eLogger_DMA, eNESSource_APU );
+         m_state->m_logger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DMA, eNESSource_APU );
       }
 
       // Check for breakpoint...
@@ -3934,11 +4308,11 @@ uint8_t C6502::DMA ( uint32_t addr )
 
 void C6502::DMA ( uint32_t srcAddr, uint32_t dstAddr, uint8_t data )
 {
-   TracerInfo* pSample = NULL;
+   uint32_t sample = TRACER_NO_SAMPLE;
    int8_t target;
 
    // Writing...
-   m_write = true;
+   m_state->m_write = true;
 
    // Synchronize CPU and APU...
    ADVANCE ( true );
@@ -3946,7 +4320,7 @@ void C6502::DMA ( uint32_t srcAddr, uint32_t dstAddr, uint8_t data )
    if ( nesIsDebuggable() )
    {
       // Store unknown target because otherwise the trace will be out of order...
-      pSample = CNES::TRACER()->AddSample ( m_cycles, eTracer_DMA, eNESSource_CPU, target, dstAddr, data );
+      sample = CNES::TRACER()->AddSample ( m_state->m_cycles, eTracer_DMA, eNESSource_CPU, target, dstAddr, data );
    }
 
    STORE ( dstAddr, data, &target );
@@ -3957,19 +4331,16 @@ void C6502::DMA ( uint32_t srcAddr, uint32_t dstAddr, uint8_t data )
       if ( srcAddr >= MEM_32KB )
       {
          CCodeDataLogger* pLogger = CROM::LOGGERVIRT ( srcAddr );
-         pLogger->LogAccess ( m_cycles, srcAddr, data, eLogger_DMA, eNESSource_PPU );
+         pLogger->LogAccess ( m_state->m_cycles, srcAddr, data, eLogger_DMA, eNESSource_PPU );
       }
       else if ( srcAddr < MEM_8KB )
       {
-         m_logger->LogAccess ( m_cycles, srcAddr, data, eLogger_DMA, eNESSource_PPU );
+         m_state->m_logger->LogAccess ( m_state->m_cycles, srcAddr, data, eLogger_DMA, eNESSource_PPU );
       }
    }
 
    // Store real target...
-   if ( pSample )
-   {
-      pSample->target = target;
-   }
+   CNES::TRACER()->SetTarget ( sample, target );
 
    if ( nesIsDebuggable() )
    {
@@ -3984,7 +4355,7 @@ uint8_t C6502::MEM ( uint32_t addr )
    uint8_t data;
 
    // Not writing...
-   m_write = false;
+   m_state->m_write = false;
 
    // Set effective address.
    wEA ( addr );
@@ -4001,37 +4372,37 @@ uint8_t C6502::MEM ( uint32_t addr )
    if ( nesIsDebuggable() )
    {
       // Add Tracer sample...
-      CNES::TRACER()->AddSample ( m_cycles, eTracer_DataRead, eNESSource_CPU, target, addr, data );
+      CNES::TRACER()->AddSample ( m_state->m_cycles, eTracer_DataRead, eNESSource_CPU, target, addr, data );
 
       // If ROM or RAM is being accessed, log code/data logger...
       if ( (target == eTarget_Mapper) &&
            (addr >= MEM_32KB) )
       {
          CCodeDataLogger* pLogger = CROM::LOGGERVIRT ( addr );
-         pLogger->LogAccess ( m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
+         pLogger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
       }
       else if ( target == eTarget_SRAM )
       {
          // Log to Code/Data Logger...
          CCodeDataLogger* pLogger = CROM::SRAMLOGGERVIRT ( addr );
-         pLogger->LogAccess ( m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
+         pLogger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
       }
       else if ( target == eTarget_EXRAM )
       {
          // Log to Code/Data Logger...
          CCodeDataLogger* pLogger = CROM::EXRAMLOGGER ();
-         pLogger->LogAccess ( m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
+         pLogger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
       }
       else if ( target == eTarget_RAM )
       {
          // Log to Code/Data Logger...
-         m_logger->LogAccess ( m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
+         m_state->m_logger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
       }
       else
       {
          // Registers...
          // Log to Code/Data Logger...
-         m_logger->LogAccess ( m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
+         m_state->m_logger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
       }
 
       // Check for breakpoint...
@@ -4043,11 +4414,11 @@ uint8_t C6502::MEM ( uint32_t addr )
 
 void C6502::MEM ( uint32_t addr, uint8_t data )
 {
-   TracerInfo* pSample = NULL;
+   uint32_t sample = TRACER_NO_SAMPLE;
    int8_t target;
 
    // Writing...
-   m_write = true;
+   m_state->m_write = true;
 
    // Set effective address.
    wEA ( addr );
@@ -4062,7 +4433,7 @@ void C6502::MEM ( uint32_t addr, uint8_t data )
    if ( nesIsDebuggable() )
    {
       // Store unknown target because otherwise the trace will be out of order...
-      pSample = CNES::TRACER()->AddSample ( m_cycles, eTracer_DataWrite, eNESSource_CPU, 0, addr, data );
+      sample = CNES::TRACER()->AddSample ( m_state->m_cycles, eTracer_DataWrite, eNESSource_CPU, 0, addr, data );
    }
 
    STORE ( addr, data, &target );
@@ -4074,37 +4445,34 @@ void C6502::MEM ( uint32_t addr, uint8_t data )
            (addr >= MEM_32KB) )
       {
          CCodeDataLogger* pLogger = CROM::LOGGERVIRT ( addr );
-         pLogger->LogAccess ( m_cycles, addr, data, eLogger_DataWrite, eNESSource_CPU );
+         pLogger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DataWrite, eNESSource_CPU );
       }
       else if ( target == eTarget_SRAM )
       {
          // Log to Code/Data Logger...
          CCodeDataLogger* pLogger = CROM::SRAMLOGGERVIRT ( addr );
-         pLogger->LogAccess ( m_cycles, addr, data, eLogger_DataWrite, eNESSource_CPU );
+         pLogger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DataWrite, eNESSource_CPU );
       }
       else if ( target == eTarget_EXRAM )
       {
          // Log to Code/Data Logger...
          CCodeDataLogger* pLogger = CROM::EXRAMLOGGER ();
-         pLogger->LogAccess ( m_cycles, addr, data, eLogger_DataWrite, eNESSource_CPU );
+         pLogger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DataWrite, eNESSource_CPU );
       }
       else if ( target == eTarget_RAM )
       {
-         m_logger->LogAccess ( m_cycles, addr, data, eLogger_DataWrite, eNESSource_CPU );
+         m_state->m_logger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DataWrite, eNESSource_CPU );
       }
       else
       {
          // Registers...
          // Log to Code/Data Logger...
-         m_logger->LogAccess ( m_cycles, addr, data, eLogger_DataWrite, eNESSource_CPU );
+         m_state->m_logger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DataWrite, eNESSource_CPU );
       }
    }
 
    // Store real target...
-   if ( pSample )
-   {
-      pSample->target = target;
-   }
+   CNES::TRACER()->SetTarget ( sample, target );
 
    if ( nesIsDebuggable() )
    {
@@ -4119,7 +4487,7 @@ uint8_t C6502::STEAL ( uint32_t addr, uint8_t source )
    uint8_t data;
 
    // Not writing...
-   m_write = false;
+   m_state->m_write = false;
 
    // Set effective address.
    wEA ( addr );
@@ -4136,37 +4504,37 @@ uint8_t C6502::STEAL ( uint32_t addr, uint8_t source )
    if ( nesIsDebuggable() )
    {
       // Add Tracer sample...
-      CNES::TRACER()->AddStolenCycle ( m_cycles, source );
+      CNES::TRACER()->AddStolenCycle ( m_state->m_cycles, source );
 
       // If ROM or RAM is being accessed, log code/data logger...
       if ( (target == eTarget_Mapper) &&
            (addr >= MEM_32KB) )
       {
          CCodeDataLogger* pLogger = CROM::LOGGERVIRT ( addr );
-         pLogger->LogAccess ( m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
+         pLogger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
       }
       else if ( target == eTarget_SRAM )
       {
          // Log to Code/Data Logger...
          CCodeDataLogger* pLogger = CROM::SRAMLOGGERVIRT ( addr );
-         pLogger->LogAccess ( m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
+         pLogger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
       }
       else if ( target == eTarget_EXRAM )
       {
          // Log to Code/Data Logger...
          CCodeDataLogger* pLogger = CROM::EXRAMLOGGER ();
-         pLogger->LogAccess ( m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
+         pLogger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
       }
       else if ( target == eTarget_RAM )
       {
          // Log to Code/Data Logger...
-         m_logger->LogAccess ( m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
+         m_state->m_logger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
       }
       else
       {
          // Registers...
          // Log to Code/Data Logger...
-         m_logger->LogAccess ( m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
+         m_state->m_logger->LogAccess ( m_state->m_cycles, addr, data, eLogger_DataRead, eNESSource_CPU );
       }
 
       // Check stolen cycles breakpoint.
@@ -4223,7 +4591,7 @@ uint32_t C6502::MAKEADDR ( int32_t amode, uint8_t* data )
       addr = addrpre+rX();
 
       // Check for ROL special case...
-      if ( ((*opcodeData) == ROL_ABS_X) || ((addrpre>>8) != (addr>>8)) || (pOpcodeStruct->forceExtraCycle) )
+      if ( ((*m_state->opcodeData) == ROL_ABS_X) || ((addrpre>>8) != (addr>>8)) || (m_state->pOpcodeStruct->forceExtraCycle) )
       {
          // dummy read
          MEM((addrpre&0xFF00)+((addrpre+rX())&0xFF));
@@ -4234,7 +4602,7 @@ uint32_t C6502::MAKEADDR ( int32_t amode, uint8_t* data )
       addrpre = MAKE16((*data),(*(data+1)));
       addr = addrpre+rY();
 
-      if ( ((addrpre>>8) != (addr>>8)) || (pOpcodeStruct->forceExtraCycle) )
+      if ( ((addrpre>>8) != (addr>>8)) || (m_state->pOpcodeStruct->forceExtraCycle) )
       {
          // dummy read
          MEM((addrpre&0xFF00)+((addrpre+rY())&0xFF));
@@ -4251,7 +4619,7 @@ uint32_t C6502::MAKEADDR ( int32_t amode, uint8_t* data )
       addrpre = MAKE16(MEM((*data)),MEM(((*data)+1)&0xFF));
       addr = addrpre+rY();
 
-      if ( ((addrpre>>8) != (addr>>8)) || (pOpcodeStruct->forceExtraCycle) )
+      if ( ((addrpre>>8) != (addr>>8)) || (m_state->pOpcodeStruct->forceExtraCycle) )
       {
          // dummy read
          MEM((addrpre&0xFF00)+((addrpre+rY())&0xFF));
@@ -4268,98 +4636,207 @@ void C6502::DISASSEMBLE ()
 {
    if ( __PCSYNC() < 0x800 )
    {
-      DISASSEMBLE ( m_RAMdisassembly,
-                    m_6502memory,
+      // RAM changes under the disassembly without its opcode mask
+      // changing, so it is always redone in full.
+      DISASSEMBLYDIRTY ( &(m_state->m_RAMdisassemblyState), 0, MEM_2KB-1 );
+      DISASSEMBLE ( m_state->m_RAMdisassembly,
+                    m_state->m_6502memory,
                     MEM_2KB,
-                    m_RAMopcodeMask,
-                    m_RAMsloc2addr,
-                    m_RAMaddr2sloc,
-                    &(m_RAMsloc) );
+                    m_state->m_RAMopcodeMask,
+                    m_state->m_RAMsloc2addr,
+                    m_state->m_RAMaddr2sloc,
+                    &(m_state->m_RAMsloc),
+                    &(m_state->m_RAMdisassemblyState) );
    }
 }
 
-void C6502::DISASSEMBLE ( char** disassembly, uint8_t* binary, int32_t binaryLength, uint8_t* opcodeMask, uint16_t* sloc2addr, uint16_t* addr2sloc, uint32_t* sourceLength )
+void C6502::DISASSEMBLE ( DisassemblyInfo* disassembly, uint8_t* binary, int32_t binaryLength, uint8_t* opcodeMask, uint16_t* sloc2addr, uint16_t* addr2sloc, uint32_t* sourceLength, DisassemblyState* pState )
 {
-   CNES6502_opcode* pOp;
-   int32_t opSize;
-   uint8_t op;
-   char* ptr;
-   uint8_t mask;
+   uint16_t rows [ MEM_8KB ];
+   int32_t  numRows = 0;
+   int32_t  oldRows;
+   int32_t  start;
+   int32_t  end;
+   int32_t  base;
+   int32_t  opSize;
+   int32_t  idx;
+   int32_t  i;
+   uint8_t  mask;
+   bool     full;
 
-   (*sourceLength) = 0;
+   if ( pState->dirtyFirst > pState->dirtyLast )
+   {
+      return;
+   }
 
-   for ( int32_t i = 0; i < binaryLength; )
+   full = ((*sourceLength) == 0) || ((pState->dirtyFirst == 0) && (pState->dirtyLast >= binaryLength-1));
+   if ( full )
    {
-      op = *(binary+i);
-      pOp = m_6502opcode+op;
-      opSize = *(opcode_size+pOp->amode);
+      // Nothing to keep, start from scratch.
+      start = 0;
+      base = 0;
+   }
+   else
+   {
+      // Instructions before the first changed offset decode as they did
+      // before, so start at the row it is part of.
+      base = addr2sloc[pState->dirtyFirst];
+      start = sloc2addr[base];
+   }
 
-      mask = *(opcodeMask+i);
+   // Disassemble from there until past the last changed offset, then on
+   // until an instruction starts where one started before.  From there on
+   // the old rows are still good.
+   for ( i = start; i < binaryLength; )
+   {
+      if ( (!full) && (i > pState->dirtyLast) && (sloc2addr[addr2sloc[i]] == i) )
+      {
+         break;
+      }
 
-      ptr = (*disassembly);
+      opSize = *(opcode_size+m_6502opcode[*(binary+i)].amode);
 
-      // save sloc
-      (*sloc2addr) = i;
-      sloc2addr++;
-      (*addr2sloc) = (*sourceLength);
-      addr2sloc++;
+      mask = *(opcodeMask+i);
+
+      rows[numRows] = i;
 
       // If we've discovered this address has been executed by the 6502 we'll
       // attempt to provide disassembly for it...
       if ( (mask) && ((i+opSize) < binaryLength) )
       {
-         sprintf_opcode ( ptr, pOp->name );
-
-         switch ( pOp->amode )
-         {
-               // Single byte operands
-            case AM_IMMEDIATE:
-            case AM_ZEROPAGE_INDEXED_X:
-            case AM_ZEROPAGE_INDEXED_Y:
-            case AM_ZEROPAGE:
-            case AM_PREINDEXED_INDIRECT:
-            case AM_POSTINDEXED_INDIRECT:
-            case AM_RELATIVE:
-               ptr += sprintf ( ptr, operandFmt[pOp->amode], binary[i+1] );
-               break;
-
-               // Two byte operands
-            case AM_ABSOLUTE:
-            case AM_ABSOLUTE_INDEXED_X:
-            case AM_ABSOLUTE_INDEXED_Y:
-            case AM_INDIRECT:
-               ptr += sprintf ( ptr, operandFmt[pOp->amode], binary[i+2], binary[i+1] );
-               break;
-         }
+         disassembly[i].bytes[0] = binary[i];
+         disassembly[i].bytes[1] = (opSize > 1) ? binary[i+1] : 0;
+         disassembly[i].bytes[2] = (opSize > 2) ? binary[i+2] : 0;
+         disassembly[i].size = opSize;
 
-         if ( opSize > 2 )
+         // Every byte of the instruction shows the instruction.
+         for ( idx = 0; idx < opSize; idx++ )
          {
-            strcpy((*(disassembly+2)), (*disassembly));
-            (*addr2sloc) = (*sourceLength);
-            addr2sloc++;
-         }
-
-         if ( opSize > 1 )
-         {
-            strcpy((*(disassembly+1)), (*disassembly));
-            (*addr2sloc) = (*sourceLength);
-            addr2sloc++;
+            disassembly[i+idx] = disassembly[i];
+            addr2sloc[i+idx] = base+numRows;
          }
 
          i += opSize;
-         disassembly += opSize;
       }
       else
       {
-         sprintf_db(ptr);
-         sprintf_02x(ptr,binary[i]);
+         disassembly[i].bytes[0] = binary[i];
+         disassembly[i].bytes[1] = 0;
+         disassembly[i].bytes[2] = 0;
+         disassembly[i].size = 0;
+         addr2sloc[i] = base+numRows;
 
          i++;
-         disassembly++;
       }
 
-      (*sourceLength)++;
+      numRows++;
+   }
+   end = i;
+
+   // Splice the new rows in place of the old ones and move the rest.
+   oldRows = ((end < binaryLength) ? addr2sloc[end] : (*sourceLength))-base;
+   if ( numRows != oldRows )
+   {
+      memmove ( sloc2addr+base+numRows, sloc2addr+base+oldRows, ((*sourceLength)-base-oldRows)*sizeof(uint16_t) );
+      for ( idx = end; idx < binaryLength; idx++ )
+      {
+         addr2sloc[idx] += numRows-oldRows;
+      }
+      (*sourceLength) += numRows-oldRows;
+   }
+   memcpy ( sloc2addr+base, rows, numRows*sizeof(uint16_t) );
+
+   DISASSEMBLYCHANGED ( pState, base, oldRows, numRows );
+
+   pState->dirtyFirst = 0x7FFFFFFF;
+   pState->dirtyLast = -1;
+}
+
+void C6502::DISASSEMBLYCHANGED ( DisassemblyState* pState, int32_t first, int32_t oldRows, int32_t newRows )
+{
+   int32_t end = pState->changedEnd;
+
+   if ( pState->changedFirst > pState->changedEnd )
+   {
+      pState->changedFirst = first;
+      pState->changedEnd = first+newRows;
+      pState->changedDelta = newRows-oldRows;
+      return;
    }
+
+   // Rows changed earlier that come after this change move with it.
+   if ( end >= first+oldRows )
+   {
+      end += newRows-oldRows;
+   }
+   else if ( end > first )
+   {
+      end = first+newRows;
+   }
+
+   if ( first < pState->changedFirst )
+   {
+      pState->changedFirst = first;
+   }
+   pState->changedEnd = (end > first+newRows) ? end : first+newRows;
+   pState->changedDelta += newRows-oldRows;
+}
+
+void C6502::DISASSEMBLYCHANGES ( const DisassemblyState* pState, int32_t base, DisassemblyState* pView )
+{
+   if ( pState->changedFirst > pState->changedEnd )
+   {
+      return;
+   }
+   if ( base+pState->changedFirst < pView->changedFirst )
+   {
+      pView->changedFirst = base+pState->changedFirst;
+   }
+   if ( base+pState->changedEnd > pView->changedEnd )
+   {
+      pView->changedEnd = base+pState->changedEnd;
+   }
+   pView->changedDelta += pState->changedDelta;
+}
+
+char* C6502::DisassemblyText ( const DisassemblyInfo* pInfo, char* buffer )
+{
+   CNES6502_opcode* pOp = m_6502opcode+pInfo->bytes[0];
+   const char* name = pOp->name;
+   char* ptr = buffer;
+
+   if ( !pInfo->size )
+   {
+      sprintf_db(ptr);
+      sprintf_02x(ptr,pInfo->bytes[0]);
+      return buffer;
+   }
+
+   sprintf_opcode ( ptr, name );
+
+   switch ( pOp->amode )
+   {
+         // Single byte operands
+      case AM_IMMEDIATE:
+      case AM_ZEROPAGE_INDEXED_X:
+      case AM_ZEROPAGE_INDEXED_Y:
+      case AM_ZEROPAGE:
+      case AM_PREINDEXED_INDIRECT:
+      case AM_POSTINDEXED_INDIRECT:
+      case AM_RELATIVE:
+         sprintf ( ptr, operandFmt[pOp->amode], pInfo->bytes[1] );
+         break;
+
+         // Two byte operands
+      case AM_ABSOLUTE:
+      case AM_ABSOLUTE_INDEXED_X:
+      case AM_ABSOLUTE_INDEXED_Y:
+      case AM_INDIRECT:
+         sprintf ( ptr, operandFmt[pOp->amode], pInfo->bytes[2], pInfo->bytes[1] );
+         break;
+   }
+
+   return buffer;
 }
 
 char* C6502::Disassemble ( uint8_t* pOpcode, char* buffer )
@@ -4405,3 +4882,7 @@ char* C6502::Disassemble ( uint8_t* pOpcode, char* buffer )
 
    return lbuffer;
 }
+
+// The instruction loops the PPU chooses between.
+template void C6502::EMULATE<false> ( int32_t cycles );
+template void C6502::EMULATE<true> ( int32_t cycles );
@@ -11,6 +11,7 @@
 #include "cregisterdata.h"
 #include "cmemorydata.h"
 #include "cbreakpointinfo.h"
+#include "cnesstate.h"
 
 // CPU flags register bit definitions.
 #define FLAG_C    0x01
@@ -37,20 +38,56 @@
 #define GETHI8(wd) (((wd)>>8)&0xFF)
 #define GETLO8(wd) ((wd)&0xFF)
 
+// One address of a disassembled region of memory.  Every byte of an
+// instruction gets a copy of the instruction's record; bytes that are not
+// known to be code are data bytes.  The text the debuggers show is made
+// from the record only when it is asked for (see C6502::DisassemblyText).
+typedef struct _DisassemblyInfo
+{
+   uint8_t bytes [ 3 ]; // Opcode and operands, or the data byte.
+   uint8_t size;        // Instruction size, 0 for a data byte.
+} DisassemblyInfo;
+
+// Book-keeping for disassembling a region (RAM, EXRAM, or a SRAM or
+// PRG-ROM bank) a piece at a time.  The dirty span is the offsets whose
+// opcode mask changed since the region was last disassembled; only the
+// instructions around them are redone.  The changed span is the rows
+// (source lines) redone since the debugger last asked for them: rows
+// before changedFirst are as they were, rows from changedEnd on are the
+// old rows moved by changedDelta.  Both spans are empty when first is
+// past last or end.
+typedef struct _DisassemblyState
+{
+   int32_t dirtyFirst;
+   int32_t dirtyLast;
+   int32_t changedFirst;
+   int32_t changedEnd;
+   int32_t changedDelta;
+} DisassemblyState;
+
+// Number of 1KB pages in the CPU's page table.
+#define CPU_PAGES (MEM_64KB>>UPSHIFT_1KB)
+
+// Longest loop, in bytes, the CPU considers for idle-loop skipping, and
+// the registers it compares between turns of one (see C6502::IDLELOOP).
+#define IDLE_LOOP_BYTES 16
+#define IDLE_LOOP_REGS  12
+#define IDLE_NO_LOOP    0xFFFFFFFF
+
 // CPU stack manipuation macros.
 #define GETSTACKADDR() (MAKE16(rSP(),0x01))
 #define GETSTACKDATA() (MEM(GETSTACKADDR()))
 
 // CPU program counter manipulation macros.
-#define rPC() (uint32_t)(m_pc)
-#define wPC(pc) { m_pc = (pc); CNES::CHECKBREAKPOINT(eBreakInCPU,eBreakOnCPUState,CPU_PC); }
-#define INCPC() { m_pc++; CNES::CHECKBREAKPOINT(eBreakInCPU,eBreakOnCPUState,CPU_PC); }
+#define rPC() (uint32_t)(m_state->m_pc)
+#define wPC(pc) { m_state->m_pc = (pc); CNES::CHECKBREAKPOINT(eBreakInCPU,eBreakOnCPUState,CPU_PC); }
+#define INCPC() { m_state->m_pc++; CNES::CHECKBREAKPOINT(eBreakInCPU,eBreakOnCPUState,CPU_PC); }
 
 // CPU stack pointer manipulation macros.
-#define rSP() (m_sp)
-#define wSP(sp) { m_sp = (sp); }
-#define DECSP() { m_sp--;  CNES::CHECKBREAKPOINT(eBreakInCPU,eBreakOnCPUState,CPU_SP); }
-#define INCSP() { m_sp++;  CNES::CHECKBREAKPOINT(eBreakInCPU,eBreakOnCPUState,CPU_SP); }
+#define rSP() (m_state->m_sp)
+#define wSP(sp) { m_state->m_sp = (sp); }
+#define DECSP() { m_state->m_sp--;  CNES::CHECKBREAKPOINT(eBreakInCPU,eBreakOnCPUState,CPU_SP); }
+#define INCSP() { m_state->m_sp++;  CNES::CHECKBREAKPOINT(eBreakInCPU,eBreakOnCPUState,CPU_SP); }
 #define PUSH(data) { MEM(GETSTACKADDR(),(data)); DECSP(); }
 
 // The effective address is the calculated address for a
@@ -60,56 +97,56 @@
 // absolute physical address being manipulated by the CPU
 // for any given instruction executed.
 // NOTE: INTERNAL MACROS
-#define rEA() (m_ea)
-#define wEA(ea) { m_ea = (ea); }
+#define rEA() (m_state->m_ea)
+#define wEA(ea) { m_state->m_ea = (ea); }
 
 // CPU accumulator, X, and Y register manipulation macros.
 // NOTE: INTERNAL MACROS
-#define rA() (m_a)
-#define rX() (m_x)
-#define rY() (m_y)
-#define wA(a) { m_a = (a); CNES::CHECKBREAKPOINT(eBreakInCPU,eBreakOnCPUState,CPU_A); }
-#define wX(x) { m_x = (x); CNES::CHECKBREAKPOINT(eBreakInCPU,eBreakOnCPUState,CPU_X); }
-#define wY(y) { m_y = (y); CNES::CHECKBREAKPOINT(eBreakInCPU,eBreakOnCPUState,CPU_Y); }
+#define rA() (m_state->m_a)
+#define rX() (m_state->m_x)
+#define rY() (m_state->m_y)
+#define wA(a) { m_state->m_a = (a); CNES::CHECKBREAKPOINT(eBreakInCPU,eBreakOnCPUState,CPU_A); }
+#define wX(x) { m_state->m_x = (x); CNES::CHECKBREAKPOINT(eBreakInCPU,eBreakOnCPUState,CPU_X); }
+#define wY(y) { m_state->m_y = (y); CNES::CHECKBREAKPOINT(eBreakInCPU,eBreakOnCPUState,CPU_Y); }
 
 // CPU flags register manipulation macros.  Used by instructions
 // that manipulate the flags register as a complete set rather than
 // as individual flag bits.
 // NOTE: INTERNAL MACROS
-#define rF() (m_f|FLAG_MISC)
-#define wF(f) { m_f = ((f)|FLAG_MISC); }
+#define rF() (m_state->m_f|FLAG_MISC)
+#define wF(f) { m_state->m_f = ((f)|FLAG_MISC); }
 
 // CPU flag bit manipulation macros.  Used by instructions that
 // manipulate individual flag bits within the CPU flags register.
 // NOTE: INTERNAL MACROS
-#define rN() (!!(m_f&FLAG_N))
-#define rV() (!!(m_f&FLAG_V))
-#define rB() (!!(m_f&FLAG_B))
-#define rD() (!!(m_f&FLAG_D))
-#define rI() (!!(m_f&FLAG_I))
-#define rZ() (!!(m_f&FLAG_Z))
-#define rC() (!!(m_f&FLAG_C))
-#define sN() { m_f|=FLAG_N; }
-#define cN() { m_f&=~(FLAG_N); }
-#define sV() { m_f|=FLAG_V; }
-#define cV() { m_f&=~(FLAG_V); }
-#define sB() { m_f|=FLAG_B; }
-#define cB() { m_f&=~(FLAG_B); }
-#define sD() { m_f|=FLAG_D; }
-#define cD() { m_f&=~(FLAG_D); }
-#define sI() { m_f|=FLAG_I; }
-#define cI() { m_f&=~(FLAG_I); }
-#define sZ() { m_f|=FLAG_Z; }
-#define cZ() { m_f&=~(FLAG_Z); }
-#define sC() { m_f|=FLAG_C; }
-#define cC() { m_f&=~(FLAG_C); }
-#define wN(set) { m_f&=(~(FLAG_N)); m_f|=((!!(set))<<FLAG_N_SHIFT); }
-#define wV(set) { m_f&=(~(FLAG_V)); m_f|=((!!(set))<<FLAG_V_SHIFT); }
-#define wB(set) { m_f&=(~(FLAG_B)); m_f|=((!!(set))<<FLAG_B_SHIFT); }
-#define wD(set) { m_f&=(~(FLAG_D)); m_f|=((!!(set))<<FLAG_D_SHIFT); }
-#define wI(set) { m_f&=(~(FLAG_I)); m_f|=((!!(set))<<FLAG_I_SHIFT); }
-#define wZ(set) { m_f&=(~(FLAG_Z)); m_f|=((!!(set))<<FLAG_Z_SHIFT); }
-#define wC(set) { m_f&=(~(FLAG_C)); m_f|=((!!(set))<<FLAG_C_SHIFT); }
+#define rN() (!!(m_state->m_f&FLAG_N))
+#define rV() (!!(m_state->m_f&FLAG_V))
+#define rB() (!!(m_state->m_f&FLAG_B))
+#define rD() (!!(m_state->m_f&FLAG_D))
+#define rI() (!!(m_state->m_f&FLAG_I))
+#define rZ() (!!(m_state->m_f&FLAG_Z))
+#define rC() (!!(m_state->m_f&FLAG_C))
+#define sN() { m_state->m_f|=FLAG_N; }
+#define cN() { m_state->m_f&=~(FLAG_N); }
+#define sV() { m_state->m_f|=FLAG_V; }
+#define cV() { m_state->m_f&=~(FLAG_V); }
+#define sB() { m_state->m_f|=FLAG_B; }
+#define cB() { m_state->m_f&=~(FLAG_B); }
+#define sD() { m_state->m_f|=FLAG_D; }
+#define cD() { m_state->m_f&=~(FLAG_D); }
+#define sI() { m_state->m_f|=FLAG_I; }
+#define cI() { m_state->m_f&=~(FLAG_I); }
+#define sZ() { m_state->m_f|=FLAG_Z; }
+#define cZ() { m_state->m_f&=~(FLAG_Z); }
+#define sC() { m_state->m_f|=FLAG_C; }
+#define cC() { m_state->m_f&=~(FLAG_C); }
+#define wN(set) { m_state->m_f&=(~(FLAG_N)); m_state->m_f|=((!!(set))<<FLAG_N_SHIFT); }
+#define wV(set) { m_state->m_f&=(~(FLAG_V)); m_state->m_f|=((!!(set))<<FLAG_V_SHIFT); }
+#define wB(set) { m_state->m_f&=(~(FLAG_B)); m_state->m_f|=((!!(set))<<FLAG_B_SHIFT); }
+#define wD(set) { m_state->m_f&=(~(FLAG_D)); m_state->m_f|=((!!(set))<<FLAG_D_SHIFT); }
+#define wI(set) { m_state->m_f&=(~(FLAG_I)); m_state->m_f|=((!!(set))<<FLAG_I_SHIFT); }
+#define wZ(set) { m_state->m_f&=(~(FLAG_Z)); m_state->m_f|=((!!(set))<<FLAG_Z_SHIFT); }
+#define wC(set) { m_state->m_f&=(~(FLAG_C)); m_state->m_f|=((!!(set))<<FLAG_C_SHIFT); }
 
 // The C6502 class is the implementation of the core CPU of the NES.
 // It provides CPU-fetch-cycle granular emulation of the CPU core, including
@@ -148,15 +185,78 @@ public:
    C6502();
    ~C6502();
 
-   // Emulation routines.
-   static void EMULATE ( int32_t cycles );
+   // Allocate/free the resources owned by the selected machine.
+   static void CREATE ( void );
+   static void DESTROY ( void );
+
+   // Save/restore the selected machine's CPU core state to/from a binary save-state.
+   static void SAVESTATE ( CNESStateWriter& state );
+   static bool LOADSTATE ( CNESStateReader& state );
+
+   // Emulation routines.  Debuggable=false leaves the tracer, code/data
+   // logger and breakpoint checks out of the instruction loop; the PPU
+   // passes down whichever flavour CNES::RUN picked for the frame.
+   template<bool Debuggable> static void EMULATE ( int32_t cycles );
+
+   // Hand the CPU cycles clocked by the PPU.  Until the CPU is owed at
+   // least one whole cycle it has nothing to do, so the cycles are just
+   // banked without entering EMULATE.  A killed CPU still clocks the APU
+   // on every cycle it is handed.
+   template<bool Debuggable> static inline void CATCHUP ( int32_t cycles )
+   {
+      if ( (!m_state->m_killed) && (m_state->m_curCycles+cycles <= 0) )
+      {
+         m_state->m_curCycles += cycles;
+      }
+      else
+      {
+         EMULATE<Debuggable> ( cycles );
+      }
+   }
+
+   // How many cycles can be handed to CATCHUP before the CPU, and with it
+   // the APU and any cycle-counting mapper, has work to do.
+   static inline int32_t IDLECYCLES ( void )
+   {
+      return m_state->m_killed ? 0 : -m_state->m_curCycles;
+   }
+
+   // Idle-loop skipping.  While it is on, EMULATE<false> passes over
+   // whole turns of a short loop that only reads memory nothing else is
+   // changing, such as a game waiting for NMI (see IDLELOOP).  The
+   // counts are of the turns and CPU cycles passed over in the last
+   // whole frame.
+   static void IDLESKIP ( bool enabled )
+   {
+      m_state->m_idleSkip = enabled;
+      m_state->m_idleHead = IDLE_NO_LOOP;
+   }
+   static bool IDLESKIP ( void )
+   {
+      return m_state->m_idleSkip;
+   }
+   static void IDLEFRAME ( void )
+   {
+      m_state->m_idleFrameTurns = m_state->m_idleTurns;
+      m_state->m_idleFrameCycles = m_state->m_idleCycles;
+      m_state->m_idleTurns = 0;
+      m_state->m_idleCycles = 0;
+   }
+   static uint32_t IDLETURNS ( void )
+   {
+      return m_state->m_idleFrameTurns;
+   }
+   static uint32_t IDLESKIPPED ( void )
+   {
+      return m_state->m_idleFrameCycles;
+   }
    static void GOTO ( uint32_t pcGoto )
    {
-      m_pcGoto = pcGoto;
+      m_state->m_pcGoto = pcGoto;
    }
    static void GOTO ()
    {
-      m_pcGoto = 0xFFFFFFFF;
+      m_state->m_pcGoto = 0xFFFFFFFF;
    }
 
    // CPU reset vector routine.
@@ -172,7 +272,7 @@ public:
    // assertion of NMI to the CPU.
    static void CHOKENMI ()
    {
-      m_nmiAsserted = false;
+      m_state->m_nmiAsserted = false;
    }
 
    // The CPU BRK instruction and also the handler routines for
@@ -273,7 +373,7 @@ public:
    // Return the currently calculated effective address.
    static uint32_t _EA ( void )
    {
-      return m_ea;
+      return m_state->m_ea;
    }
 
    // Return the contents of a memory location visible to the CPU.
@@ -285,21 +385,21 @@ public:
    // Retrieve a pointer to the whole memory.
    static uint8_t* _MEMPTR ( void )
    {
-      return m_6502memory;
+      return m_state->m_6502memory;
    }
 
    // Return whether or not the CPU is currently in the middle of
    // the first cycle of an instruction fetch (the opcode fetch).
    static bool _SYNC ( void )
    {
-      return (m_instrCycle==0);
+      return (m_state->m_instrCycle==0);
    }
 
    // Return whether or not the CPU is currently in the middle of
    // a write memory cycle.
    static bool _WRITING ( void )
    {
-      return m_write;
+      return m_state->m_write;
    }
 
    // Return the current cycle index of the CPU core.
@@ -308,26 +408,70 @@ public:
    // But, roll-over of this counter is not a significant event.
    static inline uint32_t _CYCLES ( void )
    {
-      return m_cycles;
+      return m_state->m_cycles;
+   }
+
+   // Instructions the CPU has started, counting those in idle-loop turns
+   // passed over.  Rolls over like the cycle counter.
+   static inline uint32_t _INSTRUCTIONS ( void )
+   {
+      return m_state->m_instructions;
    }
 
    // Accessor methods to set up or clear the state of the RAM
    // maintained internally by the CPU core object.
    static void MEMSET ( uint32_t addr, uint8_t* data, uint32_t length )
    {
-      memcpy(m_6502memory+addr,data,length);
+      memcpy(m_state->m_6502memory+addr,data,length);
    };
    static void MEMCLR ( void )
    {
-      memset(m_6502memory,0,MEM_2KB);
+      memset(m_state->m_6502memory,0,MEM_2KB);
+   }
+
+   // Point a range of the CPU's page table at memory the CPU can read
+   // (or write) directly.  NULL sends the range back through the slow
+   // LOAD/STORE path to the PPU, APU, I/O ports and mapper.
+   static inline void MAPREAD ( uint32_t addr, uint32_t length, uint8_t* memory )
+   {
+      uint32_t page;
+
+      for ( page = addr>>UPSHIFT_1KB; page < (addr+length)>>UPSHIFT_1KB; page++ )
+      {
+         m_state->m_pReadPage[page] = memory;
+         if ( memory )
+         {
+            memory += MEM_1KB;
+         }
+      }
+   }
+   static inline void MAPWRITE ( uint32_t addr, uint32_t length, uint8_t* memory )
+   {
+      uint32_t page;
+
+      for ( page = addr>>UPSHIFT_1KB; page < (addr+length)>>UPSHIFT_1KB; page++ )
+      {
+         m_state->m_pWritePage[page] = memory;
+         if ( memory )
+         {
+            memory += MEM_1KB;
+         }
+      }
    }
 
    // Method to return the current open bus data.
-   static uint8_t OPENBUS () { return m_openBusData; }
+   static uint8_t OPENBUS () { return m_state->m_openBusData; }
 
    // DMA driver method.
    static bool DMA ( void );
 
+   // Whether a sprite or DMC DMA is requested or in flight.  The DMA
+   // driver only has to be stepped while one is.
+   static inline bool DMAACTIVE ( void )
+   {
+      return (m_state->m_dmaRequest >= 0) || m_state->m_readDmaCounter || m_state->m_writeDmaCounter;
+   }
+
    // Accessor methods for supporting DMA between the CPU and APU/PPU.
    static uint8_t DMA ( uint32_t addr );
    static void DMA ( uint32_t srcAddr, uint32_t dstAddr, uint8_t data );
@@ -347,125 +491,125 @@ public:
    // emulator core.
    static uint32_t __PC ( void )
    {
-      return m_pc;
+      return m_state->m_pc;
    }
    static uint32_t __PCSYNC ( void )
    {
-      if ( m_pcSyncSet )
+      if ( m_state->m_pcSyncSet )
       {
-         return m_pcSync;
+         return m_state->m_pcSync;
       }
       else
       {
-         return m_pc;
+         return m_state->m_pc;
       }
    }
    static void __PC ( uint16_t pc )
    {
-      m_pc = pc;
+      m_state->m_pc = pc;
    }
    static uint32_t _SP ( void )
    {
-      return m_sp;
+      return m_state->m_sp;
    }
    static void _SP ( uint8_t sp )
    {
-      m_sp = sp;
+      m_state->m_sp = sp;
    }
    static uint32_t _A ( void )
    {
-      return m_a;
+      return m_state->m_a;
    }
    static void _A ( uint8_t a )
    {
-      m_a = a;
+      m_state->m_a = a;
    }
    static uint32_t _X ( void )
    {
-      return m_x;
+      return m_state->m_x;
    }
    static void _X ( uint8_t x )
    {
-      m_x = x;
+      m_state->m_x = x;
    }
    static uint32_t _Y ( void )
    {
-      return m_y;
+      return m_state->m_y;
    }
    static void _Y ( uint8_t y )
    {
-      m_y = y;
+      m_state->m_y = y;
    }
    static uint32_t _F ( void )
    {
-      return m_f;
+      return m_state->m_f;
    }
    static void _F ( uint8_t f )
    {
-      m_f = f;
+      m_state->m_f = f;
    }
    static uint32_t _N ( void )
    {
-      return (!!(m_f&FLAG_N));   // Negative
+      return (!!(m_state->m_f&FLAG_N));   // Negative
    }
    static uint32_t _V ( void )
    {
-      return (!!(m_f&FLAG_V));   // Overflow
+      return (!!(m_state->m_f&FLAG_V));   // Overflow
    }
    static uint32_t _B ( void )
    {
-      return (!!(m_f&FLAG_B));   // Break command
+      return (!!(m_state->m_f&FLAG_B));   // Break command
    }
    static uint32_t _D ( void )
    {
-      return (!!(m_f&FLAG_D));   // Decimal mode
+      return (!!(m_state->m_f&FLAG_D));   // Decimal mode
    }
    static uint32_t _I ( void )
    {
-      return (!!(m_f&FLAG_I));   // Interrupt disable
+      return (!!(m_state->m_f&FLAG_I));   // Interrupt disable
    }
    static uint32_t _Z ( void )
    {
-      return (!!(m_f&FLAG_Z));   // Zero
+      return (!!(m_state->m_f&FLAG_Z));   // Zero
    }
    static uint32_t _C ( void )
    {
-      return (!!(m_f&FLAG_C));   // Carry
+      return (!!(m_state->m_f&FLAG_C));   // Carry
    }
    static void _N ( uint32_t set )
    {
-      m_f&=~(FLAG_N);
-      m_f|=((!!set)<<FLAG_N_SHIFT);
+      m_state->m_f&=~(FLAG_N);
+      m_state->m_f|=((!!set)<<FLAG_N_SHIFT);
    }
    static void _V ( uint32_t set )
    {
-      m_f&=~(FLAG_V);
-      m_f|=((!!set)<<FLAG_V_SHIFT);
+      m_state->m_f&=~(FLAG_V);
+      m_state->m_f|=((!!set)<<FLAG_V_SHIFT);
    }
    static void _B ( uint32_t set )
    {
-      m_f&=~(FLAG_B);
-      m_f|=((!!set)<<FLAG_B_SHIFT);
+      m_state->m_f&=~(FLAG_B);
+      m_state->m_f|=((!!set)<<FLAG_B_SHIFT);
    }
    static void _D ( uint32_t set )
    {
-      m_f&=~(FLAG_D);
-      m_f|=((!!set)<<FLAG_D_SHIFT);
+      m_state->m_f&=~(FLAG_D);
+      m_state->m_f|=((!!set)<<FLAG_D_SHIFT);
    }
    static void _I ( uint32_t set )
    {
-      m_f&=~(FLAG_I);
-      m_f|=((!!set)<<FLAG_I_SHIFT);
+      m_state->m_f&=~(FLAG_I);
+      m_state->m_f|=((!!set)<<FLAG_I_SHIFT);
    }
    static void _Z ( uint32_t set )
    {
-      m_f&=~(FLAG_Z);
-      m_f|=((!!set)<<FLAG_Z_SHIFT);
+      m_state->m_f&=~(FLAG_Z);
+      m_state->m_f|=((!!set)<<FLAG_Z_SHIFT);
    }
    static void _C ( uint32_t set )
    {
-      m_f&=~(FLAG_C);
-      m_f|=((!!set)<<FLAG_C_SHIFT);
+      m_state->m_f&=~(FLAG_C);
+      m_state->m_f|=((!!set)<<FLAG_C_SHIFT);
    }
 
    // Interface to retrieve the database of execution markers.
@@ -477,17 +621,54 @@ public:
    // database visually.
    static CMarker* MARKERS()
    {
-      return m_marker;
+      return m_state->m_marker;
    }
 
    // Disassembly routines for display.
    static void DISASSEMBLE ();
-   static void DISASSEMBLE ( char** disassembly, uint8_t* binary, int32_t binaryLength, uint8_t* opcodeMask, uint16_t* sloc2addr, uint16_t* addr2sloc, uint32_t* sourceLength );
+   static void DISASSEMBLE ( DisassemblyInfo* disassembly, uint8_t* binary, int32_t binaryLength, uint8_t* opcodeMask, uint16_t* sloc2addr, uint16_t* addr2sloc, uint32_t* sourceLength, DisassemblyState* pState );
    static char* Disassemble ( uint8_t* pOpcode, char* buffer );
+   static char* DisassemblyText ( const DisassemblyInfo* pInfo, char* buffer );
+
+   // Region book-keeping (see DisassemblyState).
+   static inline void DISASSEMBLYRESET ( DisassemblyState* pState, int32_t length )
+   {
+      pState->dirtyFirst = 0;
+      pState->dirtyLast = length-1;
+      pState->changedFirst = 0x7FFFFFFF;
+      pState->changedEnd = 0;
+      pState->changedDelta = 0;
+   }
+   static inline void DISASSEMBLYDIRTY ( DisassemblyState* pState, int32_t first, int32_t last )
+   {
+      if ( first < pState->dirtyFirst )
+      {
+         pState->dirtyFirst = first;
+      }
+      if ( last > pState->dirtyLast )
+      {
+         pState->dirtyLast = last;
+      }
+   }
+   static inline void DISASSEMBLYCHANGESCLR ( DisassemblyState* pState )
+   {
+      pState->changedFirst = 0x7FFFFFFF;
+      pState->changedEnd = 0;
+      pState->changedDelta = 0;
+   }
+   // Record that rows [first,first+oldRows) became newRows rows.
+   static void DISASSEMBLYCHANGED ( DisassemblyState* pState, int32_t first, int32_t oldRows, int32_t newRows );
+   // Add a region's changed rows to those of a view that shows the
+   // region starting at row base.
+   static void DISASSEMBLYCHANGES ( const DisassemblyState* pState, int32_t base, DisassemblyState* pView );
+   static inline DisassemblyState* DISASSEMBLYSTATE ( void )
+   {
+      return &(m_state->m_RAMdisassemblyState);
+   }
 
    static inline CCodeDataLogger* LOGGER ( void )
    {
-      return m_logger;
+      return m_state->m_logger;
    }
 
    // Interface to retrieve the database defining the registers
@@ -513,7 +694,7 @@ public:
    // breakpoint if a KIL opcode is executed.
    static void BREAKONKIL(bool breakOnKIL)
    {
-      m_breakOnKIL = breakOnKIL;
+      m_state->m_breakOnKIL = breakOnKIL;
    }
 
    // Interface to retrieve the database of CPU core-specific
@@ -543,36 +724,36 @@ public:
    // disassembler.
    static inline void OPCODEMASK ( uint32_t addr, uint8_t mask )
    {
-      *(m_RAMopcodeMask+(addr&MEM_2KB)) = mask;
+      *(m_state->m_RAMopcodeMask+(addr&MEM_2KB)) = mask;
    }
    static inline void OPCODEMASKCLR ( void )
    {
       int32_t idx;
       for ( idx = 0; idx < MEM_2KB; idx++ )
       {
-         m_RAMopcodeMask[idx] = 0;
+         m_state->m_RAMopcodeMask[idx] = 0;
       }
    }
-   static inline char* DISASSEMBLY ( uint32_t addr )
+   static inline DisassemblyInfo* DISASSEMBLY ( uint32_t addr )
    {
-      return *(m_RAMdisassembly+addr);
+      return m_state->m_RAMdisassembly+addr;
    }
    static uint32_t SLOC2ADDR ( uint16_t sloc )
    {
-      return *(m_RAMsloc2addr+sloc);
+      return *(m_state->m_RAMsloc2addr+sloc);
    }
    static uint16_t ADDR2SLOC ( uint32_t addr )
    {
-      return *(m_RAMaddr2sloc+addr);
+      return *(m_state->m_RAMaddr2sloc+addr);
    }
    static inline uint16_t SLOC ()
    {
-      return m_RAMsloc;
+      return m_state->m_RAMsloc;
    }
 
    static inline uint32_t WRITEDMAADDR()
    {
-      return (512-m_writeDmaCounter)>>1;
+      return (512-m_state->m_writeDmaCounter)>>1;
    }
 
 protected:
@@ -587,118 +768,198 @@ protected:
    // These are used internally by the CPU core during emulation.
    static uint8_t MEM ( uint32_t addr );
    static void MEM ( uint32_t addr, uint8_t data );
-   static uint8_t FETCH ();
-   static uint8_t EXTRAFETCH ();
+   template<bool Debuggable> static uint8_t FETCH ();
+   template<bool Debuggable> static uint8_t EXTRAFETCH ();
+
+   // Opcode handlers are shared by both flavours of EMULATE, so they
+   // go by the current debug setting.
+   static inline uint8_t FETCH ()
+   {
+      return nesIsDebuggable() ? FETCH<true> () : FETCH<false> ();
+   }
+
+   // Idle-loop skipping.  IDLELOOP is called when the CPU is about to
+   // fetch the top of a short loop it just branched back to.  Once a
+   // turn of the loop has gone by in the time a turn takes with nothing
+   // changing, every further turn will be the same until something
+   // outside the CPU changes what the loop reads or interrupts it.  The
+   // CPU then moves straight on by as many turns as fit before the
+   // first thing the PPU, APU or mapper could do to end it, and the
+   // rest of the machine catches up without it.  Returns true if it
+   // moved on.  IDLELOOPCYCLES checks the loop only reads RAM, ROM or
+   // PPUSTATUS, and returns the cycles and instructions one turn takes
+   // (0 cycles if the loop does not qualify).
+   static bool IDLELOOP ( void );
+   static uint32_t IDLELOOPCYCLES ( uint32_t head, uint32_t tail, bool* status, uint32_t* instructions );
+   static void IDLESNAPSHOT ( uint8_t* regs );
+
    static uint8_t STEAL ( uint32_t addr, uint8_t source );
    static uint8_t LOAD ( uint32_t addr, int8_t* pTarget );
    static void STORE ( uint32_t addr, uint8_t data, int8_t* pTarget );
 
-   // Is the CPU currently locked due to execution of an
-   // illegal instruction?  Illegal instructions are all KIL opcodes.
-   static bool            m_killed;
-
-   // Has an IRQ been asserted to the CPU core?
-   static bool            m_irqAsserted;
-
-   // Was IRQ asserted when checked?
-   static bool            m_irqPending;
-
-   // Has NMI been asserted to the CPU core?
-   static bool            m_nmiAsserted;
-
-   // Was NMI asserted when checked?
-   static bool            m_nmiPending;
-
-   // The CPU core maintains the 2KB of RAM visible to the CPU.
-   static uint8_t*  m_6502memory;
-
-   // The CPU core registers.
-   static uint8_t   m_a;
-   static uint8_t   m_x;
-   static uint8_t   m_y;
-   static uint8_t   m_f;
-   static uint16_t  m_pc;
-   static uint16_t  m_pcSync;
-   static bool      m_pcSyncSet;
-   static uint8_t   m_sp;
-
-   // The effective address calculated by the CPU core.
-   static uint32_t    m_ea;
-
-   // The address to break at on a "run to here" go.
-   static uint32_t            m_pcGoto;
-
-   // Running counter of CPU cycles executed.  Will roll over in
-   // approximately 40 minutes of emulation.
-   static uint32_t    m_cycles;
-   static int32_t     m_instrCycle;
-
-   // The current number of CPU cycles ready to be executed by
-   // the CPU core.
-   static int32_t             m_curCycles; // must be allowed to go negative!
-
-   // The following data is used internally by the CPU core
-   // during instruction execution.  As opcodes are fetched and
-   // decoded, relevant information about the opcode is stored
-   // in these variables to avoid passing all of this information
-   // on the stack frame during instruction execution via
-   // function-pointer invocation.
-   // The current opcode's addressing mode.
-   static int32_t             amode;
-
-   // DMC DMA request active flag.
-   static int32_t m_dmaRequest;
-
-   // DMA address for DMA write transfers.  The CPU sets this on a DMA
-   // request from a write to $4014, then begins its DMA transfer at the
-   // appropriate time.  When not DMAing the counter will be 0.
-   static uint16_t m_writeDmaAddr;
-   static int32_t m_writeDmaCounter;
-
-   // DMA address for DMA read transfers.  The APU sets this on a DMA
-   // request for a DMC channel sample, then begins its DMA transfer at the
-   // appropriate time.  When not DMAing the counter will be 0.
-   static uint16_t m_readDmaAddr;
-   static int32_t m_readDmaCounter;
-
-   // The current opcode's full 1-, 2-, or 3-byte instruction data.
-   static uint8_t*  data;
-   static uint8_t   opcodeData [ 4 ]; // 3 opcode bytes and 1 byte for operand return data [extra cycle]
-
-   // The current opcode's table entry (see struct _CNES6502_opcode below).
-   static struct _CNES6502_opcode* pOpcodeStruct;
-
-   // The size of the current opcode in bytes (1, 2, or 3).
-   static int32_t             opcodeSize;
-
-   // Whether or not the CPU is in a write memory cycle.
-   static bool            m_write;
-
-   // Open bus data to be returned if reading an unconnected memory region.
-   static uint8_t m_openBusData;
-
-   // Which phase of instruction fetching is the CPU core in?
-   // m_phase will be 0 during the opcode fetch.  m_phase will go
-   // up to 1 if the fetched opcode is 1-byte (extra fetch cycle) or 2-bytes.
-   // m_phase will go up to 3 if the fetched opcode is 3-byte.
-   // Then m_phase goes to -1 for the instruction execution.
-   static int8_t            m_phase;
-
-   // This points to the last execution tracer tag that
-   // is where the disassembly of the instruction should
-   // be placed.
-   static TracerInfo* pDisassemblySample;
-
-   // Database used by the Execution Visualizer debugger inspector.
-   // The data structure is maintained by the CPU core as it executes
-   // instructions that are marked.
-   static CMarker*         m_marker;
-
-   // Database used by the Code/Data Logger debugger inspector.  The data structure
-   // is maintained by the CPU core as it performs fetches, reads,
-   // writes, and DMA transfers to/from its managed RAM.  The
-   // Code/Data Logger displays the collected information graphically.
-   static CCodeDataLogger* m_logger;
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      // Is the CPU currently locked due to execution of an
+      // illegal instruction?  Illegal instructions are all KIL opcodes.
+      bool m_killed = false;
+
+      // Has an IRQ been asserted to the CPU core?
+      bool m_irqAsserted = false;
+
+      // Was IRQ asserted when checked?
+      bool m_irqPending = false;
+
+      // Has NMI been asserted to the CPU core?
+      bool m_nmiAsserted = false;
+
+      // Was NMI asserted when checked?
+      bool m_nmiPending = false;
+
+      // The CPU core maintains the 2KB of RAM visible to the CPU.
+      uint8_t* m_6502memory = NULL;
+
+      // CPU page table, one entry per 1KB of the CPU address space.
+      // Pages of RAM, and of PRG-ROM and SRAM that the mapper reads
+      // the default way, point straight at the memory; NULL pages go
+      // through the callbacks.  Only RAM is writable this way since
+      // SRAM writes have to mark the battery dirty.
+      uint8_t* m_pReadPage [ CPU_PAGES ] = { NULL, };
+      uint8_t* m_pWritePage [ CPU_PAGES ] = { NULL, };
+
+      // The CPU core registers.
+      uint8_t m_a = 0x00;
+      uint8_t m_x = 0x00;
+      uint8_t m_y = 0x00;
+      uint8_t m_f = FLAG_MISC;
+      uint16_t m_pc = VECTOR_RESET;
+      uint16_t m_pcSync = VECTOR_RESET;
+      bool m_pcSyncSet = false;
+      uint8_t m_sp = 0x00;
+
+      // The effective address calculated by the CPU core.
+      uint32_t m_ea = 0;
+
+      // The address to break at on a "run to here" go.
+      uint32_t m_pcGoto = 0xFFFFFFFF;
+
+      // Running counter of CPU cycles executed.  Will roll over in
+      // approximately 40 minutes of emulation.
+      uint32_t m_cycles = 0;
+      int32_t m_instrCycle = 0;
+
+      // The current number of CPU cycles ready to be executed by
+      // the CPU core.
+      int32_t m_curCycles = 0; // must be allowed to go negative!
+
+      // The following data is used internally by the CPU core
+      // during instruction execution.  As opcodes are fetched and
+      // decoded, relevant information about the opcode is stored
+      // in these variables to avoid passing all of this information
+      // on the stack frame during instruction execution via
+      // function-pointer invocation.
+      // The current opcode's addressing mode.
+      int32_t amode;
+
+      // DMC DMA request active flag.
+      int32_t m_dmaRequest = -1;
+
+      // DMA address for DMA write transfers.  The CPU sets this on a DMA
+      // request from a write to $4014, then begins its DMA transfer at the
+      // appropriate time.  When not DMAing the counter will be 0.
+      uint16_t m_writeDmaAddr = 0x0000;
+      int32_t m_writeDmaCounter = 0;
+
+      // DMA address for DMA read transfers.  The APU sets this on a DMA
+      // request for a DMC channel sample, then begins its DMA transfer at the
+      // appropriate time.  When not DMAing the counter will be 0.
+      uint16_t m_readDmaAddr = 0x0000;
+      int32_t m_readDmaCounter = 0;
+
+      // The current opcode's full 1-, 2-, or 3-byte instruction data.
+      uint8_t* data = NULL;
+      uint8_t opcodeData [ 4 ]; // 3 opcode bytes and 1 byte for operand return data [extra cycle]
+
+      // The current opcode's table entry (see struct _CNES6502_opcode below).
+      struct _CNES6502_opcode* pOpcodeStruct = NULL;
+
+      // The size of the current opcode in bytes (1, 2, or 3).
+      int32_t opcodeSize;
+
+      // Whether or not the CPU is in a write memory cycle.
+      bool m_write = false;
+
+      // Open bus data to be returned if reading an unconnected memory region.
+      uint8_t m_openBusData = 0x00;
+
+      // Which phase of instruction fetching is the CPU core in?
+      // m_phase will be 0 during the opcode fetch.  m_phase will go
+      // up to 1 if the fetched opcode is 1-byte (extra fetch cycle) or 2-bytes.
+      // m_phase will go up to 3 if the fetched opcode is 3-byte.
+      // Then m_phase goes to -1 for the instruction execution.
+      int8_t m_phase = 0;
+
+      // This is the slot of the last execution tracer tag that
+      // is where the disassembly of the instruction should
+      // be placed.
+      uint32_t disassemblySample = TRACER_NO_SAMPLE;
+
+      // Database used by the Execution Visualizer debugger inspector.
+      // The data structure is maintained by the CPU core as it executes
+      // instructions that are marked.
+      CMarker* m_marker = NULL;
+
+      // Database used by the Code/Data Logger debugger inspector.  The data structure
+      // is maintained by the CPU core as it performs fetches, reads,
+      // writes, and DMA transfers to/from its managed RAM.  The
+      // Code/Data Logger displays the collected information graphically.
+      CCodeDataLogger* m_logger = NULL;
+
+      // Configuration from EmulatorPrefs.
+      bool m_breakOnKIL = false;
+
+      // The data structures that support runtime disassembly of executed code.
+      uint8_t* m_RAMopcodeMask = NULL;
+      DisassemblyInfo* m_RAMdisassembly = NULL;
+      uint16_t* m_RAMsloc2addr = NULL;
+      uint16_t* m_RAMaddr2sloc = NULL;
+      uint32_t m_RAMsloc = 0;
+      DisassemblyState m_RAMdisassemblyState;
+
+      // Data latched by DMA while the CPU is stalled.
+      uint8_t m_dmaDatabuf = 0x00;
+
+      // BRK/IRQ sequence state carried between instruction cycles.
+      uint8_t m_brkPclo = 0x00;
+      bool m_brkDoingIrq = false;
+
+      // Idle-loop skipping (see IDLELOOP).  The loop the CPU last came
+      // round to the top of, the cycles a turn of it takes (0 if it
+      // does not qualify), whether it reads PPUSTATUS, and the cycle and
+      // registers when the CPU was last at its top.  None of this is
+      // part of the emulated machine, so none of it is saved.
+      bool m_idleSkip = false;
+      uint32_t m_idleHead = IDLE_NO_LOOP;
+      uint32_t m_idleTail = IDLE_NO_LOOP;
+      uint32_t m_idleLoopCycles = 0;
+      uint32_t m_idleLoopInstructions = 0;
+      bool m_idleStatus = false;
+      uint32_t m_idleCycle = 0;
+      uint32_t m_idleEA = 0;
+      uint8_t m_idleRegs [ IDLE_LOOP_REGS ];
+
+      // Turns and cycles skipped this frame, and in the last one.
+      uint32_t m_idleTurns = 0;
+      uint32_t m_idleCycles = 0;
+      uint32_t m_idleFrameTurns = 0;
+      uint32_t m_idleFrameCycles = 0;
+
+      // Instructions started (see _INSTRUCTIONS).  Not saved either.
+      uint32_t m_instructions = 0;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 
    // The database for CPU core registers.  Declaration
    // is in source file.
@@ -707,20 +968,11 @@ protected:
    // The database for CPU RAM.  Declaration is in source file.
    static CMemoryDatabase* m_dbMemory;
 
-   // Configuration from EmulatorPrefs.
-   static bool m_breakOnKIL;
-
    // The database for CPU core breakpoint events.  Declaration
    // is in source file.
    static CBreakpointEventInfo** m_tblBreakpointEvents;
    static int32_t                    m_numBreakpointEvents;
 
-   // The data structures that support runtime disassembly of executed code.
-   static uint8_t*   m_RAMopcodeMask;
-   static char**           m_RAMdisassembly;
-   static uint16_t*  m_RAMsloc2addr;
-   static uint16_t*  m_RAMaddr2sloc;
-   static uint32_t    m_RAMsloc;
 };
 
 // Structure representing each instruction and
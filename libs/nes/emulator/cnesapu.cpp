@@ -17,6 +17,10 @@
 #include "cnesapu.h"
 #include "cnes6502.h"
 #include "cnesppu.h"
+#include "cnesrom.h"
+#include "cnesperf.h"
+
+#include <math.h>
 
 //#define OUTPUT_WAV
 
@@ -233,31 +237,8 @@ CRegisterDatabase* CAPU::m_dbRegisters = dbRegisters;
 CBreakpointEventInfo** CAPU::m_tblBreakpointEvents = tblAPUEvents;
 int32_t                CAPU::m_numBreakpointEvents = NUM_APU_EVENTS;
 
-uint8_t CAPU::m_APUreg [] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-uint8_t CAPU::m_APUregDirty [] = { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 };
-bool          CAPU::m_irqEnabled = false;
-bool          CAPU::m_irqAsserted = false;
-CAPUSquare    CAPU::m_square[2];
-CAPUTriangle  CAPU::m_triangle;
-CAPUNoise     CAPU::m_noise;
-CAPUDMC       CAPU::m_dmc;
-
-uint16_t*      CAPU::m_waveBuf = NULL;
-int32_t        CAPU::m_waveBufProduce = 0;
-int32_t        CAPU::m_waveBufConsume = 0;
-
-uint32_t CAPU::m_cycles = 0;
-
-float        CAPU::m_sampleSpacer = 0.0;
-
-int32_t CAPU::m_sampleBufferSize = APU_BUFFER_SIZE;
-
-int32_t CAPU::m_sequencerMode = 0;
-int32_t CAPU::m_newSequencerMode = 0;
-// Cycles to wait before changing sequencer modes...0 or 1 are valid values
-// on a mode-change.
-int32_t CAPU::m_changeModes = -1;
-int32_t CAPU::m_sequenceStep = 0;
+CAPU::State CAPU::m_defaultState;
+thread_local CAPU::State* CAPU::m_state = &CAPU::m_defaultState;
 
 // Events that can occur during the APU sequence stepping
 enum
@@ -284,6 +265,23 @@ static int32_t m_seq5 [ 5 ] =
    0
 };
 
+// The APU cycles on which EMULATE does more than clock the channels:
+// the sequencer steps and frame IRQs of each mode, ending with the last
+// cycle of the APU frame.  [NTSC/Dendy,PAL][mode 0,mode 1]
+#define APU_SEQ_EVENTS 7
+
+static uint32_t m_seqEvents [ 2 ][ 2 ][ APU_SEQ_EVENTS ] =
+{
+   {
+      { 7459, 14915, 22373, 29830, 29831, 29832, 37288 },
+      { 1, 7459, 14915, 22373, 29829, 37282, 37282 }
+   },
+   {
+      { 8315, 16629, 24941, 33254, 33255, 33256, 41568 },
+      { 1, 8315, 16629, 24941, 33255, 41566, 41566 }
+   }
+};
+
 static uint8_t m_lengthLUT [ 32 ] =
 {
    0x0A,
@@ -320,167 +318,414 @@ static uint8_t m_lengthLUT [ 32 ] =
    0x1E
 };
 
-int32_t apuDataAvailable = 0;
+int32_t CAPU::m_pulseMix [ APU_PULSE_MIX_SIZE ];
+int32_t CAPU::m_tndMix [ APU_TND_MIX_SIZE ];
+int32_t CAPU::m_blipKernel [ APU_BLIP_PHASES ] [ APU_BLIP_TAPS ];
 
 static CAPU __init __attribute__((unused));
 
 CAPU::CAPU()
 {
-   m_square[0].SetChannel ( 0 );
-   m_square[1].SetChannel ( 1 );
-   m_triangle.SetChannel ( 2 );
-   m_noise.SetChannel ( 3 );
-   m_dmc.SetChannel ( 4 );
-
-   m_square[0].MUTE(false);
-   m_square[1].MUTE(false);
-   m_triangle.MUTE(false);
-   m_noise.MUTE(false);
-   m_dmc.MUTE(false);
-
-   m_waveBuf = new uint16_t [ APU_BUFFER_SIZE ];
-   memset( m_waveBuf, 0, APU_BUFFER_SIZE * sizeof m_waveBuf[ 0 ] );
+   MIXERTABLES();
+   CREATE();
 }
 
-uint8_t* CAPU::PLAY ( uint16_t samples )
+void CAPU::MIXERTABLES ( void )
 {
-   uint16_t* waveBuf;
-   
-   m_sampleBufferSize = samples*NUM_APU_BUFS;
-
-   waveBuf = m_waveBuf + m_waveBufConsume;
-
-   m_waveBufConsume += samples;
-   m_waveBufConsume %= m_sampleBufferSize;
-
-   apuDataAvailable -= samples;
-
-   return (uint8_t*)waveBuf;
-}
+   double scale;
+   double taps [ APU_BLIP_TAPS ];
+   double sum;
+   double t;
+   double x;
+   double w;
+   int32_t phase;
+   int32_t tap;
+   int32_t step;
+   int32_t total;
+   int32_t idx;
 
-uint16_t CAPU::AMPLITUDE ( void )
-{
-   float famp;
-   int16_t amp;
-   int16_t delta;
-   int16_t out[100] = { 0, };
-   static int16_t outLast = 0;
-   uint8_t sample;
-   uint8_t* sq1dacSamples = m_square[0].GETDACSAMPLES();
-   uint8_t* sq2dacSamples = m_square[1].GETDACSAMPLES();
-   uint8_t* triangleDacSamples = m_triangle.GETDACSAMPLES();
-   uint8_t* noiseDacSamples = m_noise.GETDACSAMPLES();
-   uint8_t* dmcDacSamples = m_dmc.GETDACSAMPLES();
-   static int32_t outDownsampled = 0;
-
-   for ( sample = 0; sample < m_square[0].GETDACSAMPLECOUNT(); sample++ )
-   {
 //      output = square_out + tnd_out
 //
-//
 //                            95.88
 //      square_out = -----------------------
 //                          8128
 //                   ----------------- + 100
 //                   square1 + square2
 //
+//                           163.67
+//      tnd_out = -----------------------------------
+//                            24329
+//                ----------------------------- + 100
+//                3*triangle + 2*noise + dmc
 //
-//                            159.79
-//      tnd_out = ------------------------------
-//                            1
-//                ------------------------ + 100
-//                triangle   noise    dmc
-//                -------- + ----- + -----
-//                  8227     12241   22638
-      famp = 0.0;
-      if ( (*(sq1dacSamples+sample))+(*(sq2dacSamples+sample)) )
+// Both are scaled so the loudest output is a full 16-bit sample.
+   scale = 32767.0/((95.88/((8128.0/(APU_PULSE_MIX_SIZE-1))+100.0))+
+                    (163.67/((24329.0/(APU_TND_MIX_SIZE-1))+100.0)));
+
+   m_pulseMix [ 0 ] = 0;
+   for ( idx = 1; idx < APU_PULSE_MIX_SIZE; idx++ )
+   {
+      m_pulseMix [ idx ] = (int32_t)((scale*95.88/((8128.0/idx)+100.0))+0.5);
+   }
+   m_tndMix [ 0 ] = 0;
+   for ( idx = 1; idx < APU_TND_MIX_SIZE; idx++ )
+   {
+      m_tndMix [ idx ] = (int32_t)((scale*163.67/((24329.0/idx)+100.0))+0.5);
+   }
+
+   // Each tap of a step's kernel is the part of a Blackman-windowed sinc
+   // impulse (cut off at 80% of the output Nyquist) that falls within
+   // the tap's output sample.  Taps of a phase add up to exactly one so
+   // the level the steps build up never drifts.
+   for ( phase = 0; phase < APU_BLIP_PHASES; phase++ )
+   {
+      sum = 0.0;
+      for ( tap = 0; tap < APU_BLIP_TAPS; tap++ )
       {
-         famp = (95.88/((8128.0/((*(sq1dacSamples+sample))+(*(sq2dacSamples+sample))))+100.0));
+         taps [ tap ] = 0.0;
+         for ( step = 0; step < 32; step++ )
+         {
+            t = tap-(APU_BLIP_TAPS/2)-((phase+0.5)/APU_BLIP_PHASES)+((step+0.5)/32.0);
+            if ( fabs(t) >= (APU_BLIP_TAPS/2) )
+            {
+               continue;
+            }
+            x = M_PI*0.8*t;
+            w = 0.42+(0.5*cos(M_PI*t/(APU_BLIP_TAPS/2)))+(0.08*cos(2.0*M_PI*t/(APU_BLIP_TAPS/2)));
+            taps [ tap ] += (x == 0.0) ? w : ((sin(x)/x)*w);
+         }
+         sum += taps [ tap ];
       }
-      if ( (*(triangleDacSamples+sample))+(*(noiseDacSamples+sample))+(*(dmcDacSamples+sample)) )
+
+      total = 0;
+      for ( tap = 0; tap < APU_BLIP_TAPS; tap++ )
       {
-         famp += (159.79/((1.0/((((*(triangleDacSamples+sample))/8227.0)+((*(noiseDacSamples+sample))/12241.0)+((*(dmcDacSamples+sample))/22638.0))))+100.0));
+         m_blipKernel [ phase ] [ tap ] = (int32_t)floor((taps[tap]*(1<<APU_BLIP_BITS)/sum)+0.5);
+         total += m_blipKernel [ phase ] [ tap ];
       }
-      amp = (int16_t)(float)(65535.0*famp*0.50);
+      m_blipKernel [ phase ] [ APU_BLIP_TAPS/2 ] += (1<<APU_BLIP_BITS)-total;
+   }
+}
 
-      (*(out+sample)) = amp;
+void CAPU::SYNTHESIS ( uint32_t mode )
+{
+   // Start the new mode from the level the mixer is at now.
+   m_state->m_synthesis = mode;
+   m_state->m_mixSum = 0;
+   m_state->m_mixTicks = 0;
+   memset ( m_state->m_blipBuf, 0, sizeof(m_state->m_blipBuf) );
+   m_state->m_blipLevel = m_state->m_mixLast<<APU_BLIP_BITS;
+}
 
-      outDownsampled += (*(out+sample));
+void CAPU::CREATE ( void )
+{
+   m_state->m_square[0].SetChannel ( 0 );
+   m_state->m_square[1].SetChannel ( 1 );
+   m_state->m_triangle.SetChannel ( 2 );
+   m_state->m_noise.SetChannel ( 3 );
+   m_state->m_dmc.SetChannel ( 4 );
+
+   m_state->m_square[0].MUTE(false);
+   m_state->m_square[1].MUTE(false);
+   m_state->m_triangle.MUTE(false);
+   m_state->m_noise.MUTE(false);
+   m_state->m_dmc.MUTE(false);
+
+   m_state->m_waveBuf = new uint16_t [ APU_BUFFER_SIZE ];
+   memset( m_state->m_waveBuf, 0, APU_BUFFER_SIZE * sizeof m_state->m_waveBuf[ 0 ] );
+   m_state->m_playBuf = new uint16_t [ APU_BUFFER_SIZE ];
+   memset( m_state->m_playBuf, 0, APU_BUFFER_SIZE * sizeof m_state->m_playBuf[ 0 ] );
+}
+
+void CAPU::DESTROY ( void )
+{
+   delete [] m_state->m_waveBuf;
+   m_state->m_waveBuf = NULL;
+   delete [] m_state->m_playBuf;
+   m_state->m_playBuf = NULL;
+}
+
+void CAPU::SAVESTATE ( CNESStateWriter& state )
+{
+   SYNC ();
+
+   state.BeginChunk ( NES_STATE_CHUNK_APU, NES_STATE_VERSION_APU );
+   state.Put ( m_state->m_APUreg );
+   state.Put ( m_state->m_irqEnabled );
+   state.Put ( m_state->m_irqAsserted );
+   state.Put ( m_state->m_sequencerMode );
+   state.Put ( m_state->m_newSequencerMode );
+   state.Put ( m_state->m_changeModes );
+   state.Put ( m_state->m_sequenceStep );
+   state.Put ( m_state->m_cycles );
+   state.Put ( m_state->m_sampleSpacer );
+   state.Put ( m_state->m_takeSample );
+   state.Put ( m_state->m_outLast );
+   state.Put ( m_state->m_outDownsampled );
+
+   // The channels are plain data; save them whole.
+   state.Put ( m_state->m_square );
+   state.Put ( m_state->m_triangle );
+   state.Put ( m_state->m_noise );
+   state.Put ( m_state->m_dmc );
+   state.EndChunk ();
+}
+
+bool CAPU::LOADSTATE ( CNESStateReader& state )
+{
+   // Channel muting is a user preference and the DMC sample source
+   // belongs to whoever is driving the APU; neither is machine state.
+   uint8_t  muted = MUTED();
+   uint8_t* dmaSource = m_state->m_dmc.DMASOURCE();
+   bool     ok;
+
+   if ( !state.FindChunk(NES_STATE_CHUNK_APU,NES_STATE_VERSION_APU) )
+   {
+      return false;
+   }
+   ok = state.Get ( m_state->m_APUreg ) &&
+        state.Get ( m_state->m_irqEnabled ) &&
+        state.Get ( m_state->m_irqAsserted ) &&
+        state.Get ( m_state->m_sequencerMode ) &&
+        state.Get ( m_state->m_newSequencerMode ) &&
+        state.Get ( m_state->m_changeModes ) &&
+        state.Get ( m_state->m_sequenceStep ) &&
+        state.Get ( m_state->m_cycles ) &&
+        state.Get ( m_state->m_sampleSpacer ) &&
+        state.Get ( m_state->m_takeSample ) &&
+        state.Get ( m_state->m_outLast ) &&
+        state.Get ( m_state->m_outDownsampled ) &&
+        state.Get ( m_state->m_square ) &&
+        state.Get ( m_state->m_triangle ) &&
+        state.Get ( m_state->m_noise ) &&
+        state.Get ( m_state->m_dmc );
+
+   MUTE ( muted );
+   m_state->m_dmc.DMASOURCE ( dmaSource );
+   RATECONTROL ();
+
+   // Cycles the APU owed belong to the machine being replaced.
+   m_state->m_pendingCycles = 0;
+   m_state->m_syncCycles = 1;
+
+   // Let the debugger refresh every register.
+   memset ( m_state->m_APUregDirty, 1, sizeof(m_state->m_APUregDirty) );
+
+   return ok;
+}
+
+uint8_t* CAPU::PLAY ( uint16_t samples )
+{
+   uint32_t consume = m_state->m_waveBufConsume.load(std::memory_order_relaxed);
+   uint32_t available = m_state->m_waveBufProduce.load(std::memory_order_acquire)-consume;
+   uint32_t idx;
+
+   if ( samples > APU_BUFFER_SIZE )
+   {
+      samples = APU_BUFFER_SIZE;
+   }
+
+   for ( idx = 0; (idx < samples) && (idx < available); idx++ )
+   {
+      m_state->m_playBuf[idx] = m_state->m_waveBuf[(consume+idx)&(APU_BUFFER_SIZE-1)];
+   }
+
+   // Hand the slots back to the emulator thread.
+   m_state->m_waveBufConsume.store(consume+idx,std::memory_order_release);
+
+   if ( idx < samples )
+   {
+      // Underrun.  Hold the last sample played instead of
+      // dropping to zero, which would click.
+      for ( ; idx < samples; idx++ )
+      {
+         m_state->m_playBuf[idx] = m_state->m_playLast;
+      }
+      m_state->m_underruns.fetch_add(1,std::memory_order_relaxed);
+   }
+
+   if ( samples )
+   {
+      m_state->m_playLast = m_state->m_playBuf[samples-1];
+   }
+
+   return (uint8_t*)m_state->m_playBuf;
+}
+
+void CAPU::PRODUCE ( uint16_t sample )
+{
+   uint32_t produce = m_state->m_waveBufProduce.load(std::memory_order_relaxed);
+   uint32_t consume = m_state->m_waveBufConsume.load(std::memory_order_acquire);
+
+   // A full ring means nobody is playing the samples; drop them.
+   if ( (produce-consume) >= APU_BUFFER_SIZE )
+   {
+      m_state->m_overruns.fetch_add(1,std::memory_order_relaxed);
+      return;
+   }
+
+   m_state->m_waveBuf[produce&(APU_BUFFER_SIZE-1)] = sample;
+   produce++;
+   m_state->m_waveBufProduce.store(produce,std::memory_order_release);
+
+   if ( (produce-consume) >= APU_BUFFER_PRERENDER )
+   {
+      nesBreakAudio();
    }
+}
 
-   outDownsampled = (int32_t)((float)outDownsampled/((float)m_square[0].GETDACSAMPLECOUNT()));
+void CAPU::RATECONTROL ( void )
+{
+   float error;
 
-   // Add mapper audio if any.
-   outDownsampled += MAPPERFUNC->amplitude();
+   if ( !m_state->m_fillTarget )
+   {
+      m_state->m_outputSpacer = m_state->m_sampleSpacer;
+      m_state->m_rateAdjust = 0;
+      return;
+   }
+
+   // Space the samples further apart when the ring is fuller than
+   // the target, closer together when it is emptier.
+   error = (float)(SAMPLESAVAILABLE()-(int32_t)m_state->m_fillTarget)/(float)m_state->m_fillTarget;
+   if ( error > 1.0f )
+   {
+      error = 1.0f;
+   }
+   else if ( error < -1.0f )
+   {
+      error = -1.0f;
+   }
 
-   delta = outDownsampled - outLast;
-   outDownsampled = outLast+((delta*65371)/65536); // 65371/65536 is 0.9975 adjusted to 16-bit fixed point.
+   m_state->m_outputSpacer = m_state->m_sampleSpacer*(1.0f+(APU_RATE_CONTROL*error));
+   m_state->m_rateAdjust = (int32_t)(APU_RATE_CONTROL*error*1000000.0f);
+}
 
-   outLast = outDownsampled;
+void CAPU::BLIPSTEP ( int32_t delta )
+{
+   int32_t* kernel;
+   int32_t  phase;
+   int32_t  tap;
+
+   // The change happened this far between the last sample and the next.
+   phase = (int32_t)(m_state->m_takeSample*APU_BLIP_PHASES/m_state->m_outputSpacer);
+   if ( phase >= APU_BLIP_PHASES )
+   {
+      phase = APU_BLIP_PHASES-1;
+   }
+   kernel = m_blipKernel[phase];
+
+   for ( tap = 0; tap < APU_BLIP_TAPS; tap++ )
+   {
+      m_state->m_blipBuf[(m_state->m_blipPos+tap)&(APU_BLIP_BUFFER-1)] += delta*(*(kernel+tap));
+   }
+}
+
+uint16_t CAPU::AMPLITUDE ( void )
+{
+   int32_t out;
+   int16_t delta;
+
+   if ( m_state->m_synthesis == AUDIO_SYNTHESIS_BANDLIMITED )
+   {
+      // The steps are already in the buffer; the sample is the level
+      // they add up to.  Speculative frames leave the buffer alone.
+      if ( !nesIsSpeculative() )
+      {
+         m_state->m_blipLevel += m_state->m_blipBuf[m_state->m_blipPos];
+         m_state->m_blipBuf[m_state->m_blipPos] = 0;
+         m_state->m_blipPos = (m_state->m_blipPos+1)&(APU_BLIP_BUFFER-1);
+      }
+      out = m_state->m_blipLevel>>APU_BLIP_BITS;
+   }
+   else if ( m_state->m_mixTicks )
+   {
+      out = m_state->m_mixSum/m_state->m_mixTicks;
+   }
+   else
+   {
+      out = m_state->m_mixLast;
+   }
+   m_state->m_mixSum = 0;
+   m_state->m_mixTicks = 0;
+
+   // Add mapper audio if any.  Its channels are clocked with the mapper
+   // (see CNES::MAPPERCLOCK), which may be behind the CPU.
+   if ( CNES::MAPPERFUNC()->amplitude != CROM::AMPLITUDE )
+   {
+      CNES::MAPPERSYNC ();
+   }
+   m_state->m_outDownsampled = out+CNES::MAPPERFUNC()->amplitude();
+
+   delta = m_state->m_outDownsampled - m_state->m_outLast;
+   m_state->m_outDownsampled = m_state->m_outLast+((delta*65371)/65536); // 65371/65536 is 0.9975 adjusted to 16-bit fixed point.
+
+   m_state->m_outLast = m_state->m_outDownsampled;
 
    // Reset DAC averaging...
-   m_square[0].CLEARDACAVG();
-   m_square[1].CLEARDACAVG();
-   m_triangle.CLEARDACAVG();
-   m_noise.CLEARDACAVG();
-   m_dmc.CLEARDACAVG();
+   m_state->m_square[0].CLEARDACAVG();
+   m_state->m_square[1].CLEARDACAVG();
+   m_state->m_triangle.CLEARDACAVG();
+   m_state->m_noise.CLEARDACAVG();
+   m_state->m_dmc.CLEARDACAVG();
 
-   return outDownsampled;
+   return m_state->m_outDownsampled;
 }
 
+template<bool Debuggable>
 void CAPU::SEQTICK ( int32_t sequence )
 {
    bool clockedLengthCounter = false;
    bool clockedLinearCounter = false;
 
-   if ( m_sequencerMode )
+   if ( m_state->m_sequencerMode )
    {
       if ( m_seq5[sequence]&APU_SEQ_CLK_ENVELOPE_CTR )
       {
-         m_square[0].CLKENVELOPE ();
-         m_square[1].CLKENVELOPE ();
-         clockedLinearCounter |= m_triangle.CLKLINEARCOUNTER ();
-         m_noise.CLKENVELOPE ();
+         m_state->m_square[0].CLKENVELOPE ();
+         m_state->m_square[1].CLKENVELOPE ();
+         clockedLinearCounter |= m_state->m_triangle.CLKLINEARCOUNTER ();
+         m_state->m_noise.CLKENVELOPE ();
       }
 
       if ( m_seq5[sequence]&APU_SEQ_CLK_LENGTH_CTR )
       {
-         m_square[0].CLKSWEEPUNIT ();
-         clockedLengthCounter |= m_square[0].CLKLENGTHCOUNTER ();
-         m_square[1].CLKSWEEPUNIT ();
-         clockedLengthCounter |= m_square[1].CLKLENGTHCOUNTER ();
-         clockedLengthCounter |= m_triangle.CLKLENGTHCOUNTER ();
-         clockedLengthCounter |= m_noise.CLKLENGTHCOUNTER ();
+         m_state->m_square[0].CLKSWEEPUNIT ();
+         clockedLengthCounter |= m_state->m_square[0].CLKLENGTHCOUNTER ();
+         m_state->m_square[1].CLKSWEEPUNIT ();
+         clockedLengthCounter |= m_state->m_square[1].CLKLENGTHCOUNTER ();
+         clockedLengthCounter |= m_state->m_triangle.CLKLENGTHCOUNTER ();
+         clockedLengthCounter |= m_state->m_noise.CLKLENGTHCOUNTER ();
       }
    }
    else
    {
       if ( m_seq4[sequence]&APU_SEQ_CLK_ENVELOPE_CTR )
       {
-         m_square[0].CLKENVELOPE ();
-         m_square[1].CLKENVELOPE ();
-         clockedLinearCounter |= m_triangle.CLKLINEARCOUNTER ();
-         m_noise.CLKENVELOPE ();
+         m_state->m_square[0].CLKENVELOPE ();
+         m_state->m_square[1].CLKENVELOPE ();
+         clockedLinearCounter |= m_state->m_triangle.CLKLINEARCOUNTER ();
+         m_state->m_noise.CLKENVELOPE ();
       }
 
       if ( m_seq4[sequence]&APU_SEQ_CLK_LENGTH_CTR )
       {
-         m_square[0].CLKSWEEPUNIT ();
-         clockedLengthCounter |= m_square[0].CLKLENGTHCOUNTER ();
-         m_square[1].CLKSWEEPUNIT ();
-         clockedLengthCounter |= m_square[1].CLKLENGTHCOUNTER ();
-         clockedLengthCounter |= m_triangle.CLKLENGTHCOUNTER ();
-         clockedLengthCounter |= m_noise.CLKLENGTHCOUNTER ();
+         m_state->m_square[0].CLKSWEEPUNIT ();
+         clockedLengthCounter |= m_state->m_square[0].CLKLENGTHCOUNTER ();
+         m_state->m_square[1].CLKSWEEPUNIT ();
+         clockedLengthCounter |= m_state->m_square[1].CLKLENGTHCOUNTER ();
+         clockedLengthCounter |= m_state->m_triangle.CLKLENGTHCOUNTER ();
+         clockedLengthCounter |= m_state->m_noise.CLKLENGTHCOUNTER ();
       }
 
       if ( m_seq4[sequence]&APU_SEQ_INT_FLAG )
       {
-         if ( m_irqEnabled )
+         if ( m_state->m_irqEnabled )
          {
-            m_irqAsserted = true;
+            m_state->m_irqAsserted = true;
             C6502::ASSERTIRQ ( eNESSource_APU );
 
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Check for IRQ breakpoint...
                CNES::CHECKBREAKPOINT(eBreakInAPU,eBreakOnAPUEvent,0,APU_EVENT_IRQ);
@@ -490,7 +735,7 @@ void CAPU::SEQTICK ( int32_t sequence )
    }
 
    // Check for Length Counter clocking breakpoint...
-   if ( nesIsDebuggable() )
+   if ( Debuggable )
    {
       if ( clockedLengthCounter )
       {
@@ -532,49 +777,49 @@ void CAPU::RESET ( void )
 
    for ( idx = 0; idx < 32; idx++ )
    {
-      m_APUreg [ idx ] = 0x00;
-      m_APUregDirty [ idx ] = 1;
+      m_state->m_APUreg [ idx ] = 0x00;
+      m_state->m_APUregDirty [ idx ] = 1;
    }
 
-   m_square[0].RESET ();
-   m_square[1].RESET ();
-   m_triangle.RESET ();
-   m_noise.RESET ();
-   m_dmc.RESET ();
+   m_state->m_square[0].RESET ();
+   m_state->m_square[1].RESET ();
+   m_state->m_triangle.RESET ();
+   m_state->m_noise.RESET ();
+   m_state->m_dmc.RESET ();
 
    // Reset DAC averaging...
-   m_square[0].CLEARDACAVG();
-   m_square[1].CLEARDACAVG();
-   m_triangle.CLEARDACAVG();
-   m_noise.CLEARDACAVG();
-   m_dmc.CLEARDACAVG();
-
-   m_irqEnabled = true;
-   m_irqAsserted = false;
+   m_state->m_square[0].CLEARDACAVG();
+   m_state->m_square[1].CLEARDACAVG();
+   m_state->m_triangle.CLEARDACAVG();
+   m_state->m_noise.CLEARDACAVG();
+   m_state->m_dmc.CLEARDACAVG();
+   m_state->m_mixLast = 0;
+   SYNTHESIS ( m_state->m_synthesis );
+
+   m_state->m_irqEnabled = true;
+   m_state->m_irqAsserted = false;
    C6502::RELEASEIRQ ( eNESSource_APU );
-   m_sequencerMode = 0;
-   m_sequenceStep = 0;
-
-   m_waveBufProduce = 0;
-   m_waveBufConsume = 0;
-
-   memset( m_waveBuf, 0, APU_BUFFER_SIZE * sizeof m_waveBuf[ 0 ] );
+   m_state->m_sequencerMode = 0;
+   m_state->m_sequenceStep = 0;
 
    if ( CNES::VIDEOMODE() == MODE_NTSC )
    {
-      m_sampleSpacer = APU_SAMPLE_SPACE_NTSC;
+      m_state->m_sampleSpacer = APU_SAMPLE_SPACE_NTSC;
    }
    else if ( CNES::VIDEOMODE() == MODE_DENDY )
    {
-      m_sampleSpacer = APU_SAMPLE_SPACE_DENDY;
+      m_state->m_sampleSpacer = APU_SAMPLE_SPACE_DENDY;
    }
    else
    {
-      m_sampleSpacer = APU_SAMPLE_SPACE_PAL;
+      m_state->m_sampleSpacer = APU_SAMPLE_SPACE_PAL;
    }
+   RATECONTROL ();
 
-   m_cycles = 0;
-   apuDataAvailable = 0;
+   m_state->m_cycles = 0;
+
+   m_state->m_pendingCycles = 0;
+   m_state->m_syncCycles = 1;
 }
 
 CAPUOscillator::CAPUOscillator (uint8_t periodAdjust) :
@@ -1438,10 +1683,13 @@ void CAPUDMC::TIMERTICK ( void )
    }
 }
 
+template<bool Debuggable>
 void CAPU::EMULATE ( void )
 {
-   static float takeSample = 0.0f;
-   uint16_t* pWaveBuf;
+   uint16_t sample;
+   int32_t  mix;
+
+   NESPERFSCOPE ( eNESPerf_APU );
 
    // Handle APU clock jitter.  Mode changes occur
    // only on even APU clocks.  On a mode change write
@@ -1449,24 +1697,24 @@ void CAPU::EMULATE ( void )
    // 1 indicating that the mode change should happen
    // in 0 or 1 clocks from now.  Do the mode change
    // when m_changeModes is 0; decrement it if it isn't 0.
-   if ( m_changeModes == 0 )
+   if ( m_state->m_changeModes == 0 )
    {
       // Do mode-change now...
-      m_changeModes--;
-      m_sequencerMode = m_newSequencerMode;
-      m_sequenceStep = 0;
+      m_state->m_changeModes--;
+      m_state->m_sequencerMode = m_state->m_newSequencerMode;
+      m_state->m_sequenceStep = 0;
       RESETCYCLECOUNTER(0);
 
-      if ( nesIsDebuggable() )
+      if ( Debuggable )
       {
          // Emit frame-start indication to Tracer...
          CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_StartAPUFrame, eNESSource_APU, 0, 0, 0 );
       }
    }
 
-   if ( m_changeModes > 0 )
+   if ( m_state->m_changeModes > 0 )
    {
-      m_changeModes--;
+      m_state->m_changeModes--;
    }
 
    // Clock the 240Hz sequencer.
@@ -1474,51 +1722,51 @@ void CAPU::EMULATE ( void )
    if ( (CNES::VIDEOMODE() == MODE_NTSC) || (CNES::VIDEOMODE() == MODE_DENDY) )
    {
       // APU sequencer mode 1
-      if ( m_sequencerMode )
+      if ( m_state->m_sequencerMode )
       {
-         if ( m_cycles == 1 )
+         if ( m_state->m_cycles == 1 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
             }
 
-            SEQTICK ( 0 );
+            SEQTICK<Debuggable> ( 0 );
          }
-         else if ( m_cycles == 7459 )
+         else if ( m_state->m_cycles == 7459 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
             }
 
-            SEQTICK ( 1 );
+            SEQTICK<Debuggable> ( 1 );
          }
-         else if ( m_cycles == 14915 )
+         else if ( m_state->m_cycles == 14915 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
             }
 
-            SEQTICK ( 2 );
+            SEQTICK<Debuggable> ( 2 );
          }
-         else if ( m_cycles == 22373 )
+         else if ( m_state->m_cycles == 22373 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
             }
 
-            SEQTICK ( 3 );
+            SEQTICK<Debuggable> ( 3 );
          }
-         else if ( m_cycles == 29829 )
+         else if ( m_state->m_cycles == 29829 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
@@ -1530,61 +1778,61 @@ void CAPU::EMULATE ( void )
       // APU sequencer mode 0
       else
       {
-         if ( m_cycles == 7459 )
+         if ( m_state->m_cycles == 7459 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
             }
 
-            SEQTICK ( 0 );
+            SEQTICK<Debuggable> ( 0 );
          }
-         else if ( m_cycles == 14915 )
+         else if ( m_state->m_cycles == 14915 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
             }
 
-            SEQTICK ( 1 );
+            SEQTICK<Debuggable> ( 1 );
          }
-         else if ( m_cycles == 22373 )
+         else if ( m_state->m_cycles == 22373 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
             }
 
-            SEQTICK ( 2 );
+            SEQTICK<Debuggable> ( 2 );
          }
-         else if ( (m_cycles == 29830) ||
-                   (m_cycles == 29832) )
+         else if ( (m_state->m_cycles == 29830) ||
+                   (m_state->m_cycles == 29832) )
          {
-            if ( m_irqEnabled )
+            if ( m_state->m_irqEnabled )
             {
-               m_irqAsserted = true;
+               m_state->m_irqAsserted = true;
                C6502::ASSERTIRQ(eNESSource_APU);
 
-               if ( nesIsDebuggable() )
+               if ( Debuggable )
                {
                   // Check for IRQ breakpoint...
                   CNES::CHECKBREAKPOINT(eBreakInAPU,eBreakOnAPUEvent,0,APU_EVENT_IRQ);
                }
             }
          }
-         else if ( m_cycles == 29831 )
+         else if ( m_state->m_cycles == 29831 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
             }
 
             // IRQ asserted inside SEQTICK...
-            SEQTICK ( 3 );
+            SEQTICK<Debuggable> ( 3 );
          }
       }
    }
@@ -1592,51 +1840,51 @@ void CAPU::EMULATE ( void )
    else
    {
       // APU sequencer mode 1
-      if ( m_sequencerMode )
+      if ( m_state->m_sequencerMode )
       {
-         if ( m_cycles == 1 )
+         if ( m_state->m_cycles == 1 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
             }
 
-            SEQTICK ( 0 );
+            SEQTICK<Debuggable> ( 0 );
          }
-         else if ( m_cycles == 8315 )
+         else if ( m_state->m_cycles == 8315 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
             }
 
-            SEQTICK ( 1 );
+            SEQTICK<Debuggable> ( 1 );
          }
-         else if ( m_cycles == 16629 )
+         else if ( m_state->m_cycles == 16629 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
             }
 
-            SEQTICK ( 2 );
+            SEQTICK<Debuggable> ( 2 );
          }
-         else if ( m_cycles == 24941 )
+         else if ( m_state->m_cycles == 24941 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
             }
 
-            SEQTICK ( 3 );
+            SEQTICK<Debuggable> ( 3 );
          }
-         else if ( m_cycles == 33255 )
+         else if ( m_state->m_cycles == 33255 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
@@ -1648,81 +1896,109 @@ void CAPU::EMULATE ( void )
       // APU sequencer mode 0
       else
       {
-         if ( m_cycles == 8315 )
+         if ( m_state->m_cycles == 8315 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
             }
 
-            SEQTICK ( 0 );
+            SEQTICK<Debuggable> ( 0 );
          }
-         else if ( m_cycles == 16629 )
+         else if ( m_state->m_cycles == 16629 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
             }
 
-            SEQTICK ( 1 );
+            SEQTICK<Debuggable> ( 1 );
          }
-         else if ( m_cycles == 24941 )
+         else if ( m_state->m_cycles == 24941 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
             }
 
-            SEQTICK ( 2 );
+            SEQTICK<Debuggable> ( 2 );
          }
-         else if ( (m_cycles == 33254) ||
-                   (m_cycles == 33256) )
+         else if ( (m_state->m_cycles == 33254) ||
+                   (m_state->m_cycles == 33256) )
          {
-            if ( m_irqEnabled )
+            if ( m_state->m_irqEnabled )
             {
-               m_irqAsserted = true;
+               m_state->m_irqAsserted = true;
                C6502::ASSERTIRQ(eNESSource_APU);
 
-               if ( nesIsDebuggable() )
+               if ( Debuggable )
                {
                   // Check for IRQ breakpoint...
                   CNES::CHECKBREAKPOINT(eBreakInAPU,eBreakOnAPUEvent,0,APU_EVENT_IRQ);
                }
             }
          }
-         else if ( m_cycles == 33255 )
+         else if ( m_state->m_cycles == 33255 )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
                // Emit frame-end indication to Tracer...
                CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_SequencerStep, eNESSource_APU, 0, 0, 0 );
             }
 
             // IRQ asserted inside SEQTICK...
-            SEQTICK ( 3 );
+            SEQTICK<Debuggable> ( 3 );
          }
       }
    }
 
    // Clock the individual channels.
-   m_square[0].TIMERTICK ();
-   m_square[1].TIMERTICK ();
-   m_triangle.TIMERTICK ();
-   m_noise.TIMERTICK ();
-   m_dmc.TIMERTICK ();
+   m_state->m_square[0].TIMERTICK ();
+   m_state->m_square[1].TIMERTICK ();
+   m_state->m_triangle.TIMERTICK ();
+   m_state->m_noise.TIMERTICK ();
+   m_state->m_dmc.TIMERTICK ();
+
+   // Mix the channels.
+   mix = m_pulseMix[m_state->m_square[0].GETDAC()+m_state->m_square[1].GETDAC()]+
+         m_tndMix[(3*m_state->m_triangle.GETDAC())+(2*m_state->m_noise.GETDAC())+m_state->m_dmc.GETDAC()];
+
+   if ( m_state->m_synthesis == AUDIO_SYNTHESIS_BANDLIMITED )
+   {
+      // Speculative frames are rolled back; their steps must not be
+      // heard, nor the level they leave the mixer at.
+      if ( (mix != m_state->m_mixLast) && (!nesIsSpeculative()) )
+      {
+         BLIPSTEP ( mix-m_state->m_mixLast );
+         m_state->m_mixLast = mix;
+      }
+   }
+   else
+   {
+      m_state->m_mixSum += mix;
+      m_state->m_mixTicks++;
+      m_state->m_mixLast = mix;
+   }
 
    // Generate audio samples.
-   takeSample += 1.0;
+   m_state->m_takeSample += 1.0;
 
-   if ( takeSample >= m_sampleSpacer )
+   if ( m_state->m_takeSample >= m_state->m_outputSpacer )
    {
-      takeSample -= m_sampleSpacer;
+      m_state->m_takeSample -= m_state->m_outputSpacer;
 
-      pWaveBuf = m_waveBuf+m_waveBufProduce;
-      (*pWaveBuf) = AMPLITUDE ();
+      // Speculative (run-ahead) frames are thrown away, and so is
+      // their audio.  The mixer still runs, it resets the DAC averaging.
+      if ( nesIsSpeculative() )
+      {
+         AMPLITUDE ();
+      }
+      else
+      {
+         sample = AMPLITUDE ();
 
 #if defined ( OUTPUT_WAV )
 if ( wavOut )
@@ -1734,7 +2010,7 @@ if ( wavOut )
 //   fwrite(&t,1,1,wavOut);
 //   fwrite(&n,1,1,wavOut);
 //   fwrite(&d,1,1,wavOut);
-   fwrite(&(*pWaveBuf),1,2,wavOut);
+   fwrite(&sample,1,2,wavOut);
    wavFileSize += 2;
    if ( wavFileSize == 88200*200 )
    {
@@ -1744,26 +2020,22 @@ if ( wavOut )
 }
 #endif
 
-      m_waveBufProduce++;
-
-      m_waveBufProduce %= m_sampleBufferSize;
-
-      apuDataAvailable++;
-
-      if ( apuDataAvailable >= APU_BUFFER_PRERENDER )
-      {
-         nesBreakAudio();
+         // Frames skipped while fast-forwarding are not heard.
+         if ( !nesIsFrameSkipped() )
+         {
+            PRODUCE ( sample );
+         }
       }
    }
 
    // Go to next cycle and restart if necessary...
-   m_cycles++;
+   m_state->m_cycles++;
 
    if ( (CNES::VIDEOMODE() == MODE_NTSC) || (CNES::VIDEOMODE() == MODE_DENDY) )
    {
-      if ( (m_sequencerMode) && (m_cycles >= 37283) )
+      if ( (m_state->m_sequencerMode) && (m_state->m_cycles >= 37283) )
       {
-         if ( nesIsDebuggable() )
+         if ( Debuggable )
          {
             // Emit frame-end indication to Tracer...
             CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_EndAPUFrame, eNESSource_APU, 0, 0, 0 );
@@ -1771,15 +2043,15 @@ if ( wavOut )
 
          RESETCYCLECOUNTER(1);
 
-         if ( nesIsDebuggable() )
+         if ( Debuggable )
          {
             // Emit frame-start indication to Tracer...
             CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_StartAPUFrame, eNESSource_APU, 0, 0, 0 );
          }
       }
-      else if ( (!m_sequencerMode) && (m_cycles >= 37289) )
+      else if ( (!m_state->m_sequencerMode) && (m_state->m_cycles >= 37289) )
       {
-         if ( nesIsDebuggable() )
+         if ( Debuggable )
          {
             // Emit frame-end indication to Tracer...
             CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_EndAPUFrame, eNESSource_APU, 0, 0, 0 );
@@ -1787,7 +2059,7 @@ if ( wavOut )
 
          RESETCYCLECOUNTER(7459);
 
-         if ( nesIsDebuggable() )
+         if ( Debuggable )
          {
             // Emit frame-start indication to Tracer...
             CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_StartAPUFrame, eNESSource_APU, 0, 0, 0 );
@@ -1796,9 +2068,9 @@ if ( wavOut )
    }
    else // MODE_PAL
    {
-      if ( (m_sequencerMode) && (m_cycles >= 41567) )
+      if ( (m_state->m_sequencerMode) && (m_state->m_cycles >= 41567) )
       {
-         if ( nesIsDebuggable() )
+         if ( Debuggable )
          {
             // Emit frame-end indication to Tracer...
             CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_EndAPUFrame, eNESSource_APU, 0, 0, 0 );
@@ -1806,15 +2078,15 @@ if ( wavOut )
 
          RESETCYCLECOUNTER(1);
 
-         if ( nesIsDebuggable() )
+         if ( Debuggable )
          {
             // Emit frame-start indication to Tracer...
             CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_StartAPUFrame, eNESSource_APU, 0, 0, 0 );
          }
       }
-      else if ( (!m_sequencerMode) && (m_cycles >= 41569) )
+      else if ( (!m_state->m_sequencerMode) && (m_state->m_cycles >= 41569) )
       {
-         if ( nesIsDebuggable() )
+         if ( Debuggable )
          {
             // Emit frame-end indication to Tracer...
             CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_EndAPUFrame, eNESSource_APU, 0, 0, 0 );
@@ -1822,7 +2094,7 @@ if ( wavOut )
 
          RESETCYCLECOUNTER(8315);
 
-         if ( nesIsDebuggable() )
+         if ( Debuggable )
          {
             // Emit frame-start indication to Tracer...
             CNES::TRACER()->AddSample ( CAPU::CYCLES(), eTracer_StartAPUFrame, eNESSource_APU, 0, 0, 0 );
@@ -1831,9 +2103,159 @@ if ( wavOut )
    }
 }
 
+void CAPU::SYNC ( void )
+{
+   if ( m_state->m_pendingCycles )
+   {
+      CATCHUP ();
+   }
+
+   // The caller is about to look at or change the APU, which may move
+   // its next event; work it out again on the next cycle.
+   m_state->m_syncCycles = 1;
+}
+
+void CAPU::CATCHUP ( void )
+{
+   uint32_t cycles = m_state->m_pendingCycles;
+   uint32_t quiet;
+   uint32_t next;
+
+   m_state->m_pendingCycles = 0;
+
+   while ( cycles )
+   {
+      // Run the first cycle, and every cycle something happens on,
+      // in full.  Skip the cycles in between.
+      EMULATE<false> ();
+      cycles--;
+
+      quiet = QUIETCYCLES ();
+      if ( quiet > cycles )
+      {
+         quiet = cycles;
+      }
+      if ( quiet )
+      {
+         QUIET ( quiet );
+         cycles -= quiet;
+      }
+   }
+
+   // Find the next cycle the rest of the machine would notice the APU
+   // not having run.  Sequencer steps cover the frame IRQ.
+   if ( m_state->m_changeModes >= 0 )
+   {
+      next = 1;
+   }
+   else
+   {
+      next = SEQUENCERCYCLES()+1;
+   }
+
+   quiet = m_state->m_dmc.DMACYCLES ();
+   if ( quiet && (quiet < next) )
+   {
+      next = quiet;
+   }
+
+   // Mappers with their own audio are asked for it with every sample.
+   if ( CNES::MAPPERFUNC()->amplitude != CROM::AMPLITUDE )
+   {
+      quiet = SAMPLECYCLES()+1;
+      if ( quiet < next )
+      {
+         next = quiet;
+      }
+   }
+
+   m_state->m_syncCycles = next;
+}
+
+uint32_t CAPU::SEQUENCERCYCLES ( void )
+{
+   uint32_t* events = m_seqEvents[(CNES::VIDEOMODE() == MODE_NTSC) || (CNES::VIDEOMODE() == MODE_DENDY) ? 0 : 1][m_state->m_sequencerMode ? 1 : 0];
+   int32_t   idx;
+
+   for ( idx = 0; idx < APU_SEQ_EVENTS; idx++ )
+   {
+      if ( events[idx] >= m_state->m_cycles )
+      {
+         return events[idx]-m_state->m_cycles;
+      }
+   }
+
+   return 0;
+}
+
+uint32_t CAPU::SAMPLECYCLES ( void )
+{
+   // Leave a little more room than the rounding m_takeSample
+   // picks up adding up to it one cycle at a time.
+   float room = m_state->m_outputSpacer-m_state->m_takeSample-0.01f;
+
+   return (room > 0.0f) ? (uint32_t)room : 0;
+}
+
+uint32_t CAPU::QUIETCYCLES ( void )
+{
+   uint32_t quiet [ 6 ];
+   uint32_t cycles;
+   int32_t  idx;
+
+   if ( m_state->m_changeModes >= 0 )
+   {
+      return 0;
+   }
+
+   quiet[0] = m_state->m_square[0].QUIETCYCLES();
+   quiet[1] = m_state->m_square[1].QUIETCYCLES();
+   quiet[2] = m_state->m_triangle.QUIETCYCLES();
+   quiet[3] = m_state->m_noise.QUIETCYCLES();
+   quiet[4] = m_state->m_dmc.QUIETCYCLES();
+   quiet[5] = SAMPLECYCLES();
+
+   cycles = SEQUENCERCYCLES ();
+   for ( idx = 0; idx < 6; idx++ )
+   {
+      if ( quiet[idx] < cycles )
+      {
+         cycles = quiet[idx];
+      }
+   }
+
+   return cycles;
+}
+
+void CAPU::QUIET ( uint32_t cycles )
+{
+   // Every channel's DAC, and so the mixer, holds its level.
+   m_state->m_square[0].SKIPDIVIDER ( cycles );
+   m_state->m_square[1].SKIPDIVIDER ( cycles );
+   m_state->m_triangle.SKIPDIVIDER ( cycles );
+   m_state->m_noise.SKIPDIVIDER ( cycles );
+   m_state->m_dmc.SKIPDIVIDER ( cycles );
+
+   if ( m_state->m_synthesis != AUDIO_SYNTHESIS_BANDLIMITED )
+   {
+      m_state->m_mixSum += m_state->m_mixLast*cycles;
+      m_state->m_mixTicks += cycles;
+   }
+
+   m_state->m_cycles += cycles;
+
+   // Add up m_takeSample the way EMULATE does so samples are
+   // taken on the same cycles.
+   while ( cycles )
+   {
+      m_state->m_takeSample += 1.0;
+      cycles--;
+   }
+}
+
 void CAPU::RELEASEIRQ ( void )
 {
-   if ( (!m_irqAsserted) && (!m_dmc.IRQASSERTED()) )
+   if ( (!m_state->m_irqAsserted) && (!m_state->m_dmc.IRQASSERTED()) )
    {
       C6502::RELEASEIRQ ( eNESSource_APU );
    }
@@ -1845,15 +2267,17 @@ uint32_t CAPU::APU ( uint32_t addr )
 
    if ( addr == APUCTRL )
    {
-      data |= (m_square[0].LENGTH()?0x01:0x00);
-      data |= (m_square[1].LENGTH()?0x02:0x00);
-      data |= (m_triangle.LENGTH()?0x04:0x00);
-      data |= (m_noise.LENGTH()?0x08:0x00);
-      data |= (m_dmc.LENGTH()?0x10:0x00);
-      data |= (m_irqAsserted?0x40:0x00);
-      data |= (m_dmc.IRQASSERTED()?0x80:0x00);
+      SYNC ();
 
-      m_irqAsserted = false;
+      data |= (m_state->m_square[0].LENGTH()?0x01:0x00);
+      data |= (m_state->m_square[1].LENGTH()?0x02:0x00);
+      data |= (m_state->m_triangle.LENGTH()?0x04:0x00);
+      data |= (m_state->m_noise.LENGTH()?0x08:0x00);
+      data |= (m_state->m_dmc.LENGTH()?0x10:0x00);
+      data |= (m_state->m_irqAsserted?0x40:0x00);
+      data |= (m_state->m_dmc.IRQASSERTED()?0x80:0x00);
+
+      m_state->m_irqAsserted = false;
       CAPU::RELEASEIRQ ();
 
       if ( nesIsDebuggable() )
@@ -1873,57 +2297,59 @@ uint32_t CAPU::APU ( uint32_t addr )
 
 void CAPU::APU ( uint32_t addr, uint8_t data )
 {
+   SYNC ();
+
    // For APU recording...
-   m_APUreg [ addr&0x1F ] = data;
-   m_APUregDirty [ addr&0x1F ] = 1;
+   m_state->m_APUreg [ addr&0x1F ] = data;
+   m_state->m_APUregDirty [ addr&0x1F ] = 1;
 
    if ( addr < 0x4004 )
    {
       // Square 1
-      m_square[0].APU ( addr&0x3, data );
+      m_state->m_square[0].APU ( addr&0x3, data );
    }
    else if ( addr < 0x4008 )
    {
       // Square 2
-      m_square[1].APU ( addr&0x3, data );
+      m_state->m_square[1].APU ( addr&0x3, data );
    }
    else if ( addr < 0x400C )
    {
       // Triangle
-      m_triangle.APU ( addr&0x3, data );
+      m_state->m_triangle.APU ( addr&0x3, data );
    }
    else if ( addr < 0x4010 )
    {
       // Noise
-      m_noise.APU ( addr&0x3, data );
+      m_state->m_noise.APU ( addr&0x3, data );
    }
    else if ( addr < 0x4014 )
    {
       // DMC
-      m_dmc.APU ( addr&0x3, data );
+      m_state->m_dmc.APU ( addr&0x3, data );
    }
    else if ( addr == APUCTRL )
    {
-      m_square[0].ENABLE ( !!(data&0x01) );
-      m_square[1].ENABLE ( !!(data&0x02) );
-      m_triangle.ENABLE ( !!(data&0x04) );
-      m_noise.ENABLE ( !!(data&0x08) );
-      m_dmc.ENABLE ( !!(data&0x10) );
+      m_state->m_square[0].ENABLE ( !!(data&0x01) );
+      m_state->m_square[1].ENABLE ( !!(data&0x02) );
+      m_state->m_triangle.ENABLE ( !!(data&0x04) );
+      m_state->m_noise.ENABLE ( !!(data&0x08) );
+      m_state->m_dmc.ENABLE ( !!(data&0x10) );
    }
    else if ( addr == 0x4017 )
    {
-      m_newSequencerMode = data&0x80;
-      m_irqEnabled = !(data&0x40);
+      m_state->m_newSequencerMode = data&0x80;
+      m_state->m_irqEnabled = !(data&0x40);
 
-      if ( !m_irqEnabled )
+      if ( !m_state->m_irqEnabled )
       {
-         m_irqAsserted = false;
-         m_dmc.IRQASSERTED(false);
+         m_state->m_irqAsserted = false;
+         m_state->m_dmc.IRQASSERTED(false);
          CAPU::RELEASEIRQ ();
       }
 
       // Change modes on even cycle...
-      m_changeModes = C6502::_CYCLES()&1;
+      m_state->m_changeModes = C6502::_CYCLES()&1;
    }
 
    if ( nesIsDebuggable() )
@@ -1932,3 +2358,7 @@ void CAPU::APU ( uint32_t addr, uint8_t data )
    }
 }
 
+
+// The APU cycles the CPU chooses between.
+template void CAPU::EMULATE<false> ( void );
+template void CAPU::EMULATE<true> ( void );
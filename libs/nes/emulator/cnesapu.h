@@ -7,14 +7,37 @@
 #include "cbreakpointinfo.h"
 
 #include "cnes.h"
+#include "cnesstate.h"
 
+#include <atomic>
+
+// Output sample ring.  Its size must be a power of two.
 #define NUM_APU_BUFS 16
 #define APU_BUFFER_SIZE (NUM_APU_BUFS*APU_SAMPLES)
 
+// Furthest dynamic rate control moves the output rate from nominal
+// (see nesSetAudioBufferTarget).
+#define APU_RATE_CONTROL 0.005f
+
 // APU mask register ($4017) bit definitions.
 #define APUSTATUS_FIVEFRAMES 0x80
 #define APUSTATUS_IRQDISABLE 0x40
 
+// Entries in the mixer's lookup tables.  The pulse table is indexed by
+// square1+square2, the TND table by 3*triangle+2*noise+dmc.
+#define APU_PULSE_MIX_SIZE 31
+#define APU_TND_MIX_SIZE   203
+
+// Band-limited step synthesis (see nesSetAudioSynthesis).  A change in
+// the mixer's output is spread over APU_BLIP_TAPS output samples by a
+// windowed-sinc step, picked by where between two output samples the
+// change happened (one of APU_BLIP_PHASES positions).  Steps are kept
+// in APU_BLIP_BITS fixed point in a ring of APU_BLIP_BUFFER samples.
+#define APU_BLIP_PHASES 32
+#define APU_BLIP_TAPS   16
+#define APU_BLIP_BITS   14
+#define APU_BLIP_BUFFER 32
+
 // The CAPUOscillator class is the base class of all of the
 // sound channels within the APU.  There are five sound channels.
 // Each sound channel has behavior that is identical to all
@@ -106,6 +129,26 @@ public:
    // appropriate waveform.
    inline uint32_t CLKDIVIDER ( void );
 
+   // The number of APU cycles the divider will count through before
+   // the cycle it emits its next clock edge on, and a way to count
+   // through some of them at once.  Nothing else about a channel
+   // changes on those cycles, so the APU can skip them (see CAPU::CATCHUP).
+   inline uint32_t QUIETCYCLES ( void )
+   {
+      if ( !m_period )
+      {
+         return 0xFFFFFFFF;
+      }
+      return m_periodCounter?m_periodCounter-1:0;
+   }
+   inline void SKIPDIVIDER ( uint32_t cycles )
+   {
+      if ( m_period )
+      {
+         m_periodCounter -= cycles;
+      }
+   }
+
    // These routines set/get the channels' DAC value.
    inline void SETDAC ( uint8_t dac )
    {
@@ -474,6 +517,18 @@ public:
    // channel elements to fetch sample data using DMA.
    void TIMERTICK ( void );
 
+   // The number of APU cycles up to and including the one on which the
+   // channel will next ask the CPU for a sample byte, or 0 if it won't
+   // without a register write first.
+   inline uint32_t DMACYCLES ( void )
+   {
+      if ( (!m_sampleBufferFull) || (!m_lengthCounter) || m_dmaSource || (!m_period) )
+      {
+         return 0;
+      }
+      return QUIETCYCLES()+1+(m_outputShiftCounter*(m_period+m_periodAdjust));
+   }
+
    // The delta-modulation channel requires special handling of writes
    // to $4015 because it has an internal interrupt generator that is
    // acknowledged and it restarts sample playback if appropriate to do so.
@@ -492,6 +547,10 @@ public:
       m_dmaSource = source;
       m_dmaSourcePtr = source;
    }
+   uint8_t* DMASOURCE ( void ) const
+   {
+      return m_dmaSource;
+   }
 
    void DMASAMPLE ( uint8_t data );
 
@@ -590,85 +649,193 @@ class CAPU
 public:
    CAPU();
 
+   // Allocate/free the resources owned by the selected machine.
+   static void CREATE ( void );
+   static void DESTROY ( void );
+
+   // Save/restore the selected machine's APU and channel state to/from a binary save-state.
+   static void SAVESTATE ( CNESStateWriter& state );
+   static bool LOADSTATE ( CNESStateReader& state );
+
    static void RESET ( void );
    static uint32_t APU ( uint32_t addr );
    static void APU ( uint32_t addr, uint8_t data );
-   static void EMULATE ( void );
+
+   // Run one APU cycle.  Debuggable=false leaves the tracer and
+   // breakpoint checks out.
+   template<bool Debuggable> static void EMULATE ( void );
+
+   // The CPU calls this once per cycle.  Without the debugger watching
+   // the APU runs behind the CPU: cycles are only counted here and are
+   // caught up later, either when something outside the APU is about
+   // to look at or change it, or on the cycle of the next thing the APU
+   // does that the rest of the machine can see (a frame IRQ, a DMC DMA
+   // fetch, a sample for a mapper with its own audio).
+   template<bool Debuggable> static inline void CLOCK ( void )
+   {
+      if ( Debuggable )
+      {
+         if ( m_state->m_pendingCycles )
+         {
+            SYNC ();
+         }
+         EMULATE<true> ();
+
+         // Nothing has been predicted for the cycles run here.
+         m_state->m_syncCycles = 1;
+      }
+      else
+      {
+         m_state->m_pendingCycles++;
+
+         if ( m_state->m_pendingCycles >= m_state->m_syncCycles )
+         {
+            CATCHUP ();
+         }
+      }
+   }
+
+   // How many more cycles CLOCK can count before the APU has to catch
+   // up, and a way to count that many at once for a CPU skipping ahead.
+   static inline uint32_t IDLECYCLES ( void )
+   {
+      return m_state->m_syncCycles-m_state->m_pendingCycles-1;
+   }
+   static inline void CLOCKIDLE ( uint32_t cycles )
+   {
+      m_state->m_pendingCycles += cycles;
+   }
+
+   // Run the cycles the APU is behind the CPU.
+   static void SYNC ( void );
+
+   // The output samples go through a single-producer, single-consumer
+   // ring.  EMULATE is the producer; PLAY and CLEARSAMPLESAVAILABLE are
+   // the consumer and may run on another thread, say an audio callback.
+   // PLAY always returns the number of samples asked for, holding the
+   // last one through an underrun.  The buffer it returns is good until
+   // the next PLAY.
    static uint8_t* PLAY ( uint16_t samples );
+   static inline int32_t SAMPLESAVAILABLE ( void )
+   {
+      return m_state->m_waveBufProduce.load(std::memory_order_acquire)-
+             m_state->m_waveBufConsume.load(std::memory_order_acquire);
+   }
+   static inline void CLEARSAMPLESAVAILABLE ( void )
+   {
+      m_state->m_waveBufConsume.store(m_state->m_waveBufProduce.load(std::memory_order_acquire),std::memory_order_release);
+   }
+   static inline uint32_t UNDERRUNS ( void )
+   {
+      return m_state->m_underruns.load(std::memory_order_relaxed);
+   }
+   static inline uint32_t OVERRUNS ( void )
+   {
+      return m_state->m_overruns.load(std::memory_order_relaxed);
+   }
+
+   // Dynamic rate control.  Once a frame the output rate is moved by
+   // up to APU_RATE_CONTROL to bring the ring's fill towards the target;
+   // a target of 0 holds the nominal rate.
+   static void RATECONTROL ( void );
+   static inline void FILLTARGET ( uint32_t samples )
+   {
+      m_state->m_fillTarget = samples;
+   }
+   static inline int32_t RATEADJUST ( void )
+   {
+      return m_state->m_rateAdjust;
+   }
 
    static void DMASOURCE ( uint8_t* source )
    {
-      m_dmc.DMASOURCE ( source );
+      m_state->m_dmc.DMASOURCE ( source );
    }
 
    static void DMASAMPLE ( uint8_t data )
    {
-      m_dmc.DMASAMPLE ( data );
+      SYNC ();
+      m_state->m_dmc.DMASAMPLE ( data );
    }
 
    static uint8_t MUTED ( void )
    {
-      return ( (!m_square[0].MUTED())|
-               ((!m_square[1].MUTED())<<1)|
-               ((!m_triangle.MUTED())<<2)|
-               ((!m_noise.MUTED())<<3)|
-               ((!m_dmc.MUTED())<<4) );
+      return ( (!m_state->m_square[0].MUTED())|
+               ((!m_state->m_square[1].MUTED())<<1)|
+               ((!m_state->m_triangle.MUTED())<<2)|
+               ((!m_state->m_noise.MUTED())<<3)|
+               ((!m_state->m_dmc.MUTED())<<4) );
    }
    static void MUTE ( uint8_t mask )
    {
-      m_square[0].MUTE(!(mask&0x01));
-      m_square[1].MUTE(!(mask&0x02));
-      m_triangle.MUTE(!(mask&0x04));
-      m_noise.MUTE(!(mask&0x08));
-      m_dmc.MUTE(!(mask&0x10));
+      m_state->m_square[0].MUTE(!(mask&0x01));
+      m_state->m_square[1].MUTE(!(mask&0x02));
+      m_state->m_triangle.MUTE(!(mask&0x04));
+      m_state->m_noise.MUTE(!(mask&0x08));
+      m_state->m_dmc.MUTE(!(mask&0x10));
    }
 
    static uint32_t _APU ( uint32_t addr )
    {
-      return *(m_APUreg+(addr&0x1F));
+      return *(m_state->m_APUreg+(addr&0x1F));
    }
    static void _APU ( uint32_t addr, uint8_t data )
    {
-      *(m_APUreg+(addr&0x1F)) = data;
+      *(m_state->m_APUreg+(addr&0x1F)) = data;
    }
    static inline uint8_t DIRTY ( uint32_t addr )
    {
-      uint8_t updated = *(m_APUregDirty+(addr&0x1F));
-      *(m_APUregDirty+(addr&0x1F))=0;
+      uint8_t updated = *(m_state->m_APUregDirty+(addr&0x1F));
+      *(m_state->m_APUregDirty+(addr&0x1F))=0;
       return updated;
    }
 
    static void RELEASEIRQ ( void );
-   static inline void SEQTICK ( int32_t sequence );
+   template<bool Debuggable> static inline void SEQTICK ( int32_t sequence );
    static inline uint16_t AMPLITUDE ( void );
 
+   // Select how the mixer's output is turned into samples; one of the
+   // AUDIO_SYNTHESIS_* modes.
+   static void SYNTHESIS ( uint32_t mode );
+
+   // Non-linear mixer levels, in 16-bit sample units.  pulse is
+   // square1+square2, tnd is 3*triangle+2*noise+dmc.
+   static inline int32_t PULSEMIX ( uint32_t pulse )
+   {
+      return m_pulseMix[pulse];
+   }
+   static inline int32_t TNDMIX ( uint32_t tnd )
+   {
+      return m_tndMix[tnd];
+   }
+
    static inline void RESETCYCLECOUNTER ( uint32_t cycle )
    {
-      m_cycles = cycle;
+      m_state->m_cycles = cycle;
    }
    static inline uint32_t CYCLES ( void )
    {
-      return m_cycles;
+      return m_state->m_cycles;
    }
 
    static int32_t SEQUENCERMODE ( void )
    {
-      return m_sequencerMode;
+      return m_state->m_sequencerMode;
    }
 
    // INTERNAL ACCESSOR FUNCTIONS
    // These are called directly.
    static void LENGTHCOUNTERS ( uint16_t* sq1, uint16_t* sq2, uint16_t* triangle, uint16_t* noise, uint16_t* dmc )
    {
-      (*sq1) = m_square[0].LENGTHCOUNTER();
-      (*sq2) = m_square[1].LENGTHCOUNTER();
-      (*triangle) = m_triangle.LENGTHCOUNTER();
-      (*noise) = m_noise.LENGTHCOUNTER();
-      (*dmc) = m_dmc.LENGTHCOUNTER();
+      (*sq1) = m_state->m_square[0].LENGTHCOUNTER();
+      (*sq2) = m_state->m_square[1].LENGTHCOUNTER();
+      (*triangle) = m_state->m_triangle.LENGTHCOUNTER();
+      (*noise) = m_state->m_noise.LENGTHCOUNTER();
+      (*dmc) = m_state->m_dmc.LENGTHCOUNTER();
    }
    static void LINEARCOUNTER ( uint8_t* triangle )
    {
-      (*triangle) = m_triangle.LINEARCOUNTER();
+      (*triangle) = m_state->m_triangle.LINEARCOUNTER();
    }
    static void GETDACS ( uint8_t* square1,
                          uint8_t* square2,
@@ -676,27 +843,27 @@ public:
                          uint8_t* noise,
                          uint8_t* dmc )
    {
-      (*square1) = m_square[0].GETDAC();
-      (*square2) = m_square[1].GETDAC();
-      (*triangle) = m_triangle.GETDAC();
-      (*noise) = m_noise.GETDAC();
-      (*dmc) = m_dmc.GETDAC();
+      (*square1) = m_state->m_square[0].GETDAC();
+      (*square2) = m_state->m_square[1].GETDAC();
+      (*triangle) = m_state->m_triangle.GETDAC();
+      (*noise) = m_state->m_noise.GETDAC();
+      (*dmc) = m_state->m_dmc.GETDAC();
    }
    static void DMCIRQ ( bool* enabled, bool* asserted )
    {
-      (*enabled) = m_dmc.IRQENABLED();
-      (*asserted) = m_dmc.IRQASSERTED();
+      (*enabled) = m_state->m_dmc.IRQENABLED();
+      (*asserted) = m_state->m_dmc.IRQASSERTED();
    }
    static void SAMPLEINFO ( uint16_t* addr, uint16_t* length, uint16_t* pos )
    {
-      (*addr) = m_dmc.SAMPLEADDR();
-      (*length) = m_dmc.SAMPLELENGTH();
-      (*pos) = m_dmc.SAMPLEPOS();
+      (*addr) = m_state->m_dmc.SAMPLEADDR();
+      (*length) = m_state->m_dmc.SAMPLELENGTH();
+      (*pos) = m_state->m_dmc.SAMPLEPOS();
    }
    static void DMAINFO ( uint8_t* buffer, bool* full )
    {
-      (*buffer) = m_dmc.SAMPLEBUFFER();
-      (*full) = m_dmc.SAMPLEBUFFERFULL();
+      (*buffer) = m_state->m_dmc.SAMPLEBUFFER();
+      (*full) = m_state->m_dmc.SAMPLEBUFFERFULL();
    }
 
    static CRegisterDatabase* REGISTERS()
@@ -714,30 +881,80 @@ public:
    }
 
 protected:
-   static uint8_t m_APUreg [ 32 ];
-   static uint8_t m_APUregDirty [ 32 ];
-   static bool m_irqEnabled;
-   static bool m_irqAsserted;
-
-   static int32_t m_sequencerMode;
-   static int32_t m_newSequencerMode;
-   static int32_t m_changeModes;
-   static int32_t m_sequenceStep;
-
-   static CAPUSquare m_square[2];
-   static CAPUTriangle m_triangle;
-   static CAPUNoise m_noise;
-   static CAPUDMC m_dmc;
-
-   static uint16_t* m_waveBuf;
-   static int32_t m_waveBufProduce;
-   static int32_t m_waveBufConsume;
-
-   static uint32_t   m_cycles;
-
-   static float m_sampleSpacer;
-   
-   static int32_t m_sampleBufferSize;
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      uint8_t m_APUreg [ 32 ] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+      uint8_t m_APUregDirty [ 32 ] = { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 };
+      bool m_irqEnabled = false;
+      bool m_irqAsserted = false;
+      int32_t m_sequencerMode = 0;
+      int32_t m_newSequencerMode = 0;
+      int32_t m_changeModes = -1;
+      int32_t m_sequenceStep = 0;
+      CAPUSquare m_square [2];
+      CAPUTriangle m_triangle;
+      CAPUNoise m_noise;
+      CAPUDMC m_dmc;
+      uint32_t m_cycles = 0;
+      float m_sampleSpacer = 0.0;
+      float m_takeSample = 0.0f;
+
+      // Output ring (see PLAY).  The indexes run freely; each is only
+      // written by its own side.  Like the rate control below none of
+      // this is saved with the machine.
+      uint16_t* m_waveBuf = NULL;
+      std::atomic<uint32_t> m_waveBufProduce = { 0 };
+      std::atomic<uint32_t> m_waveBufConsume = { 0 };
+      std::atomic<uint32_t> m_underruns = { 0 };
+      std::atomic<uint32_t> m_overruns = { 0 };
+
+      // Consumer side.
+      uint16_t* m_playBuf = NULL;
+      uint16_t m_playLast = 0;
+
+      // Rate control: the fill it aims for, the sample spacing in use
+      // (m_sampleSpacer, moved) and how far it moved, in parts per million.
+      uint32_t m_fillTarget = 0;
+      float m_outputSpacer = 0.0f;
+      int32_t m_rateAdjust = 0;
+
+      // DC-blocking filter history for AMPLITUDE.
+      int16_t m_outLast = 0;
+      int32_t m_outDownsampled = 0;
+
+      // Mixer output since the last sample.  Like the channels' muting
+      // the synthesis mode is a user preference, and none of this is
+      // saved with the machine.
+      uint32_t m_synthesis = AUDIO_SYNTHESIS_AVERAGE;
+      int32_t m_mixLast = 0;
+      int32_t m_mixSum = 0;
+      int32_t m_mixTicks = 0;
+      int32_t m_blipBuf [ APU_BLIP_BUFFER ] = { 0, };
+      int32_t m_blipPos = 0;
+      int32_t m_blipLevel = 0;
+
+      // CPU cycles the APU has yet to run, and how many there can be
+      // before it has to run them (see CLOCK).
+      uint32_t m_pendingCycles = 0;
+      uint32_t m_syncCycles = 1;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
+
+   static void MIXERTABLES ( void );
+   static void PRODUCE ( uint16_t sample );
+   static void CATCHUP ( void );
+   static uint32_t SEQUENCERCYCLES ( void );
+   static uint32_t SAMPLECYCLES ( void );
+   static uint32_t QUIETCYCLES ( void );
+   static void QUIET ( uint32_t cycles );
+   static inline void BLIPSTEP ( int32_t delta );
+
+   static int32_t m_pulseMix [ APU_PULSE_MIX_SIZE ];
+   static int32_t m_tndMix [ APU_TND_MIX_SIZE ];
+   static int32_t m_blipKernel [ APU_BLIP_PHASES ] [ APU_BLIP_TAPS ];
 
    static CRegisterDatabase* m_dbRegisters;
 
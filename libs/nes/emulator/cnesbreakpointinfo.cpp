@@ -9,6 +9,88 @@
 
 CNESBreakpointInfo::CNESBreakpointInfo()
 {
+   BreakpointsChanged ();
+}
+
+static inline bool addressMatches ( const BreakpointInfo* pBreakpoint, uint32_t addr )
+{
+   // Same address test as CNES::CHECKBREAKPOINT.
+   return (addr >= pBreakpoint->item1) &&
+          (addr <= pBreakpoint->item2) &&
+          (((!pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask)) ||
+           ((pBreakpoint->itemMaskExclusive) && (addr&pBreakpoint->itemMask) && ((addr&(~pBreakpoint->itemMask)) == 0)));
+}
+
+static void mapAddresses ( const BreakpointInfo* pBreakpoint, uint32_t* map )
+{
+   uint32_t addr;
+   uint32_t last = (pBreakpoint->item2 < MEM_64KB) ? pBreakpoint->item2 : (MEM_64KB-1);
+
+   for ( addr = pBreakpoint->item1; addr <= last; addr++ )
+   {
+      if ( addressMatches(pBreakpoint,addr) )
+      {
+         map[addr>>5] |= 1<<(addr&0x1F);
+      }
+   }
+}
+
+void CNESBreakpointInfo::BreakpointsChanged ( void )
+{
+   BreakpointInfo* pBreakpoint;
+   int idx;
+
+   memset(m_armedTypes,0,sizeof(m_armedTypes));
+   memset(m_armedEvents,0,sizeof(m_armedEvents));
+   memset(m_numArmed,0,sizeof(m_numArmed));
+   memset(m_executionMap,0,sizeof(m_executionMap));
+   memset(m_readMap,0,sizeof(m_readMap));
+   memset(m_writeMap,0,sizeof(m_writeMap));
+
+   for ( idx = 0; idx < m_numBreakpoints; idx++ )
+   {
+      pBreakpoint = m_breakpoint+idx;
+
+      if ( !pBreakpoint->enabled )
+      {
+         continue;
+      }
+
+      m_armed[pBreakpoint->target][m_numArmed[pBreakpoint->target]++] = idx;
+      m_armedTypes[pBreakpoint->target] |= 1<<pBreakpoint->type;
+      if ( (BREAKPOINT_EVENT_TYPES&(1<<pBreakpoint->type)) &&
+           (pBreakpoint->event >= 0) && (pBreakpoint->event < 32) )
+      {
+         m_armedEvents[pBreakpoint->target] |= 1<<pBreakpoint->event;
+      }
+
+      // "Access" breakpoints are checked for by reads and by writes.
+      switch ( pBreakpoint->type )
+      {
+         case eBreakOnCPUExecution:
+            mapAddresses(pBreakpoint,m_executionMap);
+            break;
+         case eBreakOnCPUMemoryAccess:
+            m_armedTypes[eBreakInCPU] |= (1<<eBreakOnCPUMemoryRead)|(1<<eBreakOnCPUMemoryWrite);
+            mapAddresses(pBreakpoint,m_readMap);
+            mapAddresses(pBreakpoint,m_writeMap);
+            break;
+         case eBreakOnCPUMemoryRead:
+            mapAddresses(pBreakpoint,m_readMap);
+            break;
+         case eBreakOnCPUMemoryWrite:
+            mapAddresses(pBreakpoint,m_writeMap);
+            break;
+         case eBreakOnOAMPortalAccess:
+            m_armedTypes[eBreakInPPU] |= (1<<eBreakOnOAMPortalRead)|(1<<eBreakOnOAMPortalWrite);
+            break;
+         case eBreakOnPPUPortalAccess:
+            m_armedTypes[eBreakInPPU] |= (1<<eBreakOnPPUPortalRead)|(1<<eBreakOnPPUPortalWrite);
+            break;
+         default:
+            break;
+      }
+   }
 }
 
 void CNESBreakpointInfo::ModifyBreakpoint ( BreakpointInfo* pBreakpoint, int type, eBreakpointItemType itemType, int event, int item1, int item1Absolute, int item2, int mask, bool maskExclusive, eBreakpointConditionType conditionType, int condition, eBreakpointDataType dataType, int data, bool enabled )
@@ -3,6 +3,13 @@
 
 #include "cbreakpointinfo.h"
 
+#include "nes_emulator_core.h"
+
+#define NUM_BREAKPOINT_TARGETS (eBreakInMapper+1)
+
+// Breakpoint kinds that are further keyed by an event identifier.
+#define BREAKPOINT_EVENT_TYPES ( (1<<eBreakOnCPUEvent)|(1<<eBreakOnPPUEvent)|(1<<eBreakOnAPUEvent)|(1<<eBreakOnMapperEvent) )
+
 class CNESBreakpointInfo : public CBreakpointInfo
 {
 public:
@@ -10,8 +17,61 @@ public:
    void GetPrintable ( int idx, char* msg );
    void GetHitPrintable ( int idx, char* hmsg );
 
+   // Index of the enabled breakpoints, rebuilt whenever the list changes,
+   // so the emulator can tell cheaply that a check can't match anything.
+   // Whether any enabled breakpoint is of this kind (and, for the event
+   // kinds, on this event).
+   inline bool IsArmed ( eBreakpointTarget target, eBreakpointType type, int event ) const
+   {
+      uint32_t bit;
+
+      if ( (uint32_t)type >= 32 )
+      {
+         return true;
+      }
+      bit = 1<<type;
+      if ( !(m_armedTypes[target]&bit) )
+      {
+         return false;
+      }
+      if ( bit&BREAKPOINT_EVENT_TYPES )
+      {
+         return ((uint32_t)event < 32) ? ((m_armedEvents[target]>>event)&1) : true;
+      }
+      return true;
+   }
+   // Whether an enabled CPU execution, read or write breakpoint covers
+   // this address.
+   inline bool IsExecutionArmed ( uint32_t addr ) const
+   {
+      return (m_executionMap[(addr&0xFFFF)>>5]>>(addr&0x1F))&1;
+   }
+   inline bool IsReadArmed ( uint32_t addr ) const
+   {
+      return (m_readMap[(addr&0xFFFF)>>5]>>(addr&0x1F))&1;
+   }
+   inline bool IsWriteArmed ( uint32_t addr ) const
+   {
+      return (m_writeMap[(addr&0xFFFF)>>5]>>(addr&0x1F))&1;
+   }
+   // The enabled breakpoints for a target, by index into the list.
+   inline const uint8_t* GetArmed ( eBreakpointTarget target, int* count ) const
+   {
+      (*count) = m_numArmed[target];
+      return m_armed[target];
+   }
+
 protected:
    void ModifyBreakpoint ( BreakpointInfo* pBreakpoint, int type, eBreakpointItemType itemType, int event, int item1, int item1Absolute, int item2, int mask, bool maskExclusive, eBreakpointConditionType conditionType, int condition, eBreakpointDataType dataType, int data, bool enabled );
+   void BreakpointsChanged ( void );
+
+   uint32_t m_armedTypes [ NUM_BREAKPOINT_TARGETS ];
+   uint32_t m_armedEvents [ NUM_BREAKPOINT_TARGETS ];
+   uint8_t  m_armed [ NUM_BREAKPOINT_TARGETS ][ NUM_BREAKPOINTS ];
+   int      m_numArmed [ NUM_BREAKPOINT_TARGETS ];
+   uint32_t m_executionMap [ MEM_64KB/32 ];
+   uint32_t m_readMap [ MEM_64KB/32 ];
+   uint32_t m_writeMap [ MEM_64KB/32 ];
 };
 
 #endif // CBREAKPOINTINFO_H
@@ -20,21 +20,20 @@
 #include "cnes6502.h"
 
 // Default IO implementation stuff
-uint32_t   CIO::m_ioJoy [] = { 0x00, 0x00 };
+CIO::State CIO::m_defaultState;
+thread_local CIO::State* CIO::m_state = &CIO::m_defaultState;
 
 // Standard joypad stuff
-uint8_t   CIOStandardJoypad::m_ioJoyLatch [] = { 0x00, 0x00 };
-uint8_t   CIOStandardJoypad::m_last4016 = 0x00;
-CJoypadLogger  CIOStandardJoypad::m_logger [ NUM_CONTROLLERS ];
+CIOStandardJoypad::State CIOStandardJoypad::m_defaultState;
+thread_local CIOStandardJoypad::State* CIOStandardJoypad::m_state = &CIOStandardJoypad::m_defaultState;
 
 // Turbo joypad stuff
-uint8_t   CIOTurboJoypad::m_alternator [][2] = { { 0, 0 }, { 0, 0 } };
-uint32_t  CIOTurboJoypad::m_lastFrame = 0;
+CIOTurboJoypad::State CIOTurboJoypad::m_defaultState;
+thread_local CIOTurboJoypad::State* CIOTurboJoypad::m_state = &CIOTurboJoypad::m_defaultState;
 
 // Vaus Arkanoid pad stuff
-uint8_t   CIOVaus::m_ioPotLatch [] = { 0x00, 0x00 };
-uint8_t   CIOVaus::m_last4016 = 0x00;
-uint8_t   CIOVaus::m_trimPot [] = { 0x54, 0x54 };
+CIOVaus::State CIOVaus::m_defaultState;
+thread_local CIOVaus::State* CIOVaus::m_state = &CIOVaus::m_defaultState;
 
 uint32_t CIO::IO ( uint32_t addr )
 {
@@ -91,15 +90,15 @@ uint32_t CIOStandardJoypad::IO ( uint32_t addr )
    switch ( addr )
    {
       case IOJOY1:
-         data = 0x40|((*(m_ioJoyLatch+CONTROLLER1))&0x01);
-         *(m_ioJoyLatch+CONTROLLER1) >>= 1;
-         *(m_ioJoyLatch+CONTROLLER1) |= 0x80;
+         data = 0x40|((*(m_state->m_ioJoyLatch+CONTROLLER1))&0x01);
+         *(m_state->m_ioJoyLatch+CONTROLLER1) >>= 1;
+         *(m_state->m_ioJoyLatch+CONTROLLER1) |= 0x80;
          break;
 
       case IOJOY2:
-         data = 0x40|((*(m_ioJoyLatch+CONTROLLER2))&0x01);
-         *(m_ioJoyLatch+CONTROLLER2) >>= 1;
-         *(m_ioJoyLatch+CONTROLLER2) |= 0x80;
+         data = 0x40|((*(m_state->m_ioJoyLatch+CONTROLLER2))&0x01);
+         *(m_state->m_ioJoyLatch+CONTROLLER2) >>= 1;
+         *(m_state->m_ioJoyLatch+CONTROLLER2) |= 0x80;
          break;
    }
 
@@ -112,13 +111,13 @@ void CIOStandardJoypad::IO ( uint32_t addr, uint8_t data )
    {
       case IOJOY1:
 
-         if ( (m_last4016&1) && (!(data&1)) ) // latch on negative edge
+         if ( (m_state->m_last4016&1) && (!(data&1)) ) // latch on negative edge
          {
-            *(m_ioJoyLatch+CONTROLLER1) = *(m_ioJoy+CONTROLLER1);
-            *(m_ioJoyLatch+CONTROLLER2) = *(m_ioJoy+CONTROLLER2);
+            *(m_state->m_ioJoyLatch+CONTROLLER1) = *(CIO::m_state->m_ioJoy+CONTROLLER1);
+            *(m_state->m_ioJoyLatch+CONTROLLER2) = *(CIO::m_state->m_ioJoy+CONTROLLER2);
          }
 
-         m_last4016 = data;
+         m_state->m_last4016 = data;
          break;
    }
 }
@@ -130,11 +129,11 @@ uint32_t CIOStandardJoypad::_IO ( uint32_t addr )
    switch ( addr )
    {
       case IOJOY1:
-         data = 0x40|(m_ioJoyLatch[CONTROLLER1]&0x01);
+         data = 0x40|(m_state->m_ioJoyLatch[CONTROLLER1]&0x01);
          break;
 
       case IOJOY2:
-         data = 0x40|(m_ioJoyLatch[CONTROLLER2]&0x01);
+         data = 0x40|(m_state->m_ioJoyLatch[CONTROLLER2]&0x01);
          break;
    }
 
@@ -147,13 +146,13 @@ void CIOStandardJoypad::_IO ( uint32_t addr, uint8_t data )
    {
       case IOJOY1:
 
-         if ( (m_last4016&1) && (!(data&1)) ) // latch on negative edge
+         if ( (m_state->m_last4016&1) && (!(data&1)) ) // latch on negative edge
          {
-            *(m_ioJoyLatch+CONTROLLER1) = *(m_ioJoy+CONTROLLER1);
-            *(m_ioJoyLatch+CONTROLLER2) = *(m_ioJoy+CONTROLLER2);
+            *(m_state->m_ioJoyLatch+CONTROLLER1) = *(CIO::m_state->m_ioJoy+CONTROLLER1);
+            *(m_state->m_ioJoyLatch+CONTROLLER2) = *(CIO::m_state->m_ioJoy+CONTROLLER2);
          }
 
-         m_last4016 = data;
+         m_state->m_last4016 = data;
          break;
    }
 }
@@ -164,56 +163,56 @@ void CIOTurboJoypad::IO ( uint32_t addr, uint8_t data )
    {
       case IOJOY1:
 
-         if ( (m_last4016&1) && (!(data&1)) ) // latch on negative edge
+         if ( (CIOStandardJoypad::m_state->m_last4016&1) && (!(data&1)) ) // latch on negative edge
          {
-            *(m_ioJoyLatch+CONTROLLER1) = (uint8_t)(*(m_ioJoy+CONTROLLER1))&0xFF;
-            *(m_ioJoyLatch+CONTROLLER2) = (uint8_t)(*(m_ioJoy+CONTROLLER2))&0xFF;
+            *(CIOStandardJoypad::m_state->m_ioJoyLatch+CONTROLLER1) = (uint8_t)(*(CIO::m_state->m_ioJoy+CONTROLLER1))&0xFF;
+            *(CIOStandardJoypad::m_state->m_ioJoyLatch+CONTROLLER2) = (uint8_t)(*(CIO::m_state->m_ioJoy+CONTROLLER2))&0xFF;
 
             // Alternate for turbos if necessary.
-            if ( m_lastFrame != CNES::FRAME() )
+            if ( m_state->m_lastFrame != CNES::FRAME() )
             {
-               m_alternator[CONTROLLER1][0] = !m_alternator[CONTROLLER1][0];
-               m_alternator[CONTROLLER1][1] = !m_alternator[CONTROLLER1][1];
-               m_alternator[CONTROLLER2][0] = !m_alternator[CONTROLLER2][0];
-               m_alternator[CONTROLLER2][1] = !m_alternator[CONTROLLER2][1];
+               m_state->m_alternator[CONTROLLER1][0] = !m_state->m_alternator[CONTROLLER1][0];
+               m_state->m_alternator[CONTROLLER1][1] = !m_state->m_alternator[CONTROLLER1][1];
+               m_state->m_alternator[CONTROLLER2][0] = !m_state->m_alternator[CONTROLLER2][0];
+               m_state->m_alternator[CONTROLLER2][1] = !m_state->m_alternator[CONTROLLER2][1];
             }
-            m_lastFrame = CNES::FRAME();
+            m_state->m_lastFrame = CNES::FRAME();
 
-            if ( m_ioJoy[CONTROLLER1]&JOY_ATURBO )
+            if ( CIO::m_state->m_ioJoy[CONTROLLER1]&JOY_ATURBO )
             {
-               *(m_ioJoyLatch+CONTROLLER1) &= (~JOY_A);
-               if ( m_alternator[CONTROLLER1][0] )
+               *(CIOStandardJoypad::m_state->m_ioJoyLatch+CONTROLLER1) &= (~JOY_A);
+               if ( m_state->m_alternator[CONTROLLER1][0] )
                {
-                  *(m_ioJoyLatch+CONTROLLER1) |= JOY_A;
+                  *(CIOStandardJoypad::m_state->m_ioJoyLatch+CONTROLLER1) |= JOY_A;
                }
             }
-            if ( m_ioJoy[CONTROLLER1]&JOY_BTURBO )
+            if ( CIO::m_state->m_ioJoy[CONTROLLER1]&JOY_BTURBO )
             {
-               *(m_ioJoyLatch+CONTROLLER1) &= (~JOY_B);
-               if ( m_alternator[CONTROLLER1][1] )
+               *(CIOStandardJoypad::m_state->m_ioJoyLatch+CONTROLLER1) &= (~JOY_B);
+               if ( m_state->m_alternator[CONTROLLER1][1] )
                {
-                  *(m_ioJoyLatch+CONTROLLER1) |= JOY_B;
+                  *(CIOStandardJoypad::m_state->m_ioJoyLatch+CONTROLLER1) |= JOY_B;
                }
             }
-            if ( m_ioJoy[CONTROLLER2]&JOY_ATURBO )
+            if ( CIO::m_state->m_ioJoy[CONTROLLER2]&JOY_ATURBO )
             {
-               *(m_ioJoyLatch+CONTROLLER2) &= (~JOY_A);
-               if ( m_alternator[CONTROLLER2][0] )
+               *(CIOStandardJoypad::m_state->m_ioJoyLatch+CONTROLLER2) &= (~JOY_A);
+               if ( m_state->m_alternator[CONTROLLER2][0] )
                {
-                  *(m_ioJoyLatch+CONTROLLER2) |= JOY_A;
+                  *(CIOStandardJoypad::m_state->m_ioJoyLatch+CONTROLLER2) |= JOY_A;
                }
             }
-            if ( m_ioJoy[CONTROLLER2]&JOY_BTURBO )
+            if ( CIO::m_state->m_ioJoy[CONTROLLER2]&JOY_BTURBO )
             {
-               *(m_ioJoyLatch+CONTROLLER2) &= (~JOY_B);
-               if ( m_alternator[CONTROLLER2][1] )
+               *(CIOStandardJoypad::m_state->m_ioJoyLatch+CONTROLLER2) &= (~JOY_B);
+               if ( m_state->m_alternator[CONTROLLER2][1] )
                {
-                  *(m_ioJoyLatch+CONTROLLER2) |= JOY_B;
+                  *(CIOStandardJoypad::m_state->m_ioJoyLatch+CONTROLLER2) |= JOY_B;
                }
             }
          }
 
-         m_last4016 = data;
+         CIOStandardJoypad::m_state->m_last4016 = data;
          break;
    }
 }
@@ -225,11 +224,11 @@ uint32_t CIOTurboJoypad::_IO ( uint32_t addr )
    switch ( addr )
    {
       case IOJOY1:
-         data = 0x40|(m_ioJoyLatch[CONTROLLER1]&0x01);
+         data = 0x40|(CIOStandardJoypad::m_state->m_ioJoyLatch[CONTROLLER1]&0x01);
          break;
 
       case IOJOY2:
-         data = 0x40|(m_ioJoyLatch[CONTROLLER2]&0x01);
+         data = 0x40|(CIOStandardJoypad::m_state->m_ioJoyLatch[CONTROLLER2]&0x01);
          break;
    }
 
@@ -242,13 +241,13 @@ void CIOTurboJoypad::_IO ( uint32_t addr, uint8_t data )
    {
       case IOJOY1:
 
-         if ( (m_last4016&1) && (!(data&1)) ) // latch on negative edge
+         if ( (CIOStandardJoypad::m_state->m_last4016&1) && (!(data&1)) ) // latch on negative edge
          {
-            *(m_ioJoyLatch+CONTROLLER1) = *(m_ioJoy+CONTROLLER1);
-            *(m_ioJoyLatch+CONTROLLER2) = *(m_ioJoy+CONTROLLER2);
+            *(CIOStandardJoypad::m_state->m_ioJoyLatch+CONTROLLER1) = *(CIO::m_state->m_ioJoy+CONTROLLER1);
+            *(CIOStandardJoypad::m_state->m_ioJoyLatch+CONTROLLER2) = *(CIO::m_state->m_ioJoy+CONTROLLER2);
          }
 
-         m_last4016 = data;
+         CIOStandardJoypad::m_state->m_last4016 = data;
          break;
    }
 }
@@ -293,7 +292,7 @@ uint32_t CIOZapper::IO ( uint32_t addr )
          }
 
          // grab trigger state...
-         data = m_ioJoy [ CONTROLLER1 ];
+         data = CIO::m_state->m_ioJoy [ CONTROLLER1 ];
 
          if ( nonBlacks > 0 )
          {
@@ -334,7 +333,7 @@ uint32_t CIOZapper::IO ( uint32_t addr )
          }
 
          // grab trigger state...
-         data = m_ioJoy [ CONTROLLER2 ];
+         data = CIO::m_state->m_ioJoy [ CONTROLLER2 ];
 
          if ( nonBlacks > 0 )
          {
@@ -384,13 +383,13 @@ uint32_t CIOVaus::IO ( uint32_t addr )
    switch ( addr )
    {
       case IOJOY1:
-         data = 0x40|(*(m_ioJoy+CONTROLLER1))|(((*(m_ioPotLatch+CONTROLLER1))&0x80)>>3);
-         *(m_ioPotLatch+CONTROLLER1) <<= 1;
+         data = 0x40|(*(CIO::m_state->m_ioJoy+CONTROLLER1))|(((*(m_state->m_ioPotLatch+CONTROLLER1))&0x80)>>3);
+         *(m_state->m_ioPotLatch+CONTROLLER1) <<= 1;
          break;
 
       case IOJOY2:
-         data = 0x40|(*(m_ioJoy+CONTROLLER2))|(((*(m_ioPotLatch+CONTROLLER2))&0x80)>>3);
-         *(m_ioPotLatch+CONTROLLER2) <<= 1;
+         data = 0x40|(*(CIO::m_state->m_ioJoy+CONTROLLER2))|(((*(m_state->m_ioPotLatch+CONTROLLER2))&0x80)>>3);
+         *(m_state->m_ioPotLatch+CONTROLLER2) <<= 1;
          break;
    }
 
@@ -409,21 +408,21 @@ void CIOVaus::IO ( uint32_t addr, uint8_t data )
          CNES::CONTROLLERPOSITION(CONTROLLER1,&px1,&py1,&wx1,&wy1,&wx2,&wy2);
          CNES::CONTROLLERPOSITION(CONTROLLER2,&px2,&py2,&wx1,&wy1,&wx2,&wy2);
 
-         if ( (m_last4016&1) && (!(data&1)) ) // latch on negative edge
+         if ( (m_state->m_last4016&1) && (!(data&1)) ) // latch on negative edge
          {
             if ( (py1 > wy1) && (py1 < wy2) &&
                  (px1 > wx1) && (px1 < wx2) )
             {
-               *(m_ioPotLatch+CONTROLLER1) = ~((uint8_t)((((px1-wx1)*VAUS_POT_RANGE)/(wx2-wx1)))+(*(m_trimPot+CONTROLLER1)));
+               *(m_state->m_ioPotLatch+CONTROLLER1) = ~((uint8_t)((((px1-wx1)*VAUS_POT_RANGE)/(wx2-wx1)))+(*(m_state->m_trimPot+CONTROLLER1)));
             }
             if ( (py2 > wy1) && (py2 < wy2) &&
                  (px2 > wx1) && (px2 < wx2) )
             {
-               *(m_ioPotLatch+CONTROLLER2) = ~((uint8_t)((((px2-wx1)*VAUS_POT_RANGE)/(wx2-wx1)))+(*(m_trimPot+CONTROLLER2)));
+               *(m_state->m_ioPotLatch+CONTROLLER2) = ~((uint8_t)((((px2-wx1)*VAUS_POT_RANGE)/(wx2-wx1)))+(*(m_state->m_trimPot+CONTROLLER2)));
             }
          }
 
-         m_last4016 = data;
+         m_state->m_last4016 = data;
          break;
    }
 }
@@ -435,11 +434,11 @@ uint32_t CIOVaus::_IO ( uint32_t addr )
    switch ( addr )
    {
       case IOJOY1:
-         data = 0x40|(*(m_ioJoy+CONTROLLER1))|(((*(m_ioPotLatch+CONTROLLER1))&0x80)>>3);
+         data = 0x40|(*(CIO::m_state->m_ioJoy+CONTROLLER1))|(((*(m_state->m_ioPotLatch+CONTROLLER1))&0x80)>>3);
          break;
 
       case IOJOY2:
-         data = 0x40|(*(m_ioJoy+CONTROLLER2))|(((*(m_ioPotLatch+CONTROLLER2))&0x80)>>3);
+         data = 0x40|(*(CIO::m_state->m_ioJoy+CONTROLLER2))|(((*(m_state->m_ioPotLatch+CONTROLLER2))&0x80)>>3);
          break;
    }
 
@@ -458,26 +457,26 @@ void CIOVaus::_IO ( uint32_t addr, uint8_t data )
          CNES::CONTROLLERPOSITION(CONTROLLER1,&px1,&py1,&wx1,&wy1,&wx2,&wy2);
          CNES::CONTROLLERPOSITION(CONTROLLER2,&px2,&py2,&wx1,&wy1,&wx2,&wy2);
 
-         if ( (m_last4016&1) && (!(data&1)) ) // latch on negative edge
+         if ( (m_state->m_last4016&1) && (!(data&1)) ) // latch on negative edge
          {
             if ( (py1 > wy1) && (py1 < wy2) &&
                  (px1 > wx1) && (px1 < wx2) )
             {
-               *(m_ioPotLatch+CONTROLLER1) = ~((uint8_t)((((px1-wx1)*VAUS_POT_RANGE)/(wx2-wx1)))+(*(m_trimPot+CONTROLLER1)));
+               *(m_state->m_ioPotLatch+CONTROLLER1) = ~((uint8_t)((((px1-wx1)*VAUS_POT_RANGE)/(wx2-wx1)))+(*(m_state->m_trimPot+CONTROLLER1)));
             }
             if ( (py2 > wy1) && (py2 < wy2) &&
                  (px2 > wx1) && (px2 < wx2) )
             {
-               *(m_ioPotLatch+CONTROLLER2) = ~((uint8_t)((((px2-wx1)*VAUS_POT_RANGE)/(wx2-wx1)))+(*(m_trimPot+CONTROLLER2)));
+               *(m_state->m_ioPotLatch+CONTROLLER2) = ~((uint8_t)((((px2-wx1)*VAUS_POT_RANGE)/(wx2-wx1)))+(*(m_state->m_trimPot+CONTROLLER2)));
             }
          }
 
-         m_last4016 = data;
+         m_state->m_last4016 = data;
          break;
    }
 }
 
 void CIOVaus::SPECIAL(int32_t port,int32_t special)
 {
-   m_trimPot[port] = special;
+   m_state->m_trimPot[port] = special;
 }
@@ -15,11 +15,18 @@ public:
    static uint32_t _IO ( uint32_t addr );
    static inline void JOY ( uint8_t joy, uint32_t data )
    {
-      *(m_ioJoy+joy) = data;
+      *(m_state->m_ioJoy+joy) = data;
    }
 
 protected:
-   static uint32_t  m_ioJoy [ NUM_CONTROLLERS ];
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      uint32_t m_ioJoy [ NUM_CONTROLLERS ] = { 0x00, 0x00 };
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 };
 
 class CIOStandardJoypad : public CIO
@@ -31,12 +38,19 @@ public:
    static uint32_t IO ( uint32_t addr );
    static void _IO ( uint32_t addr, uint8_t data );
    static uint32_t _IO ( uint32_t addr );
-   static inline CJoypadLogger* LOGGER ( int idx ) { return m_logger+idx; }
+   static inline CJoypadLogger* LOGGER ( int idx ) { return m_state->m_logger+idx; }
 
 protected:
-   static uint8_t   m_ioJoyLatch [ NUM_CONTROLLERS ];
-   static uint8_t   m_last4016;
-   static CJoypadLogger  m_logger [ NUM_CONTROLLERS ];
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      uint8_t m_ioJoyLatch [ NUM_CONTROLLERS ] = { 0x00, 0x00 };
+      uint8_t m_last4016 = 0x00;
+      CJoypadLogger m_logger [ NUM_CONTROLLERS ];
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 };
 
 class CIOTurboJoypad : public CIOStandardJoypad
@@ -49,8 +63,15 @@ public:
    static uint32_t _IO ( uint32_t addr );
 
 protected:
-   static uint32_t m_lastFrame;
-   static uint8_t m_alternator [ NUM_CONTROLLERS ][ 2 ];
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      uint32_t m_lastFrame = 0;
+      uint8_t m_alternator [ NUM_CONTROLLERS ][ 2 ] = { { 0, 0 }, { 0, 0 } };
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 };
 
 class CIOVaus : public CIO
@@ -65,9 +86,16 @@ public:
    static void SPECIAL ( int32_t port, int32_t special );
 
 protected:
-   static uint8_t   m_ioPotLatch [ NUM_CONTROLLERS ];
-   static uint8_t   m_last4016;
-   static uint8_t   m_trimPot [ NUM_CONTROLLERS ];
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      uint8_t m_ioPotLatch [ NUM_CONTROLLERS ] = { 0x00, 0x00 };
+      uint8_t m_last4016 = 0x00;
+      uint8_t m_trimPot [ NUM_CONTROLLERS ] = { 0x54, 0x54 };
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 };
 
 class CIOZapper : public CIO
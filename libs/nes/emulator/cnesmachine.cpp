@@ -0,0 +1,468 @@
+#include "cnesmachine.h"
+
+thread_local NesMachine* NesMachine::m_current = NULL;
+
+NesMachine::NesMachine ( bool isDefault )
+   : m_bDefault(isDefault),
+     m_pSnapshot(NULL),
+     m_snapshotSize(0),
+     m_snapshotLength(0)
+{
+   m_pNESState = &CNES::m_defaultState;
+   m_p6502State = &C6502::m_defaultState;
+   m_pPPUState = &CPPU::m_defaultState;
+   m_pAPUState = &CAPU::m_defaultState;
+   m_pROMState = &CROM::m_defaultState;
+   m_pIOState = &CIO::m_defaultState;
+   m_pIOStandardJoypadState = &CIOStandardJoypad::m_defaultState;
+   m_pIOTurboJoypadState = &CIOTurboJoypad::m_defaultState;
+   m_pIOVausState = &CIOVaus::m_defaultState;
+   m_pCodeDataLoggerState = &CCodeDataLogger::m_defaultState;
+   m_pPerfState = &CNESPerf::m_defaultState;
+   m_pROMMapper001State = &CROMMapper001::m_defaultState;
+   m_pROMMapper002State = &CROMMapper002::m_defaultState;
+   m_pROMMapper003State = &CROMMapper003::m_defaultState;
+   m_pROMMapper004State = &CROMMapper004::m_defaultState;
+   m_pROMMapper005State = &CROMMapper005::m_defaultState;
+   m_pROMMapper007State = &CROMMapper007::m_defaultState;
+   m_pROMMapper009State = &CROMMapper009::m_defaultState;
+   m_pROMMapper010State = &CROMMapper010::m_defaultState;
+   m_pROMMapper011State = &CROMMapper011::m_defaultState;
+   m_pROMMapper013State = &CROMMapper013::m_defaultState;
+   m_pROMMapper016State = &CROMMapper016::m_defaultState;
+   m_pROMMapper018State = &CROMMapper018::m_defaultState;
+   m_pROMMapper019State = &CROMMapper019::m_defaultState;
+   m_pROMMapper021State = &CROMMapper021::m_defaultState;
+   m_pROMMapper022State = &CROMMapper022::m_defaultState;
+   m_pROMMapper023State = &CROMMapper023::m_defaultState;
+   m_pROMMapper024State = &CROMMapper024::m_defaultState;
+   m_pROMMapper025State = &CROMMapper025::m_defaultState;
+   m_pROMMapper026State = &CROMMapper026::m_defaultState;
+   m_pROMMapper028State = &CROMMapper028::m_defaultState;
+   m_pROMMapper033State = &CROMMapper033::m_defaultState;
+   m_pROMMapper034State = &CROMMapper034::m_defaultState;
+   m_pROMMapper065State = &CROMMapper065::m_defaultState;
+   m_pROMMapper068State = &CROMMapper068::m_defaultState;
+   m_pROMMapper069State = &CROMMapper069::m_defaultState;
+   m_pROMMapper073State = &CROMMapper073::m_defaultState;
+   m_pROMMapper075State = &CROMMapper075::m_defaultState;
+   m_pROMMapper111State = &CROMMapper111::m_defaultState;
+}
+
+NesMachine::NesMachine()
+   : m_bDefault(false),
+     m_pSnapshot(NULL),
+     m_snapshotSize(0),
+     m_snapshotLength(0)
+{
+   NesMachine* previous;
+
+   m_pNESState = new CNES::State();
+   m_p6502State = new C6502::State();
+   m_pPPUState = new CPPU::State();
+   m_pAPUState = new CAPU::State();
+   m_pROMState = new CROM::State();
+   m_pIOState = new CIO::State();
+   m_pIOStandardJoypadState = new CIOStandardJoypad::State();
+   m_pIOTurboJoypadState = new CIOTurboJoypad::State();
+   m_pIOVausState = new CIOVaus::State();
+   m_pCodeDataLoggerState = new CCodeDataLogger::State();
+   m_pPerfState = new CNESPerf::State();
+   m_pROMMapper001State = new CROMMapper001::State();
+   m_pROMMapper002State = new CROMMapper002::State();
+   m_pROMMapper003State = new CROMMapper003::State();
+   m_pROMMapper004State = new CROMMapper004::State();
+   m_pROMMapper005State = new CROMMapper005::State();
+   m_pROMMapper007State = new CROMMapper007::State();
+   m_pROMMapper009State = new CROMMapper009::State();
+   m_pROMMapper010State = new CROMMapper010::State();
+   m_pROMMapper011State = new CROMMapper011::State();
+   m_pROMMapper013State = new CROMMapper013::State();
+   m_pROMMapper016State = new CROMMapper016::State();
+   m_pROMMapper018State = new CROMMapper018::State();
+   m_pROMMapper019State = new CROMMapper019::State();
+   m_pROMMapper021State = new CROMMapper021::State();
+   m_pROMMapper022State = new CROMMapper022::State();
+   m_pROMMapper023State = new CROMMapper023::State();
+   m_pROMMapper024State = new CROMMapper024::State();
+   m_pROMMapper025State = new CROMMapper025::State();
+   m_pROMMapper026State = new CROMMapper026::State();
+   m_pROMMapper028State = new CROMMapper028::State();
+   m_pROMMapper033State = new CROMMapper033::State();
+   m_pROMMapper034State = new CROMMapper034::State();
+   m_pROMMapper065State = new CROMMapper065::State();
+   m_pROMMapper068State = new CROMMapper068::State();
+   m_pROMMapper069State = new CROMMapper069::State();
+   m_pROMMapper073State = new CROMMapper073::State();
+   m_pROMMapper075State = new CROMMapper075::State();
+   m_pROMMapper111State = new CROMMapper111::State();
+
+   // Allocate the per-machine resources with this machine selected so
+   // they land in this machine's state.
+   previous = SELECT ( this );
+   CNES::CREATE ();
+   C6502::CREATE ();
+   CPPU::CREATE ();
+   CAPU::CREATE ();
+   CROM::CREATE ();
+   SELECT ( previous );
+}
+
+NesMachine::~NesMachine()
+{
+   NesMachine* previous;
+
+   delete [] m_pSnapshot;
+
+   if ( m_bDefault )
+   {
+      return;
+   }
+
+   previous = SELECT ( this );
+   CROM::DESTROY ();
+   CAPU::DESTROY ();
+   CPPU::DESTROY ();
+   C6502::DESTROY ();
+   CNES::DESTROY ();
+   SELECT ( (previous == this) ? NULL : previous );
+
+   delete m_pNESState;
+   delete m_p6502State;
+   delete m_pPPUState;
+   delete m_pAPUState;
+   delete m_pROMState;
+   delete m_pIOState;
+   delete m_pIOStandardJoypadState;
+   delete m_pIOTurboJoypadState;
+   delete m_pIOVausState;
+   delete m_pCodeDataLoggerState;
+   delete m_pPerfState;
+   delete m_pROMMapper001State;
+   delete m_pROMMapper002State;
+   delete m_pROMMapper003State;
+   delete m_pROMMapper004State;
+   delete m_pROMMapper005State;
+   delete m_pROMMapper007State;
+   delete m_pROMMapper009State;
+   delete m_pROMMapper010State;
+   delete m_pROMMapper011State;
+   delete m_pROMMapper013State;
+   delete m_pROMMapper016State;
+   delete m_pROMMapper018State;
+   delete m_pROMMapper019State;
+   delete m_pROMMapper021State;
+   delete m_pROMMapper022State;
+   delete m_pROMMapper023State;
+   delete m_pROMMapper024State;
+   delete m_pROMMapper025State;
+   delete m_pROMMapper026State;
+   delete m_pROMMapper028State;
+   delete m_pROMMapper033State;
+   delete m_pROMMapper034State;
+   delete m_pROMMapper065State;
+   delete m_pROMMapper068State;
+   delete m_pROMMapper069State;
+   delete m_pROMMapper073State;
+   delete m_pROMMapper075State;
+   delete m_pROMMapper111State;
+}
+
+NesMachine* NesMachine::DEFAULT ( void )
+{
+   static NesMachine defaultMachine ( true );
+
+   return &defaultMachine;
+}
+
+NesMachine* NesMachine::CURRENT ( void )
+{
+   if ( !m_current )
+   {
+      return DEFAULT();
+   }
+   return m_current;
+}
+
+NesMachine* NesMachine::SELECT ( NesMachine* machine )
+{
+   NesMachine* previous = CURRENT();
+
+   if ( !machine )
+   {
+      machine = DEFAULT();
+   }
+   m_current = machine;
+
+   CNES::m_state = machine->m_pNESState;
+   C6502::m_state = machine->m_p6502State;
+   CPPU::m_state = machine->m_pPPUState;
+   CAPU::m_state = machine->m_pAPUState;
+   CROM::m_state = machine->m_pROMState;
+   CIO::m_state = machine->m_pIOState;
+   CIOStandardJoypad::m_state = machine->m_pIOStandardJoypadState;
+   CIOTurboJoypad::m_state = machine->m_pIOTurboJoypadState;
+   CIOVaus::m_state = machine->m_pIOVausState;
+   CCodeDataLogger::m_state = machine->m_pCodeDataLoggerState;
+   CNESPerf::m_state = machine->m_pPerfState;
+   CROMMapper001::m_state = machine->m_pROMMapper001State;
+   CROMMapper002::m_state = machine->m_pROMMapper002State;
+   CROMMapper003::m_state = machine->m_pROMMapper003State;
+   CROMMapper004::m_state = machine->m_pROMMapper004State;
+   CROMMapper005::m_state = machine->m_pROMMapper005State;
+   CROMMapper007::m_state = machine->m_pROMMapper007State;
+   CROMMapper009::m_state = machine->m_pROMMapper009State;
+   CROMMapper010::m_state = machine->m_pROMMapper010State;
+   CROMMapper011::m_state = machine->m_pROMMapper011State;
+   CROMMapper013::m_state = machine->m_pROMMapper013State;
+   CROMMapper016::m_state = machine->m_pROMMapper016State;
+   CROMMapper018::m_state = machine->m_pROMMapper018State;
+   CROMMapper019::m_state = machine->m_pROMMapper019State;
+   CROMMapper021::m_state = machine->m_pROMMapper021State;
+   CROMMapper022::m_state = machine->m_pROMMapper022State;
+   CROMMapper023::m_state = machine->m_pROMMapper023State;
+   CROMMapper024::m_state = machine->m_pROMMapper024State;
+   CROMMapper025::m_state = machine->m_pROMMapper025State;
+   CROMMapper026::m_state = machine->m_pROMMapper026State;
+   CROMMapper028::m_state = machine->m_pROMMapper028State;
+   CROMMapper033::m_state = machine->m_pROMMapper033State;
+   CROMMapper034::m_state = machine->m_pROMMapper034State;
+   CROMMapper065::m_state = machine->m_pROMMapper065State;
+   CROMMapper068::m_state = machine->m_pROMMapper068State;
+   CROMMapper069::m_state = machine->m_pROMMapper069State;
+   CROMMapper073::m_state = machine->m_pROMMapper073State;
+   CROMMapper075::m_state = machine->m_pROMMapper075State;
+   CROMMapper111::m_state = machine->m_pROMMapper111State;
+
+   return previous;
+}
+
+void NesMachine::MAPPERSTATES ( StateBlock* blocks )
+{
+   StateBlock table [ NUM_MAPPER_STATES ] =
+   {
+      { 1, m_pROMMapper001State, sizeof(CROMMapper001::State) },
+      { 2, m_pROMMapper002State, sizeof(CROMMapper002::State) },
+      { 3, m_pROMMapper003State, sizeof(CROMMapper003::State) },
+      { 4, m_pROMMapper004State, sizeof(CROMMapper004::State) },
+      { 5, m_pROMMapper005State, sizeof(CROMMapper005::State) },
+      { 7, m_pROMMapper007State, sizeof(CROMMapper007::State) },
+      { 9, m_pROMMapper009State, sizeof(CROMMapper009::State) },
+      { 10, m_pROMMapper010State, sizeof(CROMMapper010::State) },
+      { 11, m_pROMMapper011State, sizeof(CROMMapper011::State) },
+      { 13, m_pROMMapper013State, sizeof(CROMMapper013::State) },
+      { 16, m_pROMMapper016State, sizeof(CROMMapper016::State) },
+      { 18, m_pROMMapper018State, sizeof(CROMMapper018::State) },
+      { 19, m_pROMMapper019State, sizeof(CROMMapper019::State) },
+      { 21, m_pROMMapper021State, sizeof(CROMMapper021::State) },
+      { 22, m_pROMMapper022State, sizeof(CROMMapper022::State) },
+      { 23, m_pROMMapper023State, sizeof(CROMMapper023::State) },
+      { 24, m_pROMMapper024State, sizeof(CROMMapper024::State) },
+      { 25, m_pROMMapper025State, sizeof(CROMMapper025::State) },
+      { 26, m_pROMMapper026State, sizeof(CROMMapper026::State) },
+      { 28, m_pROMMapper028State, sizeof(CROMMapper028::State) },
+      { 33, m_pROMMapper033State, sizeof(CROMMapper033::State) },
+      { 34, m_pROMMapper034State, sizeof(CROMMapper034::State) },
+      { 65, m_pROMMapper065State, sizeof(CROMMapper065::State) },
+      { 68, m_pROMMapper068State, sizeof(CROMMapper068::State) },
+      { 69, m_pROMMapper069State, sizeof(CROMMapper069::State) },
+      { 73, m_pROMMapper073State, sizeof(CROMMapper073::State) },
+      { 75, m_pROMMapper075State, sizeof(CROMMapper075::State) },
+      { 111, m_pROMMapper111State, sizeof(CROMMapper111::State) }
+   };
+
+   memcpy ( blocks, table, sizeof(table) );
+}
+
+uint32_t NesMachine::SAVESTATE ( uint8_t* buffer, uint32_t size )
+{
+   NesMachine*     previous = SELECT ( this );
+   CNESStateWriter state ( buffer, size );
+   StateBlock      mappers [ NUM_MAPPER_STATES ];
+   uint32_t        written;
+   int32_t         idx;
+
+   CNES::SAVESTATE ( state );
+   C6502::SAVESTATE ( state );
+   CPPU::SAVESTATE ( state );
+   CAPU::SAVESTATE ( state );
+   CROM::SAVESTATE ( state );
+
+   state.BeginChunk ( NES_STATE_CHUNK_IO, NES_STATE_VERSION_IO );
+   state.Put ( m_pIOState->m_ioJoy );
+   state.Put ( m_pIOStandardJoypadState->m_ioJoyLatch );
+   state.Put ( m_pIOStandardJoypadState->m_last4016 );
+   state.Put ( *m_pIOTurboJoypadState );
+   state.Put ( *m_pIOVausState );
+   state.EndChunk ();
+
+   // Every mapper's registers are saved, not only the loaded mapper's;
+   // several mapper numbers share one implementation and the blocks
+   // are small.
+   // The N106 wave channels point at their machine's sound RAM; keep that
+   // out of the save-state so it is the same whichever machine wrote it.
+   for ( idx = 0; idx < 8; idx++ )
+   {
+      m_pROMMapper019State->m_wave[idx].SOUNDRAM(NULL);
+   }
+   MAPPERSTATES ( mappers );
+   state.BeginChunk ( NES_STATE_CHUNK_MAPPER, NES_STATE_VERSION_MAPPER );
+   for ( idx = 0; idx < NUM_MAPPER_STATES; idx++ )
+   {
+      state.Put ( mappers[idx].id );
+      state.Put ( mappers[idx].size );
+      state.Put ( mappers[idx].data, mappers[idx].size );
+   }
+   state.EndChunk ();
+   for ( idx = 0; idx < 8; idx++ )
+   {
+      m_pROMMapper019State->m_wave[idx].SOUNDRAM(m_pROMMapper019State->m_soundRAM);
+   }
+
+   written = buffer ? state.Finish() : state.SIZE();
+
+   SELECT ( previous );
+   return written;
+}
+
+bool NesMachine::CHECKSTATE ( const uint8_t* buffer, uint32_t size )
+{
+   CNESStateReader state ( buffer, size );
+   StateBlock      mappers [ NUM_MAPPER_STATES ];
+   int32_t         videoMode;
+   uint32_t        mapper;
+   uint32_t        numPrgBanks;
+   uint32_t        numChrBanks;
+   uint16_t        id;
+   uint32_t        blockSize;
+   int32_t         idx;
+
+   // A save-state of this build for this cartridge is always exactly as
+   // big as the one this machine would write now.
+   if ( !state.Begin() || (SAVESTATE(NULL,0) != size) )
+   {
+      return false;
+   }
+
+   if ( !state.FindChunk(NES_STATE_CHUNK_CPU,NES_STATE_VERSION_CPU) ||
+        !state.FindChunk(NES_STATE_CHUNK_PPU,NES_STATE_VERSION_PPU) ||
+        !state.FindChunk(NES_STATE_CHUNK_APU,NES_STATE_VERSION_APU) ||
+        !state.FindChunk(NES_STATE_CHUNK_IO,NES_STATE_VERSION_IO) )
+   {
+      return false;
+   }
+
+   if ( !state.FindChunk(NES_STATE_CHUNK_NES,NES_STATE_VERSION_NES) ||
+        !state.Get(videoMode) ||
+        (videoMode != m_pNESState->m_videoMode) )
+   {
+      return false;
+   }
+
+   if ( !state.FindChunk(NES_STATE_CHUNK_ROM,NES_STATE_VERSION_ROM) ||
+        !state.Get(mapper) ||
+        !state.Get(numPrgBanks) ||
+        !state.Get(numChrBanks) ||
+        (mapper != m_pROMState->m_mapper) ||
+        (numPrgBanks != m_pROMState->m_numPrgBanks) ||
+        (numChrBanks != m_pROMState->m_numChrBanks) )
+   {
+      return false;
+   }
+
+   MAPPERSTATES ( mappers );
+   if ( !state.FindChunk(NES_STATE_CHUNK_MAPPER,NES_STATE_VERSION_MAPPER) )
+   {
+      return false;
+   }
+   for ( idx = 0; idx < NUM_MAPPER_STATES; idx++ )
+   {
+      if ( !state.Get(id) ||
+           !state.Get(blockSize) ||
+           (id != mappers[idx].id) ||
+           (blockSize != mappers[idx].size) ||
+           !state.Skip(blockSize) )
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+bool NesMachine::LOADSTATE ( const uint8_t* buffer, uint32_t size )
+{
+   if ( !CHECKSTATE(buffer,size) )
+   {
+      return false;
+   }
+   return APPLYSTATE ( buffer, size );
+}
+
+bool NesMachine::SNAPSHOT ( void )
+{
+   m_snapshotLength = m_pSnapshot ? SAVESTATE ( m_pSnapshot, m_snapshotSize ) : 0;
+   if ( !m_snapshotLength )
+   {
+      delete [] m_pSnapshot;
+      m_snapshotSize = SAVESTATE ( NULL, 0 );
+      m_pSnapshot = new uint8_t [ m_snapshotSize ];
+      m_snapshotLength = SAVESTATE ( m_pSnapshot, m_snapshotSize );
+   }
+   return m_snapshotLength != 0;
+}
+
+bool NesMachine::RESTORE ( void )
+{
+   if ( !m_snapshotLength )
+   {
+      return false;
+   }
+   return APPLYSTATE ( m_pSnapshot, m_snapshotLength );
+}
+
+bool NesMachine::APPLYSTATE ( const uint8_t* buffer, uint32_t size )
+{
+   NesMachine*     previous;
+   CNESStateReader state ( buffer, size );
+   StateBlock      mappers [ NUM_MAPPER_STATES ];
+   uint16_t        id;
+   uint32_t        blockSize;
+   bool            ok;
+   int32_t         idx;
+
+   previous = SELECT ( this );
+
+   ok = state.Begin() &&
+        CNES::LOADSTATE(state) &&
+        C6502::LOADSTATE(state) &&
+        CPPU::LOADSTATE(state) &&
+        CAPU::LOADSTATE(state) &&
+        CROM::LOADSTATE(state);
+
+   ok = ok &&
+        state.FindChunk(NES_STATE_CHUNK_IO,NES_STATE_VERSION_IO) &&
+        state.Get(m_pIOState->m_ioJoy) &&
+        state.Get(m_pIOStandardJoypadState->m_ioJoyLatch) &&
+        state.Get(m_pIOStandardJoypadState->m_last4016) &&
+        state.Get(*m_pIOTurboJoypadState) &&
+        state.Get(*m_pIOVausState);
+
+   MAPPERSTATES ( mappers );
+   ok = ok && state.FindChunk(NES_STATE_CHUNK_MAPPER,NES_STATE_VERSION_MAPPER);
+   for ( idx = 0; ok && (idx < NUM_MAPPER_STATES); idx++ )
+   {
+      ok = state.Get(id) &&
+           state.Get(blockSize) &&
+           state.Get(mappers[idx].data,mappers[idx].size);
+   }
+
+   // The N106 wave channels point at their machine's sound RAM.
+   for ( idx = 0; idx < 8; idx++ )
+   {
+      m_pROMMapper019State->m_wave[idx].SOUNDRAM(m_pROMMapper019State->m_soundRAM);
+   }
+
+   SELECT ( previous );
+   return ok;
+}
@@ -0,0 +1,162 @@
+#if !defined ( NES_MACHINE_H )
+#define NES_MACHINE_H
+
+#include "cnes.h"
+#include "cnes6502.h"
+#include "cnesppu.h"
+#include "cnesapu.h"
+#include "cnesrom.h"
+#include "cnesio.h"
+#include "cnesrewind.h"
+#include "ccodedatalogger.h"
+#include "cnesperf.h"
+#include "cnesrommapper001.h"
+#include "cnesrommapper002.h"
+#include "cnesrommapper003.h"
+#include "cnesrommapper004.h"
+#include "cnesrommapper005.h"
+#include "cnesrommapper007.h"
+#include "cnesrommapper009.h"
+#include "cnesrommapper010.h"
+#include "cnesrommapper011.h"
+#include "cnesrommapper013.h"
+#include "cnesrommapper016.h"
+#include "cnesrommapper018.h"
+#include "cnesrommapper019.h"
+#include "cnesrommapper021.h"
+#include "cnesrommapper022.h"
+#include "cnesrommapper023.h"
+#include "cnesrommapper024.h"
+#include "cnesrommapper025.h"
+#include "cnesrommapper026.h"
+#include "cnesrommapper028.h"
+#include "cnesrommapper033.h"
+#include "cnesrommapper034.h"
+#include "cnesrommapper065.h"
+#include "cnesrommapper068.h"
+#include "cnesrommapper069.h"
+#include "cnesrommapper073.h"
+#include "cnesrommapper075.h"
+#include "cnesrommapper111.h"
+
+// A NesMachine owns one complete set of emulation state: CPU, PPU, APU,
+// cartridge (including every mapper's registers), controllers and the
+// debugger databases attached to them (tracer, breakpoints, code/data
+// loggers).  The emulator classes themselves remain static; each of them
+// reaches its state through a thread-local pointer which SELECT points
+// at the State owned by a particular machine.  This allows any number of
+// machines to exist in one process and any number of threads to emulate
+// them at the same time, as long as each machine is only driven by one
+// thread at a time.
+//
+// The default machine wraps the states that are statically allocated by
+// each class, and is the one selected on every thread until something
+// else is selected.  The global nes* API operates on whichever machine
+// the calling thread has selected.
+struct NesMachine
+{
+public:
+   NesMachine();
+   ~NesMachine();
+
+   // Accessor method to retrieve the machine that wraps the statically
+   // allocated emulator state.
+   static NesMachine* DEFAULT ( void );
+
+   // Accessor method to retrieve the machine selected by the calling thread.
+   static NesMachine* CURRENT ( void );
+
+   // Point the calling thread's view of the emulator at the passed machine.
+   // Returns the previously selected machine so the caller can restore it.
+   static NesMachine* SELECT ( NesMachine* machine );
+
+   // Save this machine's emulation state to a binary save-state (see
+   // cnesstate.h).  Returns the size of the save-state, or 0 if it does not
+   // fit in the passed buffer.  Passing no buffer returns the size only.
+   uint32_t SAVESTATE ( uint8_t* buffer, uint32_t size );
+
+   // Restore this machine's emulation state from a binary save-state.  Fails
+   // without touching the machine if the save-state is damaged, from another
+   // build, or was taken with a different cartridge or system mode loaded.
+   bool LOADSTATE ( const uint8_t* buffer, uint32_t size );
+
+   // Keep a save-state of this machine in memory, and put it back.  The
+   // snapshot was taken by this machine, so RESTORE skips the checks that
+   // LOADSTATE makes.  This is cheap enough to do every frame (run-ahead).
+   bool SNAPSHOT ( void );
+   bool RESTORE ( void );
+
+   // Accessor method to retrieve this machine's rewind history.
+   inline CNESRewind* REWIND ( void )
+   {
+      return &m_rewind;
+   }
+
+private:
+   // Used only to construct the default machine.
+   NesMachine ( bool isDefault );
+
+   // The mapper states are saved as raw blocks; they hold only registers.
+   struct StateBlock
+   {
+      uint16_t id;
+      void*    data;
+      uint32_t size;
+   };
+   enum { NUM_MAPPER_STATES = 28 };
+   void MAPPERSTATES ( StateBlock* blocks );
+   bool CHECKSTATE ( const uint8_t* buffer, uint32_t size );
+   bool APPLYSTATE ( const uint8_t* buffer, uint32_t size );
+
+   bool m_bDefault;
+
+   CNESRewind m_rewind;
+
+   uint8_t* m_pSnapshot;
+   uint32_t m_snapshotSize;
+   uint32_t m_snapshotLength;
+
+   CNES::State* m_pNESState;
+   C6502::State* m_p6502State;
+   CPPU::State* m_pPPUState;
+   CAPU::State* m_pAPUState;
+   CROM::State* m_pROMState;
+   CIO::State* m_pIOState;
+   CIOStandardJoypad::State* m_pIOStandardJoypadState;
+   CIOTurboJoypad::State* m_pIOTurboJoypadState;
+   CIOVaus::State* m_pIOVausState;
+   CCodeDataLogger::State* m_pCodeDataLoggerState;
+   CNESPerf::State* m_pPerfState;
+   CROMMapper001::State* m_pROMMapper001State;
+   CROMMapper002::State* m_pROMMapper002State;
+   CROMMapper003::State* m_pROMMapper003State;
+   CROMMapper004::State* m_pROMMapper004State;
+   CROMMapper005::State* m_pROMMapper005State;
+   CROMMapper007::State* m_pROMMapper007State;
+   CROMMapper009::State* m_pROMMapper009State;
+   CROMMapper010::State* m_pROMMapper010State;
+   CROMMapper011::State* m_pROMMapper011State;
+   CROMMapper013::State* m_pROMMapper013State;
+   CROMMapper016::State* m_pROMMapper016State;
+   CROMMapper018::State* m_pROMMapper018State;
+   CROMMapper019::State* m_pROMMapper019State;
+   CROMMapper021::State* m_pROMMapper021State;
+   CROMMapper022::State* m_pROMMapper022State;
+   CROMMapper023::State* m_pROMMapper023State;
+   CROMMapper024::State* m_pROMMapper024State;
+   CROMMapper025::State* m_pROMMapper025State;
+   CROMMapper026::State* m_pROMMapper026State;
+   CROMMapper028::State* m_pROMMapper028State;
+   CROMMapper033::State* m_pROMMapper033State;
+   CROMMapper034::State* m_pROMMapper034State;
+   CROMMapper065::State* m_pROMMapper065State;
+   CROMMapper068::State* m_pROMMapper068State;
+   CROMMapper069::State* m_pROMMapper069State;
+   CROMMapper073::State* m_pROMMapper073State;
+   CROMMapper075::State* m_pROMMapper075State;
+   CROMMapper111::State* m_pROMMapper111State;
+
+   static thread_local NesMachine* m_current;
+};
+
+#endif
@@ -3,11 +3,15 @@
 
 #include "nes_emulator_core.h"
 
+#define MAPPER_IDLE_FOREVER 0xFFFFFFFF
+
 typedef void (*RESETFUNC)(bool soft);
 typedef uint32_t (*MAPPERRFUNC)(uint32_t addr);
 typedef void (*MAPPERWFUNC)(uint32_t addr, uint8_t data);
 typedef void (*SYNCPPUFUNC)(uint32_t ppuCycle, uint32_t ppuAddr);
 typedef void (*SYNCCPUFUNC)(void);
+typedef uint32_t (*CPUIDLEFUNC)(void);
+typedef void (*SKIPCPUFUNC)(uint32_t cycles);
 typedef uint16_t (*SOUNDFUNC)(void);
 typedef void (*SOUNDENAFUNC)(uint32_t mask);
 
@@ -20,6 +24,12 @@ typedef struct _MapperFuncs
    MAPPERWFUNC  lowwrite;
    SYNCPPUFUNC  sync_ppu;
    SYNCCPUFUNC  sync_cpu;
+   // How many of the coming sync_cpu calls can do nothing anyone would
+   // notice before they are asked about (no IRQ, in particular), or
+   // MAPPER_IDLE_FOREVER.  skip_cpu stands in for that many of them in
+   // one go.  See CNES::MAPPERCLOCK.
+   CPUIDLEFUNC  cpu_idle;
+   SKIPCPUFUNC  skip_cpu;
    MAPPERRFUNC  debuginfo;
    SOUNDFUNC    amplitude;
    SOUNDENAFUNC soundenable;
@@ -27,10 +37,14 @@ typedef struct _MapperFuncs
    bool     remapChr;
    bool     remapVram;
    uint32_t vramSize;
+   // The PPU addresses sync_ppu needs to see: an address whose
+   // ppuEdgeMask bits differ from those of the address before it, or
+   // one with all of its ppuMatchMask bits set.  With both zero it sees
+   // every address.  See CPPU::SYNCMAPPER.
+   uint16_t ppuEdgeMask;
+   uint16_t ppuMatchMask;
 } MapperFuncs;
 
 extern MapperFuncs _mapperfunc[];
 
-extern MapperFuncs* MAPPERFUNC;
-
 #endif
@@ -0,0 +1,73 @@
+//    NESICIDE - an IDE for the 8-bit NES.
+//    Copyright (C) 2009  Christopher S. Pow
+
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "cnesperf.h"
+
+#include <string.h>
+#include <chrono>
+
+CNESPerf::State CNESPerf::m_defaultState;
+thread_local CNESPerf::State* CNESPerf::m_state = &CNESPerf::m_defaultState;
+
+static uint64_t wallClockNs ( void )
+{
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void CNESPerf::FRAMEBEGIN ( void )
+{
+   memset ( m_state->m_ticks, 0, sizeof(m_state->m_ticks) );
+   memset ( m_state->m_calls, 0, sizeof(m_state->m_calls) );
+   m_state->m_waitTicks = 0;
+   m_state->m_frameStart = wallClockNs();
+   m_state->m_frameTicks = TICKS();
+}
+
+void CNESPerf::FRAMEEND ( uint32_t frame )
+{
+   uint64_t ticks = TICKS()-m_state->m_frameTicks;
+   uint64_t ns = wallClockNs()-m_state->m_frameStart;
+   double   nsPerTick = ticks ? (((double)ns)/ticks) : 0.0;
+   int32_t  idx;
+
+   m_state->m_last.frame = frame;
+   m_state->m_last.waitNs = m_state->m_waitTicks*nsPerTick;
+   m_state->m_last.frameNs = ns-m_state->m_last.waitNs;
+   for ( idx = 0; idx < eNESPerf_Count; idx++ )
+   {
+      m_state->m_last.ns[idx] = m_state->m_ticks[idx]*nsPerTick;
+      m_state->m_last.calls[idx] = m_state->m_calls[idx];
+   }
+}
+
+void CNESPerf::WAITEND ( void )
+{
+   uint64_t ticks = TICKS()-m_state->m_waitStart;
+
+   m_state->m_waitTicks += ticks;
+
+   // Take it off the scope that called the hook; the scopes outside that
+   // one already leave out what it took.
+   if ( m_state->m_pScope )
+   {
+      m_state->m_pScope->m_childTicks += ticks;
+   }
+}
+
+void CNESPerf::GET ( NesPerfCounters* counters )
+{
+   (*counters) = m_state->m_last;
+}
@@ -0,0 +1,154 @@
+#if !defined ( NES_PERF_H )
+#define NES_PERF_H
+
+#include "nes_emulator_core.h"
+
+// Hot-path timers and event counters (see nesGetPerfCounters).
+//
+// NESPERFSCOPE(counter) at the top of a function times the rest of the
+// function against that counter and counts the call.  Where a function
+// is called far more often than it does any work, NESPERFCOUNT counts
+// the call and NESPERFTIME in the part that does the work times it
+// without counting it again.  Scopes nest: when
+// one finishes, its time is taken off whichever scope it ran inside, so
+// every counter ends up with the time spent in its own code only.  Time
+// is read from the processor's time-stamp counter where there is one and
+// converted to nanoseconds once a frame, against the wall clock, so a
+// scope costs two counter reads and a few stores.
+//
+// Time the emulator thread spends stopped in the breakpoint or audio
+// hooks is not anybody's: NESPERFWAITBEGIN/END around the hook take it
+// off the scope it happened in and off the frame.
+//
+// Without NES_PERF_COUNTERS the macros are empty and none of this is
+// compiled into the hot paths.
+#if defined ( NES_PERF_COUNTERS )
+
+#if defined ( __x86_64__ ) || defined ( __i386__ ) || defined ( _M_X64 ) || defined ( _M_IX86 )
+#if defined ( _MSC_VER )
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define NES_PERF_TSC
+#else
+#include <chrono>
+#endif
+
+#endif
+
+class CNESPerfScope;
+
+class CNESPerf
+{
+public:
+   static inline uint64_t TICKS ( void )
+   {
+#if defined ( NES_PERF_TSC )
+      return __rdtsc();
+#elif defined ( NES_PERF_COUNTERS )
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+      return 0;
+#endif
+   }
+
+   // Bracket one frame.  FRAMEEND converts what was counted since
+   // FRAMEBEGIN and keeps it for GET.
+   static void FRAMEBEGIN ( void );
+   static void FRAMEEND ( uint32_t frame );
+
+   static inline void COUNT ( eNESPerfCounter counter )
+   {
+      m_state->m_calls[counter]++;
+   }
+
+   // Bracket a wait in a hook.
+   static inline void WAITBEGIN ( void )
+   {
+      m_state->m_waitStart = TICKS();
+   }
+   static void WAITEND ( void );
+
+   // Counters for the last frame run.
+   static void GET ( NesPerfCounters* counters );
+
+protected:
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      // Frame being run.
+      uint64_t m_ticks [ eNESPerf_Count ] = { 0 };
+      uint32_t m_calls [ eNESPerf_Count ] = { 0 };
+      uint64_t m_frameTicks = 0;
+      uint64_t m_frameStart = 0;
+      uint64_t m_waitTicks = 0;
+      uint64_t m_waitStart = 0;
+      CNESPerfScope* m_pScope = NULL;
+
+      // Last frame run.
+      NesPerfCounters m_last = { 0, 0, 0, { 0 }, { 0 } };
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
+   friend class CNESPerfScope;
+};
+
+class CNESPerfScope
+{
+public:
+   inline CNESPerfScope ( eNESPerfCounter counter, bool count = true )
+      : m_counter(counter),
+        m_count(count),
+        m_childTicks(0)
+   {
+      m_pParent = CNESPerf::m_state->m_pScope;
+      CNESPerf::m_state->m_pScope = this;
+      m_start = CNESPerf::TICKS();
+   }
+   inline ~CNESPerfScope ()
+   {
+      uint64_t ticks = CNESPerf::TICKS()-m_start;
+
+      CNESPerf::m_state->m_ticks[m_counter] += ticks-m_childTicks;
+      if ( m_count )
+      {
+         CNESPerf::m_state->m_calls[m_counter]++;
+      }
+      if ( m_pParent )
+      {
+         m_pParent->m_childTicks += ticks;
+      }
+      CNESPerf::m_state->m_pScope = m_pParent;
+   }
+
+private:
+   friend class CNESPerf;
+
+   eNESPerfCounter m_counter;
+   bool            m_count;
+   uint64_t        m_start;
+   uint64_t        m_childTicks;
+   CNESPerfScope*  m_pParent;
+};
+
+#if defined ( NES_PERF_COUNTERS )
+#define NESPERFSCOPE(counter) CNESPerfScope __nesPerfScope ( counter )
+#define NESPERFTIME(counter) CNESPerfScope __nesPerfScope ( counter, false )
+#define NESPERFCOUNT(counter) CNESPerf::COUNT ( counter )
+#define NESPERFFRAMEBEGIN() CNESPerf::FRAMEBEGIN ()
+#define NESPERFFRAMEEND(frame) CNESPerf::FRAMEEND ( frame )
+#define NESPERFWAITBEGIN() CNESPerf::WAITBEGIN ()
+#define NESPERFWAITEND() CNESPerf::WAITEND ()
+#else
+#define NESPERFSCOPE(counter)
+#define NESPERFTIME(counter)
+#define NESPERFCOUNT(counter)
+#define NESPERFFRAMEBEGIN()
+#define NESPERFFRAMEEND(frame)
+#define NESPERFWAITBEGIN()
+#define NESPERFWAITEND()
+#endif
+
+#endif
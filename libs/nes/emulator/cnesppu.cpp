@@ -20,6 +20,7 @@
 #include "cnes6502.h"
 #include "cnesrom.h"
 #include "cnesapu.h"
+#include "cnesperf.h"
 
 #include "nes_emulator_core.h"
 
@@ -666,231 +667,429 @@ static CBreakpointEventInfo* tblPPUEvents [] =
 CBreakpointEventInfo** CPPU::m_tblBreakpointEvents = tblPPUEvents;
 int32_t                CPPU::m_numBreakpointEvents = NUM_PPU_EVENTS;
 
-uint8_t* CPPU::m_PPUmemory = NULL;
-uint8_t  CPPU::m_PALETTEmemory [] = { 0, };
-uint8_t* CPPU::m_pPPUmemory [] = { NULL, };
-uint8_t  CPPU::m_oamAddr = 0x00;
-int32_t  CPPU::m_ppuRegByte = 0;
-uint16_t CPPU::m_ppuAddr = 0x0000;
-uint8_t  CPPU::m_ppuAddrIncrement = 1;
-uint16_t CPPU::m_ppuAddrLatch = 0x0000;
-uint8_t  CPPU::m_ppuReadLatch = 0x00;
-uint8_t  CPPU::m_ppuIOLatch = 0x00;
-uint8_t  CPPU::m_ppuIOLatchDecayFrames [] = { 0, };
-uint8_t  CPPU::m_PPUreg [] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
-uint8_t  CPPU::m_PPUoam [] = { 0x00, };
-uint8_t  CPPU::m_ppuScrollX = 0x00;
-int32_t        CPPU::m_oneScreen = -1;
-bool           CPPU::m_extraVRAM = false;
-
-uint32_t   CPPU::m_cycles = 0;
-
-uint32_t CPPU::startVblank;
-uint32_t CPPU::quietScanlines;
-uint32_t CPPU::vblankScanlines;
-uint32_t CPPU::vblankEndCycle;
-uint32_t CPPU::prerenderScanline;
-uint32_t CPPU::cycleRatio;
-uint32_t CPPU::memoryDecayFrames;
-
-bool           CPPU::m_vblankChoked = false;
-bool           CPPU::m_nmiChoked = false;
-bool           CPPU::m_nmiReenabled = false;
-
-int8_t*          CPPU::m_pTV = NULL;
-
-uint32_t       CPPU::m_frame = 0;
-int32_t         CPPU::m_curCycles = 0;
-
-SpriteTemporaryMemory CPPU::m_spriteTemporaryMemory;
-SpriteBuffer          CPPU::m_spriteBuffer;
-
-BackgroundBuffer CPPU::m_bkgndBuffer;
-
-CCodeDataLogger* CPPU::m_logger = NULL;
-
-uint8_t  CPPU::m_last2005x = 0;
-uint8_t  CPPU::m_last2005y = 0;
-uint16_t** CPPU::m_2005x = NULL;
-uint16_t** CPPU::m_2005y = NULL;
-uint8_t  CPPU::m_lastSprite0HitX = 0;
-uint8_t  CPPU::m_lastSprite0HitY = 0;
-uint8_t  CPPU::m_x = 0xFF;
-uint8_t  CPPU::m_y = 0xFF;
+uint8_t CPPU::m_dotActions [ ePPULine_Count ][ PPU_CYCLES_PER_SCANLINE ];
+uint8_t CPPU::m_lineKinds [ 3 ][ SCANLINES_TOTAL_PAL ];
+uint64_t CPPU::m_bkgndSpread [ 256 ];
+
+CPPU::State CPPU::m_defaultState;
+thread_local CPPU::State* CPPU::m_state = &CPPU::m_defaultState;
 
 static CPPU __init __attribute__((unused));
 
 CPPU::CPPU()
+{
+   BUILDDOTTABLES();
+   BUILDBKGNDSPANTABLE();
+   CREATE();
+}
+
+void CPPU::BUILDDOTTABLES ( void )
+{
+   static const uint32_t quietScanlines [ 3 ] = { SCANLINES_QUIET_NTSC, SCANLINES_QUIET_PAL, SCANLINES_QUIET_DENDY };
+   static const uint32_t vblankScanlines [ 3 ] = { SCANLINES_VBLANK_NTSC, SCANLINES_VBLANK_PAL, SCANLINES_VBLANK_DENDY };
+   static const uint32_t prerenderScanline [ 3 ] = { SCANLINE_PRERENDER_NTSC, SCANLINE_PRERENDER_PAL, SCANLINE_PRERENDER_DENDY };
+   uint32_t mode;
+   uint32_t scanline;
+   uint32_t vblankScanline;
+   uint32_t dot;
+
+   memset(m_dotActions,0,sizeof(m_dotActions));
+
+   for ( dot = 0; dot < PPU_CYCLES_PER_SCANLINE; dot++ )
+   {
+      // Rendering walks the PPU address through the nametable: a tile to
+      // the right every eight dots, down a row of pixels near the end of
+      // the line and back to the left edge at the start of sprite fetches.
+      if ( dot == 257 )
+      {
+         m_dotActions[ePPULine_Visible][dot] |= PPU_DOT_HSCROLL_RELOAD;
+      }
+      else
+      {
+         if ( dot == 251 )
+         {
+            m_dotActions[ePPULine_Visible][dot] |= PPU_DOT_Y_INCREMENT;
+         }
+         if ( ((dot%8) == 3) && ((dot < 256) || (dot == 323) || (dot == 331)) )
+         {
+            m_dotActions[ePPULine_Visible][dot] |= PPU_DOT_X_INCREMENT;
+         }
+      }
+
+      // The pre-render line reloads the whole address for the new frame.
+      if ( dot == 304 )
+      {
+         m_dotActions[ePPULine_Prerender][dot] |= PPU_DOT_VSCROLL_RELOAD;
+      }
+
+      // NMI re-enabled during VBLANK fires right away, bar the last dot
+      // of each line.
+      if ( dot < PPU_CYCLES_PER_SCANLINE-1 )
+      {
+         m_dotActions[ePPULine_VblankStart][dot] |= PPU_DOT_VBLANK;
+         m_dotActions[ePPULine_Vblank][dot] |= PPU_DOT_VBLANK;
+         m_dotActions[ePPULine_VblankOAMClear][dot] |= PPU_DOT_VBLANK;
+      }
+   }
+   m_dotActions[ePPULine_VblankStart][1] |= PPU_DOT_NMI;
+   m_dotActions[ePPULine_VblankOAMClear][316] |= PPU_DOT_OAM_CLEAR;
+
+   for ( mode = MODE_NTSC; mode <= MODE_DENDY; mode++ )
+   {
+      for ( scanline = 0; scanline < SCANLINES_TOTAL_PAL; scanline++ )
+      {
+         vblankScanline = scanline-(SCANLINES_VISIBLE+quietScanlines[mode]);
+
+         if ( scanline < SCANLINES_VISIBLE )
+         {
+            m_lineKinds[mode][scanline] = ePPULine_Visible;
+         }
+         else if ( scanline == prerenderScanline[mode] )
+         {
+            m_lineKinds[mode][scanline] = ePPULine_Prerender;
+         }
+         else if ( (scanline < SCANLINES_VISIBLE+quietScanlines[mode]) ||
+                   (vblankScanline >= vblankScanlines[mode]) )
+         {
+            m_lineKinds[mode][scanline] = ePPULine_Idle;
+         }
+         else if ( vblankScanline == 0 )
+         {
+            m_lineKinds[mode][scanline] = ePPULine_VblankStart;
+         }
+         else if ( vblankScanline == 19 )
+         {
+            m_lineKinds[mode][scanline] = ePPULine_VblankOAMClear;
+         }
+         else
+         {
+            m_lineKinds[mode][scanline] = ePPULine_Vblank;
+         }
+      }
+   }
+}
+
+CPPU::~CPPU()
+{
+   DESTROY();
+}
+
+void CPPU::CREATE ( void )
 {
    int idx;
 
-   m_logger = new CCodeDataLogger ( MEM_16KB, MASK_16KB );
+   m_state->m_logger = new CCodeDataLogger ( MEM_16KB, MASK_16KB );
 
-   m_2005x = new uint16_t*[256];
+   m_state->m_2005x = new uint16_t*[256];
    for ( idx = 0; idx < 256; idx++ )
    {
-      m_2005x[idx] = new uint16_t[240];
+      m_state->m_2005x[idx] = new uint16_t[240];
+      memset ( m_state->m_2005x[idx], 0, 240*sizeof(uint16_t) );
    }
-   m_2005y = new uint16_t*[256];
+   m_state->m_2005y = new uint16_t*[256];
    for ( idx = 0; idx < 256; idx++ )
    {
-      m_2005y[idx] = new uint16_t[240];
+      m_state->m_2005y[idx] = new uint16_t[240];
+      memset ( m_state->m_2005y[idx], 0, 240*sizeof(uint16_t) );
    }
 
-   m_PPUmemory = new uint8_t[MEM_2KB];
+   m_state->m_PPUmemory = new uint8_t[MEM_2KB];
+   memset ( m_state->m_PPUmemory, 0, MEM_2KB );
 
    // Set up default mapping.
    for ( idx = 0; idx < 8; idx++ )
    {
-      m_pPPUmemory[idx] = m_PPUmemory+((idx&1)<<UPSHIFT_1KB);
+      m_state->m_pPPUmemory[idx] = m_state->m_PPUmemory+((idx&1)<<UPSHIFT_1KB);
    }
 }
 
-CPPU::~CPPU()
+void CPPU::DESTROY ( void )
 {
    int idx;
 
-   delete m_logger;
+   delete m_state->m_logger;
    for ( idx = 0; idx < 256; idx++ )
    {
-      delete [] m_2005x[idx];
+      delete [] m_state->m_2005x[idx];
    }
-   delete [] m_2005x;
+   delete [] m_state->m_2005x;
    for ( idx = 0; idx < 256; idx++ )
    {
-      delete [] m_2005y[idx];
+      delete [] m_state->m_2005y[idx];
    }
-   delete [] m_2005y;
+   delete [] m_state->m_2005y;
 
-   delete [] m_PPUmemory;
+   delete [] m_state->m_PPUmemory;
 }
 
-void CPPU::EMULATE(uint32_t cycles)
+void CPPU::SAVESTATE ( CNESStateWriter& state )
 {
-   uint32_t idxx = 0xffffffff;
-   uint32_t idxy = 0xffffffff;
+   uint32_t pointer;
+   int32_t  sprite;
+   int32_t  idx;
 
-   for ( ; cycles > 0; cycles-- )
+   state.BeginChunk ( NES_STATE_CHUNK_PPU, NES_STATE_VERSION_PPU );
+   state.Put ( m_state->m_PPUmemory, MEM_2KB );
+   state.Put ( m_state->m_PALETTEmemory );
+   state.Put ( m_state->m_PPUoam );
+   state.Put ( m_state->m_PPUreg );
+
+   // Nametables are either the PPU's own 2KB or memory on the cartridge.
+   for ( idx = 0; idx < 8; idx++ )
    {
-      // Get VBLANK raster position.
-      if ( m_cycles >= startVblank )
+      if ( (m_state->m_pPPUmemory[idx] >= m_state->m_PPUmemory) &&
+           (m_state->m_pPPUmemory[idx] < m_state->m_PPUmemory+MEM_2KB) )
       {
-         idxy = (m_cycles-startVblank)/PPU_CYCLES_PER_SCANLINE;
-         idxx = (m_cycles-startVblank)%PPU_CYCLES_PER_SCANLINE;
+         pointer = NES_STATE_POINTER(eStatePointer_CIRAM,m_state->m_pPPUmemory[idx]-m_state->m_PPUmemory);
+      }
+      else
+      {
+         pointer = CROM::POINTERTOSTATE ( m_state->m_pPPUmemory[idx] );
+      }
+      state.Put ( pointer );
+   }
+
+   state.Put ( m_state->m_ppuRegByte );
+   state.Put ( m_state->m_oamAddr );
+   state.Put ( m_state->m_ppuAddr );
+   state.Put ( m_state->m_ppuAddrLatch );
+   state.Put ( m_state->m_ppuAddrIncrement );
+   state.Put ( m_state->m_ppuReadLatch );
+   state.Put ( m_state->m_ppuIOLatch );
+   state.Put ( m_state->m_ppuIOLatchDecayFrames );
+   state.Put ( m_state->m_ppuScrollX );
+   state.Put ( m_state->m_oneScreen );
+   state.Put ( m_state->m_extraVRAM );
+   state.Put ( m_state->m_cycles );
+   state.Put ( m_state->m_frame );
+   state.Put ( m_state->m_curCycles );
+   state.Put ( m_state->m_vblankChoked );
+   state.Put ( m_state->m_nmiChoked );
+   state.Put ( m_state->m_nmiReenabled );
+   state.Put ( m_state->m_spriteTemporaryMemory );
+   state.Put ( m_state->m_spriteBuffer );
+   state.Put ( m_state->m_bkgndBuffer );
+   state.Put ( m_state->m_last2005x );
+   state.Put ( m_state->m_last2005y );
+   state.Put ( m_state->m_lastSprite0HitX );
+   state.Put ( m_state->m_lastSprite0HitY );
+   state.Put ( m_state->m_x );
+   state.Put ( m_state->m_y );
+   state.Put ( m_state->m_patternIdx );
+   state.Put ( m_state->m_bkgndTemp );
+   state.Put ( m_state->m_spriteDevNull );
+   state.Put ( m_state->m_spritesFound );
+
+   // The sprite being evaluated is either a slot in secondary OAM or
+   // the bit bucket once secondary OAM is full.
+   sprite = -1;
+   if ( m_state->m_pSprite != &m_state->m_spriteDevNull )
+   {
+      sprite = m_state->m_pSprite-m_state->m_spriteTemporaryMemory.data;
+   }
+   state.Put ( sprite );
+   state.EndChunk ();
+}
+
+bool CPPU::LOADSTATE ( CNESStateReader& state )
+{
+   uint32_t pointer [ 8 ];
+   int32_t  sprite = -1;
+   int32_t  idx;
+   bool     ok;
+
+   if ( !state.FindChunk(NES_STATE_CHUNK_PPU,NES_STATE_VERSION_PPU) )
+   {
+      return false;
+   }
+   ok = state.Get ( m_state->m_PPUmemory, MEM_2KB ) &&
+        state.Get ( m_state->m_PALETTEmemory ) &&
+        state.Get ( m_state->m_PPUoam ) &&
+        state.Get ( m_state->m_PPUreg ) &&
+        state.Get ( pointer ) &&
+        state.Get ( m_state->m_ppuRegByte ) &&
+        state.Get ( m_state->m_oamAddr ) &&
+        state.Get ( m_state->m_ppuAddr ) &&
+        state.Get ( m_state->m_ppuAddrLatch ) &&
+        state.Get ( m_state->m_ppuAddrIncrement ) &&
+        state.Get ( m_state->m_ppuReadLatch ) &&
+        state.Get ( m_state->m_ppuIOLatch ) &&
+        state.Get ( m_state->m_ppuIOLatchDecayFrames ) &&
+        state.Get ( m_state->m_ppuScrollX ) &&
+        state.Get ( m_state->m_oneScreen ) &&
+        state.Get ( m_state->m_extraVRAM ) &&
+        state.Get ( m_state->m_cycles ) &&
+        state.Get ( m_state->m_frame ) &&
+        state.Get ( m_state->m_curCycles ) &&
+        state.Get ( m_state->m_vblankChoked ) &&
+        state.Get ( m_state->m_nmiChoked ) &&
+        state.Get ( m_state->m_nmiReenabled ) &&
+        state.Get ( m_state->m_spriteTemporaryMemory ) &&
+        state.Get ( m_state->m_spriteBuffer ) &&
+        state.Get ( m_state->m_bkgndBuffer ) &&
+        state.Get ( m_state->m_last2005x ) &&
+        state.Get ( m_state->m_last2005y ) &&
+        state.Get ( m_state->m_lastSprite0HitX ) &&
+        state.Get ( m_state->m_lastSprite0HitY ) &&
+        state.Get ( m_state->m_x ) &&
+        state.Get ( m_state->m_y ) &&
+        state.Get ( m_state->m_patternIdx ) &&
+        state.Get ( m_state->m_bkgndTemp ) &&
+        state.Get ( m_state->m_spriteDevNull ) &&
+        state.Get ( m_state->m_spritesFound ) &&
+        state.Get ( sprite );
+
+   if ( ok )
+   {
+      SYNCDOT ();
+      MAPPERWATCH ();
+
+      for ( idx = 0; idx < 8; idx++ )
+      {
+         if ( NES_STATE_POINTER_REGION(pointer[idx]) == eStatePointer_CIRAM )
+         {
+            m_state->m_pPPUmemory[idx] = m_state->m_PPUmemory+(NES_STATE_POINTER_OFFSET(pointer[idx])&MASK_2KB);
+         }
+         else if ( pointer[idx] != NES_STATE_POINTER_INVALID )
+         {
+            m_state->m_pPPUmemory[idx] = CROM::STATETOPOINTER ( pointer[idx] );
+         }
       }
+   }
+
+   if ( (sprite >= 0) && (sprite < NUM_SPRITES_PER_SCANLINE) )
+   {
+      m_state->m_pSprite = m_state->m_spriteTemporaryMemory.data+sprite;
+   }
+   else
+   {
+      m_state->m_pSprite = &m_state->m_spriteDevNull;
+   }
+
+   return ok;
+}
+
+template<bool Debuggable>
+void CPPU::EMULATE(uint32_t cycles)
+{
+   uint8_t actions;
+
+   for ( ; cycles > 0; cycles-- )
+   {
+      // What needs doing on this dot...
+      actions = m_state->m_pDotActions[m_state->m_dot];
 
       // We're emulating one PPU cycle...
-      m_curCycles += CPU_CYCLE_ADJUST;
+      m_state->m_curCycles += CPU_CYCLE_ADJUST;
 
       // Update PPU address from latch at appropriate times...
       // Re-latch PPU address...
-      if ( rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) )
+      if ( (actions&PPU_DOT_SCROLL) &&
+           (rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES)) )
       {
-         if ( ((m_cycles%PPU_CYCLES_PER_SCANLINE) == 257) &&
-               ((m_cycles/PPU_CYCLES_PER_SCANLINE) < SCANLINES_VISIBLE) )
+         if ( actions&PPU_DOT_HSCROLL_RELOAD )
          {
-            m_ppuAddr &= 0xFBE0;
-            m_ppuAddr |= m_ppuAddrLatch&0x41F;
+            m_state->m_ppuAddr &= 0xFBE0;
+            m_state->m_ppuAddr |= m_state->m_ppuAddrLatch&0x41F;
          }
-         else if ( ((m_cycles%PPU_CYCLES_PER_SCANLINE) == 304) &&
-                   ((m_cycles/PPU_CYCLES_PER_SCANLINE) == prerenderScanline) )
+         else if ( actions&PPU_DOT_VSCROLL_RELOAD )
          {
-            m_ppuAddr = m_ppuAddrLatch;
+            m_state->m_ppuAddr = m_state->m_ppuAddrLatch;
          }
-         else if ( (m_cycles/PPU_CYCLES_PER_SCANLINE) < SCANLINES_VISIBLE )
+         else
          {
-            if ( (m_cycles%PPU_CYCLES_PER_SCANLINE) == 251 )
+            if ( actions&PPU_DOT_Y_INCREMENT )
             {
-               if ( (m_ppuAddr&0x7000) == 0x7000 )
+               if ( (m_state->m_ppuAddr&0x7000) == 0x7000 )
                {
-                  m_ppuAddr &= 0x8FFF;
+                  m_state->m_ppuAddr &= 0x8FFF;
 
-                  if ( (m_ppuAddr&0x03E0) == 0x03A0 )
+                  if ( (m_state->m_ppuAddr&0x03E0) == 0x03A0 )
                   {
-                     m_ppuAddr ^= 0x0800;
-                     m_ppuAddr &= 0xFC1F;
+                     m_state->m_ppuAddr ^= 0x0800;
+                     m_state->m_ppuAddr &= 0xFC1F;
                   }
                   else
                   {
-                     if ( (m_ppuAddr&0x03E0) == 0x03E0 )
+                     if ( (m_state->m_ppuAddr&0x03E0) == 0x03E0 )
                      {
-                        m_ppuAddr &= 0xFC1F;
+                        m_state->m_ppuAddr &= 0xFC1F;
                      }
                      else
                      {
-                        m_ppuAddr += 0x0020;
+                        m_state->m_ppuAddr += 0x0020;
                      }
                   }
                }
                else
                {
-                  m_ppuAddr += 0x1000;
+                  m_state->m_ppuAddr += 0x1000;
                }
             }
 
-            if ( (((m_cycles%PPU_CYCLES_PER_SCANLINE)%8) == 3) &&
-                  (((m_cycles%PPU_CYCLES_PER_SCANLINE) < 256) ||
-                   ((m_cycles%PPU_CYCLES_PER_SCANLINE) == 323) ||
-                   ((m_cycles%PPU_CYCLES_PER_SCANLINE) == 331)) )
+            if ( actions&PPU_DOT_X_INCREMENT )
             {
-               if ( (m_ppuAddr&0x001F) != 0x001F )
+               if ( (m_state->m_ppuAddr&0x001F) != 0x001F )
                {
-                  m_ppuAddr++;
+                  m_state->m_ppuAddr++;
                }
                else
                {
-                  m_ppuAddr ^= 0x041F;
+                  m_state->m_ppuAddr ^= 0x041F;
                }
             }
          }
       }
 
       // Run 0 or 1 CPU cycles...
-      C6502::EMULATE ( m_curCycles/cycleRatio );
+      C6502::CATCHUP<Debuggable> ( m_state->m_curCycles/m_state->cycleRatio );
 
       // Adjust current cycle count...
-      m_curCycles %= cycleRatio;
+      m_state->m_curCycles %= m_state->cycleRatio;
 
       // Turn off NMI choking if it shouldn't be...
-      if ( m_cycles > startVblank+1 )
+      if ( m_state->m_cycles > m_state->startVblank+1 )
       {
          NMICHOKED ( false );
       }
 
       // Turn off NMI re-enablement if it shouldn't be...
-      if ( m_cycles > vblankEndCycle )
+      if ( m_state->m_cycles > m_state->vblankEndCycle )
       {
          NMIREENABLED ( false );
       }
 
-      if ( nesIsDebuggable() )
+      if ( Debuggable )
       {
          // Check for breakpoints...
          CNES::CHECKBREAKPOINT ( eBreakInPPU, eBreakOnPPUCycle );
       }
 
       if ( (rPPU(PPUCTRL)&PPUCTRL_GENERATE_NMI) &&
-            (((!NMICHOKED()) && (idxy == 0) && (idxx == 1)) ||
-             ((NMIREENABLED()) && (idxy <= vblankScanlines-1) && (idxx < PPU_CYCLES_PER_SCANLINE-1))) )
+            (((!NMICHOKED()) && (actions&PPU_DOT_NMI)) ||
+             ((NMIREENABLED()) && (actions&PPU_DOT_VBLANK))) )
       {
          C6502::ASSERTNMI ();
 
-         // Check for PPU NMI breakpoint...
-         CNES::CHECKBREAKPOINT ( eBreakInPPU, eBreakOnPPUEvent, 0, PPU_EVENT_NMI );
+         if ( Debuggable )
+         {
+            // Check for PPU NMI breakpoint...
+            CNES::CHECKBREAKPOINT ( eBreakInPPU, eBreakOnPPUEvent, 0, PPU_EVENT_NMI );
+         }
       }
 
       // Clear OAM at appropriate point...
       // Note the appropriate point comes from blargg's discussion on nesdev forum:
       // http://nesdev.parodius.com/bbs/viewtopic.php?t=1366&highlight=sprite+address+clear
-      if ( (rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) == (PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES)) &&
-           (idxy == 19) && (idxx == 316) )
+      if ( (actions&PPU_DOT_OAM_CLEAR) &&
+           (rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) == (PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES)) )
       {
-         m_oamAddr = 0x00;
+         m_state->m_oamAddr = 0x00;
       }
 
       // Internal cycle counter keeps track of stuff needing to happen
       // at particular PPU frame cycles.  It is reset at the end of a frame.
-      m_cycles++;
+      ADVANCEDOTS ( 1 );
    }
 }
 
@@ -907,7 +1106,7 @@ uint32_t CPPU::LOAD ( uint32_t addr, int8_t source, int8_t type, bool trace )
       // Add Tracer sample...
       if ( nesIsDebuggable() && trace )
       {
-         CNES::TRACER()->AddSample ( m_cycles, type, source, eTarget_PatternMemory, addr, data );
+         CNES::TRACER()->AddSample ( m_state->m_cycles, type, source, eTarget_PatternMemory, addr, data );
       }
 
       return data;
@@ -915,12 +1114,12 @@ uint32_t CPPU::LOAD ( uint32_t addr, int8_t source, int8_t type, bool trace )
 
    if ( addr >= 0x3F00 )
    {
-      data = *(m_PALETTEmemory+(addr&0x1F));
+      data = *(m_state->m_PALETTEmemory+(addr&0x1F));
 
       // Add Tracer sample...
       if ( nesIsDebuggable() && trace )
       {
-         CNES::TRACER()->AddSample ( m_cycles, type, source, eTarget_Palette, addr, data );
+         CNES::TRACER()->AddSample ( m_state->m_cycles, type, source, eTarget_Palette, addr, data );
       }
 
       return data;
@@ -934,7 +1133,7 @@ uint32_t CPPU::LOAD ( uint32_t addr, int8_t source, int8_t type, bool trace )
    }
    else
    {
-      data = *((*(m_pPPUmemory+((addr&0x1FFF)>>10)))+(addr&0x3FF));
+      data = *((*(m_state->m_pPPUmemory+((addr&0x1FFF)>>10)))+(addr&0x3FF));
    }
 
    // Add Tracer sample...
@@ -942,11 +1141,11 @@ uint32_t CPPU::LOAD ( uint32_t addr, int8_t source, int8_t type, bool trace )
    {
       if ( (addr&0x3FF) < 0x3C0 )
       {
-         CNES::TRACER()->AddSample ( m_cycles, type, source, eTarget_NameTable, addr, data );
+         CNES::TRACER()->AddSample ( m_state->m_cycles, type, source, eTarget_NameTable, addr, data );
       }
       else
       {
-         CNES::TRACER()->AddSample ( m_cycles, type, source, eTarget_AttributeTable, addr, data );
+         CNES::TRACER()->AddSample ( m_state->m_cycles, type, source, eTarget_AttributeTable, addr, data );
       }
    }
 
@@ -962,7 +1161,7 @@ void CPPU::STORE ( uint32_t addr, uint8_t data, int8_t source, int8_t type, bool
       // Add Tracer sample...
       if ( nesIsDebuggable() && trace )
       {
-         CNES::TRACER()->AddSample ( m_cycles, type, source, eTarget_PatternMemory, addr, data );
+         CNES::TRACER()->AddSample ( m_state->m_cycles, type, source, eTarget_PatternMemory, addr, data );
       }
 
       if ( CROM::IsWriteProtected() == false )
@@ -978,17 +1177,17 @@ void CPPU::STORE ( uint32_t addr, uint8_t data, int8_t source, int8_t type, bool
       // Add Tracer sample...
       if ( nesIsDebuggable() && trace )
       {
-         CNES::TRACER()->AddSample ( m_cycles, type, source, eTarget_Palette, addr, data );
+         CNES::TRACER()->AddSample ( m_state->m_cycles, type, source, eTarget_Palette, addr, data );
       }
 
       if ( !(addr&0xF) )
       {
-         *(m_PALETTEmemory+0x00) = data;
-         *(m_PALETTEmemory+0x10) = data;
+         *(m_state->m_PALETTEmemory+0x00) = data;
+         *(m_state->m_PALETTEmemory+0x10) = data;
       }
       else
       {
-         *(m_PALETTEmemory+(addr&0x1F)) = data;
+         *(m_state->m_PALETTEmemory+(addr&0x1F)) = data;
       }
 
       return;
@@ -1001,11 +1200,11 @@ void CPPU::STORE ( uint32_t addr, uint8_t data, int8_t source, int8_t type, bool
    {
       if ( (addr&0x3FF) < 0x3C0 )
       {
-         CNES::TRACER()->AddSample ( m_cycles, type, source, eTarget_NameTable, addr, data );
+         CNES::TRACER()->AddSample ( m_state->m_cycles, type, source, eTarget_NameTable, addr, data );
       }
       else
       {
-         CNES::TRACER()->AddSample ( m_cycles, type, source, eTarget_AttributeTable, addr, data );
+         CNES::TRACER()->AddSample ( m_state->m_cycles, type, source, eTarget_AttributeTable, addr, data );
       }
    }
 
@@ -1015,28 +1214,132 @@ void CPPU::STORE ( uint32_t addr, uint8_t data, int8_t source, int8_t type, bool
    }
    else
    {
-      *((*(m_pPPUmemory+((addr&0x1FFF)>>10)))+(addr&0x3FF)) = data;
+      *((*(m_state->m_pPPUmemory+((addr&0x1FFF)>>10)))+(addr&0x3FF)) = data;
+   }
+}
+
+template<bool Debuggable>
+void CPPU::EMULATEIDLE ( uint32_t cycles )
+{
+   uint32_t nmiCycle = m_state->startVblank+1;
+   uint32_t oamClearCycle = m_state->startVblank+(19*PPU_CYCLES_PER_SCANLINE)+316;
+   uint32_t dots;
+   uint32_t cpuDots;
+
+   while ( cycles > 0 )
+   {
+      dots = cycles;
+
+      // The debugger wants to see every dot.  A pending NMI re-enable
+      // or a lapsing NMI choke is dealt with on the next dot.
+      if ( Debuggable ||
+           m_state->m_nmiReenabled ||
+           (m_state->m_nmiChoked && (m_state->m_cycles > nmiCycle)) )
+      {
+         dots = 0;
+      }
+
+      // Stop short of the dots EMULATE does something on by itself...
+      if ( (m_state->m_cycles <= nmiCycle) && (nmiCycle-m_state->m_cycles < dots) )
+      {
+         dots = nmiCycle-m_state->m_cycles;
+      }
+      if ( (m_state->m_cycles <= oamClearCycle) && (oamClearCycle-m_state->m_cycles < dots) )
+      {
+         dots = oamClearCycle-m_state->m_cycles;
+      }
+
+      // ...and of the dot on which the CPU is owed a cycle.
+      cpuDots = (((C6502::IDLECYCLES()+1)*m_state->cycleRatio)-1-m_state->m_curCycles)/CPU_CYCLE_ADJUST;
+      if ( cpuDots < dots )
+      {
+         dots = cpuDots;
+      }
+
+      if ( dots )
+      {
+         m_state->m_curCycles += dots*CPU_CYCLE_ADJUST;
+         m_state->m_cpuDots = dots;
+         C6502::CATCHUP<Debuggable> ( m_state->m_curCycles/m_state->cycleRatio );
+         m_state->m_cpuDots = 1;
+         m_state->m_curCycles %= m_state->cycleRatio;
+         ADVANCEDOTS ( dots );
+         cycles -= dots;
+      }
+      else
+      {
+         EMULATE<Debuggable> ( 1 );
+         cycles--;
+      }
+   }
+}
+
+uint32_t CPPU::CPUIDLECYCLES ( bool status )
+{
+   uint32_t vblankEnd = m_state->startVblank+(m_state->vblankScanlines*PPU_CYCLES_PER_SCANLINE);
+   uint32_t until = vblankEnd;
+
+   // NMI choking and re-enabling are left to EMULATE, dot by dot.
+   if ( m_state->m_nmiChoked || m_state->m_nmiReenabled || VBLANKCHOKED() )
+   {
+      return 0;
+   }
+
+   if ( (rPPU(PPUCTRL)&PPUCTRL_GENERATE_NMI) && (m_state->m_cycles <= m_state->startVblank+1) )
+   {
+      until = m_state->startVblank+1;
    }
+
+   if ( status )
+   {
+      // With rendering on the sprite flags can change on any visible
+      // scanline.  With it off PPUSTATUS only changes as VBLANK starts
+      // and ends.  Stop before the dot on which a read chokes VBLANK,
+      // and stay a scanline clear of VBLANK starting so that the read
+      // the CPU just made cannot have been of the old value.
+      if ( rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) )
+      {
+         return 0;
+      }
+      if ( m_state->m_cycles < m_state->startVblank )
+      {
+         until = m_state->startVblank-1;
+      }
+      else if ( m_state->m_cycles < m_state->startVblank+PPU_CYCLES_PER_SCANLINE )
+      {
+         return 0;
+      }
+   }
+
+   // The CPU has already been handed its cycles for the dots up to
+   // m_cycles+m_cpuDots.
+   if ( m_state->m_cycles+m_state->m_cpuDots >= until )
+   {
+      return 0;
+   }
+
+   return (((until-m_state->m_cycles-m_state->m_cpuDots)*CPU_CYCLE_ADJUST)+(m_state->m_curCycles%m_state->cycleRatio))/m_state->cycleRatio;
 }
 
+template<bool Debuggable>
 uint32_t CPPU::RENDER ( uint32_t addr, int8_t target )
 {
    uint32_t data;
 
    data = LOAD ( addr, eNESSource_PPU, target );
 
-   if ( nesIsDebuggable() )
+   if ( Debuggable )
    {
-      m_logger->LogAccess ( C6502::_CYCLES()/*m_cycles*/, addr, data, eLogger_DataRead, eNESSource_PPU );
+      m_state->m_logger->LogAccess ( C6502::_CYCLES()/*m_cycles*/, addr, data, eLogger_DataRead, eNESSource_PPU );
    }
 
    // Provide PPU cycle and address to mappers that watch such things!
-   MAPPERFUNC->sync_ppu(m_cycles,addr);
+   SYNCMAPPER ( addr );
 
    // Address/Data bus multiplexed thus 2 cycles required per access...
-   EMULATE(1);
+   EMULATE<Debuggable>(1);
 
-   if ( nesIsDebuggable() )
+   if ( Debuggable )
    {
       // Check for PPU address breakpoint...
       CNES::CHECKBREAKPOINT ( eBreakInPPU, eBreakOnPPUEvent, rPPUADDR(), PPU_EVENT_ADDRESS_EQUALS );
@@ -1048,20 +1351,21 @@ uint32_t CPPU::RENDER ( uint32_t addr, int8_t target )
    return data;
 }
 
+template<bool Debuggable>
 void CPPU::GARBAGE ( uint32_t addr, int8_t target )
 {
-   if ( nesIsDebuggable() )
+   if ( Debuggable )
    {
-      CNES::TRACER()->AddGarbageFetch ( m_cycles, target, addr );
+      CNES::TRACER()->AddGarbageFetch ( m_state->m_cycles, target, addr );
    }
 
    // Provide PPU cycle and address to mappers that watch such things!
-   MAPPERFUNC->sync_ppu(m_cycles,addr);
+   SYNCMAPPER ( addr );
 
    // Address/Data bus multiplexed thus 2 cycles required per access...
-   EMULATE(1);
+   EMULATE<Debuggable>(1);
 
-   if ( nesIsDebuggable() )
+   if ( Debuggable )
    {
       // Check for PPU address breakpoint...
       CNES::CHECKBREAKPOINT ( eBreakInPPU, eBreakOnPPUEvent, rPPUADDR(), PPU_EVENT_ADDRESS_EQUALS );
@@ -1071,17 +1375,18 @@ void CPPU::GARBAGE ( uint32_t addr, int8_t target )
    }
 }
 
+template<bool Debuggable>
 void CPPU::EXTRA ()
 {
-   if ( nesIsDebuggable() )
+   if ( Debuggable )
    {
-      CNES::TRACER()->AddGarbageFetch ( m_cycles, eTarget_ExtraCycle, 0 );
+      CNES::TRACER()->AddGarbageFetch ( m_state->m_cycles, eTarget_ExtraCycle, 0 );
    }
 
    // Idle cycle...
-   EMULATE(1);
+   EMULATE<Debuggable>(1);
 
-   if ( nesIsDebuggable() )
+   if ( Debuggable )
    {
       // Check for PPU address breakpoint...
       CNES::CHECKBREAKPOINT ( eBreakInPPU, eBreakOnPPUEvent, rPPUADDR(), PPU_EVENT_ADDRESS_EQUALS );
@@ -1091,56 +1396,82 @@ void CPPU::EXTRA ()
    }
 }
 
+void CPPU::MAPPERWATCH ( void )
+{
+   MapperFuncs* mapper = CNES::MAPPERFUNC();
+
+   m_state->m_mapperResync = true;
+   m_state->m_mapperEdgeMask = mapper->ppuEdgeMask;
+   m_state->m_mapperMatchMask = mapper->ppuMatchMask;
+   m_state->m_mapperMatchValue = mapper->ppuMatchMask;
+
+   if ( mapper->sync_ppu == CROM::SYNCPPU )
+   {
+      // Nothing to see.
+      m_state->m_mapperEdgeMask = 0;
+      m_state->m_mapperMatchMask = 0;
+      m_state->m_mapperMatchValue = 1;
+   }
+   else if ( mapper->ppuEdgeMask && !mapper->ppuMatchMask )
+   {
+      // Edges only.
+      m_state->m_mapperMatchValue = 1;
+   }
+}
+
 void CPPU::RESET ( bool soft )
 {
    int idx;
 
-   startVblank = (CNES::VIDEOMODE()==MODE_NTSC)?PPU_CYCLE_START_VBLANK_NTSC:(CNES::VIDEOMODE()==MODE_PAL)?PPU_CYCLE_START_VBLANK_PAL:PPU_CYCLE_START_VBLANK_DENDY;
-   quietScanlines = (CNES::VIDEOMODE()==MODE_NTSC)?SCANLINES_QUIET_NTSC:(CNES::VIDEOMODE()==MODE_PAL)?SCANLINES_QUIET_PAL:SCANLINES_QUIET_DENDY;
-   vblankScanlines = (CNES::VIDEOMODE()==MODE_NTSC)?SCANLINES_VBLANK_NTSC:(CNES::VIDEOMODE()==MODE_PAL)?SCANLINES_VBLANK_PAL:SCANLINES_VBLANK_DENDY;
-   vblankEndCycle = (CNES::VIDEOMODE()==MODE_NTSC)?PPU_CYCLE_END_VBLANK_NTSC:(CNES::VIDEOMODE()==MODE_PAL)?PPU_CYCLE_END_VBLANK_PAL:PPU_CYCLE_END_VBLANK_DENDY;
-   prerenderScanline = (CNES::VIDEOMODE()==MODE_NTSC)?SCANLINE_PRERENDER_NTSC:(CNES::VIDEOMODE()==MODE_PAL)?SCANLINE_PRERENDER_PAL:SCANLINE_PRERENDER_DENDY;
-   cycleRatio = (CNES::VIDEOMODE()==MODE_NTSC)?PPU_CPU_RATIO_NTSC:(CNES::VIDEOMODE()==MODE_PAL)?PPU_CPU_RATIO_PAL:PPU_CPU_RATIO_DENDY;
-   memoryDecayFrames = (CNES::VIDEOMODE()==MODE_NTSC)?PPU_DECAY_FRAME_COUNT_NTSC:(CNES::VIDEOMODE()==MODE_PAL)?PPU_DECAY_FRAME_COUNT_PAL:PPU_DECAY_FRAME_COUNT_DENDY;
-
-   m_PPUreg [ 0 ] = 0x00;
-   m_PPUreg [ 1 ] = 0x00;
-   m_PPUreg [ 2 ] = 0x00;
-
-   m_frame = 0;
-   m_cycles = 0;
-   m_curCycles = 0;
-
-   m_vblankChoked = false;
-   m_nmiChoked = false;
-   m_nmiReenabled = false;
-
-   m_ppuAddr = 0x0000;
-   m_ppuAddrLatch = 0x0000;
-   m_ppuAddrIncrement = 1;
-   m_ppuReadLatch = 0x00;
-   m_ppuRegByte = 0;
-   m_ppuIOLatch = 0x00;
-   m_ppuIOLatchDecayFrames [ 0 ] = 0;
-   m_ppuIOLatchDecayFrames [ 1 ] = 0;
-   m_ppuIOLatchDecayFrames [ 2 ] = 0;
-   m_ppuIOLatchDecayFrames [ 3 ] = 0;
-   m_ppuIOLatchDecayFrames [ 4 ] = 0;
-   m_ppuIOLatchDecayFrames [ 5 ] = 0;
-   m_ppuIOLatchDecayFrames [ 6 ] = 0;
-   m_ppuIOLatchDecayFrames [ 7 ] = 0;
-
-   m_spriteTemporaryMemory.count = 0;
-   m_spriteTemporaryMemory.yByte = SPRITEY;
-   m_spriteTemporaryMemory.rolling = 0;
-
-   m_lastSprite0HitX = 0;
-   m_lastSprite0HitY = 0;
+   m_state->startVblank = (CNES::VIDEOMODE()==MODE_NTSC)?PPU_CYCLE_START_VBLANK_NTSC:(CNES::VIDEOMODE()==MODE_PAL)?PPU_CYCLE_START_VBLANK_PAL:PPU_CYCLE_START_VBLANK_DENDY;
+   m_state->quietScanlines = (CNES::VIDEOMODE()==MODE_NTSC)?SCANLINES_QUIET_NTSC:(CNES::VIDEOMODE()==MODE_PAL)?SCANLINES_QUIET_PAL:SCANLINES_QUIET_DENDY;
+   m_state->vblankScanlines = (CNES::VIDEOMODE()==MODE_NTSC)?SCANLINES_VBLANK_NTSC:(CNES::VIDEOMODE()==MODE_PAL)?SCANLINES_VBLANK_PAL:SCANLINES_VBLANK_DENDY;
+   m_state->vblankEndCycle = (CNES::VIDEOMODE()==MODE_NTSC)?PPU_CYCLE_END_VBLANK_NTSC:(CNES::VIDEOMODE()==MODE_PAL)?PPU_CYCLE_END_VBLANK_PAL:PPU_CYCLE_END_VBLANK_DENDY;
+   m_state->prerenderScanline = (CNES::VIDEOMODE()==MODE_NTSC)?SCANLINE_PRERENDER_NTSC:(CNES::VIDEOMODE()==MODE_PAL)?SCANLINE_PRERENDER_PAL:SCANLINE_PRERENDER_DENDY;
+   m_state->cycleRatio = (CNES::VIDEOMODE()==MODE_NTSC)?PPU_CPU_RATIO_NTSC:(CNES::VIDEOMODE()==MODE_PAL)?PPU_CPU_RATIO_PAL:PPU_CPU_RATIO_DENDY;
+   m_state->memoryDecayFrames = (CNES::VIDEOMODE()==MODE_NTSC)?PPU_DECAY_FRAME_COUNT_NTSC:(CNES::VIDEOMODE()==MODE_PAL)?PPU_DECAY_FRAME_COUNT_PAL:PPU_DECAY_FRAME_COUNT_DENDY;
+   m_state->m_pLineKinds = (CNES::VIDEOMODE()==MODE_NTSC)?m_lineKinds[MODE_NTSC]:(CNES::VIDEOMODE()==MODE_PAL)?m_lineKinds[MODE_PAL]:m_lineKinds[MODE_DENDY];
+
+   m_state->m_PPUreg [ 0 ] = 0x00;
+   m_state->m_PPUreg [ 1 ] = 0x00;
+   m_state->m_PPUreg [ 2 ] = 0x00;
+
+   m_state->m_frame = 0;
+   m_state->m_cycles = 0;
+   m_state->m_curCycles = 0;
+   SYNCDOT ();
+
+   m_state->m_vblankChoked = false;
+   m_state->m_nmiChoked = false;
+   m_state->m_nmiReenabled = false;
+
+   m_state->m_ppuAddr = 0x0000;
+   m_state->m_ppuAddrLatch = 0x0000;
+   MAPPERWATCH ();
+   m_state->m_ppuAddrIncrement = 1;
+   m_state->m_ppuReadLatch = 0x00;
+   m_state->m_ppuRegByte = 0;
+   m_state->m_ppuIOLatch = 0x00;
+   m_state->m_ppuIOLatchDecayFrames [ 0 ] = 0;
+   m_state->m_ppuIOLatchDecayFrames [ 1 ] = 0;
+   m_state->m_ppuIOLatchDecayFrames [ 2 ] = 0;
+   m_state->m_ppuIOLatchDecayFrames [ 3 ] = 0;
+   m_state->m_ppuIOLatchDecayFrames [ 4 ] = 0;
+   m_state->m_ppuIOLatchDecayFrames [ 5 ] = 0;
+   m_state->m_ppuIOLatchDecayFrames [ 6 ] = 0;
+   m_state->m_ppuIOLatchDecayFrames [ 7 ] = 0;
+
+   m_state->m_spriteTemporaryMemory.count = 0;
+   m_state->m_spriteTemporaryMemory.yByte = SPRITEY;
+   m_state->m_spriteTemporaryMemory.rolling = 0;
+
+   m_state->m_lastSprite0HitX = 0;
+   m_state->m_lastSprite0HitY = 0;
 
    // Set up default mapping.
    for ( idx = 0; idx < 8; idx++ )
    {
-      m_pPPUmemory[idx] = m_PPUmemory+((idx&1)<<UPSHIFT_1KB);
+      m_state->m_pPPUmemory[idx] = m_state->m_PPUmemory+((idx&1)<<UPSHIFT_1KB);
    }
 
    // Set up default palette in a way that passes the default palette test.
@@ -1164,24 +1495,24 @@ uint32_t CPPU::PPU ( uint32_t addr )
 
    if ( fixAddr == PPUSTATUS_REG )
    {
-      data = *(m_PPUreg+fixAddr);
-      *(m_PPUreg+fixAddr) &= (~PPUSTATUS_VBLANK); // VBLANK clear-on-read
-      m_ppuRegByte = 0; // Clear PPUADDR address latch
-      data = (data&0xE0)|(m_ppuIOLatch&0x1F);
+      data = *(m_state->m_PPUreg+fixAddr);
+      *(m_state->m_PPUreg+fixAddr) &= (~PPUSTATUS_VBLANK); // VBLANK clear-on-read
+      m_state->m_ppuRegByte = 0; // Clear PPUADDR address latch
+      data = (data&0xE0)|(m_state->m_ppuIOLatch&0x1F);
 
       // Refresh I/O latch...
-      m_ppuIOLatch &= (0x1F);
-      m_ppuIOLatch |= (data&0xE0);
+      m_state->m_ppuIOLatch &= (0x1F);
+      m_state->m_ppuIOLatch |= (data&0xE0);
 
       // Kill VBLANK flag if register is read at 'wrong' time...
-      if ( m_cycles == startVblank-1 )
+      if ( m_state->m_cycles == m_state->startVblank-1 )
       {
          VBLANKCHOKED ( true );
       }
 
       // Kill NMI assertion if register is read at 'wrong' time...
-      if ( (m_cycles >= startVblank-1) &&
-            (m_cycles <= startVblank+1) )
+      if ( (m_state->m_cycles >= m_state->startVblank-1) &&
+            (m_state->m_cycles <= m_state->startVblank+1) )
       {
          NMICHOKED ( true );
       }
@@ -1191,10 +1522,10 @@ uint32_t CPPU::PPU ( uint32_t addr )
       uint8_t mask[4] = { 0xFF, 0xFF, 0xE3, 0xFF };
 
       // Third sprite byte should be masked with E3 on read.
-      data = (*(m_PPUoam+m_oamAddr))&mask[m_oamAddr&0x3];
+      data = (*(m_state->m_PPUoam+m_state->m_oamAddr))&mask[m_state->m_oamAddr&0x3];
 
       // Refresh I/O latch...
-      m_ppuIOLatch = data;
+      m_state->m_ppuIOLatch = data;
 
       if ( nesIsDebuggable() )
       {
@@ -1204,18 +1535,18 @@ uint32_t CPPU::PPU ( uint32_t addr )
    }
    else if ( fixAddr == PPUDATA_REG )
    {
-      oldPpuAddr = m_ppuAddr;
+      oldPpuAddr = m_state->m_ppuAddr;
 
-      m_ppuAddr += m_ppuAddrIncrement;
+      m_state->m_ppuAddr += m_state->m_ppuAddrIncrement;
 
       if ( oldPpuAddr < 0x3F00 )
       {
-         data = m_ppuReadLatch;
+         data = m_state->m_ppuReadLatch;
 
          // Refresh I/O latch...
-         m_ppuIOLatch = data;
+         m_state->m_ppuIOLatch = data;
 
-         m_ppuReadLatch = LOAD ( oldPpuAddr, eNESSource_CPU, eTracer_DataRead );
+         m_state->m_ppuReadLatch = LOAD ( oldPpuAddr, eNESSource_CPU, eTracer_DataRead );
       }
       else
       {
@@ -1225,14 +1556,14 @@ uint32_t CPPU::PPU ( uint32_t addr )
          data &= 0x3F;
 
          // Fill in read-latch bits...
-         data |= (m_ppuIOLatch&0xC0);
+         data |= (m_state->m_ppuIOLatch&0xC0);
 
          // Refresh I/O latch...
-         m_ppuIOLatch &= (0xC0);
-         m_ppuIOLatch |= (data&0x3F);
+         m_state->m_ppuIOLatch &= (0xC0);
+         m_state->m_ppuIOLatch |= (data&0x3F);
 
          // Shadow palette/VRAM read, don't use regular LOAD or it will be logged in Tracer...
-         m_ppuReadLatch = *((*(m_pPPUmemory+(((oldPpuAddr&(~0x1000))&0x1FFF)>>10)))+((oldPpuAddr&(~0x1000))&0x3FF));
+         m_state->m_ppuReadLatch = *((*(m_state->m_pPPUmemory+(((oldPpuAddr&(~0x1000))&0x1FFF)>>10)))+((oldPpuAddr&(~0x1000))&0x3FF));
       }
 
       if ( nesIsDebuggable() )
@@ -1241,15 +1572,15 @@ uint32_t CPPU::PPU ( uint32_t addr )
          CNES::CHECKBREAKPOINT ( eBreakInPPU, eBreakOnPPUPortalRead, data );
 
          // Log Code/Data logger...
-         m_logger->LogAccess ( C6502::_CYCLES()/*m_cycles*/, oldPpuAddr, data, eLogger_DataRead, eNESSource_CPU );
+         m_state->m_logger->LogAccess ( C6502::_CYCLES()/*m_cycles*/, oldPpuAddr, data, eLogger_DataRead, eNESSource_CPU );
       }
 
       // Toggling A12 causes IRQ count in some mappers...
-      MAPPERFUNC->sync_ppu(m_cycles,m_ppuAddr);
+      SYNCMAPPER ( m_state->m_ppuAddr );
    }
    else
    {
-      data = m_ppuIOLatch;
+      data = m_state->m_ppuIOLatch;
    }
 
    if ( nesIsDebuggable() )
@@ -1269,20 +1600,20 @@ void CPPU::PPU ( uint32_t addr, uint8_t data )
    int32_t  bit;
 
    // Set I/O latch for bus hold-up emulation...
-   m_ppuIOLatch = data;
+   m_state->m_ppuIOLatch = data;
 
    // Set crude 'frame counters' for each 1 bit to decay...
    for ( bit = 0; bit < 8; bit++ )
    {
-      if ( m_ppuIOLatch&(1<<bit) )
+      if ( m_state->m_ppuIOLatch&(1<<bit) )
       {
          // ~600msec
-         m_ppuIOLatchDecayFrames [ bit ] = memoryDecayFrames;
+         m_state->m_ppuIOLatchDecayFrames [ bit ] = m_state->memoryDecayFrames;
       }
       else
       {
          // No decay necessary.
-         m_ppuIOLatchDecayFrames [ bit ] = 0;
+         m_state->m_ppuIOLatchDecayFrames [ bit ] = 0;
       }
    }
 
@@ -1290,8 +1621,8 @@ void CPPU::PPU ( uint32_t addr, uint8_t data )
 
    if ( fixAddr != PPUSTATUS_REG )
    {
-      old2000 = *(m_PPUreg+PPUCTRL_REG);
-      *(m_PPUreg+fixAddr) = data;
+      old2000 = *(m_state->m_PPUreg+PPUCTRL_REG);
+      *(m_state->m_PPUreg+fixAddr) = data;
 
       // Check for need to re-assert NMI if NMI is enabled and we're in VBLANK...
       if ( (fixAddr == PPUCTRL_REG) &&
@@ -1305,17 +1636,17 @@ void CPPU::PPU ( uint32_t addr, uint8_t data )
 
    if ( fixAddr == PPUCTRL_REG )
    {
-      m_ppuAddrLatch &= 0x73FF;
-      m_ppuAddrLatch |= ((((uint16_t)data&PPUCTRL_BASE_NAM_TBL_ADDR_MSK))<<10);
-      m_ppuAddrIncrement = (((!!(data&PPUCTRL_VRAM_ADDR_INC))*31)+1);
+      m_state->m_ppuAddrLatch &= 0x73FF;
+      m_state->m_ppuAddrLatch |= ((((uint16_t)data&PPUCTRL_BASE_NAM_TBL_ADDR_MSK))<<10);
+      m_state->m_ppuAddrIncrement = (((!!(data&PPUCTRL_VRAM_ADDR_INC))*31)+1);
    }
    else if ( fixAddr == OAMADDR_REG )
    {
-      m_oamAddr = data;
+      m_state->m_oamAddr = data;
    }
    else if ( fixAddr == OAMDATA_REG )
    {
-      *(m_PPUoam+m_oamAddr) = data;
+      *(m_state->m_PPUoam+m_state->m_oamAddr) = data;
 
       if ( nesIsDebuggable() )
       {
@@ -1323,16 +1654,16 @@ void CPPU::PPU ( uint32_t addr, uint8_t data )
          CNES::CHECKBREAKPOINT ( eBreakInPPU, eBreakOnOAMPortalWrite, data );
       }
 
-      m_oamAddr++;
+      m_state->m_oamAddr++;
    }
    else if ( fixAddr == PPUSCROLL_REG )
    {
-      if ( m_ppuRegByte )
+      if ( m_state->m_ppuRegByte )
       {
-         m_last2005y = data;
-         m_ppuAddrLatch &= 0x8C1F;
-         m_ppuAddrLatch |= ((((uint16_t)data&0xF8))<<2);
-         m_ppuAddrLatch |= ((((uint16_t)data&0x07))<<12);
+         m_state->m_last2005y = data;
+         m_state->m_ppuAddrLatch &= 0x8C1F;
+         m_state->m_ppuAddrLatch |= ((((uint16_t)data&0xF8))<<2);
+         m_state->m_ppuAddrLatch |= ((((uint16_t)data&0x07))<<12);
 
          if ( nesIsDebuggable() )
          {
@@ -1342,10 +1673,10 @@ void CPPU::PPU ( uint32_t addr, uint8_t data )
       }
       else
       {
-         m_last2005x = data;
-         m_ppuScrollX = data&0x07;
-         m_ppuAddrLatch &= 0xFFE0;
-         m_ppuAddrLatch |= ((((uint16_t)data&0xF8))>>3);
+         m_state->m_last2005x = data;
+         m_state->m_ppuScrollX = data&0x07;
+         m_state->m_ppuAddrLatch &= 0xFFE0;
+         m_state->m_ppuAddrLatch |= ((((uint16_t)data&0xF8))>>3);
 
          if ( nesIsDebuggable() )
          {
@@ -1354,47 +1685,47 @@ void CPPU::PPU ( uint32_t addr, uint8_t data )
          }
       }
 
-      m_ppuRegByte = !m_ppuRegByte;
+      m_state->m_ppuRegByte = !m_state->m_ppuRegByte;
    }
    else if ( fixAddr == PPUADDR_REG )
    {
-      if ( m_ppuRegByte )
+      if ( m_state->m_ppuRegByte )
       {
-         m_ppuAddrLatch &= 0x7F00;
-         m_ppuAddrLatch |= data;
+         m_state->m_ppuAddrLatch &= 0x7F00;
+         m_state->m_ppuAddrLatch |= data;
 
-         m_ppuAddr = m_ppuAddrLatch;
+         m_state->m_ppuAddr = m_state->m_ppuAddrLatch;
 
          // Toggling A12 causes IRQ count in some mappers...
-         MAPPERFUNC->sync_ppu(m_cycles,m_ppuAddr);
+         SYNCMAPPER ( m_state->m_ppuAddr );
       }
       else
       {
-         m_ppuAddrLatch &= 0x00FF;
-         m_ppuAddrLatch |= ((((uint16_t)data&0x3F))<<8);
+         m_state->m_ppuAddrLatch &= 0x00FF;
+         m_state->m_ppuAddrLatch |= ((((uint16_t)data&0x3F))<<8);
       }
 
-      m_ppuRegByte = !m_ppuRegByte;
+      m_state->m_ppuRegByte = !m_state->m_ppuRegByte;
    }
    else if ( fixAddr == PPUDATA_REG )
    {
-      STORE ( m_ppuAddr, data, eNESSource_CPU, eTracer_DataWrite );
+      STORE ( m_state->m_ppuAddr, data, eNESSource_CPU, eTracer_DataWrite );
 
-      oldPpuAddr = m_ppuAddr;
+      oldPpuAddr = m_state->m_ppuAddr;
 
       if ( nesIsDebuggable() )
       {
-         m_logger->LogAccess ( C6502::_CYCLES()/*m_cycles*/, oldPpuAddr, data, eLogger_DataWrite, eNESSource_CPU );
+         m_state->m_logger->LogAccess ( C6502::_CYCLES()/*m_cycles*/, oldPpuAddr, data, eLogger_DataWrite, eNESSource_CPU );
 
          // Check for breakpoint...
          CNES::CHECKBREAKPOINT ( eBreakInPPU, eBreakOnPPUPortalWrite, data );
       }
 
       // Increment PPUADDR
-      m_ppuAddr += m_ppuAddrIncrement;
+      m_state->m_ppuAddr += m_state->m_ppuAddrIncrement;
 
       // Toggling A12 causes IRQ count in some mappers...
-      MAPPERFUNC->sync_ppu(m_cycles,m_ppuAddr);
+      SYNCMAPPER ( m_state->m_ppuAddr );
    }
 
    if ( nesIsDebuggable() )
@@ -1406,12 +1737,12 @@ void CPPU::PPU ( uint32_t addr, uint8_t data )
 
 void CPPU::MIRROR ( int32_t oneScreen, bool vert, bool extraVRAM )
 {
-   m_oneScreen = oneScreen;
-   m_extraVRAM = extraVRAM;
+   m_state->m_oneScreen = oneScreen;
+   m_state->m_extraVRAM = extraVRAM;
 
-   if ( m_oneScreen >= 0 )
+   if ( m_state->m_oneScreen >= 0 )
    {
-      MIRROR ( m_oneScreen, m_oneScreen, m_oneScreen, m_oneScreen );
+      MIRROR ( m_state->m_oneScreen, m_state->m_oneScreen, m_state->m_oneScreen, m_state->m_oneScreen );
    }
    else if ( vert )
    {
@@ -1421,7 +1752,7 @@ void CPPU::MIRROR ( int32_t oneScreen, bool vert, bool extraVRAM )
    {
       MIRRORHORIZ ();
    }
-   if ( m_extraVRAM )
+   if ( m_state->m_extraVRAM )
    {
       CROM::REMAPVRAM ( 0x0, 0x0 );
       CROM::REMAPVRAM ( 0x1, 0x1 );
@@ -1449,55 +1780,57 @@ void CPPU::MIRROR ( int32_t b0, int32_t b1, int32_t b2, int32_t b3 )
    if ( b0 >= 0 )
    {
       b0 &= 0x3;
-      REMAPVRAM ( 0x0, &(m_PPUmemory[(b0<<UPSHIFT_1KB)]) );
-      REMAPVRAM ( 0x4, &(m_PPUmemory[(b0<<UPSHIFT_1KB)]) );
+      REMAPVRAM ( 0x0, &(m_state->m_PPUmemory[(b0<<UPSHIFT_1KB)]) );
+      REMAPVRAM ( 0x4, &(m_state->m_PPUmemory[(b0<<UPSHIFT_1KB)]) );
    }
    if ( b1 >= 0 )
    {
       b1 &= 0x3;
-      REMAPVRAM ( 0x1, &(m_PPUmemory[(b1<<UPSHIFT_1KB)]) );
-      REMAPVRAM ( 0x5, &(m_PPUmemory[(b1<<UPSHIFT_1KB)]) );
+      REMAPVRAM ( 0x1, &(m_state->m_PPUmemory[(b1<<UPSHIFT_1KB)]) );
+      REMAPVRAM ( 0x5, &(m_state->m_PPUmemory[(b1<<UPSHIFT_1KB)]) );
    }
    if ( b2 >= 0 )
    {
       b2 &= 0x3;
-      REMAPVRAM ( 0x2, &(m_PPUmemory[(b2<<UPSHIFT_1KB)]) );
-      REMAPVRAM ( 0x6, &(m_PPUmemory[(b2<<UPSHIFT_1KB)]) );
+      REMAPVRAM ( 0x2, &(m_state->m_PPUmemory[(b2<<UPSHIFT_1KB)]) );
+      REMAPVRAM ( 0x6, &(m_state->m_PPUmemory[(b2<<UPSHIFT_1KB)]) );
    }
    if ( b3 >= 0 )
    {
       b3 &= 0x3;
-      REMAPVRAM ( 0x3, &(m_PPUmemory[(b3<<UPSHIFT_1KB)]) );
-      REMAPVRAM ( 0x7, &(m_PPUmemory[(b3<<UPSHIFT_1KB)]) );
+      REMAPVRAM ( 0x3, &(m_state->m_PPUmemory[(b3<<UPSHIFT_1KB)]) );
+      REMAPVRAM ( 0x7, &(m_state->m_PPUmemory[(b3<<UPSHIFT_1KB)]) );
    }
 }
 
+template<bool Debuggable>
 void CPPU::QUIETSCANLINES ( void )
 {
    int32_t bit;
 
-   EMULATE(PPU_CYCLES_PER_SCANLINE*quietScanlines);
+   EMULATEIDLE<Debuggable>(PPU_CYCLES_PER_SCANLINE*m_state->quietScanlines);
 
    // Do I/O latch decay...this is just a convenient place to put
    // this decay because this function is called once per frame and
    // the current emulation of PPU register decay is a frame-count.
    for ( bit = 0; bit < 8; bit++ )
    {
-      if ( m_ppuIOLatch&(1<<bit) )
+      if ( m_state->m_ppuIOLatch&(1<<bit) )
       {
-         if ( m_ppuIOLatchDecayFrames[bit] )
+         if ( m_state->m_ppuIOLatchDecayFrames[bit] )
          {
-            m_ppuIOLatchDecayFrames[bit]--;
+            m_state->m_ppuIOLatchDecayFrames[bit]--;
          }
 
-         if ( !(m_ppuIOLatchDecayFrames[bit]) )
+         if ( !(m_state->m_ppuIOLatchDecayFrames[bit]) )
          {
-            m_ppuIOLatch &= (~(1<<bit));
+            m_state->m_ppuIOLatch &= (~(1<<bit));
          }
       }
    }
 }
 
+template<bool Debuggable>
 void CPPU::VBLANKSCANLINES ( void )
 {
    // Set VBLANK flag...
@@ -1506,7 +1839,7 @@ void CPPU::VBLANKSCANLINES ( void )
       wPPU ( PPUSTATUS, rPPU(PPUSTATUS)|PPUSTATUS_VBLANK );
    }
 
-   EMULATE(vblankScanlines*PPU_CYCLES_PER_SCANLINE);
+   EMULATEIDLE<Debuggable>(m_state->vblankScanlines*PPU_CYCLES_PER_SCANLINE);
 
    // Clear VBLANK, Sprite 0 Hit flag and sprite overflow...
    wPPU ( PPUSTATUS, rPPU(PPUSTATUS)&(~(PPUSTATUS_VBLANK|PPUSTATUS_SPRITE_0_HIT|PPUSTATUS_SPRITE_OVFLO)) );
@@ -1514,8 +1847,8 @@ void CPPU::VBLANKSCANLINES ( void )
 
 void CPPU::PIXELPIPELINES ( int32_t pickoff, uint8_t* a, uint8_t* b1, uint8_t* b2 )
 {
-   BackgroundBufferData* pBkgnd1 = m_bkgndBuffer.data;
-   BackgroundBufferData* pBkgnd2 = m_bkgndBuffer.data+1;
+   BackgroundBufferData* pBkgnd1 = m_state->m_bkgndBuffer.data;
+   BackgroundBufferData* pBkgnd2 = m_state->m_bkgndBuffer.data+1;
 
    // Adjust pickoff point to place within stored data...
    pickoff = 7-pickoff;
@@ -1542,15 +1875,187 @@ void CPPU::PIXELPIPELINES ( int32_t pickoff, uint8_t* a, uint8_t* b1, uint8_t* b
    pBkgnd2->attribData2 <<= 1;
 }
 
-void CPPU::RENDERSCANLINE ( int32_t scanlines )
+void CPPU::BUILDBKGNDSPANTABLE ( void )
+{
+   uint8_t  pixels [ 8 ];
+   uint32_t data;
+   int32_t  pixel;
+
+   for ( data = 0; data < 256; data++ )
+   {
+      for ( pixel = 0; pixel < 8; pixel++ )
+      {
+         pixels[pixel] = (data>>(7-pixel))&0x1;
+      }
+      memcpy(&m_bkgndSpread[data],pixels,sizeof(pixels));
+   }
+}
+
+void CPPU::BKGNDSPAN ( int32_t pickoff, uint8_t* span )
+{
+   BackgroundBufferData* pBkgnd1 = m_state->m_bkgndBuffer.data;
+   BackgroundBufferData* pBkgnd2 = m_state->m_bkgndBuffer.data+1;
+   int32_t  shift = 8-pickoff;
+   uint64_t pixels;
+
+   // The eight pixels PIXELPIPELINES would pick off next are the eight
+   // bits starting at the pickoff point of each pair of shifters...
+   pixels = m_bkgndSpread[(uint8_t)((((pBkgnd1->patternData1<<8)|pBkgnd2->patternData1)>>shift))];
+   pixels |= m_bkgndSpread[(uint8_t)((((pBkgnd1->patternData2<<8)|pBkgnd2->patternData2)>>shift))]<<1;
+   pixels |= m_bkgndSpread[(uint8_t)((((pBkgnd1->attribData1<<8)|pBkgnd2->attribData1)>>shift))]<<2;
+   pixels |= m_bkgndSpread[(uint8_t)((((pBkgnd1->attribData2<<8)|pBkgnd2->attribData2)>>shift))]<<3;
+
+   memcpy(span,&pixels,sizeof(pixels));
+}
+
+void CPPU::SHIFTPIPELINES ( int32_t pixels )
+{
+   BackgroundBufferData* pBkgnd1 = m_state->m_bkgndBuffer.data;
+   BackgroundBufferData* pBkgnd2 = m_state->m_bkgndBuffer.data+1;
+
+   pBkgnd1->patternData1 = (pBkgnd1->patternData1<<pixels)|(pBkgnd2->patternData1>>(8-pixels));
+   pBkgnd1->patternData2 = (pBkgnd1->patternData2<<pixels)|(pBkgnd2->patternData2>>(8-pixels));
+   pBkgnd1->attribData1 = (pBkgnd1->attribData1<<pixels)|(pBkgnd2->attribData1>>(8-pixels));
+   pBkgnd1->attribData2 = (pBkgnd1->attribData2<<pixels)|(pBkgnd2->attribData2>>(8-pixels));
+   pBkgnd2->patternData1 <<= pixels;
+   pBkgnd2->patternData2 <<= pixels;
+   pBkgnd2->attribData1 <<= pixels;
+   pBkgnd2->attribData2 <<= pixels;
+}
+
+bool CPPU::SPRITE0PENDING ( void )
 {
-   int32_t idxx;
    int32_t sprite;
+
+   // Once set the flag stays set until the pre-render scanline.
+   if ( rPPU(PPUSTATUS)&PPUSTATUS_SPRITE_0_HIT )
+   {
+      return false;
+   }
+
+   for ( sprite = 0; sprite < m_state->m_spriteBuffer.count; sprite++ )
+   {
+      if ( m_state->m_spriteBuffer.data[sprite].temp.spriteIdx == 0 )
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+template<bool Debuggable>
+void CPPU::BUILDSPRITELINE ( SpriteLineData* line )
+{
    SpriteBufferData* pSprite;
    SpriteTemporaryMemoryData* pSpriteTemp;
-   SpriteBufferData* pSelectedSprite;
-   SpriteTemporaryMemoryData* pSelectedSpriteTemp;
+   int32_t sprite;
    int32_t idx2;
+   int32_t p;
+   int32_t colorIdx;
+   int32_t startClip = 0;
+   bool    renderSprites = false;
+
+   memset(line,0,sizeof(SpriteLineData)*256);
+
+   if ( Debuggable )
+   {
+      // Multiplexer events are only reported for pixels the
+      // clipping lets through...
+      startClip = ((!(rPPU(PPUMASK)&PPUMASK_SPRITE_CLIPPING)) || (!(rPPU(PPUMASK)&PPUMASK_BKGND_CLIPPING)))<<3;
+      renderSprites = !!(rPPU(PPUMASK)&PPUMASK_RENDER_SPRITES);
+   }
+
+   // Sprites earlier in the secondary OAM are in front of later ones,
+   // so a pixel belongs to the first sprite with an opaque pixel there...
+   for ( sprite = 0; sprite < m_state->m_spriteBuffer.count; sprite++ )
+   {
+      pSprite = m_state->m_spriteBuffer.data + sprite;
+      pSpriteTemp = &(pSprite->temp);
+
+      for ( idx2 = 0; idx2 < PATTERN_SIZE; idx2++ )
+      {
+         p = pSpriteTemp->spriteX + idx2;
+         if ( p > 255 )
+         {
+            break;
+         }
+
+         if ( Debuggable &&
+              (p >= startClip) &&
+              ((!line[p].colorIdx) || (!renderSprites)) )
+         {
+            // Check for sprite-in-multiplexer event breakpoint...
+            CNES::CHECKBREAKPOINT(eBreakInPPU,eBreakOnPPUEvent,pSpriteTemp->spriteIdx,PPU_EVENT_SPRITE_IN_MULTIPLEXER);
+         }
+
+         if ( line[p].colorIdx )
+         {
+            continue;
+         }
+
+         if ( pSprite->spriteFlipHoriz )
+         {
+            colorIdx = ((pSprite->patternData1>>idx2)&0x01)|((((pSprite->patternData2>>idx2)&0x01)<<1) );
+         }
+         else
+         {
+            colorIdx = ((pSprite->patternData1>>(7-idx2))&0x01)|((((pSprite->patternData2>>(7-idx2))&0x01)<<1) );
+         }
+
+         // Transparent pixels let sprites behind show through...
+         if ( !colorIdx )
+         {
+            continue;
+         }
+
+         if ( Debuggable && (p >= startClip) && renderSprites )
+         {
+            // Check for sprite selected event breakpoint...
+            CNES::CHECKBREAKPOINT(eBreakInPPU,eBreakOnPPUEvent,pSpriteTemp->spriteIdx,PPU_EVENT_SPRITE_SELECTED);
+         }
+
+         line[p].colorIdx = colorIdx|(pSpriteTemp->attribData<<2);
+         line[p].sprite = sprite;
+         line[p].spriteBehind = pSprite->spriteBehind;
+         line[p].sprite0 = (pSpriteTemp->spriteIdx == 0);
+      }
+   }
+}
+
+void CPPU::PIXEL ( int8_t* pTV, uint16_t* pTVIndexed, int32_t x, uint8_t color )
+{
+   uint16_t pixel = color;
+
+   if ( rPPU(PPUMASK)&PPUMASK_GREYSCALE )
+   {
+      pixel &= 0x30;
+   }
+   pixel |= (rPPU(PPUMASK)&(PPUMASK_INTENSIFY_REDS|PPUMASK_INTENSIFY_GREENS|PPUMASK_INTENSIFY_BLUES))<<(TV_INDEXED_EMPHASIS_SHIFT-5);
+
+   if ( pTVIndexed )
+   {
+      *(pTVIndexed+x) = pixel;
+   }
+   if ( pTV )
+   {
+      CONVERTPIXEL ( pixel, pTV+(x<<2) );
+   }
+}
+
+void CPPU::CONVERTPIXEL ( uint16_t pixel, int8_t* pTV )
+{
+   *pTV = CBasePalette::GetPaletteR(pixel&TV_INDEXED_COLOR_MASK, 0, !!(pixel&TV_INDEXED_EMPHASIS_RED), !!(pixel&TV_INDEXED_EMPHASIS_GREEN), !!(pixel&TV_INDEXED_EMPHASIS_BLUE));
+   *(pTV+1) = CBasePalette::GetPaletteG(pixel&TV_INDEXED_COLOR_MASK, 0, !!(pixel&TV_INDEXED_EMPHASIS_RED), !!(pixel&TV_INDEXED_EMPHASIS_GREEN), !!(pixel&TV_INDEXED_EMPHASIS_BLUE));
+   *(pTV+2) = CBasePalette::GetPaletteB(pixel&TV_INDEXED_COLOR_MASK, 0, !!(pixel&TV_INDEXED_EMPHASIS_RED), !!(pixel&TV_INDEXED_EMPHASIS_GREEN), !!(pixel&TV_INDEXED_EMPHASIS_BLUE));
+}
+
+template<bool Debuggable>
+void CPPU::RENDERSCANLINE ( int32_t scanlines )
+{
+   int32_t idxx;
+   SpriteLineData spriteLine [ 256 ];
+   SpriteLineData* pSelectedSprite;
    int32_t spriteColorIdx;
    int32_t bkgndColorIdx;
    int32_t startBkgnd;
@@ -1559,7 +2064,14 @@ void CPPU::RENDERSCANLINE ( int32_t scanlines )
    int scanline;
    int32_t rasttv;
    int8_t* pTV;
+   uint16_t* pTVIndexed;
    int32_t p;
+   uint8_t bkgndSpan [ 8 ];
+   int32_t spanPickoff;
+   bool pixels;
+   bool compose = !nesIsFrameSkipped();
+
+   NESPERFSCOPE ( eNESPerf_PPURender );
 
    if ( scanlines == SCANLINES_VISIBLE )
    {
@@ -1572,13 +2084,26 @@ void CPPU::RENDERSCANLINE ( int32_t scanlines )
    for ( scanline = start; scanline <= scanlines; scanline++ )
    {
       rasttv = ((scanline<<8)<<2);
-      pTV = (int8_t*)(m_pTV+rasttv);
+      pTV = NULL;
+      pTVIndexed = NULL;
+      if ( (scanline >= 0) && compose )
+      {
+         if ( m_state->m_pTV )
+         {
+            pTV = (int8_t*)(m_state->m_pTV+rasttv);
+         }
+         if ( m_state->m_pTVIndexed )
+         {
+            pTVIndexed = m_state->m_pTVIndexed+(scanline<<8);
+         }
+      }
       p = 0;
+      spanPickoff = -1;
 
-      m_x = 0;
-      m_y = scanline;
+      m_state->m_x = 0;
+      m_state->m_y = scanline;
 
-      if ( nesIsDebuggable() )
+      if ( Debuggable )
       {
          // Check for start-of-scanline breakpoints...
          if ( scanline == -1 )
@@ -1591,6 +2116,21 @@ void CPPU::RENDERSCANLINE ( int32_t scanlines )
          }
       }
 
+      // A frame that is not shown only needs its pixels worked out
+      // if sprite 0 could hit the background on this scanline...
+      pixels = (scanline >= 0);
+      if ( pixels && (!compose) && (!Debuggable) )
+      {
+         pixels = SPRITE0PENDING ();
+      }
+
+      // The sprites for this scanline were fetched at the end of
+      // the last one, so the multiplexer can be run for all of it now...
+      if ( pixels )
+      {
+         BUILDSPRITELINE<Debuggable> ( spriteLine );
+      }
+
       for ( idxx = 0; idxx < 256; idxx++ )
       {
          uint8_t a, b1, b2;
@@ -1601,82 +2141,62 @@ void CPPU::RENDERSCANLINE ( int32_t scanlines )
          startSprite = (!(rPPU(PPUMASK)&PPUMASK_SPRITE_CLIPPING))<<3;
 
          // Only render to the screen on the visible scanlines...
-         if ( scanline >= 0 )
+         if ( pixels )
          {
-            if ( nesIsDebuggable() )
+            if ( Debuggable )
             {
-               m_x = idxx;
+               m_state->m_x = idxx;
 
                // Update variables for PPU viewer
-               *(*(m_2005x+m_x)+m_y) = m_last2005x+((rPPU(PPUCTRL)&0x1)<<8);
-               *(*(m_2005y+m_x)+m_y) = m_last2005y+(((rPPU(PPUCTRL)&0x2)>>1)*240);
+               *(*(m_state->m_2005x+m_state->m_x)+m_state->m_y) = m_state->m_last2005x+((rPPU(PPUCTRL)&0x1)<<8);
+               *(*(m_state->m_2005y+m_state->m_x)+m_state->m_y) = m_state->m_last2005y+(((rPPU(PPUCTRL)&0x2)>>1)*240);
 
                // Check for PPU pixel-at breakpoint...
                CNES::CHECKBREAKPOINT(eBreakInPPU,eBreakOnPPUEvent,0,PPU_EVENT_PIXEL_XY);
             }
 
-            // Run sprite multiplexer to figure out what, if any,
-            // sprite pixel to draw here...
+            // Pick up whatever sprite pixel the multiplexer left
+            // for this pixel, if the clipping and mask let it show...
             pSelectedSprite = NULL;
-            pSelectedSpriteTemp = NULL;
 
-            for ( sprite = 0; sprite < m_spriteBuffer.count; sprite++ )
+            if ( (spriteLine[p].colorIdx) &&
+                 (p >= startSprite) &&
+                 (p >= startBkgnd) &&
+                 (rPPU(PPUMASK)&PPUMASK_RENDER_SPRITES) )
             {
-               pSprite = m_spriteBuffer.data + sprite;
-               pSpriteTemp = &(pSprite->temp);
-               idx2 = p - pSpriteTemp->spriteX;
+               pSelectedSprite = spriteLine+p;
+               spriteColorIdx = pSelectedSprite->colorIdx;
+            }
 
-               if ( (idx2 >= 0) && (idx2 < PATTERN_SIZE) &&
-                     (pSpriteTemp->spriteX+idx2 >= startSprite) &&
-                     (pSpriteTemp->spriteX+idx2 >= startBkgnd) )
+            // Background pixel determination.  The shifters are only
+            // reloaded at the end of each tile so, unless the X-scroll
+            // changes partway through it, the whole tile can be picked
+            // off in one go...
+            if ( !(idxx&7) )
+            {
+               spanPickoff = -1;
+               if ( !Debuggable )
                {
-                  if ( nesIsDebuggable() )
-                  {
-                     // Check for sprite-in-multiplexer event breakpoint...
-                     CNES::CHECKBREAKPOINT(eBreakInPPU,eBreakOnPPUEvent,pSpriteTemp->spriteIdx,PPU_EVENT_SPRITE_IN_MULTIPLEXER);
-                  }
-
-                  if ( pSprite->spriteFlipHoriz )
-                  {
-                     spriteColorIdx = ((pSprite->patternData1>>idx2)&0x01)|((((pSprite->patternData2>>idx2)&0x01)<<1) );
-                  }
-                  else
-                  {
-                     spriteColorIdx = ((pSprite->patternData1>>(7-idx2))&0x01)|((((pSprite->patternData2>>(7-idx2))&0x01)<<1) );
-                  }
-
-                  spriteColorIdx |= (pSpriteTemp->attribData<<2);
-
-                  // Render background color if necessary...
-                  if ( !(spriteColorIdx&0x3) )
-                  {
-                     spriteColorIdx = 0;
-                  }
-
-                  if ( !(rPPU(PPUMASK)&PPUMASK_RENDER_SPRITES) )
-                  {
-                     spriteColorIdx = 0;
-                  }
-
-                  if ( spriteColorIdx&0x3 )
-                  {
-                     if ( nesIsDebuggable() )
-                     {
-                        // Check for sprite selected event breakpoint...
-                        CNES::CHECKBREAKPOINT(eBreakInPPU,eBreakOnPPUEvent,pSpriteTemp->spriteIdx,PPU_EVENT_SPRITE_SELECTED);
-                     }
-
-                     // Save rendered sprite for multiplexing with background...
-                     pSelectedSprite = pSprite;
-                     pSelectedSpriteTemp = &(pSprite->temp);
-                     break;
-                  }
+                  spanPickoff = rSCROLLX();
+                  BKGNDSPAN ( spanPickoff, bkgndSpan );
                }
             }
-
-            // Background pixel determination...
-            PIXELPIPELINES ( rSCROLLX(), &a, &b1, &b2 );
-            bkgndColorIdx = ((a<<2)|b1|(b2<<1));
+            if ( spanPickoff == rSCROLLX() )
+            {
+               bkgndColorIdx = bkgndSpan[idxx&7];
+            }
+            else
+            {
+               if ( spanPickoff >= 0 )
+               {
+                  // ...otherwise catch the shifters up and carry on
+                  // pixel by pixel.
+                  SHIFTPIPELINES ( idxx&7 );
+                  spanPickoff = -1;
+               }
+               PIXELPIPELINES ( rSCROLLX(), &a, &b1, &b2 );
+               bkgndColorIdx = ((a<<2)|b1|(b2<<1));
+            }
 
             // Render background color if necessary...
             if ( !(bkgndColorIdx&0x3) )
@@ -1697,35 +2217,29 @@ void CPPU::RENDERSCANLINE ( int32_t scanlines )
                       ((bkgndColorIdx == 0) &&
                        (spriteColorIdx != 0))) )
                {
-                  if ( nesIsDebuggable() )
+                  if ( Debuggable )
                   {
                      // Check for sprite rendering event breakpoint...
-                     CNES::CHECKBREAKPOINT(eBreakInPPU,eBreakOnPPUEvent,pSelectedSpriteTemp->spriteIdx,PPU_EVENT_SPRITE_RENDERING);
+                     CNES::CHECKBREAKPOINT(eBreakInPPU,eBreakOnPPUEvent,m_state->m_spriteBuffer.data[pSelectedSprite->sprite].temp.spriteIdx,PPU_EVENT_SPRITE_RENDERING);
                   }
 
                   // Draw sprite...
-                  *pTV = CBasePalette::GetPaletteR(rPALETTE(0x10+spriteColorIdx), !!(rPPU(PPUMASK)&PPUMASK_GREYSCALE), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_REDS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_GREENS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_BLUES));
-                  *(pTV+1) = CBasePalette::GetPaletteG(rPALETTE(0x10+spriteColorIdx), !!(rPPU(PPUMASK)&PPUMASK_GREYSCALE), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_REDS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_GREENS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_BLUES));
-                  *(pTV+2) = CBasePalette::GetPaletteB(rPALETTE(0x10+spriteColorIdx), !!(rPPU(PPUMASK)&PPUMASK_GREYSCALE), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_REDS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_GREENS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_BLUES));
+                  PIXEL ( pTV, pTVIndexed, p, rPALETTE(0x10+spriteColorIdx) );
                }
                else if ( p>=startBkgnd )
                {
                   // Draw background...
-                  *pTV = CBasePalette::GetPaletteR(rPALETTE(bkgndColorIdx), !!(rPPU(PPUMASK)&PPUMASK_GREYSCALE), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_REDS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_GREENS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_BLUES));
-                  *(pTV+1) = CBasePalette::GetPaletteG(rPALETTE(bkgndColorIdx), !!(rPPU(PPUMASK)&PPUMASK_GREYSCALE), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_REDS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_GREENS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_BLUES));
-                  *(pTV+2) = CBasePalette::GetPaletteB(rPALETTE(bkgndColorIdx), !!(rPPU(PPUMASK)&PPUMASK_GREYSCALE), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_REDS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_GREENS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_BLUES));
+                  PIXEL ( pTV, pTVIndexed, p, rPALETTE(bkgndColorIdx) );
                }
                else
                {
                   // Draw 'nothing'...
-                  *pTV = CBasePalette::GetPaletteR(rPALETTE(0), !!(rPPU(PPUMASK)&PPUMASK_GREYSCALE), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_REDS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_GREENS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_BLUES));
-                  *(pTV+1) = CBasePalette::GetPaletteG(rPALETTE(0), !!(rPPU(PPUMASK)&PPUMASK_GREYSCALE), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_REDS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_GREENS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_BLUES));
-                  *(pTV+2) = CBasePalette::GetPaletteB(rPALETTE(0), !!(rPPU(PPUMASK)&PPUMASK_GREYSCALE), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_REDS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_GREENS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_BLUES));
+                  PIXEL ( pTV, pTVIndexed, p, rPALETTE(0) );
                }
 
                // Sprite 0 hit checks...
                if ( (pSelectedSprite) &&
-                    (pSelectedSpriteTemp->spriteIdx == 0) &&
+                    (pSelectedSprite->sprite0) &&
                     (!(rPPU(PPUSTATUS)&PPUSTATUS_SPRITE_0_HIT)) &&
                     (bkgndColorIdx != 0) &&
                     (p < 255) )
@@ -1734,14 +2248,14 @@ void CPPU::RENDERSCANLINE ( int32_t scanlines )
                   {
                      wPPU ( PPUSTATUS, rPPU(PPUSTATUS)|PPUSTATUS_SPRITE_0_HIT );
 
-                     if ( nesIsDebuggable() )
+                     if ( Debuggable )
                      {
                         // Save last sprite 0 hit coords for OAM viewer...
-                        m_lastSprite0HitX = p;
-                        m_lastSprite0HitY = scanline;
+                        m_state->m_lastSprite0HitX = p;
+                        m_state->m_lastSprite0HitY = scanline;
 
                         // Add trace tag for Sprice 0 hit...
-                        CNES::TRACER()->AddSample ( m_cycles, eTracer_Sprite0Hit, eNESSource_PPU, 0, 0, 0 );
+                        CNES::TRACER()->AddSample ( m_state->m_cycles, eTracer_Sprite0Hit, eNESSource_PPU, 0, 0, 0 );
 
                         // Check for Sprite 0 Hit breakpoint...
                         CNES::CHECKBREAKPOINT(eBreakInPPU,eBreakOnPPUEvent,0,PPU_EVENT_SPRITE0_HIT);
@@ -1751,34 +2265,36 @@ void CPPU::RENDERSCANLINE ( int32_t scanlines )
             }
             else
             {
-               if ( (m_ppuAddr&0x3F00) == 0x3F00 )
+               if ( (m_state->m_ppuAddr&0x3F00) == 0x3F00 )
                {
-                  *pTV = CBasePalette::GetPaletteR(rPALETTE(m_ppuAddr&0x1F), !!(rPPU(PPUMASK)&PPUMASK_GREYSCALE), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_REDS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_GREENS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_BLUES));
-                  *(pTV+1) = CBasePalette::GetPaletteG(rPALETTE(m_ppuAddr&0x1F), !!(rPPU(PPUMASK)&PPUMASK_GREYSCALE), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_REDS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_GREENS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_BLUES));
-                  *(pTV+2) = CBasePalette::GetPaletteB(rPALETTE(m_ppuAddr&0x1F), !!(rPPU(PPUMASK)&PPUMASK_GREYSCALE), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_REDS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_GREENS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_BLUES));
+                  PIXEL ( pTV, pTVIndexed, p, rPALETTE(m_state->m_ppuAddr&0x1F) );
                }
                else
                {
-                  *pTV = CBasePalette::GetPaletteR(rPALETTE(0), !!(rPPU(PPUMASK)&PPUMASK_GREYSCALE), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_REDS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_GREENS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_BLUES));
-                  *(pTV+1) = CBasePalette::GetPaletteG(rPALETTE(0), !!(rPPU(PPUMASK)&PPUMASK_GREYSCALE), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_REDS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_GREENS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_BLUES));
-                  *(pTV+2) = CBasePalette::GetPaletteB(rPALETTE(0), !!(rPPU(PPUMASK)&PPUMASK_GREYSCALE), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_REDS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_GREENS), !!(rPPU(PPUMASK)&PPUMASK_INTENSIFY_BLUES));
+                  PIXEL ( pTV, pTVIndexed, p, rPALETTE(0) );
                }
             }
 
             // Move to next pixel...
-            pTV += 4;
             p++;
          }
 
+         // Shift out the tile picked off by BKGNDSPAN, or passed over
+         // without working out its pixels, before the next one is loaded...
+         if ( ((idxx&7) == 7) && ((spanPickoff >= 0) || ((scanline >= 0) && (!pixels))) )
+         {
+            SHIFTPIPELINES ( 8 );
+         }
+
          // Secondary OAM reads occur on even PPU cycles...
          if ( !(idxx&1) )
          {
-            BUILDSPRITELIST ( scanline, idxx );
+            BUILDSPRITELIST<Debuggable> ( scanline, idxx );
          }
-         GATHERBKGND ( idxx%8 );
+         GATHERBKGND<Debuggable> ( idxx%8 );
       }
 
-      if ( nesIsDebuggable() )
+      if ( Debuggable )
       {
          // Check for end-of-scanline breakpoints...
          if ( scanline == -1 )
@@ -1791,69 +2307,69 @@ void CPPU::RENDERSCANLINE ( int32_t scanlines )
          }
       }
 
-      GATHERSPRITES ( scanline );
+      GATHERSPRITES<Debuggable> ( scanline );
 
       // Fill pipeline for next scanline...
-      m_bkgndBuffer.data[0].attribData1 = m_bkgndBuffer.data[1].attribData1;
-      m_bkgndBuffer.data[0].attribData2 = m_bkgndBuffer.data[1].attribData2;
-      m_bkgndBuffer.data[0].patternData1 = m_bkgndBuffer.data[1].patternData1;
-      m_bkgndBuffer.data[0].patternData2 = m_bkgndBuffer.data[1].patternData2;
+      m_state->m_bkgndBuffer.data[0].attribData1 = m_state->m_bkgndBuffer.data[1].attribData1;
+      m_state->m_bkgndBuffer.data[0].attribData2 = m_state->m_bkgndBuffer.data[1].attribData2;
+      m_state->m_bkgndBuffer.data[0].patternData1 = m_state->m_bkgndBuffer.data[1].patternData1;
+      m_state->m_bkgndBuffer.data[0].patternData2 = m_state->m_bkgndBuffer.data[1].patternData2;
 
       for ( p = 0; p < 8; p++ )
       {
-         GATHERBKGND ( p );
+         GATHERBKGND<Debuggable> ( p );
       }
 
       // Fill pipeline for next scanline...
-      m_bkgndBuffer.data[0].attribData1 = m_bkgndBuffer.data[1].attribData1;
-      m_bkgndBuffer.data[0].attribData2 = m_bkgndBuffer.data[1].attribData2;
-      m_bkgndBuffer.data[0].patternData1 = m_bkgndBuffer.data[1].patternData1;
-      m_bkgndBuffer.data[0].patternData2 = m_bkgndBuffer.data[1].patternData2;
+      m_state->m_bkgndBuffer.data[0].attribData1 = m_state->m_bkgndBuffer.data[1].attribData1;
+      m_state->m_bkgndBuffer.data[0].attribData2 = m_state->m_bkgndBuffer.data[1].attribData2;
+      m_state->m_bkgndBuffer.data[0].patternData1 = m_state->m_bkgndBuffer.data[1].patternData1;
+      m_state->m_bkgndBuffer.data[0].patternData2 = m_state->m_bkgndBuffer.data[1].patternData2;
 
       for ( p = 0; p < 8; p++ )
       {
-         GATHERBKGND ( p );
+         GATHERBKGND<Debuggable> ( p );
       }
 
       // Finish off scanline render clock cycles...
-      EMULATE(1);
+      EMULATE<Debuggable>(1);
 
       // If this is a visible scanline it is 341 clocks long both NTSC and PAL...
       // The exact skipped cycle appears to be cycle 337, which is right here.
       if ( scanline >= 0 )
       {
          // ...account for extra clock (341)
-         EXTRA ();
+         EXTRA<Debuggable> ();
       }
       // Otherwise, if this is the pre-render scanline it is:
       // 341 dots for PAL, always
       // 340 dots for NTSC odd frames and 341 dots for NTSC even frames if rendering is off, 341 dots for all frames otherwise
       else
       {
-         if ( (CNES::VIDEOMODE() == MODE_DENDY) || (CNES::VIDEOMODE() == MODE_PAL) || ((CNES::VIDEOMODE() == MODE_NTSC) && ((!(m_frame&1)) || (!(rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND))))) )
+         if ( (CNES::VIDEOMODE() == MODE_DENDY) || (CNES::VIDEOMODE() == MODE_PAL) || ((CNES::VIDEOMODE() == MODE_NTSC) && ((!(m_state->m_frame&1)) || (!(rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND))))) )
          {
             // account for extra clock (341)
-            EXTRA ();
+            EXTRA<Debuggable> ();
          }
       }
 
       // Finish off scanline render clock cycles...
       if ( rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) )
       {
-         GARBAGE ( 0x2000, eTarget_NameTable );
+         GARBAGE<Debuggable> ( 0x2000, eTarget_NameTable );
       }
       else
       {
-         EMULATE(1);
+         EMULATE<Debuggable>(1);
       }
-      EMULATE(1);
+      EMULATE<Debuggable>(1);
       if ( rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) )
       {
-         GARBAGE ( 0x2000, eTarget_NameTable );
+         GARBAGE<Debuggable> ( 0x2000, eTarget_NameTable );
       }
       else
       {
-         EMULATE(1);
+         EMULATE<Debuggable>(1);
       }
    }
 }
@@ -1863,9 +2379,24 @@ void CPPU::PIXELRGB ( int32_t x, int32_t y, uint8_t* r, uint8_t* g, uint8_t* b )
    if ( (x>=0) && (x<=255) && (y>=0) && (y<=239) )
    {
       int32_t rasttv = (y<<8)<<2;
-      int8_t* pTV = (int8_t*)(m_pTV+rasttv);
+      int8_t* pTV;
+      int8_t  rgb [ 4 ];
 
-      pTV += (x<<2);
+      if ( m_state->m_pTV )
+      {
+         pTV = (int8_t*)(m_state->m_pTV+rasttv);
+         pTV += (x<<2);
+      }
+      else if ( m_state->m_pTVIndexed )
+      {
+         // Only the palette-index surface is being drawn on...
+         pTV = rgb;
+         CONVERTPIXEL ( *(m_state->m_pTVIndexed+(y<<8)+x), pTV );
+      }
+      else
+      {
+         return;
+      }
 
       (*r) = (*pTV);
       (*g) = (*pTV+1);
@@ -1873,11 +2404,49 @@ void CPPU::PIXELRGB ( int32_t x, int32_t y, uint8_t* r, uint8_t* g, uint8_t* b )
    }
 }
 
-void CPPU::GATHERBKGND ( int8_t phase )
+void CPPU::CONVERTTVRGBA ( const uint16_t* pTVIndexed, int8_t* pTV, uint8_t alpha )
+{
+   uint32_t colors [ TV_INDEXED_NUM_COLORS ];
+   uint32_t* pOut = (uint32_t*)pTV;
+   int8_t   rgba [ 4 ];
+   int32_t  idx;
+
+   // The palette can be edited at any time, so build the lookup for
+   // every frame converted.  It is tiny compared to the frame.
+   for ( idx = 0; idx < TV_INDEXED_NUM_COLORS; idx++ )
+   {
+      CONVERTPIXEL ( idx, rgba );
+      rgba[3] = alpha;
+      memcpy(&colors[idx],rgba,sizeof(rgba));
+   }
+
+   for ( idx = 0; idx < TV_INDEXED_WIDTH*TV_INDEXED_HEIGHT; idx++ )
+   {
+      *(pOut+idx) = colors[*(pTVIndexed+idx)&(TV_INDEXED_NUM_COLORS-1)];
+   }
+}
+
+void CPPU::CONVERTTVRGB565 ( const uint16_t* pTVIndexed, uint16_t* pTV )
 {
-   static uint16_t patternIdx;
-   static BackgroundBufferData bkgndTemp;
+   uint16_t colors [ TV_INDEXED_NUM_COLORS ];
+   int8_t   rgb [ 4 ];
+   int32_t  idx;
 
+   for ( idx = 0; idx < TV_INDEXED_NUM_COLORS; idx++ )
+   {
+      CONVERTPIXEL ( idx, rgb );
+      colors[idx] = ((((uint8_t)rgb[0])>>3)<<11)|((((uint8_t)rgb[1])>>2)<<5)|(((uint8_t)rgb[2])>>3);
+   }
+
+   for ( idx = 0; idx < TV_INDEXED_WIDTH*TV_INDEXED_HEIGHT; idx++ )
+   {
+      *(pTV+idx) = colors[*(pTVIndexed+idx)&(TV_INDEXED_NUM_COLORS-1)];
+   }
+}
+
+template<bool Debuggable>
+void CPPU::GATHERBKGND ( int8_t phase )
+{
    uint32_t ppuAddr = rPPUADDR();
    int32_t tileX = ppuAddr&0x001F;
    int32_t tileY = (ppuAddr&0x03E0)>>5;
@@ -1885,11 +2454,11 @@ void CPPU::GATHERBKGND ( int8_t phase )
    int32_t attribAddr = 0x2000 + (ppuAddr&0x0C00) + 0x03C0 + ((tileY&0xFFFC)<<1) + (tileX>>2);
    uint8_t attribData = 0x00;
    int32_t bkgndPatBase = (!!(rPPU(PPUCTRL)&PPUCTRL_BKGND_PAT_TBL_ADDR))<<12;
-   BackgroundBufferData* pBkgnd = m_bkgndBuffer.data + 1;
+   BackgroundBufferData* pBkgnd = m_state->m_bkgndBuffer.data + 1;
 
    if ( !(phase&1) )
    {
-      EMULATE(1);
+      EMULATE<Debuggable>(1);
       return;
    }
 
@@ -1897,22 +2466,22 @@ void CPPU::GATHERBKGND ( int8_t phase )
    {
       if ( rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) )
       {
-         patternIdx = bkgndPatBase+(RENDER(nameAddr,eTracer_RenderBkgnd)<<4)+((ppuAddr&0x7000)>>12);
+         m_state->m_patternIdx = bkgndPatBase+(RENDER<Debuggable>(nameAddr,eTracer_RenderBkgnd)<<4)+((ppuAddr&0x7000)>>12);
       }
       else
       {
-         EMULATE(1);
+         EMULATE<Debuggable>(1);
       }
    }
    else if ( phase == 3 )
    {
       if ( rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) )
       {
-         attribData = RENDER ( attribAddr,eTracer_RenderBkgnd );
+         attribData = RENDER<Debuggable> ( attribAddr,eTracer_RenderBkgnd );
       }
       else
       {
-         EMULATE(1);
+         EMULATE<Debuggable>(1);
       }
 
       if ( (tileY&0x0002) == 0 )
@@ -1921,40 +2490,40 @@ void CPPU::GATHERBKGND ( int8_t phase )
          {
             if ( attribData&0x01 )
             {
-               bkgndTemp.attribData1 = 0xFF;
+               m_state->m_bkgndTemp.attribData1 = 0xFF;
             }
             else
             {
-               bkgndTemp.attribData1 = 0x00;
+               m_state->m_bkgndTemp.attribData1 = 0x00;
             }
 
             if ( attribData&0x02 )
             {
-               bkgndTemp.attribData2 = 0xFF;
+               m_state->m_bkgndTemp.attribData2 = 0xFF;
             }
             else
             {
-               bkgndTemp.attribData2 = 0x00;
+               m_state->m_bkgndTemp.attribData2 = 0x00;
             }
          }
          else
          {
             if ( attribData&0x04 )
             {
-               bkgndTemp.attribData1 = 0xFF;
+               m_state->m_bkgndTemp.attribData1 = 0xFF;
             }
             else
             {
-               bkgndTemp.attribData1 = 0x00;
+               m_state->m_bkgndTemp.attribData1 = 0x00;
             }
 
             if ( attribData&0x08 )
             {
-               bkgndTemp.attribData2 = 0xFF;
+               m_state->m_bkgndTemp.attribData2 = 0xFF;
             }
             else
             {
-               bkgndTemp.attribData2 = 0x00;
+               m_state->m_bkgndTemp.attribData2 = 0x00;
             }
          }
       }
@@ -1964,40 +2533,40 @@ void CPPU::GATHERBKGND ( int8_t phase )
          {
             if ( attribData&0x10 )
             {
-               bkgndTemp.attribData1 = 0xFF;
+               m_state->m_bkgndTemp.attribData1 = 0xFF;
             }
             else
             {
-               bkgndTemp.attribData1 = 0x00;
+               m_state->m_bkgndTemp.attribData1 = 0x00;
             }
 
             if ( attribData&0x20 )
             {
-               bkgndTemp.attribData2 = 0xFF;
+               m_state->m_bkgndTemp.attribData2 = 0xFF;
             }
             else
             {
-               bkgndTemp.attribData2 = 0x00;
+               m_state->m_bkgndTemp.attribData2 = 0x00;
             }
          }
          else
          {
             if ( attribData&0x40 )
             {
-               bkgndTemp.attribData1 = 0xFF;
+               m_state->m_bkgndTemp.attribData1 = 0xFF;
             }
             else
             {
-               bkgndTemp.attribData1 = 0x00;
+               m_state->m_bkgndTemp.attribData1 = 0x00;
             }
 
             if ( attribData&0x80 )
             {
-               bkgndTemp.attribData2 = 0xFF;
+               m_state->m_bkgndTemp.attribData2 = 0xFF;
             }
             else
             {
-               bkgndTemp.attribData2 = 0x00;
+               m_state->m_bkgndTemp.attribData2 = 0x00;
             }
          }
       }
@@ -2006,38 +2575,35 @@ void CPPU::GATHERBKGND ( int8_t phase )
    {
       if ( rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) )
       {
-         bkgndTemp.patternData1 = RENDER ( patternIdx,eTracer_RenderBkgnd );
+         m_state->m_bkgndTemp.patternData1 = RENDER<Debuggable> ( m_state->m_patternIdx,eTracer_RenderBkgnd );
       }
       else
       {
-         EMULATE(1);
+         EMULATE<Debuggable>(1);
       }
    }
    else if ( phase == 7 )
    {
       if ( rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) )
       {
-         bkgndTemp.patternData2 = RENDER ( patternIdx+PATTERN_SIZE,eTracer_RenderBkgnd );
+         m_state->m_bkgndTemp.patternData2 = RENDER<Debuggable> ( m_state->m_patternIdx+PATTERN_SIZE,eTracer_RenderBkgnd );
       }
       else
       {
-         EMULATE(1);
+         EMULATE<Debuggable>(1);
       }
 
-      pBkgnd->attribData1 = bkgndTemp.attribData1;
-      pBkgnd->attribData2 = bkgndTemp.attribData2;
-      pBkgnd->patternData1 = bkgndTemp.patternData1;
-      pBkgnd->patternData2 = bkgndTemp.patternData2;
+      pBkgnd->attribData1 = m_state->m_bkgndTemp.attribData1;
+      pBkgnd->attribData2 = m_state->m_bkgndTemp.attribData2;
+      pBkgnd->patternData1 = m_state->m_bkgndTemp.patternData1;
+      pBkgnd->patternData2 = m_state->m_bkgndTemp.patternData2;
 
    }
 }
 
+template<bool Debuggable>
 void CPPU::BUILDSPRITELIST ( int32_t scanline, int32_t cycle )
 {
-   static SpriteTemporaryMemoryData  devNull;
-   static SpriteTemporaryMemoryData* pSprite = &devNull;
-   static int32_t                    spritesFound = 0;
-
    int32_t          idx1;
    int32_t          spriteY;
    int32_t          spriteSize;
@@ -2046,14 +2612,14 @@ void CPPU::BUILDSPRITELIST ( int32_t scanline, int32_t cycle )
    // secondary OAM data...
    if ( cycle == 0 )
    {
-      spritesFound = 0;
-      m_oamAddr = 0;
-      pSprite = &devNull;
-      m_spriteTemporaryMemory.count = 0;
-      m_spriteTemporaryMemory.sprite = (m_oamAddr>>2);
-      m_spriteTemporaryMemory.phase = 0;
-      m_spriteTemporaryMemory.yByte = (m_oamAddr&0x3);
-      m_spriteTemporaryMemory.rolling = 0;
+      m_state->m_spritesFound = 0;
+      m_state->m_oamAddr = 0;
+      m_state->m_pSprite = &m_state->m_spriteDevNull;
+      m_state->m_spriteTemporaryMemory.count = 0;
+      m_state->m_spriteTemporaryMemory.sprite = (m_state->m_oamAddr>>2);
+      m_state->m_spriteTemporaryMemory.phase = 0;
+      m_state->m_spriteTemporaryMemory.yByte = (m_state->m_oamAddr&0x3);
+      m_state->m_spriteTemporaryMemory.rolling = 0;
    }
 
    // Loop invariants...
@@ -2068,18 +2634,18 @@ void CPPU::BUILDSPRITELIST ( int32_t scanline, int32_t cycle )
    }
 
    // Secondary OAM reads stop after all sprites evaluated...
-   if ( m_spriteTemporaryMemory.sprite == NUM_SPRITES )
+   if ( m_state->m_spriteTemporaryMemory.sprite == NUM_SPRITES )
    {
       return;
    }
 
-   if ( m_spriteTemporaryMemory.phase == 0 )
+   if ( m_state->m_spriteTemporaryMemory.phase == 0 )
    {
       // Populate sprite buffer...
       // Retrieve OAM byte for scanline check...
       // Note: obscure PPU 'bug' in that 9th sprite on scanline
       // causes other sprite data to be used as the Y-coordinate.
-      spriteY = OAM ( m_spriteTemporaryMemory.yByte, m_spriteTemporaryMemory.sprite ) + 1;
+      spriteY = OAM ( m_state->m_spriteTemporaryMemory.yByte, m_state->m_spriteTemporaryMemory.sprite ) + 1;
 
       // idx1 is sprite slice (it will be in range 0-7 or 0-15 if the sprite
       // is on the next scanline.
@@ -2089,19 +2655,19 @@ void CPPU::BUILDSPRITELIST ( int32_t scanline, int32_t cycle )
       if ( (idx1 >= 0) && (idx1 < spriteSize) )
       {
          // Calculate sprite-per-scanline limit...
-         spritesFound++;
+         m_state->m_spritesFound++;
 
-         if ( spritesFound > 8 )
+         if ( m_state->m_spritesFound > 8 )
          {
             // Found 8 sprites, point to /dev/null for future sprites on this scanline...
-            pSprite = &devNull;
+            m_state->m_pSprite = &m_state->m_spriteDevNull;
 
             // Move to next sprite...
-            m_spriteTemporaryMemory.sprite++;
-            m_spriteTemporaryMemory.phase = 0;
+            m_state->m_spriteTemporaryMemory.sprite++;
+            m_state->m_spriteTemporaryMemory.phase = 0;
 
             // Should we assert sprite overflow?
-            if ( spritesFound == 9 )
+            if ( m_state->m_spritesFound == 9 )
             {
                if ( rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) )
                {
@@ -2109,7 +2675,7 @@ void CPPU::BUILDSPRITELIST ( int32_t scanline, int32_t cycle )
                   {
                      wPPU(PPUSTATUS,rPPU(PPUSTATUS)|PPUSTATUS_SPRITE_OVFLO );
 
-                     if ( nesIsDebuggable() )
+                     if ( Debuggable )
                      {
                         // Check for breakpoint...
                         CNES::CHECKBREAKPOINT ( eBreakInPPU, eBreakOnPPUEvent, 0, PPU_EVENT_SPRITE_OVERFLOW );
@@ -2121,70 +2687,71 @@ void CPPU::BUILDSPRITELIST ( int32_t scanline, int32_t cycle )
          else
          {
             // Cause fetch phases to occur for this in-range sprite...
-            m_spriteTemporaryMemory.phase++;
+            m_state->m_spriteTemporaryMemory.phase++;
 
             // Found a sprite...
-            pSprite = m_spriteTemporaryMemory.data+m_spriteTemporaryMemory.count;
-            pSprite->spriteIdx = m_spriteTemporaryMemory.sprite;
-            pSprite->spriteSlice = idx1;
+            m_state->m_pSprite = m_state->m_spriteTemporaryMemory.data+m_state->m_spriteTemporaryMemory.count;
+            m_state->m_pSprite->spriteIdx = m_state->m_spriteTemporaryMemory.sprite;
+            m_state->m_pSprite->spriteSlice = idx1;
          }
       }
       else
       {
          // Sprite not on this scanline, move to next one...
-         m_spriteTemporaryMemory.sprite++;
+         m_state->m_spriteTemporaryMemory.sprite++;
       }
 
       // If we've found 8 sprites on this scanline, enable the
       // obscure PPU 'bug'.
-      if ( (spritesFound == 8) && (!(idx1 >= 0) && (idx1 < spriteSize)) )
+      if ( (m_state->m_spritesFound == 8) && (!(idx1 >= 0) && (idx1 < spriteSize)) )
       {
-         m_spriteTemporaryMemory.rolling = 1;
+         m_state->m_spriteTemporaryMemory.rolling = 1;
       }
 
       // The obscure PPU 'bug' behavior rolls through different
       // sprite data bytes as the Y-coordinate...
-      if ( m_spriteTemporaryMemory.rolling )
+      if ( m_state->m_spriteTemporaryMemory.rolling )
       {
-         m_spriteTemporaryMemory.yByte++;
-         m_spriteTemporaryMemory.yByte %= OAM_SIZE;
+         m_state->m_spriteTemporaryMemory.yByte++;
+         m_state->m_spriteTemporaryMemory.yByte %= OAM_SIZE;
       }
 
-      if ( spritesFound < NUM_SPRITES_PER_SCANLINE )
+      if ( m_state->m_spritesFound < NUM_SPRITES_PER_SCANLINE )
       {
-         m_spriteTemporaryMemory.count = spritesFound;
+         m_state->m_spriteTemporaryMemory.count = m_state->m_spritesFound;
       }
       else
       {
-         m_spriteTemporaryMemory.count = NUM_SPRITES_PER_SCANLINE;
+         m_state->m_spriteTemporaryMemory.count = NUM_SPRITES_PER_SCANLINE;
       }
    }
-   else if ( (pSprite != &devNull) && (m_spriteTemporaryMemory.phase == 1) )
+   else if ( (m_state->m_pSprite != &m_state->m_spriteDevNull) && (m_state->m_spriteTemporaryMemory.phase == 1) )
    {
       // Cause fetch phases to occur for this in-range sprite...
-      m_spriteTemporaryMemory.phase++;
+      m_state->m_spriteTemporaryMemory.phase++;
 
-      pSprite->patternIdx = OAM ( SPRITEPAT, pSprite->spriteIdx );
+      m_state->m_pSprite->patternIdx = OAM ( SPRITEPAT, m_state->m_pSprite->spriteIdx );
    }
-   else if ( (pSprite != &devNull) && (m_spriteTemporaryMemory.phase == 2) )
+   else if ( (m_state->m_pSprite != &m_state->m_spriteDevNull) && (m_state->m_spriteTemporaryMemory.phase == 2) )
    {
       // Cause fetch phases to occur for this in-range sprite...
-      m_spriteTemporaryMemory.phase++;
+      m_state->m_spriteTemporaryMemory.phase++;
 
-      pSprite->attribData = OAM ( SPRITEATT, pSprite->spriteIdx );
+      m_state->m_pSprite->attribData = OAM ( SPRITEATT, m_state->m_pSprite->spriteIdx );
    }
-   else if ( (pSprite != &devNull) && (m_spriteTemporaryMemory.phase == 3) )
+   else if ( (m_state->m_pSprite != &m_state->m_spriteDevNull) && (m_state->m_spriteTemporaryMemory.phase == 3) )
    {
       // Move to next sprite...
-      m_spriteTemporaryMemory.sprite++;
-      m_spriteTemporaryMemory.phase = 0;
+      m_state->m_spriteTemporaryMemory.sprite++;
+      m_state->m_spriteTemporaryMemory.phase = 0;
 
-      pSprite->spriteX = OAM ( SPRITEX, pSprite->spriteIdx );
+      m_state->m_pSprite->spriteX = OAM ( SPRITEX, m_state->m_pSprite->spriteIdx );
    }
 
-   m_oamAddr = (m_spriteTemporaryMemory.sprite<<2)|(m_spriteTemporaryMemory.phase);
+   m_state->m_oamAddr = (m_state->m_spriteTemporaryMemory.sprite<<2)|(m_state->m_spriteTemporaryMemory.phase);
 }
 
+template<bool Debuggable>
 void CPPU::GATHERSPRITES ( int32_t scanline )
 {
    int32_t idx1;
@@ -2204,11 +2771,11 @@ void CPPU::GATHERSPRITES ( int32_t scanline )
    }
 
    // Populate sprite buffer...
-   for ( sprite = 0; sprite < m_spriteTemporaryMemory.count; sprite++ )
+   for ( sprite = 0; sprite < m_state->m_spriteTemporaryMemory.count; sprite++ )
    {
       // Move sprite data...
-      pSpriteTemp = (m_spriteTemporaryMemory.data+sprite);
-      pSprite = m_spriteBuffer.data+sprite;
+      pSpriteTemp = (m_state->m_spriteTemporaryMemory.data+sprite);
+      pSprite = m_state->m_spriteBuffer.data+sprite;
 
       pSprite->temp.attribData = pSpriteTemp->attribData;
       pSprite->temp.patternIdx = pSpriteTemp->patternIdx;
@@ -2217,13 +2784,13 @@ void CPPU::GATHERSPRITES ( int32_t scanline )
       pSprite->temp.spriteX = pSpriteTemp->spriteX;
    }
 
-   m_spriteBuffer.count = m_spriteTemporaryMemory.count;
+   m_state->m_spriteBuffer.count = m_state->m_spriteTemporaryMemory.count;
 
    // Work with sprite buffer...
-   for ( sprite = 0; sprite < m_spriteBuffer.count; sprite++ )
+   for ( sprite = 0; sprite < m_state->m_spriteBuffer.count; sprite++ )
    {
       // Get sprite data...
-      pSprite = m_spriteBuffer.data+sprite;
+      pSprite = m_state->m_spriteBuffer.data+sprite;
       pSpriteTemp = &(pSprite->temp);
 
       // Get sprite 'slice'...
@@ -2260,55 +2827,55 @@ void CPPU::GATHERSPRITES ( int32_t scanline )
       // Garbage nametable fetches according to Samus Aran...
       if ( rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) )
       {
-         EMULATE(1);
-         GARBAGE ( 0x2000, eTarget_NameTable );
-         EMULATE(1);
-         GARBAGE ( 0x2000, eTarget_NameTable );
+         EMULATE<Debuggable>(1);
+         GARBAGE<Debuggable> ( 0x2000, eTarget_NameTable );
+         EMULATE<Debuggable>(1);
+         GARBAGE<Debuggable> ( 0x2000, eTarget_NameTable );
       }
       else
       {
-         EMULATE(4);
+         EMULATE<Debuggable>(4);
       }
 
       // Get sprite's pattern data...
-      EMULATE(1);
+      EMULATE<Debuggable>(1);
 
       if ( rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) )
       {
-         pSprite->patternData1 = RENDER ( spritePatBase+(patternIdx<<4)+(idx1&0x7), eTracer_RenderSprite );
+         pSprite->patternData1 = RENDER<Debuggable> ( spritePatBase+(patternIdx<<4)+(idx1&0x7), eTracer_RenderSprite );
       }
       else
       {
-         EMULATE(1);
+         EMULATE<Debuggable>(1);
       }
 
-      EMULATE(1);
+      EMULATE<Debuggable>(1);
 
       if ( rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) )
       {
-         pSprite->patternData2 = RENDER ( spritePatBase+(patternIdx<<4)+(idx1&0x7)+PATTERN_SIZE, eTracer_RenderSprite );
+         pSprite->patternData2 = RENDER<Debuggable> ( spritePatBase+(patternIdx<<4)+(idx1&0x7)+PATTERN_SIZE, eTracer_RenderSprite );
       }
       else
       {
-         EMULATE(1);
+         EMULATE<Debuggable>(1);
       }
    }
 
    // Perform remaining garbage fetches to finish out the scanline's
    // PPU cycles...
-   for ( sprite = m_spriteBuffer.count; sprite < NUM_SPRITES_PER_SCANLINE; sprite++ )
+   for ( sprite = m_state->m_spriteBuffer.count; sprite < NUM_SPRITES_PER_SCANLINE; sprite++ )
    {
       // Garbage nametable fetches according to Samus Aran...
       if ( rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) )
       {
-         EMULATE(1);
-         GARBAGE ( 0x2000, eTarget_NameTable );
-         EMULATE(1);
-         GARBAGE ( 0x2000, eTarget_NameTable );
+         EMULATE<Debuggable>(1);
+         GARBAGE<Debuggable> ( 0x2000, eTarget_NameTable );
+         EMULATE<Debuggable>(1);
+         GARBAGE<Debuggable> ( 0x2000, eTarget_NameTable );
       }
       else
       {
-         EMULATE(4);
+         EMULATE<Debuggable>(4);
       }
 
       if ( spriteSize == 16 )
@@ -2318,14 +2885,22 @@ void CPPU::GATHERSPRITES ( int32_t scanline )
 
       if ( rPPU(PPUMASK)&(PPUMASK_RENDER_BKGND|PPUMASK_RENDER_SPRITES) )
       {
-         EMULATE(1);
-         GARBAGE ( spritePatBase+(GARBAGE_SPRITE_FETCH<<4), eTarget_PatternMemory );
-         EMULATE(1);
-         GARBAGE ( spritePatBase+(GARBAGE_SPRITE_FETCH<<4)+PATTERN_SIZE, eTarget_PatternMemory );
+         EMULATE<Debuggable>(1);
+         GARBAGE<Debuggable> ( spritePatBase+(GARBAGE_SPRITE_FETCH<<4), eTarget_PatternMemory );
+         EMULATE<Debuggable>(1);
+         GARBAGE<Debuggable> ( spritePatBase+(GARBAGE_SPRITE_FETCH<<4)+PATTERN_SIZE, eTarget_PatternMemory );
       }
       else
       {
-         EMULATE(4);
+         EMULATE<Debuggable>(4);
       }
    }
 }
+
+// The scanline renderers CNES::RUN chooses between.
+template void CPPU::RENDERSCANLINE<false> ( int32_t scanlines );
+template void CPPU::RENDERSCANLINE<true> ( int32_t scanlines );
+template void CPPU::QUIETSCANLINES<false> ( void );
+template void CPPU::QUIETSCANLINES<true> ( void );
+template void CPPU::VBLANKSCANLINES<false> ( void );
+template void CPPU::VBLANKSCANLINES<true> ( void );
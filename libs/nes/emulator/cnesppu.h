@@ -7,6 +7,7 @@
 #include "ccodedatalogger.h"
 
 #include "cnesrom.h"
+#include "cnesstate.h"
 
 // Rudimentary PPU I/O bus decay algorithm simply counts PPU frames to get
 // "close" to 600 milliseconds of time elapsed for a single bit to decay.
@@ -24,6 +25,29 @@
 #define PPU_CPU_RATIO_PAL   16
 #define PPU_CPU_RATIO_DENDY 15
 
+// Work the PPU does on particular dots of a scanline besides fetching and
+// drawing pixels.  Every scanline of a frame is one of a few kinds, and
+// each kind has a table of the work due on each of its dots.
+#define PPU_DOT_HSCROLL_RELOAD 0x01 // Copy horizontal scroll from the latch.
+#define PPU_DOT_VSCROLL_RELOAD 0x02 // Copy the whole latch.
+#define PPU_DOT_Y_INCREMENT    0x04 // Step to the next row of pixels.
+#define PPU_DOT_X_INCREMENT    0x08 // Step to the next tile.
+#define PPU_DOT_NMI            0x10 // VBLANK starts; assert NMI.
+#define PPU_DOT_VBLANK         0x20 // Re-enabling NMI asserts it.
+#define PPU_DOT_OAM_CLEAR      0x40 // Clear the OAM address.
+#define PPU_DOT_SCROLL         (PPU_DOT_HSCROLL_RELOAD|PPU_DOT_VSCROLL_RELOAD|PPU_DOT_Y_INCREMENT|PPU_DOT_X_INCREMENT)
+
+enum
+{
+   ePPULine_Visible = 0,
+   ePPULine_Idle,
+   ePPULine_VblankStart,
+   ePPULine_Vblank,
+   ePPULine_VblankOAMClear,
+   ePPULine_Prerender,
+   ePPULine_Count
+};
+
 // This structure represents a sprite entry in the
 // sprite temporary memory which is the memory used
 // by the PPU during pixel rendering to store accumulated
@@ -108,6 +132,23 @@ typedef struct _SpriteBuffer
    SpriteBufferData data [ NUM_SPRITES_PER_SCANLINE ];
 } SpriteBuffer;
 
+// This structure represents one pixel of the sprite line
+// buffer, which holds the result of running the sprite
+// multiplexer over the secondary OAM for a whole scanline.
+typedef struct _SpriteLineData
+{
+   // Sprite palette index of the frontmost opaque sprite
+   // pixel, or 0 if there is none.
+   uint8_t colorIdx;
+
+   // Which secondary OAM entry the pixel came from.
+   uint8_t sprite;
+
+   // Sprite attributes.
+   bool    spriteBehind;
+   bool    sprite0;
+} SpriteLineData;
+
 // This structure represents an entry in the 2-entry tile slice
 // buffer that is filled by the PPU during cycles 320-335 of
 // a scanline.
@@ -142,11 +183,11 @@ typedef struct _BackgroundBuffer
 } BackgroundBuffer;
 
 // Macros for internal access to PPU data for use within the PPU object.
-#define rPALETTE(addr) ( (*(m_PALETTEmemory+(addr))&0x3F) )
-#define rPPU(addr) ( *(m_PPUreg+((addr)&0x0007)) )
-#define wPPU(addr,data) { *(m_PPUreg+((addr)&0x0007)) = (data); CNES::CHECKBREAKPOINT(eBreakInPPU,eBreakOnPPUState,addr&0x0007); }
-#define rPPUADDR() ( m_ppuAddr )
-#define rSCROLLX() ( m_ppuScrollX )
+#define rPALETTE(addr) ( (*(m_state->m_PALETTEmemory+(addr))&0x3F) )
+#define rPPU(addr) ( *(m_state->m_PPUreg+((addr)&0x0007)) )
+#define wPPU(addr,data) { *(m_state->m_PPUreg+((addr)&0x0007)) = (data); CNES::CHECKBREAKPOINT(eBreakInPPU,eBreakOnPPUState,addr&0x0007); }
+#define rPPUADDR() ( m_state->m_ppuAddr )
+#define rSCROLLX() ( m_state->m_ppuScrollX )
 
 // The CPPU class is the implementation of the PPU of the NES.
 // It provides PPU-fetch-cycle granular emulation of the PPU core.
@@ -180,6 +221,11 @@ typedef struct _BackgroundBuffer
 // executes instruction cycles when kicked by the PPU object.
 // The CPU object also executes APU cycles by passing the execution
 // over to the APU object (CAPU).
+// The PPU is the master clock but only kicks the CPU on the dots where
+// the CPU is owed a cycle; on the other dots the CPU cycles are banked.
+// On scanlines that are not rendered nothing happens on most dots, so
+// the PPU runs ahead from one event (a CPU cycle coming due, the NMI
+// edge, the NMI choke window lapsing, ...) to the next in one step.
 // There are some slight complications in this scheme such as
 // PPU or APU DMA events, but those do not perturb the general
 // flow described here too drastically.  The CPU/APU share the same
@@ -192,8 +238,22 @@ public:
    CPPU();
    ~CPPU();
 
+   // Allocate/free the resources owned by the selected machine.
+   static void CREATE ( void );
+   static void DESTROY ( void );
+
+   // Save/restore the selected machine's PPU state to/from a binary save-state.
+   static void SAVESTATE ( CNESStateWriter& state );
+   static bool LOADSTATE ( CNESStateReader& state );
+
    // Emulation routine.  Emulates one PPU cycle.
-   static inline void EMULATE ( uint32_t cycles );
+   template<bool Debuggable> static inline void EMULATE ( uint32_t cycles );
+
+   // How many CPU cycles the PPU will hand the CPU before it does
+   // anything a CPU sitting in an idle loop could notice: assert NMI or,
+   // with status set, change what PPUSTATUS reads back.  Never reaches
+   // past VBLANK into the pre-render scanline.
+   static uint32_t CPUIDLECYCLES ( bool status );
 
    // Routine invoked on reset of the emulation engine.
    // Cleans up the PPU state as if a NES reset had just occurred.
@@ -216,25 +276,25 @@ public:
    // Read a byte from the PPU's internal OAM memory.
    static inline uint32_t OAM ( uint32_t oam, uint32_t sprite )
    {
-      return *(m_PPUoam+(sprite*OAM_SIZE)+oam);
+      return *(m_state->m_PPUoam+(sprite*OAM_SIZE)+oam);
    }
 
    // Write a byte to the PPU's internal OAM memory.
    static inline void OAM ( uint32_t oam, uint32_t sprite, uint8_t data )
    {
-      *(m_PPUoam+(sprite*OAM_SIZE)+oam) = data;
+      *(m_state->m_PPUoam+(sprite*OAM_SIZE)+oam) = data;
    }
 
    // Read a byte from the PPU's internal OAM memory.
    static inline uint32_t _OAM ( uint32_t oam, uint32_t sprite )
    {
-      return *(m_PPUoam+(sprite*OAM_SIZE)+oam);
+      return *(m_state->m_PPUoam+(sprite*OAM_SIZE)+oam);
    }
 
    // Write a byte to the PPU's internal OAM memory.
    static inline void _OAM ( uint32_t oam, uint32_t sprite, uint8_t data )
    {
-      *(m_PPUoam+(sprite*OAM_SIZE)+oam) = data;
+      *(m_state->m_PPUoam+(sprite*OAM_SIZE)+oam) = data;
    }
 
    // Return the current cycle index of the PPU core.
@@ -256,36 +316,37 @@ public:
    // its presence or lack thereof.
    static inline uint32_t _CYCLES ( void )
    {
-      return m_cycles;
+      return m_state->m_cycles;
    }
 
    // Every PPU frame starts at PPU cycle 0.
    static inline void RESETCYCLECOUNTER ( void )
    {
-      m_cycles = 0;
-      m_frame++;
+      m_state->m_cycles = 0;
+      m_state->m_frame++;
+      SYNCDOT ();
    }
 
    // Accessor methods to set up or clear the state of the nametable memory
    // maintained internally by the PPU object.
    static void MEMSET ( uint32_t addr, uint8_t* data, uint32_t length )
    {
-      memcpy(m_PPUmemory+addr,data,length);
+      memcpy(m_state->m_PPUmemory+addr,data,length);
    }
    static void MEMCLR ( void )
    {
-      memset(m_PPUmemory,0,MEM_4KB);
+      memset(m_state->m_PPUmemory,0,MEM_2KB);
    }
 
    // Accessor methods to set up or clear the state of the OAM memory
    // maintained internally by the PPU object.
    static void OAMSET ( uint32_t addr, uint8_t* data, uint32_t length )
    {
-      memcpy(m_PPUoam+addr,data,length);
+      memcpy(m_state->m_PPUoam+addr,data,length);
    }
    static void OAMCLR ( void )
    {
-      memset(m_PPUoam,0,MEM_256B);
+      memset(m_state->m_PPUoam,0,MEM_256B);
    }
 
    // Routines to configure or retrieve information about the current
@@ -296,16 +357,20 @@ public:
    static void MIRROR ( int32_t b0, int32_t b1, int32_t b2, int32_t b3 );
    static inline bool FOURSCREEN ( void )
    {
-      return m_extraVRAM;
+      return m_state->m_extraVRAM;
    }
 
    // Rendering interfaces.  These are invoked by the NES object at
    // particular places within the PPU frame to run the PPU for a
    // specific number of PPU cycles, usually a multiple of the number
    // of PPU cycles per scanline.
-   static void RENDERSCANLINE ( int32_t scanline );
-   static void QUIETSCANLINES ( void );
-   static void VBLANKSCANLINES ( void );
+   //
+   // Each comes in two flavours: Debuggable=true feeds the tracer,
+   // code/data logger and breakpoints, Debuggable=false leaves all of
+   // that out of the generated code.  CNES::RUN picks one per frame.
+   template<bool Debuggable> static void RENDERSCANLINE ( int32_t scanline );
+   template<bool Debuggable> static void QUIETSCANLINES ( void );
+   template<bool Debuggable> static void VBLANKSCANLINES ( void );
 
    // Interface to handle the special case where the setting of the
    // VBLANK flag in the PPU registers is choked by the reading of the
@@ -313,12 +378,12 @@ public:
    // the PPU frame.
    static inline void VBLANKCHOKED ( bool choked )
    {
-      m_vblankChoked = choked;
+      m_state->m_vblankChoked = choked;
    }
    static inline bool VBLANKCHOKED ()
    {
-      bool choked = m_vblankChoked;
-      m_vblankChoked = false;
+      bool choked = m_state->m_vblankChoked;
+      m_state->m_vblankChoked = false;
       return choked;
    }
 
@@ -327,11 +392,11 @@ public:
    // PPU frame.
    static inline void NMICHOKED ( bool choked )
    {
-      m_nmiChoked = choked;
+      m_state->m_nmiChoked = choked;
    }
    static inline bool NMICHOKED ()
    {
-      return m_nmiChoked;
+      return m_state->m_nmiChoked;
    }
 
    // Interface to handle the special case where assertion of NMI can be
@@ -339,12 +404,12 @@ public:
    // bit is cleared and re-set during the VBLANK period.
    static inline void NMIREENABLED ( bool reenabled )
    {
-      m_nmiReenabled = reenabled;
+      m_state->m_nmiReenabled = reenabled;
    }
    static inline bool NMIREENABLED ()
    {
-      bool reenabled = m_nmiReenabled;
-      m_nmiReenabled = false;
+      bool reenabled = m_state->m_nmiReenabled;
+      m_state->m_nmiReenabled = false;
       return reenabled;
    }
 
@@ -358,7 +423,7 @@ public:
    // part of the emulation process (ie. generate an NMI to the CPU core or not?)
    static inline uint32_t _PPU ( uint32_t addr )
    {
-      return *(m_PPUreg+(addr&0x0007));
+      return *(m_state->m_PPUreg+(addr&0x0007));
    }
 
    // Write a PPU register.
@@ -368,7 +433,7 @@ public:
    // flag are not necessarily dependent on executed code.
    static inline void _PPU ( uint32_t addr, uint8_t data )
    {
-      *(m_PPUreg+(addr&0x0007)) = data;
+      *(m_state->m_PPUreg+(addr&0x0007)) = data;
    }
 
    // Silently read from a memory location visible to the PPU.
@@ -392,11 +457,11 @@ public:
    // impacting the state of the emulation.
    static inline uint8_t _NAMETABLE ( uint16_t addr )
    {
-      return *((*(m_pPPUmemory+((addr&0x1FFF)>>10)))+(addr&0x3FF));
+      return *((*(m_state->m_pPPUmemory+((addr&0x1FFF)>>10)))+(addr&0x3FF));
    }
    static inline uint8_t _ATTRTABLE ( uint16_t addr )
    {
-      return *((*(m_pPPUmemory+((addr&0x1FFF)>>10)))+(addr&0x3FF));
+      return *((*(m_state->m_pPPUmemory+((addr&0x1FFF)>>10)))+(addr&0x3FF));
    }
    static inline uint8_t _PATTERNDATA ( uint16_t addr )
    {
@@ -409,37 +474,37 @@ public:
          addr = 0x00;
       }
 
-      return *(m_PALETTEmemory+addr);
+      return *(m_state->m_PALETTEmemory+addr);
    }
 
    // Return the internal state of the PPU's hardware such as the OAM address latch, the PPU
    // address latch, and the read-buffer.
    static inline uint8_t _OAMADDR ( void )
    {
-      return m_oamAddr;
+      return m_state->m_oamAddr;
    }
    static inline uint16_t _PPUADDR ( void )
    {
-      return m_ppuAddr;
+      return m_state->m_ppuAddr;
    }
    static inline uint8_t _PPUREADLATCH ( void )
    {
-      return m_ppuReadLatch;
+      return m_state->m_ppuReadLatch;
    }
    static inline uint16_t _PPUADDRLATCH ( void )
    {
-      return m_ppuAddrLatch;
+      return m_state->m_ppuAddrLatch;
    }
    static inline int32_t _PPUFLIPFLOP ( void )
    {
-      return m_ppuRegByte;
+      return m_state->m_ppuRegByte;
    }
    static inline void _MIRROR(uint16_t* sc1, uint16_t* sc2, uint16_t* sc3, uint16_t* sc4)
    {
-      (*sc1) = ((uint8_t*)m_pPPUmemory[0]-(uint8_t*)m_PPUmemory)+MEM_8KB;
-      (*sc2) = ((uint8_t*)m_pPPUmemory[1]-(uint8_t*)m_PPUmemory)+MEM_8KB;
-      (*sc3) = ((uint8_t*)m_pPPUmemory[2]-(uint8_t*)m_PPUmemory)+MEM_8KB;
-      (*sc4) = ((uint8_t*)m_pPPUmemory[3]-(uint8_t*)m_PPUmemory)+MEM_8KB;
+      (*sc1) = ((uint8_t*)m_state->m_pPPUmemory[0]-(uint8_t*)m_state->m_PPUmemory)+MEM_8KB;
+      (*sc2) = ((uint8_t*)m_state->m_pPPUmemory[1]-(uint8_t*)m_state->m_PPUmemory)+MEM_8KB;
+      (*sc3) = ((uint8_t*)m_state->m_pPPUmemory[2]-(uint8_t*)m_state->m_PPUmemory)+MEM_8KB;
+      (*sc4) = ((uint8_t*)m_state->m_pPPUmemory[3]-(uint8_t*)m_state->m_PPUmemory)+MEM_8KB;
    }
 
    // Accessor functions for the database of scroll values indexed by pixel
@@ -449,26 +514,26 @@ public:
    // inspector.
    static inline uint16_t _SCROLLX ( int32_t x, int32_t y )
    {
-      return *(*(m_2005x+x)+y);
+      return *(*(m_state->m_2005x+x)+y);
    }
    static inline uint16_t _SCROLLY ( int32_t x, int32_t y )
    {
-      return *(*(m_2005y+x)+y);
+      return *(*(m_state->m_2005y+x)+y);
    }
    static inline void _SCROLL ( uint8_t* x, uint8_t* y )
    {
-      (*x) = m_last2005x;
-      (*y) = m_last2005y;
+      (*x) = m_state->m_last2005x;
+      (*y) = m_state->m_last2005y;
    }
 
    // Accessor functions for the pixel coordinate of the last sprite-0 hit.
    static inline uint8_t _SPRITE0HITX ( void )
    {
-      return m_lastSprite0HitX;
+      return m_state->m_lastSprite0HitX;
    }
    static inline uint8_t _SPRITE0HITY ( void )
    {
-      return m_lastSprite0HitY;
+      return m_state->m_lastSprite0HitY;
    }
 
    // Returns a running counter of the number of frames that have elapsed
@@ -477,35 +542,48 @@ public:
    // even then, roll-over of this counter is not a significant event.
    static inline uint32_t _FRAME ( void )
    {
-      return m_frame;
+      return m_state->m_frame;
    }
 
    // Accessor functions for the pixel coordinate of the PPU during rendering.
    static inline uint8_t _X ( void )
    {
-      return m_x;
+      return m_state->m_x;
    }
    static inline uint8_t _Y ( void )
    {
-      return m_y;
+      return m_state->m_y;
    }
 
    // Accessor routines to get or set the rendering surface memory to
    // be used by the PPU to render the emulated machine's image.
    static inline void TV ( int8_t* pTV )
    {
-      m_pTV = pTV;
+      m_state->m_pTV = pTV;
    }
    static inline int8_t* TV ( void )
    {
-      return m_pTV;
+      return m_state->m_pTV;
+   }
+   static inline void TVINDEXED ( uint16_t* pTV )
+   {
+      m_state->m_pTVIndexed = pTV;
+   }
+   static inline uint16_t* TVINDEXED ( void )
+   {
+      return m_state->m_pTVIndexed;
    }
 
+   // Expand a palette-index surface to the RGBA layout used by TV(), or
+   // to 256x240 RGB565 pixels.
+   static void CONVERTTVRGBA ( const uint16_t* pTVIndexed, int8_t* pTV, uint8_t alpha );
+   static void CONVERTTVRGB565 ( const uint16_t* pTVIndexed, uint16_t* pTV );
+
    // Accessor method used by some ROM mappers that can remap the
    // nametable memory in a more complicated fashion than straight mirroring.
    static inline void REMAPVRAM ( int32_t bank, uint8_t* point )
    {
-      m_pPPUmemory[bank] = point;
+      m_state->m_pPPUmemory[bank] = point;
    }
 
    // Accessor method to retrieve the database managed by the PPU
@@ -513,7 +591,7 @@ public:
    // Logger debugger inspector.
    static inline CCodeDataLogger* LOGGER ( void )
    {
-      return m_logger;
+      return m_state->m_logger;
    }
 
    // Interface to retrieve the database defining the registers
@@ -564,202 +642,331 @@ protected:
 
    // Routines to access the RAM maintained by the PPU core object for rendering.
    // These are used internally by the PPU core during emulation.
-   static inline uint32_t RENDER ( uint32_t addr, int8_t target );
-   static inline void GARBAGE ( uint32_t addr, int8_t target );
-   static inline void EXTRA ();
+   template<bool Debuggable> static inline uint32_t RENDER ( uint32_t addr, int8_t target );
+   template<bool Debuggable> static inline void GARBAGE ( uint32_t addr, int8_t target );
+   template<bool Debuggable> static inline void EXTRA ();
+
+   // Hand the mapper a PPU address if it is one it watches.
+   static inline void SYNCMAPPER ( uint32_t addr )
+   {
+      if ( ((addr^m_state->m_mapperAddr)&m_state->m_mapperEdgeMask) ||
+           ((addr&m_state->m_mapperMatchMask) == m_state->m_mapperMatchValue) ||
+           m_state->m_mapperResync )
+      {
+         CNES::MAPPERFUNC()->sync_ppu(m_state->m_cycles,addr);
+         m_state->m_mapperResync = false;
+      }
+      m_state->m_mapperAddr = addr;
+   }
+
+   // Work out which addresses SYNCMAPPER passes on for the mapper
+   // selected by the most recent RESET.
+   static void MAPPERWATCH ( void );
+
+   // Run PPU cycles on scanlines that are not rendered, skipping ahead
+   // over the dots on which nothing happens.
+   template<bool Debuggable> static void EMULATEIDLE ( uint32_t cycles );
+
+   // Build the per-dot work tables.  Done once, they are shared by all machines.
+   static void BUILDDOTTABLES ( void );
+
+   // The dot work table for a scanline of the current video mode.
+   static inline const uint8_t* DOTACTIONS ( uint32_t scanline )
+   {
+      if ( scanline < SCANLINES_TOTAL_PAL )
+      {
+         return m_dotActions[m_state->m_pLineKinds[scanline]];
+      }
+      return m_dotActions[ePPULine_Idle];
+   }
+
+   // Work out the scanline and dot from the PPU cycle.
+   static inline void SYNCDOT ( void )
+   {
+      m_state->m_dot = m_state->m_cycles%PPU_CYCLES_PER_SCANLINE;
+      m_state->m_scanline = m_state->m_cycles/PPU_CYCLES_PER_SCANLINE;
+      m_state->m_pDotActions = DOTACTIONS ( m_state->m_scanline );
+   }
+
+   // Move the PPU cycle, scanline and dot along.
+   static inline void ADVANCEDOTS ( uint32_t dots )
+   {
+      m_state->m_cycles += dots;
+      m_state->m_dot += dots;
+      while ( m_state->m_dot >= PPU_CYCLES_PER_SCANLINE )
+      {
+         m_state->m_dot -= PPU_CYCLES_PER_SCANLINE;
+         m_state->m_scanline++;
+         m_state->m_pDotActions = DOTACTIONS ( m_state->m_scanline );
+      }
+   }
 
    // Routines that mimic the PPU bus behavior down to the PPU cycle.
    // These are used internally by the PPU core during emulation.
-   static inline void GATHERBKGND ( int8_t phase );
-   static inline void GATHERSPRITES ( int32_t scanline );
+   template<bool Debuggable> static inline void GATHERBKGND ( int8_t phase );
+   template<bool Debuggable> static inline void GATHERSPRITES ( int32_t scanline );
 
    // Routines that mimic the PPU OAM behavior down to the PPU cycle.
    // This is used internally by the PPU core during emulation.
-   static inline void BUILDSPRITELIST ( int32_t scanline, int32_t cycle );
+   template<bool Debuggable> static inline void BUILDSPRITELIST ( int32_t scanline, int32_t cycle );
+
+   // Routine that runs the sprite multiplexer for a whole scanline
+   // up front, leaving the frontmost opaque sprite pixel at each X.
+   template<bool Debuggable> static inline void BUILDSPRITELINE ( SpriteLineData* line );
+
+   // Routine that says whether sprite 0 is in the secondary OAM for this
+   // scanline and could still set the sprite 0 hit flag.
+   static inline bool SPRITE0PENDING ( void );
 
    // Routine that mimics the PPU's background barrel-shifters and
    // X-scroll pickoff.
    static inline void PIXELPIPELINES ( int32_t pickoff, uint8_t* a, uint8_t* b1, uint8_t* b2 );
 
+   // Routine that puts a pixel of the passed color, with the greyscale
+   // and color emphasis in PPUMASK applied, onto whichever rendering
+   // surfaces are set.
+   static inline void PIXEL ( int8_t* pTV, uint16_t* pTVIndexed, int32_t x, uint8_t color );
+   static inline void CONVERTPIXEL ( uint16_t pixel, int8_t* pTV );
+
+   // Tile-at-a-time versions of the above.  BKGNDSPAN picks off the next
+   // eight background color indexes without touching the shifters;
+   // SHIFTPIPELINES then moves the shifters on by however many of those
+   // pixels were used.
+   static void BUILDBKGNDSPANTABLE ( void );
+   static inline void BKGNDSPAN ( int32_t pickoff, uint8_t* span );
+   static inline void SHIFTPIPELINES ( int32_t pixels );
+
    // Routine that initializes the PPU's palette memory on reset.
    static void PALETTESET ( uint8_t* data )
    {
-      memcpy(m_PALETTEmemory,data,MEM_32B);
+      memcpy(m_state->m_PALETTEmemory,data,MEM_32B);
    }
 
 protected:
-   // The PPU core maintains 32B of palette RAM.
-   static uint8_t  m_PALETTEmemory [ MEM_32B ];
-
-   // The PPU core maintains 2KB of video RAM.
-   // Some mappers extend this by providing more memory on
-   // the cartridge.
-   static uint8_t*  m_PPUmemory;
-
-   // The PPU's video memory can be rearranged by some mappers.
-   // These pointers support that rearrangement.
-   static uint8_t* m_pPPUmemory [ 8 ];
-
-   // The PPU has an internal flip-flop which delivers
-   // bytes written to $2005 or $2006 to different locations
-   // within the PPU.  The flip-flop flips on each write to
-   // PPU address $2005, or $2007.  It is reset on reads from
-   // PPU address $2002.
-   static int32_t            m_ppuRegByte;
-
-   // Pre-calculated values based on video mode.
-   static uint32_t startVblank;
-   static uint32_t quietScanlines;
-   static uint32_t vblankScanlines;
-   static uint32_t vblankEndCycle;
-   static uint32_t prerenderScanline;
-   static uint32_t cycleRatio;
-   static uint32_t memoryDecayFrames;
-
-   // The PPU has an internal OAM address register that is
-   // accessed via PPU address $2003.  It is incremented on
-   // writes to $2004.
-   static uint8_t  m_oamAddr;
-
-   // The PPU has an internal address register that is used to
-   // generate the bus addresses accessed by the PPU during rendering.
-   // It is incremented on read/write of PPU address $2007.  It
-   // is updated from the PPU address latch (see below) on every
-   // other write to PPU address $2006 (ie. when the flip-flop is flipped
-   // in the right direction).
-   static uint16_t m_ppuAddr;
-
-   // The PPU has an internal address latch that is programmed
-   // via writes to PPU address $2000, $2005, $2006, and $2007.
-   // The latch is copied to the address register (see above)
-   // on every other write to PPU address $2006.
-   static uint16_t m_ppuAddrLatch;
-
-   // The PPU keeps track internally of whether it should be
-   // auto-incrementing its internal address register by 1
-   // (for horizontal updating) or by 32 (for vertical updating).
-   // This is set on writes to PPU address $2000.
-   static uint8_t  m_ppuAddrIncrement;
-
-   // The PPU has an internal latch that keeps the last value
-   // read by the PPU on an external memory fetch.  This provides
-   // a one-read-cycle delay between the PPU and CPU when the
-   // CPU requests data (via a read of PPU address $2007) from
-   // the PPU's visible memory space.  This latch is necessary so
-   // the CPU does not have to be held up while the PPU does the
-   // external memory fetch.  The latch does not apply to CPU
-   // accesses to PPU addresses in the range $3F00-$3FFF (the PPU's
-   // internal palette memory).  That data is returned immediately
-   // to the CPU on a read access of PPU address $2007 in that range.
-   static uint8_t  m_ppuReadLatch;
-
-   // The PPU has an internal hold-up on the bus between it and
-   // the CPU that causes the last value written to be readable
-   // for about 600 milliseconds.
-   static uint8_t m_ppuIOLatch;
-
-   // Each bit of the IO latch decays at the same rate but some
-   // might have been set to 1 more recently than others.
-   static uint8_t m_ppuIOLatchDecayFrames [ 8 ];
-
-   // The PPU has eight registers visible to the CPU in the CPU's
-   // memory map at address $2000 through $2007.  These are further
-   // mirrored throughout the CPU's memory map up to address $3FFF.
-   // The PPU keeps track internally of values written to the register
-   // ports so that the debugger inspectors can return actual data
-   // written to the registers instead of "open bus".  If the debugger
-   // inspectors want to, they can implement a mode where the inspector
-   // does infact reflect the actual state of the PPU as seen by the CPU.
-   // Typically, however, a user likes to see what has been written.
-   // I'll keep the "open bus" in mind though to provide accurate feedback
-   // as if the user were staring at an actual PPU.
-   static uint8_t  m_PPUreg [ NUM_PPU_REGS ];
-
-   // The PPU has space for 64 objects (sprites) in its internal
-   // Object Attribute Map (OAM) memory.
-   static uint8_t  m_PPUoam [ NUM_OAM_REGS ];
-
-   // The PPU maintains fine-X (0..7) scroll value which is used as the
-   // pick-off location in the barrel-shifter that does the rendering.
-   static uint8_t  m_ppuScrollX;
-
-   // The PPU maintains the state of mirroring of its internal video RAM.
-   // Some mappers only use one video screen's worth of RAM, others provide
-   // extra RAM for up to four independent video screens.  Most mappers use
-   // the two video screen's worth of RAM dedicated to the PPU in some
-   // mirrored fashion across the memory region which supports up to four
-   // video screen's worth.
-   static int32_t            m_oneScreen;
-   static bool           m_extraVRAM;
-
-   // Bounded counter of PPU cycles executed.  It resets to zero at the
-   // start of each PPU frame.
-   static uint32_t   m_cycles;
-
-   // Running counter of PPU frames drawn.  It will roll over after
-   // approximately 40 minutes of emulation.  However, this roll-over
-   // is not a significant event.
-   static uint32_t   m_frame;
-
-   // The current number of PPU cycles ready to be executed by
-   // the PPU core.
-   static int32_t            m_curCycles;
-
-   // If the CPU reads PPU address $2002 at a precise point within the
-   // PPU frame it can choke the setting of the VBLANK flag in that register.
-   static bool           m_vblankChoked;
-
-   // If the CPU reads PPU address $2002 at precise points within the
-   // PPU frame it can choke the assertion of NMI by the PPU.
-   static bool           m_nmiChoked;
-
-   // Re-enabling NMI flag in the PPU control register allows for re-assertion
-   // of NMI during VBLANK period.
-   static bool           m_nmiReenabled;
-
-   // This is the temporary memory used by the PPU to store gathered
-   // OAM data during pixel rendering.
-   static SpriteTemporaryMemory m_spriteTemporaryMemory;
-
-   // This is the secondary OAM that is used to keep track of in-view
-   // sprites on each scanline.
-   static SpriteBuffer     m_spriteBuffer;
-
-   // This is the background buffer of fetched tile data to be
-   // rendered on the next scanline.
-   static BackgroundBuffer m_bkgndBuffer;
-
-   // This is the rendering surface on which the PPU draws the
-   // emulated frame representing the true visual state of the
-   // NES as would be seen by a player.  The memory is allocated
-   // by the dialog class and passed to the PPU.
-   static int8_t*          m_pTV;
-
-   // These items are the database that keeps track of the status of the
-   // x and y scroll values for each rendered pixel.  This information is
-   // used by the nametable visualizer to highlight areas of the nametable
-   // memory internal to the PPU that are being rendered to the screen.
-   static uint8_t  m_last2005x;
-   static uint8_t  m_last2005y;
-   static uint16_t** m_2005x;
-   static uint16_t** m_2005y;
-
-   // These items are the position of the last sprite-0 hit event on the
-   // last rendered PPU frame.  They are invalidated at the start of each
-   // new frame.
-   static uint8_t  m_lastSprite0HitX;
-   static uint8_t  m_lastSprite0HitY;
-
-   // These items are the position of the pixel being rendered by the
-   // PPU on any given PPU cycle.  This information is used by the debugger.
-   static uint8_t  m_x;
-   static uint8_t  m_y;
-
-   // Database used by the Code/Data Logger debugger inspector.  The data structure
-   // is maintained by the PPU core as it performs fetches, reads,
-   // and writes to/from its managed RAM.  The
-   // Code/Data Logger displays the collected information graphically.
-   static CCodeDataLogger* m_logger;
+   // Work due on each dot of each kind of scanline, and the kind of
+   // each scanline for NTSC, PAL and Dendy.
+   static uint8_t m_dotActions [ ePPULine_Count ][ PPU_CYCLES_PER_SCANLINE ];
+   static uint8_t m_lineKinds [ 3 ][ SCANLINES_TOTAL_PAL ];
+
+   // A bitplane byte spread out to one bit per pixel, leftmost pixel first.
+   static uint64_t m_bkgndSpread [ 256 ];
+
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      // The PPU core maintains 32B of palette RAM.
+      uint8_t m_PALETTEmemory [ MEM_32B ] = { 0, };
+
+      // The PPU core maintains 2KB of video RAM.
+      // Some mappers extend this by providing more memory on
+      // the cartridge.
+      uint8_t* m_PPUmemory = NULL;
+
+      // The PPU's video memory can be rearranged by some mappers.
+      // These pointers support that rearrangement.
+      uint8_t* m_pPPUmemory [ 8 ] = { NULL, };
+
+      // The PPU has an internal flip-flop which delivers
+      // bytes written to $2005 or $2006 to different locations
+      // within the PPU.  The flip-flop flips on each write to
+      // PPU address $2005, or $2007.  It is reset on reads from
+      // PPU address $2002.
+      int32_t m_ppuRegByte = 0;
+
+      // Pre-calculated values based on video mode.
+      uint32_t startVblank;
+      uint32_t quietScanlines;
+      uint32_t vblankScanlines;
+      uint32_t vblankEndCycle;
+      uint32_t prerenderScanline;
+      uint32_t cycleRatio;
+      uint32_t memoryDecayFrames;
+
+      // The PPU has an internal OAM address register that is
+      // accessed via PPU address $2003.  It is incremented on
+      // writes to $2004.
+      uint8_t m_oamAddr = 0x00;
+
+      // The PPU has an internal address register that is used to
+      // generate the bus addresses accessed by the PPU during rendering.
+      // It is incremented on read/write of PPU address $2007.  It
+      // is updated from the PPU address latch (see below) on every
+      // other write to PPU address $2006 (ie. when the flip-flop is flipped
+      // in the right direction).
+      uint16_t m_ppuAddr = 0x0000;
+
+      // The PPU has an internal address latch that is programmed
+      // via writes to PPU address $2000, $2005, $2006, and $2007.
+      // The latch is copied to the address register (see above)
+      // on every other write to PPU address $2006.
+      uint16_t m_ppuAddrLatch = 0x0000;
+
+      // The last address the PPU put on its bus, and which addresses
+      // the mapper wants to see (see SYNCMAPPER).  After a reset or a
+      // save-state load the next address is passed on whatever it is,
+      // so the mapper's idea of the last address is in step again.
+      uint32_t m_mapperAddr = 0x0000;
+      uint32_t m_mapperEdgeMask = 0;
+      uint32_t m_mapperMatchMask = 0;
+      uint32_t m_mapperMatchValue = 0;
+      bool m_mapperResync = true;
+
+      // The PPU keeps track internally of whether it should be
+      // auto-incrementing its internal address register by 1
+      // (for horizontal updating) or by 32 (for vertical updating).
+      // This is set on writes to PPU address $2000.
+      uint8_t m_ppuAddrIncrement = 1;
+
+      // The PPU has an internal latch that keeps the last value
+      // read by the PPU on an external memory fetch.  This provides
+      // a one-read-cycle delay between the PPU and CPU when the
+      // CPU requests data (via a read of PPU address $2007) from
+      // the PPU's visible memory space.  This latch is necessary so
+      // the CPU does not have to be held up while the PPU does the
+      // external memory fetch.  The latch does not apply to CPU
+      // accesses to PPU addresses in the range $3F00-$3FFF (the PPU's
+      // internal palette memory).  That data is returned immediately
+      // to the CPU on a read access of PPU address $2007 in that range.
+      uint8_t m_ppuReadLatch = 0x00;
+
+      // The PPU has an internal hold-up on the bus between it and
+      // the CPU that causes the last value written to be readable
+      // for about 600 milliseconds.
+      uint8_t m_ppuIOLatch = 0x00;
+
+      // Each bit of the IO latch decays at the same rate but some
+      // might have been set to 1 more recently than others.
+      uint8_t m_ppuIOLatchDecayFrames [ 8 ] = { 0, };
+
+      // The PPU has eight registers visible to the CPU in the CPU's
+      // memory map at address $2000 through $2007.  These are further
+      // mirrored throughout the CPU's memory map up to address $3FFF.
+      // The PPU keeps track internally of values written to the register
+      // ports so that the debugger inspectors can return actual data
+      // written to the registers instead of "open bus".  If the debugger
+      // inspectors want to, they can implement a mode where the inspector
+      // does infact reflect the actual state of the PPU as seen by the CPU.
+      // Typically, however, a user likes to see what has been written.
+      // I'll keep the "open bus" in mind though to provide accurate feedback
+      // as if the user were staring at an actual PPU.
+      uint8_t m_PPUreg [ NUM_PPU_REGS ] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+      // The PPU has space for 64 objects (sprites) in its internal
+      // Object Attribute Map (OAM) memory.
+      uint8_t m_PPUoam [ NUM_OAM_REGS ] = { 0x00, };
+
+      // The PPU maintains fine-X (0..7) scroll value which is used as the
+      // pick-off location in the barrel-shifter that does the rendering.
+      uint8_t m_ppuScrollX = 0x00;
+
+      // The PPU maintains the state of mirroring of its internal video RAM.
+      // Some mappers only use one video screen's worth of RAM, others provide
+      // extra RAM for up to four independent video screens.  Most mappers use
+      // the two video screen's worth of RAM dedicated to the PPU in some
+      // mirrored fashion across the memory region which supports up to four
+      // video screen's worth.
+      int32_t m_oneScreen = -1;
+      bool m_extraVRAM = false;
+
+      // Bounded counter of PPU cycles executed.  It resets to zero at the
+      // start of each PPU frame.
+      uint32_t m_cycles = 0;
+
+      // The same position as scanline and dot, kept alongside the cycle
+      // counter, and the work table for the scanline.  These are derived
+      // from the cycle counter and are not part of a save-state.
+      uint32_t m_dot = 0;
+      uint32_t m_scanline = 0;
+      const uint8_t* m_pDotActions = m_dotActions[ePPULine_Visible];
+
+      // Kind of each scanline in the frame, for the video mode.
+      const uint8_t* m_pLineKinds = m_lineKinds[MODE_NTSC];
+
+      // Running counter of PPU frames drawn.  It will roll over after
+      // approximately 40 minutes of emulation.  However, this roll-over
+      // is not a significant event.
+      uint32_t m_frame = 0;
+
+      // The current number of PPU cycles ready to be executed by
+      // the PPU core.
+      int32_t m_curCycles = 0;
+
+      // How many dots, starting at m_cycles, the CPU has been handed its
+      // cycles for.  More than one only while EMULATEIDLE runs a stretch.
+      uint32_t m_cpuDots = 1;
+
+      // If the CPU reads PPU address $2002 at a precise point within the
+      // PPU frame it can choke the setting of the VBLANK flag in that register.
+      bool m_vblankChoked = false;
+
+      // If the CPU reads PPU address $2002 at precise points within the
+      // PPU frame it can choke the assertion of NMI by the PPU.
+      bool m_nmiChoked = false;
+
+      // Re-enabling NMI flag in the PPU control register allows for re-assertion
+      // of NMI during VBLANK period.
+      bool m_nmiReenabled = false;
+
+      // This is the temporary memory used by the PPU to store gathered
+      // OAM data during pixel rendering.
+      SpriteTemporaryMemory m_spriteTemporaryMemory;
+
+      // This is the secondary OAM that is used to keep track of in-view
+      // sprites on each scanline.
+      SpriteBuffer m_spriteBuffer;
+
+      // This is the background buffer of fetched tile data to be
+      // rendered on the next scanline.
+      BackgroundBuffer m_bkgndBuffer;
+
+      // This is the rendering surface on which the PPU draws the
+      // emulated frame representing the true visual state of the
+      // NES as would be seen by a player.  The memory is allocated
+      // by the dialog class and passed to the PPU.
+      int8_t* m_pTV = NULL;
+
+      // Optional palette-index rendering surface (see nesSetTVOutIndexed).
+      // Either surface, or both, may be set.
+      uint16_t* m_pTVIndexed = NULL;
+
+      // These items are the database that keeps track of the status of the
+      // x and y scroll values for each rendered pixel.  This information is
+      // used by the nametable visualizer to highlight areas of the nametable
+      // memory internal to the PPU that are being rendered to the screen.
+      uint8_t m_last2005x = 0;
+      uint8_t m_last2005y = 0;
+      uint16_t** m_2005x = NULL;
+      uint16_t** m_2005y = NULL;
+
+      // These items are the position of the last sprite-0 hit event on the
+      // last rendered PPU frame.  They are invalidated at the start of each
+      // new frame.
+      uint8_t m_lastSprite0HitX = 0;
+      uint8_t m_lastSprite0HitY = 0;
+
+      // These items are the position of the pixel being rendered by the
+      // PPU on any given PPU cycle.  This information is used by the debugger.
+      uint8_t m_x = 0xFF;
+      uint8_t m_y = 0xFF;
+
+      // Database used by the Code/Data Logger debugger inspector.  The data structure
+      // is maintained by the PPU core as it performs fetches, reads,
+      // and writes to/from its managed RAM.  The
+      // Code/Data Logger displays the collected information graphically.
+      CCodeDataLogger* m_logger = NULL;
+
+      // Background fetch pipeline state carried between cycles.
+      uint16_t m_patternIdx = 0;
+      BackgroundBufferData m_bkgndTemp;
+
+      // Sprite evaluation state carried between cycles.
+      SpriteTemporaryMemoryData  m_spriteDevNull;
+      SpriteTemporaryMemoryData* m_pSprite = &m_spriteDevNull;
+      int32_t                    m_spritesFound = 0;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 
    // The database for PPU core registers.  Declaration
    // is in source file.
@@ -0,0 +1,445 @@
+//    NESICIDE - an IDE for the 8-bit NES.
+//    Copyright (C) 2009  Christopher S. Pow
+
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "cnesrewind.h"
+#include "cnesmachine.h"
+
+#include <string.h>
+
+// A literal run of changed bytes only ends once at least this many
+// unchanged bytes follow it; shorter gaps cost more to encode as a
+// skip than to carry along.
+#define REWIND_MIN_SKIP 4
+
+// Encoded frame: a sequence of
+//    varint skip     (unchanged bytes)
+//    varint length   (changed bytes)
+//    uint8_t xor [ length ]
+// with any trailing unchanged bytes left implicit.
+static inline uint8_t* putVarint ( uint8_t* out, uint32_t value )
+{
+   while ( value >= 0x80 )
+   {
+      *out++ = (value&0x7F)|0x80;
+      value >>= 7;
+   }
+   *out++ = value;
+   return out;
+}
+
+static inline const uint8_t* getVarint ( const uint8_t* in, const uint8_t* end, uint32_t* value )
+{
+   uint32_t shift = 0;
+
+   (*value) = 0;
+   while ( (in < end) && (shift < 32) )
+   {
+      (*value) |= ((*in)&0x7F)<<shift;
+      if ( !((*in++)&0x80) )
+      {
+         return in;
+      }
+      shift += 7;
+   }
+   return NULL;
+}
+
+static uint32_t encodeFrame ( const uint8_t* state, const uint8_t* reference, uint32_t size, uint8_t* out )
+{
+   uint8_t* start = out;
+   uint32_t pos = 0;
+   uint32_t skip;
+   uint32_t literal;
+   uint32_t run;
+   uint64_t a;
+   uint64_t b;
+
+   while ( pos < size )
+   {
+      skip = pos;
+      while ( pos+8 <= size )
+      {
+         memcpy(&a,state+pos,8);
+         memcpy(&b,reference+pos,8);
+         if ( a != b )
+         {
+            break;
+         }
+         pos += 8;
+      }
+      while ( (pos < size) && (state[pos] == reference[pos]) )
+      {
+         pos++;
+      }
+      if ( pos == size )
+      {
+         break;
+      }
+      skip = pos-skip;
+
+      literal = pos;
+      while ( pos < size )
+      {
+         if ( state[pos] != reference[pos] )
+         {
+            pos++;
+            continue;
+         }
+         for ( run = 1; (run < REWIND_MIN_SKIP) && (pos+run < size) && (state[pos+run] == reference[pos+run]); run++ );
+         if ( (run == REWIND_MIN_SKIP) || (pos+run == size) )
+         {
+            break;
+         }
+         pos += run;
+      }
+
+      out = putVarint(out,skip);
+      out = putVarint(out,pos-literal);
+      for ( ; literal < pos; literal++ )
+      {
+         *out++ = state[literal]^reference[literal];
+      }
+   }
+
+   return out-start;
+}
+
+static bool applyFrame ( const uint8_t* in, uint32_t length, uint8_t* state, uint32_t size )
+{
+   const uint8_t* end = in+length;
+   uint32_t pos = 0;
+   uint32_t skip;
+   uint32_t literal;
+
+   while ( in < end )
+   {
+      in = getVarint(in,end,&skip);
+      if ( in )
+      {
+         in = getVarint(in,end,&literal);
+      }
+      if ( (!in) ||
+           (skip > size-pos) || (literal > size-pos-skip) || (literal > (uint32_t)(end-in)) )
+      {
+         return false;
+      }
+      pos += skip;
+      for ( ; literal; literal-- )
+      {
+         state[pos++] ^= *in++;
+      }
+   }
+   return true;
+}
+
+CNESRewind::CNESRewind()
+   : m_maxFrames(REWIND_DEFAULT_FRAMES),
+     m_bufferSize(REWIND_DEFAULT_BUFFER_SIZE),
+     m_keyframeInterval(REWIND_DEFAULT_KEYFRAME_INTERVAL),
+     m_pBuffer(NULL),
+     m_write(0),
+     m_used(0),
+     m_pEntries(NULL),
+     m_first(0),
+     m_count(0),
+     m_stateSize(0),
+     m_pState(NULL),
+     m_pKeyframe(NULL),
+     m_pZero(NULL),
+     m_pEncoded(NULL),
+     m_keyValid(false)
+{
+}
+
+CNESRewind::~CNESRewind()
+{
+   Free();
+}
+
+void CNESRewind::SetEnabled ( bool enabled )
+{
+   if ( enabled && !IsEnabled() )
+   {
+      Allocate();
+   }
+   else if ( !enabled && IsEnabled() )
+   {
+      Free();
+   }
+}
+
+void CNESRewind::Configure ( uint32_t frames, uint32_t bufferSize, uint32_t keyframeInterval )
+{
+   bool enabled = IsEnabled();
+
+   Free();
+
+   m_maxFrames = frames?frames:1;
+   m_bufferSize = bufferSize;
+   m_keyframeInterval = keyframeInterval?keyframeInterval:1;
+
+   if ( enabled )
+   {
+      Allocate();
+   }
+}
+
+void CNESRewind::Clear ( void )
+{
+   m_write = 0;
+   m_used = 0;
+   m_first = 0;
+   m_count = 0;
+   m_keyValid = false;
+}
+
+void CNESRewind::Allocate ( void )
+{
+   m_pBuffer = new uint8_t [ m_bufferSize ];
+   m_pEntries = new Entry [ m_maxFrames ];
+   Clear();
+}
+
+void CNESRewind::Free ( void )
+{
+   delete [] m_pBuffer;
+   delete [] m_pEntries;
+   delete [] m_pState;
+   delete [] m_pKeyframe;
+   delete [] m_pZero;
+   delete [] m_pEncoded;
+   m_pBuffer = NULL;
+   m_pEntries = NULL;
+   m_pState = NULL;
+   m_pKeyframe = NULL;
+   m_pZero = NULL;
+   m_pEncoded = NULL;
+   m_stateSize = 0;
+   Clear();
+}
+
+bool CNESRewind::ResizeState ( uint32_t stateSize )
+{
+   delete [] m_pState;
+   delete [] m_pKeyframe;
+   delete [] m_pZero;
+   delete [] m_pEncoded;
+   m_pState = NULL;
+   m_pKeyframe = NULL;
+   m_pZero = NULL;
+   m_pEncoded = NULL;
+
+   // Frames of a different size belong to a different cartridge.
+   Clear();
+
+   m_stateSize = stateSize;
+   if ( !m_stateSize )
+   {
+      return false;
+   }
+
+   m_pState = new uint8_t [ m_stateSize ];
+   m_pKeyframe = new uint8_t [ m_stateSize ];
+   m_pZero = new uint8_t [ m_stateSize ];
+   memset(m_pZero,0,m_stateSize);
+
+   // Worst case is one skip/length pair per REWIND_MIN_SKIP bytes.
+   m_pEncoded = new uint8_t [ (m_stateSize*4)+16 ];
+
+   return true;
+}
+
+void CNESRewind::DropOldest ( void )
+{
+   // Deltas cannot outlive the keyframe they were taken against, so the
+   // whole keyframe group goes.
+   do
+   {
+      m_used -= m_pEntries[m_first].length;
+      m_first = (m_first+1)%m_maxFrames;
+      m_count--;
+   } while ( m_count && !m_pEntries[m_first].keyframe );
+}
+
+uint32_t CNESRewind::NewestKeyframe ( void ) const
+{
+   uint32_t slot = (m_first+m_count-1)%m_maxFrames;
+
+   while ( !m_pEntries[slot].keyframe )
+   {
+      slot = (slot+m_maxFrames-1)%m_maxFrames;
+   }
+   return slot;
+}
+
+void CNESRewind::Store ( uint32_t length, bool keyframe, const uint32_t* joypads )
+{
+   Entry* pEntry;
+
+   if ( length > m_bufferSize )
+   {
+      Clear();
+      return;
+   }
+
+   if ( !m_count )
+   {
+      m_write = 0;
+   }
+   if ( m_write+length > m_bufferSize )
+   {
+      // Anything still past the write position is older than anything
+      // at the start of the buffer.
+      while ( m_count && (m_pEntries[m_first].offset >= m_write) )
+      {
+         DropOldest();
+      }
+      m_write = 0;
+   }
+   while ( m_count &&
+           (m_pEntries[m_first].offset < m_write+length) &&
+           (m_write < m_pEntries[m_first].offset+m_pEntries[m_first].length) )
+   {
+      DropOldest();
+   }
+
+   if ( !keyframe && !m_count )
+   {
+      // Made room by dropping this delta's own keyframe.
+      m_keyValid = false;
+      return;
+   }
+
+   pEntry = m_pEntries+((m_first+m_count)%m_maxFrames);
+   pEntry->offset = m_write;
+   pEntry->length = length;
+   pEntry->joypads[0] = joypads?joypads[0]:0;
+   pEntry->joypads[1] = joypads?joypads[1]:0;
+   pEntry->keyframe = keyframe;
+   memcpy(m_pBuffer+m_write,m_pEncoded,length);
+
+   m_write += length;
+   m_used += length;
+   m_count++;
+}
+
+void CNESRewind::Decode ( const Entry& entry, uint8_t* state )
+{
+   if ( entry.keyframe )
+   {
+      memset(state,0,m_stateSize);
+   }
+   else
+   {
+      memcpy(state,m_pKeyframe,m_stateSize);
+   }
+   applyFrame(m_pBuffer+entry.offset,entry.length,state,m_stateSize);
+}
+
+void CNESRewind::Capture ( NesMachine* machine, const uint32_t* joypads )
+{
+   uint32_t size;
+   uint32_t length;
+   uint32_t distance;
+   uint8_t* swap;
+   bool     keyframe;
+
+   if ( !IsEnabled() )
+   {
+      return;
+   }
+
+   size = machine->SAVESTATE(m_pState,m_stateSize);
+   if ( (!size) || (size != m_stateSize) )
+   {
+      if ( !ResizeState(machine->SAVESTATE(NULL,0)) )
+      {
+         return;
+      }
+      size = machine->SAVESTATE(m_pState,m_stateSize);
+      if ( !size )
+      {
+         return;
+      }
+   }
+
+   if ( m_count == m_maxFrames )
+   {
+      DropOldest();
+   }
+
+   keyframe = (!m_count) || (!m_keyValid);
+   if ( !keyframe )
+   {
+      distance = ((m_first+m_count)+m_maxFrames-NewestKeyframe())%m_maxFrames;
+      keyframe = (distance >= m_keyframeInterval);
+   }
+
+   if ( keyframe )
+   {
+      length = encodeFrame(m_pState,m_pZero,m_stateSize,m_pEncoded);
+
+      // This frame is the reference for the deltas that follow.
+      swap = m_pKeyframe;
+      m_pKeyframe = m_pState;
+      m_pState = swap;
+      m_keyValid = true;
+   }
+   else
+   {
+      length = encodeFrame(m_pState,m_pKeyframe,m_stateSize,m_pEncoded);
+   }
+
+   Store(length,keyframe,joypads);
+}
+
+bool CNESRewind::StepBack ( NesMachine* machine, uint32_t* joypads )
+{
+   Entry entry;
+   bool ok;
+
+   if ( !IsEnabled() || !m_count )
+   {
+      return false;
+   }
+
+   entry = m_pEntries[(m_first+m_count-1)%m_maxFrames];
+
+   if ( !entry.keyframe && !m_keyValid )
+   {
+      Decode(m_pEntries[NewestKeyframe()],m_pKeyframe);
+      m_keyValid = true;
+   }
+   Decode(entry,m_pState);
+
+   ok = machine->LOADSTATE(m_pState,m_stateSize);
+
+   if ( joypads )
+   {
+      joypads[0] = entry.joypads[0];
+      joypads[1] = entry.joypads[1];
+   }
+
+   m_count--;
+   m_used -= entry.length;
+   m_write = entry.offset;
+   if ( entry.keyframe )
+   {
+      m_keyValid = false;
+   }
+
+   return ok;
+}
@@ -0,0 +1,104 @@
+#if !defined ( NES_REWIND_H )
+#define NES_REWIND_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct NesMachine;
+
+#define REWIND_DEFAULT_FRAMES            3600
+#define REWIND_DEFAULT_BUFFER_SIZE       (8*1024*1024)
+#define REWIND_DEFAULT_KEYFRAME_INTERVAL 60
+
+// Rewind history of one NesMachine.
+//
+// Every captured frame is a binary save-state (see cnesstate.h).  Every
+// so many frames the save-state is stored as a keyframe; the frames in
+// between are stored as the XOR of their save-state against that keyframe,
+// run-length encoded so the unchanged bytes (most of them) cost next to
+// nothing.  Keyframes use the same encoding against an all-zero state,
+// which packs the unused parts of SRAM, CHR-RAM and so on.
+//
+// Frames are kept in a ring of fixed size: once the buffer or the frame
+// limit is reached the oldest keyframe and the frames depending on it are
+// dropped.  Stepping back restores the newest frame and removes it from
+// the ring.  That costs one delta application, plus one keyframe decode
+// whenever a keyframe boundary is crossed.
+class CNESRewind
+{
+public:
+   CNESRewind();
+   ~CNESRewind();
+
+   // Enabling allocates the buffers, disabling frees them.
+   void SetEnabled ( bool enabled );
+   bool IsEnabled ( void ) const
+   {
+      return m_pBuffer != NULL;
+   }
+
+   // Change the ring limits.  Discards the history.
+   void Configure ( uint32_t frames, uint32_t bufferSize, uint32_t keyframeInterval );
+   void Clear ( void );
+
+   // Record the machine's state, and the joypads about to be applied to
+   // the frame that is run from it.
+   void Capture ( NesMachine* machine, const uint32_t* joypads );
+
+   // Restore the newest recorded frame and drop it from the history.  The
+   // joypads recorded with it are returned so the caller can re-run the
+   // frame exactly as it was.
+   bool StepBack ( NesMachine* machine, uint32_t* joypads );
+
+   uint32_t GetNumFrames ( void ) const
+   {
+      return m_count;
+   }
+   uint32_t GetMemoryUsed ( void ) const
+   {
+      return m_used;
+   }
+
+protected:
+   struct Entry
+   {
+      uint32_t offset;
+      uint32_t length;
+      uint32_t joypads [ 2 ];
+      bool     keyframe;
+   };
+
+   void Allocate ( void );
+   void Free ( void );
+   bool ResizeState ( uint32_t stateSize );
+   void Store ( uint32_t length, bool keyframe, const uint32_t* joypads );
+   void DropOldest ( void );
+   uint32_t NewestKeyframe ( void ) const;
+   void Decode ( const Entry& entry, uint8_t* state );
+
+   uint32_t m_maxFrames;
+   uint32_t m_bufferSize;
+   uint32_t m_keyframeInterval;
+
+   // Encoded frames.
+   uint8_t* m_pBuffer;
+   uint32_t m_write;
+   uint32_t m_used;
+
+   // Frame descriptors, oldest at m_first.
+   Entry*   m_pEntries;
+   uint32_t m_first;
+   uint32_t m_count;
+
+   // Raw save-states: the frame being captured or restored, the newest
+   // keyframe (valid only if m_keyValid), all-zero reference for keyframe
+   // encoding, and room for one encoded frame.
+   uint32_t m_stateSize;
+   uint8_t* m_pState;
+   uint8_t* m_pKeyframe;
+   uint8_t* m_pZero;
+   uint8_t* m_pEncoded;
+   bool     m_keyValid;
+};
+
+#endif // #if !defined ( NES_REWIND_H )
@@ -31,8 +31,6 @@ static CBreakpointEventInfo* tblMapperEvents [] =
    new CBreakpointEventInfo("IRQ", mapperIRQEvent, 0, "Break if mapper asserts IRQ", 10),
 };
 
-CRegisterDatabase*  CROM::m_dbRegisters = NULL;
-
 static CMemoryDatabase* dbSRAMMemory = new CMemoryDatabase(eMemory_cartSRAM,
                                                            SRAM_START,
                                                            MEM_8KB,
@@ -106,243 +104,544 @@ CMemoryDatabase* CROM::m_dbCHRMemory = dbCHRMemory;
 CBreakpointEventInfo** CROM::m_tblBreakpointEvents = tblMapperEvents;
 int32_t                CROM::m_numBreakpointEvents = NUM_MAPPER_EVENTS;
 
-uint8_t** CROM::m_PRGROMmemory = NULL;
-uint8_t** CROM::m_CHRmemory = NULL;
-uint8_t*  CROM::m_VRAMmemory = NULL;
-uint8_t*  CROM::m_pPRGROMmemory [] = { NULL, NULL, NULL, NULL };
-uint8_t*  CROM::m_pCHRmemory [] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
-uint8_t*  CROM::m_pVRAMmemory [] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
-uint8_t** CROM::m_SRAMmemory = NULL;
-uint8_t*  CROM::m_pSRAMmemory [] = { NULL, NULL, NULL, NULL, NULL };
-uint8_t*  CROM::m_EXRAMmemory = NULL;
-
-uint32_t           CROM::m_mapper = 0;
-uint32_t           CROM::m_numPrgBanks = 0;
-uint32_t           CROM::m_numChrBanks = 0;
-
-CCodeDataLogger* CROM::m_pLogger [] = { NULL, };
-CCodeDataLogger* CROM::m_pEXRAMLogger = NULL;
-CCodeDataLogger* CROM::m_pSRAMLogger [] = { NULL, };
-
-uint8_t**  CROM::m_PRGROMopcodeMask = NULL;
-bool*      CROM::m_PRGROMopcodeMaskDirty  = NULL;
-char***    CROM::m_PRGROMdisassembly = NULL;
-uint16_t** CROM::m_PRGROMsloc2addr = NULL;
-uint16_t** CROM::m_PRGROMaddr2sloc = NULL;
-uint32_t*  CROM::m_PRGROMsloc = NULL;
-uint8_t**  CROM::m_SRAMopcodeMask = NULL;
-bool*      CROM::m_SRAMopcodeMaskDirty = NULL;
-char***    CROM::m_SRAMdisassembly = NULL;
-uint16_t** CROM::m_SRAMsloc2addr = NULL;
-uint16_t** CROM::m_SRAMaddr2sloc = NULL;
-uint32_t*  CROM::m_SRAMsloc = NULL;
-bool       CROM::m_SRAMdirty = false;
-uint8_t*   CROM::m_EXRAMopcodeMask = NULL;
-bool       CROM::m_EXRAMopcodeMaskDirty = false;
-char**     CROM::m_EXRAMdisassembly = NULL;
-uint16_t*  CROM::m_EXRAMsloc2addr = NULL;
-uint16_t*  CROM::m_EXRAMaddr2sloc = NULL;
-uint32_t   CROM::m_EXRAMsloc = 0;
+CROM::State CROM::m_defaultState;
+thread_local CROM::State* CROM::m_state = &CROM::m_defaultState;
 
 static CROM __init __attribute__((unused));
 
 CROM::CROM()
+{
+   CREATE();
+}
+
+CROM::~CROM()
+{
+   DESTROY();
+}
+
+// CHR-RAM occupies the bottom of CHR memory on cartridges without CHR-ROM.
+// The banks above the largest CHR-ROM are the CHR-RAM of cartridges with
+// both (N106); they only exist once such a mapper asks for them.
+#define CHRRAM_STATE_BANKS 32
+#define CHRRAM_STATE_EXTRA_BANK 256
+
+// Mappers index the PRG-ROM table straight from their 8-bit bank
+// registers, some shifted left for 16KB banks, so it has this many
+// entries rather than NUM_ROM_BANKS.
+#define PRGROM_STATE_ALIASES 512
+
+void CROM::CREATE ( void )
 {
    int32_t bank;
    int32_t addr;
 
-   m_PRGROMmemory = new uint8_t*[NUM_ROM_BANKS];
-   m_PRGROMdisassembly = new char**[NUM_ROM_BANKS];
-   m_PRGROMopcodeMaskDirty = new bool[NUM_ROM_BANKS];
-   m_PRGROMopcodeMask = new uint8_t*[NUM_ROM_BANKS];
-   m_PRGROMsloc2addr = new uint16_t*[NUM_ROM_BANKS];
-   m_PRGROMaddr2sloc = new uint16_t*[NUM_ROM_BANKS];
-   m_PRGROMsloc = new uint32_t[NUM_ROM_BANKS];
-   for ( bank = 0; bank < NUM_ROM_BANKS; bank++ )
+   // Only the bank tables are full-size.  Until a cartridge is loaded
+   // there is one PRG-ROM bank and CHR-RAM's worth of CHR banks behind
+   // them; nesLoadROM's SetPRGBank and SetCHRBank grow them to fit.
+   m_state->m_PRGROMmemory = new uint8_t*[PRGROM_STATE_ALIASES];
+   m_state->m_PRGROMdisassembly = new DisassemblyInfo*[NUM_ROM_BANKS];
+   m_state->m_PRGROMdisassemblyState = new DisassemblyState[NUM_ROM_BANKS];
+   m_state->m_PRGROMopcodeMask = new uint8_t*[NUM_ROM_BANKS];
+   m_state->m_PRGROMsloc2addr = new uint16_t*[NUM_ROM_BANKS];
+   m_state->m_PRGROMaddr2sloc = new uint16_t*[NUM_ROM_BANKS];
+   m_state->m_PRGROMsloc = new uint32_t[NUM_ROM_BANKS];
+   m_state->m_numPrgBanksAllocated = 0;
+   ALLOCATEPRGBANKS ( 1 );
+
+   m_state->m_SRAMmemory = new uint8_t*[NUM_SRAM_BANKS];
+   m_state->m_SRAMdisassembly = new DisassemblyInfo*[NUM_SRAM_BANKS];
+   m_state->m_SRAMdisassemblyState = new DisassemblyState[NUM_SRAM_BANKS];
+   m_state->m_SRAMopcodeMask = new uint8_t*[NUM_SRAM_BANKS];
+   m_state->m_SRAMsloc2addr = new uint16_t*[NUM_SRAM_BANKS];
+   m_state->m_SRAMaddr2sloc = new uint16_t*[NUM_SRAM_BANKS];
+   m_state->m_SRAMsloc = new uint32_t[NUM_SRAM_BANKS];
+   for ( bank = 0; bank < NUM_SRAM_BANKS; bank++ )
    {
-      m_PRGROMmemory[bank] = new uint8_t[MEM_8KB+1]; // Leave room for bank ID.
-      m_PRGROMdisassembly[bank] = new char*[MEM_8KB];
-      m_PRGROMopcodeMaskDirty[bank] = true;
-      m_PRGROMopcodeMask[bank] = new uint8_t[MEM_8KB];
-      m_PRGROMsloc2addr[bank] = new uint16_t[MEM_8KB];
-      m_PRGROMaddr2sloc[bank] = new uint16_t[MEM_8KB];
-      m_PRGROMsloc[bank] = 0;
-      m_pLogger [ bank ] = new CCodeDataLogger ( MEM_8KB, MASK_8KB );
-
-      for ( addr = 0; addr < MEM_8KB; addr++ )
-      {
-         m_PRGROMdisassembly[bank][addr] = new char [ 16 ];
-         m_PRGROMopcodeMask[bank][addr] = 0;
-         m_PRGROMsloc2addr[bank][addr] = 0;
-         m_PRGROMaddr2sloc[bank][addr] = 0;
-      }
+      m_state->m_SRAMmemory[bank] = new uint8_t[MEM_8KB+1]; // Leave room for bank ID.
+      m_state->m_SRAMdisassembly[bank] = new DisassemblyInfo[MEM_8KB];
+      C6502::DISASSEMBLYRESET ( m_state->m_SRAMdisassemblyState+bank, MEM_8KB );
+      m_state->m_SRAMopcodeMask[bank] = new uint8_t[MEM_8KB];
+      m_state->m_SRAMsloc2addr[bank] = new uint16_t[MEM_8KB];
+      m_state->m_SRAMaddr2sloc[bank] = new uint16_t[MEM_8KB];
+      m_state->m_SRAMsloc[bank] = 0;
+      m_state->m_pSRAMLogger [ bank ] = new CCodeDataLogger ( MEM_8KB, MASK_8KB );
+
+      memset ( m_state->m_SRAMmemory[bank], 0, MEM_8KB );
+      memset ( m_state->m_SRAMdisassembly[bank], 0, MEM_8KB*sizeof(DisassemblyInfo) );
+      memset ( m_state->m_SRAMopcodeMask[bank], 0, MEM_8KB );
+      memset ( m_state->m_SRAMsloc2addr[bank], 0, MEM_8KB*sizeof(uint16_t) );
+      memset ( m_state->m_SRAMaddr2sloc[bank], 0, MEM_8KB*sizeof(uint16_t) );
 
       // Store bank ID in bank data at the end.  This is used only
       // by code that needs to calculate absolute address stuff.
       // Since the banks are stored non-contiguously this is a cheap
       // way to get the bank ID without having to implement a structure.
-      m_PRGROMmemory[bank][MEM_8KB] = bank;
+      m_state->m_SRAMmemory[bank][MEM_8KB] = bank;
+   }
+
+   m_state->m_EXRAMmemory = new uint8_t[MEM_1KB];
+   m_state->m_EXRAMdisassembly = new DisassemblyInfo[MEM_1KB];
+   m_state->m_EXRAMopcodeMask = new uint8_t[MEM_1KB];
+   m_state->m_EXRAMsloc2addr = new uint16_t[MEM_1KB];
+   m_state->m_EXRAMaddr2sloc = new uint16_t[MEM_1KB];
+   m_state->m_pEXRAMLogger = new CCodeDataLogger ( MEM_1KB, MASK_1KB );
+   m_state->m_EXRAMsloc = 0;
+   C6502::DISASSEMBLYRESET ( &(m_state->m_EXRAMdisassemblyState), MEM_1KB );
+   memset ( m_state->m_EXRAMmemory, 0, MEM_1KB );
+   memset ( m_state->m_EXRAMdisassembly, 0, MEM_1KB*sizeof(DisassemblyInfo) );
+   for ( addr = 0; addr < MEM_1KB; addr++ )
+   {
+      m_state->m_EXRAMopcodeMask[addr] = 0;
+      m_state->m_EXRAMsloc2addr[addr] = 0;
+      m_state->m_EXRAMaddr2sloc[addr] = 0;
+   }
+
+   m_state->m_VRAMmemory = new uint8_t[MEM_16KB]; // GTROM mapper 111 has 16KB remappable here
+   memset ( m_state->m_VRAMmemory, 0, MEM_16KB );
+
+   m_state->m_CHRmemory = new uint8_t*[NUM_CHR_BANKS];
+   m_state->m_numChrBanksAllocated = 0;
+   m_state->m_chrExtraBanksAllocated = false;
+   ALLOCATECHRBANKS ( CHRRAM_STATE_BANKS );
+
+   // Assume identity-mapped SRAM...
+   // There are five possible concurrently-visible 8KB
+   // SRAM banks in MMC5: (0x6000 - 0xFFFF).  Other
+   // cartridges with 8KB of SRAM will leave this mapping alone.
+   for ( bank = 0; bank < 5; bank++ )
+   {
+      m_state->m_pSRAMmemory [ bank ] = *(m_state->m_SRAMmemory+bank);
    }
 
-   m_SRAMmemory = new uint8_t*[NUM_SRAM_BANKS];
-   m_SRAMdisassembly = new char**[NUM_SRAM_BANKS];
-   m_SRAMopcodeMaskDirty = new bool[NUM_SRAM_BANKS];
-   m_SRAMopcodeMask = new uint8_t*[NUM_SRAM_BANKS];
-   m_SRAMsloc2addr = new uint16_t*[NUM_SRAM_BANKS];
-   m_SRAMaddr2sloc = new uint16_t*[NUM_SRAM_BANKS];
-   m_SRAMsloc = new uint32_t[NUM_SRAM_BANKS];
+   CROM::RESET ( false );
+}
+
+void CROM::DESTROY ( void )
+{
+   int32_t bank;
+
+   for ( bank = 0; bank < (int32_t)m_state->m_numPrgBanksAllocated; bank++ )
+   {
+      delete m_state->m_pLogger [ bank ];
+      delete [] m_state->m_PRGROMdisassembly[bank];
+      delete [] m_state->m_PRGROMmemory[bank];
+      delete [] m_state->m_PRGROMopcodeMask[bank];
+      delete [] m_state->m_PRGROMsloc2addr[bank];
+      delete [] m_state->m_PRGROMaddr2sloc[bank];
+   }
+   m_state->m_numPrgBanksAllocated = 0;
+   delete [] m_state->m_PRGROMdisassemblyState;
+   delete [] m_state->m_PRGROMmemory;
+   delete [] m_state->m_PRGROMdisassembly;
+   delete [] m_state->m_PRGROMopcodeMask;
+   delete [] m_state->m_PRGROMsloc2addr;
+   delete [] m_state->m_PRGROMaddr2sloc;
+   delete [] m_state->m_PRGROMsloc;
+
+   for ( bank = 0; bank < (int32_t)m_state->m_numChrBanksAllocated; bank++ )
+   {
+      delete [] m_state->m_CHRmemory[bank];
+   }
+   FREECHREXTRABANKS ();
+   m_state->m_numChrBanksAllocated = 0;
+   delete [] m_state->m_CHRmemory;
+
    for ( bank = 0; bank < NUM_SRAM_BANKS; bank++ )
    {
-      m_SRAMmemory[bank] = new uint8_t[MEM_8KB+1]; // Leave room for bank ID.
-      m_SRAMdisassembly[bank] = new char*[MEM_8KB];
-      m_SRAMopcodeMaskDirty[bank] = true;
-      m_SRAMopcodeMask[bank] = new uint8_t[MEM_8KB];
-      m_SRAMsloc2addr[bank] = new uint16_t[MEM_8KB];
-      m_SRAMaddr2sloc[bank] = new uint16_t[MEM_8KB];
-      m_SRAMsloc[bank] = 0;
-      m_pSRAMLogger [ bank ] = new CCodeDataLogger ( MEM_8KB, MASK_8KB );
+      delete m_state->m_pSRAMLogger [ bank ];
+      delete [] m_state->m_SRAMdisassembly[bank];
+      delete [] m_state->m_SRAMmemory[bank];
+      delete [] m_state->m_SRAMopcodeMask[bank];
+      delete [] m_state->m_SRAMsloc2addr[bank];
+      delete [] m_state->m_SRAMaddr2sloc[bank];
+   }
+   delete [] m_state->m_SRAMdisassemblyState;
+   delete [] m_state->m_SRAMmemory;
+   delete [] m_state->m_SRAMdisassembly;
+   delete [] m_state->m_SRAMopcodeMask;
+   delete [] m_state->m_SRAMsloc2addr;
+   delete [] m_state->m_SRAMaddr2sloc;
+   delete [] m_state->m_SRAMsloc;
+
+   delete [] m_state->m_VRAMmemory;
+
+   delete [] m_state->m_EXRAMdisassembly;
+   delete [] m_state->m_EXRAMmemory;
+   delete [] m_state->m_EXRAMopcodeMask;
+   delete [] m_state->m_EXRAMsloc2addr;
+   delete [] m_state->m_EXRAMaddr2sloc;
+   delete m_state->m_pEXRAMLogger;
+}
 
-      for ( addr = 0; addr < MEM_8KB; addr++ )
-      {
-         m_SRAMdisassembly[bank][addr] = new char [ 16 ];
-         m_SRAMopcodeMask[bank][addr] = 0;
-         m_SRAMsloc2addr[bank][addr] = 0;
-         m_SRAMaddr2sloc[bank][addr] = 0;
-      }
+void CROM::ALLOCATEPRGBANKS ( uint32_t banks )
+{
+   uint32_t bank;
+
+   // Drop the banks past the new size...
+   for ( bank = banks; bank < m_state->m_numPrgBanksAllocated; bank++ )
+   {
+      delete m_state->m_pLogger [ bank ];
+      delete [] m_state->m_PRGROMdisassembly[bank];
+      delete [] m_state->m_PRGROMmemory[bank];
+      delete [] m_state->m_PRGROMopcodeMask[bank];
+      delete [] m_state->m_PRGROMsloc2addr[bank];
+      delete [] m_state->m_PRGROMaddr2sloc[bank];
+   }
+
+   // ...or add banks up to it.
+   for ( bank = m_state->m_numPrgBanksAllocated; bank < banks; bank++ )
+   {
+      m_state->m_PRGROMmemory[bank] = new uint8_t[MEM_8KB+1]; // Leave room for bank ID.
+      m_state->m_PRGROMdisassembly[bank] = new DisassemblyInfo[MEM_8KB];
+      m_state->m_PRGROMopcodeMask[bank] = new uint8_t[MEM_8KB];
+      m_state->m_PRGROMsloc2addr[bank] = new uint16_t[MEM_8KB];
+      m_state->m_PRGROMaddr2sloc[bank] = new uint16_t[MEM_8KB];
+      m_state->m_pLogger [ bank ] = new CCodeDataLogger ( MEM_8KB, MASK_8KB );
+
+      memset ( m_state->m_PRGROMdisassembly[bank], 0, MEM_8KB*sizeof(DisassemblyInfo) );
+      memset ( m_state->m_PRGROMopcodeMask[bank], 0, MEM_8KB );
+      memset ( m_state->m_PRGROMsloc2addr[bank], 0, MEM_8KB*sizeof(uint16_t) );
+      memset ( m_state->m_PRGROMaddr2sloc[bank], 0, MEM_8KB*sizeof(uint16_t) );
 
       // Store bank ID in bank data at the end.  This is used only
       // by code that needs to calculate absolute address stuff.
       // Since the banks are stored non-contiguously this is a cheap
       // way to get the bank ID without having to implement a structure.
-      m_SRAMmemory[bank][MEM_8KB] = bank;
+      m_state->m_PRGROMmemory[bank][MEM_8KB] = bank;
    }
+   m_state->m_numPrgBanksAllocated = banks;
 
-   m_EXRAMmemory = new uint8_t[MEM_1KB];
-   m_EXRAMdisassembly = new char*[MEM_1KB];
-   m_EXRAMopcodeMask = new uint8_t[MEM_1KB];
-   m_EXRAMsloc2addr = new uint16_t[MEM_1KB];
-   m_EXRAMaddr2sloc = new uint16_t[MEM_1KB];
-   m_pEXRAMLogger = new CCodeDataLogger ( MEM_1KB, MASK_1KB );
-   for ( addr = 0; addr < MEM_1KB; addr++ )
+   for ( bank = 0; bank < NUM_ROM_BANKS; bank++ )
    {
-      m_EXRAMdisassembly[addr] = new char [ 16 ];
-      m_EXRAMopcodeMask[addr] = 0;
-      m_EXRAMsloc2addr[addr] = 0;
-      m_EXRAMaddr2sloc[addr] = 0;
+      if ( bank >= banks )
+      {
+         m_state->m_PRGROMmemory[bank] = m_state->m_PRGROMmemory[bank%banks];
+         m_state->m_PRGROMdisassembly[bank] = m_state->m_PRGROMdisassembly[bank%banks];
+         m_state->m_PRGROMopcodeMask[bank] = m_state->m_PRGROMopcodeMask[bank%banks];
+         m_state->m_PRGROMsloc2addr[bank] = m_state->m_PRGROMsloc2addr[bank%banks];
+         m_state->m_PRGROMaddr2sloc[bank] = m_state->m_PRGROMaddr2sloc[bank%banks];
+         m_state->m_pLogger [ bank ] = m_state->m_pLogger [ bank%banks ];
+      }
+      C6502::DISASSEMBLYRESET ( m_state->m_PRGROMdisassemblyState+bank, MEM_8KB );
+      m_state->m_PRGROMsloc[bank] = 0;
    }
+   for ( bank = NUM_ROM_BANKS; bank < PRGROM_STATE_ALIASES; bank++ )
+   {
+      m_state->m_PRGROMmemory[bank] = m_state->m_PRGROMmemory[bank%banks];
+   }
+}
 
-   m_VRAMmemory = new uint8_t[MEM_16KB]; // GTROM mapper 111 has 16KB remappable here
+void CROM::ALLOCATECHRBANKS ( uint32_t banks )
+{
+   uint32_t bank;
 
-   m_CHRmemory = new uint8_t*[NUM_CHR_BANKS];
-   for ( bank = 0; bank < NUM_CHR_BANKS; bank++ )
+   for ( bank = banks; bank < m_state->m_numChrBanksAllocated; bank++ )
+   {
+      delete [] m_state->m_CHRmemory[bank];
+   }
+   for ( bank = m_state->m_numChrBanksAllocated; bank < banks; bank++ )
    {
-      m_CHRmemory[bank] = new uint8_t[MEM_1KB+1]; // Leave room for bank ID.
+      m_state->m_CHRmemory[bank] = new uint8_t[MEM_1KB+1]; // Leave room for bank ID.
+      memset ( m_state->m_CHRmemory[bank], 0, MEM_1KB );
+      m_state->m_CHRmemory[bank][MEM_1KB] = bank;
+   }
+   m_state->m_numChrBanksAllocated = banks;
 
-      // Store bank ID in bank data at the end.  This is used only
-      // by code that needs to calculate absolute address stuff.
-      // Since the banks are stored non-contiguously this is a cheap
-      // way to get the bank ID without having to implement a structure.
-      m_CHRmemory[bank][MEM_1KB] = bank;
+   for ( bank = banks; bank < NUM_CHR_BANKS; bank++ )
+   {
+      if ( (bank < CHRRAM_STATE_EXTRA_BANK) || (!m_state->m_chrExtraBanksAllocated) )
+      {
+         m_state->m_CHRmemory[bank] = m_state->m_CHRmemory[bank%banks];
+      }
    }
+}
 
-   // Assume identity-mapped SRAM...
-   // There are five possible concurrently-visible 8KB
-   // SRAM banks in MMC5: (0x6000 - 0xFFFF).  Other
-   // cartridges with 8KB of SRAM will leave this mapping alone.
-   for ( bank = 0; bank < 5; bank++ )
+void CROM::ALLOCATECHREXTRABANKS ( void )
+{
+   uint32_t bank;
+
+   if ( m_state->m_chrExtraBanksAllocated )
+   {
+      return;
+   }
+   for ( bank = CHRRAM_STATE_EXTRA_BANK; bank < NUM_CHR_BANKS; bank++ )
    {
-      m_pSRAMmemory [ bank ] = *(m_SRAMmemory+bank);
+      m_state->m_CHRmemory[bank] = new uint8_t[MEM_1KB+1]; // Leave room for bank ID.
+      memset ( m_state->m_CHRmemory[bank], 0, MEM_1KB );
+      m_state->m_CHRmemory[bank][MEM_1KB] = bank;
    }
+   m_state->m_chrExtraBanksAllocated = true;
+}
 
-   CROM::RESET ( false );
+void CROM::FREECHREXTRABANKS ( void )
+{
+   uint32_t bank;
+
+   if ( !m_state->m_chrExtraBanksAllocated )
+   {
+      return;
+   }
+   for ( bank = CHRRAM_STATE_EXTRA_BANK; bank < NUM_CHR_BANKS; bank++ )
+   {
+      delete [] m_state->m_CHRmemory[bank];
+   }
+   m_state->m_chrExtraBanksAllocated = false;
 }
 
-CROM::~CROM()
+uint32_t CROM::POINTERTOSTATE ( const uint8_t* pointer )
 {
    int32_t bank;
-   int32_t addr;
 
+   if ( !pointer )
+   {
+      return NES_STATE_POINTER(eStatePointer_Null,0);
+   }
    for ( bank = 0; bank < NUM_ROM_BANKS; bank++ )
    {
-      delete m_pLogger [ bank ];
-
-      for ( addr = 0; addr < MEM_8KB; addr++ )
+      if ( (pointer >= m_state->m_PRGROMmemory[bank]) && (pointer < m_state->m_PRGROMmemory[bank]+MEM_8KB) )
       {
-         delete m_PRGROMdisassembly[bank][addr];
+         return NES_STATE_POINTER(eStatePointer_PRGROM,(bank*MEM_8KB)+(pointer-m_state->m_PRGROMmemory[bank]));
       }
-      delete [] m_PRGROMmemory[bank];
-      delete [] m_PRGROMopcodeMask[bank];
-      delete [] m_PRGROMsloc2addr[bank];
-      delete [] m_PRGROMaddr2sloc[bank];
-   }
-   delete [] m_PRGROMopcodeMaskDirty;
-   delete [] m_PRGROMmemory;
-   delete [] m_PRGROMopcodeMask;
-   delete [] m_PRGROMsloc2addr;
-   delete [] m_PRGROMaddr2sloc;
-   delete [] m_PRGROMsloc;
-
+   }
    for ( bank = 0; bank < NUM_CHR_BANKS; bank++ )
    {
-      delete [] m_CHRmemory[bank];
+      if ( (pointer >= m_state->m_CHRmemory[bank]) && (pointer < m_state->m_CHRmemory[bank]+MEM_1KB) )
+      {
+         return NES_STATE_POINTER(eStatePointer_CHR,(bank*MEM_1KB)+(pointer-m_state->m_CHRmemory[bank]));
+      }
+   }
+   for ( bank = 0; bank < NUM_SRAM_BANKS; bank++ )
+   {
+      if ( (pointer >= m_state->m_SRAMmemory[bank]) && (pointer < m_state->m_SRAMmemory[bank]+MEM_8KB) )
+      {
+         return NES_STATE_POINTER(eStatePointer_SRAM,(bank*MEM_8KB)+(pointer-m_state->m_SRAMmemory[bank]));
+      }
+   }
+   if ( (pointer >= m_state->m_EXRAMmemory) && (pointer < m_state->m_EXRAMmemory+MEM_1KB) )
+   {
+      return NES_STATE_POINTER(eStatePointer_EXRAM,pointer-m_state->m_EXRAMmemory);
+   }
+   if ( (pointer >= m_state->m_VRAMmemory) && (pointer < m_state->m_VRAMmemory+MEM_16KB) )
+   {
+      return NES_STATE_POINTER(eStatePointer_VRAM,pointer-m_state->m_VRAMmemory);
+   }
+   return NES_STATE_POINTER_INVALID;
+}
+
+uint8_t* CROM::STATETOPOINTER ( uint32_t value )
+{
+   uint32_t offset = NES_STATE_POINTER_OFFSET(value);
+
+   switch ( NES_STATE_POINTER_REGION(value) )
+   {
+   case eStatePointer_PRGROM:
+      return m_state->m_PRGROMmemory[(offset/MEM_8KB)%NUM_ROM_BANKS]+(offset%MEM_8KB);
+   case eStatePointer_CHR:
+      return m_state->m_CHRmemory[(offset/MEM_1KB)%(NUM_CHR_BANKS)]+(offset%MEM_1KB);
+   case eStatePointer_SRAM:
+      return m_state->m_SRAMmemory[(offset/MEM_8KB)%NUM_SRAM_BANKS]+(offset%MEM_8KB);
+   case eStatePointer_EXRAM:
+      return m_state->m_EXRAMmemory+(offset%MEM_1KB);
+   case eStatePointer_VRAM:
+      return m_state->m_VRAMmemory+(offset%MEM_16KB);
+   }
+   return NULL;
+}
+
+void CROM::SAVESTATE ( CNESStateWriter& state )
+{
+   int32_t bank;
+
+   state.BeginChunk ( NES_STATE_CHUNK_ROM, NES_STATE_VERSION_ROM );
+
+   // Identify the cartridge so a state isn't loaded into the wrong one.
+   state.Put ( m_state->m_mapper );
+   state.Put ( m_state->m_numPrgBanks );
+   state.Put ( m_state->m_numChrBanks );
+
+   for ( bank = 0; bank < 4; bank++ )
+   {
+      state.Put ( POINTERTOSTATE(m_state->m_pPRGROMmemory[bank]) );
+   }
+   for ( bank = 0; bank < 8; bank++ )
+   {
+      state.Put ( POINTERTOSTATE(m_state->m_pCHRmemory[bank]) );
+   }
+   for ( bank = 0; bank < 5; bank++ )
+   {
+      state.Put ( POINTERTOSTATE(m_state->m_pSRAMmemory[bank]) );
+   }
+   for ( bank = 0; bank < 8; bank++ )
+   {
+      state.Put ( POINTERTOSTATE(m_state->m_pVRAMmemory[bank]) );
    }
-   delete [] m_CHRmemory;
 
    for ( bank = 0; bank < NUM_SRAM_BANKS; bank++ )
    {
-      for ( addr = 0; addr < MEM_8KB; addr++ )
+      state.Put ( m_state->m_SRAMmemory[bank], MEM_8KB );
+   }
+   state.Put ( m_state->m_EXRAMmemory, MEM_1KB );
+   state.Put ( m_state->m_VRAMmemory, MEM_16KB );
+   if ( !m_state->m_numChrBanks )
+   {
+      for ( bank = 0; bank < CHRRAM_STATE_BANKS; bank++ )
       {
-         delete m_SRAMdisassembly[bank][addr];
+         state.Put ( m_state->m_CHRmemory[bank], MEM_1KB );
       }
-      delete [] m_SRAMmemory[bank];
-      delete [] m_SRAMopcodeMask[bank];
-      delete [] m_SRAMsloc2addr[bank];
-      delete [] m_SRAMaddr2sloc[bank];
    }
-   delete [] m_SRAMopcodeMaskDirty;
-   delete [] m_SRAMmemory;
-   delete [] m_SRAMopcodeMask;
-   delete [] m_SRAMsloc2addr;
-   delete [] m_SRAMaddr2sloc;
-   delete [] m_SRAMsloc;
+   if ( m_state->m_chrExtraBanksAllocated )
+   {
+      for ( bank = CHRRAM_STATE_EXTRA_BANK; bank < NUM_CHR_BANKS; bank++ )
+      {
+         state.Put ( m_state->m_CHRmemory[bank], MEM_1KB );
+      }
+   }
+   state.EndChunk ();
+}
 
-   delete [] m_VRAMmemory;
+bool CROM::LOADSTATE ( CNESStateReader& state )
+{
+   uint32_t mapper;
+   uint32_t numPrgBanks;
+   uint32_t numChrBanks;
+   uint32_t pointer [ 4+8+5+8 ];
+   uint8_t** pBank [ 4+8+5+8 ];
+   int32_t  bank;
+   bool     ok;
 
-   for ( addr = 0; addr < MEM_1KB; addr++ )
+   if ( !state.FindChunk(NES_STATE_CHUNK_ROM,NES_STATE_VERSION_ROM) ||
+        !state.Get(mapper) ||
+        !state.Get(numPrgBanks) ||
+        !state.Get(numChrBanks) )
+   {
+      return false;
+   }
+   if ( (mapper != m_state->m_mapper) ||
+        (numPrgBanks != m_state->m_numPrgBanks) ||
+        (numChrBanks != m_state->m_numChrBanks) )
+   {
+      return false;
+   }
+
+   ok = state.Get ( pointer );
+   for ( bank = 0; ok && (bank < NUM_SRAM_BANKS); bank++ )
+   {
+      ok = state.Get ( m_state->m_SRAMmemory[bank], MEM_8KB );
+   }
+   ok = ok &&
+        state.Get ( m_state->m_EXRAMmemory, MEM_1KB ) &&
+        state.Get ( m_state->m_VRAMmemory, MEM_16KB );
+   if ( !m_state->m_numChrBanks )
+   {
+      for ( bank = 0; ok && (bank < CHRRAM_STATE_BANKS); bank++ )
+      {
+         ok = state.Get ( m_state->m_CHRmemory[bank], MEM_1KB );
+      }
+   }
+   if ( m_state->m_chrExtraBanksAllocated )
+   {
+      for ( bank = CHRRAM_STATE_EXTRA_BANK; ok && (bank < NUM_CHR_BANKS); bank++ )
+      {
+         ok = state.Get ( m_state->m_CHRmemory[bank], MEM_1KB );
+      }
+   }
+
+   if ( ok )
    {
-      delete m_EXRAMdisassembly[addr];
+      for ( bank = 0; bank < 4; bank++ )
+      {
+         pBank[bank] = m_state->m_pPRGROMmemory+bank;
+      }
+      for ( bank = 0; bank < 8; bank++ )
+      {
+         pBank[4+bank] = m_state->m_pCHRmemory+bank;
+      }
+      for ( bank = 0; bank < 5; bank++ )
+      {
+         pBank[4+8+bank] = m_state->m_pSRAMmemory+bank;
+      }
+      for ( bank = 0; bank < 8; bank++ )
+      {
+         pBank[4+8+5+bank] = m_state->m_pVRAMmemory+bank;
+      }
+      for ( bank = 0; bank < 4+8+5+8; bank++ )
+      {
+         if ( pointer[bank] != NES_STATE_POINTER_INVALID )
+         {
+            (*pBank[bank]) = STATETOPOINTER ( pointer[bank] );
+         }
+      }
+      MAPCPUPAGES ();
    }
-   delete [] m_EXRAMmemory;
-   delete [] m_EXRAMopcodeMask;
-   delete [] m_EXRAMsloc2addr;
-   delete [] m_EXRAMaddr2sloc;
+
+   return ok;
+}
+
+void CROM::ClearPRGBanks ( void )
+{
+   m_state->m_numPrgBanks = 0;
+   ALLOCATEPRGBANKS ( 1 );
+}
+
+void CROM::ClearCHRBanks ( void )
+{
+   m_state->m_numChrBanks = 0;
+   FREECHREXTRABANKS ();
+   ALLOCATECHRBANKS ( CHRRAM_STATE_BANKS );
 }
 
 void CROM::SetPRGBank ( int32_t bank, uint8_t* data )
 {
-   memcpy ( m_PRGROMmemory[m_numPrgBanks], data, MEM_8KB );
-   m_numPrgBanks++;
+   if ( m_state->m_numPrgBanks >= NUM_ROM_BANKS )
+   {
+      return;
+   }
+   if ( m_state->m_numPrgBanks >= m_state->m_numPrgBanksAllocated )
+   {
+      ALLOCATEPRGBANKS ( m_state->m_numPrgBanks+1 );
+   }
+   memcpy ( m_state->m_PRGROMmemory[m_state->m_numPrgBanks], data, MEM_8KB );
+   m_state->m_numPrgBanks++;
 }
 
 void CROM::SetCHRBank ( int32_t bank, uint8_t* data )
 {
    uint8_t ibank;
+
+   if ( (bank<<3) >= CHRRAM_STATE_EXTRA_BANK )
+   {
+      return;
+   }
+   if ( ((bank+1)<<3) > (int32_t)m_state->m_numChrBanksAllocated )
+   {
+      ALLOCATECHRBANKS ( (bank+1)<<3 );
+   }
    for ( ibank = 0; ibank < 8; ibank++ )
    {
-      memcpy ( m_CHRmemory[(bank<<3)+ibank], data+(ibank*MEM_1KB), MEM_1KB );
+      memcpy ( m_state->m_CHRmemory[(bank<<3)+ibank], data+(ibank*MEM_1KB), MEM_1KB );
    }
-   m_numChrBanks = bank + 1;
+   m_state->m_numChrBanks = bank + 1;
 }
 
 void CROM::DoneLoadingBanks ()
 {
+   int32_t bank;
+
    // This is called when the ROM loader is done so that fixup can be done...
-   if ( m_numPrgBanks == 2 )
+
+   // The PRG-ROM slots were mapped when the previous cartridge came out,
+   // before this one's banks existed.
+   for ( bank = 0; bank < 4; bank++ )
+   {
+      REMAPPRG ( bank, m_state->m_PRGROMmemory [ bank ] );
+   }
+
+   if ( m_state->m_numPrgBanks == 2 )
    {
       // If the ROM contains only one 16KB PRG-ROM bank then it needs to be replicated
       // to the second PRG-ROM bank slot...
-      m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ 0 ];
-      m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ 1 ];
+      REMAPPRG ( 2, m_state->m_PRGROMmemory [ 0 ] );
+      REMAPPRG ( 3, m_state->m_PRGROMmemory [ 1 ] );
    }
 
    if ( nesIsDebuggable() )
@@ -352,7 +651,7 @@ void CROM::DoneLoadingBanks ()
    }
 
    // We just put a cartridge in...the SRAM isn't dirty yet.
-   m_SRAMdirty = false;
+   m_state->m_SRAMdirty = false;
 }
 
 void CROM::RESET ( bool soft )
@@ -364,24 +663,24 @@ void CROM::RESET ( uint32_t mapper, bool soft )
 {
    int32_t bank;
 
-   m_mapper = mapper;
+   m_state->m_mapper = mapper;
 
    if ( mapper == 0 )
    {
-      m_dbRegisters = NULL;
+      m_state->m_dbRegisters = NULL;
    }
 
    if ( nesIsDebuggable() )
    {
       // Clear Code/Data Logger info...
-      for ( bank = 0; bank < NUM_ROM_BANKS; bank++ )
+      for ( bank = 0; bank < (int32_t)m_state->m_numPrgBanksAllocated; bank++ )
       {
-         m_pLogger [ bank ]->ClearData ();
+         m_state->m_pLogger [ bank ]->ClearData ();
       }
    }
 
    // Support for NROM-368 for Shiru and crew.
-   if ( (m_mapper == 0) && (m_numPrgBanks > 4) )
+   if ( (m_state->m_mapper == 0) && (m_state->m_numPrgBanks > 4) )
    {
       // A NROM-368 file is laid out linearly so the six 8KB PRG-ROM banks will be
       // loaded into the following memory addresses:
@@ -395,41 +694,41 @@ void CROM::RESET ( uint32_t mapper, bool soft )
       // so that the CPU sees the upper end of the linear memory there.  The lower end
       // from $4000-$7fff will be mapped in by the existing mapper "low read" APIs called
       // whenever the CPU reads from $4018-$7fff.
-      m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 2 ];
-      m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 3 ];
+      REMAPPRG ( 0, m_state->m_PRGROMmemory [ 2 ] );
+      REMAPPRG ( 1, m_state->m_PRGROMmemory [ 3 ] );
 
-      m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ 4 ];
-      m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ 5 ];
+      REMAPPRG ( 2, m_state->m_PRGROMmemory [ 4 ] );
+      REMAPPRG ( 3, m_state->m_PRGROMmemory [ 5 ] );
    }
    else
    {
-      m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-      m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
+      REMAPPRG ( 0, m_state->m_PRGROMmemory [ 0 ] );
+      REMAPPRG ( 1, m_state->m_PRGROMmemory [ 1 ] );
 
       // If the ROM contains only one 16KB PRG-ROM bank then it needs to be replicated
       // to the second PRG-ROM bank slot...
-      if ( m_numPrgBanks == 2 )
+      if ( m_state->m_numPrgBanks == 2 )
       {
-         m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ 0 ];
-         m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ 1 ];
+         REMAPPRG ( 2, m_state->m_PRGROMmemory [ 0 ] );
+         REMAPPRG ( 3, m_state->m_PRGROMmemory [ 1 ] );
       }
       else
       {
-         m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ 2 ];
-         m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ 3 ];
+         REMAPPRG ( 2, m_state->m_PRGROMmemory [ 2 ] );
+         REMAPPRG ( 3, m_state->m_PRGROMmemory [ 3 ] );
       }
    }
 
    // Default CHR map...
    for ( bank = 0; bank < 8; bank++ )
    {
-      m_pCHRmemory [ bank ] = m_CHRmemory [ bank ];
+      m_state->m_pCHRmemory [ bank ] = m_state->m_CHRmemory [ bank ];
    }
 
    // Default VRAM map...
    for ( bank = 0; bank < 8; bank++ )
    {
-      m_pVRAMmemory [ bank ] = m_VRAMmemory+(bank*MEM_1KB);
+      m_state->m_pVRAMmemory [ bank ] = m_state->m_VRAMmemory+(bank*MEM_1KB);
    }
 
    // Assume identity-mapped SRAM...
@@ -438,18 +737,35 @@ void CROM::RESET ( uint32_t mapper, bool soft )
    // cartridges with 8KB of SRAM will leave this mapping alone.
    for ( bank = 0; bank < 5; bank++ )
    {
-      m_pSRAMmemory [ bank ] = *(m_SRAMmemory+bank);
+      m_state->m_pSRAMmemory [ bank ] = *(m_state->m_SRAMmemory+bank);
    }
 }
 
+void CROM::MAPCPUPAGES ( void )
+{
+   int32_t bank;
+
+   // Mappers that intercept reads keep their pages on the slow path.
+   // NROM-368 reads PRG-ROM, not SRAM, at $6000-$7FFF.
+   m_state->m_PRGpagesDirect = (CNES::MAPPERFUNC()->highread == static_cast<MAPPERRFUNC>(CROM::HMAPPER));
+   m_state->m_SRAMpagesDirect = (CNES::MAPPERFUNC()->lowread == static_cast<MAPPERRFUNC>(CROM::LMAPPER)) &&
+                                (!((m_state->m_mapper == 0) && (m_state->m_numPrgBanks > 4)));
+
+   for ( bank = 0; bank < 4; bank++ )
+   {
+      C6502::MAPREAD ( 0x8000+(bank<<UPSHIFT_8KB), MEM_8KB, m_state->m_PRGpagesDirect ? m_state->m_pPRGROMmemory[bank] : NULL );
+   }
+   C6502::MAPREAD ( SRAM_START, MEM_8KB, m_state->m_SRAMpagesDirect ? m_state->m_pSRAMmemory[0] : NULL );
+}
+
 uint32_t CROM::LMAPPER ( uint32_t addr )
 {
    uint8_t data = C6502::OPENBUS();
 
-   if ( (m_mapper == 0) && (m_numPrgBanks > 4) )
+   if ( (m_state->m_mapper == 0) && (m_state->m_numPrgBanks > 4) )
    {
       addr -= MEM_16KB;
-      return *(*(m_PRGROMmemory+(PRGBANK_VIRT(addr)))+(PRGBANK_OFF(addr)));
+      return *(*(m_state->m_PRGROMmemory+(PRGBANK_VIRT(addr)))+(PRGBANK_OFF(addr)));
    }
    else
    {
@@ -475,51 +791,71 @@ void CROM::DISASSEMBLE ()
    uint32_t bank;
 
    // Disassemble PRG-ROM banks...
-   for ( bank = 0; bank < m_numPrgBanks; bank++ )
+   for ( bank = 0; bank < m_state->m_numPrgBanks; bank++ )
    {
-      if ( *(m_PRGROMopcodeMaskDirty+bank) )
-      {
-         C6502::DISASSEMBLE ( m_PRGROMdisassembly[bank],
-                              m_PRGROMmemory[bank],
-                              MEM_8KB,
-                              m_PRGROMopcodeMask[bank],
-                              m_PRGROMsloc2addr[bank],
-                              m_PRGROMaddr2sloc[bank],
-                              &(m_PRGROMsloc[bank]) );
-
-         *(m_PRGROMopcodeMaskDirty+bank) = false;
-      }
+      C6502::DISASSEMBLE ( m_state->m_PRGROMdisassembly[bank],
+                           m_state->m_PRGROMmemory[bank],
+                           MEM_8KB,
+                           m_state->m_PRGROMopcodeMask[bank],
+                           m_state->m_PRGROMsloc2addr[bank],
+                           m_state->m_PRGROMaddr2sloc[bank],
+                           &(m_state->m_PRGROMsloc[bank]),
+                           m_state->m_PRGROMdisassemblyState+bank );
    }
 
    // Disassemble SRAM...
    for ( bank = 0; bank < NUM_SRAM_BANKS; bank++ )
    {
-      if ( *(m_SRAMopcodeMaskDirty+bank) )
-      {
-         C6502::DISASSEMBLE ( m_SRAMdisassembly[bank],
-                              m_SRAMmemory[bank],
-                              MEM_8KB,
-                              m_SRAMopcodeMask[bank],
-                              m_SRAMsloc2addr[bank],
-                              m_SRAMaddr2sloc[bank],
-                              &(m_SRAMsloc[bank]) );
-
-         *(m_SRAMopcodeMaskDirty+bank) = false;
-      }
+      C6502::DISASSEMBLE ( m_state->m_SRAMdisassembly[bank],
+                           m_state->m_SRAMmemory[bank],
+                           MEM_8KB,
+                           m_state->m_SRAMopcodeMask[bank],
+                           m_state->m_SRAMsloc2addr[bank],
+                           m_state->m_SRAMaddr2sloc[bank],
+                           &(m_state->m_SRAMsloc[bank]),
+                           m_state->m_SRAMdisassemblyState+bank );
    }
 
    // Disassemble EXRAM...
-   if ( m_EXRAMopcodeMaskDirty )
-   {
-      C6502::DISASSEMBLE ( m_EXRAMdisassembly,
-                           m_EXRAMmemory,
-                           MEM_1KB,
-                           m_EXRAMopcodeMask,
-                           m_EXRAMsloc2addr,
-                           m_EXRAMaddr2sloc,
-                           &(m_EXRAMsloc) );
+   C6502::DISASSEMBLE ( m_state->m_EXRAMdisassembly,
+                        m_state->m_EXRAMmemory,
+                        MEM_1KB,
+                        m_state->m_EXRAMopcodeMask,
+                        m_state->m_EXRAMsloc2addr,
+                        m_state->m_EXRAMaddr2sloc,
+                        &(m_state->m_EXRAMsloc),
+                        &(m_state->m_EXRAMdisassemblyState) );
+}
 
-      m_EXRAMopcodeMaskDirty = false;
+void CROM::DISASSEMBLYCHANGES ( uint32_t addr, DisassemblyState* pView )
+{
+   uint32_t bank;
+   int32_t  base = 0;
+
+   if ( addr < 0x6000 )
+   {
+      C6502::DISASSEMBLYCHANGES ( &(m_state->m_EXRAMdisassemblyState), 0, pView );
+      C6502::DISASSEMBLYCHANGESCLR ( &(m_state->m_EXRAMdisassemblyState) );
+   }
+   else if ( addr < 0x8000 )
+   {
+      C6502::DISASSEMBLYCHANGES ( m_state->m_SRAMdisassemblyState+SRAMBANK_PHYS(addr), 0, pView );
+      C6502::DISASSEMBLYCHANGESCLR ( m_state->m_SRAMdisassemblyState+SRAMBANK_PHYS(addr) );
+   }
+   else
+   {
+      // The PRG-ROM view is the four banks at $8000-$FFFF end to end.  A
+      // bank can be in it more than once, so forget its changes only
+      // after all of them are in.
+      for ( bank = 0; bank < 4; bank++ )
+      {
+         C6502::DISASSEMBLYCHANGES ( m_state->m_PRGROMdisassemblyState+PRGBANK_PHYS(0x8000+(bank<<UPSHIFT_8KB)), base, pView );
+         base += PRGROMSLOC(0x8000+(bank<<UPSHIFT_8KB));
+      }
+      for ( bank = 0; bank < 4; bank++ )
+      {
+         C6502::DISASSEMBLYCHANGESCLR ( m_state->m_PRGROMdisassemblyState+PRGBANK_PHYS(0x8000+(bank<<UPSHIFT_8KB)) );
+      }
    }
 }
 
@@ -551,19 +887,19 @@ uint32_t CROM::PRGROMSLOC2ADDR ( uint16_t sloc )
       sloc -= slocC000;
    }
 
-   return addr+(*(*(m_PRGROMsloc2addr+PRGBANK_PHYS(addr))+sloc));
+   return addr+(*(*(m_state->m_PRGROMsloc2addr+PRGBANK_PHYS(addr))+sloc));
 }
 
 uint32_t CROM::SRAMSLOC2ADDR ( uint16_t sloc )
 {
    int32_t addr = 0x6000;
 
-   return addr+(*(*(m_SRAMsloc2addr+SRAMBANK_PHYS(addr))+sloc));
+   return addr+(*(*(m_state->m_SRAMsloc2addr+SRAMBANK_PHYS(addr))+sloc));
 }
 
 uint32_t CROM::EXRAMSLOC2ADDR ( uint16_t sloc )
 {
-   return 0x5C00+(*(m_EXRAMsloc2addr+sloc));
+   return 0x5C00+(*(m_state->m_EXRAMsloc2addr+sloc));
 }
 
 uint16_t CROM::PRGROMADDR2SLOC ( uint32_t addr )
@@ -590,17 +926,17 @@ uint16_t CROM::PRGROMADDR2SLOC ( uint32_t addr )
       sloc = slocC000;
    }
 
-   return sloc+(*(*(m_PRGROMaddr2sloc+PRGBANK_PHYS(addr))+PRGBANK_OFF(addr)));
+   return sloc+(*(*(m_state->m_PRGROMaddr2sloc+PRGBANK_PHYS(addr))+PRGBANK_OFF(addr)));
 }
 
 uint16_t CROM::SRAMADDR2SLOC ( uint32_t addr )
 {
    int32_t sloc = 0;
 
-   return sloc+(*(*(m_SRAMaddr2sloc+SRAMBANK_PHYS(addr))+SRAMBANK_OFF(addr)));
+   return sloc+(*(*(m_state->m_SRAMaddr2sloc+SRAMBANK_PHYS(addr))+SRAMBANK_OFF(addr)));
 }
 
 uint16_t CROM::EXRAMADDR2SLOC ( uint32_t addr )
 {
-   return *(m_EXRAMaddr2sloc+(addr-0x5C00));
+   return *(m_state->m_EXRAMaddr2sloc+(addr-0x5C00));
 }
@@ -10,13 +10,14 @@
 #include "ccodedatalogger.h"
 #include "cregisterdata.h"
 #include "cmemorydata.h"
+#include "cnesstate.h"
 
 // Resolve a 6502-address to one of 4 8KB PRG ROM banks [0:$8000-$9FFF, 1:$A000-$BFFF, 2:$C000-$DFFF, or 3:$E000-$FFFF]
-#define PRGBANK_VIRT(addr) ( (addr&MASK_32KB)>>SHIFT_32KB_8KB )
+#define PRGBANK_VIRT(addr) ( ((addr)&MASK_32KB)>>SHIFT_32KB_8KB )
 // Retrieve the bank-offset address portion of a 6502-address for use within PRG ROM banks
-#define PRGBANK_OFF(addr) ( addr&MASK_8KB )
+#define PRGBANK_OFF(addr) ( (addr)&MASK_8KB )
 // Resolve a 6502-address to one of the 8KB PRG ROM banks within a ROM file [the absolute physical address]
-#define PRGBANK_PHYS(addr) ( *((*(m_pPRGROMmemory+PRGBANK_VIRT(addr)))+MEM_8KB) )
+#define PRGBANK_PHYS(addr) ( *((*(m_state->m_pPRGROMmemory+PRGBANK_VIRT(addr)))+MEM_8KB) )
 
 // Resolve an absolute address to a PRG-ROM bank
 #define PRGBANK_ABSBANK(absAddr) ( absAddr>>SHIFT_32KB_8KB )
@@ -26,7 +27,7 @@
 // Retrieve the bank-offset address portion of an address for use within CHR memory banks
 #define CHRBANK_OFF(addr) ( addr&MASK_1KB )
 // Resolve an address to one of the 8KB CHR memory banks [the absolute physical address]
-#define CHRBANK_PHYS(addr) ( *((*(m_pCHRmemory+CHRBANK_VIRT(addr)))+MEM_1KB) )
+#define CHRBANK_PHYS(addr) ( *((*(m_state->m_pCHRmemory+CHRBANK_VIRT(addr)))+MEM_1KB) )
 
 #define SRAMBANK_VIRT(addr) ( ((addr-SRAM_START)&MASK_64KB)>>SHIFT_64KB_8KB )
 #define SRAMBANK_OFF(addr) ( addr&MASK_8KB )
@@ -34,7 +35,7 @@
 // NOTE: Mappers with SRAM typically have one 8KB bank at $6000-$7FFF but MMC5
 // allows mapping of up to 64KB of SRAM anywhere in the upper 32KB ROM space.
 //#define SRAMBANK_PHYS(addr) ( ((uint8_t*)(*(m_pSRAMmemory+SRAMBANK_VIRT(addr)))-(uint8_t*)m_SRAMmemory)>>SHIFT_64KB_8KB )
-#define SRAMBANK_PHYS(addr) ( *((*(m_pSRAMmemory+SRAMBANK_VIRT(addr)))+MEM_8KB) )
+#define SRAMBANK_PHYS(addr) ( *((*(m_state->m_pSRAMmemory+SRAMBANK_VIRT(addr)))+MEM_8KB) )
 
 #define SRAMBANK_ABSBANK(absAddr) ( absAddr>>SHIFT_64KB_8KB )
 
@@ -44,31 +45,39 @@ public:
    CROM();
    ~CROM();
 
+   // Allocate/free the resources owned by the selected machine.
+   static void CREATE ( void );
+   static void DESTROY ( void );
+
+   // Save/restore the selected machine's cartridge memories and bank mappings to/from a binary save-state.
+   static void SAVESTATE ( CNESStateWriter& state );
+   static bool LOADSTATE ( CNESStateReader& state );
+
+   // Convert a pointer into cartridge memory to/from the form it is stored
+   // in within a save-state (see NES_STATE_POINTER).  Pointers that do not
+   // refer to cartridge memory convert to NES_STATE_POINTER_INVALID.
+   static uint32_t POINTERTOSTATE ( const uint8_t* pointer );
+   static uint8_t* STATETOPOINTER ( uint32_t value );
+
    // Priming interfaces (data setup/initialization)
-   static void ClearPRGBanks ()
-   {
-      m_numPrgBanks = 0;
-   }
-   static void ClearCHRBanks ()
-   {
-      m_numChrBanks = 0;
-   }
+   static void ClearPRGBanks ( void );
+   static void ClearCHRBanks ( void );
    static void SetCHRBank ( int32_t bank, uint8_t* data );
    static void SetPRGBank ( int32_t bank, uint8_t* data );
    static void DoneLoadingBanks ( void );
    static uint32_t NUMPRGROMBANKS ( void )
    {
-      return m_numPrgBanks;
+      return m_state->m_numPrgBanks;
    }
    static uint32_t NUMCHRROMBANKS ( void )
    {
-      return m_numChrBanks;
+      return m_state->m_numChrBanks;
    }
 
    // Operations
    static bool IsWriteProtected ( void )
    {
-      return (m_numChrBanks>0);
+      return (m_state->m_numChrBanks>0);
    }
    static uint32_t CHRMEMABSADDR ( uint32_t addr )
    {
@@ -80,20 +89,20 @@ public:
    }
    static inline uint32_t PRGROM ( uint32_t addr )
    {
-      return *(*(m_pPRGROMmemory+PRGBANK_VIRT(addr))+(PRGBANK_OFF(addr)));
+      return *(*(m_state->m_pPRGROMmemory+PRGBANK_VIRT(addr))+(PRGBANK_OFF(addr)));
    }
    static inline void PRGROM ( uint32_t, uint8_t ) {}
    static inline uint32_t PRGROMPHYS ( uint32_t addr )
    {
-      return *(*(m_PRGROMmemory+PRGBANK_ABSBANK(addr))+PRGBANK_OFF(addr));
+      return *(*(m_state->m_PRGROMmemory+PRGBANK_ABSBANK(addr))+PRGBANK_OFF(addr));
    }
    static inline void CHRMEM ( uint32_t addr, uint8_t data )
    {
-      *(*(m_pCHRmemory+CHRBANK_VIRT(addr))+CHRBANK_OFF(addr)) = data;
+      *(*(m_state->m_pCHRmemory+CHRBANK_VIRT(addr))+CHRBANK_OFF(addr)) = data;
    }
    static inline uint32_t CHRMEM ( uint32_t addr )
    {
-      return *(*(m_pCHRmemory+CHRBANK_VIRT(addr))+CHRBANK_OFF(addr));
+      return *(*(m_state->m_pCHRmemory+CHRBANK_VIRT(addr))+CHRBANK_OFF(addr));
    }
    static inline uint32_t SRAMABSADDR ( uint32_t addr )
    {
@@ -101,52 +110,68 @@ public:
    }
    static inline uint32_t SRAMVIRT ( uint32_t addr )
    {
-      return *(*(m_pSRAMmemory+SRAMBANK_VIRT(addr))+SRAMBANK_OFF(addr));
+      return *(*(m_state->m_pSRAMmemory+SRAMBANK_VIRT(addr))+SRAMBANK_OFF(addr));
    }
    static inline void SRAMVIRT ( uint32_t addr, uint8_t data )
    {
-      *(*(m_pSRAMmemory+SRAMBANK_VIRT(addr))+SRAMBANK_OFF(addr)) = data;
-      m_SRAMdirty = true;
+      *(*(m_state->m_pSRAMmemory+SRAMBANK_VIRT(addr))+SRAMBANK_OFF(addr)) = data;
+      m_state->m_SRAMdirty = true;
    }
    static inline uint32_t SRAMPHYS ( uint32_t addr )
    {
-      return *(*(m_SRAMmemory+SRAMBANK_ABSBANK(addr))+SRAMBANK_OFF(addr));
+      return *(*(m_state->m_SRAMmemory+SRAMBANK_ABSBANK(addr))+SRAMBANK_OFF(addr));
    }
    static inline void SRAMPHYS ( uint32_t addr, uint8_t data, bool setDirty = true )
    {
-      *(*(m_SRAMmemory+SRAMBANK_ABSBANK(addr))+SRAMBANK_OFF(addr)) = data;
+      *(*(m_state->m_SRAMmemory+SRAMBANK_ABSBANK(addr))+SRAMBANK_OFF(addr)) = data;
       if ( setDirty )
       {
-         m_SRAMdirty = true;
+         m_state->m_SRAMdirty = true;
       }
    }
    static inline void REMAPSRAM ( uint32_t addr, uint8_t bank )
    {
-      *(m_pSRAMmemory+SRAMBANK_VIRT(addr)) = *(m_SRAMmemory+bank);
+      *(m_state->m_pSRAMmemory+SRAMBANK_VIRT(addr)) = *(m_state->m_SRAMmemory+bank);
+      if ( (addr < 0x8000) && m_state->m_SRAMpagesDirect )
+      {
+         C6502::MAPREAD ( SRAM_START, MEM_8KB, *(m_state->m_SRAMmemory+bank) );
+      }
    }
+   // Switch one of the four 8KB PRG-ROM windows at $8000-$FFFF.  Mappers
+   // must bank-switch through here so the CPU's page table follows.
+   static inline void REMAPPRG ( uint32_t bank, uint8_t* memory )
+   {
+      m_state->m_pPRGROMmemory [ bank ] = memory;
+      if ( m_state->m_PRGpagesDirect )
+      {
+         C6502::MAPREAD ( 0x8000+(bank<<UPSHIFT_8KB), MEM_8KB, memory );
+      }
+   }
+   // Rebuild the cartridge's part of the CPU's page table from scratch.
+   static void MAPCPUPAGES ( void );
    static inline uint32_t EXRAMABSADDR ( uint32_t addr )
    {
       return (addr%MEM_1KB);
    }
    static inline uint32_t EXRAM ( uint32_t addr )
    {
-      return *(m_EXRAMmemory+(addr-EXRAM_START));
+      return *(m_state->m_EXRAMmemory+(addr-EXRAM_START));
    }
    static inline void EXRAM ( uint32_t addr, uint8_t data )
    {
-      *(m_EXRAMmemory+(addr-EXRAM_START)) = data;
+      *(m_state->m_EXRAMmemory+(addr-EXRAM_START)) = data;
    }
    static inline uint32_t VRAM ( uint32_t addr )
    {
-      return *(m_VRAMmemory+(addr-VRAM_START));
+      return *(m_state->m_VRAMmemory+(addr-VRAM_START));
    }
    static inline void VRAM ( uint32_t addr, uint8_t data )
    {
-      *(m_VRAMmemory+(addr-VRAM_START)) = data;
+      *(m_state->m_VRAMmemory+(addr-VRAM_START)) = data;
    }
    static inline void REMAPVRAM ( uint32_t bank, uint32_t newBank )
    {
-      m_pVRAMmemory[bank] = m_VRAMmemory+(newBank*MEM_1KB);
+      m_state->m_pVRAMmemory[bank] = m_state->m_VRAMmemory+(newBank*MEM_1KB);
    }
 
    // Mapper interfaces [called by emulator through mapperfunc array]
@@ -154,7 +179,7 @@ public:
    static void RESET ( uint32_t mapper, bool soft );
    static uint32_t MAPPER ( void )
    {
-      return m_mapper;
+      return m_state->m_mapper;
    }
    static uint32_t HMAPPER ( uint32_t addr )
    {
@@ -165,6 +190,11 @@ public:
    static void LMAPPER ( uint32_t addr, uint8_t data);
    static void SYNCPPU ( uint32_t, uint32_t ) {}
    static void SYNCCPU ( void ) {}
+   static uint32_t CPUIDLE ( void )
+   {
+      return MAPPER_IDLE_FOREVER;
+   }
+   static void SKIPCPU ( uint32_t ) {}
    static uint32_t DEBUGINFO ( uint32_t addr )
    {
       return PRGROM(addr);
@@ -178,72 +208,76 @@ public:
    // Code/Data logger support functions
    static inline CCodeDataLogger* LOGGERVIRT ( uint32_t addr )
    {
-      return *(m_pLogger+PRGBANK_PHYS(addr));
+      return *(m_state->m_pLogger+PRGBANK_PHYS(addr));
    }
    static inline CCodeDataLogger* SRAMLOGGERVIRT ( uint32_t addr )
    {
-      return *(m_pSRAMLogger+SRAMBANK_PHYS(addr));
+      return *(m_state->m_pSRAMLogger+SRAMBANK_PHYS(addr));
    }
    static inline CCodeDataLogger* LOGGERPHYS ( uint32_t addr )
    {
-      return *(m_pLogger+PRGBANK_ABSBANK(addr));
+      return *(m_state->m_pLogger+PRGBANK_ABSBANK(addr));
    }
    static inline CCodeDataLogger* SRAMLOGGERPHYS ( uint32_t addr )
    {
-      return *(m_pSRAMLogger+SRAMBANK_ABSBANK(addr));
+      return *(m_state->m_pSRAMLogger+SRAMBANK_ABSBANK(addr));
    }
    static inline CCodeDataLogger* EXRAMLOGGER ()
    {
-      return m_pEXRAMLogger;
+      return m_state->m_pEXRAMLogger;
    }
 
    // Support functions for inline disassembly in PRG-ROM, SRAM, and EXRAM
    static inline void PRGROMOPCODEMASK ( uint32_t addr, uint8_t mask )
    {
-      if ( (*(*(m_PRGROMopcodeMask+PRGBANK_PHYS(addr))+PRGBANK_OFF(addr))) != mask )
+      if ( (*(*(m_state->m_PRGROMopcodeMask+PRGBANK_PHYS(addr))+PRGBANK_OFF(addr))) != mask )
       {
-         *(m_PRGROMopcodeMaskDirty+PRGBANK_PHYS(addr)) = true;
+         C6502::DISASSEMBLYDIRTY ( m_state->m_PRGROMdisassemblyState+PRGBANK_PHYS(addr), PRGBANK_OFF(addr), PRGBANK_OFF(addr) );
       }
-      *(*(m_PRGROMopcodeMask+PRGBANK_PHYS(addr))+PRGBANK_OFF(addr)) = mask;
+      *(*(m_state->m_PRGROMopcodeMask+PRGBANK_PHYS(addr))+PRGBANK_OFF(addr)) = mask;
    }
    static inline void PRGROMOPCODEMASKATABSADDR ( uint32_t absAddr, uint8_t mask )
    {
-      *(*(m_PRGROMopcodeMask+PRGBANK_ABSBANK(absAddr))+PRGBANK_OFF(absAddr)) = mask;
+      if ( (*(*(m_state->m_PRGROMopcodeMask+PRGBANK_ABSBANK(absAddr))+PRGBANK_OFF(absAddr))) != mask )
+      {
+         C6502::DISASSEMBLYDIRTY ( m_state->m_PRGROMdisassemblyState+PRGBANK_ABSBANK(absAddr), PRGBANK_OFF(absAddr), PRGBANK_OFF(absAddr) );
+      }
+      *(*(m_state->m_PRGROMopcodeMask+PRGBANK_ABSBANK(absAddr))+PRGBANK_OFF(absAddr)) = mask;
    }
    static inline void PRGROMOPCODEMASKCLR ( void )
    {
       int32_t idx1;
       int32_t idx2;
-      for ( idx1 = 0; idx1 < NUM_ROM_BANKS; idx1++ )
+      for ( idx1 = 0; idx1 < (int32_t)m_state->m_numPrgBanksAllocated; idx1++ )
       {
          for ( idx2 = 0; idx2 < MEM_8KB; idx2++ )
          {
-            m_PRGROMopcodeMask[idx1][idx2] = 0;
+            m_state->m_PRGROMopcodeMask[idx1][idx2] = 0;
          }
-         m_PRGROMopcodeMaskDirty[idx1] = true;
+         C6502::DISASSEMBLYDIRTY ( m_state->m_PRGROMdisassemblyState+idx1, 0, MEM_8KB-1 );
       }
    }
-   static inline char* PRGROMDISASSEMBLY ( uint32_t addr )
+   static inline DisassemblyInfo* PRGROMDISASSEMBLY ( uint32_t addr )
    {
-      return *(*(m_PRGROMdisassembly+PRGBANK_PHYS(addr))+PRGBANK_OFF(addr));
+      return (*(m_state->m_PRGROMdisassembly+PRGBANK_PHYS(addr)))+PRGBANK_OFF(addr);
    }
    static inline char* PRGROMDISASSEMBLYATABSADDR ( uint32_t absAddr, char* buffer )
    {
-      return C6502::Disassemble((*(m_PRGROMmemory+PRGBANK_ABSBANK(absAddr))+PRGBANK_OFF(absAddr)),buffer);
+      return C6502::Disassemble((*(m_state->m_PRGROMmemory+PRGBANK_ABSBANK(absAddr))+PRGBANK_OFF(absAddr)),buffer);
    }
    static uint32_t PRGROMSLOC2ADDR ( uint16_t sloc );
    static uint16_t PRGROMADDR2SLOC ( uint32_t addr );
    static inline uint32_t PRGROMSLOC ( uint32_t addr )
    {
-      return *(m_PRGROMsloc+PRGBANK_PHYS(addr));
+      return *(m_state->m_PRGROMsloc+PRGBANK_PHYS(addr));
    }
    static inline void SRAMOPCODEMASK ( uint32_t addr, uint8_t mask )
    {
-      if ( (*(*(m_SRAMopcodeMask+SRAMBANK_PHYS(addr))+SRAMBANK_OFF(addr))) != mask )
+      if ( (*(*(m_state->m_SRAMopcodeMask+SRAMBANK_PHYS(addr))+SRAMBANK_OFF(addr))) != mask )
       {
-         *(m_SRAMopcodeMaskDirty+SRAMBANK_PHYS(addr)) = true;
+         C6502::DISASSEMBLYDIRTY ( m_state->m_SRAMdisassemblyState+SRAMBANK_PHYS(addr), SRAMBANK_OFF(addr), SRAMBANK_OFF(addr) );
       }
-      *(*(m_SRAMopcodeMask+SRAMBANK_PHYS(addr))+SRAMBANK_OFF(addr)) = mask;
+      *(*(m_state->m_SRAMopcodeMask+SRAMBANK_PHYS(addr))+SRAMBANK_OFF(addr)) = mask;
    }
    static inline void SRAMOPCODEMASKCLR ( void )
    {
@@ -253,50 +287,51 @@ public:
       {
          for ( idx2 = 0; idx2 < MEM_8KB; idx2++ )
          {
-            m_SRAMopcodeMask[idx1][idx2] = 0;
+            m_state->m_SRAMopcodeMask[idx1][idx2] = 0;
          }
-         m_SRAMopcodeMaskDirty[idx1] = true;
+         C6502::DISASSEMBLYDIRTY ( m_state->m_SRAMdisassemblyState+idx1, 0, MEM_8KB-1 );
       }
    }
-   static inline char* SRAMDISASSEMBLY ( uint32_t addr )
+   static inline DisassemblyInfo* SRAMDISASSEMBLY ( uint32_t addr )
    {
-      return *(*(m_SRAMdisassembly+SRAMBANK_PHYS(addr))+SRAMBANK_OFF(addr));
+      return (*(m_state->m_SRAMdisassembly+SRAMBANK_PHYS(addr)))+SRAMBANK_OFF(addr);
    }
    static uint32_t SRAMSLOC2ADDR ( uint16_t sloc );
    static uint16_t SRAMADDR2SLOC ( uint32_t addr );
    static inline uint32_t SRAMSLOC ( uint32_t addr)
    {
-      return *(m_SRAMsloc+SRAMBANK_PHYS(addr));
+      return *(m_state->m_SRAMsloc+SRAMBANK_PHYS(addr));
    }
-   static bool SRAMDIRTY() { return m_SRAMdirty; }
+   static bool SRAMDIRTY() { return m_state->m_SRAMdirty; }
    static inline void EXRAMOPCODEMASK ( uint32_t addr, uint8_t mask )
    {
-      if ( (*(m_EXRAMopcodeMask+(addr-0x5C00))) != mask )
+      if ( (*(m_state->m_EXRAMopcodeMask+(addr-0x5C00))) != mask )
       {
-         m_EXRAMopcodeMaskDirty = true;
+         C6502::DISASSEMBLYDIRTY ( &(m_state->m_EXRAMdisassemblyState), addr-0x5C00, addr-0x5C00 );
       }
-      *(m_EXRAMopcodeMask+(addr-0x5C00)) = mask;
+      *(m_state->m_EXRAMopcodeMask+(addr-0x5C00)) = mask;
    }
    static inline void EXRAMOPCODEMASKCLR ( void )
    {
       int32_t idx2;
       for ( idx2 = 0; idx2 < MEM_1KB; idx2++ )
       {
-         m_EXRAMopcodeMask[idx2] = 0;
+         m_state->m_EXRAMopcodeMask[idx2] = 0;
       }
-      m_EXRAMopcodeMaskDirty = true;
+      C6502::DISASSEMBLYDIRTY ( &(m_state->m_EXRAMdisassemblyState), 0, MEM_1KB-1 );
    }
-   static inline char* EXRAMDISASSEMBLY ( uint32_t addr )
+   static inline DisassemblyInfo* EXRAMDISASSEMBLY ( uint32_t addr )
    {
-      return *(m_EXRAMdisassembly+(addr-0x5C00));
+      return m_state->m_EXRAMdisassembly+(addr-0x5C00);
    }
    static uint32_t EXRAMSLOC2ADDR ( uint16_t sloc );
    static uint16_t EXRAMADDR2SLOC ( uint32_t addr );
    static inline uint32_t EXRAMSLOC ()
    {
-      return m_EXRAMsloc;
+      return m_state->m_EXRAMsloc;
    }
    static void DISASSEMBLE ();
+   static void DISASSEMBLYCHANGES ( uint32_t addr, DisassemblyState* pView );
 
    // Breakpoint support functions
    static CBreakpointEventInfo** BREAKPOINTEVENTS()
@@ -311,7 +346,7 @@ public:
    // Debug register display interfaces
    static inline CRegisterDatabase* REGISTERS ( void )
    {
-      return m_dbRegisters;
+      return m_state->m_dbRegisters;
    }
 
    static inline CMemoryDatabase* PRGROMMEMORY ( void )
@@ -340,26 +375,80 @@ public:
    }
 
 protected:
-   static uint8_t**  m_PRGROMmemory;
-   static uint8_t**  m_CHRmemory;
-   static uint8_t**  m_SRAMmemory;
-   static uint8_t*   m_EXRAMmemory;
-   static uint8_t*   m_VRAMmemory;
-
-   // Mapper stuff...
-   static uint32_t           m_mapper;
-   static uint32_t           m_numPrgBanks;
-   static uint32_t           m_numChrBanks;
-   static uint8_t* m_pPRGROMmemory [ 4 ];
-   static uint8_t* m_pCHRmemory [ 8 ];
-   static uint8_t* m_pSRAMmemory [ 5 ];
-   static uint8_t* m_pVRAMmemory [ 8 ];
-
-   static CCodeDataLogger* m_pLogger [ NUM_ROM_BANKS ];
-   static CCodeDataLogger* m_pEXRAMLogger;
-   static CCodeDataLogger* m_pSRAMLogger [ NUM_SRAM_BANKS ];
-
-   static CRegisterDatabase* m_dbRegisters;
+   // Give PRG-ROM (with its debugger tables) or CHR memory exactly this
+   // many banks of their own and point the rest of the bank tables at
+   // them.
+   static void ALLOCATEPRGBANKS ( uint32_t banks );
+   static void ALLOCATECHRBANKS ( uint32_t banks );
+
+   // The CHR-RAM banks above the largest CHR-ROM, for mappers that have
+   // CHR-RAM alongside CHR-ROM (N106).  Until a mapper allocates them
+   // those table entries mirror the CHR banks like the rest; changing
+   // cartridge frees them.
+   static void ALLOCATECHREXTRABANKS ( void );
+   static void FREECHREXTRABANKS ( void );
+
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      uint8_t** m_PRGROMmemory = NULL;
+      uint8_t** m_CHRmemory = NULL;
+      uint8_t** m_SRAMmemory = NULL;
+      uint8_t* m_EXRAMmemory = NULL;
+      uint8_t* m_VRAMmemory = NULL;
+
+      // Mapper stuff...
+      uint32_t m_mapper = 0;
+      uint32_t m_numPrgBanks = 0;
+      uint32_t m_numChrBanks = 0;
+
+      // Banks with memory of their own.  The bank tables always have
+      // NUM_ROM_BANKS (PRG-ROM memory PRGROM_STATE_ALIASES) and
+      // NUM_CHR_BANKS entries because mappers index them straight from
+      // their registers; entries past the banks that exist mirror them,
+      // as the cartridge's address lines would.  The extra CHR-RAM banks
+      // above the largest CHR-ROM exist only for mappers that use them.
+      uint32_t m_numPrgBanksAllocated = 0;
+      uint32_t m_numChrBanksAllocated = 0;
+      bool m_chrExtraBanksAllocated = false;
+      uint8_t* m_pPRGROMmemory [ 4 ] = { NULL, NULL, NULL, NULL };
+      uint8_t* m_pCHRmemory [ 8 ] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+      uint8_t* m_pSRAMmemory [ 5 ] = { NULL, NULL, NULL, NULL, NULL };
+      uint8_t* m_pVRAMmemory [ 8 ] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+      CCodeDataLogger* m_pLogger [ NUM_ROM_BANKS ] = { NULL, };
+      CCodeDataLogger* m_pEXRAMLogger = NULL;
+      CCodeDataLogger* m_pSRAMLogger [ NUM_SRAM_BANKS ] = { NULL, };
+      uint8_t** m_PRGROMopcodeMask = NULL;
+      DisassemblyState* m_PRGROMdisassemblyState = NULL;
+      DisassemblyInfo** m_PRGROMdisassembly = NULL;
+      uint16_t** m_PRGROMsloc2addr = NULL;
+      uint16_t** m_PRGROMaddr2sloc = NULL;
+      uint32_t* m_PRGROMsloc = NULL;
+      uint8_t** m_SRAMopcodeMask = NULL;
+      DisassemblyState* m_SRAMdisassemblyState = NULL;
+      DisassemblyInfo** m_SRAMdisassembly = NULL;
+      uint16_t** m_SRAMsloc2addr = NULL;
+      uint16_t** m_SRAMaddr2sloc = NULL;
+      uint32_t* m_SRAMsloc = NULL;
+      bool m_SRAMdirty = false;
+
+      // Whether the mapper reads PRG-ROM and SRAM the default way, so
+      // the CPU may read them through its page table.
+      bool m_PRGpagesDirect = false;
+      bool m_SRAMpagesDirect = false;
+      uint8_t* m_EXRAMopcodeMask = NULL;
+      DisassemblyState m_EXRAMdisassemblyState;
+      DisassemblyInfo* m_EXRAMdisassembly = NULL;
+      uint16_t* m_EXRAMsloc2addr = NULL;
+      uint16_t* m_EXRAMaddr2sloc = NULL;
+      uint32_t m_EXRAMsloc = 0;
+
+      // The active mapper's register database.
+      CRegisterDatabase* m_dbRegisters = NULL;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 
    static CMemoryDatabase* m_dbPRGROMMemory;
    static CMemoryDatabase* m_dbSRAMMemory;
@@ -370,27 +459,6 @@ protected:
    static CBreakpointEventInfo** m_tblBreakpointEvents;
    static int32_t                    m_numBreakpointEvents;
 
-   static uint8_t**  m_PRGROMopcodeMask;
-   static bool*      m_PRGROMopcodeMaskDirty;
-   static char***    m_PRGROMdisassembly;
-   static uint16_t** m_PRGROMsloc2addr;
-   static uint16_t** m_PRGROMaddr2sloc;
-   static uint32_t*  m_PRGROMsloc;
-
-   static uint8_t**  m_SRAMopcodeMask;
-   static bool*      m_SRAMopcodeMaskDirty;
-   static char***    m_SRAMdisassembly;
-   static uint16_t** m_SRAMsloc2addr;
-   static uint16_t** m_SRAMaddr2sloc;
-   static uint32_t*  m_SRAMsloc;
-   static bool       m_SRAMdirty;
-
-   static uint8_t*  m_EXRAMopcodeMask;
-   static bool     m_EXRAMopcodeMaskDirty;
-   static char**          m_EXRAMdisassembly;
-   static uint16_t* m_EXRAMsloc2addr;
-   static uint16_t* m_EXRAMaddr2sloc;
-   static uint32_t   m_EXRAMsloc;
 };
 
 #endif
@@ -64,13 +64,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,4,4,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper001::m_reg [] = { 0x0C, 0x00, 0x00, 0x00 };
-uint8_t  CROMMapper001::m_regdef [] = { 0x0C, 0x00, 0x00, 0x00 };
-uint8_t  CROMMapper001::m_sr = 0x00;
-uint8_t  CROMMapper001::m_sel = 0x00;
-uint8_t  CROMMapper001::m_srCount = 0;
-uint32_t CROMMapper001::m_cpuCycleOfLastWrite = 0xFFFFFFFF;
-uint32_t CROMMapper001::m_cpuCycle = 0xFFFFFFFF;
+CROMMapper001::State CROMMapper001::m_defaultState;
+thread_local CROMMapper001::State* CROMMapper001::m_state = &CROMMapper001::m_defaultState;
 
 CROMMapper001::CROMMapper001()
 {
@@ -84,27 +79,27 @@ void CROMMapper001::RESET ( bool soft )
 {
    int32_t idx;
 
-   m_mapper = 1;
+   CROM::m_state->m_mapper = 1;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
-   m_sr = 0;
-   m_srCount = 0;
+   m_state->m_sr = 0;
+   m_state->m_srCount = 0;
 
-   m_cpuCycleOfLastWrite = 0xFFFFFFFF;
-   m_cpuCycle = 0xFFFFFFFF;
+   m_state->m_cpuCycleOfLastWrite = 0xFFFFFFFF;
+   m_state->m_cpuCycle = 0xFFFFFFFF;
 
    for ( idx = 0; idx < 4; idx++ )
    {
-      m_reg [ idx ] = m_regdef [ idx ];
+      m_state->m_reg [ idx ] = m_state->m_regdef [ idx ];
    }
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
@@ -112,12 +107,22 @@ void CROMMapper001::RESET ( bool soft )
 void CROMMapper001::SYNCCPU()
 {
    // This may not be the actual CPU cycle but it doesn't matter.
-   m_cpuCycle++;
+   m_state->m_cpuCycle++;
+}
+
+uint32_t CROMMapper001::CPUIDLE ( void )
+{
+   return MAPPER_IDLE_FOREVER;
+}
+
+void CROMMapper001::SKIPCPU ( uint32_t cycles )
+{
+   m_state->m_cpuCycle += cycles;
 }
 
 uint32_t CROMMapper001::DEBUGINFO ( uint32_t addr )
 {
-   return m_reg [ (addr-MEM_32KB)/MEM_8KB ];
+   return m_state->m_reg [ (addr-MEM_32KB)/MEM_8KB ];
 }
 
 void CROMMapper001::HMAPPER ( uint32_t addr, uint8_t data )
@@ -125,43 +130,43 @@ void CROMMapper001::HMAPPER ( uint32_t addr, uint8_t data )
    uint8_t bank = 0;
 
    // Discard this write if it's immediately following another write.
-   if ( m_cpuCycle == m_cpuCycleOfLastWrite+1 )
+   if ( m_state->m_cpuCycle == m_state->m_cpuCycleOfLastWrite+1 )
    {
       return;
    }
 
    // Keep track of when we last wrote.
-   m_cpuCycleOfLastWrite = m_cpuCycle;
+   m_state->m_cpuCycleOfLastWrite = m_state->m_cpuCycle;
 
    // Shift bits into registers...
    if ( data&0x80 )
    {
-      m_sr = 0x00;
-      m_srCount = 0;
-      m_reg [ 0 ] |= m_regdef [ 0 ];
-      m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-      m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+      m_state->m_sr = 0x00;
+      m_state->m_srCount = 0;
+      m_state->m_reg [ 0 ] |= m_state->m_regdef [ 0 ];
+      CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+      CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
    }
    else
    {
-      m_sr>>=1;
-      m_sr|=((data&0x01)<<4);
-      m_srCount++;
+      m_state->m_sr>>=1;
+      m_state->m_sr|=((data&0x01)<<4);
+      m_state->m_srCount++;
 
-      if ( m_srCount == 5 )
+      if ( m_state->m_srCount == 5 )
       {
-         m_sel = (addr-0x8000)/0x2000;
-         m_reg [ m_sel ] = m_sr;
-         m_srCount = 0;
+         m_state->m_sel = (addr-0x8000)/0x2000;
+         m_state->m_reg [ m_state->m_sel ] = m_state->m_sr;
+         m_state->m_srCount = 0;
 
          // Act on new register content...
-         switch ( m_sel )
+         switch ( m_state->m_sel )
          {
             case 0:
 
-               if ( m_reg[0]&0x02 )
+               if ( m_state->m_reg[0]&0x02 )
                {
-                  if ( m_reg[0]&0x01 )
+                  if ( m_state->m_reg[0]&0x01 )
                   {
                      CPPU::MIRRORHORIZ ();
                   }
@@ -172,93 +177,93 @@ void CROMMapper001::HMAPPER ( uint32_t addr, uint8_t data )
                }
                else
                {
-                  CPPU::MIRROR ( m_reg[0]&0x01 );
+                  CPPU::MIRROR ( m_state->m_reg[0]&0x01 );
                }
 
                break;
             case 1:
 
-               if ( m_numChrBanks > 0 )
+               if ( CROM::m_state->m_numChrBanks > 0 )
                {
-                  if ( m_reg[0]&0x10 )
+                  if ( m_state->m_reg[0]&0x10 )
                   {
-                     m_pCHRmemory [ 0 ] = m_CHRmemory [ ((m_reg[1]&0x1F)<<2)+0 ];
-                     m_pCHRmemory [ 1 ] = m_CHRmemory [ ((m_reg[1]&0x1F)<<2)+1 ];
-                     m_pCHRmemory [ 2 ] = m_CHRmemory [ ((m_reg[1]&0x1F)<<2)+2 ];
-                     m_pCHRmemory [ 3 ] = m_CHRmemory [ ((m_reg[1]&0x1F)<<2)+3 ];
+                     CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ ((m_state->m_reg[1]&0x1F)<<2)+0 ];
+                     CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ ((m_state->m_reg[1]&0x1F)<<2)+1 ];
+                     CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ ((m_state->m_reg[1]&0x1F)<<2)+2 ];
+                     CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ ((m_state->m_reg[1]&0x1F)<<2)+3 ];
                   }
                   else
                   {
-                     m_pCHRmemory [ 0 ] = m_CHRmemory [ ((m_reg[1]&0x1F)<<2)+0 ];
-                     m_pCHRmemory [ 1 ] = m_CHRmemory [ ((m_reg[1]&0x1F)<<2)+1 ];
-                     m_pCHRmemory [ 2 ] = m_CHRmemory [ ((m_reg[1]&0x1F)<<2)+2 ];
-                     m_pCHRmemory [ 3 ] = m_CHRmemory [ ((m_reg[1]&0x1F)<<2)+3 ];
-                     m_pCHRmemory [ 4 ] = m_CHRmemory [ ((m_reg[1]&0x1F)<<2)+4 ];
-                     m_pCHRmemory [ 5 ] = m_CHRmemory [ ((m_reg[1]&0x1F)<<2)+5 ];
-                     m_pCHRmemory [ 6 ] = m_CHRmemory [ ((m_reg[1]&0x1F)<<2)+6 ];
-                     m_pCHRmemory [ 7 ] = m_CHRmemory [ ((m_reg[1]&0x1F)<<2)+7 ];
+                     CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ ((m_state->m_reg[1]&0x1F)<<2)+0 ];
+                     CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ ((m_state->m_reg[1]&0x1F)<<2)+1 ];
+                     CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ ((m_state->m_reg[1]&0x1F)<<2)+2 ];
+                     CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ ((m_state->m_reg[1]&0x1F)<<2)+3 ];
+                     CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ ((m_state->m_reg[1]&0x1F)<<2)+4 ];
+                     CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ ((m_state->m_reg[1]&0x1F)<<2)+5 ];
+                     CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ ((m_state->m_reg[1]&0x1F)<<2)+6 ];
+                     CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ ((m_state->m_reg[1]&0x1F)<<2)+7 ];
                   }
                }
                else
                {
-                  if ( m_reg[0]&0x10 )
+                  if ( m_state->m_reg[0]&0x10 )
                   {
-                     m_pCHRmemory [ 0 ] = m_CHRmemory [ 0 ];
-                     m_pCHRmemory [ 1 ] = m_CHRmemory [ 1 ];
-                     m_pCHRmemory [ 2 ] = m_CHRmemory [ 2 ];
-                     m_pCHRmemory [ 3 ] = m_CHRmemory [ 3 ];
+                     CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ 0 ];
+                     CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ 1 ];
+                     CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ 2 ];
+                     CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ 3 ];
                   }
                }
 
                break;
             case 2:
 
-               if ( m_numChrBanks > 0 )
+               if ( CROM::m_state->m_numChrBanks > 0 )
                {
-                  if ( m_reg[0]&0x10 )
+                  if ( m_state->m_reg[0]&0x10 )
                   {
-                     m_pCHRmemory [ 4 ] = m_CHRmemory [ ((m_reg[2]&0x1F)<<2)+0 ];
-                     m_pCHRmemory [ 5 ] = m_CHRmemory [ ((m_reg[2]&0x1F)<<2)+1 ];
-                     m_pCHRmemory [ 6 ] = m_CHRmemory [ ((m_reg[2]&0x1F)<<2)+2 ];
-                     m_pCHRmemory [ 7 ] = m_CHRmemory [ ((m_reg[2]&0x1F)<<2)+3 ];
+                     CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ ((m_state->m_reg[2]&0x1F)<<2)+0 ];
+                     CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ ((m_state->m_reg[2]&0x1F)<<2)+1 ];
+                     CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ ((m_state->m_reg[2]&0x1F)<<2)+2 ];
+                     CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ ((m_state->m_reg[2]&0x1F)<<2)+3 ];
                   }
                }
                else
                {
-                  if ( m_reg[0]&0x10 )
+                  if ( m_state->m_reg[0]&0x10 )
                   {
-                     m_pCHRmemory [ 4 ] = m_CHRmemory [ 4 ];
-                     m_pCHRmemory [ 5 ] = m_CHRmemory [ 5 ];
-                     m_pCHRmemory [ 6 ] = m_CHRmemory [ 6 ];
-                     m_pCHRmemory [ 7 ] = m_CHRmemory [ 7 ];
+                     CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ 4 ];
+                     CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ 5 ];
+                     CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ 6 ];
+                     CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ 7 ];
                   }
                }
 
                break;
             case 3:
 
-               if ( m_reg[0]&0x08 )
+               if ( m_state->m_reg[0]&0x08 )
                {
-                  bank = (m_reg[3]&0x0F)<<1;
+                  bank = (m_state->m_reg[3]&0x0F)<<1;
 
-                  if ( m_reg[0]&0x04 )
+                  if ( m_state->m_reg[0]&0x04 )
                   {
-                     m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ bank ];
-                     m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ bank+1 ];
+                     CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ bank ] );
+                     CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ bank+1 ] );
                   }
                   else
                   {
-                     m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ bank ];
-                     m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ bank+1 ];
+                     CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ bank ] );
+                     CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ bank+1 ] );
                   }
                }
                else
                {
-                  bank = m_reg[3]&0x0F;
-                  m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ bank ];
-                  m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ bank+1 ];
-                  m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ bank+2 ];
-                  m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ bank+3 ];
+                  bank = m_state->m_reg[3]&0x0F;
+                  CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ bank ] );
+                  CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ bank+1 ] );
+                  CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ bank+2 ] );
+                  CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ bank+3 ] );
                }
 
                break;
@@ -268,7 +273,7 @@ void CROMMapper001::HMAPPER ( uint32_t addr, uint8_t data )
          {
             // Check mapper state breakpoints...
             // m_sel is convenient register number...
-            CNES::CHECKBREAKPOINT(eBreakInMapper,eBreakOnMapperState,m_sel);
+            CNES::CHECKBREAKPOINT(eBreakInMapper,eBreakOnMapperState,m_state->m_sel);
          }
       }
    }
@@ -12,28 +12,37 @@ public:
    static void RESET ( bool soft );
    static void HMAPPER ( uint32_t addr, uint8_t data );
    static void SYNCCPU ( void );
+   static uint32_t CPUIDLE ( void );
+   static void SKIPCPU ( uint32_t cycles );
    static uint32_t DEBUGINFO ( uint32_t addr );
 
    // Internal accessors for mapper information inspector...
    // Note: called directly!
    static uint32_t SHIFTREGISTER ( void )
    {
-      return m_sr;
+      return m_state->m_sr;
    }
    static uint32_t SHIFTREGISTERBIT ( void )
    {
-      return m_srCount;
+      return m_state->m_srCount;
    }
 
 protected:
-   // MMC1
-   static uint8_t  m_reg [ 4 ];
-   static uint8_t  m_regdef [ 4 ];
-   static uint8_t  m_sr;
-   static uint8_t  m_sel;
-   static uint8_t  m_srCount;
-   static uint32_t m_cpuCycleOfLastWrite;
-   static uint32_t m_cpuCycle;
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      // MMC1
+      uint8_t m_reg [ 4 ] = { 0x0C, 0x00, 0x00, 0x00 };
+      uint8_t m_regdef [ 4 ] = { 0x0C, 0x00, 0x00, 0x00 };
+      uint8_t m_sr = 0x00;
+      uint8_t m_sel = 0x00;
+      uint8_t m_srCount = 0;
+      uint32_t m_cpuCycleOfLastWrite = 0xFFFFFFFF;
+      uint32_t m_cpuCycle = 0xFFFFFFFF;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 };
 
 #endif
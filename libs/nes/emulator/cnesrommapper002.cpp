@@ -41,7 +41,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,1,1,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper002::m_reg = 0x00;
+CROMMapper002::State CROMMapper002::m_defaultState;
+thread_local CROMMapper002::State* CROMMapper002::m_state = &CROMMapper002::m_defaultState;
 
 CROMMapper002::CROMMapper002()
 {
@@ -53,35 +54,35 @@ CROMMapper002::~CROMMapper002()
 
 void CROMMapper002::RESET ( bool soft )
 {
-   m_mapper = 2;
+   CROM::m_state->m_mapper = 2;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
 
 uint32_t CROMMapper002::DEBUGINFO ( uint32_t addr )
 {
-   return m_reg;
+   return m_state->m_reg;
 }
 
 void CROMMapper002::HMAPPER ( uint32_t addr, uint8_t data )
 {
    uint8_t bank;
 
-   m_reg = data%m_numPrgBanks;
+   m_state->m_reg = data%CROM::m_state->m_numPrgBanks;
 
-   bank = m_reg<<1;
+   bank = m_state->m_reg<<1;
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ bank ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ bank+1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ bank ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ bank+1 ] );
 
    if ( nesIsDebuggable() )
    {
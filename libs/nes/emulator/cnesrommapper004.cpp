@@ -88,17 +88,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,8,8,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper004::m_reg [] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
-bool           CROMMapper004::m_irqAsserted = false;
-uint8_t  CROMMapper004::m_irqCounter = 0x00;
-uint8_t  CROMMapper004::m_irqLatch = 0x00;
-bool           CROMMapper004::m_irqEnable = false;
-bool           CROMMapper004::m_irqReload = false;
-uint8_t  CROMMapper004::m_prg [ 2 ] = { 0, 0 };
-uint8_t  CROMMapper004::m_chr [ 8 ] = { 0, 0, 0, 0, 0, 0, 0, 0 };
-
-uint32_t   CROMMapper004::m_lastPPUAddrA12 = 0;
-uint32_t   CROMMapper004::m_lastPPUCycle = 0;
+CROMMapper004::State CROMMapper004::m_defaultState;
+thread_local CROMMapper004::State* CROMMapper004::m_state = &CROMMapper004::m_defaultState;
 
 CROMMapper004::CROMMapper004()
 {
@@ -112,32 +103,32 @@ void CROMMapper004::RESET ( bool soft )
 {
    int32_t idx;
 
-   m_mapper = 4;
+   CROM::m_state->m_mapper = 4;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
    for ( idx = 0; idx < 8; idx++ )
    {
-      m_reg [ idx ] = 0x00;
-      m_chr [ idx ] = 0;
+      m_state->m_reg [ idx ] = 0x00;
+      m_state->m_chr [ idx ] = 0;
    }
 
-   m_prg [ 0 ] = 0;
-   m_prg [ 1 ] = 0;
-   m_irqCounter = 0x00;
-   m_irqLatch = 0x00;
-   m_irqEnable = false;
-   m_irqAsserted = false;
+   m_state->m_prg [ 0 ] = 0;
+   m_state->m_prg [ 1 ] = 0;
+   m_state->m_irqCounter = 0x00;
+   m_state->m_irqLatch = 0x00;
+   m_state->m_irqEnable = false;
+   m_state->m_irqAsserted = false;
 
-   m_lastPPUCycle = 0;
-   m_lastPPUAddrA12 = 0;
+   m_state->m_lastPPUCycle = 0;
+   m_state->m_lastPPUAddrA12 = 0;
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
@@ -150,53 +141,53 @@ void CROMMapper004::SYNCPPU ( uint32_t ppuCycle, uint32_t ppuAddr )
 
    // Determine if clocked...rising edge more than 11 cycles
    // after the last one.
-   if ( (m_lastPPUAddrA12 == 0x0000) &&
+   if ( (m_state->m_lastPPUAddrA12 == 0x0000) &&
          (ppuAddrA12 == 0x1000) )
    {
       clockIt = true;
    }
 
    // Update PPU watching variables on rising edge...
-   m_lastPPUAddrA12 = ppuAddrA12;
+   m_state->m_lastPPUAddrA12 = ppuAddrA12;
 
    if ( clockIt )
    {
-      if ( (ppuCycle-m_lastPPUCycle) < 12 )
+      if ( (ppuCycle-m_state->m_lastPPUCycle) < 12 )
       {
          clockIt = false;
       }
 
-      m_lastPPUCycle = ppuCycle;
+      m_state->m_lastPPUCycle = ppuCycle;
    }
 
    // Clock the IRQ counter if needed...
    if ( clockIt )
    {
-      if ( m_irqReload )
+      if ( m_state->m_irqReload )
       {
-         m_irqCounter = m_irqLatch;
-         m_irqReload = false;
+         m_state->m_irqCounter = m_state->m_irqLatch;
+         m_state->m_irqReload = false;
 
-         if ( m_irqCounter == 0 )
+         if ( m_state->m_irqCounter == 0 )
          {
             zero = true;
          }
       }
       else
       {
-         m_irqCounter--;
+         m_state->m_irqCounter--;
 
-         if ( m_irqCounter == 0 )
+         if ( m_state->m_irqCounter == 0 )
          {
-            m_irqReload = true;
+            m_state->m_irqReload = true;
             zero = true;
          }
       }
 
-      if ( m_irqEnable && zero )
+      if ( m_state->m_irqEnable && zero )
       {
          C6502::ASSERTIRQ ( eNESSource_Mapper );
-         m_irqAsserted = true;
+         m_state->m_irqAsserted = true;
 
          if ( nesIsDebuggable() )
          {
@@ -209,57 +200,57 @@ void CROMMapper004::SYNCPPU ( uint32_t ppuCycle, uint32_t ppuAddr )
 
 void CROMMapper004::SETCPU ( void )
 {
-   if ( m_reg[0]&0x40 )
+   if ( m_state->m_reg[0]&0x40 )
    {
-      m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-      m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ m_prg[1] ];
-      m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_prg[0] ];
-      m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+      CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+      CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ m_state->m_prg[1] ] );
+      CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ m_state->m_prg[0] ] );
+      CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
    }
    else
    {
-      m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ m_prg[0] ];
-      m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ m_prg[1] ];
-      m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-      m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+      CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ m_state->m_prg[0] ] );
+      CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ m_state->m_prg[1] ] );
+      CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+      CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
    }
 }
 
 void CROMMapper004::SETPPU ( void )
 {
-   if ( m_reg[0]&0x80 )
+   if ( m_state->m_reg[0]&0x80 )
    {
-      m_pCHRmemory [ 0 ] = m_CHRmemory [ m_chr[4] ];
-      m_pCHRmemory [ 1 ] = m_CHRmemory [ m_chr[5] ];
-      m_pCHRmemory [ 2 ] = m_CHRmemory [ m_chr[6] ];
-      m_pCHRmemory [ 3 ] = m_CHRmemory [ m_chr[7] ];
-      m_pCHRmemory [ 4 ] = m_CHRmemory [ m_chr[0] ];
-      m_pCHRmemory [ 5 ] = m_CHRmemory [ m_chr[1] ];
-      m_pCHRmemory [ 6 ] = m_CHRmemory [ m_chr[2] ];
-      m_pCHRmemory [ 7 ] = m_CHRmemory [ m_chr[3] ];
+      CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[4] ];
+      CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[5] ];
+      CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[6] ];
+      CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[7] ];
+      CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[0] ];
+      CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[1] ];
+      CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[2] ];
+      CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[3] ];
    }
    else
    {
-      m_pCHRmemory [ 0 ] = m_CHRmemory [ m_chr[0] ];
-      m_pCHRmemory [ 1 ] = m_CHRmemory [ m_chr[1] ];
-      m_pCHRmemory [ 2 ] = m_CHRmemory [ m_chr[2] ];
-      m_pCHRmemory [ 3 ] = m_CHRmemory [ m_chr[3] ];
-      m_pCHRmemory [ 4 ] = m_CHRmemory [ m_chr[4] ];
-      m_pCHRmemory [ 5 ] = m_CHRmemory [ m_chr[5] ];
-      m_pCHRmemory [ 6 ] = m_CHRmemory [ m_chr[6] ];
-      m_pCHRmemory [ 7 ] = m_CHRmemory [ m_chr[7] ];
+      CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[0] ];
+      CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[1] ];
+      CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[2] ];
+      CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[3] ];
+      CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[4] ];
+      CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[5] ];
+      CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[6] ];
+      CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[7] ];
    }
 }
 
 uint32_t CROMMapper004::DEBUGINFO ( uint32_t addr )
 {
-   return m_reg [ (((addr-MEM_32KB)/MEM_8KB)*2)+(addr&0x0001) ];
+   return m_state->m_reg [ (((addr-MEM_32KB)/MEM_8KB)*2)+(addr&0x0001) ];
 }
 
 void CROMMapper004::HMAPPER ( uint32_t addr, uint8_t data )
 {
    int32_t reg = (((addr-0x8000)/0x2000)*2)+(addr&0x0001);
-   m_reg [ reg ] = data;
+   m_state->m_reg [ reg ] = data;
 
    switch ( addr&0xE001 )
    {
@@ -269,40 +260,40 @@ void CROMMapper004::HMAPPER ( uint32_t addr, uint8_t data )
          break;
       case 0x8001:
 
-         switch ( m_reg[0]&0x7 )
+         switch ( m_state->m_reg[0]&0x7 )
          {
             case 0x00:
-               m_chr [ 0 ] = data&0xFE;
-               m_chr [ 1 ] = (data&0xFE)+1;
+               m_state->m_chr [ 0 ] = data&0xFE;
+               m_state->m_chr [ 1 ] = (data&0xFE)+1;
                SETPPU ();
                break;
             case 0x01:
-               m_chr [ 2 ] = data&0xFE;
-               m_chr [ 3 ] = (data&0xFE)+1;
+               m_state->m_chr [ 2 ] = data&0xFE;
+               m_state->m_chr [ 3 ] = (data&0xFE)+1;
                SETPPU ();
                break;
             case 0x02:
-               m_chr [ 4 ] = data;
+               m_state->m_chr [ 4 ] = data;
                SETPPU ();
                break;
             case 0x03:
-               m_chr [ 5 ] = data;
+               m_state->m_chr [ 5 ] = data;
                SETPPU ();
                break;
             case 0x04:
-               m_chr [ 6 ] = data;
+               m_state->m_chr [ 6 ] = data;
                SETPPU ();
                break;
             case 0x05:
-               m_chr [ 7 ] = data;
+               m_state->m_chr [ 7 ] = data;
                SETPPU ();
                break;
             case 0x06:
-               m_prg [ 0 ] = data%m_numPrgBanks;
+               m_state->m_prg [ 0 ] = data%CROM::m_state->m_numPrgBanks;
                SETCPU ();
                break;
             case 0x07:
-               m_prg [ 1 ] = data%m_numPrgBanks;
+               m_state->m_prg [ 1 ] = data%CROM::m_state->m_numPrgBanks;
                SETCPU ();
                break;
          }
@@ -326,18 +317,18 @@ void CROMMapper004::HMAPPER ( uint32_t addr, uint8_t data )
       case 0xA001:
          break;
       case 0xC000:
-         m_irqLatch = data;
+         m_state->m_irqLatch = data;
          break;
       case 0xC001:
-         m_irqReload = true;
+         m_state->m_irqReload = true;
          break;
       case 0xE000:
-         m_irqEnable = false;
+         m_state->m_irqEnable = false;
          C6502::RELEASEIRQ ( eNESSource_Mapper );
-         m_irqAsserted = false;
+         m_state->m_irqAsserted = false;
          break;
       case 0xE001:
-         m_irqEnable = true;
+         m_state->m_irqEnable = true;
          break;
    }
 
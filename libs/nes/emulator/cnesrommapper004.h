@@ -20,46 +20,53 @@ public:
    // Note: called directly!
    static uint32_t IRQENABLED ( void )
    {
-      return m_irqEnable;
+      return m_state->m_irqEnable;
    }
    static uint32_t IRQASSERTED ( void )
    {
-      return m_irqAsserted;
+      return m_state->m_irqAsserted;
    }
    static uint32_t IRQRELOAD ( void )
    {
-      return m_irqReload;
+      return m_state->m_irqReload;
    }
    static uint32_t IRQCOUNTER ( void )
    {
-      return m_irqCounter;
+      return m_state->m_irqCounter;
    }
    static uint32_t IRQLATCH ( void )
    {
-      return m_irqLatch;
+      return m_state->m_irqLatch;
    }
    static uint32_t PPUADDRA12 ( void )
    {
-      return m_lastPPUAddrA12;
+      return m_state->m_lastPPUAddrA12;
    }
    static uint32_t PPUCYCLE ( void )
    {
-      return m_lastPPUCycle;
+      return m_state->m_lastPPUCycle;
    }
 
 protected:
-   // MMC3
-   static uint8_t  m_reg [ 8 ];
-   static bool           m_irqAsserted;
-   static uint8_t  m_irqCounter;
-   static uint8_t  m_irqLatch;
-   static bool           m_irqEnable;
-   static bool           m_irqReload;
-   static uint8_t  m_prg [ 2 ];
-   static uint8_t  m_chr [ 8 ];
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      // MMC3
+      uint8_t m_reg [ 8 ] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+      bool m_irqAsserted = false;
+      uint8_t m_irqCounter = 0x00;
+      uint8_t m_irqLatch = 0x00;
+      bool m_irqEnable = false;
+      bool m_irqReload = false;
+      uint8_t m_prg [ 2 ] = { 0, 0 };
+      uint8_t m_chr [ 8 ] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+      uint32_t m_lastPPUAddrA12 = 0;
+      uint32_t m_lastPPUCycle = 0;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 
-   static uint32_t   m_lastPPUAddrA12;
-   static uint32_t   m_lastPPUCycle;
 };
 
 #endif
@@ -306,26 +306,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,44,44,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper005::m_prgMode = 0;
-uint8_t  CROMMapper005::m_chrMode = 0;
-uint8_t  CROMMapper005::m_chrHigh = 0;
-uint8_t  CROMMapper005::m_irqScanline = 0;
-uint8_t  CROMMapper005::m_irqEnabled = 0;
-uint8_t  CROMMapper005::m_irqStatus = 0;
-bool           CROMMapper005::m_prgRAM [] = { false, false, false };
-bool           CROMMapper005::m_wp = false;
-uint8_t  CROMMapper005::m_wp1 = 0;
-uint8_t  CROMMapper005::m_wp2 = 0;
-uint8_t  CROMMapper005::m_mult1 = 0;
-uint8_t  CROMMapper005::m_mult2 = 0;
-uint16_t CROMMapper005::m_prod = 0;
-uint8_t  CROMMapper005::m_fillTile = 0;
-uint8_t  CROMMapper005::m_fillAttr = 0;
-uint32_t CROMMapper005::m_ppuCycle = 0;
-uint8_t  CROMMapper005::m_chr[] = { 0, };
-uint8_t  CROMMapper005::m_reg[] = { 0, };
-CAPUSquare CROMMapper005::m_square[2];
-CAPUDMC    CROMMapper005::m_dmc;
+CROMMapper005::State CROMMapper005::m_defaultState;
+thread_local CROMMapper005::State* CROMMapper005::m_state = &CROMMapper005::m_defaultState;
 
 CROMMapper005::CROMMapper005()
 {
@@ -337,73 +319,87 @@ CROMMapper005::~CROMMapper005()
 
 void CROMMapper005::RESET ( bool soft )
 {
-   m_mapper = 5;
+   CROM::m_state->m_mapper = 5;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   m_square[0].RESET();
-   m_square[1].RESET();
-   m_dmc.RESET();
+   m_state->m_square[0].RESET();
+   m_state->m_square[1].RESET();
+   m_state->m_dmc.RESET();
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
-   m_prgMode = 0;
-   m_chrMode = 0;
-   m_chrHigh = 0;
-   m_irqScanline = 0;
-   m_irqStatus = 0;
+   m_state->m_prgMode = 0;
+   m_state->m_chrMode = 0;
+   m_state->m_chrHigh = 0;
+   m_state->m_irqScanline = 0;
+   m_state->m_irqStatus = 0;
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_prgRAM [ 0 ] = false;
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_prgRAM [ 1 ] = false;
-   if ( m_numPrgBanks == 2 )
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   m_state->m_prgRAM [ 0 ] = false;
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   m_state->m_prgRAM [ 1 ] = false;
+   if ( CROM::m_state->m_numPrgBanks == 2 )
    {
-      m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ 0 ];
-      m_prgRAM [ 2 ] = false;
+      CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ 0 ] );
+      m_state->m_prgRAM [ 2 ] = false;
    }
    else
    {
-      m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ 2 ];
-      m_prgRAM [ 2 ] = false;
+      CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ 2 ] );
+      m_state->m_prgRAM [ 2 ] = false;
    }
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
 
 void CROMMapper005::SYNCCPU ( void )
 {
-   m_square[0].TIMERTICK();
-   m_square[1].TIMERTICK();
-   m_dmc.TIMERTICK();
+   m_state->m_square[0].TIMERTICK();
+   m_state->m_square[1].TIMERTICK();
+   m_state->m_dmc.TIMERTICK();
+}
+
+uint32_t CROMMapper005::CPUIDLE ( void )
+{
+   // Sound only, which is caught up before each sample is taken.
+   return MAPPER_IDLE_FOREVER;
+}
+
+void CROMMapper005::SKIPCPU ( uint32_t cycles )
+{
+   while ( cycles-- )
+   {
+      SYNCCPU ();
+   }
 }
 
 void CROMMapper005::SYNCPPU ( uint32_t ppuCycle, uint32_t ppuAddr )
 {
    int32_t scanline = CYCLE_TO_VISY(ppuCycle);
 
-   m_ppuCycle = ppuCycle;
+   m_state->m_ppuCycle = ppuCycle;
 
    SETPPU();
 
    if ( scanline < 239 )
    {
-      m_irqStatus = 0x40;
+      m_state->m_irqStatus = 0x40;
       C6502::RELEASEIRQ(eNESSource_Mapper);
    }
 
    if ( scanline == 239 )
    {
-      m_irqStatus &= ~(0x40);
+      m_state->m_irqStatus &= ~(0x40);
    }
 
-   if ( (m_irqScanline > 0) && (scanline == m_irqScanline) )
+   if ( (m_state->m_irqScanline > 0) && (scanline == m_state->m_irqScanline) )
    {
-      m_irqStatus |= 0x80;
+      m_state->m_irqStatus |= 0x80;
    }
 
-   if ( m_irqEnabled && (m_irqStatus&0x80) )
+   if ( m_state->m_irqEnabled && (m_state->m_irqStatus&0x80) )
    {
       C6502::ASSERTIRQ ( eNESSource_Mapper );
 
@@ -421,46 +417,46 @@ void CROMMapper005::SETCPU ( void )
 
 void CROMMapper005::SETPPU ( void )
 {
-   int32_t rasterX = CYCLE_TO_VISX(m_ppuCycle);
+   int32_t rasterX = CYCLE_TO_VISX(m_state->m_ppuCycle);
 
    if ( (rasterX >= 256) &&
         (rasterX < 320) )
    {
       // Sprite fetches
-      m_pCHRmemory [ 0 ] = m_CHRmemory [ (m_chrHigh<<8)|m_chr[0] ];
-      m_pCHRmemory [ 1 ] = m_CHRmemory [ (m_chrHigh<<8)|m_chr[1] ];
-      m_pCHRmemory [ 2 ] = m_CHRmemory [ (m_chrHigh<<8)|m_chr[2] ];
-      m_pCHRmemory [ 3 ] = m_CHRmemory [ (m_chrHigh<<8)|m_chr[3] ];
-      m_pCHRmemory [ 4 ] = m_CHRmemory [ (m_chrHigh<<8)|m_chr[4] ];
-      m_pCHRmemory [ 5 ] = m_CHRmemory [ (m_chrHigh<<8)|m_chr[5] ];
-      m_pCHRmemory [ 6 ] = m_CHRmemory [ (m_chrHigh<<8)|m_chr[6] ];
-      m_pCHRmemory [ 7 ] = m_CHRmemory [ (m_chrHigh<<8)|m_chr[7] ];
+      CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chrHigh<<8)|m_state->m_chr[0] ];
+      CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chrHigh<<8)|m_state->m_chr[1] ];
+      CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chrHigh<<8)|m_state->m_chr[2] ];
+      CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chrHigh<<8)|m_state->m_chr[3] ];
+      CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chrHigh<<8)|m_state->m_chr[4] ];
+      CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chrHigh<<8)|m_state->m_chr[5] ];
+      CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chrHigh<<8)|m_state->m_chr[6] ];
+      CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chrHigh<<8)|m_state->m_chr[7] ];
    }
    else
    {
       // Background fetches
-      m_pCHRmemory [ 0 ] = m_CHRmemory [ (m_chrHigh<<8)|m_chr[8] ];
-      m_pCHRmemory [ 1 ] = m_CHRmemory [ (m_chrHigh<<8)|m_chr[9] ];
-      m_pCHRmemory [ 2 ] = m_CHRmemory [ (m_chrHigh<<8)|m_chr[10] ];
-      m_pCHRmemory [ 3 ] = m_CHRmemory [ (m_chrHigh<<8)|m_chr[11] ];
-      m_pCHRmemory [ 4 ] = m_CHRmemory [ (m_chrHigh<<8)|m_chr[8] ];
-      m_pCHRmemory [ 5 ] = m_CHRmemory [ (m_chrHigh<<8)|m_chr[9] ];
-      m_pCHRmemory [ 6 ] = m_CHRmemory [ (m_chrHigh<<8)|m_chr[10] ];
-      m_pCHRmemory [ 7 ] = m_CHRmemory [ (m_chrHigh<<8)|m_chr[11] ];
+      CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chrHigh<<8)|m_state->m_chr[8] ];
+      CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chrHigh<<8)|m_state->m_chr[9] ];
+      CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chrHigh<<8)|m_state->m_chr[10] ];
+      CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chrHigh<<8)|m_state->m_chr[11] ];
+      CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chrHigh<<8)|m_state->m_chr[8] ];
+      CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chrHigh<<8)|m_state->m_chr[9] ];
+      CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chrHigh<<8)|m_state->m_chr[10] ];
+      CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chrHigh<<8)|m_state->m_chr[11] ];
    }
 }
 
 uint32_t CROMMapper005::HMAPPER ( uint32_t addr )
 {
-   if ( (m_prgRAM[0]) && (addr < 0xA000) )
+   if ( (m_state->m_prgRAM[0]) && (addr < 0xA000) )
    {
       return CROM::SRAMVIRT ( addr );
    }
-   else if ( (m_prgRAM[1]) && (addr >= 0xA000) && (addr < 0xC000) )
+   else if ( (m_state->m_prgRAM[1]) && (addr >= 0xA000) && (addr < 0xC000) )
    {
       return CROM::SRAMVIRT ( addr );
    }
-   else if ( (m_prgRAM[2]) && (addr >= 0xC000) && (addr < 0xE000) )
+   else if ( (m_state->m_prgRAM[2]) && (addr >= 0xC000) && (addr < 0xE000) )
    {
       return CROM::SRAMVIRT ( addr );
    }
@@ -474,7 +470,7 @@ void CROMMapper005::HMAPPER ( uint32_t addr, uint8_t data )
 {
    // if PRG RAM has been mapped in it will already be there...
    // first check to ensure writes allowed...
-   if ( !m_wp )
+   if ( !m_state->m_wp )
    {
       CROM::SRAMVIRT ( addr, data );
    }
@@ -485,136 +481,136 @@ uint32_t CROMMapper005::DEBUGINFO ( uint32_t addr )
    switch ( addr )
    {
    case 0x5000:
-      return m_reg[0];
+      return m_state->m_reg[0];
       break;
    case 0x5001:
-      return m_reg[1];
+      return m_state->m_reg[1];
       break;
    case 0x5002:
-      return m_reg[2];
+      return m_state->m_reg[2];
       break;
    case 0x5003:
-      return m_reg[3];
+      return m_state->m_reg[3];
       break;
    case 0x5004:
-      return m_reg[4];
+      return m_state->m_reg[4];
       break;
    case 0x5005:
-      return m_reg[5];
+      return m_state->m_reg[5];
       break;
    case 0x5006:
-      return m_reg[6];
+      return m_state->m_reg[6];
       break;
    case 0x5007:
-      return m_reg[7];
+      return m_state->m_reg[7];
       break;
    case 0x5010:
-      return m_reg[8];
+      return m_state->m_reg[8];
       break;
    case 0x5011:
-      return m_reg[9];
+      return m_state->m_reg[9];
       break;
    case 0x5015:
-      return m_reg[10];
+      return m_state->m_reg[10];
       break;
    case 0x5100:
-      return m_reg[11];
+      return m_state->m_reg[11];
       break;
    case 0x5101:
-      return m_reg[12];
+      return m_state->m_reg[12];
       break;
    case 0x5102:
-      return m_reg[13];
+      return m_state->m_reg[13];
       break;
    case 0x5103:
-      return m_reg[14];
+      return m_state->m_reg[14];
       break;
    case 0x5104:
-      return m_reg[15];
+      return m_state->m_reg[15];
       break;
    case 0x5105:
-      return m_reg[16];
+      return m_state->m_reg[16];
       break;
    case 0x5106:
-      return m_reg[17];
+      return m_state->m_reg[17];
       break;
    case 0x5107:
-      return m_reg[18];
+      return m_state->m_reg[18];
       break;
    case 0x5113:
-      return m_reg[19];
+      return m_state->m_reg[19];
       break;
    case 0x5114:
-      return m_reg[20];
+      return m_state->m_reg[20];
       break;
    case 0x5115:
-      return m_reg[21];
+      return m_state->m_reg[21];
       break;
    case 0x5116:
-      return m_reg[22];
+      return m_state->m_reg[22];
       break;
    case 0x5117:
-      return m_reg[23];
+      return m_state->m_reg[23];
       break;
    case 0x5120:
-      return m_reg[24];
+      return m_state->m_reg[24];
       break;
    case 0x5121:
-      return m_reg[25];
+      return m_state->m_reg[25];
       break;
    case 0x5122:
-      return m_reg[26];
+      return m_state->m_reg[26];
       break;
    case 0x5123:
-      return m_reg[27];
+      return m_state->m_reg[27];
       break;
    case 0x5124:
-      return m_reg[28];
+      return m_state->m_reg[28];
       break;
    case 0x5125:
-      return m_reg[29];
+      return m_state->m_reg[29];
       break;
    case 0x5126:
-      return m_reg[30];
+      return m_state->m_reg[30];
       break;
    case 0x5127:
-      return m_reg[31];
+      return m_state->m_reg[31];
       break;
    case 0x5128:
-      return m_reg[32];
+      return m_state->m_reg[32];
       break;
    case 0x5129:
-      return m_reg[33];
+      return m_state->m_reg[33];
       break;
    case 0x512A:
-      return m_reg[34];
+      return m_state->m_reg[34];
       break;
    case 0x512B:
-      return m_reg[35];
+      return m_state->m_reg[35];
       break;
    case 0x5130:
-      return m_reg[36];
+      return m_state->m_reg[36];
       break;
    case 0x5200:
-      return m_reg[37];
+      return m_state->m_reg[37];
       break;
    case 0x5201:
-      return m_reg[38];
+      return m_state->m_reg[38];
       break;
    case 0x5202:
-      return m_reg[39];
+      return m_state->m_reg[39];
       break;
    case 0x5203:
-      return m_reg[40];
+      return m_state->m_reg[40];
       break;
    case 0x5204:
-      return m_reg[41];
+      return m_state->m_reg[41];
       break;
    case 0x5205:
-      return m_reg[42];
+      return m_state->m_reg[42];
       break;
    case 0x5206:
-      return m_reg[43];
+      return m_state->m_reg[43];
       break;
    }
    return 0;
@@ -637,15 +633,15 @@ uint32_t CROMMapper005::LMAPPER ( uint32_t addr )
       switch ( addr )
       {
          case 0x5204:
-            data = m_irqStatus;
-            m_irqStatus &= ~(0x80);
+            data = m_state->m_irqStatus;
+            m_state->m_irqStatus &= ~(0x80);
             C6502::RELEASEIRQ ( eNESSource_Mapper );
             break;
          case 0x5205:
-            data = m_prod&0xFF;
+            data = m_state->m_prod&0xFF;
             break;
          case 0x5206:
-            data = (m_prod>>8)&0xFF;
+            data = (m_state->m_prod>>8)&0xFF;
             break;
       }
    }
@@ -670,108 +666,108 @@ void CROMMapper005::LMAPPER ( uint32_t addr, uint8_t data )
       switch ( addr )
       {
       case 0x5000:
-         m_reg[0] = data;
-         m_square[0].APU(0,data);
+         m_state->m_reg[0] = data;
+         m_state->m_square[0].APU(0,data);
          break;
       case 0x5001:
-         m_reg[1] = data;
-         m_square[0].APU(1,data);
+         m_state->m_reg[1] = data;
+         m_state->m_square[0].APU(1,data);
          break;
       case 0x5002:
-         m_reg[2] = data;
-         m_square[0].APU(2,data);
+         m_state->m_reg[2] = data;
+         m_state->m_square[0].APU(2,data);
          break;
       case 0x5003:
-         m_reg[3] = data;
-         m_square[0].APU(3,data);
+         m_state->m_reg[3] = data;
+         m_state->m_square[0].APU(3,data);
          break;
       case 0x5004:
-         m_reg[4] = data;
-         m_square[1].APU(0,data);
+         m_state->m_reg[4] = data;
+         m_state->m_square[1].APU(0,data);
          break;
       case 0x5005:
-         m_reg[5] = data;
-         m_square[1].APU(1,data);
+         m_state->m_reg[5] = data;
+         m_state->m_square[1].APU(1,data);
          break;
       case 0x5006:
-         m_reg[6] = data;
-         m_square[1].APU(2,data);
+         m_state->m_reg[6] = data;
+         m_state->m_square[1].APU(2,data);
          break;
       case 0x5007:
-         m_reg[7] = data;
-         m_square[1].APU(3,data);
+         m_state->m_reg[7] = data;
+         m_state->m_square[1].APU(3,data);
          break;
       case 0x5010:
-         m_reg[8] = data;
-         m_dmc.APU(0,data);
+         m_state->m_reg[8] = data;
+         m_state->m_dmc.APU(0,data);
          break;
       case 0x5011:
-         m_reg[9] = data;
-         m_dmc.APU(1,data);
+         m_state->m_reg[9] = data;
+         m_state->m_dmc.APU(1,data);
          break;
       case 0x5015:
-         m_reg[10] = data;
-         m_square[0].ENABLE(!!(data&0x01));
-         m_square[1].ENABLE(!!(data&0x02));
+         m_state->m_reg[10] = data;
+         m_state->m_square[0].ENABLE(!!(data&0x01));
+         m_state->m_square[1].ENABLE(!!(data&0x02));
          break;
       case 0x5100:
-         m_reg[11] = data;
-         m_prgMode = data&0x3;
+         m_state->m_reg[11] = data;
+         m_state->m_prgMode = data&0x3;
          break;
       case 0x5101:
-         m_reg[12] = data;
-         m_chrMode = data&0x3;
+         m_state->m_reg[12] = data;
+         m_state->m_chrMode = data&0x3;
          break;
       case 0x5102:
-         m_reg[13] = data;
-         m_wp1 = data&0x3;
+         m_state->m_reg[13] = data;
+         m_state->m_wp1 = data&0x3;
 
-         if ( (m_wp1 == 0x2) && (m_wp2 == 0x1) )
+         if ( (m_state->m_wp1 == 0x2) && (m_state->m_wp2 == 0x1) )
          {
-            m_wp = false;
+            m_state->m_wp = false;
          }
          else
          {
-            m_wp = true;
+            m_state->m_wp = true;
          }
 
          break;
       case 0x5103:
-         m_reg[14] = data;
-         m_wp2 = data&0x3;
+         m_state->m_reg[14] = data;
+         m_state->m_wp2 = data&0x3;
 
-         if ( (m_wp1 == 0x2) && (m_wp2 == 0x1) )
+         if ( (m_state->m_wp1 == 0x2) && (m_state->m_wp2 == 0x1) )
          {
-            m_wp = false;
+            m_state->m_wp = false;
          }
          else
          {
-            m_wp = true;
+            m_state->m_wp = true;
          }
 
          break;
       case 0x5104:
-         m_reg[15] = data;
+         m_state->m_reg[15] = data;
          break;
       case 0x5105:
-         m_reg[16] = data;
+         m_state->m_reg[16] = data;
          CPPU::MIRROR ( data&0x03, (data&0x0C)>>2, (data&0x30)>>4, (data&0xC0)>>6 );
          break;
       case 0x5106:
-         m_reg[17] = data;
-         m_fillTile = data;
+         m_state->m_reg[17] = data;
+         m_state->m_fillTile = data;
          break;
       case 0x5107:
-         m_reg[18] = data;
-         m_fillAttr = data&0x3;
+         m_state->m_reg[18] = data;
+         m_state->m_fillAttr = data&0x3;
          break;
       case 0x5113:
-         m_reg[19] = data;
+         m_state->m_reg[19] = data;
          data &= 0x7;
          CROM::REMAPSRAM ( 0x6000, data );
          break;
       case 0x5114:
-         m_reg[20] = data;
+         m_state->m_reg[20] = data;
          prgRAM = !(data&0x80);
          data &= 0x7F;
 
@@ -780,22 +776,22 @@ void CROMMapper005::LMAPPER ( uint32_t addr, uint8_t data )
             data &= 0x7;
          }
 
-         if ( m_prgMode == 3 )
+         if ( m_state->m_prgMode == 3 )
          {
-            m_prgRAM[0] = prgRAM;
-            if ( m_prgRAM[0] )
+            m_state->m_prgRAM[0] = prgRAM;
+            if ( m_state->m_prgRAM[0] )
             {
                CROM::REMAPSRAM ( 0x8000, data );
             }
             else
             {
-               m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ data ];
+               CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ data ] );
             }
          }
 
          break;
       case 0x5115:
-         m_reg[21] = data;
+         m_state->m_reg[21] = data;
          prgRAM = !(data&0x80);
          data &= 0x7F;
 
@@ -804,10 +800,10 @@ void CROMMapper005::LMAPPER ( uint32_t addr, uint8_t data )
             data &= 0x7;
          }
 
-         if ( (m_prgMode == 1) || (m_prgMode == 2) )
+         if ( (m_state->m_prgMode == 1) || (m_state->m_prgMode == 2) )
          {
-            m_prgRAM[0] = prgRAM;
-            m_prgRAM[1] = prgRAM;
+            m_state->m_prgRAM[0] = prgRAM;
+            m_state->m_prgRAM[1] = prgRAM;
             if ( prgRAM )
             {
                CROM::REMAPSRAM ( 0x8000, (data&0xFE)+0 );
@@ -815,26 +811,26 @@ void CROMMapper005::LMAPPER ( uint32_t addr, uint8_t data )
             }
             else
             {
-               m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ (data&0xFE)+0 ];
-               m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ (data&0xFE)+1 ];
+               CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ (data&0xFE)+0 ] );
+               CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ (data&0xFE)+1 ] );
             }
          }
-         else if ( m_prgMode == 3 )
+         else if ( m_state->m_prgMode == 3 )
          {
-            m_prgRAM[1] = prgRAM;
+            m_state->m_prgRAM[1] = prgRAM;
             if ( prgRAM )
             {
                CROM::REMAPSRAM ( 0x8000, data );
             }
             else
             {
-               m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ data ];
+               CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ data ] );
             }
          }
 
          break;
       case 0x5116:
-         m_reg[22] = data;
+         m_state->m_reg[22] = data;
          prgRAM = !(data&0x80);
          data &= 0x7F;
 
@@ -843,216 +839,216 @@ void CROMMapper005::LMAPPER ( uint32_t addr, uint8_t data )
             data &= 0x7;
          }
 
-         if ( (m_prgMode == 2) || (m_prgMode == 3) )
+         if ( (m_state->m_prgMode == 2) || (m_state->m_prgMode == 3) )
          {
-            m_prgRAM[2] = prgRAM;
+            m_state->m_prgRAM[2] = prgRAM;
             if ( prgRAM )
             {
                CROM::REMAPSRAM ( 0xC000, data );
             }
             else
             {
-               m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ data ];
+               CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ data ] );
             }
          }
 
          break;
       case 0x5117:
-         m_reg[23] = data;
-         if ( m_prgMode == 0 )
+         m_state->m_reg[23] = data;
+         if ( m_state->m_prgMode == 0 )
          {
-            m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ (data&0xFC)+0 ];
-            m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ (data&0xFC)+1 ];
-            m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ (data&0xFC)+2 ];
-            m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ (data&0xFC)+3 ];
+            CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ (data&0xFC)+0 ] );
+            CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ (data&0xFC)+1 ] );
+            CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ (data&0xFC)+2 ] );
+            CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ (data&0xFC)+3 ] );
          }
-         else if ( m_prgMode == 1 )
+         else if ( m_state->m_prgMode == 1 )
          {
-            m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ (data&0xFE)+0 ];
-            m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ (data&0xFE)+1 ];
+            CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ (data&0xFE)+0 ] );
+            CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ (data&0xFE)+1 ] );
          }
-         else if ( (m_prgMode == 2) || (m_prgMode == 3) )
+         else if ( (m_state->m_prgMode == 2) || (m_state->m_prgMode == 3) )
          {
-            m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ data ];
+            CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ data ] );
          }
 
          break;
       case 0x5120:
-         m_reg[24] = data;
-         if ( m_chrMode == 3 )
+         m_state->m_reg[24] = data;
+         if ( m_state->m_chrMode == 3 )
          {
-            m_chr[0] = data;
+            m_state->m_chr[0] = data;
          }
          break;
       case 0x5121:
-         m_reg[25] = data;
-         if ( m_chrMode == 3 )
+         m_state->m_reg[25] = data;
+         if ( m_state->m_chrMode == 3 )
          {
-            m_chr[1] = data;
+            m_state->m_chr[1] = data;
          }
-         else if ( m_chrMode == 2 )
+         else if ( m_state->m_chrMode == 2 )
          {
-            m_chr[0] = (data<<1)+0;
-            m_chr[1] = (data<<1)+1;
+            m_state->m_chr[0] = (data<<1)+0;
+            m_state->m_chr[1] = (data<<1)+1;
          }
          break;
       case 0x5122:
-         m_reg[26] = data;
-         if ( m_chrMode == 3 )
+         m_state->m_reg[26] = data;
+         if ( m_state->m_chrMode == 3 )
          {
-            m_chr[2] = data;
+            m_state->m_chr[2] = data;
          }
          break;
       case 0x5123:
-         m_reg[27] = data;
-         if ( m_chrMode == 3 )
+         m_state->m_reg[27] = data;
+         if ( m_state->m_chrMode == 3 )
          {
-            m_chr[3] = data;
+            m_state->m_chr[3] = data;
          }
-         else if ( m_chrMode == 2 )
+         else if ( m_state->m_chrMode == 2 )
          {
-            m_chr[2] = (data<<1)+0;
-            m_chr[3] = (data<<1)+1;
+            m_state->m_chr[2] = (data<<1)+0;
+            m_state->m_chr[3] = (data<<1)+1;
          }
-         else if ( m_chrMode == 1 )
+         else if ( m_state->m_chrMode == 1 )
          {
-            m_chr[0] = (data<<2)+0;
-            m_chr[1] = (data<<2)+1;
-            m_chr[2] = (data<<2)+2;
-            m_chr[3] = (data<<2)+3;
+            m_state->m_chr[0] = (data<<2)+0;
+            m_state->m_chr[1] = (data<<2)+1;
+            m_state->m_chr[2] = (data<<2)+2;
+            m_state->m_chr[3] = (data<<2)+3;
          }
          break;
       case 0x5124:
-         m_reg[28] = data;
-         if ( m_chrMode == 3 )
+         m_state->m_reg[28] = data;
+         if ( m_state->m_chrMode == 3 )
          {
-            m_chr[4] = data;
+            m_state->m_chr[4] = data;
          }
          break;
       case 0x5125:
-         m_reg[29] = data;
-         if ( m_chrMode == 3 )
+         m_state->m_reg[29] = data;
+         if ( m_state->m_chrMode == 3 )
          {
-            m_chr[5] = data;
+            m_state->m_chr[5] = data;
          }
-         else if ( m_chrMode == 2 )
+         else if ( m_state->m_chrMode == 2 )
          {
-            m_chr[4] = (data<<1)+0;
-            m_chr[5] = (data<<1)+1;
+            m_state->m_chr[4] = (data<<1)+0;
+            m_state->m_chr[5] = (data<<1)+1;
          }
          break;
       case 0x5126:
-         m_reg[30] = data;
-         if ( m_chrMode == 3 )
+         m_state->m_reg[30] = data;
+         if ( m_state->m_chrMode == 3 )
          {
-            m_chr[6] = data;
+            m_state->m_chr[6] = data;
          }
          break;
       case 0x5127:
-         m_reg[31] = data;
-         if ( m_chrMode == 3 )
+         m_state->m_reg[31] = data;
+         if ( m_state->m_chrMode == 3 )
          {
-            m_chr[7] = data;
+            m_state->m_chr[7] = data;
          }
-         else if ( m_chrMode == 2 )
+         else if ( m_state->m_chrMode == 2 )
          {
-            m_chr[6] = (data<<1)+0;
-            m_chr[7] = (data<<1)+1;
+            m_state->m_chr[6] = (data<<1)+0;
+            m_state->m_chr[7] = (data<<1)+1;
          }
-         else if ( m_chrMode == 1 )
+         else if ( m_state->m_chrMode == 1 )
          {
-            m_chr[4] = (data<<2)+0;
-            m_chr[5] = (data<<2)+1;
-            m_chr[6] = (data<<2)+2;
-            m_chr[7] = (data<<2)+3;
+            m_state->m_chr[4] = (data<<2)+0;
+            m_state->m_chr[5] = (data<<2)+1;
+            m_state->m_chr[6] = (data<<2)+2;
+            m_state->m_chr[7] = (data<<2)+3;
          }
-         else if ( m_chrMode == 0 )
+         else if ( m_state->m_chrMode == 0 )
          {
-            m_chr[0] = (data<<3)+0;
-            m_chr[1] = (data<<3)+1;
-            m_chr[2] = (data<<3)+2;
-            m_chr[3] = (data<<3)+3;
-            m_chr[4] = (data<<3)+4;
-            m_chr[5] = (data<<3)+5;
-            m_chr[6] = (data<<3)+6;
-            m_chr[7] = (data<<3)+7;
+            m_state->m_chr[0] = (data<<3)+0;
+            m_state->m_chr[1] = (data<<3)+1;
+            m_state->m_chr[2] = (data<<3)+2;
+            m_state->m_chr[3] = (data<<3)+3;
+            m_state->m_chr[4] = (data<<3)+4;
+            m_state->m_chr[5] = (data<<3)+5;
+            m_state->m_chr[6] = (data<<3)+6;
+            m_state->m_chr[7] = (data<<3)+7;
          }
          break;
       case 0x5128:
-         m_reg[32] = data;
-         if ( m_chrMode == 3 )
+         m_state->m_reg[32] = data;
+         if ( m_state->m_chrMode == 3 )
          {
-            m_chr[8] = data;
+            m_state->m_chr[8] = data;
          }
          break;
       case 0x5129:
-         m_reg[33] = data;
-         if ( m_chrMode == 3 )
+         m_state->m_reg[33] = data;
+         if ( m_state->m_chrMode == 3 )
          {
-            m_chr[9] = data;
+            m_state->m_chr[9] = data;
          }
-         else if ( m_chrMode == 2 )
+         else if ( m_state->m_chrMode == 2 )
          {
-            m_chr[8] = (data<<1)+0;
-            m_chr[9] = (data<<1)+1;
+            m_state->m_chr[8] = (data<<1)+0;
+            m_state->m_chr[9] = (data<<1)+1;
          }
          break;
       case 0x512A:
-         m_reg[34] = data;
-         if ( m_chrMode == 3 )
+         m_state->m_reg[34] = data;
+         if ( m_state->m_chrMode == 3 )
          {
-            m_chr[10] = data;
+            m_state->m_chr[10] = data;
          }
          break;
       case 0x512B:
-         m_reg[35] = data;
-         if ( m_chrMode == 3 )
+         m_state->m_reg[35] = data;
+         if ( m_state->m_chrMode == 3 )
          {
-            m_chr[11] = data;
+            m_state->m_chr[11] = data;
          }
-         else if ( m_chrMode == 2 )
+         else if ( m_state->m_chrMode == 2 )
          {
-            m_chr[10] = (data<<1)+0;
-            m_chr[11] = (data<<1)+1;
+            m_state->m_chr[10] = (data<<1)+0;
+            m_state->m_chr[11] = (data<<1)+1;
          }
-         else if ( m_chrMode == 1 || m_chrMode == 0 )
+         else if ( m_state->m_chrMode == 1 || m_state->m_chrMode == 0 )
          {
-            m_chr[8] = (data<<2)+0;
-            m_chr[9] = (data<<2)+1;
-            m_chr[10] = (data<<2)+2;
-            m_chr[11] = (data<<2)+3;
+            m_state->m_chr[8] = (data<<2)+0;
+            m_state->m_chr[9] = (data<<2)+1;
+            m_state->m_chr[10] = (data<<2)+2;
+            m_state->m_chr[11] = (data<<2)+3;
          }
          break;
       case 0x5130:
-         m_reg[36] = data;
-         m_chrHigh = data&0x3;
+         m_state->m_reg[36] = data;
+         m_state->m_chrHigh = data&0x3;
          break;
       case 0x5200:
-         m_reg[37] = data;
+         m_state->m_reg[37] = data;
          break;
       case 0x5201:
-         m_reg[38] = data;
+         m_state->m_reg[38] = data;
          break;
       case 0x5202:
-         m_reg[39] = data;
+         m_state->m_reg[39] = data;
          break;
       case 0x5203:
-         m_reg[40] = data;
-         m_irqScanline = data;
+         m_state->m_reg[40] = data;
+         m_state->m_irqScanline = data;
          break;
       case 0x5204:
-         m_reg[41] = data;
-         m_irqEnabled = data&0x80;
+         m_state->m_reg[41] = data;
+         m_state->m_irqEnabled = data&0x80;
          break;
       case 0x5205:
-         m_reg[42] = data;
-         m_mult1 = data;
-         m_prod = m_mult1*m_mult2;
+         m_state->m_reg[42] = data;
+         m_state->m_mult1 = data;
+         m_state->m_prod = m_state->m_mult1*m_state->m_mult2;
          break;
       case 0x5206:
-         m_reg[43] = data;
-         m_mult2 = data;
-         m_prod = m_mult1*m_mult2;
+         m_state->m_reg[43] = data;
+         m_state->m_mult2 = data;
+         m_state->m_prod = m_state->m_mult1*m_state->m_mult2;
          break;
       }
    }
@@ -1061,70 +1057,42 @@ void CROMMapper005::LMAPPER ( uint32_t addr, uint8_t data )
 
 uint16_t CROMMapper005::AMPLITUDE ( void )
 {
-   float famp;
-   int16_t amp;
+   int32_t sum = 0;
    int16_t delta;
-   int16_t out[100] = { 0, };
-   static int16_t outLast = 0;
    uint8_t sample;
-   uint8_t* sq1dacSamples = m_square[0].GETDACSAMPLES();
-   uint8_t* sq2dacSamples = m_square[1].GETDACSAMPLES();
-   uint8_t* dmcDacSamples = m_dmc.GETDACSAMPLES();
-   static int32_t outDownsampled = 0;
+   uint8_t* sq1dacSamples = m_state->m_square[0].GETDACSAMPLES();
+   uint8_t* sq2dacSamples = m_state->m_square[1].GETDACSAMPLES();
+   uint8_t* dmcDacSamples = m_state->m_dmc.GETDACSAMPLES();
 
-   for ( sample = 0; sample < m_square[0].GETDACSAMPLECOUNT(); sample++ )
+   // Same non-linear mixing as the APU's squares and DMC.
+   for ( sample = 0; sample < m_state->m_square[0].GETDACSAMPLECOUNT(); sample++ )
    {
-//      output = square_out + tnd_out
-//
-//
-//                            95.88
-//      square_out = -----------------------
-//                          8128
-//                   ----------------- + 100
-//                   square1 + square2
-//
-//
-//                            159.79
-//      tnd_out = ------------------------------
-//                            1
-//                ------------------------ + 100
-//                triangle   noise    dmc
-//                -------- + ----- + -----
-//                  8227     12241   22638
-      famp = 0.0;
-      if ( (*(sq1dacSamples+sample))+(*(sq2dacSamples+sample)) )
-      {
-         famp = (95.88/((8128.0/((*(sq1dacSamples+sample))+(*(sq2dacSamples+sample))))+100.0));
-      }
-      if ( (*(dmcDacSamples+sample)) )
-      {
-         famp += (159.79/((1.0/((((*(dmcDacSamples+sample))/22638.0))))+100.0));
-      }
-      amp = (int16_t)(float)(65535.0*famp*0.50);
-
-      (*(out+sample)) = amp;
-
-      outDownsampled += (*(out+sample));
+      sum += CAPU::PULSEMIX((*(sq1dacSamples+sample))+(*(sq2dacSamples+sample)))+
+             CAPU::TNDMIX(*(dmcDacSamples+sample));
    }
 
-   outDownsampled = (int32_t)((float)outDownsampled/((float)m_square[0].GETDACSAMPLECOUNT()));
+   if ( m_state->m_square[0].GETDACSAMPLECOUNT() )
+   {
+      sum /= m_state->m_square[0].GETDACSAMPLECOUNT();
+   }
+   m_state->m_outDownsampled = sum;
 
-   delta = outDownsampled - outLast;
-   outDownsampled = outLast+((delta*65371)/65536); // 65371/65536 is 0.9975 adjusted to 16-bit fixed point.
+   delta = m_state->m_outDownsampled - m_state->m_outLast;
+   m_state->m_outDownsampled = m_state->m_outLast+((delta*65371)/65536); // 65371/65536 is 0.9975 adjusted to 16-bit fixed point.
 
-   outLast = outDownsampled;
+   m_state->m_outLast = m_state->m_outDownsampled;
 
    // Reset DAC averaging...
-   m_square[0].CLEARDACAVG();
-   m_square[1].CLEARDACAVG();
-   m_dmc.CLEARDACAVG();
+   m_state->m_square[0].CLEARDACAVG();
+   m_state->m_square[1].CLEARDACAVG();
+   m_state->m_dmc.CLEARDACAVG();
 
-   return outDownsampled;
+   return m_state->m_outDownsampled;
 }
 
 void CROMMapper005::SOUNDENABLE(uint32_t mask)
 {
-   m_square[0].MUTE(0);//!(mask&0x01));
-   m_square[1].MUTE(0);//!(mask&0x02));
-   m_dmc.MUTE(0);//!(mask&0x04));
+   m_state->m_square[0].MUTE(0);//!(mask&0x01));
+   m_state->m_square[1].MUTE(0);//!(mask&0x02));
+   m_state->m_dmc.MUTE(0);//!(mask&0x04));
 }
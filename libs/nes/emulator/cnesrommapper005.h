@@ -17,6 +17,8 @@ public:
    static void LMAPPER ( uint32_t addr, uint8_t data );
    static void SYNCPPU ( uint32_t ppuCycle, uint32_t ppuAddr );
    static void SYNCCPU ( void );
+   static uint32_t CPUIDLE ( void );
+   static void SKIPCPU ( uint32_t cycles );
    static void SETCPU ( void );
    static void SETPPU ( void );
    static uint32_t DEBUGINFO ( uint32_t addr );
@@ -24,28 +26,39 @@ public:
    static void SOUNDENABLE ( uint32_t mask );
 
 protected:
-   // MMC5
-   static uint8_t m_prgMode;
-   static uint8_t m_chrMode;
-   static uint8_t m_chrHigh;
-   static uint8_t m_irqScanline;
-   static uint8_t m_irqEnabled;
-   static uint8_t m_irqStatus;
-   static bool          m_prgRAM [ 3 ];
-   static bool          m_wp;
-   static uint32_t m_ppuCycle;
-   static uint8_t m_chr[12];
-   static uint8_t m_wp1;
-   static uint8_t m_wp2;
-   static uint8_t  m_mult1;
-   static uint8_t  m_mult2;
-   static uint16_t m_prod;
-   static uint8_t  m_fillTile;
-   static uint8_t  m_fillAttr;
-   static uint8_t  m_reg[44];
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      // MMC5
+      uint8_t m_prgMode = 0;
+      uint8_t m_chrMode = 0;
+      uint8_t m_chrHigh = 0;
+      uint8_t m_irqScanline = 0;
+      uint8_t m_irqEnabled = 0;
+      uint8_t m_irqStatus = 0;
+      bool m_prgRAM [ 3 ] = { false, false, false };
+      bool m_wp = false;
+      uint32_t m_ppuCycle = 0;
+      uint8_t m_chr [12] = { 0, };
+      uint8_t m_wp1 = 0;
+      uint8_t m_wp2 = 0;
+      uint8_t m_mult1 = 0;
+      uint8_t m_mult2 = 0;
+      uint16_t m_prod = 0;
+      uint8_t m_fillTile = 0;
+      uint8_t m_fillAttr = 0;
+      uint8_t m_reg [44] = { 0, };
+      CAPUSquare m_square [2];
+      CAPUDMC m_dmc;
+
+      // Expansion audio output filter history.
+      int16_t m_outLast = 0;
+      int32_t m_outDownsampled = 0;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 
-   static CAPUSquare m_square[2];
-   static CAPUDMC    m_dmc;
 };
 
 #endif
@@ -44,7 +44,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,1,1,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper007::m_reg = 0x00;
+CROMMapper007::State CROMMapper007::m_defaultState;
+thread_local CROMMapper007::State* CROMMapper007::m_state = &CROMMapper007::m_defaultState;
 
 CROMMapper007::CROMMapper007()
 {
@@ -56,16 +57,16 @@ CROMMapper007::~CROMMapper007()
 
 void CROMMapper007::RESET ( bool soft )
 {
-   m_mapper = 7;
+   CROM::m_state->m_mapper = 7;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
    CPPU::MIRROR ( 0 );
 
@@ -74,23 +75,23 @@ void CROMMapper007::RESET ( bool soft )
 
 uint32_t CROMMapper007::DEBUGINFO ( uint32_t addr )
 {
-   return m_reg;
+   return m_state->m_reg;
 }
 
 void CROMMapper007::HMAPPER ( uint32_t addr, uint8_t data )
 {
    uint8_t bank;
 
-   m_reg = data;
+   m_state->m_reg = data;
 
-   bank = (m_reg&0xF)<<2;
+   bank = (m_state->m_reg&0xF)<<2;
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ bank ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ bank+1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ bank+2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ bank+3 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ bank ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ bank+1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ bank+2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ bank+3 ] );
 
-   CPPU::MIRROR ( (m_reg&0x10)>>4 );
+   CPPU::MIRROR ( (m_state->m_reg&0x10)>>4 );
 
    if ( nesIsDebuggable() )
    {
@@ -14,7 +14,14 @@ public:
    static uint32_t DEBUGINFO ( uint32_t addr );
 
 protected:
-   static uint8_t  m_reg;
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      uint8_t m_reg = 0x00;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 };
 
 #endif
@@ -71,13 +71,8 @@ static const char* columnHeadings [] =
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,6,6,tblRegisters,rowHeadings,columnHeadings);
 
 // MMC2 stuff
-uint8_t  CROMMapper010::m_reg [] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
-uint8_t  CROMMapper010::m_latch0 = 0xFE;
-uint8_t  CROMMapper010::m_latch1 = 0xFE;
-uint8_t  CROMMapper010::m_latch0FD = 0;
-uint8_t  CROMMapper010::m_latch0FE = 1;
-uint8_t  CROMMapper010::m_latch1FD = 0;
-uint8_t  CROMMapper010::m_latch1FE = 0;
+CROMMapper010::State CROMMapper010::m_defaultState;
+thread_local CROMMapper010::State* CROMMapper010::m_state = &CROMMapper010::m_defaultState;
 
 CROMMapper010::CROMMapper010()
 {
@@ -89,32 +84,32 @@ CROMMapper010::~CROMMapper010()
 
 void CROMMapper010::RESET ( bool soft )
 {
-   m_mapper = 10;
-
-   m_dbRegisters = dbRegisters;
-
-   CROM::RESET ( m_mapper, soft );
-
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
-
-   m_latch0 = 0xFE;
-   m_latch1 = 0xFE;
-   m_latch0FD = 0;
-   m_latch0FE = 1;
-   m_latch1FD = 0;
-   m_latch1FE = 0;
-
-   m_pCHRmemory [ 0 ] = m_CHRmemory [ (m_latch0FE<<2)+0 ];
-   m_pCHRmemory [ 1 ] = m_CHRmemory [ (m_latch0FE<<2)+1 ];
-   m_pCHRmemory [ 2 ] = m_CHRmemory [ (m_latch0FE<<2)+2 ];
-   m_pCHRmemory [ 3 ] = m_CHRmemory [ (m_latch0FE<<2)+3 ];
-   m_pCHRmemory [ 4 ] = m_CHRmemory [ (m_latch1FE<<2)+0 ];
-   m_pCHRmemory [ 5 ] = m_CHRmemory [ (m_latch1FE<<2)+1 ];
-   m_pCHRmemory [ 6 ] = m_CHRmemory [ (m_latch1FE<<2)+2 ];
-   m_pCHRmemory [ 7 ] = m_CHRmemory [ (m_latch1FE<<2)+3 ];
+   CROM::m_state->m_mapper = 10;
+
+   CROM::m_state->m_dbRegisters = dbRegisters;
+
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
+
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
+
+   m_state->m_latch0 = 0xFE;
+   m_state->m_latch1 = 0xFE;
+   m_state->m_latch0FD = 0;
+   m_state->m_latch0FE = 1;
+   m_state->m_latch1FD = 0;
+   m_state->m_latch1FE = 0;
+
+   CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FE<<2)+0 ];
+   CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FE<<2)+1 ];
+   CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FE<<2)+2 ];
+   CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FE<<2)+3 ];
+   CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FE<<2)+0 ];
+   CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FE<<2)+1 ];
+   CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FE<<2)+2 ];
+   CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FE<<2)+3 ];
 }
 
 uint32_t CROMMapper010::DEBUGINFO ( uint32_t addr )
@@ -122,22 +117,22 @@ uint32_t CROMMapper010::DEBUGINFO ( uint32_t addr )
    switch ( addr&0xF000 )
    {
       case 0xA000:
-         return m_reg [ 0 ];
+         return m_state->m_reg [ 0 ];
          break;
       case 0xB000:
-         return m_reg [ 1 ];
+         return m_state->m_reg [ 1 ];
          break;
       case 0xC000:
-         return m_reg [ 2 ];
+         return m_state->m_reg [ 2 ];
          break;
       case 0xD000:
-         return m_reg [ 3 ];
+         return m_state->m_reg [ 3 ];
          break;
       case 0xE000:
-         return m_reg [ 4 ];
+         return m_state->m_reg [ 4 ];
          break;
       case 0xF000:
-         return m_reg [ 5 ];
+         return m_state->m_reg [ 5 ];
          break;
    }
 
@@ -152,69 +147,69 @@ void CROMMapper010::HMAPPER ( uint32_t addr, uint8_t data )
    {
       case 0xA000:
          reg = 0;
-         m_reg [ 0 ] = data;
-         m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ (data<<1)+0 ];
-         m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ (data<<1)+1 ];
+         m_state->m_reg [ 0 ] = data;
+         CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ (data<<1)+0 ] );
+         CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ (data<<1)+1 ] );
          break;
       case 0xB000:
          reg = 1;
-         m_reg [ 1 ] = data;
-         m_latch0FD = data;
+         m_state->m_reg [ 1 ] = data;
+         m_state->m_latch0FD = data;
 
-         if ( m_latch0 == 0xFD )
+         if ( m_state->m_latch0 == 0xFD )
          {
-            m_pCHRmemory [ 0 ] = m_CHRmemory [ (m_latch0FD<<2)+0 ];
-            m_pCHRmemory [ 1 ] = m_CHRmemory [ (m_latch0FD<<2)+1 ];
-            m_pCHRmemory [ 2 ] = m_CHRmemory [ (m_latch0FD<<2)+2 ];
-            m_pCHRmemory [ 3 ] = m_CHRmemory [ (m_latch0FD<<2)+3 ];
+            CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FD<<2)+0 ];
+            CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FD<<2)+1 ];
+            CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FD<<2)+2 ];
+            CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FD<<2)+3 ];
          }
 
          break;
       case 0xC000:
          reg = 2;
-         m_reg [ 2 ] = data;
-         m_latch0FE = data;
+         m_state->m_reg [ 2 ] = data;
+         m_state->m_latch0FE = data;
 
-         if ( m_latch0 == 0xFE )
+         if ( m_state->m_latch0 == 0xFE )
          {
-            m_pCHRmemory [ 0 ] = m_CHRmemory [ (m_latch0FE<<2)+0 ];
-            m_pCHRmemory [ 1 ] = m_CHRmemory [ (m_latch0FE<<2)+1 ];
-            m_pCHRmemory [ 2 ] = m_CHRmemory [ (m_latch0FE<<2)+2 ];
-            m_pCHRmemory [ 3 ] = m_CHRmemory [ (m_latch0FE<<2)+3 ];
+            CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FE<<2)+0 ];
+            CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FE<<2)+1 ];
+            CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FE<<2)+2 ];
+            CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FE<<2)+3 ];
          }
 
          break;
       case 0xD000:
          reg = 3;
-         m_reg [ 3 ] = data;
-         m_latch1FD = data;
+         m_state->m_reg [ 3 ] = data;
+         m_state->m_latch1FD = data;
 
-         if ( m_latch1 == 0xFD )
+         if ( m_state->m_latch1 == 0xFD )
          {
-            m_pCHRmemory [ 4 ] = m_CHRmemory [ (m_latch1FD<<2)+0 ];
-            m_pCHRmemory [ 5 ] = m_CHRmemory [ (m_latch1FD<<2)+1 ];
-            m_pCHRmemory [ 6 ] = m_CHRmemory [ (m_latch1FD<<2)+2 ];
-            m_pCHRmemory [ 7 ] = m_CHRmemory [ (m_latch1FD<<2)+3 ];
+            CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FD<<2)+0 ];
+            CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FD<<2)+1 ];
+            CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FD<<2)+2 ];
+            CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FD<<2)+3 ];
          }
 
          break;
       case 0xE000:
          reg = 4;
-         m_reg [ 4 ] = data;
-         m_latch1FE = data;
+         m_state->m_reg [ 4 ] = data;
+         m_state->m_latch1FE = data;
 
-         if ( m_latch1 == 0xFE )
+         if ( m_state->m_latch1 == 0xFE )
          {
-            m_pCHRmemory [ 4 ] = m_CHRmemory [ (m_latch1FE<<2)+0 ];
-            m_pCHRmemory [ 5 ] = m_CHRmemory [ (m_latch1FE<<2)+1 ];
-            m_pCHRmemory [ 6 ] = m_CHRmemory [ (m_latch1FE<<2)+2 ];
-            m_pCHRmemory [ 7 ] = m_CHRmemory [ (m_latch1FE<<2)+3 ];
+            CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FE<<2)+0 ];
+            CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FE<<2)+1 ];
+            CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FE<<2)+2 ];
+            CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FE<<2)+3 ];
          }
 
          break;
       case 0xF000:
          reg = 5;
-         m_reg [ 5 ] = data;
+         m_state->m_reg [ 5 ] = data;
 
          if ( !(CPPU::FOURSCREEN()) )
          {
@@ -242,34 +237,34 @@ void CROMMapper010::SYNCPPU ( uint32_t ppuCycle, uint32_t ppuAddr )
 {
    if ( (ppuAddr&0x1FF0) == 0x0FD0 )
    {
-      m_latch0 = 0xFD;
-      m_pCHRmemory [ 0 ] = m_CHRmemory [ (m_latch0FD<<2)+0 ];
-      m_pCHRmemory [ 1 ] = m_CHRmemory [ (m_latch0FD<<2)+1 ];
-      m_pCHRmemory [ 2 ] = m_CHRmemory [ (m_latch0FD<<2)+2 ];
-      m_pCHRmemory [ 3 ] = m_CHRmemory [ (m_latch0FD<<2)+3 ];
+      m_state->m_latch0 = 0xFD;
+      CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FD<<2)+0 ];
+      CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FD<<2)+1 ];
+      CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FD<<2)+2 ];
+      CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FD<<2)+3 ];
    }
    else if ( (ppuAddr&0x1FF0) == 0x0FE0 )
    {
-      m_latch0 = 0xFE;
-      m_pCHRmemory [ 0 ] = m_CHRmemory [ (m_latch0FE<<2)+0 ];
-      m_pCHRmemory [ 1 ] = m_CHRmemory [ (m_latch0FE<<2)+1 ];
-      m_pCHRmemory [ 2 ] = m_CHRmemory [ (m_latch0FE<<2)+2 ];
-      m_pCHRmemory [ 3 ] = m_CHRmemory [ (m_latch0FE<<2)+3 ];
+      m_state->m_latch0 = 0xFE;
+      CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FE<<2)+0 ];
+      CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FE<<2)+1 ];
+      CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FE<<2)+2 ];
+      CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch0FE<<2)+3 ];
    }
    else if ( (ppuAddr&0x1FF0) == 0x1FD0 )
    {
-      m_latch1 = 0xFD;
-      m_pCHRmemory [ 4 ] = m_CHRmemory [ (m_latch1FD<<2)+0 ];
-      m_pCHRmemory [ 5 ] = m_CHRmemory [ (m_latch1FD<<2)+1 ];
-      m_pCHRmemory [ 6 ] = m_CHRmemory [ (m_latch1FD<<2)+2 ];
-      m_pCHRmemory [ 7 ] = m_CHRmemory [ (m_latch1FD<<2)+3 ];
+      m_state->m_latch1 = 0xFD;
+      CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FD<<2)+0 ];
+      CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FD<<2)+1 ];
+      CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FD<<2)+2 ];
+      CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FD<<2)+3 ];
    }
    else if ( (ppuAddr&0x1FF0) == 0x1FE0 )
    {
-      m_latch1 = 0xFE;
-      m_pCHRmemory [ 4 ] = m_CHRmemory [ (m_latch1FE<<2)+0 ];
-      m_pCHRmemory [ 5 ] = m_CHRmemory [ (m_latch1FE<<2)+1 ];
-      m_pCHRmemory [ 6 ] = m_CHRmemory [ (m_latch1FE<<2)+2 ];
-      m_pCHRmemory [ 7 ] = m_CHRmemory [ (m_latch1FE<<2)+3 ];
+      m_state->m_latch1 = 0xFE;
+      CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FE<<2)+0 ];
+      CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FE<<2)+1 ];
+      CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FE<<2)+2 ];
+      CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ (m_state->m_latch1FE<<2)+3 ];
    }
 }
@@ -42,7 +42,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,1,1,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper011::m_reg = 0x00;
+CROMMapper011::State CROMMapper011::m_defaultState;
+thread_local CROMMapper011::State* CROMMapper011::m_state = &CROMMapper011::m_defaultState;
 
 CROMMapper011::CROMMapper011()
 {
@@ -54,46 +55,46 @@ CROMMapper011::~CROMMapper011()
 
 void CROMMapper011::RESET ( bool soft )
 {
-   m_mapper = 11;
+   CROM::m_state->m_mapper = 11;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
 
 uint32_t CROMMapper011::DEBUGINFO ( uint32_t addr )
 {
-   return m_reg;
+   return m_state->m_reg;
 }
 
 void CROMMapper011::HMAPPER ( uint32_t addr, uint8_t data )
 {
    uint8_t bank;
 
-   m_reg = data;
+   m_state->m_reg = data;
 
    bank = ((data&0x03)<<2);
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ bank ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ bank+1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ bank+2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ bank+3 ];
-
-   m_pCHRmemory [ 0 ] = m_CHRmemory [ ((data>>1)&0x78)+0 ];
-   m_pCHRmemory [ 1 ] = m_CHRmemory [ ((data>>1)&0x78)+1 ];
-   m_pCHRmemory [ 2 ] = m_CHRmemory [ ((data>>1)&0x78)+2 ];
-   m_pCHRmemory [ 3 ] = m_CHRmemory [ ((data>>1)&0x78)+3 ];
-   m_pCHRmemory [ 4 ] = m_CHRmemory [ ((data>>1)&0x78)+4 ];
-   m_pCHRmemory [ 5 ] = m_CHRmemory [ ((data>>1)&0x78)+5 ];
-   m_pCHRmemory [ 6 ] = m_CHRmemory [ ((data>>1)&0x78)+6 ];
-   m_pCHRmemory [ 7 ] = m_CHRmemory [ ((data>>1)&0x78)+7 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ bank ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ bank+1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ bank+2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ bank+3 ] );
+
+   CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ ((data>>1)&0x78)+0 ];
+   CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ ((data>>1)&0x78)+1 ];
+   CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ ((data>>1)&0x78)+2 ];
+   CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ ((data>>1)&0x78)+3 ];
+   CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ ((data>>1)&0x78)+4 ];
+   CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ ((data>>1)&0x78)+5 ];
+   CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ ((data>>1)&0x78)+6 ];
+   CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ ((data>>1)&0x78)+7 ];
 
    if ( nesIsDebuggable() )
    {
@@ -86,16 +86,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,14,14,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper016::m_reg [] = { 0x00, };
-uint16_t CROMMapper016::m_irqCounter = 0;
-bool     CROMMapper016::m_irqEnabled = false;
-bool     CROMMapper016::m_irqAsserted = false;
-uint8_t  CROMMapper016::m_eepromBitCounter = 0;
-uint8_t  CROMMapper016::m_eepromState = 0;
-uint8_t  CROMMapper016::m_eepromCmd;
-uint8_t  CROMMapper016::m_eepromAddr;
-uint8_t  CROMMapper016::m_eepromDataBuf;
-uint8_t  CROMMapper016::m_eepromRWBit;
+CROMMapper016::State CROMMapper016::m_defaultState;
+thread_local CROMMapper016::State* CROMMapper016::m_state = &CROMMapper016::m_defaultState;
 
 CROMMapper016::CROMMapper016()
 {
@@ -109,22 +101,22 @@ void CROMMapper016::RESET016 ( bool soft )
 {
    int32_t idx;
 
-   m_mapper = 16;
+   CROM::m_state->m_mapper = 16;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
-   m_irqCounter = 0;
-   m_irqEnabled = false;
-   m_irqAsserted = false;
-   m_eepromState = 0;
-   m_eepromBitCounter = 0;
+   m_state->m_irqCounter = 0;
+   m_state->m_irqEnabled = false;
+   m_state->m_irqAsserted = false;
+   m_state->m_eepromState = 0;
+   m_state->m_eepromBitCounter = 0;
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
@@ -134,35 +126,35 @@ void CROMMapper016::RESET159 ( bool soft )
 {
    int32_t idx;
 
-   m_mapper = 159;
+   CROM::m_state->m_mapper = 159;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
-   m_irqCounter = 0;
-   m_irqEnabled = false;
-   m_irqAsserted = false;
-   m_eepromState = 0;
-   m_eepromBitCounter = 0;
+   m_state->m_irqCounter = 0;
+   m_state->m_irqEnabled = false;
+   m_state->m_irqAsserted = false;
+   m_state->m_eepromState = 0;
+   m_state->m_eepromBitCounter = 0;
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
 
 void CROMMapper016::SYNCCPU ( void )
 {
-   if ( m_irqEnabled )
+   if ( m_state->m_irqEnabled )
    {
-      m_irqCounter--;
+      m_state->m_irqCounter--;
 
-      if ( !m_irqCounter )
+      if ( !m_state->m_irqCounter )
       {
-         m_irqAsserted = true;
+         m_state->m_irqAsserted = true;
          C6502::ASSERTIRQ(eNESSource_Mapper);
 
          if ( nesIsDebuggable() )
@@ -174,51 +166,69 @@ void CROMMapper016::SYNCCPU ( void )
    }
 }
 
+uint32_t CROMMapper016::CPUIDLE ( void )
+{
+   if ( m_state->m_irqEnabled )
+   {
+      // The IRQ fires on the cycle the counter reaches zero.
+      return (uint16_t)(m_state->m_irqCounter-1);
+   }
+   return MAPPER_IDLE_FOREVER;
+}
+
+void CROMMapper016::SKIPCPU ( uint32_t cycles )
+{
+   if ( m_state->m_irqEnabled )
+   {
+      m_state->m_irqCounter -= cycles;
+   }
+}
+
 uint32_t CROMMapper016::DEBUGINFO ( uint32_t addr )
 {
    switch ( addr&0x000F )
    {
    case 0x0000:
-      return m_reg[0];
+      return m_state->m_reg[0];
       break;
    case 0x0001:
-      return m_reg[1];
+      return m_state->m_reg[1];
       break;
    case 0x0002:
-      return m_reg[2];
+      return m_state->m_reg[2];
       break;
    case 0x0003:
-      return m_reg[3];
+      return m_state->m_reg[3];
       break;
    case 0x0004:
-      return m_reg[4];
+      return m_state->m_reg[4];
       break;
    case 0x0005:
-      return m_reg[5];
+      return m_state->m_reg[5];
       break;
    case 0x0006:
-      return m_reg[6];
+      return m_state->m_reg[6];
       break;
    case 0x0007:
-      return m_reg[7];
+      return m_state->m_reg[7];
       break;
    case 0x0008:
-      return m_reg[8];
+      return m_state->m_reg[8];
       break;
    case 0x0009:
-      return m_reg[9];
+      return m_state->m_reg[9];
       break;
    case 0x000A:
-      return m_reg[10];
+      return m_state->m_reg[10];
       break;
    case 0x000B:
-      return m_reg[11];
+      return m_state->m_reg[11];
       break;
    case 0x000C:
-      return m_reg[12];
+      return m_state->m_reg[12];
       break;
    case 0x000D:
-      return m_reg[13];
+      return m_state->m_reg[13];
       break;
    }
 }
@@ -227,54 +237,54 @@ uint32_t CROMMapper016::LMAPPER ( uint32_t addr )
 {
    uint8_t data = C6502::OPENBUS();
 
-   switch ( m_eepromState )
+   switch ( m_state->m_eepromState )
    {
    case 1:
       // Need to ack and skip to state 3 on a read command.
-      if ( m_eepromBitCounter == 9 )
+      if ( m_state->m_eepromBitCounter == 9 )
       {
-         m_eepromBitCounter = 0;
-         if ( m_eepromCmd&0x01 )
+         m_state->m_eepromBitCounter = 0;
+         if ( m_state->m_eepromCmd&0x01 )
          {
-            m_eepromState = 3;
+            m_state->m_eepromState = 3;
          }
          else
          {
-            m_eepromState = 2;
+            m_state->m_eepromState = 2;
          }
          data = 0x00;
       }
    case 2:
       // Only need to ack.
-      if ( m_eepromBitCounter == 9 )
+      if ( m_state->m_eepromBitCounter == 9 )
       {
-         m_eepromBitCounter = 0;
-         m_eepromState++;
+         m_state->m_eepromBitCounter = 0;
+         m_state->m_eepromState++;
          data = 0x00;
       }
       break;
    case 3:
       // Command execution
-      if ( m_eepromBitCounter == 9 )
+      if ( m_state->m_eepromBitCounter == 9 )
       {
-         m_eepromBitCounter = 0;
+         m_state->m_eepromBitCounter = 0;
          data = 0x00;
       }
 
       // Read
-      if ( m_mapper == 16 )
+      if ( CROM::m_state->m_mapper == 16 )
       {
-         data = CROM::SRAMVIRT(0x6000+m_eepromAddr);
+         data = CROM::SRAMVIRT(0x6000+m_state->m_eepromAddr);
       }
       else
       {
-         data = CROM::SRAMVIRT(0x6000+(m_eepromAddr>>1));
+         data = CROM::SRAMVIRT(0x6000+(m_state->m_eepromAddr>>1));
       }
-      data >>= m_eepromBitCounter;
+      data >>= m_state->m_eepromBitCounter;
       data &= 0x01;
       data <<= 4;
 
-      m_eepromBitCounter++;
+      m_state->m_eepromBitCounter++;
       break;
    }
 
@@ -289,53 +299,53 @@ void CROMMapper016::HMAPPER ( uint32_t addr, uint8_t data )
    {
    case 0x0000:
       reg = 0;
-      m_reg[0] = data;
-      m_pCHRmemory[0] = m_CHRmemory[data];
+      m_state->m_reg[0] = data;
+      CROM::m_state->m_pCHRmemory[0] = CROM::m_state->m_CHRmemory[data];
       break;
    case 0x0001:
       reg = 1;
-      m_reg[1] = data;
-      m_pCHRmemory[1] = m_CHRmemory[data];
+      m_state->m_reg[1] = data;
+      CROM::m_state->m_pCHRmemory[1] = CROM::m_state->m_CHRmemory[data];
       break;
    case 0x0002:
       reg = 2;
-      m_reg[2] = data;
-      m_pCHRmemory[2] = m_CHRmemory[data];
+      m_state->m_reg[2] = data;
+      CROM::m_state->m_pCHRmemory[2] = CROM::m_state->m_CHRmemory[data];
       break;
    case 0x0003:
       reg = 3;
-      m_reg[3] = data;
-      m_pCHRmemory[3] = m_CHRmemory[data];
+      m_state->m_reg[3] = data;
+      CROM::m_state->m_pCHRmemory[3] = CROM::m_state->m_CHRmemory[data];
       break;
    case 0x0004:
       reg = 4;
-      m_reg[4] = data;
-      m_pCHRmemory[4] = m_CHRmemory[data];
+      m_state->m_reg[4] = data;
+      CROM::m_state->m_pCHRmemory[4] = CROM::m_state->m_CHRmemory[data];
       break;
    case 0x0005:
       reg = 5;
-      m_reg[5] = data;
-      m_pCHRmemory[5] = m_CHRmemory[data];
+      m_state->m_reg[5] = data;
+      CROM::m_state->m_pCHRmemory[5] = CROM::m_state->m_CHRmemory[data];
       break;
    case 0x0006:
       reg = 6;
-      m_reg[6] = data;
-      m_pCHRmemory[6] = m_CHRmemory[data];
+      m_state->m_reg[6] = data;
+      CROM::m_state->m_pCHRmemory[6] = CROM::m_state->m_CHRmemory[data];
       break;
    case 0x0007:
       reg = 7;
-      m_reg[7] = data;
-      m_pCHRmemory[7] = m_CHRmemory[data];
+      m_state->m_reg[7] = data;
+      CROM::m_state->m_pCHRmemory[7] = CROM::m_state->m_CHRmemory[data];
       break;
    case 0x0008:
       reg = 8;
-      m_reg[8] = data;
-      m_pPRGROMmemory[0] = m_PRGROMmemory[((data<<1)%m_numPrgBanks)+0];
-      m_pPRGROMmemory[1] = m_PRGROMmemory[((data<<1)%m_numPrgBanks)+1];
+      m_state->m_reg[8] = data;
+      CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory[((data<<1)%CROM::m_state->m_numPrgBanks)+0] );
+      CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory[((data<<1)%CROM::m_state->m_numPrgBanks)+1] );
       break;
    case 0x0009:
       reg = 9;
-      m_reg[9] = data;
+      m_state->m_reg[9] = data;
       switch ( data&0x03 )
       {
       case 0:
@@ -354,129 +364,129 @@ void CROMMapper016::HMAPPER ( uint32_t addr, uint8_t data )
       break;
    case 0x000A:
       reg = 10;
-      m_reg[10] = data;
-      m_irqEnabled = data&0x01;
-      m_irqAsserted = false;
+      m_state->m_reg[10] = data;
+      m_state->m_irqEnabled = data&0x01;
+      m_state->m_irqAsserted = false;
       C6502::RELEASEIRQ(eNESSource_Mapper);
       break;
    case 0x000B:
       reg = 11;
-      m_reg[11] = data;
-      m_irqCounter &= 0xFF00;
-      m_irqCounter |= data;
+      m_state->m_reg[11] = data;
+      m_state->m_irqCounter &= 0xFF00;
+      m_state->m_irqCounter |= data;
       break;
    case 0x000C:
       reg = 12;
-      m_reg[12] = data;
-      m_irqCounter &= 0x00FF;
-      m_irqCounter |= (data<<8);
+      m_state->m_reg[12] = data;
+      m_state->m_irqCounter &= 0x00FF;
+      m_state->m_irqCounter |= (data<<8);
       break;
    case 0x000D:
       reg = 13;
       // Check for START/STOP
-      if ( (m_reg[13]&0x20) && (data&0x20) )
+      if ( (m_state->m_reg[13]&0x20) && (data&0x20) )
       {
          // Clock is high, did data go low?  If so, START
-         if ( (m_reg[13]&0x40) && (!(data&0x40)) )
+         if ( (m_state->m_reg[13]&0x40) && (!(data&0x40)) )
          {
             // EEPROM in mapper 159 skips address phase
-            if ( m_mapper == 16 )
+            if ( CROM::m_state->m_mapper == 16 )
             {
-               m_eepromState = 1;
+               m_state->m_eepromState = 1;
             }
             else
             {
-               m_eepromState = 2;
+               m_state->m_eepromState = 2;
             }
-            m_eepromBitCounter = 0;
+            m_state->m_eepromBitCounter = 0;
          }
          // Clock is high, did data go high?  If so, STOP
-         if ( (!(m_reg[13]&0x40)) && (data&0x40) )
+         if ( (!(m_state->m_reg[13]&0x40)) && (data&0x40) )
          {
-            m_eepromState = 0;
+            m_state->m_eepromState = 0;
          }
       }
 
       // Did clock transition?
-      if ( (!(m_reg[13]&0x20)) && (data&0x20) )
+      if ( (!(m_state->m_reg[13]&0x20)) && (data&0x20) )
       {
          // positive edge
-         switch ( m_eepromState )
+         switch ( m_state->m_eepromState )
          {
          case 1:
             // Accepting command
-            if ( m_eepromBitCounter < 8 )
+            if ( m_state->m_eepromBitCounter < 8 )
             {
-               m_eepromCmd <<= 1;
-               m_eepromCmd &= 0xFF;
-               m_eepromCmd |= ((data&0x40)>>6);
+               m_state->m_eepromCmd <<= 1;
+               m_state->m_eepromCmd &= 0xFF;
+               m_state->m_eepromCmd |= ((data&0x40)>>6);
             }
-            m_eepromBitCounter++;
+            m_state->m_eepromBitCounter++;
             break;
          case 2:
             // Accepting address
-            if ( m_eepromBitCounter < 8 )
+            if ( m_state->m_eepromBitCounter < 8 )
             {
-               m_eepromAddr <<= 1;
-               m_eepromAddr &= 0xFF;
-               m_eepromAddr |= ((data&0x40)>>6);
+               m_state->m_eepromAddr <<= 1;
+               m_state->m_eepromAddr &= 0xFF;
+               m_state->m_eepromAddr |= ((data&0x40)>>6);
             }
-            m_eepromBitCounter++;
+            m_state->m_eepromBitCounter++;
             break;
          case 3:
             // Command execution
-            if ( m_mapper == 16 )
+            if ( CROM::m_state->m_mapper == 16 )
             {
-               m_eepromRWBit = m_eepromCmd&0x01;
+               m_state->m_eepromRWBit = m_state->m_eepromCmd&0x01;
             }
             else
             {
-               m_eepromRWBit = m_eepromAddr&0x01;
+               m_state->m_eepromRWBit = m_state->m_eepromAddr&0x01;
             }
-            switch ( m_eepromRWBit )
+            switch ( m_state->m_eepromRWBit )
             {
             case 0:
                // Write
-               m_eepromDataBuf <<= 1;
-               m_eepromDataBuf |= ((data&0x40)>>6);
+               m_state->m_eepromDataBuf <<= 1;
+               m_state->m_eepromDataBuf |= ((data&0x40)>>6);
 
-               m_eepromBitCounter++;
-               if ( m_eepromBitCounter == 8 )
+               m_state->m_eepromBitCounter++;
+               if ( m_state->m_eepromBitCounter == 8 )
                {
-                  if ( m_mapper == 16 )
+                  if ( CROM::m_state->m_mapper == 16 )
                   {
-                     CROM::SRAMVIRT(0x6000+m_eepromAddr,m_eepromDataBuf);
+                     CROM::SRAMVIRT(0x6000+m_state->m_eepromAddr,m_state->m_eepromDataBuf);
                   }
                   else
                   {
-                     CROM::SRAMVIRT(0x6000+(m_eepromAddr>>1),m_eepromDataBuf);
+                     CROM::SRAMVIRT(0x6000+(m_state->m_eepromAddr>>1),m_state->m_eepromDataBuf);
                   }
                   CNES::FORCEBREAKPOINT();
-                  if ( m_mapper == 16 )
+                  if ( CROM::m_state->m_mapper == 16 )
                   {
-                     m_eepromAddr++;
-                     m_eepromAddr %= 0x100;
+                     m_state->m_eepromAddr++;
+                     m_state->m_eepromAddr %= 0x100;
                   }
                   else
                   {
-                     m_eepromAddr += 2;
-                     m_eepromAddr %= 0x100;
+                     m_state->m_eepromAddr += 2;
+                     m_state->m_eepromAddr %= 0x100;
                   }
                }
                break;
             case 1:
-               if ( m_eepromBitCounter == 8 )
+               if ( m_state->m_eepromBitCounter == 8 )
                {
-                  m_eepromBitCounter++;
-                  if ( m_mapper == 16 )
+                  m_state->m_eepromBitCounter++;
+                  if ( CROM::m_state->m_mapper == 16 )
                   {
-                     m_eepromAddr++;
-                     m_eepromAddr %= 0x100;
+                     m_state->m_eepromAddr++;
+                     m_state->m_eepromAddr %= 0x100;
                   }
                   else
                   {
-                     m_eepromAddr += 2;
-                     m_eepromAddr %= 0x100;
+                     m_state->m_eepromAddr += 2;
+                     m_state->m_eepromAddr %= 0x100;
                   }
                }
             }
@@ -485,7 +495,7 @@ void CROMMapper016::HMAPPER ( uint32_t addr, uint8_t data )
       }
 
       // NOTE: m_reg[13] is used to keep track of the previous pin states!
-      m_reg[13] = data;
+      m_state->m_reg[13] = data;
       break;
    }
 
@@ -15,54 +15,63 @@ public:
    static uint32_t LMAPPER ( uint32_t addr );
    static void LMAPPER ( uint32_t addr, uint8_t data );
    static void SYNCCPU ( void );
+   static uint32_t CPUIDLE ( void );
+   static void SKIPCPU ( uint32_t cycles );
    static uint32_t DEBUGINFO ( uint32_t addr );
 
    // Internal accessors for mapper information inspector...
    // Note: called directly!
    static uint32_t IRQENABLED ( void )
    {
-      return m_irqEnabled;
+      return m_state->m_irqEnabled;
    }
    static uint32_t IRQCOUNTER ( void )
    {
-      return m_irqCounter;
+      return m_state->m_irqCounter;
    }
    static uint32_t IRQASSERTED ( void )
    {
-      return m_irqAsserted;
+      return m_state->m_irqAsserted;
    }
    static uint32_t EEPROMSTATE ( void )
    {
-      return m_eepromState;
+      return m_state->m_eepromState;
    }
    static uint32_t EEPROMBITCOUNTER ( void )
    {
-      return m_eepromBitCounter;
+      return m_state->m_eepromBitCounter;
    }
    static uint32_t EEPROMCMD ( void )
    {
-      return m_eepromCmd;
+      return m_state->m_eepromCmd;
    }
    static uint32_t EEPROMADDR ( void )
    {
-      return m_eepromAddr;
+      return m_state->m_eepromAddr;
    }
    static uint32_t EEPROMDATABUF ( void )
    {
-      return m_eepromDataBuf;
+      return m_state->m_eepromDataBuf;
    }
 
 protected:
-   static uint8_t  m_reg [ 14 ];
-   static uint16_t m_irqCounter;
-   static bool     m_irqEnabled;
-   static bool     m_irqAsserted;
-   static uint8_t  m_eepromBitCounter;
-   static uint8_t  m_eepromState;
-   static uint8_t  m_eepromCmd;
-   static uint8_t  m_eepromAddr;
-   static uint8_t  m_eepromDataBuf;
-   static uint8_t  m_eepromRWBit;
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      uint8_t m_reg [ 14 ] = { 0x00, };
+      uint16_t m_irqCounter = 0;
+      bool m_irqEnabled = false;
+      bool m_irqAsserted = false;
+      uint8_t m_eepromBitCounter = 0;
+      uint8_t m_eepromState = 0;
+      uint8_t m_eepromCmd;
+      uint8_t m_eepromAddr;
+      uint8_t m_eepromDataBuf;
+      uint8_t m_eepromRWBit;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
    // We'll use the SRAM interface in CROM object to store
    // the EEPROM data so that it gets saved using the regular
    // save-state mechanics.
@@ -129,12 +129,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,29,29,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper018::m_reg [] = { 0x00, };
-uint8_t  CROMMapper018::m_prg [] = { 0x00, };
-uint8_t  CROMMapper018::m_chr [] = { 0x00, };
-uint16_t CROMMapper018::m_irqReload = 0;
-uint16_t CROMMapper018::m_irqCounter = 0;
-bool     CROMMapper018::m_irqEnabled = false;
+CROMMapper018::State CROMMapper018::m_defaultState;
+thread_local CROMMapper018::State* CROMMapper018::m_state = &CROMMapper018::m_defaultState;
 
 CROMMapper018::CROMMapper018()
 {
@@ -148,62 +144,64 @@ void CROMMapper018::RESET ( bool soft )
 {
    int32_t idx;
 
-   m_mapper = 18;
+   CROM::m_state->m_mapper = 18;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
-   m_irqReload = 0;
-   m_irqCounter = 0;
-   m_irqEnabled = false;
+   m_state->m_irqReload = 0;
+   m_state->m_irqCounter = 0;
+   m_state->m_irqEnabled = false;
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
 
+uint16_t CROMMapper018::COUNTERMASK ( void )
+{
+   uint8_t size = ((m_state->m_reg[27]&0x0E)>>1);
+
+   if ( size == 0 )
+   {
+      // 16 bits
+      return 0xFFFF;
+   }
+   else if ( size == 1 )
+   {
+      // 12 bits
+      return 0x0FFF;
+   }
+   else if ( size < 4 )
+   {
+      // 8 bits
+      return 0x00FF;
+   }
+
+   // 4 bits
+   return 0x000F;
+}
+
 void CROMMapper018::SYNCCPU ( void )
 {
    uint16_t counterMask;
    uint16_t counter;
-   uint8_t  size;
-
-   size = ((m_reg[27]&0x0E)>>1);
 
-   if ( m_irqEnabled )
+   if ( m_state->m_irqEnabled )
    {
       // Get relevant counter bits.
-      if ( size == 0 )
-      {
-         // 16 bits
-         counterMask = 0xFFFF;
-      }
-      else if ( size == 1 )
-      {
-         // 12 bits
-         counterMask = 0x0FFF;
-      }
-      else if ( size < 4 )
-      {
-         // 8 bits
-         counterMask = 0x00FF;
-      }
-      else
-      {
-         // 4 bits
-         counterMask = 0x000F;
-      }
+      counterMask = COUNTERMASK();
 
-      counter = m_irqCounter&counterMask;
+      counter = m_state->m_irqCounter&counterMask;
       counter--;
-      m_irqCounter &= (~counterMask);
-      m_irqCounter |= (counter&counterMask);
+      m_state->m_irqCounter &= (~counterMask);
+      m_state->m_irqCounter |= (counter&counterMask);
 
-      if ( (m_irqCounter&counterMask) == counterMask )
+      if ( (m_state->m_irqCounter&counterMask) == counterMask )
       {
          C6502::ASSERTIRQ(eNESSource_Mapper);
 
@@ -216,96 +214,119 @@ void CROMMapper018::SYNCCPU ( void )
    }
 }
 
+uint32_t CROMMapper018::CPUIDLE ( void )
+{
+   if ( m_state->m_irqEnabled )
+   {
+      // The IRQ fires on the cycle the counter's live bits wrap.
+      return m_state->m_irqCounter&COUNTERMASK();
+   }
+   return MAPPER_IDLE_FOREVER;
+}
+
+void CROMMapper018::SKIPCPU ( uint32_t cycles )
+{
+   uint16_t counterMask = COUNTERMASK();
+   uint16_t counter;
+
+   if ( m_state->m_irqEnabled )
+   {
+      counter = (m_state->m_irqCounter&counterMask)-cycles;
+      m_state->m_irqCounter &= (~counterMask);
+      m_state->m_irqCounter |= (counter&counterMask);
+   }
+}
+
 uint32_t CROMMapper018::DEBUGINFO ( uint32_t addr )
 {
    switch ( addr )
    {
    case 0x8000:
-      return m_reg[0];
+      return m_state->m_reg[0];
       break;
    case 0x8001:
-      return m_reg[1];
+      return m_state->m_reg[1];
       break;
    case 0x8002:
-      return m_reg[2];
+      return m_state->m_reg[2];
       break;
    case 0x8003:
-      return m_reg[3];
+      return m_state->m_reg[3];
       break;
    case 0x9000:
-      return m_reg[4];
+      return m_state->m_reg[4];
       break;
    case 0x9001:
-      return m_reg[5];
+      return m_state->m_reg[5];
       break;
    case 0xA000:
-      return m_reg[6];
+      return m_state->m_reg[6];
       break;
    case 0xA001:
-      return m_reg[7];
+      return m_state->m_reg[7];
       break;
    case 0xA002:
-      return m_reg[8];
+      return m_state->m_reg[8];
       break;
    case 0xA003:
-      return m_reg[9];
+      return m_state->m_reg[9];
       break;
    case 0xB000:
-      return m_reg[10];
+      return m_state->m_reg[10];
       break;
    case 0xB001:
-      return m_reg[11];
+      return m_state->m_reg[11];
       break;
    case 0xB002:
-      return m_reg[12];
+      return m_state->m_reg[12];
       break;
    case 0xB003:
-      return m_reg[13];
+      return m_state->m_reg[13];
       break;
    case 0xC000:
-      return m_reg[14];
+      return m_state->m_reg[14];
       break;
    case 0xC001:
-      return m_reg[15];
+      return m_state->m_reg[15];
       break;
    case 0xC002:
-      return m_reg[16];
+      return m_state->m_reg[16];
       break;
    case 0xC003:
-      return m_reg[17];
+      return m_state->m_reg[17];
       break;
    case 0xD000:
-      return m_reg[18];
+      return m_state->m_reg[18];
       break;
    case 0xD001:
-      return m_reg[19];
+      return m_state->m_reg[19];
       break;
    case 0xD002:
-      return m_reg[20];
+      return m_state->m_reg[20];
       break;
    case 0xD003:
-      return m_reg[21];
+      return m_state->m_reg[21];
       break;
    case 0xE000:
-      return m_reg[22];
+      return m_state->m_reg[22];
       break;
    case 0xE001:
-      return m_reg[23];
+      return m_state->m_reg[23];
       break;
    case 0xE002:
-      return m_reg[24];
+      return m_state->m_reg[24];
       break;
    case 0xE003:
-      return m_reg[25];
+      return m_state->m_reg[25];
       break;
    case 0xF000:
-      return m_reg[26];
+      return m_state->m_reg[26];
       break;
    case 0xF001:
-      return m_reg[27];
+      return m_state->m_reg[27];
       break;
    case 0xF002:
-      return m_reg[28];
+      return m_state->m_reg[28];
       break;
    }
 }
@@ -318,193 +339,193 @@ void CROMMapper018::HMAPPER ( uint32_t addr, uint8_t data )
    {
    case 0x8000:
       reg = 0;
-      m_reg[0] = data;
-      m_prg[0] &= 0xF0;
-      m_prg[0] |= (data&0x0F);
-      m_pPRGROMmemory[0] = m_PRGROMmemory[m_prg[0]%m_numPrgBanks];
+      m_state->m_reg[0] = data;
+      m_state->m_prg[0] &= 0xF0;
+      m_state->m_prg[0] |= (data&0x0F);
+      CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory[m_state->m_prg[0]%CROM::m_state->m_numPrgBanks] );
    case 0x8001:
       reg = 1;
-      m_reg[1] = data;
-      m_prg[0] &= 0x0F;
-      m_prg[0] |= (data<<4);
-      m_pPRGROMmemory[0] = m_PRGROMmemory[m_prg[0]%m_numPrgBanks];
+      m_state->m_reg[1] = data;
+      m_state->m_prg[0] &= 0x0F;
+      m_state->m_prg[0] |= (data<<4);
+      CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory[m_state->m_prg[0]%CROM::m_state->m_numPrgBanks] );
    case 0x8002:
       reg = 2;
-      m_reg[2] = data;
-      m_prg[1] &= 0xF0;
-      m_prg[1] |= (data&0x0F);
-      m_pPRGROMmemory[1] = m_PRGROMmemory[m_prg[1]%m_numPrgBanks];
+      m_state->m_reg[2] = data;
+      m_state->m_prg[1] &= 0xF0;
+      m_state->m_prg[1] |= (data&0x0F);
+      CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory[m_state->m_prg[1]%CROM::m_state->m_numPrgBanks] );
    case 0x8003:
       reg = 3;
-      m_reg[3] = data;
-      m_prg[1] &= 0x0F;
-      m_prg[1] |= (data<<4);
-      m_pPRGROMmemory[1] = m_PRGROMmemory[m_prg[1]%m_numPrgBanks];
+      m_state->m_reg[3] = data;
+      m_state->m_prg[1] &= 0x0F;
+      m_state->m_prg[1] |= (data<<4);
+      CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory[m_state->m_prg[1]%CROM::m_state->m_numPrgBanks] );
       break;
    case 0x9000:
       reg = 4;
-      m_reg[4] = data;
-      m_prg[2] &= 0xF0;
-      m_prg[2] |= (data&0x0F);
-      m_pPRGROMmemory[2] = m_PRGROMmemory[m_prg[2]%m_numPrgBanks];
+      m_state->m_reg[4] = data;
+      m_state->m_prg[2] &= 0xF0;
+      m_state->m_prg[2] |= (data&0x0F);
+      CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory[m_state->m_prg[2]%CROM::m_state->m_numPrgBanks] );
    case 0x9001:
       reg = 5;
-      m_reg[5] = data;
-      m_prg[2] &= 0x0F;
-      m_prg[2] |= (data<<4);
-      m_pPRGROMmemory[2] = m_PRGROMmemory[m_prg[2]%m_numPrgBanks];
+      m_state->m_reg[5] = data;
+      m_state->m_prg[2] &= 0x0F;
+      m_state->m_prg[2] |= (data<<4);
+      CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory[m_state->m_prg[2]%CROM::m_state->m_numPrgBanks] );
       break;
    case 0xA000:
       reg = 6;
-      m_reg[6] = data;
-      m_chr[0] &= 0xF0;
-      m_chr[0] |= (data&0x0F);
-      m_pCHRmemory[0] = m_CHRmemory[m_chr[0]];
+      m_state->m_reg[6] = data;
+      m_state->m_chr[0] &= 0xF0;
+      m_state->m_chr[0] |= (data&0x0F);
+      CROM::m_state->m_pCHRmemory[0] = CROM::m_state->m_CHRmemory[m_state->m_chr[0]];
       break;
    case 0xA001:
       reg = 7;
-      m_reg[7] = data;
-      m_chr[0] &= 0x0F;
-      m_chr[0] |= (data<<4);
-      m_pCHRmemory[0] = m_CHRmemory[m_chr[0]];
+      m_state->m_reg[7] = data;
+      m_state->m_chr[0] &= 0x0F;
+      m_state->m_chr[0] |= (data<<4);
+      CROM::m_state->m_pCHRmemory[0] = CROM::m_state->m_CHRmemory[m_state->m_chr[0]];
       break;
    case 0xA002:
       reg = 8;
-      m_reg[8] = data;
-      m_chr[1] &= 0xF0;
-      m_chr[1] |= (data&0x0F);
-      m_pCHRmemory[1] = m_CHRmemory[m_chr[1]];
+      m_state->m_reg[8] = data;
+      m_state->m_chr[1] &= 0xF0;
+      m_state->m_chr[1] |= (data&0x0F);
+      CROM::m_state->m_pCHRmemory[1] = CROM::m_state->m_CHRmemory[m_state->m_chr[1]];
       break;
    case 0xA003:
       reg = 9;
-      m_reg[9] = data;
-      m_chr[1] &= 0x0F;
-      m_chr[1] |= (data<<4);
-      m_pCHRmemory[1] = m_CHRmemory[m_chr[1]];
+      m_state->m_reg[9] = data;
+      m_state->m_chr[1] &= 0x0F;
+      m_state->m_chr[1] |= (data<<4);
+      CROM::m_state->m_pCHRmemory[1] = CROM::m_state->m_CHRmemory[m_state->m_chr[1]];
       break;
    case 0xB000:
       reg = 10;
-      m_reg[10] = data;
-      m_chr[2] &= 0xF0;
-      m_chr[2] |= (data&0x0F);
-      m_pCHRmemory[2] = m_CHRmemory[m_chr[2]];
+      m_state->m_reg[10] = data;
+      m_state->m_chr[2] &= 0xF0;
+      m_state->m_chr[2] |= (data&0x0F);
+      CROM::m_state->m_pCHRmemory[2] = CROM::m_state->m_CHRmemory[m_state->m_chr[2]];
       break;
    case 0xB001:
       reg = 11;
-      m_reg[11] = data;
-      m_chr[2] &= 0x0F;
-      m_chr[2] |= (data<<4);
-      m_pCHRmemory[2] = m_CHRmemory[m_chr[2]];
+      m_state->m_reg[11] = data;
+      m_state->m_chr[2] &= 0x0F;
+      m_state->m_chr[2] |= (data<<4);
+      CROM::m_state->m_pCHRmemory[2] = CROM::m_state->m_CHRmemory[m_state->m_chr[2]];
       break;
    case 0xB002:
       reg = 12;
-      m_reg[12] = data;
-      m_chr[3] &= 0xF0;
-      m_chr[3] |= (data&0x0F);
-      m_pCHRmemory[3] = m_CHRmemory[m_chr[3]];
+      m_state->m_reg[12] = data;
+      m_state->m_chr[3] &= 0xF0;
+      m_state->m_chr[3] |= (data&0x0F);
+      CROM::m_state->m_pCHRmemory[3] = CROM::m_state->m_CHRmemory[m_state->m_chr[3]];
       break;
    case 0xB003:
       reg = 13;
-      m_reg[13] = data;
-      m_chr[3] &= 0x0F;
-      m_chr[3] |= (data<<4);
-      m_pCHRmemory[3] = m_CHRmemory[m_chr[3]];
+      m_state->m_reg[13] = data;
+      m_state->m_chr[3] &= 0x0F;
+      m_state->m_chr[3] |= (data<<4);
+      CROM::m_state->m_pCHRmemory[3] = CROM::m_state->m_CHRmemory[m_state->m_chr[3]];
       break;
    case 0xC000:
       reg = 14;
-      m_reg[14] = data;
-      m_chr[4] &= 0xF0;
-      m_chr[4] |= (data&0x0F);
-      m_pCHRmemory[4] = m_CHRmemory[m_chr[4]];
+      m_state->m_reg[14] = data;
+      m_state->m_chr[4] &= 0xF0;
+      m_state->m_chr[4] |= (data&0x0F);
+      CROM::m_state->m_pCHRmemory[4] = CROM::m_state->m_CHRmemory[m_state->m_chr[4]];
       break;
    case 0xC001:
       reg = 15;
-      m_reg[15] = data;
-      m_chr[4] &= 0x0F;
-      m_chr[4] |= (data<<4);
-      m_pCHRmemory[4] = m_CHRmemory[m_chr[4]];
+      m_state->m_reg[15] = data;
+      m_state->m_chr[4] &= 0x0F;
+      m_state->m_chr[4] |= (data<<4);
+      CROM::m_state->m_pCHRmemory[4] = CROM::m_state->m_CHRmemory[m_state->m_chr[4]];
       break;
    case 0xC002:
       reg = 16;
-      m_reg[16] = data;
-      m_chr[5] &= 0xF0;
-      m_chr[5] |= (data&0x0F);
-      m_pCHRmemory[5] = m_CHRmemory[m_chr[5]];
+      m_state->m_reg[16] = data;
+      m_state->m_chr[5] &= 0xF0;
+      m_state->m_chr[5] |= (data&0x0F);
+      CROM::m_state->m_pCHRmemory[5] = CROM::m_state->m_CHRmemory[m_state->m_chr[5]];
       break;
    case 0xC003:
       reg = 17;
-      m_reg[17] = data;
-      m_chr[5] &= 0x0F;
-      m_chr[5] |= (data<<4);
-      m_pCHRmemory[5] = m_CHRmemory[m_chr[5]];
+      m_state->m_reg[17] = data;
+      m_state->m_chr[5] &= 0x0F;
+      m_state->m_chr[5] |= (data<<4);
+      CROM::m_state->m_pCHRmemory[5] = CROM::m_state->m_CHRmemory[m_state->m_chr[5]];
       break;
    case 0xD000:
       reg = 18;
-      m_reg[18] = data;
-      m_chr[6] &= 0xF0;
-      m_chr[6] |= (data&0x0F);
-      m_pCHRmemory[6] = m_CHRmemory[m_chr[6]];
+      m_state->m_reg[18] = data;
+      m_state->m_chr[6] &= 0xF0;
+      m_state->m_chr[6] |= (data&0x0F);
+      CROM::m_state->m_pCHRmemory[6] = CROM::m_state->m_CHRmemory[m_state->m_chr[6]];
       break;
    case 0xD001:
       reg = 19;
-      m_reg[19] = data;
-      m_chr[6] &= 0x0F;
-      m_chr[6] |= (data<<4);
-      m_pCHRmemory[6] = m_CHRmemory[m_chr[6]];
+      m_state->m_reg[19] = data;
+      m_state->m_chr[6] &= 0x0F;
+      m_state->m_chr[6] |= (data<<4);
+      CROM::m_state->m_pCHRmemory[6] = CROM::m_state->m_CHRmemory[m_state->m_chr[6]];
       break;
    case 0xD002:
       reg = 20;
-      m_reg[20] = data;
-      m_chr[7] &= 0xF0;
-      m_chr[7] |= (data&0x0F);
-      m_pCHRmemory[7] = m_CHRmemory[m_chr[7]];
+      m_state->m_reg[20] = data;
+      m_state->m_chr[7] &= 0xF0;
+      m_state->m_chr[7] |= (data&0x0F);
+      CROM::m_state->m_pCHRmemory[7] = CROM::m_state->m_CHRmemory[m_state->m_chr[7]];
       break;
    case 0xD003:
       reg = 21;
-      m_reg[21] = data;
-      m_chr[7] &= 0x0F;
-      m_chr[7] |= (data<<4);
-      m_pCHRmemory[7] = m_CHRmemory[m_chr[7]];
+      m_state->m_reg[21] = data;
+      m_state->m_chr[7] &= 0x0F;
+      m_state->m_chr[7] |= (data<<4);
+      CROM::m_state->m_pCHRmemory[7] = CROM::m_state->m_CHRmemory[m_state->m_chr[7]];
       break;
    case 0xE000:
       reg = 22;
-      m_reg[22] = data;
-      m_irqReload &= 0xFFF0;
-      m_irqReload |= (data&0x0F);
+      m_state->m_reg[22] = data;
+      m_state->m_irqReload &= 0xFFF0;
+      m_state->m_irqReload |= (data&0x0F);
       break;
    case 0xE001:
       reg = 23;
-      m_reg[23] = data;
-      m_irqReload &= 0xFF0F;
-      m_irqReload |= ((data&0x0F)<<4);
+      m_state->m_reg[23] = data;
+      m_state->m_irqReload &= 0xFF0F;
+      m_state->m_irqReload |= ((data&0x0F)<<4);
       break;
    case 0xE002:
       reg = 24;
-      m_reg[24] = data;
-      m_irqReload &= 0xF0FF;
-      m_irqReload |= ((data&0x0F)<<8);
+      m_state->m_reg[24] = data;
+      m_state->m_irqReload &= 0xF0FF;
+      m_state->m_irqReload |= ((data&0x0F)<<8);
       break;
    case 0xE003:
       reg = 25;
-      m_reg[25] = data;
-      m_irqReload &= 0x0FFF;
-      m_irqReload |= ((data&0x0F)<<12);
+      m_state->m_reg[25] = data;
+      m_state->m_irqReload &= 0x0FFF;
+      m_state->m_irqReload |= ((data&0x0F)<<12);
       break;
    case 0xF000:
       reg = 26;
-      m_reg[26] = data;
-      m_irqCounter = m_irqReload;
+      m_state->m_reg[26] = data;
+      m_state->m_irqCounter = m_state->m_irqReload;
       C6502::RELEASEIRQ(eNESSource_Mapper);
       break;
    case 0xF001:
       reg = 27;
-      m_reg[27] = data;
-      m_irqEnabled = data&0x01;
+      m_state->m_reg[27] = data;
+      m_state->m_irqEnabled = data&0x01;
       C6502::RELEASEIRQ(eNESSource_Mapper);
       break;
    case 0xF002:
       reg = 28;
-      m_reg[28] = data;
+      m_state->m_reg[28] = data;
       switch ( data&0x03 )
       {
       case 0:
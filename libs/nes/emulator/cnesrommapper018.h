@@ -12,15 +12,27 @@ public:
    static void RESET ( bool soft );
    static void HMAPPER ( uint32_t addr, uint8_t data );
    static void SYNCCPU ( void );
+   static uint32_t CPUIDLE ( void );
+   static void SKIPCPU ( uint32_t cycles );
    static uint32_t DEBUGINFO ( uint32_t addr );
 
 protected:
-   static uint8_t  m_reg [ 29 ];
-   static uint8_t  m_prg [ 3 ];
-   static uint8_t  m_chr [ 8 ];
-   static uint16_t m_irqReload;
-   static uint16_t m_irqCounter;
-   static bool     m_irqEnabled;
+   // The IRQ counter bits that count, as picked by its size setting.
+   static uint16_t COUNTERMASK ( void );
+
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      uint8_t m_reg [ 29 ] = { 0x00, };
+      uint8_t m_prg [ 3 ] = { 0x00, };
+      uint8_t m_chr [ 8 ] = { 0x00, };
+      uint16_t m_irqReload = 0;
+      uint16_t m_irqCounter = 0;
+      bool m_irqEnabled = false;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 };
 
 #endif
@@ -104,14 +104,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,19,19,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper019::m_reg [] = { 0x00, };
-uint8_t  CROMMapper019::m_chr [];
-uint16_t CROMMapper019::m_irqCounter = 0;
-bool     CROMMapper019::m_irqEnabled = false;
-N106WaveChannel CROMMapper019::m_wave[8];
-uint8_t  CROMMapper019::m_soundRAM [];
-uint8_t  CROMMapper019::m_soundRAMAddr;
-uint8_t  CROMMapper019::m_soundChansEnabled = 0;
+CROMMapper019::State CROMMapper019::m_defaultState;
+thread_local CROMMapper019::State* CROMMapper019::m_state = &CROMMapper019::m_defaultState;
 
 CROMMapper019::CROMMapper019()
 {
@@ -125,27 +119,30 @@ void CROMMapper019::RESET ( bool soft )
 {
    int32_t idx;
 
-   m_mapper = 19;
+   CROM::m_state->m_mapper = 19;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
+
+   // CHR-RAM lives in the CHR banks above the largest CHR-ROM.
+   CROM::ALLOCATECHREXTRABANKS ();
 
    for ( idx = 0; idx < 8; idx++ )
    {
-      m_wave[idx].SOUNDRAM(m_soundRAM);
-      m_wave[idx].RESET();
+      m_state->m_wave[idx].SOUNDRAM(m_state->m_soundRAM);
+      m_state->m_wave[idx].RESET();
    }
-   m_soundRAMAddr = 0;
-   m_soundChansEnabled = 0;
+   m_state->m_soundRAMAddr = 0;
+   m_state->m_soundChansEnabled = 0;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
-   m_irqCounter = 0;
-   m_irqEnabled = false;
+   m_state->m_irqCounter = 0;
+   m_state->m_irqEnabled = false;
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
@@ -156,12 +153,12 @@ void CROMMapper019::SYNCCPU ( void )
 
    for ( idx = 0; idx < 8; idx++ )
    {
-      m_wave[idx].TIMERTICK(m_soundChansEnabled);
+      m_state->m_wave[idx].TIMERTICK(m_state->m_soundChansEnabled);
    }
 
-   if ( m_irqEnabled )
+   if ( m_state->m_irqEnabled )
    {
-      if ( m_irqCounter == 0x7FFF )
+      if ( m_state->m_irqCounter == 0x7FFF )
       {
          C6502::ASSERTIRQ(eNESSource_Mapper);
 
@@ -173,7 +170,35 @@ void CROMMapper019::SYNCCPU ( void )
       }
       else
       {
-         m_irqCounter++;
+         m_state->m_irqCounter++;
+      }
+   }
+}
+
+uint32_t CROMMapper019::CPUIDLE ( void )
+{
+   if ( m_state->m_irqEnabled )
+   {
+      // The IRQ fires once the counter has counted up to $7FFF.
+      return 0x7FFF-m_state->m_irqCounter;
+   }
+   return MAPPER_IDLE_FOREVER;
+}
+
+void CROMMapper019::SKIPCPU ( uint32_t cycles )
+{
+   int32_t idx;
+
+   if ( m_state->m_irqEnabled )
+   {
+      m_state->m_irqCounter += cycles;
+   }
+
+   while ( cycles-- )
+   {
+      for ( idx = 0; idx < 8; idx++ )
+      {
+         m_state->m_wave[idx].TIMERTICK(m_state->m_soundChansEnabled);
       }
    }
 }
@@ -183,61 +208,61 @@ uint32_t CROMMapper019::DEBUGINFO ( uint32_t addr )
    switch ( addr )
    {
    case 0x4800:
-      return m_reg[0];
+      return m_state->m_reg[0];
       break;
    case 0x5000:
-      return m_reg[1];
+      return m_state->m_reg[1];
       break;
    case 0x5800:
-      return m_reg[2];
+      return m_state->m_reg[2];
       break;
    case 0x8000:
-      return m_reg[3];
+      return m_state->m_reg[3];
       break;
    case 0x8800:
-      return m_reg[4];
+      return m_state->m_reg[4];
       break;
    case 0x9000:
-      return m_reg[5];
+      return m_state->m_reg[5];
       break;
    case 0x9800:
-      return m_reg[6];
+      return m_state->m_reg[6];
       break;
    case 0xA000:
-      return m_reg[7];
+      return m_state->m_reg[7];
       break;
    case 0xA800:
-      return m_reg[8];
+      return m_state->m_reg[8];
       break;
    case 0xB000:
-      return m_reg[9];
+      return m_state->m_reg[9];
       break;
    case 0xB800:
-      return m_reg[10];
+      return m_state->m_reg[10];
       break;
    case 0xC000:
-      return m_reg[11];
+      return m_state->m_reg[11];
       break;
    case 0xC800:
-      return m_reg[12];
+      return m_state->m_reg[12];
       break;
    case 0xD000:
-      return m_reg[13];
+      return m_state->m_reg[13];
       break;
    case 0xD800:
-      return m_reg[14];
+      return m_state->m_reg[14];
       break;
    case 0xE000:
-      return m_reg[15];
+      return m_state->m_reg[15];
       break;
    case 0xE800:
-      return m_reg[16];
+      return m_state->m_reg[16];
       break;
    case 0xF000:
-      return m_reg[17];
+      return m_state->m_reg[17];
       break;
    case 0xF800:
-      return m_reg[18];
+      return m_state->m_reg[18];
       break;
    }
 }
@@ -251,21 +276,21 @@ uint32_t CROMMapper019::LMAPPER ( uint32_t addr )
    {
    case 0x4800:
       reg = 0;
-      data = m_soundRAM[m_soundRAMAddr];
-      if ( m_reg[18]&0x80 )
+      data = m_state->m_soundRAM[m_state->m_soundRAMAddr];
+      if ( m_state->m_reg[18]&0x80 )
       {
-         m_soundRAMAddr++;
-         m_soundRAMAddr &= 0x7F;
+         m_state->m_soundRAMAddr++;
+         m_state->m_soundRAMAddr &= 0x7F;
       }
       break;
    case 0x5000:
       reg = 1;
-      data = m_reg[1];
+      data = m_state->m_reg[1];
       C6502::RELEASEIRQ(eNESSource_Mapper);
       break;
    case 0x5800:
       reg = 2;
-      data = m_reg[2];
+      data = m_state->m_reg[2];
       C6502::RELEASEIRQ(eNESSource_Mapper);
       break;
    }
@@ -287,39 +312,39 @@ void CROMMapper019::LMAPPER ( uint32_t addr, uint8_t data )
    {
    case 0x4800:
       reg = 0;
-      m_reg[0] = data;
-      m_soundRAM[m_soundRAMAddr] = data;
-      if ( m_soundRAMAddr >= 0x40 )
+      m_state->m_reg[0] = data;
+      m_state->m_soundRAM[m_state->m_soundRAMAddr] = data;
+      if ( m_state->m_soundRAMAddr >= 0x40 )
       {
-         m_wave[(m_soundRAMAddr-0x40)/0x8].REG(m_soundRAMAddr&0x7,data);
+         m_state->m_wave[(m_state->m_soundRAMAddr-0x40)/0x8].REG(m_state->m_soundRAMAddr&0x7,data);
       }
 
       // Special case "register" 0x7F for channel enabled count.
-      if ( m_soundRAMAddr == 0x7F )
+      if ( m_state->m_soundRAMAddr == 0x7F )
       {
-         m_soundChansEnabled = ((data>>4)&0x7);
+         m_state->m_soundChansEnabled = ((data>>4)&0x7);
       }
 
-      if ( m_reg[18]&0x80 )
+      if ( m_state->m_reg[18]&0x80 )
       {
-         m_soundRAMAddr++;
-         m_soundRAMAddr &= 0x7F;
+         m_state->m_soundRAMAddr++;
+         m_state->m_soundRAMAddr &= 0x7F;
       }
       break;
    case 0x5000:
       reg = 1;
-      m_reg[1] = data;
+      m_state->m_reg[1] = data;
       C6502::RELEASEIRQ(eNESSource_Mapper);
-      m_irqCounter &= 0xFF00;
-      m_irqCounter |= data;
+      m_state->m_irqCounter &= 0xFF00;
+      m_state->m_irqCounter |= data;
       break;
    case 0x5800:
       reg = 2;
-      m_reg[2] = data;
+      m_state->m_reg[2] = data;
       C6502::RELEASEIRQ(eNESSource_Mapper);
-      m_irqCounter &= 0x00FF;
-      m_irqCounter |= ((data&0x7F)<<8);
-      m_irqEnabled = (data&0x80);
+      m_state->m_irqCounter &= 0x00FF;
+      m_state->m_irqCounter |= ((data&0x7F)<<8);
+      m_state->m_irqEnabled = (data&0x80);
       break;
    }
 
@@ -338,175 +363,175 @@ void CROMMapper019::HMAPPER ( uint32_t addr, uint8_t data )
    {
    case 0x8000:
       reg = 3;
-      m_reg[3] = data;
-      m_chr[0] = data;
-      m_pCHRmemory[0] = m_CHRmemory[m_chr[0]];
-      if ( (!(m_reg[16]&0x40)) &&
+      m_state->m_reg[3] = data;
+      m_state->m_chr[0] = data;
+      CROM::m_state->m_pCHRmemory[0] = CROM::m_state->m_CHRmemory[m_state->m_chr[0]];
+      if ( (!(m_state->m_reg[16]&0x40)) &&
            (data >= 0xE0) )
       {
          data &= 0x1F;
          // Shove this into unused CHR memory, we'll call it CHR-RAM.
-         m_pCHRmemory[0] = m_CHRmemory[0x100+data];
+         CROM::m_state->m_pCHRmemory[0] = CROM::m_state->m_CHRmemory[0x100+data];
       }
       break;
    case 0x8800:
       reg = 4;
-      m_reg[4] = data;
-      m_chr[1] = data;
-      m_pCHRmemory[1] = m_CHRmemory[m_chr[1]];
-      if ( (!(m_reg[16]&0x40)) &&
+      m_state->m_reg[4] = data;
+      m_state->m_chr[1] = data;
+      CROM::m_state->m_pCHRmemory[1] = CROM::m_state->m_CHRmemory[m_state->m_chr[1]];
+      if ( (!(m_state->m_reg[16]&0x40)) &&
            (data >= 0xE0) )
       {
          data &= 0x1F;
          // Shove this into unused CHR memory, we'll call it CHR-RAM.
-         m_pCHRmemory[1] = m_CHRmemory[0x100+data];
+         CROM::m_state->m_pCHRmemory[1] = CROM::m_state->m_CHRmemory[0x100+data];
       }
       break;
    case 0x9000:
       reg = 5;
-      m_reg[5] = data;
-      m_chr[2] = data;
-      m_pCHRmemory[2] = m_CHRmemory[m_chr[2]];
-      if ( (!(m_reg[16]&0x40)) &&
+      m_state->m_reg[5] = data;
+      m_state->m_chr[2] = data;
+      CROM::m_state->m_pCHRmemory[2] = CROM::m_state->m_CHRmemory[m_state->m_chr[2]];
+      if ( (!(m_state->m_reg[16]&0x40)) &&
            (data >= 0xE0) )
       {
          data &= 0x1F;
          // Shove this into unused CHR memory, we'll call it CHR-RAM.
-         m_pCHRmemory[2] = m_CHRmemory[0x100+data];
+         CROM::m_state->m_pCHRmemory[2] = CROM::m_state->m_CHRmemory[0x100+data];
       }
       break;
    case 0x9800:
       reg = 6;
-      m_reg[6] = data;
-      m_chr[3] = data;
-      m_pCHRmemory[3] = m_CHRmemory[m_chr[3]];
-      if ( (!(m_reg[16]&0x40)) &&
+      m_state->m_reg[6] = data;
+      m_state->m_chr[3] = data;
+      CROM::m_state->m_pCHRmemory[3] = CROM::m_state->m_CHRmemory[m_state->m_chr[3]];
+      if ( (!(m_state->m_reg[16]&0x40)) &&
            (data >= 0xE0) )
       {
          data &= 0x1F;
          // Shove this into unused CHR memory, we'll call it CHR-RAM.
-         m_pCHRmemory[3] = m_CHRmemory[0x100+data];
+         CROM::m_state->m_pCHRmemory[3] = CROM::m_state->m_CHRmemory[0x100+data];
       }
       break;
    case 0xA000:
       reg = 7;
-      m_reg[7] = data;
-      m_chr[4] = data;
-      m_pCHRmemory[4] = m_CHRmemory[m_chr[4]];
-      if ( (!(m_reg[16]&0x80)) &&
+      m_state->m_reg[7] = data;
+      m_state->m_chr[4] = data;
+      CROM::m_state->m_pCHRmemory[4] = CROM::m_state->m_CHRmemory[m_state->m_chr[4]];
+      if ( (!(m_state->m_reg[16]&0x80)) &&
            (data >= 0xE0) )
       {
          data &= 0x1F;
          // Shove this into unused CHR memory, we'll call it CHR-RAM.
-         m_pCHRmemory[4] = m_CHRmemory[0x100+data];
+         CROM::m_state->m_pCHRmemory[4] = CROM::m_state->m_CHRmemory[0x100+data];
       }
       break;
    case 0xA800:
       reg = 8;
-      m_reg[8] = data;
-      m_chr[5] = data;
-      m_pCHRmemory[5] = m_CHRmemory[m_chr[5]];
-      if ( (!(m_reg[16]&0x80)) &&
+      m_state->m_reg[8] = data;
+      m_state->m_chr[5] = data;
+      CROM::m_state->m_pCHRmemory[5] = CROM::m_state->m_CHRmemory[m_state->m_chr[5]];
+      if ( (!(m_state->m_reg[16]&0x80)) &&
            (data >= 0xE0) )
       {
          data &= 0x1F;
          // Shove this into unused CHR memory, we'll call it CHR-RAM.
-         m_pCHRmemory[5] = m_CHRmemory[0x100+data];
+         CROM::m_state->m_pCHRmemory[5] = CROM::m_state->m_CHRmemory[0x100+data];
       }
       break;
    case 0xB000:
       reg = 9;
-      m_reg[9] = data;
-      m_chr[6] = data;
-      m_pCHRmemory[6] = m_CHRmemory[m_chr[6]];
-      if ( (!(m_reg[16]&0x80)) &&
+      m_state->m_reg[9] = data;
+      m_state->m_chr[6] = data;
+      CROM::m_state->m_pCHRmemory[6] = CROM::m_state->m_CHRmemory[m_state->m_chr[6]];
+      if ( (!(m_state->m_reg[16]&0x80)) &&
            (data >= 0xE0) )
       {
          data &= 0x1F;
          // Shove this into unused CHR memory, we'll call it CHR-RAM.
-         m_pCHRmemory[6] = m_CHRmemory[0x100+data];
+         CROM::m_state->m_pCHRmemory[6] = CROM::m_state->m_CHRmemory[0x100+data];
       }
       break;
    case 0xB800:
       reg = 10;
-      m_reg[10] = data;
-      m_chr[7] = data;
-      m_pCHRmemory[7] = m_CHRmemory[m_chr[7]];
-      if ( (!(m_reg[16]&0x80)) &&
+      m_state->m_reg[10] = data;
+      m_state->m_chr[7] = data;
+      CROM::m_state->m_pCHRmemory[7] = CROM::m_state->m_CHRmemory[m_state->m_chr[7]];
+      if ( (!(m_state->m_reg[16]&0x80)) &&
            (data >= 0xE0) )
       {
          data &= 0x1F;
          // Shove this into unused CHR memory, we'll call it CHR-RAM.
-         m_pCHRmemory[7] = m_CHRmemory[0x100+data];
+         CROM::m_state->m_pCHRmemory[7] = CROM::m_state->m_CHRmemory[0x100+data];
       }
       break;
    case 0xC000:
       reg = 11;
-      m_reg[11] = data;
+      m_state->m_reg[11] = data;
       if ( data < 0xE0 )
       {
-         CPPU::REMAPVRAM(0x0,m_CHRmemory[m_reg[11]]);
+         CPPU::REMAPVRAM(0x0,CROM::m_state->m_CHRmemory[m_state->m_reg[11]]);
       }
       else
       {
-         CPPU::MIRROR(m_reg[11]&0x01,-1,-1,-1);
+         CPPU::MIRROR(m_state->m_reg[11]&0x01,-1,-1,-1);
       }
       break;
    case 0xC800:
       reg = 12;
-      m_reg[12] = data;
+      m_state->m_reg[12] = data;
       if ( data < 0xE0 )
       {
-         CPPU::REMAPVRAM(0x1,m_CHRmemory[m_reg[12]]);
+         CPPU::REMAPVRAM(0x1,CROM::m_state->m_CHRmemory[m_state->m_reg[12]]);
       }
       else
       {
-         CPPU::MIRROR(-1,m_reg[12]&0x01,-1,-1);
+         CPPU::MIRROR(-1,m_state->m_reg[12]&0x01,-1,-1);
       }
       break;
    case 0xD000:
       reg = 13;
-      m_reg[13] = data;
+      m_state->m_reg[13] = data;
       if ( data < 0xE0 )
       {
-         CPPU::REMAPVRAM(0x2,m_CHRmemory[m_reg[13]]);
+         CPPU::REMAPVRAM(0x2,CROM::m_state->m_CHRmemory[m_state->m_reg[13]]);
       }
       else
       {
-         CPPU::MIRROR(-1,-1,m_reg[13]&0x01,-1);
+         CPPU::MIRROR(-1,-1,m_state->m_reg[13]&0x01,-1);
       }
       break;
    case 0xD800:
       reg = 14;
-      m_reg[14] = data;
+      m_state->m_reg[14] = data;
       if ( data < 0xE0 )
       {
-         CPPU::REMAPVRAM(0x3,m_CHRmemory[m_reg[14]]);
+         CPPU::REMAPVRAM(0x3,CROM::m_state->m_CHRmemory[m_state->m_reg[14]]);
       }
       else
       {
-         CPPU::MIRROR(-1,-1,-1,m_reg[14]&0x01);
+         CPPU::MIRROR(-1,-1,-1,m_state->m_reg[14]&0x01);
       }
       break;
    case 0xE000:
       reg = 15;
-      m_reg[15] = data;
-      m_pPRGROMmemory[0] = m_PRGROMmemory[data%m_numPrgBanks];
+      m_state->m_reg[15] = data;
+      CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory[data%CROM::m_state->m_numPrgBanks] );
       break;
    case 0xE800:
       reg = 16;
-      m_reg[16] = data;
-      m_pPRGROMmemory[1] = m_PRGROMmemory[data%m_numPrgBanks];
+      m_state->m_reg[16] = data;
+      CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory[data%CROM::m_state->m_numPrgBanks] );
       break;
    case 0xF000:
       reg = 17;
-      m_reg[17] = data;
-      m_pPRGROMmemory[2] = m_PRGROMmemory[data%m_numPrgBanks];
+      m_state->m_reg[17] = data;
+      CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory[data%CROM::m_state->m_numPrgBanks] );
       break;
    case 0xF800:
       reg = 18;
-      m_reg[18] = data;
-      m_soundRAMAddr = data&0x7F;
+      m_state->m_reg[18] = data;
+      m_state->m_soundRAMAddr = data&0x7F;
       break;
    }
 
@@ -563,25 +588,23 @@ uint16_t CROMMapper019::AMPLITUDE()
    int16_t amp;
    int16_t delta;
    int16_t out[100] = { 0, };
-   static int16_t outLast = 0;
    uint8_t sample;
    uint8_t* wdacSamples[8];
-   static int32_t outDownsampled = 0;
    int32_t idx;
 
-   wdacSamples[0] = m_wave[0].GETDACSAMPLES();
-   wdacSamples[1] = m_wave[1].GETDACSAMPLES();
-   wdacSamples[2] = m_wave[2].GETDACSAMPLES();
-   wdacSamples[3] = m_wave[3].GETDACSAMPLES();
-   wdacSamples[4] = m_wave[4].GETDACSAMPLES();
-   wdacSamples[5] = m_wave[5].GETDACSAMPLES();
-   wdacSamples[6] = m_wave[6].GETDACSAMPLES();
-   wdacSamples[7] = m_wave[7].GETDACSAMPLES();
+   wdacSamples[0] = m_state->m_wave[0].GETDACSAMPLES();
+   wdacSamples[1] = m_state->m_wave[1].GETDACSAMPLES();
+   wdacSamples[2] = m_state->m_wave[2].GETDACSAMPLES();
+   wdacSamples[3] = m_state->m_wave[3].GETDACSAMPLES();
+   wdacSamples[4] = m_state->m_wave[4].GETDACSAMPLES();
+   wdacSamples[5] = m_state->m_wave[5].GETDACSAMPLES();
+   wdacSamples[6] = m_state->m_wave[6].GETDACSAMPLES();
+   wdacSamples[7] = m_state->m_wave[7].GETDACSAMPLES();
 
-   for ( sample = 0; sample < m_wave[0].GETDACSAMPLECOUNT(); sample++ )
+   for ( sample = 0; sample < m_state->m_wave[0].GETDACSAMPLECOUNT(); sample++ )
    {
       amp = 0;
-      for ( idx = 7-m_soundChansEnabled; idx < 8; idx++ )
+      for ( idx = 7-m_state->m_soundChansEnabled; idx < 8; idx++ )
       {
          amp += (*(*(wdacSamples+idx)+sample));
       }
@@ -597,25 +620,25 @@ uint16_t CROMMapper019::AMPLITUDE()
 
       (*(out+sample)) = amp;
 
-      outDownsampled += (*(out+sample));
+      m_state->m_outDownsampled += (*(out+sample));
    }
 
-   outDownsampled = (int32_t)((float)outDownsampled/((float)m_wave[0].GETDACSAMPLECOUNT()));
+   m_state->m_outDownsampled = (int32_t)((float)m_state->m_outDownsampled/((float)m_state->m_wave[0].GETDACSAMPLECOUNT()));
 
-   delta = outDownsampled - outLast;
-   outDownsampled = outLast+((delta*65371)/65536); // 65371/65536 is 0.9975 adjusted to 16-bit fixed point.
+   delta = m_state->m_outDownsampled - m_state->m_outLast;
+   m_state->m_outDownsampled = m_state->m_outLast+((delta*65371)/65536); // 65371/65536 is 0.9975 adjusted to 16-bit fixed point.
 
-   outLast = outDownsampled;
+   m_state->m_outLast = m_state->m_outDownsampled;
 
    // Reset DAC averaging...
-   m_wave[0].CLEARDACAVG();
-   m_wave[1].CLEARDACAVG();
-   m_wave[2].CLEARDACAVG();
-   m_wave[3].CLEARDACAVG();
-   m_wave[4].CLEARDACAVG();
-   m_wave[5].CLEARDACAVG();
-   m_wave[6].CLEARDACAVG();
-   m_wave[7].CLEARDACAVG();
-
-   return outDownsampled;
+   m_state->m_wave[0].CLEARDACAVG();
+   m_state->m_wave[1].CLEARDACAVG();
+   m_state->m_wave[2].CLEARDACAVG();
+   m_state->m_wave[3].CLEARDACAVG();
+   m_state->m_wave[4].CLEARDACAVG();
+   m_state->m_wave[5].CLEARDACAVG();
+   m_state->m_wave[6].CLEARDACAVG();
+   m_state->m_wave[7].CLEARDACAVG();
+
+   return m_state->m_outDownsampled;
 }
@@ -94,6 +94,8 @@ public:
    static void LMAPPER ( uint32_t addr, uint8_t data );
    static void HMAPPER ( uint32_t addr, uint8_t data );
    static void SYNCCPU ( void );
+   static uint32_t CPUIDLE ( void );
+   static void SKIPCPU ( uint32_t cycles );
    static uint32_t DEBUGINFO ( uint32_t addr );
    static uint16_t AMPLITUDE ( void );
    static void SOUNDENABLE ( uint32_t mask )
@@ -101,23 +103,34 @@ public:
       uint8_t bit;
       for ( bit = 0; bit < 8; bit++ )
       {
-         m_wave[bit].muted = !(mask&(0x01<<bit));
+         m_state->m_wave[bit].muted = !(mask&(0x01<<bit));
       }
    }
 
 protected:
-   // N106
-   static uint8_t  m_reg [ 19 ];
-   static uint8_t  m_chr [ 8 ];
-   static uint16_t m_irqCounter;
-   static bool     m_irqEnabled;
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      // N106
+      uint8_t m_reg [ 19 ] = { 0x00, };
+      uint8_t m_chr [ 8 ];
+      uint16_t m_irqCounter = 0;
+      bool m_irqEnabled = false;
+
+      // N106 sound
+      N106WaveChannel m_wave [8];
+      uint8_t m_soundRAM [128];
+      uint8_t m_soundRAMAddr;
+      uint8_t m_soundChansEnabled = 0;
 
-   // N106 sound
-   static N106WaveChannel m_wave[8];
+      // Expansion audio output filter history.
+      int16_t m_outLast = 0;
+      int32_t m_outDownsampled = 0;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 
-   static uint8_t m_soundRAM[128];
-   static uint8_t m_soundRAMAddr;
-   static uint8_t m_soundChansEnabled;
 };
 
 #endif
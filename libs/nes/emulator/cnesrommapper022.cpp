@@ -75,8 +75,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,19,19,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper022::m_reg [] = { 0x00, };
-uint8_t  CROMMapper022::m_chr [];
+CROMMapper022::State CROMMapper022::m_defaultState;
+thread_local CROMMapper022::State* CROMMapper022::m_state = &CROMMapper022::m_defaultState;
 
 CROMMapper022::CROMMapper022()
 {
@@ -90,16 +90,16 @@ void CROMMapper022::RESET ( bool soft )
 {
    int32_t idx;
 
-   m_mapper = 22;
+   CROM::m_state->m_mapper = 22;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
@@ -112,67 +112,67 @@ uint32_t CROMMapper022::DEBUGINFO ( uint32_t addr )
    case 0x8001:
    case 0x8002:
    case 0x8003:
-      return m_reg[0];
+      return m_state->m_reg[0];
       break;
    case 0x9000:
    case 0x9001:
    case 0x9002:
    case 0x9003:
-      return m_reg[1];
+      return m_state->m_reg[1];
       break;
    case 0xA000:
    case 0xA001:
    case 0xA002:
    case 0xA003:
-      return m_reg[2];
+      return m_state->m_reg[2];
       break;
    case 0xB000:
-      return m_reg[3];
+      return m_state->m_reg[3];
       break;
    case 0xB001:
-      return m_reg[4];
+      return m_state->m_reg[4];
       break;
    case 0xB002:
-      return m_reg[5];
+      return m_state->m_reg[5];
       break;
    case 0xB003:
-      return m_reg[6];
+      return m_state->m_reg[6];
       break;
    case 0xC000:
-      return m_reg[7];
+      return m_state->m_reg[7];
       break;
    case 0xC001:
-      return m_reg[8];
+      return m_state->m_reg[8];
       break;
    case 0xC002:
-      return m_reg[9];
+      return m_state->m_reg[9];
       break;
    case 0xC003:
-      return m_reg[10];
+      return m_state->m_reg[10];
       break;
    case 0xD000:
-      return m_reg[11];
+      return m_state->m_reg[11];
       break;
    case 0xD001:
-      return m_reg[12];
+      return m_state->m_reg[12];
       break;
    case 0xD002:
-      return m_reg[13];
+      return m_state->m_reg[13];
       break;
    case 0xD003:
-      return m_reg[14];
+      return m_state->m_reg[14];
       break;
    case 0xE000:
-      return m_reg[15];
+      return m_state->m_reg[15];
       break;
    case 0xE001:
-      return m_reg[16];
+      return m_state->m_reg[16];
       break;
    case 0xE002:
-      return m_reg[17];
+      return m_state->m_reg[17];
       break;
    case 0xE003:
-      return m_reg[18];
+      return m_state->m_reg[18];
       break;
    }
 }
@@ -188,15 +188,15 @@ void CROMMapper022::HMAPPER ( uint32_t addr, uint8_t data )
    case 0x8002:
    case 0x8003:
       reg = 0;
-      m_reg[0] = data;
-      m_pPRGROMmemory[0] = m_PRGROMmemory[data&0x0F];
+      m_state->m_reg[0] = data;
+      CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory[data&0x0F] );
       break;
    case 0x9000:
    case 0x9001:
    case 0x9002:
    case 0x9003:
       reg = 1;
-      m_reg[1] = data;
+      m_state->m_reg[1] = data;
       switch ( data&0x03 )
       {
       case 0:
@@ -218,120 +218,120 @@ void CROMMapper022::HMAPPER ( uint32_t addr, uint8_t data )
    case 0xA002:
    case 0xA003:
       reg = 2;
-      m_reg[2] = data;
-      m_pPRGROMmemory[1] = m_PRGROMmemory[data&0x0F];
+      m_state->m_reg[2] = data;
+      CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory[data&0x0F] );
       break;
    case 0xB000:
       reg = 3;
-      m_reg[3] = data;
-      m_chr[0] &= 0xF0;
-      m_chr[0] |= (data&0x0F);
-      m_pCHRmemory[0] = m_CHRmemory[m_chr[0]>>1]; // NOTE: >>1 VRC2a only
+      m_state->m_reg[3] = data;
+      m_state->m_chr[0] &= 0xF0;
+      m_state->m_chr[0] |= (data&0x0F);
+      CROM::m_state->m_pCHRmemory[0] = CROM::m_state->m_CHRmemory[m_state->m_chr[0]>>1]; // NOTE: >>1 VRC2a only
       break;
    case 0xB001:
       reg = 4;
-      m_reg[4] = data;
-      m_chr[1] &= 0xF0;        // NOTE: swapped VRC2a
-      m_chr[1] |= (data&0x0F); // NOTE: swapped VRC2a
-      m_pCHRmemory[1] = m_CHRmemory[m_chr[1]>>1]; // NOTE: >>1 VRC2a only
+      m_state->m_reg[4] = data;
+      m_state->m_chr[1] &= 0xF0;        // NOTE: swapped VRC2a
+      m_state->m_chr[1] |= (data&0x0F); // NOTE: swapped VRC2a
+      CROM::m_state->m_pCHRmemory[1] = CROM::m_state->m_CHRmemory[m_state->m_chr[1]>>1]; // NOTE: >>1 VRC2a only
       break;
    case 0xB002:
       reg = 5;
-      m_reg[5] = data;
-      m_chr[0] &= 0x0F;      // NOTE: swapped VRC2a
-      m_chr[0] |= (data<<4); // NOTE: swapped VRC2a
-      m_pCHRmemory[0] = m_CHRmemory[m_chr[0]>>1]; // NOTE: >>1 VRC2a only
+      m_state->m_reg[5] = data;
+      m_state->m_chr[0] &= 0x0F;      // NOTE: swapped VRC2a
+      m_state->m_chr[0] |= (data<<4); // NOTE: swapped VRC2a
+      CROM::m_state->m_pCHRmemory[0] = CROM::m_state->m_CHRmemory[m_state->m_chr[0]>>1]; // NOTE: >>1 VRC2a only
       break;
    case 0xB003:
       reg = 6;
-      m_reg[6] = data;
-      m_chr[1] &= 0x0F;
-      m_chr[1] |= (data<<4);
-      m_pCHRmemory[1] = m_CHRmemory[m_chr[1]>>1]; // NOTE: >>1 VRC2a only
+      m_state->m_reg[6] = data;
+      m_state->m_chr[1] &= 0x0F;
+      m_state->m_chr[1] |= (data<<4);
+      CROM::m_state->m_pCHRmemory[1] = CROM::m_state->m_CHRmemory[m_state->m_chr[1]>>1]; // NOTE: >>1 VRC2a only
       break;
    case 0xC000:
       reg = 7;
-      m_reg[7] = data;
-      m_chr[2] &= 0xF0;
-      m_chr[2] |= (data&0x0F);
-      m_pCHRmemory[2] = m_CHRmemory[m_chr[2]>>1]; // NOTE: >>1 VRC2a only
+      m_state->m_reg[7] = data;
+      m_state->m_chr[2] &= 0xF0;
+      m_state->m_chr[2] |= (data&0x0F);
+      CROM::m_state->m_pCHRmemory[2] = CROM::m_state->m_CHRmemory[m_state->m_chr[2]>>1]; // NOTE: >>1 VRC2a only
       break;
    case 0xC001:
       reg = 8;
-      m_reg[8] = data;
-      m_chr[3] &= 0xF0;        // NOTE: swapped VRC2a
-      m_chr[3] |= (data&0x0F); // NOTE: swapped VRC2a
-      m_pCHRmemory[3] = m_CHRmemory[m_chr[3]>>1]; // NOTE: >>1 VRC2a only
+      m_state->m_reg[8] = data;
+      m_state->m_chr[3] &= 0xF0;        // NOTE: swapped VRC2a
+      m_state->m_chr[3] |= (data&0x0F); // NOTE: swapped VRC2a
+      CROM::m_state->m_pCHRmemory[3] = CROM::m_state->m_CHRmemory[m_state->m_chr[3]>>1]; // NOTE: >>1 VRC2a only
       break;
    case 0xC002:
       reg = 9;
-      m_reg[9] = data;
-      m_chr[2] &= 0x0F;      // NOTE: swapped VRC2a
-      m_chr[2] |= (data<<4); // NOTE: swapped VRC2a
-      m_pCHRmemory[2] = m_CHRmemory[m_chr[2]>>1]; // NOTE: >>1 VRC2a only
+      m_state->m_reg[9] = data;
+      m_state->m_chr[2] &= 0x0F;      // NOTE: swapped VRC2a
+      m_state->m_chr[2] |= (data<<4); // NOTE: swapped VRC2a
+      CROM::m_state->m_pCHRmemory[2] = CROM::m_state->m_CHRmemory[m_state->m_chr[2]>>1]; // NOTE: >>1 VRC2a only
       break;
    case 0xC003:
       reg = 10;
-      m_reg[10] = data;
-      m_chr[3] &= 0x0F;
-      m_chr[3] |= (data<<4);
-      m_pCHRmemory[3] = m_CHRmemory[m_chr[3]>>1]; // NOTE: >>1 VRC2a only
+      m_state->m_reg[10] = data;
+      m_state->m_chr[3] &= 0x0F;
+      m_state->m_chr[3] |= (data<<4);
+      CROM::m_state->m_pCHRmemory[3] = CROM::m_state->m_CHRmemory[m_state->m_chr[3]>>1]; // NOTE: >>1 VRC2a only
       break;
    case 0xD000:
       reg = 11;
-      m_reg[11] = data;
-      m_chr[4] &= 0xF0;
-      m_chr[4] |= (data&0x0F);
-      m_pCHRmemory[4] = m_CHRmemory[m_chr[4]>>1]; // NOTE: >>1 VRC2a only
+      m_state->m_reg[11] = data;
+      m_state->m_chr[4] &= 0xF0;
+      m_state->m_chr[4] |= (data&0x0F);
+      CROM::m_state->m_pCHRmemory[4] = CROM::m_state->m_CHRmemory[m_state->m_chr[4]>>1]; // NOTE: >>1 VRC2a only
       break;
    case 0xD001:
       reg = 12;
-      m_reg[12] = data;
-      m_chr[5] &= 0xF0;        // NOTE: swapped VRC2a
-      m_chr[5] |= (data&0x0F); // NOTE: swapped VRC2a
-      m_pCHRmemory[5] = m_CHRmemory[m_chr[5]>>1]; // NOTE: >>1 VRC2a only
+      m_state->m_reg[12] = data;
+      m_state->m_chr[5] &= 0xF0;        // NOTE: swapped VRC2a
+      m_state->m_chr[5] |= (data&0x0F); // NOTE: swapped VRC2a
+      CROM::m_state->m_pCHRmemory[5] = CROM::m_state->m_CHRmemory[m_state->m_chr[5]>>1]; // NOTE: >>1 VRC2a only
       break;
    case 0xD002:
       reg = 13;
-      m_reg[13] = data;
-      m_chr[4] &= 0x0F;      // NOTE: swapped VRC2a
-      m_chr[4] |= (data<<4); // NOTE: swapped VRC2a
-      m_pCHRmemory[4] = m_CHRmemory[m_chr[4]>>1]; // NOTE: >>1 VRC2a only
+      m_state->m_reg[13] = data;
+      m_state->m_chr[4] &= 0x0F;      // NOTE: swapped VRC2a
+      m_state->m_chr[4] |= (data<<4); // NOTE: swapped VRC2a
+      CROM::m_state->m_pCHRmemory[4] = CROM::m_state->m_CHRmemory[m_state->m_chr[4]>>1]; // NOTE: >>1 VRC2a only
       break;
    case 0xD003:
       reg = 14;
-      m_reg[14] = data;
-      m_chr[5] &= 0x0F;
-      m_chr[5] |= (data<<4);
-      m_pCHRmemory[5] = m_CHRmemory[m_chr[5]>>1]; // NOTE: >>1 VRC2a only
+      m_state->m_reg[14] = data;
+      m_state->m_chr[5] &= 0x0F;
+      m_state->m_chr[5] |= (data<<4);
+      CROM::m_state->m_pCHRmemory[5] = CROM::m_state->m_CHRmemory[m_state->m_chr[5]>>1]; // NOTE: >>1 VRC2a only
       break;
    case 0xE000:
       reg = 15;
-      m_reg[15] = data;
-      m_chr[6] &= 0xF0;
-      m_chr[6] |= (data&0x0F);
-      m_pCHRmemory[6] = m_CHRmemory[m_chr[6]>>1]; // NOTE: >>1 VRC2a only
+      m_state->m_reg[15] = data;
+      m_state->m_chr[6] &= 0xF0;
+      m_state->m_chr[6] |= (data&0x0F);
+      CROM::m_state->m_pCHRmemory[6] = CROM::m_state->m_CHRmemory[m_state->m_chr[6]>>1]; // NOTE: >>1 VRC2a only
       break;
    case 0xE001:
       reg = 16;
-      m_reg[16] = data;
-      m_chr[7] &= 0xF0;        // NOTE: swapped VRC2a
-      m_chr[7] |= (data&0x0F); // NOTE: swapped VRC2a
-      m_pCHRmemory[7] = m_CHRmemory[m_chr[7]>>1]; // NOTE: >>1 VRC2a only
+      m_state->m_reg[16] = data;
+      m_state->m_chr[7] &= 0xF0;        // NOTE: swapped VRC2a
+      m_state->m_chr[7] |= (data&0x0F); // NOTE: swapped VRC2a
+      CROM::m_state->m_pCHRmemory[7] = CROM::m_state->m_CHRmemory[m_state->m_chr[7]>>1]; // NOTE: >>1 VRC2a only
       break;
    case 0xE002:
       reg = 17;
-      m_reg[17] = data;
-      m_chr[6] &= 0x0F;      // NOTE: swapped VRC2a
-      m_chr[6] |= (data<<4); // NOTE: swapped VRC2a
-      m_pCHRmemory[6] = m_CHRmemory[m_chr[6]>>1]; // NOTE: >>1 VRC2a only
+      m_state->m_reg[17] = data;
+      m_state->m_chr[6] &= 0x0F;      // NOTE: swapped VRC2a
+      m_state->m_chr[6] |= (data<<4); // NOTE: swapped VRC2a
+      CROM::m_state->m_pCHRmemory[6] = CROM::m_state->m_CHRmemory[m_state->m_chr[6]>>1]; // NOTE: >>1 VRC2a only
       break;
    case 0xE003:
       reg = 18;
-      m_reg[18] = data;
-      m_chr[7] &= 0x0F;
-      m_chr[7] |= (data<<4);
-      m_pCHRmemory[7] = m_CHRmemory[m_chr[7]>>1]; // NOTE: >>1 VRC2a only
+      m_state->m_reg[18] = data;
+      m_state->m_chr[7] &= 0x0F;
+      m_state->m_chr[7] |= (data<<4);
+      CROM::m_state->m_pCHRmemory[7] = CROM::m_state->m_CHRmemory[m_state->m_chr[7]>>1]; // NOTE: >>1 VRC2a only
       break;
    }
 
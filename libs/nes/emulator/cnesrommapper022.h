@@ -14,9 +14,16 @@ public:
    static uint32_t DEBUGINFO ( uint32_t addr );
 
 protected:
-   // VRC2
-   static uint8_t  m_reg [ 19 ];
-   static uint8_t  m_chr [ 8 ];
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      // VRC2
+      uint8_t m_reg [ 19 ] = { 0x00, };
+      uint8_t m_chr [ 8 ];
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 };
 
 #endif
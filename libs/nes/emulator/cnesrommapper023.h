@@ -12,17 +12,26 @@ public:
    static void RESET ( bool soft );
    static void HMAPPER ( uint32_t addr, uint8_t data );
    static void SYNCCPU ( void );
+   static uint32_t CPUIDLE ( void );
+   static void SKIPCPU ( uint32_t cycles );
    static uint32_t DEBUGINFO ( uint32_t addr );
 
 protected:
-   // VRC2+VRC4
-   static uint8_t  m_reg [ 23 ];
-   static uint8_t  m_chr [ 8 ];
-   static uint8_t  m_irqReload;
-   static uint8_t  m_irqCounter;
-   static uint8_t  m_irqPrescaler;
-   static uint8_t  m_irqPrescalerPhase;
-   static bool     m_irqEnabled;
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      // VRC2+VRC4
+      uint8_t m_reg [ 23 ] = { 0x00, };
+      uint8_t m_chr [ 8 ];
+      uint8_t m_irqReload = 0;
+      uint8_t m_irqCounter = 0;
+      uint8_t m_irqPrescaler = 0;
+      uint8_t m_irqPrescalerPhase = 0;
+      bool m_irqEnabled = false;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 };
 
 #endif
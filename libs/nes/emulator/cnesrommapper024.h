@@ -152,28 +152,42 @@ public:
    static void RESET ( bool soft );
    static void HMAPPER ( uint32_t addr, uint8_t data );
    static void SYNCCPU ( void );
+   static uint32_t CPUIDLE ( void );
+   static void SKIPCPU ( uint32_t cycles );
    static uint32_t DEBUGINFO ( uint32_t addr );
    static uint16_t AMPLITUDE ( void );
    static void SOUNDENABLE ( uint32_t mask )
    {
-      m_pulse[0].muted = !(mask&0x01);
-      m_pulse[1].muted = !(mask&0x02);
-      m_sawtooth.muted = !(mask&0x04);
+      m_state->m_pulse[0].muted = !(mask&0x01);
+      m_state->m_pulse[1].muted = !(mask&0x02);
+      m_state->m_sawtooth.muted = !(mask&0x04);
    }
 
 protected:
-   // VRC6
-   static uint8_t  m_reg [ 23 ];
-   static uint8_t  m_chr [ 8 ];
-   static uint8_t  m_irqReload;
-   static uint8_t  m_irqCounter;
-   static uint8_t  m_irqPrescaler;
-   static uint8_t  m_irqPrescalerPhase;
-   static bool     m_irqEnabled;
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      // VRC6
+      uint8_t m_reg [ 23 ] = { 0x00, };
+      uint8_t m_chr [ 8 ];
+      uint8_t m_irqReload = 0;
+      uint8_t m_irqCounter = 0;
+      uint8_t m_irqPrescaler = 0;
+      uint8_t m_irqPrescalerPhase = 0;
+      bool m_irqEnabled = false;
+
+      // VRC6 sound
+      VRC6PulseChannel m_pulse [2];
+      VRC6SawtoothChannel m_sawtooth;
+
+      // Expansion audio output filter history.
+      int16_t m_outLast = 0;
+      int32_t m_outDownsampled = 0;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 
-   // VRC6 sound
-   static VRC6PulseChannel m_pulse[2];
-   static VRC6SawtoothChannel m_sawtooth;
 };
 
 #endif
@@ -127,13 +127,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,23,23,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper026::m_reg [] = { 0x00, };
-uint8_t  CROMMapper026::m_chr [];
-uint8_t  CROMMapper026::m_irqReload = 0;
-uint8_t  CROMMapper026::m_irqCounter = 0;
-uint8_t  CROMMapper026::m_irqPrescaler = 0;
-uint8_t  CROMMapper026::m_irqPrescalerPhase = 0;
-bool     CROMMapper026::m_irqEnabled = false;
+CROMMapper026::State CROMMapper026::m_defaultState;
+thread_local CROMMapper026::State* CROMMapper026::m_state = &CROMMapper026::m_defaultState;
 
 CROMMapper026::CROMMapper026()
 {
@@ -147,26 +142,26 @@ void CROMMapper026::RESET ( bool soft )
 {
    int32_t idx;
 
-   m_mapper = 26;
+   CROM::m_state->m_mapper = 26;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   m_pulse[0].RESET();
-   m_pulse[1].RESET();
-   m_sawtooth.RESET();
+   CROMMapper024::m_state->m_pulse[0].RESET();
+   CROMMapper024::m_state->m_pulse[1].RESET();
+   CROMMapper024::m_state->m_sawtooth.RESET();
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
-   m_irqReload = 0;
-   m_irqCounter = 0;
-   m_irqPrescaler = 0;
-   m_irqPrescalerPhase = 0;
-   m_irqEnabled = false;
+   m_state->m_irqReload = 0;
+   m_state->m_irqCounter = 0;
+   m_state->m_irqPrescaler = 0;
+   m_state->m_irqPrescalerPhase = 0;
+   m_state->m_irqEnabled = false;
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
@@ -175,18 +170,18 @@ void CROMMapper026::SYNCCPU ( void )
 {
    uint8_t phases[3] = { 114, 114, 113 };
 
-   m_pulse[0].TIMERTICK();
-   m_pulse[1].TIMERTICK();
-   m_sawtooth.TIMERTICK();
+   CROMMapper024::m_state->m_pulse[0].TIMERTICK();
+   CROMMapper024::m_state->m_pulse[1].TIMERTICK();
+   CROMMapper024::m_state->m_sawtooth.TIMERTICK();
 
-   if ( m_reg[21]&0x02 )
+   if ( m_state->m_reg[21]&0x02 )
    {
-      if ( m_reg[21]&0x04 )
+      if ( m_state->m_reg[21]&0x04 )
       {
          // Cycle mode counter
-         if ( m_irqCounter == 0xFF )
+         if ( m_state->m_irqCounter == 0xFF )
          {
-            m_irqCounter = m_irqReload;
+            m_state->m_irqCounter = m_state->m_irqReload;
             C6502::ASSERTIRQ(eNESSource_Mapper);
 
             if ( nesIsDebuggable() )
@@ -197,22 +192,22 @@ void CROMMapper026::SYNCCPU ( void )
          }
          else
          {
-            m_irqCounter++;
+            m_state->m_irqCounter++;
          }
       }
       else
       {
          // Scanline mode counter
-         m_irqPrescaler++;
-         if ( m_irqPrescaler >= phases[m_irqPrescalerPhase] )
+         m_state->m_irqPrescaler++;
+         if ( m_state->m_irqPrescaler >= phases[m_state->m_irqPrescalerPhase] )
          {
-            m_irqPrescaler = 0;
-            m_irqPrescalerPhase++;
-            m_irqPrescalerPhase %= 3;
+            m_state->m_irqPrescaler = 0;
+            m_state->m_irqPrescalerPhase++;
+            m_state->m_irqPrescalerPhase %= 3;
 
-            if ( m_irqCounter == 0xFF )
+            if ( m_state->m_irqCounter == 0xFF )
             {
-               m_irqCounter = m_irqReload;
+               m_state->m_irqCounter = m_state->m_irqReload;
                C6502::ASSERTIRQ(eNESSource_Mapper);
 
                if ( nesIsDebuggable() )
@@ -223,13 +218,91 @@ void CROMMapper026::SYNCCPU ( void )
             }
             else
             {
-               m_irqCounter++;
+               m_state->m_irqCounter++;
             }
          }
       }
    }
 }
 
+uint32_t CROMMapper026::CPUIDLE ( void )
+{
+   uint8_t phases[3] = { 114, 114, 113 };
+   uint8_t prescaler = m_state->m_irqPrescaler;
+   uint8_t phase = m_state->m_irqPrescalerPhase;
+   uint8_t counter = m_state->m_irqCounter;
+   uint32_t cycles = 0;
+   uint32_t count;
+
+   if ( !(m_state->m_reg[21]&0x02) )
+   {
+      return MAPPER_IDLE_FOREVER;
+   }
+
+   // The IRQ fires on the counter clock that finds it at $FF.
+   if ( m_state->m_reg[21]&0x04 )
+   {
+      // Cycle mode counter
+      return 0xFF-counter;
+   }
+
+   // Scanline mode counter
+   for ( ; ; )
+   {
+      count = (prescaler < phases[phase]) ? (phases[phase]-prescaler) : 1;
+      if ( counter == 0xFF )
+      {
+         return cycles+count-1;
+      }
+      cycles += count;
+      counter++;
+      prescaler = 0;
+      phase++;
+      phase %= 3;
+   }
+}
+
+void CROMMapper026::SKIPCPU ( uint32_t cycles )
+{
+   uint8_t phases[3] = { 114, 114, 113 };
+   uint32_t count;
+
+   for ( count = 0; count < cycles; count++ )
+   {
+      CROMMapper024::m_state->m_pulse[0].TIMERTICK();
+      CROMMapper024::m_state->m_pulse[1].TIMERTICK();
+      CROMMapper024::m_state->m_sawtooth.TIMERTICK();
+   }
+
+   if ( m_state->m_reg[21]&0x02 )
+   {
+      if ( m_state->m_reg[21]&0x04 )
+      {
+         // Cycle mode counter
+         m_state->m_irqCounter += cycles;
+      }
+      else
+      {
+         // Scanline mode counter
+         while ( cycles )
+         {
+            count = phases[m_state->m_irqPrescalerPhase];
+            count = (m_state->m_irqPrescaler < count) ? (count-m_state->m_irqPrescaler) : 1;
+            if ( cycles < count )
+            {
+               m_state->m_irqPrescaler += cycles;
+               break;
+            }
+            cycles -= count;
+            m_state->m_irqPrescaler = 0;
+            m_state->m_irqPrescalerPhase++;
+            m_state->m_irqPrescalerPhase %= 3;
+            m_state->m_irqCounter++;
+         }
+      }
+   }
+}
+
 uint32_t CROMMapper026::DEBUGINFO ( uint32_t addr )
 {
    switch ( addr )
@@ -238,76 +311,76 @@ uint32_t CROMMapper026::DEBUGINFO ( uint32_t addr )
    case 0x8001:
    case 0x8002:
    case 0x8003:
-      return m_reg[0];
+      return m_state->m_reg[0];
       break;
    case 0x9000:
-      return m_reg[1];
+      return m_state->m_reg[1];
       break;
    case 0x9001:
-      return m_reg[2];
+      return m_state->m_reg[2];
       break;
    case 0x9002:
-      return m_reg[3];
+      return m_state->m_reg[3];
       break;
    case 0xA000:
-      return m_reg[4];
+      return m_state->m_reg[4];
       break;
    case 0xA001:
-      return m_reg[5];
+      return m_state->m_reg[5];
       break;
    case 0xA002:
-      return m_reg[6];
+      return m_state->m_reg[6];
       break;
    case 0xB000:
-      return m_reg[7];
+      return m_state->m_reg[7];
       break;
    case 0xB001:
-      return m_reg[8];
+      return m_state->m_reg[8];
       break;
    case 0xB002:
-      return m_reg[9];
+      return m_state->m_reg[9];
       break;
    case 0xB003:
-      return m_reg[10];
+      return m_state->m_reg[10];
       break;
    case 0xC000:
    case 0xC001:
    case 0xC002:
    case 0xC003:
-      return m_reg[11];
+      return m_state->m_reg[11];
       break;
    case 0xD000:
-      return m_reg[12];
+      return m_state->m_reg[12];
       break;
    case 0xD001:
-      return m_reg[13];
+      return m_state->m_reg[13];
       break;
    case 0xD002:
-      return m_reg[14];
+      return m_state->m_reg[14];
       break;
    case 0xD003:
-      return m_reg[15];
+      return m_state->m_reg[15];
       break;
    case 0xE000:
-      return m_reg[16];
+      return m_state->m_reg[16];
       break;
    case 0xE001:
-      return m_reg[17];
+      return m_state->m_reg[17];
       break;
    case 0xE002:
-      return m_reg[18];
+      return m_state->m_reg[18];
       break;
    case 0xE003:
-      return m_reg[19];
+      return m_state->m_reg[19];
       break;
    case 0xF000:
-      return m_reg[20];
+      return m_state->m_reg[20];
       break;
    case 0xF001:
-      return m_reg[21];
+      return m_state->m_reg[21];
       break;
    case 0xF002:
-      return m_reg[22];
+      return m_state->m_reg[22];
       break;
    }
 }
@@ -323,58 +396,58 @@ void CROMMapper026::HMAPPER ( uint32_t addr, uint8_t data )
    case 0x8002:
    case 0x8003:
       reg = 0;
-      m_reg[0] = data;
-      m_pPRGROMmemory[0] = m_PRGROMmemory[(data<<1)+0];
-      m_pPRGROMmemory[1] = m_PRGROMmemory[(data<<1)+1];
+      m_state->m_reg[0] = data;
+      CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory[(data<<1)+0] );
+      CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory[(data<<1)+1] );
       break;
    case 0x9000:
       reg = 1;
-      m_reg[1] = data;
-      m_pulse[0].REG(0x9000,data);
+      m_state->m_reg[1] = data;
+      CROMMapper024::m_state->m_pulse[0].REG(0x9000,data);
       break;
    case 0x9001:
       reg = 2;
-      m_reg[2] = data;
-      m_pulse[0].REG(0x9002,data);
+      m_state->m_reg[2] = data;
+      CROMMapper024::m_state->m_pulse[0].REG(0x9002,data);
       break;
    case 0x9002:
       reg = 3;
-      m_reg[3] = data;
-      m_pulse[0].REG(0x9001,data);
+      m_state->m_reg[3] = data;
+      CROMMapper024::m_state->m_pulse[0].REG(0x9001,data);
       break;
    case 0xA000:
       reg = 4;
-      m_reg[4] = data;
-      m_pulse[1].REG(0xA000,data);
+      m_state->m_reg[4] = data;
+      CROMMapper024::m_state->m_pulse[1].REG(0xA000,data);
       break;
    case 0xA001:
       reg = 5;
-      m_reg[5] = data;
-      m_pulse[1].REG(0xA002,data);
+      m_state->m_reg[5] = data;
+      CROMMapper024::m_state->m_pulse[1].REG(0xA002,data);
       break;
    case 0xA002:
       reg = 6;
-      m_reg[6] = data;
-      m_pulse[1].REG(0xA001,data);
+      m_state->m_reg[6] = data;
+      CROMMapper024::m_state->m_pulse[1].REG(0xA001,data);
       break;
    case 0xB000:
       reg = 7;
-      m_reg[7] = data;
-      m_sawtooth.REG(0xB000,data);
+      m_state->m_reg[7] = data;
+      CROMMapper024::m_state->m_sawtooth.REG(0xB000,data);
       break;
    case 0xB001:
       reg = 8;
-      m_reg[8] = data;
-      m_sawtooth.REG(0xB002,data);
+      m_state->m_reg[8] = data;
+      CROMMapper024::m_state->m_sawtooth.REG(0xB002,data);
       break;
    case 0xB002:
       reg = 9;
-      m_reg[9] = data;
-      m_sawtooth.REG(0xB001,data);
+      m_state->m_reg[9] = data;
+      CROMMapper024::m_state->m_sawtooth.REG(0xB001,data);
       break;
    case 0xB003:
       reg = 10;
-      m_reg[10] = data;
+      m_state->m_reg[10] = data;
       switch ( (data&0x0C)>>2 )
       {
       case 0:
@@ -396,91 +469,91 @@ void CROMMapper026::HMAPPER ( uint32_t addr, uint8_t data )
    case 0xC002:
    case 0xC003:
       reg = 11;
-      m_reg[11] = data;
-      m_pPRGROMmemory[2] = m_PRGROMmemory[data];
+      m_state->m_reg[11] = data;
+      CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory[data] );
       break;
    case 0xD000:
       reg = 12;
-      m_reg[12] = data;
-      m_chr[0] = data;
-      m_pCHRmemory[0] = m_CHRmemory[m_chr[0]];
+      m_state->m_reg[12] = data;
+      m_state->m_chr[0] = data;
+      CROM::m_state->m_pCHRmemory[0] = CROM::m_state->m_CHRmemory[m_state->m_chr[0]];
       break;
    case 0xD001:
       reg = 13;
-      m_reg[13] = data;
-      m_chr[2] = data;
-      m_pCHRmemory[2] = m_CHRmemory[m_chr[2]];
+      m_state->m_reg[13] = data;
+      m_state->m_chr[2] = data;
+      CROM::m_state->m_pCHRmemory[2] = CROM::m_state->m_CHRmemory[m_state->m_chr[2]];
       break;
    case 0xD002:
       reg = 14;
-      m_reg[14] = data;
-      m_chr[1] = data;
-      m_pCHRmemory[1] = m_CHRmemory[m_chr[1]];
+      m_state->m_reg[14] = data;
+      m_state->m_chr[1] = data;
+      CROM::m_state->m_pCHRmemory[1] = CROM::m_state->m_CHRmemory[m_state->m_chr[1]];
       break;
    case 0xD003:
       reg = 15;
-      m_reg[15] = data;
-      m_chr[3] = data;
-      m_pCHRmemory[3] = m_CHRmemory[m_chr[3]];
+      m_state->m_reg[15] = data;
+      m_state->m_chr[3] = data;
+      CROM::m_state->m_pCHRmemory[3] = CROM::m_state->m_CHRmemory[m_state->m_chr[3]];
       break;
    case 0xE000:
       reg = 16;
-      m_reg[16] = data;
-      m_chr[4] = data;
-      m_pCHRmemory[4] = m_CHRmemory[m_chr[4]];
+      m_state->m_reg[16] = data;
+      m_state->m_chr[4] = data;
+      CROM::m_state->m_pCHRmemory[4] = CROM::m_state->m_CHRmemory[m_state->m_chr[4]];
       break;
    case 0xE001:
       reg = 17;
-      m_reg[17] = data;
-      m_chr[6] = data;
-      m_pCHRmemory[6] = m_CHRmemory[m_chr[6]];
+      m_state->m_reg[17] = data;
+      m_state->m_chr[6] = data;
+      CROM::m_state->m_pCHRmemory[6] = CROM::m_state->m_CHRmemory[m_state->m_chr[6]];
       break;
    case 0xE002:
       reg = 18;
-      m_reg[18] = data;
-      m_chr[5] = data;
-      m_pCHRmemory[5] = m_CHRmemory[m_chr[5]];
+      m_state->m_reg[18] = data;
+      m_state->m_chr[5] = data;
+      CROM::m_state->m_pCHRmemory[5] = CROM::m_state->m_CHRmemory[m_state->m_chr[5]];
       break;
    case 0xE003:
       reg = 19;
-      m_reg[19] = data;
-      m_chr[7] = data;
-      m_pCHRmemory[7] = m_CHRmemory[m_chr[7]];
+      m_state->m_reg[19] = data;
+      m_state->m_chr[7] = data;
+      CROM::m_state->m_pCHRmemory[7] = CROM::m_state->m_CHRmemory[m_state->m_chr[7]];
       break;
    case 0xF000:
       reg = 20;
-      m_reg[20] = data;
-      m_irqReload = data;
+      m_state->m_reg[20] = data;
+      m_state->m_irqReload = data;
       break;
    case 0xF001:
       reg = 21;
-      m_reg[21] = data;
+      m_state->m_reg[21] = data;
       C6502::RELEASEIRQ(eNESSource_Mapper);
-      m_reg[22] &= 0xFD;
-      m_reg[22] |= ((m_reg[21]&0x01)<<1);
-      if ( m_reg[22]&0x02 )
+      m_state->m_reg[22] &= 0xFD;
+      m_state->m_reg[22] |= ((m_state->m_reg[21]&0x01)<<1);
+      if ( m_state->m_reg[22]&0x02 )
       {
-         m_irqEnabled = true;
+         m_state->m_irqEnabled = true;
       }
       else
       {
-         m_irqEnabled = false;
+         m_state->m_irqEnabled = false;
       }
       break;
    case 0xF002:
       reg = 22;
-      m_reg[22] = data;
+      m_state->m_reg[22] = data;
       C6502::RELEASEIRQ(eNESSource_Mapper);
-      if ( m_reg[21]&0x02 )
+      if ( m_state->m_reg[21]&0x02 )
       {
-         m_irqCounter = m_irqReload;
-         m_irqPrescaler = 0;
-         m_irqPrescalerPhase = 0;
-         m_irqEnabled = true;
+         m_state->m_irqCounter = m_state->m_irqReload;
+         m_state->m_irqPrescaler = 0;
+         m_state->m_irqPrescalerPhase = 0;
+         m_state->m_irqEnabled = true;
       }
       else
       {
-         m_irqEnabled = false;
+         m_state->m_irqEnabled = false;
       }
       break;
    }
@@ -85,7 +85,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,8,8,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper033::m_reg[8] = { 0x00, };
+CROMMapper033::State CROMMapper033::m_defaultState;
+thread_local CROMMapper033::State* CROMMapper033::m_state = &CROMMapper033::m_defaultState;
 
 CROMMapper033::CROMMapper033()
 {
@@ -97,16 +98,16 @@ CROMMapper033::~CROMMapper033()
 
 void CROMMapper033::RESET ( bool soft )
 {
-   m_mapper = 33;
+   CROM::m_state->m_mapper = 33;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
@@ -116,28 +117,28 @@ uint32_t CROMMapper033::DEBUGINFO ( uint32_t addr )
    switch ( addr&0xA003 )
    {
    case 0x8000:
-      return m_reg[0];
+      return m_state->m_reg[0];
       break;
    case 0x8001:
-      return m_reg[1];
+      return m_state->m_reg[1];
       break;
    case 0x8002:
-      return m_reg[2];
+      return m_state->m_reg[2];
       break;
    case 0x8003:
-      return m_reg[3];
+      return m_state->m_reg[3];
       break;
    case 0xA000:
-      return m_reg[4];
+      return m_state->m_reg[4];
       break;
    case 0xA001:
-      return m_reg[5];
+      return m_state->m_reg[5];
       break;
    case 0xA002:
-      return m_reg[6];
+      return m_state->m_reg[6];
       break;
    case 0xA003:
-      return m_reg[7];
+      return m_state->m_reg[7];
       break;
    }
    return 0;
@@ -150,8 +151,8 @@ void CROMMapper033::HMAPPER ( uint32_t addr, uint8_t data )
    switch ( addr&0xA003 )
    {
    case 0x8000:
-      m_reg[0] = data;
-      if ( m_reg[0]&0x40 )
+      m_state->m_reg[0] = data;
+      if ( m_state->m_reg[0]&0x40 )
       {
          CPPU::MIRRORHORIZ ();
       }
@@ -159,39 +160,39 @@ void CROMMapper033::HMAPPER ( uint32_t addr, uint8_t data )
       {
          CPPU::MIRRORVERT ();
       }
-      bank = (m_reg[0]&0x3F)%m_numPrgBanks;
-      m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ bank ];
+      bank = (m_state->m_reg[0]&0x3F)%CROM::m_state->m_numPrgBanks;
+      CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ bank ] );
       break;
    case 0x8001:
-      m_reg[1] = data;
-      bank = (m_reg[1]&0x3F)%m_numPrgBanks;
-      m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ bank ];
+      m_state->m_reg[1] = data;
+      bank = (m_state->m_reg[1]&0x3F)%CROM::m_state->m_numPrgBanks;
+      CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ bank ] );
       break;
    case 0x8002:
-      m_reg[2] = data;
-      m_pCHRmemory [ 0 ] = m_CHRmemory [ (m_reg[2]<<1)+0 ];
-      m_pCHRmemory [ 1 ] = m_CHRmemory [ (m_reg[2]<<1)+1 ];
+      m_state->m_reg[2] = data;
+      CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ (m_state->m_reg[2]<<1)+0 ];
+      CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ (m_state->m_reg[2]<<1)+1 ];
       break;
    case 0x8003:
-      m_reg[3] = data;
-      m_pCHRmemory [ 2 ] = m_CHRmemory [ (m_reg[3]<<1)+0 ];
-      m_pCHRmemory [ 3 ] = m_CHRmemory [ (m_reg[3]<<1)+1 ];
+      m_state->m_reg[3] = data;
+      CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ (m_state->m_reg[3]<<1)+0 ];
+      CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ (m_state->m_reg[3]<<1)+1 ];
       break;
    case 0xA000:
-      m_reg[4] = data;
-      m_pCHRmemory [ 4 ] = m_CHRmemory [ m_reg[4] ];
+      m_state->m_reg[4] = data;
+      CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ m_state->m_reg[4] ];
       break;
    case 0xA001:
-      m_reg[5] = data;
-      m_pCHRmemory [ 5 ] = m_CHRmemory [ m_reg[5] ];
+      m_state->m_reg[5] = data;
+      CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ m_state->m_reg[5] ];
       break;
    case 0xA002:
-      m_reg[6] = data;
-      m_pCHRmemory [ 6 ] = m_CHRmemory [ m_reg[6] ];
+      m_state->m_reg[6] = data;
+      CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ m_state->m_reg[6] ];
       break;
    case 0xA003:
-      m_reg[7] = data;
-      m_pCHRmemory [ 7 ] = m_CHRmemory [ m_reg[7] ];
+      m_state->m_reg[7] = data;
+      CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ m_state->m_reg[7] ];
       break;
    }
 
@@ -62,7 +62,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,4,4,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper034::m_reg[] = { 0x00, };
+CROMMapper034::State CROMMapper034::m_defaultState;
+thread_local CROMMapper034::State* CROMMapper034::m_state = &CROMMapper034::m_defaultState;
 
 CROMMapper034::CROMMapper034()
 {
@@ -74,16 +75,16 @@ CROMMapper034::~CROMMapper034()
 
 void CROMMapper034::RESET ( bool soft )
 {
-   m_mapper = 34;
+   CROM::m_state->m_mapper = 34;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ 2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ 3 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ 2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ 3 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
@@ -92,7 +93,7 @@ uint32_t CROMMapper034::LMAPPER ( uint32_t addr )
 {
    if ( (addr >= 0x7ffd) && (addr < 0x8000) )
    {
-      return m_reg[addr-0x7ffd];
+      return m_state->m_reg[addr-0x7ffd];
    }
    else if ( addr >= 0x6000 )
    {
@@ -106,33 +107,33 @@ void CROMMapper034::LMAPPER ( uint32_t addr, uint8_t data )
 
    if ( (addr >= 0x7ffd) && (addr < 0x8000) )
    {
-      m_reg[addr-0x7ffd] = data;
+      m_state->m_reg[addr-0x7ffd] = data;
 
       switch ( addr )
       {
       case 0x7ffd:
-         bank = (m_reg[0]&(m_numPrgBanks-1))<<2;
+         bank = (m_state->m_reg[0]&(CROM::m_state->m_numPrgBanks-1))<<2;
 
-         m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ bank+0 ];
-         m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ bank+1 ];
-         m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ bank+2 ];
-         m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ bank+3 ];
+         CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ bank+0 ] );
+         CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ bank+1 ] );
+         CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ bank+2 ] );
+         CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ bank+3 ] );
          break;
       case 0x7ffe:
-         bank = (m_reg[1]&((m_numChrBanks<<1)-1));
+         bank = (m_state->m_reg[1]&((CROM::m_state->m_numChrBanks<<1)-1));
 
-         m_pCHRmemory [ 0 ] = m_CHRmemory [ (bank<<2)+0 ];
-         m_pCHRmemory [ 1 ] = m_CHRmemory [ (bank<<2)+1 ];
-         m_pCHRmemory [ 2 ] = m_CHRmemory [ (bank<<2)+2 ];
-         m_pCHRmemory [ 3 ] = m_CHRmemory [ (bank<<2)+3 ];
+         CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ (bank<<2)+0 ];
+         CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ (bank<<2)+1 ];
+         CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ (bank<<2)+2 ];
+         CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ (bank<<2)+3 ];
          break;
       case 0x7fff:
-         bank = (m_reg[2]&((m_numChrBanks<<1)-1));
+         bank = (m_state->m_reg[2]&((CROM::m_state->m_numChrBanks<<1)-1));
 
-         m_pCHRmemory [ 4 ] = m_CHRmemory [ (bank<<2)+0 ];
-         m_pCHRmemory [ 5 ] = m_CHRmemory [ (bank<<2)+1 ];
-         m_pCHRmemory [ 6 ] = m_CHRmemory [ (bank<<2)+2 ];
-         m_pCHRmemory [ 7 ] = m_CHRmemory [ (bank<<2)+3 ];
+         CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ (bank<<2)+0 ];
+         CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ (bank<<2)+1 ];
+         CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ (bank<<2)+2 ];
+         CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ (bank<<2)+3 ];
          break;
       }
 
@@ -150,21 +151,21 @@ void CROMMapper034::LMAPPER ( uint32_t addr, uint8_t data )
 
 uint32_t CROMMapper034::DEBUGINFO ( uint32_t addr )
 {
-   return m_reg[3];
+   return m_state->m_reg[3];
 }
 
 void CROMMapper034::HMAPPER ( uint32_t addr, uint8_t data )
 {
    uint8_t bank;
 
-   m_reg[3] = data%m_numPrgBanks;
+   m_state->m_reg[3] = data%CROM::m_state->m_numPrgBanks;
 
-   bank = m_reg[3]<<2;
+   bank = m_state->m_reg[3]<<2;
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ bank ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ bank+1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ bank+2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ bank+3 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ bank ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ bank+1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ bank+2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ bank+3 ] );
 
    if ( nesIsDebuggable() )
    {
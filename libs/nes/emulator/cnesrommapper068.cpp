@@ -65,7 +65,8 @@ static const char* columnHeadings [] =
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,8,8,tblRegisters,rowHeadings,columnHeadings);
 
 // Sunsoft Mapper #4 stuff
-uint8_t  CROMMapper068::m_reg [] = { 0x00, };
+CROMMapper068::State CROMMapper068::m_defaultState;
+thread_local CROMMapper068::State* CROMMapper068::m_state = &CROMMapper068::m_defaultState;
 
 CROMMapper068::CROMMapper068()
 {
@@ -79,21 +80,21 @@ void CROMMapper068::RESET ( bool soft )
 {
    int32_t idx;
 
-   m_mapper = 68;
+   CROM::m_state->m_mapper = 68;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
    for ( idx = 0; idx < 4; idx++ )
    {
-      m_reg [ idx ] = 0x00;
+      m_state->m_reg [ idx ] = 0x00;
    }
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
@@ -103,28 +104,28 @@ uint32_t CROMMapper068::DEBUGINFO ( uint32_t addr )
    switch ( addr&0xF000 )
    {
    case 0x8000:
-      return m_reg[0];
+      return m_state->m_reg[0];
       break;
    case 0x9000:
-      return m_reg[1];
+      return m_state->m_reg[1];
       break;
    case 0xA000:
-      return m_reg[2];
+      return m_state->m_reg[2];
       break;
    case 0xB000:
-      return m_reg[3];
+      return m_state->m_reg[3];
       break;
    case 0xC000:
-      return m_reg[4];
+      return m_state->m_reg[4];
       break;
    case 0xD000:
-      return m_reg[5];
+      return m_state->m_reg[5];
       break;
    case 0xE000:
-      return m_reg[6];
+      return m_state->m_reg[6];
       break;
    case 0xF000:
-      return m_reg[7];
+      return m_state->m_reg[7];
       break;
    }
 }
@@ -134,49 +135,49 @@ void CROMMapper068::HMAPPER ( uint32_t addr, uint8_t data )
    switch ( addr&0xF000 )
    {
    case 0x8000:
-      m_reg[0] = data;
-      m_pCHRmemory [ 0 ] = m_CHRmemory [ (data<<1)+0 ];
-      m_pCHRmemory [ 1 ] = m_CHRmemory [ (data<<1)+1 ];
+      m_state->m_reg[0] = data;
+      CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ (data<<1)+0 ];
+      CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ (data<<1)+1 ];
       break;
    case 0x9000:
-      m_reg[1] = data;
-      m_pCHRmemory [ 2 ] = m_CHRmemory [ (data<<1)+0 ];
-      m_pCHRmemory [ 3 ] = m_CHRmemory [ (data<<1)+1 ];
+      m_state->m_reg[1] = data;
+      CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ (data<<1)+0 ];
+      CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ (data<<1)+1 ];
       break;
    case 0xA000:
-      m_reg[2] = data;
-      m_pCHRmemory [ 4 ] = m_CHRmemory [ (data<<1)+0 ];
-      m_pCHRmemory [ 5 ] = m_CHRmemory [ (data<<1)+1 ];
+      m_state->m_reg[2] = data;
+      CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ (data<<1)+0 ];
+      CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ (data<<1)+1 ];
       break;
    case 0xB000:
-      m_reg[3] = data;
-      m_pCHRmemory [ 6 ] = m_CHRmemory [ (data<<1)+0 ];
-      m_pCHRmemory [ 7 ] = m_CHRmemory [ (data<<1)+1 ];
+      m_state->m_reg[3] = data;
+      CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ (data<<1)+0 ];
+      CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ (data<<1)+1 ];
       break;
    case 0xC000:
-      m_reg [ 4 ] = data|0x80;
+      m_state->m_reg [ 4 ] = data|0x80;
 
-      if ( (m_reg[6]>>4)&0x01 )
+      if ( (m_state->m_reg[6]>>4)&0x01 )
       {
-         switch ( m_reg[6]&0x01 )
+         switch ( m_state->m_reg[6]&0x01 )
          {
          case 0:
-            CPPU::REMAPVRAM ( 0x0, m_CHRmemory [ m_reg[4] ] );
-            CPPU::REMAPVRAM ( 0x1, m_CHRmemory [ m_reg[5] ] );
-            CPPU::REMAPVRAM ( 0x2, m_CHRmemory [ m_reg[4] ] );
-            CPPU::REMAPVRAM ( 0x3, m_CHRmemory [ m_reg[5] ] );
+            CPPU::REMAPVRAM ( 0x0, CROM::m_state->m_CHRmemory [ m_state->m_reg[4] ] );
+            CPPU::REMAPVRAM ( 0x1, CROM::m_state->m_CHRmemory [ m_state->m_reg[5] ] );
+            CPPU::REMAPVRAM ( 0x2, CROM::m_state->m_CHRmemory [ m_state->m_reg[4] ] );
+            CPPU::REMAPVRAM ( 0x3, CROM::m_state->m_CHRmemory [ m_state->m_reg[5] ] );
             break;
          case 1:
-            CPPU::REMAPVRAM ( 0x0, m_CHRmemory [ m_reg[4] ] );
-            CPPU::REMAPVRAM ( 0x1, m_CHRmemory [ m_reg[4] ] );
-            CPPU::REMAPVRAM ( 0x2, m_CHRmemory [ m_reg[5] ] );
-            CPPU::REMAPVRAM ( 0x3, m_CHRmemory [ m_reg[5] ] );
+            CPPU::REMAPVRAM ( 0x0, CROM::m_state->m_CHRmemory [ m_state->m_reg[4] ] );
+            CPPU::REMAPVRAM ( 0x1, CROM::m_state->m_CHRmemory [ m_state->m_reg[4] ] );
+            CPPU::REMAPVRAM ( 0x2, CROM::m_state->m_CHRmemory [ m_state->m_reg[5] ] );
+            CPPU::REMAPVRAM ( 0x3, CROM::m_state->m_CHRmemory [ m_state->m_reg[5] ] );
             break;
          }
       }
       else
       {
-         switch ( m_reg[6]&0x01 )
+         switch ( m_state->m_reg[6]&0x01 )
          {
             case 0:
                CPPU::MIRRORVERT ();
@@ -189,29 +190,29 @@ void CROMMapper068::HMAPPER ( uint32_t addr, uint8_t data )
 
       break;
    case 0xD000:
-      m_reg [ 5 ] = data|0x80;
+      m_state->m_reg [ 5 ] = data|0x80;
 
-      if ( (m_reg[6]>>4)&0x01 )
+      if ( (m_state->m_reg[6]>>4)&0x01 )
       {
-         switch ( m_reg[6]&0x01 )
+         switch ( m_state->m_reg[6]&0x01 )
          {
          case 0:
-            CPPU::REMAPVRAM ( 0x0, m_CHRmemory [ m_reg[4] ] );
-            CPPU::REMAPVRAM ( 0x1, m_CHRmemory [ m_reg[5] ] );
-            CPPU::REMAPVRAM ( 0x0, m_CHRmemory [ m_reg[4] ] );
-            CPPU::REMAPVRAM ( 0x1, m_CHRmemory [ m_reg[5] ] );
+            CPPU::REMAPVRAM ( 0x0, CROM::m_state->m_CHRmemory [ m_state->m_reg[4] ] );
+            CPPU::REMAPVRAM ( 0x1, CROM::m_state->m_CHRmemory [ m_state->m_reg[5] ] );
+            CPPU::REMAPVRAM ( 0x0, CROM::m_state->m_CHRmemory [ m_state->m_reg[4] ] );
+            CPPU::REMAPVRAM ( 0x1, CROM::m_state->m_CHRmemory [ m_state->m_reg[5] ] );
             break;
          case 1:
-            CPPU::REMAPVRAM ( 0x0, m_CHRmemory [ m_reg[4] ] );
-            CPPU::REMAPVRAM ( 0x1, m_CHRmemory [ m_reg[4] ] );
-            CPPU::REMAPVRAM ( 0x0, m_CHRmemory [ m_reg[5] ] );
-            CPPU::REMAPVRAM ( 0x1, m_CHRmemory [ m_reg[5] ] );
+            CPPU::REMAPVRAM ( 0x0, CROM::m_state->m_CHRmemory [ m_state->m_reg[4] ] );
+            CPPU::REMAPVRAM ( 0x1, CROM::m_state->m_CHRmemory [ m_state->m_reg[4] ] );
+            CPPU::REMAPVRAM ( 0x0, CROM::m_state->m_CHRmemory [ m_state->m_reg[5] ] );
+            CPPU::REMAPVRAM ( 0x1, CROM::m_state->m_CHRmemory [ m_state->m_reg[5] ] );
             break;
          }
       }
       else
       {
-         switch ( m_reg[6]&0x01 )
+         switch ( m_state->m_reg[6]&0x01 )
          {
             case 0:
                CPPU::MIRRORVERT ();
@@ -224,29 +225,29 @@ void CROMMapper068::HMAPPER ( uint32_t addr, uint8_t data )
 
       break;
    case 0xE000:
-      m_reg[6] = data;
+      m_state->m_reg[6] = data;
 
-      if ( (m_reg[6]>>4)&0x01 )
+      if ( (m_state->m_reg[6]>>4)&0x01 )
       {
-         switch ( m_reg[6]&0x01 )
+         switch ( m_state->m_reg[6]&0x01 )
          {
          case 0:
-            CPPU::REMAPVRAM ( 0x0, m_CHRmemory [ m_reg[4] ] );
-            CPPU::REMAPVRAM ( 0x1, m_CHRmemory [ m_reg[5] ] );
-            CPPU::REMAPVRAM ( 0x0, m_CHRmemory [ m_reg[4] ] );
-            CPPU::REMAPVRAM ( 0x1, m_CHRmemory [ m_reg[5] ] );
+            CPPU::REMAPVRAM ( 0x0, CROM::m_state->m_CHRmemory [ m_state->m_reg[4] ] );
+            CPPU::REMAPVRAM ( 0x1, CROM::m_state->m_CHRmemory [ m_state->m_reg[5] ] );
+            CPPU::REMAPVRAM ( 0x0, CROM::m_state->m_CHRmemory [ m_state->m_reg[4] ] );
+            CPPU::REMAPVRAM ( 0x1, CROM::m_state->m_CHRmemory [ m_state->m_reg[5] ] );
             break;
          case 1:
-            CPPU::REMAPVRAM ( 0x0, m_CHRmemory [ m_reg[4] ] );
-            CPPU::REMAPVRAM ( 0x1, m_CHRmemory [ m_reg[4] ] );
-            CPPU::REMAPVRAM ( 0x0, m_CHRmemory [ m_reg[5] ] );
-            CPPU::REMAPVRAM ( 0x1, m_CHRmemory [ m_reg[5] ] );
+            CPPU::REMAPVRAM ( 0x0, CROM::m_state->m_CHRmemory [ m_state->m_reg[4] ] );
+            CPPU::REMAPVRAM ( 0x1, CROM::m_state->m_CHRmemory [ m_state->m_reg[4] ] );
+            CPPU::REMAPVRAM ( 0x0, CROM::m_state->m_CHRmemory [ m_state->m_reg[5] ] );
+            CPPU::REMAPVRAM ( 0x1, CROM::m_state->m_CHRmemory [ m_state->m_reg[5] ] );
             break;
          }
       }
       else
       {
-         switch ( m_reg[6]&0x01 )
+         switch ( m_state->m_reg[6]&0x01 )
          {
             case 0:
                CPPU::MIRRORVERT ();
@@ -259,9 +260,9 @@ void CROMMapper068::HMAPPER ( uint32_t addr, uint8_t data )
 
       break;
    case 0xF000:
-      m_reg[7] = data;
-      m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ (data<<1)+0 ];
-      m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ (data<<1)+1 ];
+      m_state->m_reg[7] = data;
+      CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ (data<<1)+0 ] );
+      CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ (data<<1)+1 ] );
       break;
    }
 }
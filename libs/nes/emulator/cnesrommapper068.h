@@ -14,8 +14,15 @@ public:
    static uint32_t DEBUGINFO ( uint32_t addr );
 
 protected:
-   // Sunsoft Mapper #4
-   static uint8_t  m_reg [ 8 ];
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      // Sunsoft Mapper #4
+      uint8_t m_reg [ 8 ] = { 0x00, };
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 };
 
 #endif
@@ -61,16 +61,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,4,4,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper069::m_reg [] = { 0x00, 0x00, 0x00, 0x00 };
-uint8_t  CROMMapper069::m_subReg [];
-bool           CROMMapper069::m_irqAsserted = false;
-uint16_t  CROMMapper069::m_irqCounter = 0x0000;
-bool           CROMMapper069::m_irqEnable = false;
-bool           CROMMapper069::m_irqCountEnable = false;
-uint8_t  CROMMapper069::m_prg [ 4 ] = { 0, 0, 0, 0 };
-uint8_t  CROMMapper069::m_chr [ 8 ] = { 0, 0, 0, 0, 0, 0, 0, 0 };
-bool     CROMMapper069::m_sramAreaIsSram = false;
-bool     CROMMapper069::m_sramAreaEnabled = false;
+CROMMapper069::State CROMMapper069::m_defaultState;
+thread_local CROMMapper069::State* CROMMapper069::m_state = &CROMMapper069::m_defaultState;
 
 CROMMapper069::CROMMapper069()
 {
@@ -84,52 +76,52 @@ void CROMMapper069::RESET ( bool soft )
 {
    int32_t idx;
 
-   m_mapper = 69;
+   CROM::m_state->m_mapper = 69;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
    for ( idx = 0; idx < 4; idx++ )
    {
-      m_reg [ idx ] = 0x00;
-      m_prg [ idx ] = 0;
+      m_state->m_reg [ idx ] = 0x00;
+      m_state->m_prg [ idx ] = 0;
    }
 
    for ( idx = 0; idx < 8; idx++ )
    {
-      m_chr [ idx ] = 0;
+      m_state->m_chr [ idx ] = 0;
    }
 
-   m_irqCounter = 0x0000;
-   m_irqEnable = false;
-   m_irqCountEnable = false;
-   m_irqAsserted = false;
+   m_state->m_irqCounter = 0x0000;
+   m_state->m_irqEnable = false;
+   m_state->m_irqCountEnable = false;
+   m_state->m_irqAsserted = false;
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
-   m_sramAreaIsSram = false;
-   m_sramAreaEnabled = false;
+   m_state->m_sramAreaIsSram = false;
+   m_state->m_sramAreaEnabled = false;
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
 
 void CROMMapper069::SYNCCPU ( void )
 {
-   uint32_t prevCounter = m_irqCounter;
+   uint32_t prevCounter = m_state->m_irqCounter;
 
-   if ( m_irqCountEnable )
+   if ( m_state->m_irqCountEnable )
    {
-      m_irqCounter--;
+      m_state->m_irqCounter--;
    }
 
-   if ( m_irqEnable && (!prevCounter) )
+   if ( m_state->m_irqEnable && (!prevCounter) )
    {
       C6502::ASSERTIRQ ( eNESSource_Mapper );
-      m_irqAsserted = true;
+      m_state->m_irqAsserted = true;
 
       if ( nesIsDebuggable() )
       {
@@ -139,41 +131,66 @@ void CROMMapper069::SYNCCPU ( void )
    }
 }
 
+uint32_t CROMMapper069::CPUIDLE ( void )
+{
+   if ( m_state->m_irqEnable )
+   {
+      // The IRQ fires on every cycle that starts with the counter at zero.
+      if ( m_state->m_irqCountEnable )
+      {
+         return m_state->m_irqCounter;
+      }
+      else if ( !m_state->m_irqCounter )
+      {
+         return 0;
+      }
+   }
+   return MAPPER_IDLE_FOREVER;
+}
+
+void CROMMapper069::SKIPCPU ( uint32_t cycles )
+{
+   if ( m_state->m_irqCountEnable )
+   {
+      m_state->m_irqCounter -= cycles;
+   }
+}
+
 void CROMMapper069::SETCPU ( void )
 {
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ m_prg[1] ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ m_prg[2] ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_prg[3] ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ m_state->m_prg[1] ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ m_state->m_prg[2] ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ m_state->m_prg[3] ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 }
 
 void CROMMapper069::SETPPU ( void )
 {
-   m_pCHRmemory [ 0 ] = m_CHRmemory [ m_chr[0] ];
-   m_pCHRmemory [ 1 ] = m_CHRmemory [ m_chr[1] ];
-   m_pCHRmemory [ 2 ] = m_CHRmemory [ m_chr[2] ];
-   m_pCHRmemory [ 3 ] = m_CHRmemory [ m_chr[3] ];
-   m_pCHRmemory [ 4 ] = m_CHRmemory [ m_chr[4] ];
-   m_pCHRmemory [ 5 ] = m_CHRmemory [ m_chr[5] ];
-   m_pCHRmemory [ 6 ] = m_CHRmemory [ m_chr[6] ];
-   m_pCHRmemory [ 7 ] = m_CHRmemory [ m_chr[7] ];
+   CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[0] ];
+   CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[1] ];
+   CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[2] ];
+   CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[3] ];
+   CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[4] ];
+   CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[5] ];
+   CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[6] ];
+   CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ m_state->m_chr[7] ];
 }
 
 uint32_t CROMMapper069::DEBUGINFO ( uint32_t addr )
 {
-   return m_reg [ ((addr-MEM_32KB)/MEM_8KB) ];
+   return m_state->m_reg [ ((addr-MEM_32KB)/MEM_8KB) ];
 }
 
 void CROMMapper069::HMAPPER ( uint32_t addr, uint8_t data )
 {
    int32_t reg = ((addr-0x8000)/MEM_8KB);
-   m_reg [ reg ] = data;
+   m_state->m_reg [ reg ] = data;
 
    switch ( addr&0xE000 )
    {
       case 0xA000:
-         m_subReg [ m_reg[0]&0xF ] = data;
-         switch ( m_reg[0]&0xF )
+         m_state->m_subReg [ m_state->m_reg[0]&0xF ] = data;
+         switch ( m_state->m_reg[0]&0xF )
          {
             case 0x00:
             case 0x01:
@@ -183,26 +200,26 @@ void CROMMapper069::HMAPPER ( uint32_t addr, uint8_t data )
             case 0x05:
             case 0x06:
             case 0x07:
-               m_chr [ m_reg[0]&0xF ] = data;
+               m_state->m_chr [ m_state->m_reg[0]&0xF ] = data;
                SETPPU ();
                break;
             case 0x08:
-               m_sramAreaIsSram = (data&0x40);
-               m_sramAreaEnabled = (data&0x80);
-               if ( m_sramAreaIsSram )
+               m_state->m_sramAreaIsSram = (data&0x40);
+               m_state->m_sramAreaEnabled = (data&0x80);
+               if ( m_state->m_sramAreaIsSram )
                {
-                  m_prg[0] = (data&0x3F)%NUM_SRAM_BANKS;
-                  CROM::REMAPSRAM(0x6000,m_prg[0]);
+                  m_state->m_prg[0] = (data&0x3F)%NUM_SRAM_BANKS;
+                  CROM::REMAPSRAM(0x6000,m_state->m_prg[0]);
                }
                else
                {
-                  m_prg[0] = (data&0x3F)%m_numPrgBanks;
+                  m_state->m_prg[0] = (data&0x3F)%CROM::m_state->m_numPrgBanks;
                }
                break;
             case 0x09:
             case 0x0A:
             case 0x0B:
-               m_prg [ (m_reg[0]&0xF)-8 ] = data%m_numPrgBanks;
+               m_state->m_prg [ (m_state->m_reg[0]&0xF)-8 ] = data%CROM::m_state->m_numPrgBanks;
                SETCPU ();
                break;
             case 0x0C:
@@ -223,21 +240,21 @@ void CROMMapper069::HMAPPER ( uint32_t addr, uint8_t data )
                }
                break;
             case 0x0D:
-               m_irqEnable = (data&0x01);
-               if ( !m_irqEnable )
+               m_state->m_irqEnable = (data&0x01);
+               if ( !m_state->m_irqEnable )
                {
-                  m_irqAsserted = false;
+                  m_state->m_irqAsserted = false;
                   C6502::RELEASEIRQ(eNESSource_Mapper);
                }
-               m_irqCountEnable = (data&0x80);
+               m_state->m_irqCountEnable = (data&0x80);
                break;
             case 0x0E:
-               m_irqCounter &= 0xFF00;
-               m_irqCounter |= data;
+               m_state->m_irqCounter &= 0xFF00;
+               m_state->m_irqCounter |= data;
                break;
             case 0x0F:
-               m_irqCounter &= 0x00FF;
-               m_irqCounter |= (data<<8);
+               m_state->m_irqCounter &= 0x00FF;
+               m_state->m_irqCounter |= (data<<8);
                break;
          }
 
@@ -260,13 +277,13 @@ uint32_t CROMMapper069::LMAPPER ( uint32_t addr )
 
    if ( addr >= 0x6000 )
    {
-      if ( m_sramAreaIsSram && m_sramAreaEnabled )
+      if ( m_state->m_sramAreaIsSram && m_state->m_sramAreaEnabled )
       {
          data = CROM::SRAMVIRT(addr);
       }
-      else if ( !m_sramAreaIsSram )
+      else if ( !m_state->m_sramAreaIsSram )
       {
-         data = CROM::PRGROMPHYS((m_prg[0]*MEM_8KB)+(addr-0x6000));
+         data = CROM::PRGROMPHYS((m_state->m_prg[0]*MEM_8KB)+(addr-0x6000));
       }
    }
 
@@ -277,7 +294,7 @@ void CROMMapper069::LMAPPER ( uint32_t addr, uint8_t data )
 {
    if ( addr >= 0x6000 )
    {
-      if ( m_sramAreaIsSram && m_sramAreaEnabled )
+      if ( m_state->m_sramAreaIsSram && m_state->m_sramAreaEnabled )
       {
          CROM::SRAMVIRT(addr,data);
       }
@@ -14,6 +14,8 @@ public:
    static uint32_t LMAPPER ( uint32_t addr );
    static void LMAPPER ( uint32_t addr, uint8_t data );
    static void SYNCCPU ( void );
+   static uint32_t CPUIDLE ( void );
+   static void SKIPCPU ( uint32_t cycles );
    static void SETCPU ( void );
    static void SETPPU ( void );
    static uint32_t DEBUGINFO ( uint32_t addr );
@@ -22,53 +24,60 @@ public:
    // Note: called directly!
    static uint32_t IRQENABLED ( void )
    {
-      return m_irqEnable;
+      return m_state->m_irqEnable;
    }
    static uint32_t IRQCOUNTENABLED ( void )
    {
-      return m_irqCountEnable;
+      return m_state->m_irqCountEnable;
    }
    static uint32_t IRQASSERTED ( void )
    {
-      return m_irqAsserted;
+      return m_state->m_irqAsserted;
    }
    static uint32_t IRQCOUNTER ( void )
    {
-      return m_irqCounter;
+      return m_state->m_irqCounter;
    }
    static uint32_t SRAMENABLED ( void )
    {
-      return m_sramAreaEnabled;
+      return m_state->m_sramAreaEnabled;
    }
    static uint32_t ISSRAM ( void )
    {
-      return m_sramAreaIsSram;
+      return m_state->m_sramAreaIsSram;
    }
    static uint32_t SRAMPRGBANK ( void )
    {
-      return m_prg[0];
+      return m_state->m_prg[0];
    }
    static uint32_t REGSELECTED ( void )
    {
-      return m_reg[0]&0x0F;
+      return m_state->m_reg[0]&0x0F;
    }
    static uint32_t REGVALUE ( void )
    {
-      return m_subReg[m_reg[0]&0x0F];
+      return m_state->m_subReg[m_state->m_reg[0]&0x0F];
    }
 
 protected:
-   // MMC3
-   static uint8_t  m_reg [ 4 ];
-   static uint8_t  m_subReg [ 16 ];
-   static bool           m_irqAsserted;
-   static uint16_t  m_irqCounter;
-   static bool           m_irqEnable;
-   static bool           m_irqCountEnable;
-   static uint8_t  m_prg [ 4 ];
-   static uint8_t  m_chr [ 8 ];
-   static bool m_sramAreaIsSram;
-   static bool m_sramAreaEnabled;
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      // MMC3
+      uint8_t m_reg [ 4 ] = { 0x00, 0x00, 0x00, 0x00 };
+      uint8_t m_subReg [ 16 ];
+      bool m_irqAsserted = false;
+      uint16_t m_irqCounter = 0x0000;
+      bool m_irqEnable = false;
+      bool m_irqCountEnable = false;
+      uint8_t m_prg [ 4 ] = { 0, 0, 0, 0 };
+      uint8_t m_chr [ 8 ] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+      bool m_sramAreaIsSram = false;
+      bool m_sramAreaEnabled = false;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 };
 
 #endif
@@ -81,10 +81,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,7,7,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper073::m_reg [] = { 0x00, };
-uint16_t CROMMapper073::m_irqReload = 0;
-uint16_t CROMMapper073::m_irqCounter = 0;
-bool     CROMMapper073::m_irqEnabled = false;
+CROMMapper073::State CROMMapper073::m_defaultState;
+thread_local CROMMapper073::State* CROMMapper073::m_state = &CROMMapper073::m_defaultState;
 
 CROMMapper073::CROMMapper073()
 {
@@ -98,20 +96,20 @@ void CROMMapper073::RESET ( bool soft )
 {
    int32_t idx;
 
-   m_mapper = 73;
+   CROM::m_state->m_mapper = 73;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
-   m_irqReload = 0;
-   m_irqCounter = 0;
-   m_irqEnabled = false;
+   m_state->m_irqReload = 0;
+   m_state->m_irqCounter = 0;
+   m_state->m_irqEnabled = false;
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
@@ -121,10 +119,10 @@ void CROMMapper073::SYNCCPU ( void )
    uint16_t counterMask;
    uint16_t counter;
 
-   if ( m_irqEnabled )
+   if ( m_state->m_irqEnabled )
    {
       // Get relevant counter bits.
-      if ( (m_reg[4]&0x04) == 0 )
+      if ( (m_state->m_reg[4]&0x04) == 0 )
       {
          // 16 bits
          counterMask = 0xFFFF;
@@ -135,16 +133,16 @@ void CROMMapper073::SYNCCPU ( void )
          counterMask = 0x00FF;
       }
 
-      counter = m_irqCounter&counterMask;
+      counter = m_state->m_irqCounter&counterMask;
       counter++;
-      m_irqCounter &= (~counterMask);
-      m_irqCounter |= (counter&counterMask);
+      m_state->m_irqCounter &= (~counterMask);
+      m_state->m_irqCounter |= (counter&counterMask);
 
-      if ( (m_irqCounter&counterMask) == 0 )
+      if ( (m_state->m_irqCounter&counterMask) == 0 )
       {
          // Reload!
-         m_irqCounter &= (~counterMask);
-         m_irqCounter |= m_irqReload&counterMask;
+         m_state->m_irqCounter &= (~counterMask);
+         m_state->m_irqCounter |= m_state->m_irqReload&counterMask;
 
          C6502::ASSERTIRQ(eNESSource_Mapper);
 
@@ -157,30 +155,55 @@ void CROMMapper073::SYNCCPU ( void )
    }
 }
 
+uint32_t CROMMapper073::CPUIDLE ( void )
+{
+   uint16_t counterMask = (m_state->m_reg[4]&0x04) ? 0x00FF : 0xFFFF;
+
+   if ( m_state->m_irqEnabled )
+   {
+      // The IRQ fires on the cycle the counter's live bits wrap to zero.
+      return counterMask-(m_state->m_irqCounter&counterMask);
+   }
+   return MAPPER_IDLE_FOREVER;
+}
+
+void CROMMapper073::SKIPCPU ( uint32_t cycles )
+{
+   uint16_t counterMask = (m_state->m_reg[4]&0x04) ? 0x00FF : 0xFFFF;
+   uint16_t counter;
+
+   if ( m_state->m_irqEnabled )
+   {
+      counter = (m_state->m_irqCounter&counterMask)+cycles;
+      m_state->m_irqCounter &= (~counterMask);
+      m_state->m_irqCounter |= (counter&counterMask);
+   }
+}
+
 uint32_t CROMMapper073::DEBUGINFO ( uint32_t addr )
 {
    switch ( addr )
    {
    case 0x8000:
-      return m_reg[0];
+      return m_state->m_reg[0];
       break;
    case 0x9000:
-      return m_reg[1];
+      return m_state->m_reg[1];
       break;
    case 0xA000:
-      return m_reg[2];
+      return m_state->m_reg[2];
       break;
    case 0xB000:
-      return m_reg[3];
+      return m_state->m_reg[3];
       break;
    case 0xC000:
-      return m_reg[4];
+      return m_state->m_reg[4];
       break;
    case 0xD000:
-      return m_reg[5];
+      return m_state->m_reg[5];
       break;
    case 0xF000:
-      return m_reg[6];
+      return m_state->m_reg[6];
       break;
    }
 }
@@ -193,55 +216,55 @@ void CROMMapper073::HMAPPER ( uint32_t addr, uint8_t data )
    {
    case 0x8000:
       reg = 0;
-      m_reg[0] = data;
-      m_irqReload &= 0xFFF0;
-      m_irqReload |= (data&0x0F);
+      m_state->m_reg[0] = data;
+      m_state->m_irqReload &= 0xFFF0;
+      m_state->m_irqReload |= (data&0x0F);
       break;
    case 0x9000:
       reg = 1;
-      m_reg[1] = data;
-      m_irqReload &= 0xFF0F;
-      m_irqReload |= ((data&0x0F)<<4);
+      m_state->m_reg[1] = data;
+      m_state->m_irqReload &= 0xFF0F;
+      m_state->m_irqReload |= ((data&0x0F)<<4);
       break;
    case 0xA000:
       reg = 2;
-      m_reg[2] = data;
-      m_irqReload &= 0xF0FF;
-      m_irqReload |= ((data&0x0F)<<8);
+      m_state->m_reg[2] = data;
+      m_state->m_irqReload &= 0xF0FF;
+      m_state->m_irqReload |= ((data&0x0F)<<8);
       break;
    case 0xB000:
       reg = 3;
-      m_reg[3] = data;
-      m_irqReload &= 0x0FFF;
-      m_irqReload |= ((data&0x0F)<<12);
+      m_state->m_reg[3] = data;
+      m_state->m_irqReload &= 0x0FFF;
+      m_state->m_irqReload |= ((data&0x0F)<<12);
       break;
    case 0xC000:
       reg = 4;
-      m_reg[4] = data;
-      m_irqCounter = m_irqReload;
-      m_irqEnabled = data&0x02;
+      m_state->m_reg[4] = data;
+      m_state->m_irqCounter = m_state->m_irqReload;
+      m_state->m_irqEnabled = data&0x02;
       C6502::RELEASEIRQ(eNESSource_Mapper);
       break;
    case 0xD000:
       reg = 5;
-      m_reg[5] = data;
-      m_reg[4] &= 0xFD;
-      m_reg[4] |= ((m_reg[4]&0x01)<<1);
-      if ( m_reg[4]&0x02 )
+      m_state->m_reg[5] = data;
+      m_state->m_reg[4] &= 0xFD;
+      m_state->m_reg[4] |= ((m_state->m_reg[4]&0x01)<<1);
+      if ( m_state->m_reg[4]&0x02 )
       {
-         m_irqEnabled = true;
+         m_state->m_irqEnabled = true;
       }
       else
       {
-         m_irqEnabled = false;
+         m_state->m_irqEnabled = false;
       }
       C6502::RELEASEIRQ(eNESSource_Mapper);
       break;
    case 0xF000:
       reg = 6;
-      m_reg[6] = data;
-      m_pPRGROMmemory[0] = m_PRGROMmemory[((data<<1)%m_numPrgBanks)+0];
-      m_pPRGROMmemory[1] = m_PRGROMmemory[((data<<1)%m_numPrgBanks)+1];
+      m_state->m_reg[6] = data;
+      CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory[((data<<1)%CROM::m_state->m_numPrgBanks)+0] );
+      CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory[((data<<1)%CROM::m_state->m_numPrgBanks)+1] );
       break;
    }
 
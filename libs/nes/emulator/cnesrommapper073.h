@@ -12,14 +12,23 @@ public:
    static void RESET ( bool soft );
    static void HMAPPER ( uint32_t addr, uint8_t data );
    static void SYNCCPU ( void );
+   static uint32_t CPUIDLE ( void );
+   static void SKIPCPU ( uint32_t cycles );
    static uint32_t DEBUGINFO ( uint32_t addr );
 
 protected:
-   // VRC3
-   static uint8_t  m_reg [ 7 ];
-   static uint16_t m_irqReload;
-   static uint16_t m_irqCounter;
-   static bool     m_irqEnabled;
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      // VRC3
+      uint8_t m_reg [ 7 ] = { 0x00, };
+      uint16_t m_irqReload = 0;
+      uint16_t m_irqCounter = 0;
+      bool m_irqEnabled = false;
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 };
 
 #endif
@@ -61,9 +61,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,4,4,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper075::m_reg [] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
-uint8_t  CROMMapper075::m_prg [ 4 ] = { 0, 0, 0, 0 };
-uint8_t  CROMMapper075::m_chr [ 8 ] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+CROMMapper075::State CROMMapper075::m_defaultState;
+thread_local CROMMapper075::State* CROMMapper075::m_state = &CROMMapper075::m_defaultState;
 
 CROMMapper075::CROMMapper075()
 {
@@ -77,58 +76,58 @@ void CROMMapper075::RESET ( bool soft )
 {
    int32_t idx;
 
-   m_mapper = 75;
+   CROM::m_state->m_mapper = 75;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
    for ( idx = 0; idx < 4; idx++ )
    {
-      m_prg [ idx ] = 0;
+      m_state->m_prg [ idx ] = 0;
    }
 
    for ( idx = 0; idx < 6; idx++ )
    {
-      m_reg [ idx ] = 0x00;
+      m_state->m_reg [ idx ] = 0x00;
    }
 
    for ( idx = 0; idx < 8; idx++ )
    {
-      m_chr [ idx ] = 0;
+      m_state->m_chr [ idx ] = 0;
    }
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
 
 void CROMMapper075::SETCPU ( void )
 {
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ m_prg[0] ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ m_prg[1] ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ m_prg[2] ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ m_numPrgBanks-1 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ m_state->m_prg[0] ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ m_state->m_prg[1] ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ m_state->m_prg[2] ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ CROM::m_state->m_numPrgBanks-1 ] );
 }
 
 void CROMMapper075::SETPPU ( void )
 {
-   m_pCHRmemory [ 0 ] = m_CHRmemory [ (m_chr[0]<<2)+0 ];
-   m_pCHRmemory [ 1 ] = m_CHRmemory [ (m_chr[1]<<2)+1 ];
-   m_pCHRmemory [ 2 ] = m_CHRmemory [ (m_chr[2]<<2)+2 ];
-   m_pCHRmemory [ 3 ] = m_CHRmemory [ (m_chr[3]<<2)+3 ];
-   m_pCHRmemory [ 4 ] = m_CHRmemory [ (m_chr[4]<<2)+0 ];
-   m_pCHRmemory [ 5 ] = m_CHRmemory [ (m_chr[5]<<2)+1 ];
-   m_pCHRmemory [ 6 ] = m_CHRmemory [ (m_chr[6]<<2)+2 ];
-   m_pCHRmemory [ 7 ] = m_CHRmemory [ (m_chr[7]<<2)+3 ];
+   CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chr[0]<<2)+0 ];
+   CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chr[1]<<2)+1 ];
+   CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chr[2]<<2)+2 ];
+   CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chr[3]<<2)+3 ];
+   CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chr[4]<<2)+0 ];
+   CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chr[5]<<2)+1 ];
+   CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chr[6]<<2)+2 ];
+   CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ (m_state->m_chr[7]<<2)+3 ];
 }
 
 uint32_t CROMMapper075::DEBUGINFO ( uint32_t addr )
 {
-   return m_reg [ ((addr-MEM_32KB)/MEM_8KB) ];
+   return m_state->m_reg [ ((addr-MEM_32KB)/MEM_8KB) ];
 }
 
 void CROMMapper075::HMAPPER ( uint32_t addr, uint8_t data )
@@ -139,29 +138,29 @@ void CROMMapper075::HMAPPER ( uint32_t addr, uint8_t data )
    {
    case 0x8000:
       reg = 0;
-      m_reg[reg] = data;
-      m_prg [ 0 ] = data%m_numPrgBanks;
+      m_state->m_reg[reg] = data;
+      m_state->m_prg [ 0 ] = data%CROM::m_state->m_numPrgBanks;
       SETCPU ();
       break;
    case 0x9000:
       reg = 1;
-      m_reg[reg] = data;
-      m_chr[0] &= 0x0F;
-      m_chr[1] &= 0x0F;
-      m_chr[2] &= 0x0F;
-      m_chr[3] &= 0x0F;
-      m_chr[4] &= 0x0F;
-      m_chr[5] &= 0x0F;
-      m_chr[6] &= 0x0F;
-      m_chr[7] &= 0x0F;
-      m_chr[0] |= ((data&0x02)<<3);
-      m_chr[1] |= ((data&0x02)<<3);
-      m_chr[2] |= ((data&0x02)<<3);
-      m_chr[3] |= ((data&0x02)<<3);
-      m_chr[4] |= ((data&0x04)<<2);
-      m_chr[5] |= ((data&0x04)<<2);
-      m_chr[6] |= ((data&0x04)<<2);
-      m_chr[7] |= ((data&0x04)<<2);
+      m_state->m_reg[reg] = data;
+      m_state->m_chr[0] &= 0x0F;
+      m_state->m_chr[1] &= 0x0F;
+      m_state->m_chr[2] &= 0x0F;
+      m_state->m_chr[3] &= 0x0F;
+      m_state->m_chr[4] &= 0x0F;
+      m_state->m_chr[5] &= 0x0F;
+      m_state->m_chr[6] &= 0x0F;
+      m_state->m_chr[7] &= 0x0F;
+      m_state->m_chr[0] |= ((data&0x02)<<3);
+      m_state->m_chr[1] |= ((data&0x02)<<3);
+      m_state->m_chr[2] |= ((data&0x02)<<3);
+      m_state->m_chr[3] |= ((data&0x02)<<3);
+      m_state->m_chr[4] |= ((data&0x04)<<2);
+      m_state->m_chr[5] |= ((data&0x04)<<2);
+      m_state->m_chr[6] |= ((data&0x04)<<2);
+      m_state->m_chr[7] |= ((data&0x04)<<2);
       SETPPU ();
       switch ( data&0x01 )
       {
@@ -175,40 +174,40 @@ void CROMMapper075::HMAPPER ( uint32_t addr, uint8_t data )
       break;
    case 0xA000:
       reg = 2;
-      m_reg[reg] = data;
-      m_prg [ 1 ] = data%m_numPrgBanks;
+      m_state->m_reg[reg] = data;
+      m_state->m_prg [ 1 ] = data%CROM::m_state->m_numPrgBanks;
       SETCPU ();
       break;
    case 0xC000:
       reg = 3;
-      m_reg[reg] = data;
-      m_prg [ 2 ] = data%m_numPrgBanks;
+      m_state->m_reg[reg] = data;
+      m_state->m_prg [ 2 ] = data%CROM::m_state->m_numPrgBanks;
       SETCPU ();
       break;
    case 0xE000:
       reg = 4;
-      m_reg[reg] = data;
-      m_chr[0] &= (0x10);
-      m_chr[1] &= (0x10);
-      m_chr[2] &= (0x10);
-      m_chr[3] &= (0x10);
-      m_chr[0] |= (data&0x0F);
-      m_chr[1] |= (data&0x0F);
-      m_chr[2] |= (data&0x0F);
-      m_chr[3] |= (data&0x0F);
+      m_state->m_reg[reg] = data;
+      m_state->m_chr[0] &= (0x10);
+      m_state->m_chr[1] &= (0x10);
+      m_state->m_chr[2] &= (0x10);
+      m_state->m_chr[3] &= (0x10);
+      m_state->m_chr[0] |= (data&0x0F);
+      m_state->m_chr[1] |= (data&0x0F);
+      m_state->m_chr[2] |= (data&0x0F);
+      m_state->m_chr[3] |= (data&0x0F);
       SETPPU ();
       break;
    case 0xF000:
       reg = 5;
-      m_reg[reg] = data;
-      m_chr[4] &= (0x10);
-      m_chr[5] &= (0x10);
-      m_chr[6] &= (0x10);
-      m_chr[7] &= (0x10);
-      m_chr[4] |= (data&0x0F);
-      m_chr[5] |= (data&0x0F);
-      m_chr[6] |= (data&0x0F);
-      m_chr[7] |= (data&0x0F);
+      m_state->m_reg[reg] = data;
+      m_state->m_chr[4] &= (0x10);
+      m_state->m_chr[5] &= (0x10);
+      m_state->m_chr[6] &= (0x10);
+      m_state->m_chr[7] &= (0x10);
+      m_state->m_chr[4] |= (data&0x0F);
+      m_state->m_chr[5] |= (data&0x0F);
+      m_state->m_chr[6] |= (data&0x0F);
+      m_state->m_chr[7] |= (data&0x0F);
       SETPPU ();
       break;
    }
@@ -16,10 +16,17 @@ public:
    static uint32_t DEBUGINFO ( uint32_t addr );
 
 protected:
-   // VRC1
-   static uint8_t  m_reg [ 6 ];
-   static uint8_t  m_prg [ 4 ];
-   static uint8_t  m_chr [ 8 ];
+   // Per-machine state (see NesMachine).
+   struct State
+   {
+      // VRC1
+      uint8_t m_reg [ 6 ] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+      uint8_t m_prg [ 4 ] = { 0, 0, 0, 0 };
+      uint8_t m_chr [ 8 ] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+   };
+   static thread_local State* m_state;
+   static State m_defaultState;
+   friend struct NesMachine;
 };
 
 #endif
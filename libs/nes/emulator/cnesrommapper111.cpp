@@ -45,7 +45,8 @@ static const char* columnHeadings [] =
 
 static CRegisterDatabase* dbRegisters = new CRegisterDatabase(eMemory_cartMapper,1,1,1,tblRegisters,rowHeadings,columnHeadings);
 
-uint8_t  CROMMapper111::m_reg = 0x00;
+CROMMapper111::State CROMMapper111::m_defaultState;
+thread_local CROMMapper111::State* CROMMapper111::m_state = &CROMMapper111::m_defaultState;
 
 CROMMapper111::CROMMapper111()
 {
@@ -57,59 +58,59 @@ CROMMapper111::~CROMMapper111()
 
 void CROMMapper111::RESET ( bool soft )
 {
-   m_mapper = 111;
+   CROM::m_state->m_mapper = 111;
 
-   m_dbRegisters = dbRegisters;
+   CROM::m_state->m_dbRegisters = dbRegisters;
 
-   CROM::RESET ( m_mapper, soft );
+   CROM::RESET ( CROM::m_state->m_mapper, soft );
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ 0 ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ 1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ 2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ 3 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ 0 ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ 1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ 2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ 3 ] );
 
    // CHR ROM/RAM already set up in CROM::RESET()...
 }
 
 uint32_t CROMMapper111::DEBUGINFO ( uint32_t addr )
 {
-   return m_reg;
+   return m_state->m_reg;
 }
 
 void CROMMapper111::LMAPPER ( uint32_t addr, uint8_t data )
 {
    uint8_t bank;
 
-   m_reg = data;
+   m_state->m_reg = data;
 
-   bank = (m_reg&0x0f)<<2;
+   bank = (m_state->m_reg&0x0f)<<2;
 
-   m_pPRGROMmemory [ 0 ] = m_PRGROMmemory [ bank ];
-   m_pPRGROMmemory [ 1 ] = m_PRGROMmemory [ bank+1 ];
-   m_pPRGROMmemory [ 2 ] = m_PRGROMmemory [ bank+2 ];
-   m_pPRGROMmemory [ 3 ] = m_PRGROMmemory [ bank+3 ];
+   CROM::REMAPPRG ( 0, CROM::m_state->m_PRGROMmemory [ bank ] );
+   CROM::REMAPPRG ( 1, CROM::m_state->m_PRGROMmemory [ bank+1 ] );
+   CROM::REMAPPRG ( 2, CROM::m_state->m_PRGROMmemory [ bank+2 ] );
+   CROM::REMAPPRG ( 3, CROM::m_state->m_PRGROMmemory [ bank+3 ] );
 
-   bank = (m_reg&0x10)>>1;
+   bank = (m_state->m_reg&0x10)>>1;
 
-   m_pCHRmemory [ 0 ] = m_CHRmemory [ bank+0 ];
-   m_pCHRmemory [ 1 ] = m_CHRmemory [ bank+1 ];
-   m_pCHRmemory [ 2 ] = m_CHRmemory [ bank+2 ];
-   m_pCHRmemory [ 3 ] = m_CHRmemory [ bank+3 ];
-   m_pCHRmemory [ 4 ] = m_CHRmemory [ bank+4 ];
-   m_pCHRmemory [ 5 ] = m_CHRmemory [ bank+5 ];
-   m_pCHRmemory [ 6 ] = m_CHRmemory [ bank+6 ];
-   m_pCHRmemory [ 7 ] = m_CHRmemory [ bank+7 ];
+   CROM::m_state->m_pCHRmemory [ 0 ] = CROM::m_state->m_CHRmemory [ bank+0 ];
+   CROM::m_state->m_pCHRmemory [ 1 ] = CROM::m_state->m_CHRmemory [ bank+1 ];
+   CROM::m_state->m_pCHRmemory [ 2 ] = CROM::m_state->m_CHRmemory [ bank+2 ];
+   CROM::m_state->m_pCHRmemory [ 3 ] = CROM::m_state->m_CHRmemory [ bank+3 ];
+   CROM::m_state->m_pCHRmemory [ 4 ] = CROM::m_state->m_CHRmemory [ bank+4 ];
+   CROM::m_state->m_pCHRmemory [ 5 ] = CROM::m_state->m_CHRmemory [ bank+5 ];
+   CROM::m_state->m_pCHRmemory [ 6 ] = CROM::m_state->m_CHRmemory [ bank+6 ];
+   CROM::m_state->m_pCHRmemory [ 7 ] = CROM::m_state->m_CHRmemory [ bank+7 ];
 
-   bank = (m_reg&0x20)>>2;
+   bank = (m_state->m_reg&0x20)>>2;
 
-   m_pVRAMmemory [ 0 ] = m_VRAMmemory+((bank+0)*MEM_1KB);
-   m_pVRAMmemory [ 1 ] = m_VRAMmemory+((bank+1)*MEM_1KB);
-   m_pVRAMmemory [ 2 ] = m_VRAMmemory+((bank+2)*MEM_1KB);
-   m_pVRAMmemory [ 3 ] = m_VRAMmemory+((bank+3)*MEM_1KB);
-   m_pVRAMmemory [ 4 ] = m_VRAMmemory+((bank+4)*MEM_1KB);
-   m_pVRAMmemory [ 5 ] = m_VRAMmemory+((bank+5)*MEM_1KB);
-   m_pVRAMmemory [ 6 ] = m_VRAMmemory+((bank+6)*MEM_1KB);
-   m_pVRAMmemory [ 7 ] = m_VRAMmemory+((bank+7)*MEM_1KB);
+   CROM::m_state->m_pVRAMmemory [ 0 ] = CROM::m_state->m_VRAMmemory+((bank+0)*MEM_1KB);
+   CROM::m_state->m_pVRAMmemory [ 1 ] = CROM::m_state->m_VRAMmemory+((bank+1)*MEM_1KB);
+   CROM::m_state->m_pVRAMmemory [ 2 ] = CROM::m_state->m_VRAMmemory+((bank+2)*MEM_1KB);
+   CROM::m_state->m_pVRAMmemory [ 3 ] = CROM::m_state->m_VRAMmemory+((bank+3)*MEM_1KB);
+   CROM::m_state->m_pVRAMmemory [ 4 ] = CROM::m_state->m_VRAMmemory+((bank+4)*MEM_1KB);
+   CROM::m_state->m_pVRAMmemory [ 5 ] = CROM::m_state->m_VRAMmemory+((bank+5)*MEM_1KB);
+   CROM::m_state->m_pVRAMmemory [ 6 ] = CROM::m_state->m_VRAMmemory+((bank+6)*MEM_1KB);
+   CROM::m_state->m_pVRAMmemory [ 7 ] = CROM::m_state->m_VRAMmemory+((bank+7)*MEM_1KB);
 
    if ( nesIsDebuggable() )
    {
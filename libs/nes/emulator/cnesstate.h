@@ -0,0 +1,249 @@
+#if !defined ( NES_STATE_H )
+#define NES_STATE_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Binary save-state stream.
+//
+// A save-state is a small header followed by a sequence of chunks.  Each
+// chunk is tagged with a four-character code and carries its own version
+// and length, so a loader can skip chunks it does not know and reject
+// chunks whose layout has changed without having to understand the rest
+// of the stream.  Data is stored in native byte order; save-states are
+// meant for snapshot/rewind within a build, not for interchange (the XML
+// export in the UI covers that).
+//
+// Header:
+//    uint32_t magic   ('NESS')
+//    uint16_t version (NES_STATE_VERSION)
+//    uint16_t count   (number of chunks)
+//    uint32_t size    (total bytes including header)
+// Chunk:
+//    uint32_t tag
+//    uint16_t version
+//    uint16_t reserved
+//    uint32_t length  (payload bytes)
+//    uint8_t  payload [ length ]
+
+#define NES_STATE_MAGIC   0x5353454E
+#define NES_STATE_VERSION 1
+
+#define NES_STATE_TAG(a,b,c,d) ((uint32_t)(a)|((uint32_t)(b)<<8)|((uint32_t)(c)<<16)|((uint32_t)(d)<<24))
+
+#define NES_STATE_HEADER_SIZE 12
+#define NES_STATE_CHUNK_HEADER_SIZE 12
+
+// Chunks and their current layout versions.  Bump a chunk's version
+// whenever what its owner writes into it changes.
+#define NES_STATE_CHUNK_NES    NES_STATE_TAG('N','E','S',' ')
+#define NES_STATE_CHUNK_CPU    NES_STATE_TAG('C','P','U',' ')
+#define NES_STATE_CHUNK_PPU    NES_STATE_TAG('P','P','U',' ')
+#define NES_STATE_CHUNK_APU    NES_STATE_TAG('A','P','U',' ')
+#define NES_STATE_CHUNK_ROM    NES_STATE_TAG('R','O','M',' ')
+#define NES_STATE_CHUNK_IO     NES_STATE_TAG('I','O',' ',' ')
+#define NES_STATE_CHUNK_MAPPER NES_STATE_TAG('M','A','P','R')
+#define NES_STATE_VERSION_NES    1
+#define NES_STATE_VERSION_CPU    1
+#define NES_STATE_VERSION_PPU    1
+#define NES_STATE_VERSION_APU    1
+#define NES_STATE_VERSION_ROM    2
+#define NES_STATE_VERSION_IO     1
+#define NES_STATE_VERSION_MAPPER 1
+
+// Bank pointers (CPU and PPU memory maps) are stored as the memory region
+// they point into plus an offset within that region.
+enum
+{
+   eStatePointer_Null = 0,
+   eStatePointer_PRGROM,
+   eStatePointer_CHR,
+   eStatePointer_SRAM,
+   eStatePointer_EXRAM,
+   eStatePointer_VRAM,
+   eStatePointer_CIRAM
+};
+#define NES_STATE_POINTER(region,offset) ( ((uint32_t)(region)<<24)|((offset)&0xFFFFFF) )
+#define NES_STATE_POINTER_REGION(value) ( (value)>>24 )
+#define NES_STATE_POINTER_OFFSET(value) ( (value)&0xFFFFFF )
+#define NES_STATE_POINTER_INVALID 0xFFFFFFFF
+
+// The writer can be run without a buffer to measure how big a save-state
+// will be.  If the buffer is too small the writer keeps counting but stops
+// storing, and OVERFLOWED() reports it.
+class CNESStateWriter
+{
+public:
+   CNESStateWriter ( uint8_t* buffer, uint32_t size )
+      : m_buffer(buffer),
+        m_size(size),
+        m_pos(NES_STATE_HEADER_SIZE),
+        m_chunk(0),
+        m_count(0)
+   {
+   }
+
+   void BeginChunk ( uint32_t tag, uint16_t version )
+   {
+      uint16_t reserved = 0;
+      uint32_t length = 0;
+
+      m_chunk = m_pos;
+      Put(tag);
+      Put(version);
+      Put(reserved);
+      Put(length);
+   }
+   void EndChunk ( void )
+   {
+      uint32_t length = m_pos-m_chunk-NES_STATE_CHUNK_HEADER_SIZE;
+
+      if ( m_chunk+NES_STATE_CHUNK_HEADER_SIZE <= m_size && m_buffer )
+      {
+         memcpy(m_buffer+m_chunk+8,&length,sizeof(length));
+      }
+      m_count++;
+   }
+
+   inline void Put ( const void* data, uint32_t length )
+   {
+      if ( m_buffer && (m_pos+length <= m_size) )
+      {
+         memcpy(m_buffer+m_pos,data,length);
+      }
+      m_pos += length;
+   }
+   template<typename T> inline void Put ( const T& value )
+   {
+      Put(&value,sizeof(T));
+   }
+
+   // Write the stream header.  Returns the total size of the save-state,
+   // or 0 if it did not fit in the buffer.
+   uint32_t Finish ( void )
+   {
+      uint32_t magic = NES_STATE_MAGIC;
+      uint16_t version = NES_STATE_VERSION;
+
+      if ( OVERFLOWED() || !m_buffer )
+      {
+         return 0;
+      }
+      memcpy(m_buffer,&magic,4);
+      memcpy(m_buffer+4,&version,2);
+      memcpy(m_buffer+6,&m_count,2);
+      memcpy(m_buffer+8,&m_pos,4);
+      return m_pos;
+   }
+
+   uint32_t SIZE ( void ) const { return m_pos; }
+   bool OVERFLOWED ( void ) const { return m_pos > m_size; }
+
+private:
+   uint8_t* m_buffer;
+   uint32_t m_size;
+   uint32_t m_pos;
+   uint32_t m_chunk;
+   uint16_t m_count;
+};
+
+class CNESStateReader
+{
+public:
+   CNESStateReader ( const uint8_t* buffer, uint32_t size )
+      : m_buffer(buffer),
+        m_size(size),
+        m_pos(0),
+        m_end(0)
+   {
+   }
+
+   // Check the stream header.  Must be called before FindChunk.
+   bool Begin ( void )
+   {
+      uint32_t magic;
+      uint16_t version;
+      uint32_t size;
+
+      if ( !m_buffer || (m_size < NES_STATE_HEADER_SIZE) )
+      {
+         return false;
+      }
+      memcpy(&magic,m_buffer,4);
+      memcpy(&version,m_buffer+4,2);
+      memcpy(&size,m_buffer+8,4);
+      if ( (magic != NES_STATE_MAGIC) || (version != NES_STATE_VERSION) || (size > m_size) )
+      {
+         return false;
+      }
+      m_size = size;
+      return true;
+   }
+
+   // Position the reader at the payload of the chunk with the passed tag.
+   // Fails if the chunk is missing, truncated, or of a different version.
+   bool FindChunk ( uint32_t tag, uint16_t version )
+   {
+      uint32_t pos = NES_STATE_HEADER_SIZE;
+
+      while ( pos+NES_STATE_CHUNK_HEADER_SIZE <= m_size )
+      {
+         uint32_t chunkTag;
+         uint16_t chunkVersion;
+         uint32_t length;
+
+         memcpy(&chunkTag,m_buffer+pos,4);
+         memcpy(&chunkVersion,m_buffer+pos+4,2);
+         memcpy(&length,m_buffer+pos+8,4);
+         pos += NES_STATE_CHUNK_HEADER_SIZE;
+         if ( length > m_size-pos )
+         {
+            return false;
+         }
+         if ( chunkTag == tag )
+         {
+            m_pos = pos;
+            m_end = pos+length;
+            return chunkVersion == version;
+         }
+         pos += length;
+      }
+      return false;
+   }
+
+   inline bool Get ( void* data, uint32_t length )
+   {
+      if ( m_pos+length > m_end )
+      {
+         return false;
+      }
+      memcpy(data,m_buffer+m_pos,length);
+      m_pos += length;
+      return true;
+   }
+   template<typename T> inline bool Get ( T& value )
+   {
+      return Get(&value,sizeof(T));
+   }
+
+   inline bool Skip ( uint32_t length )
+   {
+      if ( m_pos+length > m_end )
+      {
+         return false;
+      }
+      m_pos += length;
+      return true;
+   }
+
+   // Bytes left in the current chunk.
+   uint32_t REMAINING ( void ) const { return m_end-m_pos; }
+
+private:
+   const uint8_t* m_buffer;
+   uint32_t m_size;
+   uint32_t m_pos;
+   uint32_t m_end;
+};
+
+#endif // #if !defined ( NES_STATE_H )
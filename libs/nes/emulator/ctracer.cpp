@@ -15,233 +15,372 @@
 //    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "ctracer.h"
+#include "ctracestream.h"
+
+#include <string.h>
 
 CTracer::CTracer()
 {
    m_frame = 0;
 
    m_cursor = 0;
-   m_samples = 0;
-
-   m_cpuCursor = 0;
-   m_cpuSamples = 0;
-   m_ppuCursor = 0;
-   m_ppuSamples = 0;
+   m_generation = 0;
+   m_lastCPUSample = TRACER_NO_SAMPLE;
 
-   m_pSamples = new TracerInfo [ TRACER_DEFAULT_DEPTH ];
+   memset(&m_columns,0,sizeof(m_columns));
+   AllocateColumns ( TRACER_DEFAULT_DEPTH );
 
-   m_sampleBufferDepth = TRACER_DEFAULT_DEPTH;
+   m_pStream = NULL;
+   m_streamCursor = 0;
 }
 
 
 CTracer::~CTracer()
 {
-   delete m_pSamples;
+   StopStreaming();
+
+   FreeColumns();
+}
+
+bool CTracer::AllocateColumns ( uint32_t depth )
+{
+   m_columns.frame = new uint32_t [ depth ];
+   m_columns.cycle = new uint32_t [ depth ];
+   m_columns.addr = new uint16_t [ depth ];
+   m_columns.data = new uint8_t [ depth ];
+   m_columns.type = new int8_t [ depth ];
+   m_columns.source = new int8_t [ depth ];
+   m_columns.target = new int8_t [ depth ];
+   m_columns.flags = new uint8_t [ depth ];
+   m_columns.regs = new TracerRegs [ depth ];
+   m_columns.ea = new uint32_t [ depth ];
+   m_columns.opcode = new uint32_t [ depth ];
+
+   m_columns.mask = depth-1;
+
+   if ( !(m_columns.frame && m_columns.cycle && m_columns.addr && m_columns.data &&
+          m_columns.type && m_columns.source && m_columns.target && m_columns.flags &&
+          m_columns.regs && m_columns.ea && m_columns.opcode) )
+   {
+      return false;
+   }
+
+   return true;
+}
+
+void CTracer::FreeColumns ( void )
+{
+   delete [] m_columns.frame;
+   delete [] m_columns.cycle;
+   delete [] m_columns.addr;
+   delete [] m_columns.data;
+   delete [] m_columns.type;
+   delete [] m_columns.source;
+   delete [] m_columns.target;
+   delete [] m_columns.flags;
+   delete [] m_columns.regs;
+   delete [] m_columns.ea;
+   delete [] m_columns.opcode;
+
+   memset(&m_columns,0,sizeof(m_columns));
 }
 
 bool CTracer::ReallocateTracerMemory(int32_t newDepth)
 {
-   bool ok = true;
+   uint32_t depth = 1;
+   bool ok;
 
-   delete m_pSamples;
+   FlushStream();
 
-   m_pSamples = new TracerInfo [ newDepth ];
+   while ( depth < (uint32_t)newDepth )
+   {
+      depth <<= 1;
+   }
 
-   m_sampleBufferDepth = newDepth;
+   FreeColumns();
+   ok = AllocateColumns ( depth );
 
-   if ( !m_pSamples )
+   if ( depth < TRACE_STREAM_BLOCK*TRACE_STREAM_MIN_BLOCKS )
    {
-      ok = false;
+      StopStreaming();
    }
 
+   // Nothing from the old ring survives.
+   m_cursor = 0;
+   m_streamCursor = 0;
+   m_lastCPUSample = TRACER_NO_SAMPLE;
+   m_generation++;
+
    return ok;
 }
 
-TracerInfo* CTracer::AddSample(uint32_t cycle, int8_t type, int8_t source, int8_t target, uint16_t addr, uint8_t data)
+bool CTracer::StartStreaming ( const char* fileName )
 {
-   TracerInfo* pSample = m_pSamples + m_cursor;
-   TracerInfo* pTargetSample = NULL;
-   int8_t      overwrittenSource;
+   StopStreaming();
 
-   // Save overwritten sample's type to adjust
-   // sample counts later on...
-   overwrittenSource = pSample->source;
+   if ( GetDepth() < TRACE_STREAM_BLOCK*TRACE_STREAM_MIN_BLOCKS )
+   {
+      return false;
+   }
 
-   // Set frame from emulator.
-   pSample->frame = m_frame;
+   m_pStream = new CTraceStream();
+   if ( !m_pStream->Open(fileName) )
+   {
+      delete m_pStream;
+      m_pStream = NULL;
+      return false;
+   }
+   m_streamCursor = m_cursor;
 
-   pSample->cycle = cycle;
-   pSample->type = type;
-   pSample->source = source;
-   pSample->target = target;
-   pSample->addr = addr;
-   pSample->data = data;
-   *(pSample->disassemble+3) = 0xFF;
-   pSample->ea = 0xFFFFFFFF;
-   pSample->regsset = 0;
+   return true;
+}
 
-   m_cursor++;
-   m_cursor %= m_sampleBufferDepth;
+void CTracer::StopStreaming ( void )
+{
+   if ( m_pStream )
+   {
+      FlushStream();
+      delete m_pStream;
+      m_pStream = NULL;
+   }
+}
 
-   if ( source == eNESSource_PPU )
+void CTracer::StreamBlocks ( void )
+{
+   while ( m_cursor-m_streamCursor >= 2*TRACE_STREAM_BLOCK )
    {
-      pTargetSample = m_pSamples + m_ppuCursor;
-      pTargetSample->pPPUSample = pSample;
+      m_pStream->Push ( m_columns, ((uint32_t)m_streamCursor)&m_columns.mask, TRACE_STREAM_BLOCK );
+      m_streamCursor += TRACE_STREAM_BLOCK;
+   }
+}
 
-      m_ppuCursor++;
-      m_ppuCursor %= m_sampleBufferDepth;
+void CTracer::FlushStream ( void )
+{
+   uint32_t count;
 
-      if ( m_samples < m_sampleBufferDepth )
-      {
-         m_samples++;
-         m_ppuSamples++;
-      }
-      else
-      {
-         if ( m_ppuSamples < m_sampleBufferDepth )
-         {
-            m_ppuSamples++;
-         }
-
-         if ( overwrittenSource == eNESSource_PPU )
-         {
-            m_ppuSamples--;
-         }
-         else
-         {
-            m_cpuSamples--;
-         }
-      }
-   }
-   else
+   if ( !m_pStream )
    {
-      pTargetSample = m_pSamples + m_cpuCursor;
-      pTargetSample->pCPUSample = pSample;
-
-      m_cpuCursor++;
-      m_cpuCursor %= m_sampleBufferDepth;
+      return;
+   }
 
-      if ( m_samples < m_sampleBufferDepth )
-      {
-         m_samples++;
-         m_cpuSamples++;
-      }
-      else
-      {
-         if ( m_cpuSamples < m_sampleBufferDepth )
-         {
-            m_cpuSamples++;
-         }
-
-         if ( overwrittenSource == eNESSource_PPU )
-         {
-            m_ppuSamples--;
-         }
-         else
-         {
-            m_cpuSamples--;
-         }
-      }
+   while ( m_cursor != m_streamCursor )
+   {
+      count = ((m_cursor-m_streamCursor) < TRACE_STREAM_BLOCK)?(m_cursor-m_streamCursor):TRACE_STREAM_BLOCK;
+      m_pStream->Push ( m_columns, ((uint32_t)m_streamCursor)&m_columns.mask, count );
+      m_streamCursor += count;
    }
 
-   return pSample;
+   // The ring is about to be reused from elsewhere.
+   m_pStream->Drain();
 }
 
 void CTracer::ClearSampleBuffer(void)
 {
+   FlushStream();
+   m_streamCursor = 0;
+
    m_frame = 0;
 
    m_cursor = 0;
-   m_samples = 0;
-
-   m_cpuCursor = 0;
-   m_cpuSamples = 0;
-   m_ppuCursor = 0;
-   m_ppuSamples = 0;
+   m_lastCPUSample = TRACER_NO_SAMPLE;
+   m_generation++;
 }
 
-TracerInfo* CTracer::GetLastSample ( void )
+void CTracer::GetSample ( uint32_t slot, TracerInfo* pSample ) const
 {
-   int getsample = m_cursor-1;
+   uint8_t flags;
+
+   slot &= m_columns.mask;
+   flags = m_columns.flags[slot];
 
-   if ( getsample < 0 )
+   pSample->frame = m_columns.frame[slot];
+   pSample->cycle = m_columns.cycle[slot];
+   pSample->addr = m_columns.addr[slot];
+   pSample->data = m_columns.data[slot];
+   pSample->type = m_columns.type[slot];
+   pSample->source = m_columns.source[slot];
+   pSample->target = m_columns.target[slot];
+
+   if ( flags&TRACER_SAMPLE_REGS )
+   {
+      pSample->a = m_columns.regs[slot].a;
+      pSample->x = m_columns.regs[slot].x;
+      pSample->y = m_columns.regs[slot].y;
+      pSample->sp = m_columns.regs[slot].sp;
+      pSample->f = m_columns.regs[slot].f;
+      pSample->regsset = 1;
+   }
+   else
    {
-      getsample = m_sampleBufferDepth-1;
+      pSample->a = 0;
+      pSample->x = 0;
+      pSample->y = 0;
+      pSample->sp = 0;
+      pSample->f = 0;
+      pSample->regsset = 0;
    }
 
-   return m_pSamples+getsample;
+   pSample->ea = (flags&TRACER_SAMPLE_EA) ? m_columns.ea[slot] : 0xFFFFFFFF;
+
+   if ( flags&TRACER_SAMPLE_DISASSEMBLY )
+   {
+      pSample->disassemble[0] = m_columns.opcode[slot];
+      pSample->disassemble[1] = m_columns.opcode[slot]>>8;
+      pSample->disassemble[2] = m_columns.opcode[slot]>>16;
+      pSample->disassemble[3] = 0x00;
+   }
+   else
+   {
+      memset(pSample->disassemble,0,3);
+      pSample->disassemble[3] = 0xFF;
+   }
 }
 
-TracerInfo* CTracer::GetLastCPUSample ( void )
+CTracerView::CTracerView ( const CTracer* pTracer )
 {
-   int getsample = m_cpuCursor-1;
+   m_pTracer = pTracer;
+   ClearFilter ( &m_filter );
+   Reset ();
+}
 
-   if ( getsample < 0 )
-   {
-      getsample = m_sampleBufferDepth-1;
-   }
+void CTracerView::ClearFilter ( TracerFilter* pFilter )
+{
+   pFilter->sourceMask = 0xFFFFFFFF;
+   pFilter->typeMask = 0xFFFFFFFF;
+   pFilter->firstAddr = 0x0000;
+   pFilter->lastAddr = 0xFFFF;
+}
 
-   return (m_pSamples+getsample)->pCPUSample;
+bool CTracerView::IsClear ( const TracerFilter& filter )
+{
+   return ((filter.sourceMask&0xF) == 0xF) &&
+          (filter.typeMask == 0xFFFFFFFF) &&
+          (filter.firstAddr == 0x0000) &&
+          (filter.lastAddr == 0xFFFF);
 }
 
-TracerInfo* CTracer::GetSample ( uint32_t sample )
+void CTracerView::SetFilter ( const TracerFilter& filter )
 {
-   int32_t getsample = m_cursor-(sample+1);
+   m_filter = filter;
+   Reset ();
+}
 
-   if ( getsample < 0 )
-   {
-      getsample = m_sampleBufferDepth+getsample;
-   }
+void CTracerView::Reset ( void )
+{
+   m_all = IsClear ( m_filter );
+   m_generation = m_pTracer->GetGeneration();
+   m_rows.clear();
+   m_first = 0;
+   m_indexed = 0;
+}
 
-   return m_pSamples+getsample;
+// The filter test, written without branches so the compiler is free to
+// run it over several samples at once.
+static inline uint32_t matches ( const TracerColumns& ring, uint32_t slot, uint32_t sourceMask, uint32_t typeMask,
+                                 uint16_t firstAddr, uint16_t addrSpan )
+{
+   return ((sourceMask>>(ring.source[slot]&3))&
+           (typeMask>>(ring.type[slot]&31))&
+           (((uint16_t)(ring.addr[slot]-firstAddr)) <= addrSpan))&1;
 }
 
-TracerInfo* CTracer::GetCPUSample ( uint32_t sample )
+bool CTracerView::Update ( uint32_t maxSamples )
 {
-   int32_t getsample = m_cpuCursor-(sample+1);
+   const TracerColumns& ring = m_pTracer->GetColumns();
+   uint64_t cursor = m_pTracer->GetCursor();
+   uint32_t depth = m_pTracer->GetDepth();
+   uint16_t addrSpan = m_filter.lastAddr-m_filter.firstAddr;
+   uint32_t count;
+   uint32_t rows;
+   uint32_t seq;
+   uint32_t slot;
+   uint32_t idx;
+
+   if ( m_all )
+   {
+      return false;
+   }
 
-   if ( getsample < 0 )
+   if ( (m_generation != m_pTracer->GetGeneration()) || (cursor < m_indexed) )
    {
-      getsample = m_sampleBufferDepth+getsample;
+      Reset ();
    }
 
-   return (m_pSamples+getsample)->pCPUSample;
-}
+   // Samples the ring has already dropped are not worth indexing.
+   if ( cursor-m_indexed > depth )
+   {
+      m_rows.clear();
+      m_first = 0;
+      m_indexed = cursor-depth;
+   }
 
-TracerInfo* CTracer::GetPPUSample ( uint32_t sample )
-{
-   int32_t getsample = m_ppuCursor-(sample+1);
+   count = ((cursor-m_indexed) < maxSamples) ? (cursor-m_indexed) : maxSamples;
+
+   // Forget rows that have been overwritten in the ring, and give their
+   // room back once they are the bulk of the index.
+   seq = (uint32_t)(m_indexed+count);
+   while ( (m_first < m_rows.size()) && ((uint32_t)(seq-m_rows[m_first]) > depth) )
+   {
+      m_first++;
+   }
+   if ( m_first > (m_rows.size()/2) )
+   {
+      m_rows.erase(m_rows.begin(),m_rows.begin()+m_first);
+      m_first = 0;
+   }
 
-   if ( getsample < 0 )
+   // Every sample gets a slot at the end of the index; only the ones that
+   // match move the end along.
+   rows = m_rows.size();
+   m_rows.resize(rows+count);
+
+   uint32_t* pRows = m_rows.data();
+   seq = (uint32_t)m_indexed;
+   for ( idx = 0; idx < count; idx++, seq++ )
    {
-      getsample = m_sampleBufferDepth+getsample;
+      slot = seq&ring.mask;
+      pRows[rows] = seq;
+      rows += matches(ring,slot,m_filter.sourceMask,m_filter.typeMask,m_filter.firstAddr,addrSpan);
    }
+   m_rows.resize(rows);
+
+   m_indexed += count;
 
-   return (m_pSamples+getsample)->pPPUSample;
+   return m_indexed != cursor;
 }
 
-void CTracer::SetDisassembly ( TracerInfo* pS, uint8_t* szD )
+uint32_t CTracerView::GetNumRows ( void ) const
 {
-   if ( pS )
+   if ( m_all )
    {
-      (*((pS->disassemble)+0)) = (*szD);
-      szD++;
-      (*((pS->disassemble)+1)) = (*szD);
-      szD++;
-      (*((pS->disassemble)+2)) = (*szD);
-      (*((pS->disassemble)+3)) = 0x00;
+      return m_pTracer->GetNumSamples();
    }
+   return m_rows.size()-m_first;
 }
 
-void CTracer::SetRegisters ( TracerInfo* pS, uint8_t a, uint8_t x, uint8_t y, uint8_t sp, uint8_t f )
+uint32_t CTracerView::GetRowSlot ( uint32_t row ) const
 {
-   if ( pS )
+   if ( m_all )
    {
-      pS->a = a;
-      pS->x = x;
-      pS->y = y;
-      pS->sp = sp;
-      pS->f = f;
-      pS->regsset = 1;
+      return m_pTracer->GetSampleSlot(row);
    }
+   return m_rows[m_rows.size()-(row+1)]&m_pTracer->GetColumns().mask;
+}
+
+int32_t CTracerView::Find ( uint32_t startRow, const TracerFilter& filter, bool backwards ) const
+{
+   const TracerColumns& ring = m_pTracer->GetColumns();
+   uint16_t addrSpan = filter.lastAddr-filter.firstAddr;
+   uint32_t rows = GetNumRows();
+   uint32_t row;
+
+   for ( row = startRow; row < rows; backwards ? row-- : row++ )
+   {
+      if ( matches(ring,GetRowSlot(row),filter.sourceMask,filter.typeMask,filter.firstAddr,addrSpan) )
+      {
+         return row;
+      }
+   }
+
+   return -1;
 }
@@ -2,9 +2,17 @@
 #define TRACER_H
 
 #include "nes_emulator_core.h"
+#include "cnesperf.h"
+
+#include <vector>
 
 #define TRACER_DEFAULT_DEPTH 262144
 
+// Samples per block handed to a trace file stream (see ctracestream.h).
+#define TRACE_STREAM_BLOCK   16384
+
+class CTraceStream;
+
 enum
 {
    eTracer_Unknown = 0,
@@ -72,6 +80,10 @@ enum
    eTracerCol_MAX
 };
 
+// One sample of the tracer as a row.  The tracer itself stores samples
+// as columns (see TracerColumns); GetSample assembles a row from them.
+// ea is 0xFFFFFFFF, regsset is 0 and disassemble[3] is non-zero when the
+// sample has no effective address, registers or disassembly.
 #pragma pack(1)
 typedef struct _TracerInfo
 {
@@ -90,93 +102,290 @@ typedef struct _TracerInfo
    int8_t   source;
    int8_t   target;
    int8_t   regsset;
-   struct _TracerInfo* pCPUSample;
-   struct _TracerInfo* pPPUSample;
 } TracerInfo;
+
+typedef struct _TracerRegs
+{
+   uint8_t a;
+   uint8_t x;
+   uint8_t y;
+   uint8_t sp;
+   uint8_t f;
+} TracerRegs;
 #pragma pack()
 
+// Which of a sample's optional columns hold something.
+#define TRACER_SAMPLE_REGS        0x01
+#define TRACER_SAMPLE_DISASSEMBLY 0x02
+#define TRACER_SAMPLE_EA          0x04
+
+// Returned instead of a slot when there is no sample.
+#define TRACER_NO_SAMPLE          0xFFFFFFFF
+
+// The tracer's sample ring, one array per field.  The ring holds mask+1
+// samples, a power of two; the sample in slot n is at index n of every
+// column.  regs, ea and opcode are only meaningful if the matching
+// TRACER_SAMPLE_* bit is set in flags.  opcode holds the instruction's
+// bytes in its low three bytes, first byte lowest.
+typedef struct _TracerColumns
+{
+   uint32_t    mask;
+   uint32_t*   frame;
+   uint32_t*   cycle;
+   uint16_t*   addr;
+   uint8_t*    data;
+   int8_t*     type;
+   int8_t*     source;
+   int8_t*     target;
+   uint8_t*    flags;
+   TracerRegs* regs;
+   uint32_t*   ea;
+   uint32_t*   opcode;
+} TracerColumns;
+
+// Samples are referred to by their slot in the ring.  A slot is reused
+// once the ring wraps, so slots are only good for as long as it takes
+// the emulator to add another ring's worth of samples.
 class CTracer
 {
 public:
    void ClearSampleBuffer ( void );
-   inline TracerInfo* AddRESET ( void )
+   inline uint32_t AddRESET ( void )
    {
       return AddSample ( 0, eTracer_RESET, eNESSource_CPU, 0, 0, 0 );
    }
-   inline TracerInfo* AddNMI ( uint32_t cycle, int8_t source )
+   inline uint32_t AddNMI ( uint32_t cycle, int8_t source )
    {
       return AddSample ( cycle, eTracer_NMI, source, 0, 0, 0 );
    }
-   inline TracerInfo* AddIRQ ( uint32_t cycle, int8_t source )
+   inline uint32_t AddIRQ ( uint32_t cycle, int8_t source )
    {
       return AddSample ( cycle, eTracer_IRQ, source, 0, 0, 0 );
    }
-   inline TracerInfo* AddIRQRelease ( uint32_t cycle, int8_t source )
+   inline uint32_t AddIRQRelease ( uint32_t cycle, int8_t source )
    {
       return AddSample ( cycle, eTracer_IRQRelease, source, 0, 0, 0 );
    }
-   inline TracerInfo* AddStolenCycle ( uint32_t cycle, int8_t source )
+   inline uint32_t AddStolenCycle ( uint32_t cycle, int8_t source )
    {
       return AddSample ( cycle, eTracer_StolenCycle, source, 0, 0, 0 );
    }
-   inline TracerInfo* AddGarbageFetch( uint32_t cycle, int8_t target, uint16_t addr )
+   inline uint32_t AddGarbageFetch( uint32_t cycle, int8_t target, uint16_t addr )
    {
       return AddSample ( cycle, eTracer_GarbageRead, eNESSource_PPU, target, addr, 0 );
    }
-   TracerInfo* AddSample ( uint32_t cycle, int8_t type, int8_t source, int8_t target, uint16_t addr, uint8_t data );
+   inline uint32_t AddSample ( uint32_t cycle, int8_t type, int8_t source, int8_t target, uint16_t addr, uint8_t data )
+   {
+      uint32_t slot = ((uint32_t)m_cursor)&m_columns.mask;
+
+      NESPERFSCOPE ( eNESPerf_Tracer );
+
+      m_columns.frame[slot] = m_frame;
+      m_columns.cycle[slot] = cycle;
+      m_columns.type[slot] = type;
+      m_columns.source[slot] = source;
+      m_columns.target[slot] = target;
+      m_columns.addr[slot] = addr;
+      m_columns.data[slot] = data;
+      m_columns.flags[slot] = 0;
+
+      // Everything that is not the PPU counts as the CPU.
+      m_lastCPUSample = (source == eNESSource_PPU) ? m_lastCPUSample : slot;
+
+      m_cursor++;
+      if ( m_pStream && !(((uint32_t)m_cursor)&(TRACE_STREAM_BLOCK-1)) )
+      {
+         StreamBlocks ();
+      }
+
+      return slot;
+   }
+
+   // Depth is rounded up to a power of two.
    bool ReallocateTracerMemory ( int32_t newDepth );
+   uint32_t GetDepth ( void ) const
+   {
+      return m_columns.mask+1;
+   }
    unsigned int GetNumSamples ( void ) const
    {
-      return m_samples;
+      return (m_cursor < GetDepth()) ? m_cursor : GetDepth();
    }
-   TracerInfo* GetSample ( uint32_t sample );
-   TracerInfo* GetCPUSample ( uint32_t sample );
-   TracerInfo* GetPPUSample ( uint32_t sample );
-   TracerInfo* GetLastSample ( void );
-   TracerInfo* GetLastCPUSample ( void );
-   void SetDisassembly ( TracerInfo* pS, uint8_t* szD );
-   void SetRegisters ( TracerInfo* pS, uint8_t a, uint8_t x, uint8_t y, uint8_t sp, uint8_t f );
-   void SetEffectiveAddress ( TracerInfo* pS, uint32_t ea )
+   // Total samples added since the buffer was last cleared.  The newest
+   // one is in slot (GetCursor()-1)&mask.
+   uint64_t GetCursor ( void ) const
    {
-      if ( pS )
-      {
-         pS->ea = ea;
-      }
+      return m_cursor;
+   }
+   // Bumped every time the buffer is cleared or reallocated.
+   uint32_t GetGeneration ( void ) const
+   {
+      return m_generation;
+   }
+   const TracerColumns& GetColumns ( void ) const
+   {
+      return m_columns;
    }
 
-   CTracer();
-   ~CTracer();
+   // Slot of the sample'th most recent sample.
+   uint32_t GetSampleSlot ( uint32_t sample ) const
+   {
+      return ((uint32_t)m_cursor-(sample+1))&m_columns.mask;
+   }
+   void GetSample ( uint32_t slot, TracerInfo* pSample ) const;
+   uint32_t GetLastCPUSample ( void ) const
+   {
+      return m_lastCPUSample;
+   }
 
-   unsigned int GetNumCPUSamples() const
+   void SetDisassembly ( uint32_t slot, uint8_t* szD )
    {
-      return m_cpuSamples;
+      if ( slot != TRACER_NO_SAMPLE )
+      {
+         slot &= m_columns.mask;
+         m_columns.opcode[slot] = szD[0]|(szD[1]<<8)|(szD[2]<<16);
+         m_columns.flags[slot] |= TRACER_SAMPLE_DISASSEMBLY;
+      }
    }
-   unsigned int GetNumPPUSamples() const
+   void SetRegisters ( uint32_t slot, uint8_t a, uint8_t x, uint8_t y, uint8_t sp, uint8_t f )
    {
-      return m_ppuSamples;
+      if ( slot != TRACER_NO_SAMPLE )
+      {
+         slot &= m_columns.mask;
+         m_columns.regs[slot].a = a;
+         m_columns.regs[slot].x = x;
+         m_columns.regs[slot].y = y;
+         m_columns.regs[slot].sp = sp;
+         m_columns.regs[slot].f = f;
+         m_columns.flags[slot] |= TRACER_SAMPLE_REGS;
+      }
+   }
+   void SetEffectiveAddress ( uint32_t slot, uint32_t ea )
+   {
+      if ( slot != TRACER_NO_SAMPLE )
+      {
+         slot &= m_columns.mask;
+         m_columns.ea[slot] = ea;
+         m_columns.flags[slot] |= TRACER_SAMPLE_EA;
+      }
+   }
+   void SetTarget ( uint32_t slot, int8_t target )
+   {
+      if ( slot != TRACER_NO_SAMPLE )
+      {
+         m_columns.target[slot&m_columns.mask] = target;
+      }
    }
 
+   CTracer();
+   ~CTracer();
+
    void SetFrame(uint32_t frame)
    {
       m_frame = frame;
    }
 
+   // Streaming copies every sample recorded from now on to a trace file
+   // (see ctracestream.h) as well as keeping it in the ring.  Needs a ring
+   // of at least TRACE_STREAM_MIN_BLOCKS stream blocks.
+   bool StartStreaming ( const char* fileName );
+   void StopStreaming ( void );
+   bool IsStreaming ( void ) const
+   {
+      return m_pStream != NULL;
+   }
+
 protected:
+   bool AllocateColumns ( uint32_t depth );
+   void FreeColumns ( void );
+   void StreamBlocks ( void );
+   void FlushStream ( void );
+
    // Frame # is set by emulator so it doesn't have to be passed in all the time...
-   uint32_t    m_frame;
+   uint32_t      m_frame;
 
-   uint32_t    m_cursor;
-   uint32_t    m_samples;
-   uint32_t    m_sampleBufferDepth;
+   uint64_t      m_cursor;
+   uint32_t      m_generation;
+   uint32_t      m_lastCPUSample;
 
-   uint32_t    m_cpuCursor;
-   uint32_t    m_cpuSamples;
-   uint32_t    m_ppuCursor;
-   uint32_t    m_ppuSamples;
+   TracerColumns m_columns;
 
-   TracerInfo* m_pSamples;
+   // Samples from m_streamCursor up to m_cursor are not yet streamed.
+   // Whole blocks go out once they are a block behind m_cursor, because
+   // the CPU fills in disassembly and registers after adding a sample.
+   CTraceStream* m_pStream;
+   uint64_t      m_streamCursor;
+};
+
+// What a CTracerView shows or searches for.  The masks have a bit per
+// source (eNESSource_*) and per type (eTracer_*); the address range is
+// inclusive.
+typedef struct _TracerFilter
+{
+   uint32_t sourceMask;
+   uint32_t typeMask;
+   uint16_t firstAddr;
+   uint16_t lastAddr;
+} TracerFilter;
+
+// Samples indexed by each CTracerView::Update call.
+#define TRACER_VIEW_BATCH 262144
+
+// A filtered list of the samples in a tracer's ring, for the Execution
+// Inspector.  Update indexes the samples added since the last call, so
+// keeping the view current costs only the new samples however many rows
+// it has.  Like the tracer's own sample numbers, row 0 is the most recent
+// matching sample.  A view that lets everything through keeps no index.
+class CTracerView
+{
+public:
+   CTracerView ( const CTracer* pTracer );
+
+   static void ClearFilter ( TracerFilter* pFilter );
+   static bool IsClear ( const TracerFilter& filter );
+
+   // Changing the filter starts the index over.
+   void SetFilter ( const TracerFilter& filter );
+   const TracerFilter& GetFilter ( void ) const
+   {
+      return m_filter;
+   }
+
+   // Index at most maxSamples of the samples added since the last call,
+   // oldest first.  Returns true if there are more to index.
+   bool Update ( uint32_t maxSamples = TRACER_VIEW_BATCH );
+
+   uint32_t GetNumRows ( void ) const;
+   // Slot of the sample shown in the row.
+   uint32_t GetRowSlot ( uint32_t row ) const;
+
+   // First row from startRow on, going towards older samples, or towards
+   // newer ones if backwards is set, whose sample matches the filter.
+   // Returns -1 if there is none.
+   int32_t Find ( uint32_t startRow, const TracerFilter& filter, bool backwards = false ) const;
+
+protected:
+   void Reset ( void );
+
+   const CTracer*        m_pTracer;
+   TracerFilter          m_filter;
+   bool                  m_all;
+   uint32_t              m_generation;
+
+   // Low 32 bits of the tracer cursor of every indexed sample, oldest
+   // first.  Rows before m_first have been overwritten in the ring.
+   std::vector<uint32_t> m_rows;
+   uint32_t              m_first;
+   uint64_t              m_indexed;
 };
 
 CTracer* nesGetExecutionTracerDatabase ( void );
 
+// Stream the execution tracer of the current machine to a trace file.  Only
+// debuggable runs add samples to the tracer.  Read the file back with
+// CTraceFile (ctracestream.h) or the nes-trace-query tool.
+bool nesStartTraceStream ( const char* fileName );
+void nesStopTraceStream ( void );
+bool nesIsTraceStreaming ( void );
+
 #endif
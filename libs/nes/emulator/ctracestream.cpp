@@ -0,0 +1,1125 @@
+//    NESICIDE - an IDE for the 8-bit NES.
+//    Copyright (C) 2009  Christopher S. Pow
+
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "ctracestream.h"
+
+#include <string.h>
+#include <chrono>
+
+// Chunk: the samples split into columns, each column LZ-packed on its own
+// (or stored if it does not pack), preceded by a TraceColumn per column.
+//    uint8_t event [ samples ]       (index into the event table)
+//    uint8_t data [ samples ]
+//    varint frame delta              (TRACE_FLAG_FRAME samples only)
+//    varint cycle delta              (against the source's last cycle delta)
+//    varint address delta            (against the last address of the same type, source and target)
+//    varint effective address        (TRACE_FLAG_EA samples only)
+//    uint8_t a, x, y, sp, f          (TRACE_FLAG_REGS samples only)
+//    uint8_t disassembly [ 3 ]       (TRACE_FLAG_DISASM samples only)
+//    uint8_t type, target, flags     (event table)
+//    uint8_t type, target, flags     (TRACE_EVENT_ESCAPE samples only)
+// Deltas are zigzag encoded.  A chunk only holds a few dozen different
+// combinations of type, target and flags (TRACE_FLAG_*, with the source
+// in bits 4-5), so those are numbered in order of appearance; should a
+// chunk run out of numbers the rest are escaped.
+enum
+{
+   eColumn_Event = 0,
+   eColumn_Data,
+   eColumn_Frame,
+   eColumn_Cycle,
+   eColumn_Addr,
+   eColumn_EA,
+   eColumn_Regs,
+   eColumn_Disasm,
+   eColumn_Events,
+   eColumn_Escape,
+   eColumn_MAX
+};
+
+#pragma pack(1)
+typedef struct _TraceColumn
+{
+   uint32_t rawSize;
+   uint32_t packedSize;   // 0 if stored
+} TraceColumn;
+#pragma pack()
+
+// Worst case bytes per sample in each column.
+static const uint32_t columnBytes [ eColumn_MAX ] = { 1, 1, 5, 5, 3, 5, 5, 3, 3, 3 };
+
+#define TRACE_MAX_SAMPLE_BYTES 34
+
+#define TRACE_EVENT_ESCAPE 0xFF
+#define TRACE_EVENT_KEYS   (1<<15)
+
+// Sample flags.
+#define TRACE_FLAG_REGS   0x01
+#define TRACE_FLAG_DISASM 0x02
+#define TRACE_FLAG_EA     0x04
+#define TRACE_FLAG_FRAME  0x08
+#define TRACE_FLAG_SOURCE 4
+
+// Address deltas are kept per type, source and target.
+#define TRACE_ADDR_KEYS   (32*4*16)
+
+// LZ pass over a column.  A packed column is a sequence of
+//    uint8_t token        (literal length<<4 | match length-LZ_MIN_MATCH)
+//    uint8_t 255...       (length extension when a nibble is 15)
+//    uint8_t literals [ literal length ]
+//    uint16_t offset      (back from the current position)
+//    uint8_t 255...       (match length extension)
+// where the last sequence stops after its literals.
+#define LZ_HASH_BITS  12
+#define LZ_MIN_MATCH  4
+#define LZ_MAX_OFFSET 0xFFFF
+
+static inline uint8_t* putVarint ( uint8_t* out, uint32_t value )
+{
+   while ( value >= 0x80 )
+   {
+      *out++ = (value&0x7F)|0x80;
+      value >>= 7;
+   }
+   *out++ = value;
+   return out;
+}
+
+static inline const uint8_t* getVarint ( const uint8_t* in, const uint8_t* end, uint32_t* value )
+{
+   uint32_t shift = 0;
+
+   (*value) = 0;
+   while ( (in < end) && (shift < 32) )
+   {
+      (*value) |= ((*in)&0x7F)<<shift;
+      if ( !((*in++)&0x80) )
+      {
+         return in;
+      }
+      shift += 7;
+   }
+   return NULL;
+}
+
+static inline uint32_t zigzag ( int32_t value )
+{
+   return (((uint32_t)value)<<1)^((uint32_t)(value>>31));
+}
+
+static inline int32_t unzigzag ( uint32_t value )
+{
+   return (int32_t)(value>>1)^(-(int32_t)(value&1));
+}
+
+// Split count samples of the ring starting at slot first into columns, filling
+// in the chunk header's summary as it goes.  cpuCycle carries the CPU clock
+// from one chunk to the next.  column [ eColumn_Event ] needs room for
+// count*TRACE_MAX_SAMPLE_BYTES bytes; the others are placed after it.
+static void encodeBlock ( const TracerColumns& ring, uint32_t first, uint32_t count,
+                          TraceChunkInfo* pInfo, uint32_t* cpuCycle, uint8_t** column, uint32_t* size )
+{
+   uint32_t prevCycle [ 4 ] = { 0, 0, 0, 0 };
+   uint32_t prevDelta [ 4 ] = { 0, 0, 0, 0 };
+   uint16_t prevAddr [ TRACE_ADDR_KEYS ];
+   uint32_t prevFrame = 0;
+   uint32_t pos = first;
+   uint32_t typeMask = 0;
+   uint32_t sourceMask = 0;
+   uint64_t addrPages = 0;
+   uint32_t idx;
+   uint32_t slot;
+   uint32_t key;
+   uint32_t events = 0;
+   uint32_t delta;
+   uint8_t  code [ TRACE_EVENT_KEYS ];
+   uint8_t  flags;
+   uint32_t frame;
+   uint32_t cycle;
+   uint16_t addr;
+   int8_t   type;
+   int8_t   target;
+   uint8_t  sampleFlags;
+
+   memset(prevAddr,0,sizeof(prevAddr));
+   memset(code,0,sizeof(code));
+
+   for ( idx = 1; idx < eColumn_MAX; idx++ )
+   {
+      column[idx] = column[idx-1]+(columnBytes[idx-1]*count);
+   }
+
+   // Locals rather than column[] so they stay in registers.
+   uint8_t* pEvent = column[eColumn_Event];
+   uint8_t* pData = column[eColumn_Data];
+   uint8_t* pFrame = column[eColumn_Frame];
+   uint8_t* pCycle = column[eColumn_Cycle];
+   uint8_t* pAddr = column[eColumn_Addr];
+   uint8_t* pEA = column[eColumn_EA];
+   uint8_t* pRegs = column[eColumn_Regs];
+   uint8_t* pDisasm = column[eColumn_Disasm];
+   uint8_t* pEvents = column[eColumn_Events];
+   uint8_t* pEscape = column[eColumn_Escape];
+
+   pInfo->firstFrame = ring.frame[first];
+   pInfo->lastFrame = ring.frame[first];
+   pInfo->firstCycle = (*cpuCycle);
+
+   for ( idx = 0; idx < count; idx++ )
+   {
+      frame = ring.frame[pos];
+      cycle = ring.cycle[pos];
+      addr = ring.addr[pos];
+      type = ring.type[pos];
+      target = ring.target[pos];
+      sampleFlags = ring.flags[pos];
+
+      slot = ring.source[pos]&3;
+      flags = slot<<TRACE_FLAG_SOURCE;
+
+      // The first sample always carries its frame.
+      if ( (frame != prevFrame) || !idx )
+      {
+         pFrame = putVarint(pFrame,zigzag(frame-prevFrame));
+         flags |= TRACE_FLAG_FRAME;
+         prevFrame = frame;
+         if ( prevFrame < pInfo->firstFrame )
+         {
+            pInfo->firstFrame = prevFrame;
+         }
+         if ( prevFrame > pInfo->lastFrame )
+         {
+            pInfo->lastFrame = prevFrame;
+         }
+      }
+
+      delta = cycle-prevCycle[slot];
+      pCycle = putVarint(pCycle,zigzag(delta-prevDelta[slot]));
+      prevCycle[slot] = cycle;
+      prevDelta[slot] = delta;
+      key = ((type&31)<<6)|(slot<<4)|(target&15);
+      pAddr = putVarint(pAddr,zigzag((int16_t)(addr-prevAddr[key])));
+      prevAddr[key] = addr;
+
+      if ( sampleFlags&TRACER_SAMPLE_EA )
+      {
+         pEA = putVarint(pEA,ring.ea[pos]);
+         flags |= TRACE_FLAG_EA;
+      }
+      if ( sampleFlags&TRACER_SAMPLE_REGS )
+      {
+         memcpy(pRegs,ring.regs+pos,5);
+         pRegs += 5;
+         flags |= TRACE_FLAG_REGS;
+      }
+      if ( sampleFlags&TRACER_SAMPLE_DISASSEMBLY )
+      {
+         pDisasm[0] = ring.opcode[pos];
+         pDisasm[1] = ring.opcode[pos]>>8;
+         pDisasm[2] = ring.opcode[pos]>>16;
+         pDisasm += 3;
+         flags |= TRACE_FLAG_DISASM;
+      }
+
+      // Every type and target the tracer uses fits the table's key;
+      // anything else is escaped.  Table entries are numbered from 1.
+      key = ((uint8_t)type)|(((uint8_t)target)<<5)|(flags<<9);
+      if ( (((uint8_t)type) < 32) && (((uint8_t)target) < 16) &&
+           (code[key] || (events < TRACE_EVENT_ESCAPE)) )
+      {
+         if ( !code[key] )
+         {
+            pEvents[(events*3)+0] = type;
+            pEvents[(events*3)+1] = target;
+            pEvents[(events*3)+2] = flags;
+            code[key] = ++events;
+         }
+         *pEvent++ = code[key]-1;
+      }
+      else
+      {
+         *pEvent++ = TRACE_EVENT_ESCAPE;
+         pEscape[0] = type;
+         pEscape[1] = target;
+         pEscape[2] = flags;
+         pEscape += 3;
+      }
+      *pData++ = ring.data[pos];
+
+      if ( slot == eNESSource_CPU )
+      {
+         if ( !idx )
+         {
+            pInfo->firstCycle = cycle;
+         }
+         (*cpuCycle) = cycle;
+      }
+      typeMask |= 1<<(type&31);
+      sourceMask |= 1<<slot;
+      addrPages |= 1ULL<<(addr>>UPSHIFT_1KB);
+
+      pos = (pos+1)&ring.mask;
+   }
+   pInfo->lastCycle = (*cpuCycle);
+   pInfo->typeMask = typeMask;
+   pInfo->sourceMask = sourceMask;
+   pInfo->addrPages = addrPages;
+
+   size[eColumn_Event] = pEvent-column[eColumn_Event];
+   size[eColumn_Data] = pData-column[eColumn_Data];
+   size[eColumn_Frame] = pFrame-column[eColumn_Frame];
+   size[eColumn_Cycle] = pCycle-column[eColumn_Cycle];
+   size[eColumn_Addr] = pAddr-column[eColumn_Addr];
+   size[eColumn_EA] = pEA-column[eColumn_EA];
+   size[eColumn_Regs] = pRegs-column[eColumn_Regs];
+   size[eColumn_Disasm] = pDisasm-column[eColumn_Disasm];
+   size[eColumn_Events] = events*3;
+   size[eColumn_Escape] = pEscape-column[eColumn_Escape];
+}
+
+static bool decodeBlock ( const uint8_t** column, const uint32_t* size, TracerInfo* pSamples, uint32_t count )
+{
+   const uint8_t* end [ eColumn_MAX ];
+   const uint8_t* event;
+   uint32_t prevCycle [ 4 ] = { 0, 0, 0, 0 };
+   uint32_t prevDelta [ 4 ] = { 0, 0, 0, 0 };
+   uint16_t prevAddr [ TRACE_ADDR_KEYS ];
+   uint32_t prevFrame = 0;
+   uint32_t value;
+   uint32_t idx;
+   uint32_t slot;
+   uint32_t key;
+   uint8_t  flags;
+
+   if ( (size[eColumn_Event] != count) || (size[eColumn_Data] != count) ||
+        (size[eColumn_Events]%3) )
+   {
+      return false;
+   }
+   for ( idx = 0; idx < eColumn_MAX; idx++ )
+   {
+      end[idx] = column[idx]+size[idx];
+   }
+
+   memset(pSamples,0,count*sizeof(TracerInfo));
+   memset(prevAddr,0,sizeof(prevAddr));
+
+   for ( idx = 0; idx < count; idx++ )
+   {
+      TracerInfo* pSample = pSamples+idx;
+
+      if ( column[eColumn_Event][idx] != TRACE_EVENT_ESCAPE )
+      {
+         value = column[eColumn_Event][idx]*3;
+         if ( value >= size[eColumn_Events] )
+         {
+            return false;
+         }
+         event = column[eColumn_Events]+value;
+      }
+      else
+      {
+         if ( end[eColumn_Escape]-column[eColumn_Escape] < 3 )
+         {
+            return false;
+         }
+         event = column[eColumn_Escape];
+         column[eColumn_Escape] += 3;
+      }
+      pSample->type = event[0];
+      pSample->target = event[1];
+      flags = event[2];
+      pSample->data = column[eColumn_Data][idx];
+      slot = (flags>>TRACE_FLAG_SOURCE)&3;
+      pSample->source = slot;
+
+      if ( flags&TRACE_FLAG_FRAME )
+      {
+         if ( !(column[eColumn_Frame] = getVarint(column[eColumn_Frame],end[eColumn_Frame],&value)) )
+         {
+            return false;
+         }
+         prevFrame += unzigzag(value);
+      }
+      pSample->frame = prevFrame;
+
+      if ( !(column[eColumn_Cycle] = getVarint(column[eColumn_Cycle],end[eColumn_Cycle],&value)) )
+      {
+         return false;
+      }
+      prevDelta[slot] += unzigzag(value);
+      prevCycle[slot] += prevDelta[slot];
+      pSample->cycle = prevCycle[slot];
+
+      if ( !(column[eColumn_Addr] = getVarint(column[eColumn_Addr],end[eColumn_Addr],&value)) )
+      {
+         return false;
+      }
+      key = ((pSample->type&31)<<6)|(slot<<4)|(pSample->target&15);
+      prevAddr[key] += unzigzag(value);
+      pSample->addr = prevAddr[key];
+
+      pSample->ea = 0xFFFFFFFF;
+      if ( flags&TRACE_FLAG_EA )
+      {
+         if ( !(column[eColumn_EA] = getVarint(column[eColumn_EA],end[eColumn_EA],&value)) )
+         {
+            return false;
+         }
+         pSample->ea = value;
+      }
+      if ( flags&TRACE_FLAG_REGS )
+      {
+         if ( end[eColumn_Regs]-column[eColumn_Regs] < 5 )
+         {
+            return false;
+         }
+         pSample->a = column[eColumn_Regs][0];
+         pSample->x = column[eColumn_Regs][1];
+         pSample->y = column[eColumn_Regs][2];
+         pSample->sp = column[eColumn_Regs][3];
+         pSample->f = column[eColumn_Regs][4];
+         pSample->regsset = 1;
+         column[eColumn_Regs] += 5;
+      }
+      pSample->disassemble[3] = 0xFF;
+      if ( flags&TRACE_FLAG_DISASM )
+      {
+         if ( end[eColumn_Disasm]-column[eColumn_Disasm] < 3 )
+         {
+            return false;
+         }
+         memcpy(pSample->disassemble,column[eColumn_Disasm],3);
+         pSample->disassemble[3] = 0;
+         column[eColumn_Disasm] += 3;
+      }
+   }
+
+   return true;
+}
+
+static inline uint32_t read32 ( const uint8_t* in )
+{
+   uint32_t value;
+
+   memcpy(&value,in,4);
+   return value;
+}
+
+static inline uint8_t* putLength ( uint8_t* out, uint32_t length )
+{
+   while ( length >= 255 )
+   {
+      *out++ = 255;
+      length -= 255;
+   }
+   *out++ = length;
+   return out;
+}
+
+static uint8_t* putSequence ( uint8_t* out, const uint8_t* literals, uint32_t literal, uint32_t offset, uint32_t match )
+{
+   uint8_t* token = out++;
+
+   (*token) = ((literal < 15)?literal:15)<<4;
+   if ( literal >= 15 )
+   {
+      out = putLength(out,literal-15);
+   }
+   memcpy(out,literals,literal);
+   out += literal;
+
+   if ( match )
+   {
+      match -= LZ_MIN_MATCH;
+      (*token) |= (match < 15)?match:15;
+      *out++ = offset&0xFF;
+      *out++ = offset>>8;
+      if ( match >= 15 )
+      {
+         out = putLength(out,match-15);
+      }
+   }
+   return out;
+}
+
+static inline uint32_t matchLength ( const uint8_t* in, uint32_t candidate, uint32_t pos, uint32_t size )
+{
+   uint32_t length = LZ_MIN_MATCH;
+   uint64_t a;
+   uint64_t b;
+
+   while ( pos+length+8 <= size )
+   {
+      memcpy(&a,in+candidate+length,8);
+      memcpy(&b,in+pos+length,8);
+      if ( a != b )
+      {
+         break;
+      }
+      length += 8;
+   }
+   while ( (pos+length < size) && (in[candidate+length] == in[pos+length]) )
+   {
+      length++;
+   }
+   return length;
+}
+
+// Greedy single-probe LZ: fast rather than tight.  The search steps
+// further ahead the longer it goes without a match, so stretches that do
+// not pack cost little.  Gives up and returns 0 if the first part of the
+// input packs to less than a quarter off, or the whole does not pack;
+// out must have room for size+(size/255)+16 bytes.
+static uint32_t packLZ ( const uint8_t* in, uint32_t size, uint8_t* out )
+{
+   uint32_t check = size/8;
+   uint32_t table [ 1<<LZ_HASH_BITS ];
+   uint8_t* start = out;
+   uint32_t anchor = 0;
+   uint32_t pos = 0;
+   uint32_t misses = 0;
+   uint32_t candidate;
+   uint32_t match;
+   uint32_t value;
+   uint32_t hash;
+
+   memset(table,0,sizeof(table));
+
+   while ( pos+LZ_MIN_MATCH <= size )
+   {
+      value = read32(in+pos);
+      hash = (value*2654435761U)>>(32-LZ_HASH_BITS);
+      candidate = table[hash];
+      table[hash] = pos+1;
+
+      if ( candidate &&
+           (pos-(candidate-1) <= LZ_MAX_OFFSET) &&
+           (read32(in+candidate-1) == value) )
+      {
+         candidate--;
+         match = matchLength(in,candidate,pos,size);
+         out = putSequence(out,in+anchor,pos-anchor,pos-candidate,match);
+         pos += match;
+         anchor = pos;
+         misses = 0;
+
+         // Let the next search find the end of this match.
+         if ( pos+LZ_MIN_MATCH <= size )
+         {
+            table[(read32(in+pos-2)*2654435761U)>>(32-LZ_HASH_BITS)] = pos-1;
+         }
+      }
+      else
+      {
+         pos += 1+((misses++)>>5);
+      }
+
+      if ( check && (pos >= check) )
+      {
+         if ( (uint32_t)(out-start)+(pos-anchor) > (pos*3)/4 )
+         {
+            return 0;
+         }
+         check = 0;
+      }
+   }
+   out = putSequence(out,in+anchor,size-anchor,0,0);
+
+   return ((uint32_t)(out-start) < size) ? (out-start) : 0;
+}
+
+static inline const uint8_t* getLength ( const uint8_t* in, const uint8_t* end, uint32_t* length )
+{
+   while ( in < end )
+   {
+      (*length) += (*in);
+      if ( (*in++) != 255 )
+      {
+         return in;
+      }
+   }
+   return NULL;
+}
+
+static bool unpackLZ ( const uint8_t* in, uint32_t length, uint8_t* out, uint32_t size )
+{
+   const uint8_t* end = in+length;
+   uint32_t pos = 0;
+   uint32_t literal;
+   uint32_t match;
+   uint32_t offset;
+
+   while ( in < end )
+   {
+      literal = (*in)>>4;
+      match = (*in++)&0x0F;
+      if ( (literal == 15) && !(in = getLength(in,end,&literal)) )
+      {
+         return false;
+      }
+      if ( (literal > (uint32_t)(end-in)) || (literal > size-pos) )
+      {
+         return false;
+      }
+      memcpy(out+pos,in,literal);
+      in += literal;
+      pos += literal;
+
+      if ( in == end )
+      {
+         break;
+      }
+      if ( end-in < 2 )
+      {
+         return false;
+      }
+      offset = in[0]|(in[1]<<8);
+      in += 2;
+      if ( (match == 15) && !(in = getLength(in,end,&match)) )
+      {
+         return false;
+      }
+      match += LZ_MIN_MATCH;
+      if ( (offset == 0) || (offset > pos) || (match > size-pos) )
+      {
+         return false;
+      }
+      // Matches may overlap the bytes they produce.
+      for ( ; match; match--, pos++ )
+      {
+         out[pos] = out[pos-offset];
+      }
+   }
+   return pos == size;
+}
+
+static inline bool seekFile ( FILE* pFile, uint64_t offset )
+{
+#if defined ( _WIN32 )
+   return _fseeki64(pFile,offset,SEEK_SET) == 0;
+#else
+   return fseeko(pFile,offset,SEEK_SET) == 0;
+#endif
+}
+
+static inline uint64_t fileSize ( FILE* pFile )
+{
+#if defined ( _WIN32 )
+   _fseeki64(pFile,0,SEEK_END);
+   return _ftelli64(pFile);
+#else
+   fseeko(pFile,0,SEEK_END);
+   return ftello(pFile);
+#endif
+}
+
+static uint64_t addrPages ( uint16_t firstAddr, uint16_t lastAddr )
+{
+   uint64_t pages = 0;
+   uint32_t page;
+
+   for ( page = firstAddr>>UPSHIFT_1KB; page <= (uint32_t)(lastAddr>>UPSHIFT_1KB); page++ )
+   {
+      pages |= 1ULL<<page;
+   }
+   return pages;
+}
+
+CTraceStream::CTraceStream()
+   : m_pFile(NULL),
+     m_stop(false),
+     m_head(0),
+     m_tail(0),
+     m_stalls(0),
+     m_offset(0),
+     m_sample(0),
+     m_cpuCycle(0)
+{
+}
+
+CTraceStream::~CTraceStream()
+{
+   Close();
+}
+
+bool CTraceStream::Open ( const char* fileName )
+{
+   TraceFileHeader header;
+
+   Close();
+
+   m_pFile = fopen(fileName,"wb");
+   if ( !m_pFile )
+   {
+      return false;
+   }
+
+   header.magic = TRACE_FILE_MAGIC;
+   header.version = TRACE_FILE_VERSION;
+   header.blockSize = TRACE_STREAM_BLOCK;
+   header.reserved = 0;
+   if ( fwrite(&header,sizeof(header),1,m_pFile) != 1 )
+   {
+      fclose(m_pFile);
+      m_pFile = NULL;
+      return false;
+   }
+
+   m_columns.resize(TRACE_STREAM_BLOCK*TRACE_MAX_SAMPLE_BYTES);
+   m_packed.resize(m_columns.size()+(m_columns.size()/255)+(eColumn_MAX*16));
+   m_index.clear();
+   m_offset = sizeof(header);
+   m_sample = 0;
+   m_cpuCycle = 0;
+   m_stalls = 0;
+   m_head = 0;
+   m_tail = 0;
+   m_stop = false;
+
+   m_thread = std::thread(&CTraceStream::Run,this);
+
+   return true;
+}
+
+void CTraceStream::Close ( void )
+{
+   TraceFileFooter footer;
+
+   if ( !m_pFile )
+   {
+      return;
+   }
+
+   // The writer drains the queue before it stops.
+   m_stop = true;
+   m_thread.join();
+
+   footer.magic = TRACE_INDEX_MAGIC;
+   footer.chunks = m_index.size();
+   footer.indexOffset = m_offset;
+   if ( !m_index.empty() )
+   {
+      fwrite(m_index.data(),sizeof(TraceIndexEntry),m_index.size(),m_pFile);
+   }
+   fwrite(&footer,sizeof(footer),1,m_pFile);
+   fclose(m_pFile);
+   m_pFile = NULL;
+
+   m_columns.clear();
+   m_packed.clear();
+   m_index.clear();
+}
+
+void CTraceStream::Push ( const TracerColumns& ring, uint32_t first, uint32_t count )
+{
+   uint32_t head = m_head.load(std::memory_order_relaxed);
+   uint32_t limit = ((ring.mask+1)/TRACE_STREAM_BLOCK)-2;
+
+   // The tracer goes on to overwrite the ring two blocks past the newest
+   // queued one, so never queue more than the rest of the ring.
+   if ( limit > TRACE_STREAM_QUEUE )
+   {
+      limit = TRACE_STREAM_QUEUE;
+   }
+   if ( head-m_tail.load(std::memory_order_acquire) >= limit )
+   {
+      m_stalls++;
+      while ( head-m_tail.load(std::memory_order_acquire) >= limit )
+      {
+         std::this_thread::yield();
+      }
+   }
+
+   Block& block = m_queue[head%TRACE_STREAM_QUEUE];
+
+   block.ring = ring;
+   block.first = first;
+   block.count = count;
+
+   m_head.store(head+1,std::memory_order_release);
+}
+
+void CTraceStream::Drain ( void )
+{
+   while ( m_tail.load(std::memory_order_acquire) != m_head.load(std::memory_order_relaxed) )
+   {
+      std::this_thread::yield();
+   }
+}
+
+void CTraceStream::Run ( void )
+{
+   uint32_t tail;
+
+   for ( ;; )
+   {
+      tail = m_tail.load(std::memory_order_relaxed);
+      if ( tail == m_head.load(std::memory_order_acquire) )
+      {
+         if ( m_stop.load(std::memory_order_acquire) )
+         {
+            // Anything pushed before the stop request is visible now.
+            if ( tail == m_head.load(std::memory_order_acquire) )
+            {
+               break;
+            }
+            continue;
+         }
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+         continue;
+      }
+
+      WriteChunk(m_queue[tail%TRACE_STREAM_QUEUE]);
+      m_tail.store(tail+1,std::memory_order_release);
+   }
+}
+
+void CTraceStream::WriteChunk ( const Block& block )
+{
+   TraceIndexEntry entry;
+   TraceChunkInfo& info = entry.info;
+   TraceColumn header [ eColumn_MAX ];
+   uint8_t* column [ eColumn_MAX ];
+   uint32_t size [ eColumn_MAX ];
+   uint8_t* out;
+   uint32_t idx;
+
+   if ( !block.count )
+   {
+      return;
+   }
+
+   column[0] = m_columns.data();
+   encodeBlock(block.ring,block.first,block.count,&info,&m_cpuCycle,column,size);
+
+   out = m_packed.data();
+   info.rawSize = 0;
+   for ( idx = 0; idx < eColumn_MAX; idx++ )
+   {
+      header[idx].rawSize = size[idx];
+      header[idx].packedSize = packLZ(column[idx],size[idx],out);
+      if ( header[idx].packedSize )
+      {
+         out += header[idx].packedSize;
+      }
+      else
+      {
+         memcpy(out,column[idx],size[idx]);
+         out += size[idx];
+      }
+      info.rawSize += size[idx];
+   }
+
+   info.magic = TRACE_CHUNK_MAGIC;
+   info.samples = block.count;
+   info.firstSample = m_sample;
+   info.packedSize = sizeof(header)+(out-m_packed.data());
+   m_sample += block.count;
+
+   if ( (fwrite(&info,sizeof(info),1,m_pFile) != 1) ||
+        (fwrite(header,sizeof(header),1,m_pFile) != 1) ||
+        (fwrite(m_packed.data(),out-m_packed.data(),1,m_pFile) != 1) )
+   {
+      return;
+   }
+
+   entry.offset = m_offset;
+   m_index.push_back(entry);
+   m_offset += sizeof(info)+info.packedSize;
+}
+
+CTraceFile::CTraceFile()
+   : m_pFile(NULL)
+{
+}
+
+CTraceFile::~CTraceFile()
+{
+   Close();
+}
+
+bool CTraceFile::Open ( const char* fileName )
+{
+   TraceFileHeader header;
+
+   Close();
+
+   m_pFile = fopen(fileName,"rb");
+   if ( !m_pFile )
+   {
+      return false;
+   }
+
+   if ( (fread(&header,sizeof(header),1,m_pFile) != 1) ||
+        (header.magic != TRACE_FILE_MAGIC) ||
+        (header.version != TRACE_FILE_VERSION) ||
+        (!ReadIndex() && !ScanChunks()) )
+   {
+      Close();
+      return false;
+   }
+
+   return true;
+}
+
+void CTraceFile::Close ( void )
+{
+   if ( m_pFile )
+   {
+      fclose(m_pFile);
+      m_pFile = NULL;
+   }
+   m_index.clear();
+}
+
+bool CTraceFile::ReadIndex ( void )
+{
+   TraceFileFooter footer;
+   uint64_t size = fileSize(m_pFile);
+
+   if ( (size < sizeof(TraceFileHeader)+sizeof(footer)) ||
+        !seekFile(m_pFile,size-sizeof(footer)) ||
+        (fread(&footer,sizeof(footer),1,m_pFile) != 1) ||
+        (footer.magic != TRACE_INDEX_MAGIC) ||
+        (footer.indexOffset+((uint64_t)footer.chunks*sizeof(TraceIndexEntry)) != size-sizeof(footer)) )
+   {
+      return false;
+   }
+
+   m_index.resize(footer.chunks);
+   if ( footer.chunks &&
+        (!seekFile(m_pFile,footer.indexOffset) ||
+         (fread(m_index.data(),sizeof(TraceIndexEntry),footer.chunks,m_pFile) != footer.chunks)) )
+   {
+      m_index.clear();
+      return false;
+   }
+
+   return true;
+}
+
+bool CTraceFile::ScanChunks ( void )
+{
+   TraceIndexEntry entry;
+   uint64_t size = fileSize(m_pFile);
+   uint64_t offset = sizeof(TraceFileHeader);
+
+   // No index: the writer was not closed.  Keep every complete chunk.
+   m_index.clear();
+   while ( (offset+sizeof(TraceChunkInfo) <= size) &&
+           seekFile(m_pFile,offset) &&
+           (fread(&entry.info,sizeof(TraceChunkInfo),1,m_pFile) == 1) &&
+           (entry.info.magic == TRACE_CHUNK_MAGIC) &&
+           (offset+sizeof(TraceChunkInfo)+entry.info.packedSize <= size) )
+   {
+      entry.offset = offset;
+      m_index.push_back(entry);
+      offset += sizeof(TraceChunkInfo)+entry.info.packedSize;
+   }
+
+   return true;
+}
+
+uint64_t CTraceFile::GetNumSamples ( void ) const
+{
+   uint64_t samples = 0;
+   uint32_t chunk;
+
+   for ( chunk = 0; chunk < m_index.size(); chunk++ )
+   {
+      samples += m_index[chunk].info.samples;
+   }
+   return samples;
+}
+
+int32_t CTraceFile::FindFrame ( uint32_t frame ) const
+{
+   uint32_t chunk;
+
+   for ( chunk = 0; chunk < m_index.size(); chunk++ )
+   {
+      if ( (frame >= m_index[chunk].info.firstFrame) && (frame <= m_index[chunk].info.lastFrame) )
+      {
+         return chunk;
+      }
+   }
+   return -1;
+}
+
+int32_t CTraceFile::FindCycle ( uint32_t cycle ) const
+{
+   uint32_t chunk;
+
+   for ( chunk = 0; chunk < m_index.size(); chunk++ )
+   {
+      if ( (cycle >= m_index[chunk].info.firstCycle) && (cycle <= m_index[chunk].info.lastCycle) )
+      {
+         return chunk;
+      }
+   }
+   return -1;
+}
+
+bool CTraceFile::ReadChunk ( uint32_t chunk, std::vector<TracerInfo>& samples, std::vector<uint32_t>* cpuCycles )
+{
+   const TraceColumn* header;
+   const uint8_t* column [ eColumn_MAX ];
+   uint32_t size [ eColumn_MAX ];
+   const uint8_t* in;
+   const uint8_t* end;
+   uint8_t* out;
+   uint32_t idx;
+
+   samples.clear();
+   if ( chunk >= m_index.size() )
+   {
+      return false;
+   }
+
+   const TraceChunkInfo& info = m_index[chunk].info;
+   uint32_t cpuCycle = info.firstCycle;
+
+   if ( (info.samples > TRACE_STREAM_BLOCK) ||
+        (info.rawSize > TRACE_STREAM_BLOCK*TRACE_MAX_SAMPLE_BYTES) ||
+        (info.packedSize < sizeof(TraceColumn)*eColumn_MAX) )
+   {
+      return false;
+   }
+
+   m_packed.resize(info.packedSize);
+   m_raw.resize(info.rawSize);
+   if ( !seekFile(m_pFile,m_index[chunk].offset+sizeof(TraceChunkInfo)) ||
+        (fread(m_packed.data(),1,info.packedSize,m_pFile) != info.packedSize) )
+   {
+      return false;
+   }
+
+   header = (const TraceColumn*)m_packed.data();
+   in = m_packed.data()+(sizeof(TraceColumn)*eColumn_MAX);
+   end = m_packed.data()+info.packedSize;
+   out = m_raw.data();
+   for ( idx = 0; idx < eColumn_MAX; idx++ )
+   {
+      size[idx] = header[idx].rawSize;
+      if ( size[idx] > (uint32_t)((m_raw.data()+info.rawSize)-out) )
+      {
+         return false;
+      }
+      if ( header[idx].packedSize )
+      {
+         if ( (header[idx].packedSize > (uint32_t)(end-in)) ||
+              !unpackLZ(in,header[idx].packedSize,out,size[idx]) )
+         {
+            return false;
+         }
+         column[idx] = out;
+         out += size[idx];
+         in += header[idx].packedSize;
+      }
+      else
+      {
+         if ( size[idx] > (uint32_t)(end-in) )
+         {
+            return false;
+         }
+         column[idx] = in;
+         in += size[idx];
+      }
+   }
+
+   samples.resize(info.samples);
+   if ( !decodeBlock(column,size,samples.data(),info.samples) )
+   {
+      samples.clear();
+      return false;
+   }
+
+   if ( cpuCycles )
+   {
+      cpuCycles->resize(info.samples);
+      for ( idx = 0; idx < info.samples; idx++ )
+      {
+         if ( samples[idx].source == eNESSource_CPU )
+         {
+            cpuCycle = samples[idx].cycle;
+         }
+         (*cpuCycles)[idx] = cpuCycle;
+      }
+   }
+
+   return true;
+}
+
+void CTraceFile::ClearFilter ( TraceFilter* pFilter )
+{
+   pFilter->firstFrame = 0;
+   pFilter->lastFrame = 0xFFFFFFFF;
+   pFilter->firstCycle = 0;
+   pFilter->lastCycle = 0xFFFFFFFF;
+   pFilter->sourceMask = 0xFFFFFFFF;
+   pFilter->typeMask = 0xFFFFFFFF;
+   pFilter->firstAddr = 0x0000;
+   pFilter->lastAddr = 0xFFFF;
+}
+
+uint64_t CTraceFile::Query ( const TraceFilter& filter, TraceQueryFunc func, void* userData )
+{
+   std::vector<TracerInfo> samples;
+   std::vector<uint32_t>   cpuCycles;
+   uint64_t pages = addrPages(filter.firstAddr,filter.lastAddr);
+   uint64_t matches = 0;
+   uint32_t chunk;
+   uint32_t idx;
+
+   for ( chunk = 0; chunk < m_index.size(); chunk++ )
+   {
+      const TraceChunkInfo& info = m_index[chunk].info;
+
+      if ( (info.lastFrame < filter.firstFrame) || (info.firstFrame > filter.lastFrame) ||
+           (info.lastCycle < filter.firstCycle) || (info.firstCycle > filter.lastCycle) ||
+           !(info.sourceMask&filter.sourceMask) ||
+           !(info.typeMask&filter.typeMask) ||
+           !(info.addrPages&pages) )
+      {
+         continue;
+      }
+      if ( !ReadChunk(chunk,samples,&cpuCycles) )
+      {
+         break;
+      }
+
+      for ( idx = 0; idx < samples.size(); idx++ )
+      {
+         const TracerInfo& sample = samples[idx];
+
+         if ( (sample.frame >= filter.firstFrame) && (sample.frame <= filter.lastFrame) &&
+              (cpuCycles[idx] >= filter.firstCycle) && (cpuCycles[idx] <= filter.lastCycle) &&
+              (filter.sourceMask&(1<<(sample.source&31))) &&
+              (filter.typeMask&(1<<(sample.type&31))) &&
+              (sample.addr >= filter.firstAddr) && (sample.addr <= filter.lastAddr) )
+         {
+            matches++;
+            if ( func && !func(&sample,cpuCycles[idx],userData) )
+            {
+               return matches;
+            }
+         }
+      }
+   }
+
+   return matches;
+}
@@ -0,0 +1,207 @@
+#if !defined ( TRACE_STREAM_H )
+#define TRACE_STREAM_H
+
+#include "ctracer.h"
+
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// The tracer hands samples to the writer thread TRACE_STREAM_BLOCK
+// (ctracer.h) at a time.  Its ring must hold at least this many blocks.
+#define TRACE_STREAM_MIN_BLOCKS 4
+
+// Blocks waiting for the writer thread.  The emulator only waits once
+// this many are queued, or fewer if the tracer's ring is too small to
+// hold them.
+#define TRACE_STREAM_QUEUE      8
+
+#define TRACE_FILE_MAGIC        0x5254454E // "NETR"
+#define TRACE_FILE_VERSION      1
+#define TRACE_CHUNK_MAGIC       0x4B4E4843 // "CHNK"
+#define TRACE_INDEX_MAGIC       0x58444E49 // "INDX"
+
+// Trace file layout:
+//
+//    TraceFileHeader
+//    TraceChunkInfo, packed chunk     (one per block)
+//    ...
+//    TraceIndexEntry [ chunks ]
+//    TraceFileFooter
+//
+// A chunk is one block of samples, each field stored as its own column
+// (frames and cycles as deltas, addresses as deltas against the previous
+// address of the same source and target) and each column LZ-compressed
+// unless it does not pack.  Every chunk decodes on its own.  Its header
+// says which frames, CPU cycles, sample types, sources and 1KB address
+// pages it covers, so a query only unpacks the chunks that can match.  The index at the end is a copy of the chunk
+// headers with their file offsets; if the writer never got to write it
+// the reader walks the chunk headers instead.
+//
+// Cycle counts in the tracer come from different clocks depending on the
+// sample's source.  Seeking and filtering by cycle is done on the CPU
+// clock: every sample is stamped with the cycle of the most recent CPU
+// sample before it.
+#pragma pack(1)
+typedef struct _TraceFileHeader
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t blockSize;
+   uint32_t reserved;
+} TraceFileHeader;
+
+typedef struct _TraceChunkInfo
+{
+   uint32_t magic;
+   uint32_t samples;
+   uint32_t rawSize;
+   uint32_t packedSize;
+   uint64_t firstSample;
+   uint32_t firstFrame;
+   uint32_t lastFrame;
+   uint32_t firstCycle;
+   uint32_t lastCycle;
+   uint32_t typeMask;
+   uint32_t sourceMask;
+   uint64_t addrPages;
+} TraceChunkInfo;
+
+typedef struct _TraceIndexEntry
+{
+   uint64_t       offset;
+   TraceChunkInfo info;
+} TraceIndexEntry;
+
+typedef struct _TraceFileFooter
+{
+   uint32_t magic;
+   uint32_t chunks;
+   uint64_t indexOffset;
+} TraceFileFooter;
+#pragma pack()
+
+// Background writer for a streaming CTracer.  The tracer is the only
+// producer and the writer thread the only consumer of the block queue,
+// so the two only share the queue's head and tail counters.  Queued
+// blocks are read straight out of the tracer's ring; the tracer keeps
+// them intact until the writer is done with them.
+class CTraceStream
+{
+public:
+   CTraceStream();
+   ~CTraceStream();
+
+   bool Open ( const char* fileName );
+   void Close ( void );
+   bool IsOpen ( void ) const
+   {
+      return m_pFile != NULL;
+   }
+
+   // Queue count samples of the tracer's ring starting at slot first.
+   // Waits for the writer if the queue is full.
+   void Push ( const TracerColumns& ring, uint32_t first, uint32_t count );
+
+   // Wait until the writer is done with everything queued.
+   void Drain ( void );
+
+   // Times Push had to wait for the writer.
+   uint32_t GetStalls ( void ) const
+   {
+      return m_stalls;
+   }
+
+protected:
+   struct Block
+   {
+      TracerColumns ring;
+      uint32_t      first;
+      uint32_t      count;
+   };
+
+   void Run ( void );
+   void WriteChunk ( const Block& block );
+
+   FILE*                 m_pFile;
+   std::thread           m_thread;
+   std::atomic<bool>     m_stop;
+   Block                 m_queue [ TRACE_STREAM_QUEUE ];
+   std::atomic<uint32_t> m_head;
+   std::atomic<uint32_t> m_tail;
+   uint32_t              m_stalls;
+
+   // Writer thread only.
+   std::vector<uint8_t>         m_columns;
+   std::vector<uint8_t>         m_packed;
+   std::vector<TraceIndexEntry> m_index;
+   uint64_t                     m_offset;
+   uint64_t                     m_sample;
+   uint32_t                     m_cpuCycle;
+};
+
+// What a CTraceFile query matches.  Frame and cycle ranges are inclusive;
+// the masks have a bit per source (eNESSource_*) and per type (eTracer_*).
+typedef struct _TraceFilter
+{
+   uint32_t firstFrame;
+   uint32_t lastFrame;
+   uint32_t firstCycle;
+   uint32_t lastCycle;
+   uint32_t sourceMask;
+   uint32_t typeMask;
+   uint16_t firstAddr;
+   uint16_t lastAddr;
+} TraceFilter;
+
+// Returns false to stop the query.  cpuCycle is the CPU clock the sample
+// is stamped with (see above).
+typedef bool (*TraceQueryFunc)(const TracerInfo* pSample, uint32_t cpuCycle, void* userData);
+
+// Reader for a file written by CTraceStream.
+class CTraceFile
+{
+public:
+   CTraceFile();
+   ~CTraceFile();
+
+   bool Open ( const char* fileName );
+   void Close ( void );
+
+   uint32_t GetNumChunks ( void ) const
+   {
+      return m_index.size();
+   }
+   const TraceChunkInfo& GetChunkInfo ( uint32_t chunk ) const
+   {
+      return m_index[chunk].info;
+   }
+   uint64_t GetNumSamples ( void ) const;
+
+   // First chunk holding samples of the frame, or at the CPU cycle.
+   // Returns -1 if no chunk covers it.
+   int32_t FindFrame ( uint32_t frame ) const;
+   int32_t FindCycle ( uint32_t cycle ) const;
+
+   // Unpack one chunk.  cpuCycles, if given, gets each sample's CPU clock.
+   bool ReadChunk ( uint32_t chunk, std::vector<TracerInfo>& samples, std::vector<uint32_t>* cpuCycles = NULL );
+
+   static void ClearFilter ( TraceFilter* pFilter );
+
+   // Call func for every sample matching the filter, in trace order,
+   // unpacking only the chunks whose headers allow a match.  Returns the
+   // number of matching samples.
+   uint64_t Query ( const TraceFilter& filter, TraceQueryFunc func, void* userData );
+
+protected:
+   bool ReadIndex ( void );
+   bool ScanChunks ( void );
+
+   FILE*                        m_pFile;
+   std::vector<TraceIndexEntry> m_index;
+   std::vector<uint8_t>         m_raw;
+   std::vector<uint8_t>         m_packed;
+};
+
+#endif // #if !defined ( TRACE_STREAM_H )
@@ -26,6 +26,15 @@ CONFIG(release, debug|release) {
 # Remove crap we don't need!
 CONFIG -= rtti exceptions
 
+# Per-machine emulator state is reached through thread_local pointers.
+CONFIG += c++11
+
+# The thread_local state pointers are all constant-initialized, so skip
+# the TLS init wrapper calls on every cross-module access.
+unix {
+   QMAKE_CXXFLAGS += -fno-extern-tls-init
+}
+
 OBJECTS_DIR = $$DESTDIR
 MOC_DIR = $$DESTDIR
 RCC_DIR = $$DESTDIR
@@ -61,6 +70,11 @@ unix:!mac {
 
 DEFINES += XML_SAVE_STATE
 
+# Per-subsystem timers and counters behind nesGetPerfCounters.  They cost
+# a little on every instruction and memory access, so are left out
+# unless asked for.
+#DEFINES += NES_PERF_COUNTERS
+
 INCLUDEPATH += . \
                ./common \
                ./emulator \
@@ -86,12 +100,16 @@ SOURCES += \
    emulator/cnesapu.cpp \
    emulator/cnes.cpp \
    emulator/cnes6502.cpp \
+   emulator/cnesmachine.cpp \
+   emulator/cnesrewind.cpp \
    common/cnessystempalette.cpp \
    nes_emulator_core.cpp \
    emulator/cmarker.cpp \
    emulator/cjoypadlogger.cpp \
    emulator/ccodedatalogger.cpp \
+   emulator/cnesperf.cpp \
    emulator/ctracer.cpp \
+   emulator/ctracestream.cpp \
    emulator/cnesbreakpointinfo.cpp \
    emulator/cnesios.cpp \
    emulator/cnesrommapper033.cpp \
@@ -131,12 +149,17 @@ HEADERS +=\
    emulator/cnesapu.h \
    emulator/cnes.h \
    emulator/cnes6502.h \
+   emulator/cnesmachine.h \
+   emulator/cnesstate.h \
+   emulator/cnesrewind.h \
    nes_emulator_core.h \
    common/cnessystempalette.h \
    emulator/cmarker.h \
    emulator/cjoypadlogger.h \
    emulator/ccodedatalogger.h \
+   emulator/cnesperf.h \
    emulator/ctracer.h \
+   emulator/ctracestream.h \
    emulator/cnesios.h \
    emulator/cnesrommapper033.h \
    emulator/cnesrommapper069.h \
@@ -5,6 +5,8 @@
 #include "cnesppu.h"
 #include "cnesapu.h"
 #include "cnes6502.h"
+#include "cnesmachine.h"
+#include "cnesperf.h"
 #include "cnesrommapper001.h"
 #include "cnesrommapper004.h"
 #include "cnesrommapper009.h"
@@ -26,20 +28,22 @@ char* nesGetVersion()
 {
    return __emu_version__;
 }
-extern int32_t apuDataAvailable;
 
 const char* hex_char = "0123456789ABCDEF";
 
-bool __nesdebug = false;
-
 void nesEnableDebug ( void )
 {
-   __nesdebug = true;
+   CNES::DEBUGGING(true);
 }
 
 void nesDisableDebug ( void )
 {
-   __nesdebug = false;
+   CNES::DEBUGGING(false);
+}
+
+bool nesIsDebugEnabled ( void )
+{
+   return CNES::DEBUGGING();
 }
 
 void nesSetBreakOnKIL ( bool breakOnKIL )
@@ -65,7 +69,9 @@ void nesBreak ( void )
 {
    if ( breakpointHook )
    {
+      NESPERFWAITBEGIN ();
       breakpointHook();
+      NESPERFWAITEND ();
    }
 }
 
@@ -73,7 +79,9 @@ void nesBreakAudio ( void )
 {
    if ( audioHook )
    {
+      NESPERFWAITBEGIN ();
       audioHook();
+      NESPERFWAITEND ();
    }
 }
 
@@ -184,6 +192,21 @@ CTracer* nesGetExecutionTracerDatabase ( void )
    return CNES::TRACER();
 }
 
+bool nesStartTraceStream ( const char* fileName )
+{
+   return CNES::TRACER()->StartStreaming(fileName);
+}
+
+void nesStopTraceStream ( void )
+{
+   CNES::TRACER()->StopStreaming();
+}
+
+bool nesIsTraceStreaming ( void )
+{
+   return CNES::TRACER()->IsStreaming();
+}
+
 CMarker* nesGetExecutionMarkerDatabase ( void )
 {
    return C6502::MARKERS();
@@ -351,14 +374,19 @@ void nesDisassemble ()
    CNES::DISASSEMBLE();
 }
 
+bool nesGetDisassemblyChanges ( uint32_t addr, int32_t* firstRow, int32_t* endRow, int32_t* rowDelta )
+{
+   return CNES::DISASSEMBLYCHANGES(addr,firstRow,endRow,rowDelta);
+}
+
 void nesDisassembleSingle ( uint8_t* pOpcode, char* buffer )
 {
    C6502::Disassemble(pOpcode,buffer);
 }
 
-char* nesGetDisassemblyAtAddress ( uint32_t addr )
+void nesGetDisassemblyAtAddress ( uint32_t addr, char* buffer )
 {
-   return CNES::DISASSEMBLY(addr);
+   CNES::DISASSEMBLY(addr,buffer);
 }
 
 void nesGetDisassemblyAtAbsoluteAddress ( uint32_t absAddr, char* buffer )
@@ -404,8 +432,31 @@ void nesSetTVOut ( int8_t* tv )
    CPPU::TV ( tv );
 }
 
+void nesSetTVOutIndexed ( uint16_t* tv )
+{
+   CPPU::TVINDEXED ( tv );
+}
+
+uint16_t* nesGetTVOutIndexed ( void )
+{
+   return CPPU::TVINDEXED();
+}
+
+void nesConvertTVOutRGBA ( const uint16_t* indexed, int8_t* tv, uint8_t alpha )
+{
+   CPPU::CONVERTTVRGBA ( indexed, tv, alpha );
+}
+
+void nesConvertTVOutRGB565 ( const uint16_t* indexed, uint16_t* tv )
+{
+   CPPU::CONVERTTVRGB565 ( indexed, tv );
+}
+
 void nesUnloadROM ( void )
 {
+   // The rewind history belongs to the outgoing cartridge.
+   NesMachine::CURRENT()->REWIND()->Clear();
+
    CROM::ClearPRGBanks ();
    CROM::ClearCHRBanks ();
    CROM::RESET(0);
@@ -431,6 +482,65 @@ bool nesROMIsLoaded ( void )
    return ( (CROM::NUMPRGROMBANKS()>0)?true:false );
 }
 
+uint32_t nesGetStateSize ( void )
+{
+   return NesMachine::CURRENT()->SAVESTATE(NULL,0);
+}
+
+uint32_t nesSaveState ( uint8_t* buffer, uint32_t size )
+{
+   return NesMachine::CURRENT()->SAVESTATE(buffer,size);
+}
+
+bool nesLoadState ( const uint8_t* buffer, uint32_t size )
+{
+   return NesMachine::CURRENT()->LOADSTATE(buffer,size);
+}
+
+void nesSetRewindEnabled ( bool enabled )
+{
+   NesMachine::CURRENT()->REWIND()->SetEnabled(enabled);
+}
+
+bool nesIsRewindEnabled ( void )
+{
+   return NesMachine::CURRENT()->REWIND()->IsEnabled();
+}
+
+void nesSetRewindLimits ( uint32_t frames, uint32_t bytes, uint32_t keyframeInterval )
+{
+   NesMachine::CURRENT()->REWIND()->Configure(frames,bytes,keyframeInterval);
+}
+
+void nesRewindCapture ( uint32_t* joypads )
+{
+   NesMachine* machine = NesMachine::CURRENT();
+
+   machine->REWIND()->Capture(machine,joypads);
+}
+
+bool nesRewindStep ( uint32_t* joypads )
+{
+   NesMachine* machine = NesMachine::CURRENT();
+
+   return machine->REWIND()->StepBack(machine,joypads);
+}
+
+void nesClearRewind ( void )
+{
+   NesMachine::CURRENT()->REWIND()->Clear();
+}
+
+uint32_t nesGetRewindFrames ( void )
+{
+   return NesMachine::CURRENT()->REWIND()->GetNumFrames();
+}
+
+uint32_t nesGetRewindMemoryUsed ( void )
+{
+   return NesMachine::CURRENT()->REWIND()->GetMemoryUsed();
+}
+
 void nesSetHorizontalMirroring ( void )
 {
    CPPU::MIRRORHORIZ();
@@ -461,6 +571,35 @@ void nesRun ( uint32_t* joypads )
    CNES::RUN(joypads);
 }
 
+void nesRunAhead ( uint32_t* joypads, uint32_t frames )
+{
+   NesMachine* machine = NesMachine::CURRENT();
+   uint32_t    frame;
+   bool        frameSkip = CNES::FRAMESKIP();
+
+   CNES::RUN(joypads);
+
+   if ( frames && machine->SNAPSHOT() )
+   {
+      // Only the last speculative frame's picture is shown.
+      CNES::SPECULATIVE(true);
+      for ( frame = 0; frame < frames; frame++ )
+      {
+         CNES::FRAMESKIP(frameSkip || (frame < frames-1));
+         CNES::RUN(joypads);
+      }
+      CNES::SPECULATIVE(false);
+      CNES::FRAMESKIP(frameSkip);
+
+      machine->RESTORE();
+   }
+}
+
+void nesSetFrameSkip ( bool skip )
+{
+   CNES::FRAMESKIP(skip);
+}
+
 uint8_t* nesGetAudioSamples ( uint16_t samples )
 {
    return CAPU::PLAY(samples);
@@ -468,12 +607,286 @@ uint8_t* nesGetAudioSamples ( uint16_t samples )
 
 int32_t nesGetAudioSamplesAvailable ( void )
 {
-   return apuDataAvailable;
+   return CAPU::SAMPLESAVAILABLE();
 }
 
 void nesClearAudioSamplesAvailable ( void )
 {
-   apuDataAvailable = 0;
+   CAPU::CLEARSAMPLESAVAILABLE();
+}
+
+uint32_t nesGetAudioUnderruns ( void )
+{
+   return CAPU::UNDERRUNS();
+}
+
+uint32_t nesGetAudioOverruns ( void )
+{
+   return CAPU::OVERRUNS();
+}
+
+void nesSetAudioBufferTarget ( uint32_t samples )
+{
+   CAPU::FILLTARGET(samples);
+}
+
+int32_t nesGetAudioRateAdjust ( void )
+{
+   return CAPU::RATEADJUST();
+}
+
+void nesSetIdleLoopSkip ( bool enabled )
+{
+   C6502::IDLESKIP(enabled);
+}
+
+bool nesIsIdleLoopSkip ( void )
+{
+   return C6502::IDLESKIP();
+}
+
+void nesGetIdleLoopStats ( uint32_t* turns, uint32_t* cycles )
+{
+   (*turns) = C6502::IDLETURNS();
+   (*cycles) = C6502::IDLESKIPPED();
+}
+
+bool nesGetPerfCounters ( NesPerfCounters* counters )
+{
+#if defined ( NES_PERF_COUNTERS )
+   CNESPerf::GET ( counters );
+   return true;
+#else
+   memset ( counters, 0, sizeof(NesPerfCounters) );
+   return false;
+#endif
+}
+
+NesMachine* nesCreate ( void )
+{
+   return new NesMachine();
+}
+
+void nesDestroy ( NesMachine* machine )
+{
+   if ( machine != NesMachine::DEFAULT() )
+   {
+      delete machine;
+   }
+}
+
+NesMachine* nesGetDefaultMachine ( void )
+{
+   return NesMachine::DEFAULT();
+}
+
+NesMachine* nesGetCurrentMachine ( void )
+{
+   return NesMachine::CURRENT();
+}
+
+NesMachine* nesSelect ( NesMachine* machine )
+{
+   return NesMachine::SELECT(machine);
+}
+
+void nesSetSystemModeHandle ( NesMachine* machine, uint32_t mode )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesSetSystemMode(mode);
+   NesMachine::SELECT(previous);
+}
+
+uint32_t nesGetSystemModeHandle ( NesMachine* machine )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+   uint32_t result;
+
+   result = nesGetSystemMode();
+   NesMachine::SELECT(previous);
+   return result;
+}
+
+void nesSetTVOutHandle ( NesMachine* machine, int8_t* tv )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesSetTVOut(tv);
+   NesMachine::SELECT(previous);
+}
+
+void nesSetTVOutIndexedHandle ( NesMachine* machine, uint16_t* tv )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesSetTVOutIndexed(tv);
+   NesMachine::SELECT(previous);
+}
+
+void nesUnloadROMHandle ( NesMachine* machine )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesUnloadROM();
+   NesMachine::SELECT(previous);
+}
+
+void nesLoadPRGROMBankHandle ( NesMachine* machine, uint32_t bank, uint8_t* bankData )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesLoadPRGROMBank(bank,bankData);
+   NesMachine::SELECT(previous);
+}
+
+void nesLoadCHRROMBankHandle ( NesMachine* machine, uint32_t bank, uint8_t* bankData )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesLoadCHRROMBank(bank,bankData);
+   NesMachine::SELECT(previous);
+}
+
+void nesSetHorizontalMirroringHandle ( NesMachine* machine )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesSetHorizontalMirroring();
+   NesMachine::SELECT(previous);
+}
+
+void nesSetVerticalMirroringHandle ( NesMachine* machine )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesSetVerticalMirroring();
+   NesMachine::SELECT(previous);
+}
+
+void nesSetFourScreenHandle ( NesMachine* machine )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesSetFourScreen();
+   NesMachine::SELECT(previous);
+}
+
+void nesLoadROMHandle ( NesMachine* machine )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesLoadROM();
+   NesMachine::SELECT(previous);
+}
+
+void nesResetInitialHandle ( NesMachine* machine, uint32_t mapper )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesResetInitial(mapper);
+   NesMachine::SELECT(previous);
+}
+
+void nesResetHandle ( NesMachine* machine, bool soft )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesReset(soft);
+   NesMachine::SELECT(previous);
+}
+
+void nesRunHandle ( NesMachine* machine, uint32_t* joypads )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesRun(joypads);
+   NesMachine::SELECT(previous);
+}
+
+void nesRunAheadHandle ( NesMachine* machine, uint32_t* joypads, uint32_t frames )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesRunAhead(joypads,frames);
+   NesMachine::SELECT(previous);
+}
+
+int32_t nesGetAudioSamplesAvailableHandle ( NesMachine* machine )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+   int32_t result;
+
+   result = nesGetAudioSamplesAvailable();
+   NesMachine::SELECT(previous);
+   return result;
+}
+
+void nesClearAudioSamplesAvailableHandle ( NesMachine* machine )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesClearAudioSamplesAvailable();
+   NesMachine::SELECT(previous);
+}
+
+uint8_t* nesGetAudioSamplesHandle ( NesMachine* machine, uint16_t samples )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+   uint8_t* result;
+
+   result = nesGetAudioSamples(samples);
+   NesMachine::SELECT(previous);
+   return result;
+}
+
+void nesSetControllerTypeHandle ( NesMachine* machine, int32_t port, int32_t type )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesSetControllerType(port,type);
+   NesMachine::SELECT(previous);
+}
+
+void nesSetControllerScreenPositionHandle ( NesMachine* machine, int32_t port, int32_t px, int32_t py, int32_t wx1, int32_t wy1, int32_t wx2, int32_t wy2 )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesSetControllerScreenPosition(port,px,py,wx1,wy1,wx2,wy2);
+   NesMachine::SELECT(previous);
+}
+
+void nesSetControllerSpecialHandle ( NesMachine* machine, int32_t port, int32_t special )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+
+   nesSetControllerSpecial(port,special);
+   NesMachine::SELECT(previous);
+}
+
+bool nesROMIsLoadedHandle ( NesMachine* machine )
+{
+   NesMachine* previous = NesMachine::SELECT(machine);
+   bool result;
+
+   result = nesROMIsLoaded();
+   NesMachine::SELECT(previous);
+   return result;
+}
+
+uint32_t nesGetStateSizeHandle ( NesMachine* machine )
+{
+   return (machine?machine:NesMachine::DEFAULT())->SAVESTATE(NULL,0);
+}
+
+uint32_t nesSaveStateHandle ( NesMachine* machine, uint8_t* buffer, uint32_t size )
+{
+   return (machine?machine:NesMachine::DEFAULT())->SAVESTATE(buffer,size);
+}
+
+bool nesLoadStateHandle ( NesMachine* machine, const uint8_t* buffer, uint32_t size )
+{
+   return (machine?machine:NesMachine::DEFAULT())->LOADSTATE(buffer,size);
 }
 
 uint32_t nesGetCPUCycle ( void )
@@ -481,6 +894,11 @@ uint32_t nesGetCPUCycle ( void )
    return C6502::_CYCLES();
 }
 
+uint32_t nesGetCPUInstructions ( void )
+{
+   return C6502::_INSTRUCTIONS();
+}
+
 void nesSetGotoAddress ( uint32_t addr )
 {
    if ( addr == 0xFFFFFFFF )
@@ -523,6 +941,11 @@ void nesSetAudioChannelMask ( uint8_t mask )
    CAPU::MUTE(mask);
 }
 
+void nesSetAudioSynthesis ( uint32_t mode )
+{
+   CAPU::SYNTHESIS(mode);
+}
+
 uint32_t nesGetCPUEffectiveAddress ( void )
 {
    return C6502::_EA();
@@ -843,22 +1266,24 @@ uint8_t nesGetMapper ( void )
 
 uint32_t nesMapperLowRead ( uint32_t addr )
 {
-   return MAPPERFUNC->debuginfo(addr);
+   return CNES::MAPPERFUNC()->debuginfo(addr);
 }
 
 void nesMapperLowWrite ( uint32_t addr, uint32_t data )
 {
-   MAPPERFUNC->lowwrite(addr,data);
+   CNES::MAPPERSYNC();
+   CNES::MAPPERFUNC()->lowwrite(addr,data);
 }
 
 uint32_t nesMapperHighRead ( uint32_t addr )
 {
-   return MAPPERFUNC->debuginfo(addr);
+   return CNES::MAPPERFUNC()->debuginfo(addr);
 }
 
 void nesMapperHighWrite ( uint32_t addr, uint32_t data )
 {
-   MAPPERFUNC->highwrite(addr,data);
+   CNES::MAPPERSYNC();
+   CNES::MAPPERFUNC()->highwrite(addr,data);
 }
 
 uint32_t nesGetPPUOAM ( uint32_t addr )
@@ -988,22 +1413,22 @@ void nesSetVRAMData ( uint32_t addr, uint32_t data )
 
 bool nesMapperRemapsPRGROM ( void )
 {
-   return MAPPERFUNC->remapPrg;
+   return CNES::MAPPERFUNC()->remapPrg;
 }
 
 bool nesMapperRemapsCHRMEM ( void )
 {
-   return MAPPERFUNC->remapChr;
+   return CNES::MAPPERFUNC()->remapChr;
 }
 
 bool nesMapperRemapsVMEM ( void )
 {
-   return MAPPERFUNC->remapVram;
+   return CNES::MAPPERFUNC()->remapVram;
 }
 
 uint32_t nesMapperRemappedVMEMSize ( void )
 {
-   return MAPPERFUNC->vramSize;
+   return CNES::MAPPERFUNC()->vramSize;
 }
 
 uint32_t nesGetPaletteRedComponent(uint32_t idx)
@@ -100,6 +100,7 @@ enum
 // Instructions with special handling needs.
 #define BRK_IMPLIED  0x00
 #define JSR_ABSOLUTE 0x20
+#define JMP_ABSOLUTE 0x4C
 #define PLP_IMPLIED  0x28
 #define ROL_ABS_X    0x3E
 #define RTI_IMPLIED  0x40
@@ -196,6 +197,19 @@ enum
 #define PPUMASK_INTENSIFY_GREENS        0x40
 #define PPUMASK_INTENSIFY_BLUES         0x80
 
+// Palette-index TV surface pixels (see nesSetTVOutIndexed).  Each pixel
+// is the 6-bit NES color, with greyscale already applied, and the PPUMASK
+// color emphasis bits above it.  The whole value indexes a table of
+// TV_INDEXED_NUM_COLORS colors.
+#define TV_INDEXED_WIDTH           256
+#define TV_INDEXED_HEIGHT          240
+#define TV_INDEXED_COLOR_MASK      0x3F
+#define TV_INDEXED_EMPHASIS_SHIFT  6
+#define TV_INDEXED_EMPHASIS_RED    0x040
+#define TV_INDEXED_EMPHASIS_GREEN  0x080
+#define TV_INDEXED_EMPHASIS_BLUE   0x100
+#define TV_INDEXED_NUM_COLORS      512
+
 // PPUSTATUS register bit definitions.
 #define PPUSTATUS_SPRITE_OVFLO        0x20
 #define PPUSTATUS_SPRITE_0_HIT        0x40
@@ -267,6 +281,13 @@ enum
 #define APU_SAMPLE_SPACE_PAL   ((106392.0/3.2)/(SDL_SAMPLE_RATE/50.0))
 #define APU_SAMPLE_SPACE_DENDY ((106392.0/3.0)/(SDL_SAMPLE_RATE/50.0))
 
+// How the APU turns its output into samples (nesSetAudioSynthesis).
+// AVERAGE averages the mixer's output over each sample.  BANDLIMITED
+// places every change of the output at the APU cycle it happened as a
+// band-limited step, which keeps high notes free of aliasing.
+#define AUDIO_SYNTHESIS_AVERAGE     0
+#define AUDIO_SYNTHESIS_BANDLIMITED 1
+
 #define APU_BUFFER_PRERENDER           (APU_SAMPLES*2)   // How much rendering to do
 
 #pragma pack(1)
@@ -475,7 +496,13 @@ char* nesGetVersion();
 // core and perform the necessary steps to emulate a NES game.  Those steps are:
 // 1. Set the NES system mode to MODE_NTSC or MODE_PAL using nesSetSystemMode().
 // 2. Provide a 256x256x3-byte chunk of memory to the emulator core for it to
-//    render the NES TV surface onto, using nesSetTVOut().
+//    render the NES TV surface onto, using nesSetTVOut().  Alternatively, or
+//    as well, provide a 256x240 uint16_t surface with nesSetTVOutIndexed() to
+//    have the core store just the palette index and color emphasis of each
+//    pixel (see TV_INDEXED_*).  That is half the memory traffic of the RGB
+//    surface and needs no palette lookups; convert it with nesConvertTVOutRGBA() or
+//    nesConvertTVOutRGB565() for the frames that are actually shown.  Pass
+//    NULL to nesSetTVOut() to stop the core producing RGB at all.
 // 3. Clear any emulation state by using nesUnloadROM().
 // 4. Pass 16KB PRG-ROM banks in order and 8KB CHR-ROM banks in order to the emulation
 //    core by using nesLoadPRGROMBank() and nesLoadCHRROMBank() respectively.  If no
@@ -494,13 +521,38 @@ char* nesGetVersion();
 // 9. If the emulator supports sound output, the number of audio samples available
 //    can be retrieved by using nesGetAudioSamplesAvailable().  A pointer to the
 //    next buffer of audio samples to play can be retrieved using nesGetAudioSamples().
-//    Once retrieved, the number of available audio samples should be reset using
-//    nesClearAudioSamplesAvailable.
+//    The samples go through a lock-free ring with one producer (the thread
+//    running the emulator) and one consumer, so an audio callback on its own
+//    thread can call nesGetAudioSamples() directly.  It always returns as many
+//    samples as asked for; if too few are ready the last one is held and
+//    nesGetAudioUnderruns() counts it.  nesClearAudioSamplesAvailable() throws
+//    away whatever has not been played yet and belongs on the consumer's side too.
+//    When the ring fills past APU_BUFFER_PRERENDER samples the audio hook is
+//    called for every further sample, to let the emulator thread wait for the
+//    consumer.  To keep the ring near a given fill instead of waiting on it, use
+//    nesSetAudioBufferTarget(); the output rate is then adjusted once a frame, by
+//    at most 0.5%, and nesGetAudioRateAdjust() says by how much (in parts per
+//    million).  nesGetAudioOverruns() counts samples dropped on a full ring.
+// 10. To cut input latency, nesRunAhead() can be used in place of nesRun().  It
+//    runs the frame as nesRun() does, then runs the given number of further frames
+//    with the same joypad input and puts the machine back to the end of the first
+//    frame.  The TV surface is left showing the last speculative frame, which is
+//    what the game would show if the input were held.  Speculative frames produce
+//    no audio and are not seen by the debugger.
+// 11. To fast-forward, call nesSetFrameSkip(true) before each nesRun() whose
+//    picture will not be shown.  Those frames emulate everything the game can
+//    see, sprite 0 hits, sprite overflow and the mapper's view of the PPU bus
+//    included, but leave the TV surfaces untouched and produce no audio.  Turn
+//    it off again for the frame to be shown.
 
 // Emulation interfaces.
 void nesSetSystemMode ( uint32_t mode );
 uint32_t nesGetSystemMode ( void );
 void nesSetTVOut ( int8_t* tv );
+void nesSetTVOutIndexed ( uint16_t* tv );
+uint16_t* nesGetTVOutIndexed ( void );
+void nesConvertTVOutRGBA ( const uint16_t* indexed, int8_t* tv, uint8_t alpha );
+void nesConvertTVOutRGB565 ( const uint16_t* indexed, uint16_t* tv );
 void nesUnloadROM ( void );
 void nesLoadPRGROMBank ( uint32_t bank, uint8_t* bankData );
 void nesLoadCHRROMBank ( uint32_t bank, uint8_t* bankData );
@@ -511,17 +563,137 @@ void nesLoadROM ( void );
 void nesResetInitial ( uint32_t mapper );
 void nesReset ( bool soft );
 void nesRun ( uint32_t* joypads );
+void nesRunAhead ( uint32_t* joypads, uint32_t frames );
+void nesSetFrameSkip ( bool skip );
 int32_t nesGetAudioSamplesAvailable ( void );
 void nesClearAudioSamplesAvailable ( void );
 uint8_t* nesGetAudioSamples ( uint16_t samples );
+uint32_t nesGetAudioUnderruns ( void );
+uint32_t nesGetAudioOverruns ( void );
+void nesSetAudioBufferTarget ( uint32_t samples );
+int32_t nesGetAudioRateAdjust ( void );
+
+// Idle-loop skipping.
+// Games mostly wait for NMI in a short loop such as "wait: LDA flag / BEQ wait".
+// With idle-loop skipping on, once the CPU has gone round such a loop without
+// anything changing it moves on by whole turns of the loop, up to the first
+// NMI, IRQ, DMA or PPUSTATUS change that could end it, instead of running each
+// turn.  Only loops that read RAM, ROM or PPUSTATUS and write nothing qualify.
+// The emulation is the same either way; nothing is skipped while debugging.
+// nesGetIdleLoopStats returns the turns and CPU cycles skipped in the last
+// frame run.
+void nesSetIdleLoopSkip ( bool enabled );
+bool nesIsIdleLoopSkip ( void );
+void nesGetIdleLoopStats ( uint32_t* turns, uint32_t* cycles );
+
+// Performance counters.
+// A library built with NES_PERF_COUNTERS defined times the hot paths of
+// each part of the emulator and counts the calls into them.  Each figure
+// is the time spent in that part itself: time the CPU spends clocking the
+// APU counts as APU, time spent adding tracer samples counts as tracer,
+// and so on.  Whatever the frame took beyond the sum of them (quiet and
+// vblank scanlines, mapper upkeep) is left to the caller to work out from
+// frameNs.  Time stopped in the breakpoint or audio hooks is reported as
+// waitNs and counted nowhere else.  nesGetPerfCounters fills in the figures for the last frame run
+// and returns false (with everything zeroed) if the library was built
+// without the counters.
+typedef enum
+{
+   eNESPerf_CPU = 0,
+   eNESPerf_PPURender,
+   eNESPerf_APU,
+   eNESPerf_Tracer,
+   eNESPerf_CodeDataLogger,
+   eNESPerf_Breakpoints,
+   eNESPerf_Count
+} eNESPerfCounter;
+
+typedef struct _NesPerfCounters
+{
+   uint32_t frame;
+   uint64_t frameNs;
+   uint64_t waitNs;
+   uint64_t ns [ eNESPerf_Count ];
+   uint32_t calls [ eNESPerf_Count ];
+} NesPerfCounters;
+
+bool nesGetPerfCounters ( NesPerfCounters* counters );
 void nesSetControllerType ( int32_t port, int32_t type );
 void nesSetControllerScreenPosition ( int32_t port, int32_t px, int32_t py, int32_t wx1, int32_t wy1, int32_t wx2, int32_t wy2 );
 void nesSetControllerSpecial ( int32_t port, int32_t special );
 bool nesROMIsLoaded ( void );
 
+// Save-state interfaces.
+// A save-state is a versioned, chunked binary snapshot of the whole machine:
+// CPU, PPU, APU, cartridge memories and mapper registers.  The caller owns
+// the buffer.  nesGetStateSize returns the size a save-state of the loaded
+// cartridge needs; nesSaveState returns the number of bytes written, or 0 if
+// the buffer is too small.  nesLoadState refuses save-states from another
+// build, cartridge or system mode and leaves the machine untouched if so.
+uint32_t nesGetStateSize ( void );
+uint32_t nesSaveState ( uint8_t* buffer, uint32_t size );
+bool nesLoadState ( const uint8_t* buffer, uint32_t size );
+
+// Rewind interfaces.
+// While rewind is enabled, call nesRewindCapture with the joypads just before
+// each nesRun to record the frame.  nesRewindStep restores the most recently
+// recorded frame, removes it from the history and returns the joypads it was
+// recorded with; running a frame with those joypads re-creates that frame's
+// picture, so calling nesRewindStep+nesRun once per frame plays the history
+// backwards.  The history is a fixed-size ring holding up to the given number
+// of frames in at most the given number of bytes, stored as a keyframe every
+// keyframeInterval frames and compressed deltas against it in between.
+// Changing the limits discards the history.  Memory is only allocated while
+// rewind is enabled.
+void nesSetRewindEnabled ( bool enabled );
+bool nesIsRewindEnabled ( void );
+void nesSetRewindLimits ( uint32_t frames, uint32_t bytes, uint32_t keyframeInterval );
+void nesRewindCapture ( uint32_t* joypads );
+bool nesRewindStep ( uint32_t* joypads );
+void nesClearRewind ( void );
+uint32_t nesGetRewindFrames ( void );
+uint32_t nesGetRewindMemoryUsed ( void );
+
+// Machine instance interfaces.
+// Every interface above operates on the machine selected by the calling thread,
+// which is the default machine unless nesSelect() has been used.  To emulate
+// several NES machines at once, create one with nesCreate() per emulation and
+// either select it on the thread that drives it, or use the *Handle variants
+// below which select the machine only for the duration of the call.  A machine
+// must only be driven by one thread at a time.
+typedef struct NesMachine NesMachine;
+NesMachine* nesCreate ( void );
+void nesDestroy ( NesMachine* machine );
+NesMachine* nesGetDefaultMachine ( void );
+NesMachine* nesGetCurrentMachine ( void );
+NesMachine* nesSelect ( NesMachine* machine );
+void nesSetSystemModeHandle ( NesMachine* machine, uint32_t mode );
+uint32_t nesGetSystemModeHandle ( NesMachine* machine );
+void nesSetTVOutHandle ( NesMachine* machine, int8_t* tv );
+void nesSetTVOutIndexedHandle ( NesMachine* machine, uint16_t* tv );
+void nesUnloadROMHandle ( NesMachine* machine );
+void nesLoadPRGROMBankHandle ( NesMachine* machine, uint32_t bank, uint8_t* bankData );
+void nesLoadCHRROMBankHandle ( NesMachine* machine, uint32_t bank, uint8_t* bankData );
+void nesSetHorizontalMirroringHandle ( NesMachine* machine );
+void nesSetVerticalMirroringHandle ( NesMachine* machine );
+void nesSetFourScreenHandle ( NesMachine* machine );
+void nesLoadROMHandle ( NesMachine* machine );
+void nesResetInitialHandle ( NesMachine* machine, uint32_t mapper );
+void nesResetHandle ( NesMachine* machine, bool soft );
+void nesRunHandle ( NesMachine* machine, uint32_t* joypads );
+void nesRunAheadHandle ( NesMachine* machine, uint32_t* joypads, uint32_t frames );
+int32_t nesGetAudioSamplesAvailableHandle ( NesMachine* machine );
+void nesClearAudioSamplesAvailableHandle ( NesMachine* machine );
+uint8_t* nesGetAudioSamplesHandle ( NesMachine* machine, uint16_t samples );
+void nesSetControllerTypeHandle ( NesMachine* machine, int32_t port, int32_t type );
+void nesSetControllerScreenPositionHandle ( NesMachine* machine, int32_t port, int32_t px, int32_t py, int32_t wx1, int32_t wy1, int32_t wx2, int32_t wy2 );
+void nesSetControllerSpecialHandle ( NesMachine* machine, int32_t port, int32_t special );
+bool nesROMIsLoadedHandle ( NesMachine* machine );
+uint32_t nesGetStateSizeHandle ( NesMachine* machine );
+uint32_t nesSaveStateHandle ( NesMachine* machine, uint8_t* buffer, uint32_t size );
+bool nesLoadStateHandle ( NesMachine* machine, const uint8_t* buffer, uint32_t size );
+
 // Internal debug interfaces.
-extern bool __nesdebug;
-#define nesIsDebuggable() ( __nesdebug )
 void nesBreak ( void );
 void nesBreakAudio ( void );
 
@@ -552,9 +724,11 @@ CRegisterDatabase* nesGetCartridgeRegisterDatabase ( void );
 
 CMarker* nesGetExecutionMarkerDatabase ( void );
 
-// General debug interfaces.
+// General debug interfaces.  Debug support is turned on and off for the
+// selected machine only.
 void nesEnableDebug ( void );
 void nesDisableDebug ( void );
+bool nesIsDebugEnabled ( void );
 uint32_t nesGetNumColors ( void );
 uint32_t nesGetPaletteRedComponent(uint32_t idx);
 uint32_t nesGetPaletteGreenComponent(uint32_t idx);
@@ -567,10 +741,15 @@ int8_t* nesGetTVOut ( void );
 void nesSetVRC6AudioChannelMask ( uint32_t mask );
 void nesSetN106AudioChannelMask ( uint32_t mask );
 void nesSetAudioChannelMask ( uint8_t mask );
+void nesSetAudioSynthesis ( uint32_t mode );
 uint8_t nesGetMemory ( uint32_t addr );
 void nesDisassemble ();
+// Rows of the code browser's view of the memory at addr that changed since
+// the last call: firstRow up to endRow are new, the rows after them are
+// the old ones moved by rowDelta.  Returns false if nothing changed.
+bool nesGetDisassemblyChanges ( uint32_t addr, int32_t* firstRow, int32_t* endRow, int32_t* rowDelta );
 void nesDisassembleSingle ( uint8_t* pOpcode, char* buffer );
-char* nesGetDisassemblyAtAddress ( uint32_t addr );
+void nesGetDisassemblyAtAddress ( uint32_t addr, char* buffer );
 void nesGetDisassemblyAtAbsoluteAddress ( uint32_t absAddr, char* buffer );
 uint32_t nesGetAddressFromSLOC ( uint16_t sloc );
 uint16_t nesGetSLOCFromAddress ( uint32_t addr );
@@ -593,6 +772,7 @@ void nesGetPrintableAddressWithAbsolute ( char* buffer, uint32_t addr, uint32_t
 
 // 6502 debug interfaces.
 uint32_t nesGetCPUCycle ( void );
+uint32_t nesGetCPUInstructions ( void );
 void nesSetGotoAddress ( uint32_t addr );
 bool nesCPUIsFetchingOpcode ( void );
 bool nesCPUIsWritingMemory ( void );